@@ -32,44 +32,114 @@ void MidiAudio::_initialize(HWND windowHandle) noexcept
     }
 }
 
+MidiAudio::~MidiAudio()
+{
+    {
+        const std::lock_guard guard{ _mutex };
+        _shutdown = true;
+    }
+    _cv.notify_all();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+// Discards all queued notes, cuts the current one short and
+// ignores any further notes until EndSkip() is called.
+// This happens for Ctrl+C or during shutdown.
 void MidiAudio::BeginSkip() noexcept
 {
-    _skip.SetEvent();
+    {
+        const std::lock_guard guard{ _mutex };
+        _notes.clear();
+        _skipGeneration++;
+        _skip = true;
+    }
+    _cv.notify_all();
 }
 
 void MidiAudio::EndSkip() noexcept
 {
-    _skip.ResetEvent();
+    const std::lock_guard guard{ _mutex };
+    _skip = false;
 }
 
+// Queues the note for playback and returns immediately.
+// The notes are played in order on a background thread.
 void MidiAudio::PlayNote(HWND windowHandle, const int noteNumber, const int velocity, const std::chrono::milliseconds duration) noexcept
 try
 {
-    if (_skip.is_signaled())
     {
-        return;
+        const std::lock_guard guard{ _mutex };
+
+        if (_skip || _shutdown)
+        {
+            return;
+        }
+
+        _notes.push_back({ windowHandle, noteNumber, velocity, duration });
+
+        if (!_thread.joinable())
+        {
+            _thread = std::thread{ &MidiAudio::_run, this };
+        }
+    }
+    _cv.notify_all();
+}
+CATCH_LOG()
+
+void MidiAudio::_run() noexcept
+try
+{
+    SetThreadDescription(GetCurrentThread(), L"MidiAudio");
+
+    std::unique_lock lock{ _mutex };
+
+    for (;;)
+    {
+        _cv.wait(lock, [&]() { return _shutdown || !_notes.empty(); });
+        if (_shutdown)
+        {
+            break;
+        }
+
+        const auto note = _notes.front();
+        const auto skipGeneration = _skipGeneration;
+        _notes.pop_front();
+
+        lock.unlock();
+        _playNote(note, skipGeneration);
+        lock.lock();
     }
+}
+CATCH_LOG()
 
-    if (_hwnd != windowHandle)
+// Plays a single note, blocking for its duration, unless BeginSkip() is called in the meantime.
+void MidiAudio::_playNote(const Note& note, const uint64_t skipGeneration) noexcept
+try
+{
+    if (_hwnd != note.windowHandle)
     {
-        _initialize(windowHandle);
+        _initialize(note.windowHandle);
     }
 
     const auto& buffer = _buffers.at(_activeBufferIndex);
-    if (velocity && buffer)
+    if (note.velocity && buffer)
     {
         // The formula for frequency is 2^(n/12) * 440Hz, where n is zero for
         // the A above middle C (A4). In MIDI terms, A4 is note number 69,
         // which is why we subtract 69. We also need to multiply by the size
         // of the wave form to determine the frequency that the sound buffer
         // has to be played to achieve the equivalent note frequency.
-        const auto frequency = std::pow(2.0, (noteNumber - 69.0) / 12.0) * 440.0 * WAVE_SIZE;
+        const auto frequency = std::pow(2.0, (note.noteNumber - 69.0) / 12.0) * 440.0 * WAVE_SIZE;
         buffer->SetFrequency(gsl::narrow_cast<DWORD>(frequency));
         // For the volume, we're using the formula defined in the General
         // MIDI Level 2 specification: Gain in dB = 40 * log10(v/127). We need
         // to multiply by 4000, though, because the SetVolume method expects
         // the volume to be in hundredths of a decibel.
-        const auto volume = 4000.0 * std::log10(velocity / 127.0);
+        const auto volume = 4000.0 * std::log10(note.velocity / 127.0);
         buffer->SetVolume(gsl::narrow_cast<LONG>(volume));
         // Resetting the buffer to a position that is slightly off from the
         // last position will help to produce a clearer separation between
@@ -77,12 +147,14 @@ try
         buffer->SetCurrentPosition((_lastBufferPosition + 12) % WAVE_SIZE);
     }
 
-    // By waiting on the skip event with a maximum duration of the note, we'll
-    // either be paused for the appropriate amount of time, or we'll break out early
-    // because BeginSkip() was called. This happens for Ctrl+C or during shutdown.
-    _skip.wait(::base::saturated_cast<DWORD>(duration.count()));
+    // By waiting with a maximum duration of the note, we'll either be paused for the
+    // appropriate amount of time, or we'll break out early because BeginSkip() was called.
+    {
+        std::unique_lock lock{ _mutex };
+        _cv.wait_for(lock, note.duration, [&]() { return _shutdown || _skipGeneration != skipGeneration; });
+    }
 
-    if (velocity && buffer)
+    if (note.velocity && buffer)
     {
         // When the note ends, we just turn the volume down instead of stopping
         // the sound buffer. This helps reduce unwanted static between notes.
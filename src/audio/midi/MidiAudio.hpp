@@ -6,12 +6,14 @@ Module Name:
 - MidiAudio.hpp
 
 Abstract:
-  This modules provide basic MIDI support with blocking sound output.
+  This modules provide basic MIDI support. Notes are queued and played
+  back on a thread of their own, so that callers don't block on them.
   */
 
 #pragma once
 
 #include <array>
+#include <condition_variable>
 
 struct IDirectSound8;
 struct IDirectSoundBuffer;
@@ -19,16 +21,43 @@ struct IDirectSoundBuffer;
 class MidiAudio
 {
 public:
+    MidiAudio() = default;
+    ~MidiAudio();
+
+    MidiAudio(const MidiAudio&) = delete;
+    MidiAudio& operator=(const MidiAudio&) = delete;
+    MidiAudio(MidiAudio&&) = delete;
+    MidiAudio& operator=(MidiAudio&&) = delete;
+
     void BeginSkip() noexcept;
     void EndSkip() noexcept;
     void PlayNote(HWND windowHandle, const int noteNumber, const int velocity, const std::chrono::milliseconds duration) noexcept;
 
 private:
+    struct Note
+    {
+        HWND windowHandle;
+        int noteNumber;
+        int velocity;
+        std::chrono::milliseconds duration;
+    };
+
+    void _run() noexcept;
+    void _playNote(const Note& note, const uint64_t skipGeneration) noexcept;
     void _initialize(HWND windowHandle) noexcept;
     void _createBuffers() noexcept;
 
-    wil::slim_event_manual_reset _skip;
+    // These are protected by _mutex.
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<Note> _notes;
+    // Incremented by every BeginSkip() to cut the currently playing note short.
+    uint64_t _skipGeneration = 0;
+    bool _skip = false;
+    bool _shutdown = false;
+    std::thread _thread;
 
+    // These are only ever used by _thread.
     HWND _hwnd = nullptr;
     wil::unique_hmodule _directSoundModule;
     wil::com_ptr<IDirectSound8> _directSound;
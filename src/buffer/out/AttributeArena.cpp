@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "AttributeArena.hpp"
+
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// Routine Description:
+// - Allocates memory for attribute runs from the given arena, or from the heap if there's none.
+// Arguments:
+// - arena - The arena of the ROW's block. May be nullptr.
+// - size - The size of the allocation in bytes.
+// Return Value:
+// - A pointer to at least `size` bytes, which must be freed with Deallocate().
+void* AttributeArena::Allocate(AttributeArena* arena, size_t size)
+{
+    const auto total = size + sizeof(Header);
+    Header* header;
+
+    if (arena && total <= (_minBlockSize << (_sizeClassCount - 1)))
+    {
+        size_t sizeClass = 0;
+        while ((_minBlockSize << sizeClass) < total)
+        {
+            ++sizeClass;
+        }
+
+        header = arena->_allocate(sizeClass);
+        header->arena = arena;
+        header->sizeClass = sizeClass;
+    }
+    else
+    {
+        if (total < size)
+        {
+            throw std::bad_array_new_length{};
+        }
+
+        header = static_cast<Header*>(::operator new(total));
+        header->arena = nullptr;
+        header->sizeClass = 0;
+    }
+
+    return header + 1;
+}
+
+// Routine Description:
+// - Frees memory previously returned by Allocate(), no matter which arena it came from.
+void AttributeArena::Deallocate(void* ptr) noexcept
+{
+    const auto header = static_cast<Header*>(ptr) - 1;
+    if (header->arena)
+    {
+        header->arena->_deallocate(header);
+    }
+    else
+    {
+        ::operator delete(header);
+    }
+}
+
+// Routine Description:
+// - Returns the amount of memory in bytes that the arena's slabs occupy.
+size_t AttributeArena::GetReservedSize() const noexcept
+{
+    return _slabs.size() * _slabSize;
+}
+
+// Routine Description:
+// - Frees all slabs at once. None of the memory handed out by the arena may be in use anymore.
+//   TextBuffer calls this once it has destroyed all ROWs that belong to the arena.
+void AttributeArena::Reset() noexcept
+{
+    _freeLists.fill(nullptr);
+    _slabs.clear();
+    _slabPos = nullptr;
+    _slabEnd = nullptr;
+}
+
+AttributeArena::Header* AttributeArena::_allocate(size_t sizeClass)
+{
+    auto& freeList = til::at(_freeLists, sizeClass);
+    if (freeList)
+    {
+        const auto block = freeList;
+        freeList = block->next;
+        return reinterpret_cast<Header*>(block);
+    }
+
+    const auto size = _minBlockSize << sizeClass;
+    if (gsl::narrow_cast<size_t>(_slabEnd - _slabPos) < size)
+    {
+        // The remainder of the previous slab is abandoned. It's smaller than the
+        // largest size class and thus at most a quarter of the slab.
+        auto& slab = _slabs.emplace_back(std::make_unique_for_overwrite<std::byte[]>(_slabSize));
+        _slabPos = slab.get();
+        _slabEnd = _slabPos + _slabSize;
+    }
+
+    const auto header = reinterpret_cast<Header*>(_slabPos);
+    _slabPos += size;
+    return header;
+}
+
+void AttributeArena::_deallocate(Header* header) noexcept
+{
+    auto& freeList = til::at(_freeLists, header->sizeClass);
+    const auto block = reinterpret_cast<FreeBlock*>(header);
+    block->next = freeList;
+    freeList = block;
+}
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// AttributeArena is a pool allocator for the run-length encoded attributes of a block of ROWs.
+// Rows with more than 1 attribute run normally store their runs in individual heap allocations.
+// If TextBuffer::SetAttributeArenaEnabled(true) is set, ROWs instead allocate them from the arena of
+// their block, which packs them into a few contiguous slabs and recycles freed allocations.
+//
+// Every allocation is prefixed with a header pointing to its arena (or nullptr for the regular heap),
+// which allows any Allocator instance to free any allocation. This makes the Allocator "always equal"
+// and allows small_vector to move its storage between allocators, just like with std::allocator.
+class AttributeArena final
+{
+public:
+    template<typename T>
+    struct Allocator
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+        using value_type = T;
+        using is_always_equal = std::true_type;
+        // A ROW keeps allocating from the arena of its block, no matter where its attributes came from.
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        constexpr Allocator() noexcept = default;
+
+        constexpr explicit Allocator(AttributeArena* arena) noexcept :
+            arena{ arena }
+        {
+        }
+
+        template<typename U>
+        constexpr Allocator(const Allocator<U>& other) noexcept :
+            arena{ other.arena }
+        {
+        }
+
+        // Copies of a ROW's attributes (for instance RowAttributes copies made by the renderer)
+        // may outlive the TextBuffer and so they must not allocate from its arenas.
+        constexpr Allocator select_on_container_copy_construction() const noexcept
+        {
+            return {};
+        }
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(AttributeArena::Allocate(arena, count * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t) noexcept
+        {
+            AttributeArena::Deallocate(ptr);
+        }
+
+        template<typename U>
+        constexpr bool operator==(const Allocator<U>&) const noexcept
+        {
+            return true;
+        }
+
+        AttributeArena* arena = nullptr;
+    };
+
+    AttributeArena() = default;
+
+    AttributeArena(const AttributeArena&) = delete;
+    AttributeArena& operator=(const AttributeArena&) = delete;
+
+    static void* Allocate(AttributeArena* arena, size_t size);
+    static void Deallocate(void* ptr) noexcept;
+
+    size_t GetReservedSize() const noexcept;
+    void Reset() noexcept;
+
+private:
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header
+    {
+        AttributeArena* arena;
+        size_t sizeClass;
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    // The size classes are _minBlockSize << [0, _sizeClassCount), all including the Header.
+    // Larger allocations (= rows with hundreds of attribute runs) go straight to the heap.
+    static constexpr size_t _minBlockSize = 64;
+    static constexpr size_t _sizeClassCount = 7;
+    static constexpr size_t _slabSize = 16 * 1024;
+
+    Header* _allocate(size_t sizeClass);
+    void _deallocate(Header* header) noexcept;
+
+    std::array<FreeBlock*, _sizeClassCount> _freeLists{};
+    std::vector<std::unique_ptr<std::byte[]>> _slabs;
+    std::byte* _slabPos = nullptr;
+    std::byte* _slabEnd = nullptr;
+};
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "BufferSnapshot.hpp"
+
+#include "textBuffer.hpp"
+
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+
+// Routine Description:
+// - Creates an empty snapshot at the given path, replacing any existing file.
+//   Call Restore() first to load the previous snapshot at that path.
+BufferSnapshot::BufferSnapshot(const std::filesystem::path& path)
+{
+    _file.reset(CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    THROW_LAST_ERROR_IF(!_file);
+
+    static constexpr FileHeader header{ _magic, _version };
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file.get(), &header, sizeof(header), &written, nullptr));
+}
+
+// Routine Description:
+// - Captures all rows above the viewport that haven't been captured yet.
+// Arguments:
+// - buffer - The buffer to capture. This should always be the same one, but if it's replaced
+//   (for instance when the terminal is resized), the snapshot starts over with the new one.
+// - viewportTop - The first row of the viewport. The rows below it may still change.
+void BufferSnapshot::Capture(const TextBuffer& buffer, const til::CoordType viewportTop)
+{
+    const auto rotation = buffer.GetRotationCount();
+    const auto height = buffer.TotalRowCount();
+    const auto top = std::clamp(viewportTop, 0, height);
+
+    // The rows we captured before and that are still in the buffer are [0,captured) now.
+    // If any of them has changed since, the snapshot is outdated. If the buffer was replaced,
+    // all of its rows count as changed, because every TextBuffer has its own range of mutation IDs.
+    if (_capturedEnd > rotation)
+    {
+        const auto captured = gsl::narrow_cast<til::CoordType>(std::min<uint64_t>(_capturedEnd - rotation, height));
+        if (buffer.GetFirstRowMutatedSince(_mutationId, 0, captured) != captured)
+        {
+            _pending.clear();
+            _truncate = true;
+            _capturedEnd = rotation;
+        }
+    }
+
+    // If _capturedEnd is less than the rotation count, rows got recycled before we got to capture them.
+    // This only happens if there was more output than fits into the buffer since the last call.
+    auto y = gsl::narrow_cast<til::CoordType>(std::max(_capturedEnd, rotation) - rotation);
+    for (; y < top; ++y)
+    {
+        _appendRow(buffer.GetRowByOffset(y));
+    }
+
+    _capturedEnd = std::max(_capturedEnd, rotation + top);
+    _mutationId = buffer.GetLastMutationId();
+}
+
+// Routine Description:
+// - Same as Capture(), but additionally captures the rows in the viewport, up to the
+//   last one that's not empty. Call this when the session ends, followed by Flush().
+void BufferSnapshot::CaptureFinal(const TextBuffer& buffer, const til::CoordType viewportTop)
+{
+    Capture(buffer, viewportTop);
+
+    const auto top = std::clamp(viewportTop, 0, buffer.TotalRowCount());
+    const auto last = std::max(buffer.GetCursor().GetPosition().y, buffer.GetLastNonSpaceCharacter().y);
+    for (auto y = top; y <= last; ++y)
+    {
+        _appendRow(buffer.GetRowByOffset(y));
+    }
+
+    _capturedEnd = buffer.GetRotationCount() + last + 1;
+}
+
+// Routine Description:
+// - Writes all captured rows to the file.
+void BufferSnapshot::Flush()
+{
+    if (_truncate)
+    {
+        LARGE_INTEGER afterHeader;
+        afterHeader.QuadPart = sizeof(FileHeader);
+        THROW_IF_WIN32_BOOL_FALSE(SetFilePointerEx(_file.get(), afterHeader, nullptr, FILE_BEGIN));
+        THROW_IF_WIN32_BOOL_FALSE(SetEndOfFile(_file.get()));
+        _truncate = false;
+    }
+
+    if (!_pending.empty())
+    {
+        DWORD written = 0;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file.get(), _pending.data(), gsl::narrow<DWORD>(_pending.size()), &written, nullptr));
+        _pending.clear();
+    }
+}
+
+// Routine Description:
+// - Writes the rows of the snapshot at the given path into the buffer, starting at the cursor,
+//   as if they had been printed. The cursor ends up at the start of the row below them.
+//   Rows that are wider than the buffer are truncated.
+// Arguments:
+// - path - The path of the snapshot.
+// - buffer - The buffer to restore the rows into.
+// Return Value:
+// - false if there's no valid snapshot at the given path.
+bool BufferSnapshot::Restore(const std::filesystem::path& path, TextBuffer& buffer)
+{
+    const wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+    if (!file)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+    if (fileSize.QuadPart <= static_cast<LONGLONG>(sizeof(FileHeader)))
+    {
+        return false;
+    }
+
+    // The rows are decompressed straight from a view of the file, instead of reading it into memory first.
+    const wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    THROW_LAST_ERROR_IF(!mapping);
+    const auto size = gsl::narrow<size_t>(fileSize.QuadPart);
+    const wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, size)) };
+    THROW_LAST_ERROR_IF(!view);
+
+    FileHeader header;
+    memcpy(&header, view.get(), sizeof(header));
+    if (header.magic != _magic || header.version != _version)
+    {
+        return false;
+    }
+
+    std::vector<ScrollbackArchive::RowBufferChunk> scratch;
+    auto& cursor = buffer.GetCursor();
+
+    // A record may be incomplete if the last session didn't get to finish writing it.
+    for (auto offset = sizeof(header); size - offset > sizeof(uint32_t);)
+    {
+        uint32_t recordSize;
+        memcpy(&recordSize, view.get() + offset, sizeof(recordSize));
+        offset += sizeof(recordSize);
+        if (recordSize > size - offset)
+        {
+            break;
+        }
+
+        ScrollbackArchive::DeserializeRow(view.get() + offset, buffer.GetMutableRowByOffset(cursor.GetPosition().y), scratch);
+        buffer.NewlineCursor();
+        offset += recordSize;
+    }
+
+    return true;
+}
+
+void BufferSnapshot::_appendRow(const ROW& row)
+{
+    const auto offset = _pending.size();
+    _pending.resize(offset + sizeof(uint32_t));
+    ScrollbackArchive::SerializeRow(row, _pending);
+
+    const auto recordSize = gsl::narrow<uint32_t>(_pending.size() - offset - sizeof(uint32_t));
+    memcpy(_pending.data() + offset, &recordSize, sizeof(recordSize));
+}
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "ScrollbackArchive.hpp"
+
+class TextBuffer;
+
+// BufferSnapshot incrementally saves the contents of a TextBuffer into a file, so that they can be restored
+// by the next session. Rows are appended once they've scrolled out of the viewport, as they can't change after
+// that, which leaves only the viewport to be written when the session ends. If written rows do change anyway,
+// for instance because the buffer got resized or the scrollback was cleared, the snapshot starts over.
+// The rows are serialized the same way ScrollbackArchive stores them.
+//
+// Capture() must be called under the console lock, while Flush() does the actual I/O and doesn't need it.
+// Neither of them is thread-safe.
+class BufferSnapshot final
+{
+public:
+    explicit BufferSnapshot(const std::filesystem::path& path);
+
+    void Capture(const TextBuffer& buffer, til::CoordType viewportTop);
+    void CaptureFinal(const TextBuffer& buffer, til::CoordType viewportTop);
+    void Flush();
+
+    static bool Restore(const std::filesystem::path& path, TextBuffer& buffer);
+
+private:
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    static constexpr uint32_t _magic = 0x53425457; // "WTBS"
+    static constexpr uint32_t _version = 1;
+
+    void _appendRow(const ROW& row);
+
+    wil::unique_hfile _file;
+    // Rows that were captured but not written yet. Each is prefixed with its uint32_t size.
+    std::vector<uint8_t> _pending;
+    // Set if the snapshot started over and the file needs to be truncated first.
+    bool _truncate = false;
+    // The index of the next row to capture, offset by TextBuffer::GetRotationCount(),
+    // and the TextBuffer::GetLastMutationId() at the time of the last capture.
+    uint64_t _capturedEnd = 0;
+    uint64_t _mutationId = 0;
+};
@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ImageSlice.hpp"
+
+ImageSlice::ImageSlice(const til::size cellSize) noexcept :
+    _cellSize{ cellSize },
+    _revision{ _nextRevision() }
+{
+}
+
+til::size ImageSlice::CellSize() const noexcept
+{
+    return _cellSize;
+}
+
+til::CoordType ImageSlice::ColumnOffset() const noexcept
+{
+    return _columnBegin;
+}
+
+til::CoordType ImageSlice::ColumnEnd() const noexcept
+{
+    return _columnEnd;
+}
+
+til::CoordType ImageSlice::PixelWidth() const noexcept
+{
+    return _pixelWidth;
+}
+
+uint64_t ImageSlice::Revision() const noexcept
+{
+    return _revision;
+}
+
+// Routine Description:
+// - Returns all pixels of the slice. They're PixelWidth() wide and CellSize().height tall,
+//   starting at column ColumnOffset().
+std::span<const RGBQUAD> ImageSlice::Pixels() const noexcept
+{
+    return _pixelBuffer;
+}
+
+// Routine Description:
+// - Grows the slice to cover the given columns, if needed, and returns a pointer to the first
+//   pixel of columnBegin. Rows of pixels are PixelWidth() apart, which is only valid after this call.
+// Arguments:
+// - columnBegin - The first column that the caller intends to modify.
+// - columnEnd - The column past the last one that the caller intends to modify.
+// Return Value:
+// - A pointer to the pixel at the top left of columnBegin.
+RGBQUAD* ImageSlice::MutablePixels(const til::CoordType columnBegin, const til::CoordType columnEnd)
+{
+    const auto empty = _columnBegin >= _columnEnd;
+    const auto newBegin = empty ? columnBegin : std::min(_columnBegin, columnBegin);
+    const auto newEnd = empty ? columnEnd : std::max(_columnEnd, columnEnd);
+
+    if (newBegin != _columnBegin || newEnd != _columnEnd)
+    {
+        const auto newPixelWidth = (newEnd - newBegin) * _cellSize.width;
+        std::vector<RGBQUAD> newPixelBuffer(gsl::narrow_cast<size_t>(newPixelWidth) * _cellSize.height);
+
+        if (!empty)
+        {
+            const auto offset = gsl::narrow_cast<size_t>(_columnBegin - newBegin) * _cellSize.width;
+            for (til::CoordType y = 0; y < _cellSize.height; ++y)
+            {
+                const auto src = _pixelBuffer.begin() + gsl::narrow_cast<size_t>(y) * _pixelWidth;
+                const auto dst = newPixelBuffer.begin() + gsl::narrow_cast<size_t>(y) * newPixelWidth + offset;
+                std::copy_n(src, _pixelWidth, dst);
+            }
+        }
+
+        _pixelBuffer = std::move(newPixelBuffer);
+        _columnBegin = newBegin;
+        _columnEnd = newEnd;
+        _pixelWidth = newPixelWidth;
+    }
+
+    _revision = _nextRevision();
+    return _pixelBuffer.data() + gsl::narrow_cast<size_t>(columnBegin - _columnBegin) * _cellSize.width;
+}
+
+// Routine Description:
+// - Clears the pixels of the given range of columns, for instance because text got written on top of them.
+// Arguments:
+// - columnBegin - The first column to clear.
+// - columnEnd - The column past the last one to clear.
+// Return Value:
+// - true if the slice doesn't contain any pixels anymore and can be deleted.
+bool ImageSlice::EraseCells(const til::CoordType columnBegin, const til::CoordType columnEnd) noexcept
+{
+    const auto beg = std::max(columnBegin, _columnBegin);
+    const auto end = std::min(columnEnd, _columnEnd);
+
+    if (beg >= end)
+    {
+        return _columnBegin >= _columnEnd;
+    }
+    if (beg == _columnBegin && end == _columnEnd)
+    {
+        return true;
+    }
+
+    const auto offset = gsl::narrow_cast<size_t>(beg - _columnBegin) * _cellSize.width;
+    const auto count = gsl::narrow_cast<size_t>(end - beg) * _cellSize.width;
+    for (til::CoordType y = 0; y < _cellSize.height; ++y)
+    {
+        std::fill_n(_pixelBuffer.begin() + gsl::narrow_cast<size_t>(y) * _pixelWidth + offset, count, RGBQUAD{});
+    }
+
+    _revision = _nextRevision();
+    return false;
+}
+
+uint64_t ImageSlice::_nextRevision() noexcept
+{
+    // Revisions must be unique across all TextBuffers in the process and those don't necessarily share a lock.
+    static std::atomic<uint64_t> revision{ 0 };
+    return revision.fetch_add(1, std::memory_order_relaxed) + 1;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// An ImageSlice holds the pixels of an inline image (like a sixel image) that intersect a single ROW.
+// A ROW only stores a reference-counted pointer to its slice, so that rows without images
+// cost us nothing but a null pointer and so that copying a ROW (for instance during scrolling)
+// doesn't copy any pixels. Since the renderer holds on to the slices it draws, a shared slice
+// must be copied before it's modified. ROW::GetMutableImageSlice() takes care of that.
+//
+// The pixels are stored in the B8G8R8A8 format with premultiplied alpha, as used by D2D/D3D,
+// in a cell size that's independent of the font. The renderer scales the slice into its cells.
+class ImageSlice final
+{
+public:
+    using Pointer = std::shared_ptr<ImageSlice>;
+
+    explicit ImageSlice(til::size cellSize) noexcept;
+
+    til::size CellSize() const noexcept;
+    til::CoordType ColumnOffset() const noexcept;
+    til::CoordType ColumnEnd() const noexcept;
+    til::CoordType PixelWidth() const noexcept;
+    uint64_t Revision() const noexcept;
+
+    std::span<const RGBQUAD> Pixels() const noexcept;
+    RGBQUAD* MutablePixels(til::CoordType columnBegin, til::CoordType columnEnd);
+    bool EraseCells(til::CoordType columnBegin, til::CoordType columnEnd) noexcept;
+
+private:
+    static uint64_t _nextRevision() noexcept;
+
+    til::size _cellSize;
+    std::vector<RGBQUAD> _pixelBuffer;
+    til::CoordType _columnBegin = 0;
+    til::CoordType _columnEnd = 0;
+    til::CoordType _pixelWidth = 0;
+    // Uniquely identifies the contents of this slice among all slices. It changes whenever
+    // the pixels are modified, which allows the renderer to cache them on the GPU.
+    // Copies of a slice share the revision, because they share the contents.
+    uint64_t _revision = 0;
+};
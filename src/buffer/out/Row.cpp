@@ -82,6 +82,88 @@ constexpr OutIt copy_n_small(InIt first, Diff count, OutIt dest)
     return dest;
 }
 
+// Same as iota_n, but vectorized for long runs of char offsets, like those written by the ASCII path of
+// ROW::ReplaceText. Returns `val + count`, because that's the next char offset the caller needs anyways.
+static uint16_t iota_n_offsets(uint16_t* dest, size_t count, uint16_t val) noexcept
+{
+#if defined(TIL_SSE_INTRINSICS)
+    if (count >= 8)
+    {
+        const auto end = dest + (count & ~size_t{ 7 });
+        const auto increment = _mm_set1_epi16(8);
+        auto offsets = _mm_add_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), _mm_set1_epi16(static_cast<short>(val)));
+
+        do
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), offsets);
+            offsets = _mm_add_epi16(offsets, increment);
+            dest += 8;
+        } while (dest < end);
+
+        val = gsl::narrow_cast<uint16_t>(val + (count & ~size_t{ 7 }));
+        count &= 7;
+    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+    if (count >= 8)
+    {
+        alignas(uint16x8_t) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7 };
+
+        const auto end = dest + (count & ~size_t{ 7 });
+        const auto increment = vdupq_n_u16(8);
+        auto offsets = vaddq_u16(vld1q_u16(&offsetsData[0]), vdupq_n_u16(val));
+
+        do
+        {
+            vst1q_u16(dest, offsets);
+            offsets = vaddq_u16(offsets, increment);
+            dest += 8;
+        } while (dest < end);
+
+        val = gsl::narrow_cast<uint16_t>(val + (count & ~size_t{ 7 }));
+        count &= 7;
+    }
+#endif
+
+    iota_n_mut(dest, count, val);
+    return val;
+}
+
+// Same as std::fill_n, but vectorized for long runs of the same character, like those written by ROW::FillText.
+static void fill_n_chars(wchar_t* dest, size_t count, const wchar_t ch) noexcept
+{
+#if defined(TIL_SSE_INTRINSICS)
+    if (count >= 8)
+    {
+        const auto end = dest + (count & ~size_t{ 7 });
+        const auto chars = _mm_set1_epi16(static_cast<short>(ch));
+
+        do
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), chars);
+            dest += 8;
+        } while (dest < end);
+
+        count &= 7;
+    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+    if (count >= 8)
+    {
+        const auto end = dest + (count & ~size_t{ 7 });
+        const auto chars = vdupq_n_u16(ch);
+
+        do
+        {
+            vst1q_u16(reinterpret_cast<uint16_t*>(dest), chars);
+            dest += 8;
+        } while (dest < end);
+
+        count &= 7;
+    }
+#endif
+
+    fill_n_small(dest, count, ch);
+}
+
 CharToColumnMapper::CharToColumnMapper(const wchar_t* chars, const uint16_t* charOffsets, ptrdiff_t lastCharOffset, til::CoordType currentColumn) noexcept :
     _chars{ chars },
     _charOffsets{ charOffsets },
@@ -167,13 +249,14 @@ til::CoordType CharToColumnMapper::GetTrailingColumnAt(const wchar_t* str) noexc
 // Arguments:
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
+// - attributeArena - the arena to allocate attribute runs from, or nullptr to use the heap
 // Return Value:
 // - constructed object
-ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
+ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, AttributeArena* attributeArena) :
     _charsBuffer{ charsBuffer },
     _chars{ charsBuffer, rowWidth },
     _charOffsets{ charOffsetsBuffer, ::base::strict_cast<size_t>(rowWidth) + 1u },
-    _attr{ rowWidth, fillAttribute },
+    _attr{ rowWidth, fillAttribute, RowAttributes::allocator_type{ attributeArena } },
     _columnCount{ rowWidth }
 {
     _init();
@@ -235,6 +318,7 @@ void ROW::Reset(const TextAttribute& attr) noexcept
     // Constructing and then moving objects into place isn't free.
     // Modifying the existing object is _much_ faster.
     *_attr.runs().unsafe_shrink_to_size(1) = til::rle_pair{ attr, _columnCount };
+    _imageSlice.reset();
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
     _doubleBytePadded = false;
@@ -356,7 +440,7 @@ void ROW::_init() noexcept
 #pragma warning(push)
 }
 
-void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth)
+void ROW::TransferAttributes(const RowAttributes& attr, til::CoordType newWidth)
 {
     _attr = attr;
     _attr.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
@@ -364,13 +448,180 @@ void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& a
 
 void ROW::CopyFrom(const ROW& source)
 {
-    RowCopyTextFromState state{ .source = source };
-    CopyTextFrom(state);
+    // Rows of the same width are what TextBuffer::ScrollRows() deals with when
+    // scrolling the margins (tmux, vim splits, less, etc.) and for those _chars and
+    // _charOffsets can be copied verbatim, without CopyTextFrom() having to validate
+    // and re-measure every glyph. This makes each line feed within the margins a memcpy per row.
+    if (source._columnCount == _columnCount && this != &source)
+    {
+        _copyTextVerbatim(source);
+    }
+    else
+    {
+        RowCopyTextFromState state{ .source = source };
+        CopyTextFrom(state);
+    }
     TransferAttributes(source.Attributes(), _columnCount);
+    _imageSlice = source._imageSlice;
     _lineRendition = source._lineRendition;
     _wrapForced = source._wrapForced;
 }
 
+// Copies the text of a row with the same _columnCount, including its _charOffsets as is.
+void ROW::_copyTextVerbatim(const ROW& source)
+{
+    const auto charsLength = source._charSize();
+
+    if (charsLength > _chars.size())
+    {
+        auto charsHeap = std::make_unique_for_overwrite<wchar_t[]>(charsLength);
+        _chars = { charsHeap.get(), charsLength };
+        _charsHeap = std::move(charsHeap);
+    }
+
+    std::copy_n(source._chars.begin(), charsLength, _chars.begin());
+    std::copy_n(source._charOffsets.begin(), static_cast<size_t>(_columnCount) + 1, _charOffsets.begin());
+}
+
+// Appends a compact representation of this row to `out`, which can be turned back into a ROW with Decompress().
+// TextBuffer uses this to store rows in the scrollback that are unlikely to be accessed anytime soon.
+//
+// Most rows consist of narrow, single wchar_t glyphs followed by a lot of whitespace. For those _charOffsets is
+// simply 0123... and we only need to store the text up to the last non-whitespace character. Everything else
+// is stored verbatim. _attr is already run-length encoded and its runs are stored as-is. If a TextAttributeTable
+// is given, the runs store a 16-bit handle instead of the TextAttribute. The same table must then be given to Decompress().
+void ROW::Compress(std::vector<uint8_t>& out, TextAttributeTable* attributes) const
+{
+    static_assert(std::is_trivially_copyable_v<TextAttribute>);
+
+    const auto append = [&](const void* data, size_t size) {
+        const auto beg = static_cast<const uint8_t*>(data);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        out.insert(out.end(), beg, beg + size);
+    };
+
+    auto simple = _charSize() == _columnCount;
+    for (uint16_t col = 0; simple && col <= _columnCount; ++col)
+    {
+        simple = til::at(_charOffsets, col) == col;
+    }
+
+    auto charsLength = _charSize();
+    if (simple)
+    {
+        while (charsLength > 0 && til::at(_chars, charsLength - 1) == L' ')
+        {
+            --charsLength;
+        }
+    }
+
+    const auto& runs = _attr.runs();
+
+    til::small_vector<uint16_t, 32> handles;
+    if (attributes)
+    {
+        handles.reserve(runs.size());
+        for (const auto& run : runs)
+        {
+            const auto handle = attributes->Intern(run.value);
+            if (!handle)
+            {
+                // The table is full. Store the attributes as-is instead.
+                handles.clear();
+                break;
+            }
+            handles.push_back(*handle);
+        }
+    }
+
+    const auto interned = !handles.empty();
+    const CompressedHeader header{
+        .charsLength = charsLength,
+        .attrRuns = gsl::narrow<uint16_t>(runs.size()),
+        .lineRendition = _lineRendition,
+        .wrapForced = _wrapForced,
+        .doubleBytePadded = _doubleBytePadded,
+        .simple = simple,
+        .interned = interned,
+    };
+
+    append(&header, sizeof(header));
+    append(_chars.data(), charsLength * sizeof(wchar_t));
+    if (!simple)
+    {
+        append(_charOffsets.data(), _charOffsets.size() * sizeof(uint16_t));
+    }
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const auto& run = runs[i];
+        if (interned)
+        {
+            append(&handles[i], sizeof(uint16_t));
+        }
+        else
+        {
+            append(&run.value, sizeof(run.value));
+        }
+        append(&run.length, sizeof(run.length));
+    }
+}
+
+// Restores the contents of a row previously serialized with Compress() and returns a pointer past the consumed data.
+// The row must have the same width as the one that was compressed and must be freshly constructed or Reset(),
+// because a Compress()ed row doesn't contain the trailing whitespace and identity _charOffsets.
+const uint8_t* ROW::Decompress(const uint8_t* data, const TextAttributeTable* attributes)
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto read = [&](void* dst, size_t size) noexcept {
+        memcpy(dst, data, size);
+        data += size;
+    };
+
+    CompressedHeader header;
+    read(&header, sizeof(header));
+    THROW_HR_IF(E_UNEXPECTED, header.interned && !attributes);
+
+    if (!header.simple && header.charsLength > _chars.size())
+    {
+        _charsHeap = std::make_unique_for_overwrite<wchar_t[]>(header.charsLength);
+        _chars = { _charsHeap.get(), header.charsLength };
+    }
+    read(_chars.data(), header.charsLength * sizeof(wchar_t));
+    if (!header.simple)
+    {
+        read(_charOffsets.data(), _charOffsets.size() * sizeof(uint16_t));
+    }
+
+    // Allocating the runs with our own allocator ensures they end up in our AttributeArena, if we have one.
+    decltype(_attr)::container runs{ _attr.runs().get_allocator() };
+    runs.reserve(header.attrRuns);
+    for (uint16_t i = 0; i < header.attrRuns; ++i)
+    {
+        TextAttribute value;
+        uint16_t length;
+        if (header.interned)
+        {
+            uint16_t handle;
+            read(&handle, sizeof(handle));
+            value = attributes->Lookup(handle);
+        }
+        else
+        {
+            read(&value, sizeof(value));
+        }
+        read(&length, sizeof(length));
+        runs.emplace_back(value, length);
+    }
+    _attr = decltype(_attr){ std::move(runs) };
+
+    _lineRendition = header.lineRendition;
+    _wrapForced = header.wrapForced;
+    _doubleBytePadded = header.doubleBytePadded;
+    return data;
+#pragma warning(pop)
+}
+
 // Returns the previous possible cursor position, preceding the given column.
 // Returns 0 if column is less than or equal to 0.
 til::CoordType ROW::NavigateToPrevious(til::CoordType column) const noexcept
@@ -520,6 +771,121 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     return it;
 }
 
+// Writes the given CHAR_INFOs (as passed to WriteConsoleOutput) starting at columnBegin. The result is the same as
+// calling WriteCells() with an OutputCellIterator over them, but instead of writing one cell at a time, runs of
+// consecutive well-formed cells are written with a single WriteHelper and runs of equal attributes with a single
+// replace(). Only malformed DBCS sequences (orphaned halves of wide glyphs) are handled one cell at a time.
+// Return Value:
+// - The column past the last cell that was written.
+til::CoordType ROW::WriteCharInfos(const std::span<const CHAR_INFO> charInfos, const til::CoordType columnBegin)
+try
+{
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+    const auto count = std::min<size_t>(charInfos.size(), _columnCount - colBeg);
+    if (count == 0)
+    {
+        return colBeg;
+    }
+
+    static constexpr auto isLeading = [](const CHAR_INFO& ci) { return WI_IsFlagSet(ci.Attributes, COMMON_LVB_LEADING_BYTE); };
+    static constexpr auto isTrailing = [](const CHAR_INFO& ci) { return WI_IsFlagSet(ci.Attributes, COMMON_LVB_TRAILING_BYTE); };
+    const auto lastColumn = _columnCount - 1;
+    size_t i = 0;
+
+    // The lead/trail flags aren't part of TextAttribute, so cells only differing in those belong to the same run.
+    for (size_t runBeg = 0; runBeg < count;)
+    {
+        const auto attr = til::at(charInfos, runBeg).Attributes & ~COMMON_LVB_SBCSDBCS;
+        auto runEnd = runBeg + 1;
+        for (; runEnd < count && (til::at(charInfos, runEnd).Attributes & ~COMMON_LVB_SBCSDBCS) == attr; ++runEnd)
+        {
+        }
+        _attr.replace(gsl::narrow_cast<uint16_t>(colBeg + runBeg), gsl::narrow_cast<uint16_t>(colBeg + runEnd), TextAttribute{ gsl::narrow_cast<WORD>(attr) });
+        runBeg = runEnd;
+    }
+
+    // See WriteCells(): A trailing half at the start of the request is commonly the result of a
+    // ReadConsoleOutputW() backup that intersected a wide glyph. We restore the entire glyph.
+    if (const auto& first = til::at(charInfos, 0); isTrailing(first))
+    {
+        if (colBeg == 0)
+        {
+            ClearCell(0);
+        }
+        else
+        {
+            ReplaceCharacters(colBeg - 1, 2, { &first.Char.UnicodeChar, 1 });
+        }
+        i = 1;
+    }
+
+    til::small_vector<wchar_t, 256> text;
+
+    while (i < count)
+    {
+        // Collect the text of the longest run of single cells and complete lead/trail pairs.
+        const auto runBeg = i;
+        text.clear();
+        for (; i < count; ++i)
+        {
+            const auto& ci = til::at(charInfos, i);
+            if (isLeading(ci))
+            {
+                if (i + 1 >= count || !isTrailing(til::at(charInfos, i + 1)))
+                {
+                    break;
+                }
+                ++i;
+            }
+            else if (isTrailing(ci))
+            {
+                break;
+            }
+            text.push_back(ci.Char.UnicodeChar);
+        }
+
+        if (i > runBeg)
+        {
+            const std::wstring_view chars{ text.data(), text.size() };
+            WriteHelper h{ *this, gsl::narrow_cast<til::CoordType>(colBeg + runBeg), _columnCount, chars };
+            if (h.IsValid())
+            {
+                h.ReplaceCharInfos(charInfos.subspan(runBeg, i - runBeg));
+                h.Finish();
+            }
+        }
+
+        if (i >= count)
+        {
+            break;
+        }
+
+        // A leading half without its trailing half or an orphaned trailing half. WriteCells() writes the former
+        // as a wide glyph (or as padding whitespace in the last column) and ignores the latter.
+        if (const auto& ci = til::at(charInfos, i); isLeading(ci))
+        {
+            const auto col = gsl::narrow_cast<til::CoordType>(colBeg + i);
+            if (col == lastColumn)
+            {
+                ClearCell(col);
+                SetDoubleBytePadded(true);
+            }
+            else
+            {
+                ReplaceCharacters(col, 2, { &ci.Char.UnicodeChar, 1 });
+            }
+        }
+        ++i;
+    }
+
+    return gsl::narrow_cast<til::CoordType>(colBeg + count);
+}
+catch (...)
+{
+    Reset(TextAttribute{});
+    throw;
+}
+
 void ROW::SetAttrToEnd(const til::CoordType columnBegin, const TextAttribute attr)
 {
     _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), attr);
@@ -590,6 +956,26 @@ catch (...)
     }
 }
 
+// Writes the offsets for a run of CHAR_INFOs that consists of single cells and complete lead/trail pairs.
+// `chars` contains 1 character for each single cell and pair, and the run always fits into the row.
+[[msvc::forceinline]] void ROW::WriteHelper::ReplaceCharInfos(const std::span<const CHAR_INFO> charInfos) noexcept
+{
+    auto ch = chBeg;
+
+    for (size_t i = 0; i < charInfos.size(); ++i, ++ch)
+    {
+        til::at(row._charOffsets, colEnd++) = ch;
+        if (WI_IsFlagSet(til::at(charInfos, i).Attributes, COMMON_LVB_LEADING_BYTE))
+        {
+            til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch | CharOffsetsTrailer);
+            ++i;
+        }
+    }
+
+    colEndDirty = colEnd;
+    charsConsumed = chars.size();
+}
+
 void ROW::ReplaceText(RowWriteState& state)
 try
 {
@@ -621,28 +1007,100 @@ catch (...)
     throw;
 }
 
+// Fills [columnBegin, columnLimit) with copies of state.text, which must be a single narrow character.
+// Unlike repeatedly calling ReplaceText(), the layout of the filled range is known upfront (1 char per column),
+// so the chars are written with a single fill and the char offsets are generated arithmetically.
+// Wide glyphs that are cut in half by either end of the range get replaced with whitespace.
+void ROW::FillText(RowWriteState& state)
+try
+{
+    const auto colBeg = _clampedColumnInclusive(state.columnBegin);
+    const auto colEnd = std::max(colBeg, _clampedColumnInclusive(state.columnLimit));
+
+    if (colBeg == colEnd || state.text.size() != 1)
+    {
+        state.columnEnd = colBeg;
+        state.columnBeginDirty = colBeg;
+        state.columnEndDirty = colBeg;
+        return;
+    }
+
+    const auto colBegDirty = _adjustBackward(colBeg);
+    const auto colEndDirty = _adjustForward(colEnd);
+    const auto leadingSpaces = gsl::narrow_cast<uint16_t>(colBeg - colBegDirty);
+    const auto trailingSpaces = gsl::narrow_cast<uint16_t>(colEndDirty - colEnd);
+    const auto chBegDirty = _uncheckedCharOffset(colBegDirty);
+
+    if (colBegDirty == 0 && colEndDirty == _columnCount)
+    {
+        // Filling the entire row (the most common case by far: clearing the screen) doesn't need
+        // to preserve any existing text, so we can return to the inline buffer, just like Reset().
+        _charsHeap.reset();
+        _chars = { _charsBuffer, _columnCount };
+        til::at(_charOffsets, _columnCount) = _columnCount;
+    }
+    else
+    {
+        const auto chEndDirtyOld = _uncheckedCharOffset(colEndDirty);
+        const size_t chEndDirty = chBegDirty + colEndDirty - colBegDirty;
+        if (chEndDirty != chEndDirtyOld)
+        {
+            _resizeChars(colEndDirty, chBegDirty, chEndDirty, chEndDirtyOld);
+        }
+    }
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto chars = _chars.data() + chBegDirty;
+    const auto offsets = _charOffsets.data() + colBegDirty;
+    fill_n_small(chars, leadingSpaces, L' ');
+    fill_n_chars(chars + leadingSpaces, colEnd - colBeg, state.text.front());
+    fill_n_small(chars + leadingSpaces + (colEnd - colBeg), trailingSpaces, L' ');
+    iota_n_offsets(offsets, colEndDirty - colBegDirty, chBegDirty);
+#pragma warning(pop)
+
+    // See WriteHelper::Finish().
+    if (colEndDirty == _columnCount)
+    {
+        SetDoubleBytePadded(colEnd < _columnCount);
+    }
+    _eraseImageCells(colBegDirty, colEndDirty);
+
+    state.columnEnd = colEnd;
+    state.columnBeginDirty = colBegDirty;
+    state.columnEndDirty = colEndDirty;
+}
+catch (...)
+{
+    Reset(TextAttribute{});
+    throw;
+}
+
 [[msvc::forceinline]] void ROW::WriteHelper::ReplaceText() noexcept
 {
     // This function starts with a fast-pass for ASCII. ASCII is still predominant in technical areas.
     //
     // We can infer the "end" from the amount of columns we're given (colLimit - colBeg),
     // because ASCII is always 1 column wide per character.
-    auto it = chars.begin();
-    const auto end = it + std::min<size_t>(chars.size(), colLimit - colBeg);
-    size_t ch = chBeg;
+    const auto limit = std::min<size_t>(chars.size(), colLimit - colBeg);
+    auto ascii = CountLeadingAscii(chars.substr(0, limit));
 
-    while (it != end)
+    // The last ASCII character may be the base of a grapheme cluster that continues past it,
+    // like an "e" followed by U+0301 COMBINING ACUTE ACCENT. Those are left to _replaceTextUnicode.
+    if (ascii != 0 && ascii < chars.size() && !til::utf16_is_grapheme_trivial(til::at(chars, ascii)))
     {
-        if (*it >= 0x80) [[unlikely]]
-        {
-            _replaceTextUnicode(ch, it);
-            return;
-        }
+        --ascii;
+    }
 
-        til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
-        ++colEnd;
-        ++ch;
-        ++it;
+    // Each ASCII character maps to exactly 1 column, so the char offsets are simply chBeg, chBeg+1, ...
+    // The characters themselves are memcpy'd into the row by Finish() in one go.
+    size_t ch = iota_n_offsets(row._charOffsets.data() + colEnd, ascii, chBeg);
+    colEnd = gsl::narrow_cast<uint16_t>(colEnd + ascii);
+
+    if (ascii != limit) [[unlikely]]
+    {
+        _replaceTextUnicode(ch, chars.begin() + ascii);
+        return;
     }
 
     colEndDirty = colEnd;
@@ -651,11 +1109,15 @@ catch (...)
 
 [[msvc::forceinline]] void ROW::WriteHelper::_replaceTextUnicode(size_t ch, std::wstring_view::const_iterator it) noexcept
 {
+    const auto beg = chars.begin();
     const auto end = chars.end();
+    // The code units before trivialEnd are known to be grapheme clusters of their own. See til::utf16_count_grapheme_trivial.
+    auto trivialEnd = it;
 
     while (it != end)
     {
         unsigned int width = 1;
+        const auto clusterBeg = it;
         auto ptr = &*it;
         const auto wch = *ptr;
         size_t advance = 1;
@@ -682,6 +1144,21 @@ catch (...)
             width = IsGlyphFullWidth({ ptr, advance }) + 1u;
         }
 
+        // Combining marks, emoji ZWJ sequences, etc. are joined with the preceding codepoint into a single cluster,
+        // which occupies as many columns as its first codepoint. Segmenting the text is skipped for the trivial
+        // runs that plain text consists of, because only the last code unit of such a run may get joined with its successor.
+        if (it != end && it >= trivialEnd)
+        {
+            trivialEnd = clusterBeg + til::utf16_count_grapheme_trivial({ clusterBeg, end });
+            if (it >= trivialEnd)
+            {
+                const auto offset = gsl::narrow_cast<size_t>(clusterBeg - beg);
+                const auto next = til::utf16_grapheme_next(chars, offset);
+                advance = next - offset;
+                it = beg + next;
+            }
+        }
+
         const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + width);
         if (colEndNew > colLimit)
         {
@@ -759,6 +1236,74 @@ catch (...)
     throw;
 }
 
+// Copies the columns [sourceColumnBegin, sourceColumnLimit) of the source row, text and attributes alike,
+// to the columns starting at columnBegin. Unlike CopyTextFrom() this copies columns and not glyphs:
+// Wide glyphs that are cut in half by either end of the source range are replaced with whitespace,
+// which ensures that the copied range is exactly as wide as the source range (or the target range,
+// whichever is smaller). This makes it suitable for moving rectangular blocks of cells around.
+// Just like CopyTextFrom() it can't be used to copy a row onto itself.
+void ROW::CopyCellsFrom(RowCopyTextFromState& state)
+{
+    const auto& source = state.source;
+    const til::CoordType sourceColBeg = source._clampedColumnInclusive(state.sourceColumnBegin);
+    const til::CoordType sourceColLimit = source._clampedColumnInclusive(state.sourceColumnLimit);
+    const til::CoordType colBeg = _clampedColumnInclusive(state.columnBegin);
+    const til::CoordType colLimit = _clampedColumnInclusive(state.columnLimit);
+    const auto width = std::min(colLimit - colBeg, sourceColLimit - sourceColBeg);
+
+    state.columnEnd = colBeg;
+    state.columnBeginDirty = colBeg;
+    state.columnEndDirty = colBeg;
+    state.sourceColumnEnd = sourceColBeg;
+
+    if (width <= 0 || this == &source)
+    {
+        return;
+    }
+
+    RowCopyTextFromState textState{
+        .source = source,
+        .columnBegin = colBeg,
+        .columnLimit = colBeg + width,
+        .sourceColumnBegin = sourceColBeg,
+        .sourceColumnLimit = sourceColBeg + width,
+    };
+    auto dirtyBeg = til::CoordTypeMax;
+    auto dirtyEnd = colBeg;
+
+    // CopyTextFrom() refuses to begin copying in the middle of a wide glyph.
+    // We replace its orphaned trailing half with whitespace instead.
+    if (source._uncheckedIsTrailer(sourceColBeg))
+    {
+        RowWriteState writeState{
+            .text = L" ",
+            .columnBegin = colBeg,
+            .columnLimit = colBeg + 1,
+        };
+        ReplaceText(writeState);
+        dirtyBeg = writeState.columnBeginDirty;
+        dirtyEnd = writeState.columnEndDirty;
+        textState.columnBegin++;
+        textState.sourceColumnBegin++;
+    }
+
+    if (textState.columnBegin < textState.columnLimit)
+    {
+        CopyTextFrom(textState);
+        dirtyBeg = std::min(dirtyBeg, textState.columnBeginDirty);
+        dirtyEnd = std::max(dirtyEnd, textState.columnEndDirty);
+    }
+
+    // The copied text retains its column widths, so the attributes map 1:1 onto the target columns.
+    const auto colEnd = colBeg + width;
+    _attr.replace(gsl::narrow_cast<uint16_t>(colBeg), gsl::narrow_cast<uint16_t>(colEnd), source._attr.slice(gsl::narrow_cast<uint16_t>(sourceColBeg), gsl::narrow_cast<uint16_t>(sourceColBeg + width)));
+
+    state.columnEnd = colEnd;
+    state.columnBeginDirty = dirtyBeg;
+    state.columnEndDirty = std::max(dirtyEnd, colEnd);
+    state.sourceColumnEnd = sourceColBeg + width;
+}
+
 [[msvc::forceinline]] void ROW::WriteHelper::CopyTextFrom(const std::span<const uint16_t>& charOffsets) noexcept
 {
     // Since our `charOffsets` input is already in columns (just like the `ROW::_charOffsets`),
@@ -847,6 +1392,9 @@ catch (...)
     {
         row.SetDoubleBytePadded(colEnd < row._columnCount);
     }
+
+    // Text that gets written on top of an image replaces it.
+    row._eraseImageCells(colBegDirty, colEndDirty);
 }
 
 // This function represents the slow path of ReplaceCharacters(),
@@ -886,16 +1434,59 @@ void ROW::_resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDi
     }
 }
 
-til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() noexcept
+RowAttributes& ROW::Attributes() noexcept
 {
     return _attr;
 }
 
-const til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() const noexcept
+const RowAttributes& ROW::Attributes() const noexcept
 {
     return _attr;
 }
 
+const ImageSlice::Pointer& ROW::GetImageSlice() const noexcept
+{
+    return _imageSlice;
+}
+
+// Returns the image slice of this row for modification, creating it if needed. If the current
+// slice is shared with another ROW or the renderer, it gets copied first (copy-on-write).
+// If the existing slice uses a different cell size, it's replaced with an empty one.
+ImageSlice& ROW::GetMutableImageSlice(const til::size cellSize)
+{
+    if (!_imageSlice || _imageSlice->CellSize() != cellSize)
+    {
+        _imageSlice = std::make_shared<ImageSlice>(cellSize);
+    }
+    else if (_imageSlice.use_count() > 1)
+    {
+        _imageSlice = std::make_shared<ImageSlice>(*_imageSlice);
+    }
+    return *_imageSlice;
+}
+
+void ROW::SetImageSlice(ImageSlice::Pointer imageSlice) noexcept
+{
+    _imageSlice = std::move(imageSlice);
+}
+
+void ROW::_eraseImageCells(const til::CoordType columnBegin, const til::CoordType columnEnd)
+{
+    if (!_imageSlice || columnBegin >= _imageSlice->ColumnEnd() || columnEnd <= _imageSlice->ColumnOffset())
+    {
+        return;
+    }
+
+    if (_imageSlice.use_count() > 1)
+    {
+        _imageSlice = std::make_shared<ImageSlice>(*_imageSlice);
+    }
+    if (_imageSlice->EraseCells(columnBegin, columnEnd))
+    {
+        _imageSlice.reset();
+    }
+}
+
 TextAttribute ROW::GetAttrByColumn(const til::CoordType column) const
 {
     return _attr.at(_clampedUint16(column));
@@ -1015,6 +1606,95 @@ DbcsAttribute ROW::DbcsAttrAt(til::CoordType column) const noexcept
     return { attr };
 }
 
+// The implementation of ExportCharInfos() and ExportLegacyAttributes(). Instead of constructing an
+// OutputCellView for every cell, this walks the attribute runs and then the glyphs once each:
+// Each run is converted to its legacy attributes only once, every column of a wide glyph
+// is flagged as its leading or trailing half, and glyphs that don't fit into a single
+// UTF-16 code unit turn into U+FFFD, the same as CONSOLE_INFORMATION::AsCharInfo().
+template<typename T>
+size_t ROW::_exportCells(const til::CoordType columnBegin, const std::span<T> target) const noexcept
+{
+    static constexpr auto attributes = [](T& cell) noexcept -> WORD& {
+        if constexpr (std::is_same_v<T, CHAR_INFO>)
+        {
+            return cell.Attributes;
+        }
+        else
+        {
+            return cell;
+        }
+    };
+
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+    const auto count = std::min<size_t>(target.size(), _columnCount - colBeg);
+    const auto colEnd = gsl::narrow_cast<uint16_t>(colBeg + count);
+
+    uint16_t runBeg = 0;
+    for (const auto& run : _attr.runs())
+    {
+        if (runBeg >= colEnd)
+        {
+            break;
+        }
+
+        const auto runEnd = gsl::narrow_cast<uint16_t>(runBeg + run.length);
+        if (runEnd > colBeg)
+        {
+            const auto legacyAttributes = run.value.GetLegacyAttributes();
+            for (auto col = std::max(runBeg, colBeg), end = std::min(runEnd, colEnd); col < end; ++col)
+            {
+                attributes(til::at(target, col - colBeg)) = legacyAttributes;
+            }
+        }
+        runBeg = runEnd;
+    }
+
+    // A trailing half at colBeg belongs to a glyph that starts before it.
+    for (auto col = _adjustBackward(colBeg); col < colEnd;)
+    {
+        const auto glyphBeg = col;
+        const auto chBeg = _uncheckedCharOffset(col);
+        while (_uncheckedIsTrailer(++col))
+        {
+        }
+        const auto chEnd = _uncheckedCharOffset(col);
+        const auto wide = col - glyphBeg > 1;
+        const auto ch = chEnd - chBeg == 1 ? _uncheckedChar(chBeg) : UNICODE_REPLACEMENT;
+
+        for (auto c = std::max(glyphBeg, colBeg), end = std::min(col, colEnd); c < end; ++c)
+        {
+            auto& cell = til::at(target, c - colBeg);
+            if (wide)
+            {
+                attributes(cell) |= GeneratePublicApiAttributeFormat(c == glyphBeg ? DbcsAttribute::Leading : DbcsAttribute::Trailing);
+            }
+            if constexpr (std::is_same_v<T, CHAR_INFO>)
+            {
+                cell.Char.UnicodeChar = ch;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Fills target with the cells starting at columnBegin, the way ReadConsoleOutputW() returns them.
+// Return Value:
+// - The number of cells that were filled in. It's less than target.size() if the row ends first.
+size_t ROW::ExportCharInfos(const til::CoordType columnBegin, const std::span<CHAR_INFO> target) const noexcept
+{
+    return _exportCells(columnBegin, target);
+}
+
+// Fills target with the attributes of the cells starting at columnBegin, including the
+// leading/trailing byte flags, the way ReadConsoleOutputAttribute() returns them.
+// Return Value:
+// - The number of cells that were filled in. It's less than target.size() if the row ends first.
+size_t ROW::ExportLegacyAttributes(const til::CoordType columnBegin, const std::span<WORD> target) const noexcept
+{
+    return _exportCells(columnBegin, target);
+}
+
 std::wstring_view ROW::GetText() const noexcept
 {
     const auto width = size_t{ til::at(_charOffsets, GetReadableColumnCount()) } & CharOffsetsMask;
@@ -1042,24 +1722,89 @@ til::CoordType ROW::GetTrailingColumnAtCharOffset(const ptrdiff_t offset) const
     return _createCharToColumnMapper(offset).GetTrailingColumnAt(offset);
 }
 
-DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
+DelimiterClassTable::DelimiterClassTable(const std::wstring_view wordDelimiters) :
+    _delimiters{ wordDelimiters }
+{
+    for (size_t ch = 0; ch < _table.size(); ++ch)
+    {
+        til::at(_table, ch) = ch <= L' ' ? DelimiterClass::ControlChar : DelimiterClass::RegularChar;
+    }
+    for (const auto ch : wordDelimiters)
+    {
+        if (ch >= _table.size())
+        {
+            _wideDelimiters.push_back(ch);
+        }
+        else if (ch > L' ')
+        {
+            til::at(_table, ch) = DelimiterClass::DelimiterChar;
+        }
+    }
+}
+
+DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const DelimiterClassTable& classes) const noexcept
 {
     const auto col = _clampedColumn(column);
     // Safety: col is [0, _columnCount).
-    const auto glyph = _uncheckedChar(_uncheckedCharOffset(col));
+    return classes.Classify(_uncheckedChar(_uncheckedCharOffset(col)));
+}
 
-    if (glyph <= L' ')
-    {
-        return DelimiterClass::ControlChar;
-    }
-    else if (wordDelimiters.find(glyph) != std::wstring_view::npos)
+// Returns the first column of the run of glyphs that have the same DelimiterClass as the one at the given column.
+// Instead of classifying one column at a time, this scans the row's text and only maps
+// the offset back to a column once it found a char of a different class.
+til::CoordType ROW::DelimiterClassRunBegin(til::CoordType column, const DelimiterClassTable& classes) const noexcept
+{
+    const auto col = _clampedColumn(column);
+    const auto text = GetText(0, _columnCount);
+    // Safety: col is [0, _columnCount).
+    const ptrdiff_t beg = _uncheckedCharOffset(col);
+    const auto cls = classes.Classify(til::at(text, beg));
+    auto mapper = _createCharToColumnMapper(beg);
+
+    for (auto off = beg - 1; off >= 0; --off)
     {
-        return DelimiterClass::DelimiterChar;
+        if (classes.Classify(til::at(text, off)) == cls)
+        {
+            continue;
+        }
+        // The class of a glyph is that of its first char. If off is in the middle of
+        // a glyph (for instance a combining mark) we have to keep going until we find its start.
+        const auto leading = mapper.GetLeadingColumnAt(off);
+        if (_uncheckedCharOffset(gsl::narrow_cast<size_t>(leading)) == off)
+        {
+            return mapper.GetTrailingColumnAt(off) + 1;
+        }
     }
-    else
+
+    return 0;
+}
+
+// Returns the column past the last column of the run of glyphs that have the same DelimiterClass as the one at
+// the given column. It's _columnCount if the run extends to the end of the row. See DelimiterClassRunBegin().
+til::CoordType ROW::DelimiterClassRunEnd(til::CoordType column, const DelimiterClassTable& classes) const noexcept
+{
+    const auto col = _clampedColumn(column);
+    const auto text = GetText(0, _columnCount);
+    // Safety: col is [0, _columnCount).
+    const ptrdiff_t beg = _uncheckedCharOffset(col);
+    const auto cls = classes.Classify(til::at(text, beg));
+    const auto end = gsl::narrow_cast<ptrdiff_t>(text.size());
+    auto mapper = _createCharToColumnMapper(beg);
+
+    for (auto off = beg + 1; off < end; ++off)
     {
-        return DelimiterClass::RegularChar;
+        if (classes.Classify(til::at(text, off)) == cls)
+        {
+            continue;
+        }
+        const auto leading = mapper.GetLeadingColumnAt(off);
+        if (_uncheckedCharOffset(gsl::narrow_cast<size_t>(leading)) == off)
+        {
+            return leading;
+        }
     }
+
+    return _columnCount;
 }
 
 template<typename T>
@@ -5,6 +5,8 @@
 
 #include <til/rle.h>
 
+#include "AttributeArena.hpp"
+#include "ImageSlice.hpp"
 #include "LineRendition.hpp"
 #include "OutputCell.hpp"
 #include "OutputCellIterator.hpp"
@@ -12,6 +14,10 @@
 class ROW;
 class TextBuffer;
 
+// The run-length encoded attributes of a ROW, with 1 TextAttribute per column.
+// Rows with a simple, single attribute keep it inline. See AttributeArena for everything else.
+using RowAttributes = til::small_rle<TextAttribute, uint16_t, 1, AttributeArena::Allocator<til::rle_pair<TextAttribute, uint16_t>>>;
+
 enum class DelimiterClass
 {
     ControlChar,
@@ -19,6 +25,35 @@ enum class DelimiterClass
     RegularChar
 };
 
+// Maps characters to their DelimiterClass for a given set of word delimiters.
+// Word navigation classifies every cell it passes, which is why this is a lookup table and not a search
+// through the delimiters. Only characters outside of the table (which are rarely delimiters) fall back to one.
+class DelimiterClassTable
+{
+public:
+    explicit DelimiterClassTable(std::wstring_view wordDelimiters = {});
+
+    std::wstring_view Delimiters() const noexcept
+    {
+        return _delimiters;
+    }
+
+    DelimiterClass Classify(const wchar_t ch) const noexcept
+    {
+        if (ch < _table.size())
+        {
+            return til::at(_table, ch);
+        }
+        return _wideDelimiters.find(ch) != std::wstring::npos ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+    }
+
+private:
+    std::array<DelimiterClass, 256> _table{};
+    std::wstring _delimiters;
+    // The subset of _delimiters that doesn't fit into _table.
+    std::wstring _wideDelimiters;
+};
+
 struct RowWriteState
 {
     // The text you want to write into the given ROW. When ReplaceText() returns,
@@ -114,7 +149,7 @@ public:
     }
 
     ROW() = default;
-    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
+    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, AttributeArena* attributeArena = nullptr);
 
     ROW(const ROW& other) = delete;
     ROW& operator=(const ROW& other) = delete;
@@ -131,22 +166,30 @@ public:
     til::CoordType GetReadableColumnCount() const noexcept;
 
     void Reset(const TextAttribute& attr) noexcept;
-    void TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth);
+    void TransferAttributes(const RowAttributes& attr, til::CoordType newWidth);
     void CopyFrom(const ROW& source);
+    void Compress(std::vector<uint8_t>& out, TextAttributeTable* attributes = nullptr) const;
+    const uint8_t* Decompress(const uint8_t* data, const TextAttributeTable* attributes = nullptr);
 
     til::CoordType NavigateToPrevious(til::CoordType column) const noexcept;
     til::CoordType NavigateToNext(til::CoordType column) const noexcept;
 
     void ClearCell(til::CoordType column);
     OutputCellIterator WriteCells(OutputCellIterator it, til::CoordType columnBegin, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
+    til::CoordType WriteCharInfos(std::span<const CHAR_INFO> charInfos, til::CoordType columnBegin);
     void SetAttrToEnd(til::CoordType columnBegin, TextAttribute attr);
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
+    void FillText(RowWriteState& state);
     void CopyTextFrom(RowCopyTextFromState& state);
+    void CopyCellsFrom(RowCopyTextFromState& state);
 
-    til::small_rle<TextAttribute, uint16_t, 1>& Attributes() noexcept;
-    const til::small_rle<TextAttribute, uint16_t, 1>& Attributes() const noexcept;
+    RowAttributes& Attributes() noexcept;
+    const RowAttributes& Attributes() const noexcept;
+    const ImageSlice::Pointer& GetImageSlice() const noexcept;
+    ImageSlice& GetMutableImageSlice(til::size cellSize);
+    void SetImageSlice(ImageSlice::Pointer imageSlice) noexcept;
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
     uint16_t size() const noexcept;
@@ -155,11 +198,15 @@ public:
     bool ContainsText() const noexcept;
     std::wstring_view GlyphAt(til::CoordType column) const noexcept;
     DbcsAttribute DbcsAttrAt(til::CoordType column) const noexcept;
+    size_t ExportCharInfos(til::CoordType columnBegin, std::span<CHAR_INFO> target) const noexcept;
+    size_t ExportLegacyAttributes(til::CoordType columnBegin, std::span<WORD> target) const noexcept;
     std::wstring_view GetText() const noexcept;
     std::wstring_view GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
     til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     til::CoordType GetTrailingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
-    DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
+    DelimiterClass DelimiterClassAt(til::CoordType column, const DelimiterClassTable& classes) const noexcept;
+    til::CoordType DelimiterClassRunBegin(til::CoordType column, const DelimiterClassTable& classes) const noexcept;
+    til::CoordType DelimiterClassRunEnd(til::CoordType column, const DelimiterClassTable& classes) const noexcept;
 
     auto AttrBegin() const noexcept { return _attr.begin(); }
     auto AttrEnd() const noexcept { return _attr.end(); }
@@ -177,6 +224,7 @@ private:
         explicit WriteHelper(ROW& row, til::CoordType columnBegin, til::CoordType columnLimit, const std::wstring_view& chars) noexcept;
         bool IsValid() const noexcept;
         void ReplaceCharacters(til::CoordType width) noexcept;
+        void ReplaceCharInfos(std::span<const CHAR_INFO> charInfos) noexcept;
         void ReplaceText() noexcept;
         void _replaceTextUnicode(size_t ch, std::wstring_view::const_iterator it) noexcept;
         void CopyTextFrom(const std::span<const uint16_t>& charOffsets) noexcept;
@@ -222,6 +270,23 @@ private:
     static constexpr uint16_t CharOffsetsTrailer = 0x8000;
     static constexpr uint16_t CharOffsetsMask = 0x7fff;
 
+    // The fixed-size prefix of each row serialized by Compress().
+    struct CompressedHeader
+    {
+        // The number of wchar_t's that follow the header.
+        uint16_t charsLength;
+        // The number of _attr runs that follow the text.
+        uint16_t attrRuns;
+        LineRendition lineRendition;
+        bool wrapForced;
+        bool doubleBytePadded;
+        // If true, _charOffsets is 0123... and wasn't stored. The text was trimmed of trailing whitespace.
+        // Otherwise the text is followed by all _columnCount+1 _charOffsets.
+        bool simple;
+        // If true, the attributes of the runs are stored as TextAttributeTable handles.
+        bool interned;
+    };
+
     template<typename T>
     static constexpr uint16_t _clampedUint16(T v) noexcept;
     template<typename T>
@@ -240,9 +305,13 @@ private:
     T _adjustBackward(T column) const noexcept;
     template<typename T>
     T _adjustForward(T column) const noexcept;
+    template<typename T>
+    size_t _exportCells(til::CoordType columnBegin, std::span<T> target) const noexcept;
 
     void _init() noexcept;
+    void _eraseImageCells(til::CoordType columnBegin, til::CoordType columnEnd);
     void _resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld);
+    void _copyTextVerbatim(const ROW& source);
     CharToColumnMapper _createCharToColumnMapper(ptrdiff_t offset) const noexcept;
 
     // These fields are a bit "wasteful", but it makes all this a bit more robust against
@@ -287,7 +356,10 @@ private:
     std::span<uint16_t> _charOffsets;
     // _attr is a run-length-encoded vector of TextAttribute with a decompressed
     // length equal to _columnCount (= 1 TextAttribute per column).
-    til::small_rle<TextAttribute, uint16_t, 1> _attr;
+    RowAttributes _attr;
+    // The pixels of any inline images in this row, or nullptr (the most common case by far).
+    // It may be shared with other ROWs and the renderer. See ImageSlice.
+    ImageSlice::Pointer _imageSlice;
     // The width of the row in visual columns.
     uint16_t _columnCount = 0;
     // Stores double-width/height (DECSWL/DECDWL/DECDHL) attributes.
@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ScrollbackArchive.hpp"
+
+// Routine Description:
+// - Creates the archive and its backing file in the user's temporary directory.
+//   The file is deleted automatically once the archive is destroyed or the process exits.
+ScrollbackArchive::ScrollbackArchive()
+{
+    wchar_t directory[MAX_PATH + 1];
+    THROW_LAST_ERROR_IF(GetTempPathW(ARRAYSIZE(directory), &directory[0]) == 0);
+
+    wchar_t path[MAX_PATH + 1];
+    THROW_LAST_ERROR_IF(GetTempFileNameW(&directory[0], L"wts", 0, &path[0]) == 0);
+
+    _file.reset(CreateFileW(&path[0], GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr));
+    THROW_LAST_ERROR_IF(!_file);
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    _allocationGranularity = info.dwAllocationGranularity;
+}
+
+// Routine Description:
+// - Appends the serialized form of the given row to `out`, as it's stored in the archive.
+//   ROW::Compress() doesn't store the width, because TextBuffer knows it. We don't,
+//   because the TextBuffer may be resized, so we prefix the row with it.
+// Arguments:
+// - row - The row to serialize.
+// - out - The vector to append to.
+void ScrollbackArchive::SerializeRow(const ROW& row, std::vector<uint8_t>& out)
+{
+    const auto width = row.size();
+    const auto offset = out.size();
+    out.resize(offset + sizeof(width));
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    memcpy(out.data() + offset, &width, sizeof(width));
+    row.Compress(out);
+}
+
+// Routine Description:
+// - Overwrites the given row with the contents of a row serialized by SerializeRow().
+// Arguments:
+// - data - The serialized row.
+// - row - The row to fill. It may have a different width than the serialized one, in which case
+//   the serialized contents are copied from the left and truncated or padded as with ROW::CopyFrom().
+// - scratch - Storage for a temporary ROW of the serialized width. It's reused across calls.
+// Return Value:
+// - A pointer past the end of the serialized row.
+const uint8_t* ScrollbackArchive::DeserializeRow(const uint8_t* data, ROW& row, std::vector<RowBufferChunk>& scratch)
+{
+    uint16_t width;
+    memcpy(&width, data, sizeof(width));
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    data += sizeof(width);
+
+    // ROW::Decompress() has to write into a ROW of the serialized width,
+    // so we construct one in `scratch` and copy its contents over.
+    const auto charsSize = ROW::CalculateCharsBufferSize(width);
+    const auto charOffsetsSize = ROW::CalculateCharOffsetsBufferSize(width);
+    scratch.resize((charsSize + charOffsetsSize) / sizeof(RowBufferChunk));
+
+    const auto chars = reinterpret_cast<wchar_t*>(scratch.data());
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto charOffsets = reinterpret_cast<uint16_t*>(reinterpret_cast<std::byte*>(scratch.data()) + charsSize);
+    ROW scratchRow{ chars, charOffsets, width, TextAttribute{} };
+    const auto end = scratchRow.Decompress(data);
+
+    row.CopyFrom(scratchRow);
+    row.SetDoubleBytePadded(scratchRow.WasDoubleBytePadded());
+    return end;
+}
+
+// Routine Description:
+// - Returns the number of rows stored in the archive.
+size_t ScrollbackArchive::size() const noexcept
+{
+    return _offsets.size();
+}
+
+// Routine Description:
+// - Appends the given row to the end of the archive.
+// Arguments:
+// - row - The row to store. It's usually the one that's about to be evicted from the TextBuffer.
+void ScrollbackArchive::Append(const ROW& row)
+{
+    _serialized.clear();
+    SerializeRow(row, _serialized);
+
+    _offsets.emplace_back(_fileSize);
+
+    DWORD written = 0;
+    const auto ok = WriteFile(_file.get(), _serialized.data(), gsl::narrow<DWORD>(_serialized.size()), &written, nullptr);
+    if (!ok || written != _serialized.size())
+    {
+        _offsets.pop_back();
+        THROW_LAST_ERROR();
+    }
+
+    _fileSize += written;
+}
+
+// Routine Description:
+// - Overwrites the given row with the contents of the archived row at the given index.
+// Arguments:
+// - index - The index of the row, where 0 is the oldest one. Must be less than size().
+// - row - The row to fill. It may have a different width than the archived one, in which case
+//   the archived contents are copied from the left and truncated or padded as with ROW::CopyFrom().
+void ScrollbackArchive::Read(const size_t index, ROW& row)
+{
+    const auto beg = til::at(_offsets, index);
+    const auto end = index + 1 < _offsets.size() ? til::at(_offsets, index + 1) : _fileSize;
+    DeserializeRow(_map(beg, end), row, _scratch);
+}
+
+// Returns a pointer to the contents of the file at offset `beg`, ensuring that everything up to `end` is mapped.
+const uint8_t* ScrollbackArchive::_map(const uint64_t beg, const uint64_t end)
+{
+    if (beg < _viewBegin || end > _viewEnd)
+    {
+        _view.reset();
+
+        if (end > _mappingSize)
+        {
+            _mapping.reset(CreateFileMappingW(_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+            THROW_LAST_ERROR_IF(!_mapping);
+            _mappingSize = _fileSize;
+        }
+
+        // The view offset must be a multiple of the allocation granularity.
+        const auto viewBegin = beg - beg % _allocationGranularity;
+        const auto viewEnd = std::min(_mappingSize, std::max(end, viewBegin + _viewSize));
+
+        _view.reset(static_cast<uint8_t*>(MapViewOfFile(_mapping.get(), FILE_MAP_READ, static_cast<DWORD>(viewBegin >> 32), static_cast<DWORD>(viewBegin), gsl::narrow<size_t>(viewEnd - viewBegin))));
+        THROW_LAST_ERROR_IF(!_view);
+
+        _viewBegin = viewBegin;
+        _viewEnd = viewEnd;
+    }
+
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    return _view.get() + (beg - _viewBegin);
+}
@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "Row.hpp"
+
+// ScrollbackArchive stores the rows that TextBuffer evicts from its circular buffer in an append-only
+// temporary file, which allows a session to retain its history past the size of the TextBuffer.
+// Rows are serialized via ROW::Compress() and are paged back in via a memory mapped view of the file.
+class ScrollbackArchive final
+{
+public:
+    ScrollbackArchive();
+
+    // A small alignment-providing unit to allocate the buffers of the scratch ROW in DeserializeRow(),
+    // because ROW requires that its buffers are 16-byte aligned.
+    struct alignas(16) RowBufferChunk
+    {
+        std::byte data[16];
+    };
+
+    static void SerializeRow(const ROW& row, std::vector<uint8_t>& out);
+    static const uint8_t* DeserializeRow(const uint8_t* data, ROW& row, std::vector<RowBufferChunk>& scratch);
+
+    size_t size() const noexcept;
+    void Append(const ROW& row);
+    void Read(size_t index, ROW& row);
+
+private:
+    const uint8_t* _map(uint64_t beg, uint64_t end);
+
+    // We map views of about this size, so that reading the rows in sequence doesn't map each of them individually.
+    static constexpr uint64_t _viewSize = 1024 * 1024;
+
+    wil::unique_hfile _file;
+    // _offsets[i] is the offset in _file at which row i starts. _fileSize is where the next row will start.
+    std::vector<uint64_t> _offsets;
+    uint64_t _fileSize = 0;
+    // Reused across calls to Append() to serialize the rows.
+    std::vector<uint8_t> _serialized;
+
+    // The mapping is created lazily and recreated whenever a row beyond _mappingSize is read.
+    wil::unique_handle _mapping;
+    uint64_t _mappingSize = 0;
+    wil::unique_mapview_ptr<uint8_t> _view;
+    uint64_t _viewBegin = 0;
+    uint64_t _viewEnd = 0;
+    uint64_t _allocationGranularity = 0;
+
+    std::vector<RowBufferChunk> _scratch;
+};
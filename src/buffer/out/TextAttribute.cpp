@@ -406,3 +406,51 @@ void TextAttribute::SetStandardErase() noexcept
     _attrs = CharacterAttributes::Normal;
     _hyperlinkId = 0;
 }
+
+// Routine Description:
+// - Returns the handle for the given attribute, adding it to the table if needed.
+// Return Value:
+// - The handle, or std::nullopt if the table already holds 65536 distinct attributes.
+std::optional<uint16_t> TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    if (const auto it = _handles.find(attr); it != _handles.end())
+    {
+        return it->second;
+    }
+
+    if (_attributes.size() > UINT16_MAX)
+    {
+        return std::nullopt;
+    }
+
+    const auto handle = gsl::narrow_cast<uint16_t>(_attributes.size());
+    _attributes.emplace_back(attr);
+    try
+    {
+        _handles.emplace(attr, handle);
+    }
+    catch (...)
+    {
+        _attributes.pop_back();
+        throw;
+    }
+    return handle;
+}
+
+// Routine Description:
+// - Returns the attribute for a handle previously returned by Intern().
+const TextAttribute& TextAttributeTable::Lookup(const uint16_t handle) const
+{
+    return til::at(_attributes, handle);
+}
+
+size_t TextAttributeTable::size() const noexcept
+{
+    return _attributes.size();
+}
+
+void TextAttributeTable::clear() noexcept
+{
+    _attributes.clear();
+    _handles.clear();
+}
@@ -191,6 +191,29 @@ enum class TextAttributeBehavior
     StoredOnly, // only use the contained text attribute and skip the insertion of anything else
 };
 
+// Interns TextAttributes, mapping each distinct one to a 16-bit handle.
+// TextBuffer uses this to store the attribute runs of its compressed ROWs as handles.
+class TextAttributeTable final
+{
+public:
+    std::optional<uint16_t> Intern(const TextAttribute& attr);
+    const TextAttribute& Lookup(uint16_t handle) const;
+    size_t size() const noexcept;
+    void clear() noexcept;
+
+private:
+    struct Hash
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept
+        {
+            return til::hash(&attr, sizeof(attr));
+        }
+    };
+
+    std::vector<TextAttribute> _attributes;
+    std::unordered_map<TextAttribute, uint16_t, Hash> _handles;
+};
+
 #ifdef UNIT_TESTING
 
 #define LOG_ATTR(attr) (Log::Comment(NoThrowString().Format( \
@@ -12,6 +12,22 @@ struct RowRange
     til::CoordType end;
 };
 
+// ICU calls utextAccess() whenever it leaves the current chunk. Handing out single rows results in one call
+// per row, which is why consecutive rows are copied into this scratch buffer and handed out as a single chunk.
+// It lives in UText::pExtra, which utext_setup() allocates for us, so that each clone gets its own.
+struct ChunkCache
+{
+    static constexpr til::CoordType maxRows = 256;
+    static constexpr int32_t maxLength = 16 * 1024;
+
+    // The current chunk consists of the rows [rowBeg,rowEnd). rowOffsets[i] is the offset
+    // within the chunk at which row rowBeg+i starts. rowOffsets[rowEnd-rowBeg] is the chunk length.
+    til::CoordType rowBeg;
+    til::CoordType rowEnd;
+    int32_t rowOffsets[maxRows + 1];
+    char16_t text[maxLength];
+};
+
 constexpr size_t& accessLength(UText* ut) noexcept
 {
     return *std::bit_cast<size_t*>(&ut->p);
@@ -22,9 +38,65 @@ constexpr RowRange& accessRowRange(UText* ut) noexcept
     return *std::bit_cast<RowRange*>(&ut->a);
 }
 
-constexpr til::CoordType& accessCurrentRow(UText* ut) noexcept
+static ChunkCache& accessChunkCache(const UText* ut) noexcept
+{
+    return *static_cast<ChunkCache*>(ut->pExtra);
+}
+
+// Returns the length of the text in the given row. See utextAccess().
+static int64_t rowLength(const TextBuffer& textBuffer, til::CoordType y)
+{
+    return gsl::narrow_cast<int64_t>(textBuffer.GetRowByOffset(y).GetText().size());
+}
+
+// Turns the rows [beg,end) into the current chunk, which starts at nativeStart. A single row is handed out
+// as is, because the row's text is already contiguous, while multiple rows are copied into the ChunkCache.
+static void fillChunk(UText* ut, const TextBuffer& textBuffer, til::CoordType beg, til::CoordType end, int64_t nativeStart)
+{
+    auto& cache = accessChunkCache(ut);
+    const char16_t* contents = &cache.text[0];
+    int32_t length = 0;
+
+    for (auto y = beg; y < end; ++y)
+    {
+        const auto text = textBuffer.GetRowByOffset(y).GetText();
+        til::at(cache.rowOffsets, y - beg) = length;
+
+        if (end - beg == 1)
+        {
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+            contents = reinterpret_cast<const char16_t*>(text.data());
+        }
+        else
+        {
+            memcpy(&til::at(cache.text, length), text.data(), text.size() * sizeof(char16_t));
+        }
+
+        length += gsl::narrow_cast<int32_t>(text.size());
+    }
+
+    til::at(cache.rowOffsets, end - beg) = length;
+    cache.rowBeg = beg;
+    cache.rowEnd = end;
+
+    ut->chunkNativeStart = nativeStart;
+    ut->chunkNativeLimit = nativeStart + length;
+    ut->chunkLength = length;
+    ut->chunkContents = contents;
+    ut->nativeIndexingLimit = length;
+}
+
+// Returns the row that contains the given offset into the current chunk.
+static til::CoordType rowAtChunkOffset(const UText* ut, int32_t& offset) noexcept
 {
-    return ut->b;
+    const auto& cache = accessChunkCache(ut);
+    const auto beg = &cache.rowOffsets[0];
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto end = beg + (cache.rowEnd - cache.rowBeg);
+    // The last row whose offset is <= the given one. upper_bound() can't return beg, because rowOffsets[0] is 0.
+    const auto it = std::upper_bound(beg, end, offset) - 1;
+    offset -= *it;
+    return cache.rowBeg + gsl::narrow_cast<til::CoordType>(it - beg);
 }
 
 // An excerpt from the ICU documentation:
@@ -55,10 +127,21 @@ static UText* U_CALLCONV utextClone(UText* dest, const UText* src, UBool deep, U
         return dest;
     }
 
-    dest = utext_setup(dest, 0, status);
+    dest = utext_setup(dest, src->extraSize, status);
     if (*status <= U_ZERO_ERROR)
     {
+        // Everything but the ownership of the UText and the ChunkCache is copied verbatim.
+        const auto flags = dest->flags;
+        const auto extra = dest->pExtra;
         memcpy(dest, src, sizeof(UText));
+        dest->flags = flags;
+        dest->pExtra = extra;
+        memcpy(extra, src->pExtra, sizeof(ChunkCache));
+
+        if (src->chunkContents == &accessChunkCache(src).text[0])
+        {
+            dest->chunkContents = &accessChunkCache(dest).text[0];
+        }
     }
 
     return dest;
@@ -122,53 +205,79 @@ try
         neededIndex--;
     }
 
-    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
-    const auto range = accessRowRange(ut);
     auto start = ut->chunkNativeStart;
-    auto limit = ut->chunkNativeLimit;
-    auto y = accessCurrentRow(ut);
-    std::wstring_view text;
 
-    if (neededIndex < start || neededIndex >= limit)
+    if (neededIndex < start || neededIndex >= ut->chunkNativeLimit)
     {
+        const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
+        const auto range = accessRowRange(ut);
+        const auto& cache = accessChunkCache(ut);
+        auto beg = cache.rowBeg;
+        auto end = cache.rowEnd;
+        int64_t length = 0;
+
         if (neededIndex < start)
         {
+            // Find the row containing neededIndex...
             do
             {
-                --y;
-                if (y < range.begin)
+                if (beg <= range.begin)
                 {
                     return false;
                 }
-
-                text = textBuffer.GetRowByOffset(y).GetText();
-                limit = start;
-                start -= text.size();
+                --beg;
+                length = rowLength(textBuffer, beg);
+                start -= length;
             } while (neededIndex < start);
+
+            // ...and since we're iterating backwards, also the rows in front of it that fit into the chunk.
+            end = beg + 1;
+            while (beg > range.begin && end - beg < ChunkCache::maxRows)
+            {
+                const auto l = rowLength(textBuffer, beg - 1);
+                if (length + l > ChunkCache::maxLength)
+                {
+                    break;
+                }
+                --beg;
+                start -= l;
+                length += l;
+            }
         }
         else
         {
-            do
+            start = ut->chunkNativeLimit;
+
+            // Find the row containing neededIndex...
+            for (beg = end;; ++beg)
             {
-                ++y;
-                if (y >= range.end)
+                if (beg >= range.end)
                 {
                     return false;
                 }
+                length = rowLength(textBuffer, beg);
+                if (neededIndex < start + length)
+                {
+                    break;
+                }
+                start += length;
+            }
 
-                text = textBuffer.GetRowByOffset(y).GetText();
-                start = limit;
-                limit += text.size();
-            } while (neededIndex >= limit);
+            // ...and the rows after it that fit into the chunk.
+            end = beg + 1;
+            while (end < range.end && end - beg < ChunkCache::maxRows)
+            {
+                const auto l = rowLength(textBuffer, end);
+                if (length + l > ChunkCache::maxLength)
+                {
+                    break;
+                }
+                ++end;
+                length += l;
+            }
         }
 
-        accessCurrentRow(ut) = y;
-        ut->chunkNativeStart = start;
-        ut->chunkNativeLimit = limit;
-        ut->chunkLength = gsl::narrow_cast<int32_t>(text.size());
-#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
-        ut->chunkContents = reinterpret_cast<const char16_t*>(text.data());
-        ut->nativeIndexingLimit = ut->chunkLength;
+        fillChunk(ut, textBuffer, beg, end, start);
     }
 
     auto offset = gsl::narrow_cast<int32_t>(nativeIndex - start);
@@ -232,14 +341,12 @@ try
         return gsl::narrow_cast<int32_t>(nativeLimit - nativeStart);
     }
 
-    const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
-    const auto y = accessCurrentRow(ut);
-    const auto offset = ut->chunkNativeStart - nativeStart;
-    const auto text = textBuffer.GetRowByOffset(y).GetText().substr(gsl::narrow_cast<size_t>(std::max<int64_t>(0, offset)));
+    const auto offset = gsl::narrow_cast<size_t>(nativeStart - ut->chunkNativeStart);
     const auto destCapacitySizeT = gsl::narrow_cast<size_t>(destCapacity);
-    const auto length = std::min(destCapacitySizeT, text.size());
+    const auto length = std::min(destCapacitySizeT, gsl::narrow_cast<size_t>(nativeLimit - nativeStart));
 
-    memcpy(dest, text.data(), length * sizeof(char16_t));
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    memcpy(dest, ut->chunkContents + offset, length * sizeof(char16_t));
 
     if (length < destCapacitySizeT)
     {
@@ -264,17 +371,24 @@ static constexpr UTextFuncs utextFuncs{
 };
 
 // Creates a UText from the given TextBuffer that spans rows [rowBeg,RowEnd).
-UText Microsoft::Console::ICU::UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd) noexcept
+Microsoft::Console::ICU::unique_utext Microsoft::Console::ICU::UTextFromTextBuffer(const TextBuffer& textBuffer, til::CoordType rowBeg, til::CoordType rowEnd)
 {
-#pragma warning(suppress : 26477) // Use 'nullptr' rather than 0 or NULL (es.47).
-    UText ut = UTEXT_INITIALIZER;
-    ut.providerProperties = (1 << UTEXT_PROVIDER_LENGTH_IS_EXPENSIVE) | (1 << UTEXT_PROVIDER_STABLE_CHUNKS);
-    ut.pFuncs = &utextFuncs;
-    ut.context = &textBuffer;
-    accessCurrentRow(&ut) = rowBeg - 1; // the utextAccess() below will advance this by 1.
-    accessRowRange(&ut) = { rowBeg, rowEnd };
-
-    utextAccess(&ut, 0, true);
+    UErrorCode status = U_ZERO_ERROR;
+    unique_utext ut{ utext_setup(nullptr, sizeof(ChunkCache), &status) };
+    THROW_IF_NULL_ALLOC(ut);
+
+    // The chunks are copied into the ChunkCache, which gets overwritten on the next access.
+    ut->providerProperties = 1 << UTEXT_PROVIDER_LENGTH_IS_EXPENSIVE;
+    ut->pFuncs = &utextFuncs;
+    ut->context = &textBuffer;
+    accessRowRange(ut.get()) = { rowBeg, rowEnd };
+
+    // An empty chunk in front of the first row. The utextAccess() below will advance from there.
+    auto& cache = accessChunkCache(ut.get());
+    cache.rowBeg = rowBeg;
+    cache.rowEnd = rowBeg;
+
+    utextAccess(ut.get(), 0, true);
     return ut;
 }
 
@@ -303,10 +417,13 @@ til::point_span Microsoft::Console::ICU::BufferRangeFromMatch(UText* ut, URegula
     const auto& textBuffer = *static_cast<const TextBuffer*>(ut->context);
     til::point_span ret;
 
+    // The rows of the current chunk double as a cache of the mapping from native indices to rows.
+    // Most of the time consecutive matches are within the same chunk and finding their rows doesn't need to touch the buffer.
     if (utextAccess(ut, nativeIndexBeg, true))
     {
-        const auto y = accessCurrentRow(ut);
-        ret.start.x = textBuffer.GetRowByOffset(y).GetLeadingColumnAtCharOffset(ut->chunkOffset);
+        auto offset = ut->chunkOffset;
+        const auto y = rowAtChunkOffset(ut, offset);
+        ret.start.x = textBuffer.GetRowByOffset(y).GetLeadingColumnAtCharOffset(offset);
         ret.start.y = y;
     }
     else
@@ -316,8 +433,9 @@ til::point_span Microsoft::Console::ICU::BufferRangeFromMatch(UText* ut, URegula
 
     if (utextAccess(ut, nativeIndexEnd, true))
     {
-        const auto y = accessCurrentRow(ut);
-        ret.end.x = textBuffer.GetRowByOffset(y).GetTrailingColumnAtCharOffset(ut->chunkOffset);
+        auto offset = ut->chunkOffset;
+        const auto y = rowAtChunkOffset(ut, offset);
+        ret.end.x = textBuffer.GetRowByOffset(y).GetTrailingColumnAtCharOffset(offset);
         ret.end.y = y;
     }
     else
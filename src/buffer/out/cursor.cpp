@@ -88,14 +88,22 @@ void Cursor::SetHasMoved(const bool fHasMoved) noexcept
 
 void Cursor::SetIsVisible(const bool fIsVisible) noexcept
 {
-    _fIsVisible = fIsVisible;
-    _RedrawCursor();
+    if (_fIsVisible != fIsVisible)
+    {
+        // _RedrawCursor() ignores hidden cursors, which would leave the old one on the screen.
+        _fIsVisible = fIsVisible;
+        _RedrawCursorAlways();
+    }
 }
 
 void Cursor::SetIsOn(const bool fIsOn) noexcept
 {
     _fIsOn = fIsOn;
-    _RedrawCursorAlways();
+    // A hidden cursor doesn't need to be redrawn when it blinks.
+    if (_fIsVisible)
+    {
+        _RedrawCursorAlways();
+    }
 }
 
 void Cursor::SetBlinkingAllowed(const bool fBlinkingAllowed) noexcept
@@ -153,7 +161,8 @@ void Cursor::SetStyle(const ULONG ulSize, const CursorType type) noexcept
 }
 
 // Routine Description:
-// - Sends a redraw message to the renderer only if the cursor is currently on.
+// - Sends a redraw message to the renderer only if the cursor is currently on and visible.
+//   Applications commonly hide the cursor during bulk output, which makes moving it free.
 // - NOTE: For use with most methods in this class.
 // Arguments:
 // - <none>
@@ -164,7 +173,7 @@ void Cursor::_RedrawCursor() noexcept
     // Only trigger the redraw if we're on.
     // Don't draw the cursor if this was triggered from a conversion area.
     // (Conversion areas have cursors to mark the insertion point internally, but the user's actual cursor is the one on the primary screen buffer.)
-    if (IsOn() && !IsConversionArea())
+    if (IsOn() && IsVisible() && !IsConversionArea())
     {
         if (_fDeferCursorRedraw)
         {
@@ -286,6 +295,26 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
     _cursorType = OtherCursor._cursorType;
 }
 
+// Routine Description:
+// - Returns all properties, except for the size, to the state of a freshly constructed cursor.
+void Cursor::Reset() noexcept
+{
+    _cPosition = {};
+    _fHasMoved = false;
+    _fIsVisible = true;
+    _fIsOn = true;
+    _fIsDouble = false;
+    _fBlinkingAllowed = true;
+    _fDelay = false;
+    _fIsConversionArea = false;
+    _fIsPopupShown = false;
+    _fDelayedEolWrap = false;
+    _coordDelayedAt = {};
+    _fDeferCursorRedraw = false;
+    _fHaveDeferredCursorRedraw = false;
+    _cursorType = CursorType::Legacy;
+}
+
 void Cursor::DelayEOLWrap() noexcept
 {
     _coordDelayedAt = _cPosition;
@@ -75,6 +75,7 @@ public:
     void DecrementYPosition(const til::CoordType DeltaY) noexcept;
 
     void CopyProperties(const Cursor& OtherCursor) noexcept;
+    void Reset() noexcept;
 
     void DelayEOLWrap() noexcept;
     void ResetDelayEOLWrap() noexcept;
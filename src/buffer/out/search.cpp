@@ -21,19 +21,144 @@ bool Search::ResetIfStale(Microsoft::Console::Render::IRenderData& renderData, c
         return false;
     }
 
+    // If only the buffer contents changed since the last search, we only need to search the rows that changed.
+    if (NeedsFullSearch(textBuffer, needle, caseInsensitive))
+    {
+        _results = textBuffer.SearchText(needle, caseInsensitive);
+    }
+    else
+    {
+        _updateResults(textBuffer);
+    }
+
     _renderData = &renderData;
+    _textBuffer = &textBuffer;
     _needle = needle;
     _reverse = reverse;
     _caseInsensitive = caseInsensitive;
     _lastMutationId = lastMutationId;
+    _rotationCount = textBuffer.GetRotationCount();
 
-    _results = textBuffer.SearchText(needle, caseInsensitive);
     _index = reverse ? gsl::narrow_cast<ptrdiff_t>(_results.size()) - 1 : 0;
     _step = reverse ? -1 : 1;
 
     return true;
 }
 
+// Returns true if ResetIfStale() would have to search through the entire buffer, because the previous
+// results (if any) can't be updated incrementally. Callers can use this to decide whether to search
+// through a snapshot of the buffer in the background instead. See SearchSnapshot().
+bool Search::NeedsFullSearch(const TextBuffer& textBuffer, const std::wstring_view& needle, bool caseInsensitive) const noexcept
+{
+    return _textBuffer != &textBuffer || _needle != needle || _caseInsensitive != caseInsensitive;
+}
+
+// Searches through a snapshot of all rows of a buffer, the same way ResetIfStale() would search through the buffer.
+// Since the snapshot doesn't share any state with its source, this can run on any thread without holding the lock.
+// It searches one chunk of rows at a time and returns std::nullopt if it got cancelled in between.
+std::optional<std::vector<til::point_span>> Search::SearchSnapshot(const TextBufferSnapshot& snapshot, const std::wstring_view& needle, bool caseInsensitive, const til::cancellation_token& cancellation)
+{
+    const auto& textBuffer = *snapshot.buffer;
+    const auto height = textBuffer.TotalRowCount();
+
+    // A match that begins in a chunk may continue this many rows past its end. See _updateResults().
+    const auto width = textBuffer.GetSize().Width();
+    const auto needleLength = gsl::narrow_cast<til::CoordType>(needle.size());
+    const auto lookAheadRows = (std::max(needleLength - 1, 0) + width - 1) / width;
+
+    std::vector<til::point_span> results;
+    til::point start;
+
+    while (start.y < height)
+    {
+        if (cancellation.is_cancelled())
+        {
+            return std::nullopt;
+        }
+
+        const auto chunkEnd = std::min(height, start.y + _snapshotChunkRowCount);
+        auto chunk = textBuffer.SearchText(needle, caseInsensitive, start, chunkEnd + lookAheadRows);
+
+        // Matches that begin past the chunk are found again by the next iteration, because matches never overlap.
+        chunk.erase(std::find_if(chunk.begin(), chunk.end(), [&](const auto& r) { return r.start.y >= chunkEnd; }), chunk.end());
+        results.insert(results.end(), chunk.begin(), chunk.end());
+
+        start = { 0, chunkEnd };
+        if (!results.empty())
+        {
+            const auto& last = results.back().end;
+            start = std::max(start, til::point{ last.x + 1, last.y });
+        }
+    }
+
+    return results;
+}
+
+// Replaces the results with those that SearchSnapshot() found in the given snapshot of all rows of a buffer.
+// The snapshot's mutation ID is kept, so that the next ResetIfStale() for the same needle only
+// needs to search through the rows that were modified since the snapshot was taken.
+void Search::AdoptResults(Microsoft::Console::Render::IRenderData& renderData, const TextBufferSnapshot& snapshot, const std::wstring_view& needle, bool reverse, bool caseInsensitive, std::vector<til::point_span>&& results)
+{
+    assert(snapshot.firstRow == 0);
+
+    _renderData = &renderData;
+    _textBuffer = snapshot.source;
+    _needle = needle;
+    _reverse = reverse;
+    _caseInsensitive = caseInsensitive;
+    _lastMutationId = snapshot.mutationId;
+    _rotationCount = snapshot.rotationCount;
+    _results = std::move(results);
+
+    _index = reverse ? gsl::narrow_cast<ptrdiff_t>(_results.size()) - 1 : 0;
+    _step = reverse ? -1 : 1;
+}
+
+// Updates _results for the text buffer modifications since the last search, without searching through
+// the entire buffer again. This produces the same results as a full search, because:
+// * results that lie entirely within unmodified rows would be found again, and
+// * a search that continues right after the last of those finds the same matches as a full search would,
+//   because matches never overlap. A new match can only begin up to _needle.size()-1 characters
+//   before the first modified row, which allows us to skip the unmodified rows without any results.
+void Search::_updateResults(const TextBuffer& textBuffer)
+{
+    // Rows that were rotated out of the buffer take their results with them and the remaining ones move up.
+    const auto height = textBuffer.TotalRowCount();
+    const auto rotations = gsl::narrow_cast<til::CoordType>(std::min(textBuffer.GetRotationCount() - _rotationCount, gsl::narrow_cast<uint64_t>(height)));
+    const auto firstMutatedRow = textBuffer.GetFirstRowMutatedSince(_lastMutationId);
+
+    for (auto& r : _results)
+    {
+        r.start.y -= rotations;
+        r.end.y -= rotations;
+    }
+
+    const auto keepBeg = std::find_if(_results.begin(), _results.end(), [](const auto& r) { return r.start.y >= 0; });
+    const auto keepEnd = std::find_if(keepBeg, _results.end(), [&](const auto& r) { return r.end.y >= firstMutatedRow; });
+    _results.erase(keepEnd, _results.end());
+    _results.erase(_results.begin(), keepBeg);
+
+    if (firstMutatedRow >= height)
+    {
+        return;
+    }
+
+    // Every column holds at least 1 character, so this many rows hold at least _needle.size()-1 characters.
+    const auto width = textBuffer.GetSize().Width();
+    const auto needleLength = gsl::narrow_cast<til::CoordType>(_needle.size());
+    const auto lookBehindRows = (std::max(needleLength - 1, 0) + width - 1) / width;
+    til::point start{ 0, std::max(0, firstMutatedRow - lookBehindRows) };
+
+    if (!_results.empty())
+    {
+        const auto& last = _results.back().end;
+        start = std::max(start, til::point{ last.x + 1, last.y });
+    }
+
+    const auto results = textBuffer.SearchText(_needle, _caseInsensitive, start, til::CoordTypeMax);
+    _results.insert(_results.end(), results.begin(), results.end());
+}
+
 void Search::MovePastCurrentSelection()
 {
     if (_renderData->IsSelectionActive())
@@ -102,3 +227,17 @@ bool Search::SelectCurrent() const
 
     return false;
 }
+
+// Routine Description:
+// - Returns the number of matches found by the last search.
+size_t Search::GetResultCount() const noexcept
+{
+    return _results.size();
+}
+
+// Routine Description:
+// - Returns the memory held by the cached results and needle in bytes.
+size_t Search::GetMemoryUsage() const noexcept
+{
+    return _results.capacity() * sizeof(til::point_span) + _needle.capacity() * sizeof(wchar_t);
+}
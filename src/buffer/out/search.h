@@ -17,6 +17,8 @@ Revision History:
 
 #pragma once
 
+#include <til/scheduler.h>
+
 #include "textBuffer.hpp"
 #include "../renderer/inc/IRenderData.hpp"
 
@@ -26,6 +28,10 @@ public:
     Search() = default;
 
     bool ResetIfStale(Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view& needle, bool reverse, bool caseInsensitive);
+    bool NeedsFullSearch(const TextBuffer& textBuffer, const std::wstring_view& needle, bool caseInsensitive) const noexcept;
+
+    static std::optional<std::vector<til::point_span>> SearchSnapshot(const TextBufferSnapshot& snapshot, const std::wstring_view& needle, bool caseInsensitive, const til::cancellation_token& cancellation);
+    void AdoptResults(Microsoft::Console::Render::IRenderData& renderData, const TextBufferSnapshot& snapshot, const std::wstring_view& needle, bool reverse, bool caseInsensitive, std::vector<til::point_span>&& results);
 
     void MovePastCurrentSelection();
     void MovePastPoint(til::point anchor) noexcept;
@@ -33,14 +39,25 @@ public:
 
     const til::point_span* GetCurrent() const noexcept;
     bool SelectCurrent() const;
+    size_t GetResultCount() const noexcept;
+    size_t GetMemoryUsage() const noexcept;
 
 private:
+    // SearchSnapshot() checks for cancellation after searching through this many rows.
+    static constexpr til::CoordType _snapshotChunkRowCount = 1024;
+
+    void _updateResults(const TextBuffer& textBuffer);
+
     // _renderData is a pointer so that Search() is constexpr default constructable.
     Microsoft::Console::Render::IRenderData* _renderData = nullptr;
-    std::wstring_view _needle;
+    // The buffer that _results belong to. The render data may switch between the main and alternate buffer.
+    const TextBuffer* _textBuffer = nullptr;
+    // This is a copy, because the results are reused for as long as the needle doesn't change.
+    std::wstring _needle;
     bool _reverse = false;
     bool _caseInsensitive = false;
     uint64_t _lastMutationId = 0;
+    uint64_t _rotationCount = 0;
 
     std::vector<til::point_span> _results;
     ptrdiff_t _index = 0;
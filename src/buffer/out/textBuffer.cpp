@@ -1,2972 +1,4280 @@
-// Copyright (c) Microsoft Corporation.
-// Licensed under the MIT license.
-
-#include "precomp.h"
-
-#include "textBuffer.hpp"
-
-#include <til/hash.h>
-#include <til/unicode.h>
-
-#include "UTextAdapter.h"
-#include "../../types/inc/GlyphWidth.hpp"
-#include "../renderer/base/renderer.hpp"
-#include "../types/inc/convert.hpp"
-#include "../types/inc/utils.hpp"
-
-using namespace Microsoft::Console;
-using namespace Microsoft::Console::Types;
-
-using PointTree = interval_tree::IntervalTree<til::point, size_t>;
-
-constexpr bool allWhitespace(const std::wstring_view& text) noexcept
-{
-    for (const auto ch : text)
-    {
-        if (ch != L' ')
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-static std::atomic<uint64_t> s_lastMutationIdInitialValue;
-
-// Routine Description:
-// - Creates a new instance of TextBuffer
-// Arguments:
-// - screenBufferSize - The X by Y dimensions of the new screen buffer
-// - defaultAttributes - The attributes with which the buffer will be initialized
-// - cursorSize - The height of the cursor within this buffer
-// - isActiveBuffer - Whether this is the currently active buffer
-// - renderer - The renderer to use for triggering a redraw
-// Return Value:
-// - constructed object
-// Note: may throw exception
-TextBuffer::TextBuffer(til::size screenBufferSize,
-                       const TextAttribute defaultAttributes,
-                       const UINT cursorSize,
-                       const bool isActiveBuffer,
-                       Microsoft::Console::Render::Renderer& renderer) :
-    _renderer{ renderer },
-    _currentAttributes{ defaultAttributes },
-    // This way every TextBuffer will start with a ""unique"" _lastMutationId
-    // and so it'll compare unequal with the counter of other TextBuffers.
-    _lastMutationId{ s_lastMutationIdInitialValue.fetch_add(0x100000000) },
-    _cursor{ cursorSize, *this },
-    _isActiveBuffer{ isActiveBuffer }
-{
-    // Guard against resizing the text buffer to 0 columns/rows, which would break being able to insert text.
-    screenBufferSize.width = std::max(screenBufferSize.width, 1);
-    screenBufferSize.height = std::max(screenBufferSize.height, 1);
-    _reserve(screenBufferSize, defaultAttributes);
-}
-
-TextBuffer::~TextBuffer()
-{
-    if (_buffer)
-    {
-        _destroy();
-    }
-}
-
-// I put these functions in a block at the start of the class, because they're the most
-// fundamental aspect of TextBuffer: It implements the basic gap buffer text storage.
-// It's also fairly tricky code.
-#pragma region buffer management
-#pragma warning(push)
-#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
-#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
-
-// MEM_RESERVEs memory sufficient to store height-many ROW structs,
-// as well as their ROW::_chars and ROW::_charOffsets buffers.
-//
-// We use explicit virtual memory allocations to not taint the general purpose allocator
-// with our huge allocation, as well as to be able to reduce the private working set of
-// the application by only committing what we actually need. This reduces conhost's
-// memory usage from ~7MB down to just ~2MB at startup in the general case.
-void TextBuffer::_reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes)
-{
-    const auto w = gsl::narrow<uint16_t>(screenBufferSize.width);
-    const auto h = gsl::narrow<uint16_t>(screenBufferSize.height);
-
-    constexpr auto rowSize = ROW::CalculateRowSize();
-    const auto charsBufferSize = ROW::CalculateCharsBufferSize(w);
-    const auto charOffsetsBufferSize = ROW::CalculateCharOffsetsBufferSize(w);
-    const auto rowStride = rowSize + charsBufferSize + charOffsetsBufferSize;
-    assert(rowStride % alignof(ROW) == 0);
-
-    // 65535*65535 cells would result in a allocSize of 8GiB.
-    // --> Use uint64_t so that we can safely do our calculations even on x86.
-    // We allocate 1 additional row, which will be used for GetScratchpadRow().
-    const auto rowCount = ::base::strict_cast<uint64_t>(h) + 1;
-    const auto allocSize = gsl::narrow<size_t>(rowCount * rowStride);
-
-    // NOTE: Modifications to this block of code might have to be mirrored over to ResizeTraditional().
-    // It constructs a temporary TextBuffer and then extracts the members below, overwriting itself.
-    _buffer = wil::unique_virtualalloc_ptr<std::byte>{
-        static_cast<std::byte*>(THROW_LAST_ERROR_IF_NULL(VirtualAlloc(nullptr, allocSize, MEM_RESERVE, PAGE_READWRITE)))
-    };
-    _bufferEnd = _buffer.get() + allocSize;
-    _commitWatermark = _buffer.get();
-    _initialAttributes = defaultAttributes;
-    _bufferRowStride = rowStride;
-    _bufferOffsetChars = rowSize;
-    _bufferOffsetCharOffsets = rowSize + charsBufferSize;
-    _width = w;
-    _height = h;
-}
-
-// MEM_COMMITs the memory and constructs all ROWs up to and including the given row pointer.
-// It's expected that the caller verifies the parameter. It goes hand in hand with _getRowByOffsetDirect().
-//
-// Declaring this function as noinline allows _getRowByOffsetDirect() to be inlined,
-// which improves overall TextBuffer performance by ~6%. And all it cost is this annotation.
-// The compiler doesn't understand the likelihood of our branches. (PGO does, but that's imperfect.)
-__declspec(noinline) void TextBuffer::_commit(const std::byte* row)
-{
-    const auto rowEnd = row + _bufferRowStride;
-    const auto remaining = gsl::narrow_cast<uintptr_t>(_bufferEnd - _commitWatermark);
-    const auto minimum = gsl::narrow_cast<uintptr_t>(rowEnd - _commitWatermark);
-    const auto ideal = minimum + _bufferRowStride * _commitReadAheadRowCount;
-    const auto size = std::min(remaining, ideal);
-
-    THROW_LAST_ERROR_IF_NULL(VirtualAlloc(_commitWatermark, size, MEM_COMMIT, PAGE_READWRITE));
-
-    _construct(_commitWatermark + size);
-}
-
-// Destructs and MEM_DECOMMITs all previously constructed ROWs.
-// You can use this (or rather the Reset() method) to fully clear the TextBuffer.
-void TextBuffer::_decommit() noexcept
-{
-    _destroy();
-    VirtualFree(_buffer.get(), 0, MEM_DECOMMIT);
-    _commitWatermark = _buffer.get();
-}
-
-// Constructs ROWs up to (excluding) the ROW pointed to by `until`.
-void TextBuffer::_construct(const std::byte* until) noexcept
-{
-    for (; _commitWatermark < until; _commitWatermark += _bufferRowStride)
-    {
-        const auto row = reinterpret_cast<ROW*>(_commitWatermark);
-        const auto chars = reinterpret_cast<wchar_t*>(_commitWatermark + _bufferOffsetChars);
-        const auto indices = reinterpret_cast<uint16_t*>(_commitWatermark + _bufferOffsetCharOffsets);
-        std::construct_at(row, chars, indices, _width, _initialAttributes);
-    }
-}
-
-// Destroys all previously constructed ROWs.
-// Be careful! This doesn't reset any of the members, in particular the _commitWatermark.
-void TextBuffer::_destroy() const noexcept
-{
-    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride)
-    {
-        std::destroy_at(reinterpret_cast<ROW*>(it));
-    }
-}
-
-// This function is "direct" because it trusts the caller to properly wrap the "offset"
-// parameter modulo the _height of the buffer, etc. But keep in mind that a offset=0
-// is the GetScratchpadRow() and not the GetRowByOffset(0). That one is offset=1.
-ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
-{
-    const auto row = _buffer.get() + _bufferRowStride * offset;
-    THROW_HR_IF(E_UNEXPECTED, row < _buffer.get() || row >= _bufferEnd);
-
-    if (row >= _commitWatermark)
-    {
-        _commit(row);
-    }
-
-    return *reinterpret_cast<ROW*>(row);
-}
-
-ROW& TextBuffer::_getRow(til::CoordType y) const
-{
-    // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
-    auto offset = (_firstRow + y) % _height;
-
-    // Support negative wrap around. This way an index of -1 will
-    // wrap to _rowCount-1 and make implementing scrolling easier.
-    if (offset < 0)
-    {
-        offset += _height;
-    }
-
-    // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
-#pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
-    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
-}
-
-// Returns the "user-visible" index of the last committed row, which can be used
-// to short-circuit some algorithms that try to scan the entire buffer.
-// Returns 0 if no rows are committed in.
-til::CoordType TextBuffer::_estimateOffsetOfLastCommittedRow() const noexcept
-{
-    const auto lastRowOffset = (_commitWatermark - _buffer.get()) / _bufferRowStride;
-    // This subtracts 2 from the offset to account for the:
-    // * scratchpad row at offset 0, whereas regular rows start at offset 1.
-    // * fact that _commitWatermark points _past_ the last committed row,
-    //   but we want to return an index pointing at the last row.
-    return std::max(0, gsl::narrow_cast<til::CoordType>(lastRowOffset - 2));
-}
-
-// Retrieves a row from the buffer by its offset from the first row of the text buffer
-// (what corresponds to the top row of the screen buffer).
-const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
-{
-    return _getRow(index);
-}
-
-// Retrieves a row from the buffer by its offset from the first row of the text buffer
-// (what corresponds to the top row of the screen buffer).
-ROW& TextBuffer::GetMutableRowByOffset(const til::CoordType index)
-{
-    _lastMutationId++;
-    return _getRow(index);
-}
-
-// Returns a row filled with whitespace and the current attributes, for you to freely use.
-ROW& TextBuffer::GetScratchpadRow()
-{
-    return GetScratchpadRow(_currentAttributes);
-}
-
-// Returns a row filled with whitespace and the given attributes, for you to freely use.
-ROW& TextBuffer::GetScratchpadRow(const TextAttribute& attributes)
-{
-    auto& r = _getRowByOffsetDirect(0);
-    r.Reset(attributes);
-    return r;
-}
-
-#pragma warning(pop)
-#pragma endregion
-
-// Routine Description:
-// - Copies properties from another text buffer into this one.
-// - This is primarily to copy properties that would otherwise not be specified during CreateInstance
-// Arguments:
-// - OtherBuffer - The text buffer to copy properties from
-// Return Value:
-// - <none>
-void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer) noexcept
-{
-    GetCursor().CopyProperties(OtherBuffer.GetCursor());
-}
-
-// Routine Description:
-// - Gets the number of rows in the buffer
-// Arguments:
-// - <none>
-// Return Value:
-// - Total number of rows in the buffer
-til::CoordType TextBuffer::TotalRowCount() const noexcept
-{
-    return _height;
-}
-
-// Method Description:
-// - Gets the number of glyphs in the buffer between two points.
-// - IMPORTANT: Make sure that start is before end, or this will never return!
-// Arguments:
-// - start - The starting point of the range to get the glyph count for.
-// - end - The ending point of the range to get the glyph count for.
-// Return Value:
-// - The number of glyphs in the buffer between the two points.
-size_t TextBuffer::GetCellDistance(const til::point from, const til::point to) const
-{
-    auto startCell = GetCellDataAt(from);
-    const auto endCell = GetCellDataAt(to);
-    auto delta = 0;
-    while (startCell != endCell)
-    {
-        ++startCell;
-        ++delta;
-    }
-    return delta;
-}
-
-// Routine Description:
-// - Retrieves read-only text iterator at the given buffer location
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// Return Value:
-// - Read-only iterator of text data only.
-TextBufferTextIterator TextBuffer::GetTextDataAt(const til::point at) const
-{
-    return TextBufferTextIterator(GetCellDataAt(at));
-}
-
-// Routine Description:
-// - Retrieves read-only cell iterator at the given buffer location
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// Return Value:
-// - Read-only iterator of cell data.
-TextBufferCellIterator TextBuffer::GetCellDataAt(const til::point at) const
-{
-    return TextBufferCellIterator(*this, at);
-}
-
-// Routine Description:
-// - Retrieves read-only text iterator at the given buffer location
-//   but restricted to only the specific line (Y coordinate).
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// Return Value:
-// - Read-only iterator of text data only.
-TextBufferTextIterator TextBuffer::GetTextLineDataAt(const til::point at) const
-{
-    return TextBufferTextIterator(GetCellLineDataAt(at));
-}
-
-// Routine Description:
-// - Retrieves read-only cell iterator at the given buffer location
-//   but restricted to only the specific line (Y coordinate).
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// Return Value:
-// - Read-only iterator of cell data.
-TextBufferCellIterator TextBuffer::GetCellLineDataAt(const til::point at) const
-{
-    til::inclusive_rect limit;
-    limit.top = at.y;
-    limit.bottom = at.y;
-    limit.left = 0;
-    limit.right = GetSize().RightInclusive();
-
-    return TextBufferCellIterator(*this, at, Viewport::FromInclusive(limit));
-}
-
-// Routine Description:
-// - Retrieves read-only text iterator at the given buffer location
-//   but restricted to operate only inside the given viewport.
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// - limit - boundaries for the iterator to operate within
-// Return Value:
-// - Read-only iterator of text data only.
-TextBufferTextIterator TextBuffer::GetTextDataAt(const til::point at, const Viewport limit) const
-{
-    return TextBufferTextIterator(GetCellDataAt(at, limit));
-}
-
-// Routine Description:
-// - Retrieves read-only cell iterator at the given buffer location
-//   but restricted to operate only inside the given viewport.
-// Arguments:
-// - at - X,Y position in buffer for iterator start position
-// - limit - boundaries for the iterator to operate within
-// Return Value:
-// - Read-only iterator of cell data.
-TextBufferCellIterator TextBuffer::GetCellDataAt(const til::point at, const Viewport limit) const
-{
-    return TextBufferCellIterator(*this, at, limit);
-}
-
-//Routine Description:
-// - Call before inserting a character into the buffer.
-// - This will ensure a consistent double byte state (KAttrs line) within the text buffer
-// - It will attempt to correct the buffer if we're inserting an unexpected double byte character type
-//   and it will pad out the buffer if we're going to split a double byte sequence across two rows.
-//Arguments:
-// - dbcsAttribute - Double byte information associated with the character about to be inserted into the buffer
-//Return Value:
-// - true if we successfully prepared the buffer and moved the cursor
-// - false otherwise (out of memory)
-void TextBuffer::_PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute)
-{
-    // Now compensate if we don't have enough space for the upcoming double byte sequence
-    // We only need to compensate for leading bytes
-    if (dbcsAttribute == DbcsAttribute::Leading)
-    {
-        const auto cursorPosition = GetCursor().GetPosition();
-        const auto lineWidth = GetLineWidth(cursorPosition.y);
-
-        // If we're about to lead on the last column in the row, we need to add a padding space
-        if (cursorPosition.x == lineWidth - 1)
-        {
-            // set that we're wrapping for double byte reasons
-            auto& row = GetMutableRowByOffset(cursorPosition.y);
-            row.SetDoubleBytePadded(true);
-
-            // then move the cursor forward and onto the next row
-            IncrementCursor();
-        }
-    }
-}
-
-// Given the character offset `position` in the `chars` string, this function returns the starting position of the next grapheme.
-// For instance, given a `chars` of L"x\uD83D\uDE42y" and a `position` of 1 it'll return 3.
-// GraphemePrev would do the exact inverse of this operation.
-// In the future, these functions are expected to also deliver information about how many columns a grapheme occupies.
-// (I know that mere UTF-16 code point iteration doesn't handle graphemes, but that's what we're working towards.)
-size_t TextBuffer::GraphemeNext(const std::wstring_view& chars, size_t position) noexcept
-{
-    return til::utf16_iterate_next(chars, position);
-}
-
-// It's the counterpart to GraphemeNext. See GraphemeNext.
-size_t TextBuffer::GraphemePrev(const std::wstring_view& chars, size_t position) noexcept
-{
-    return til::utf16_iterate_prev(chars, position);
-}
-
-// Pretend as if `position` is a regular cursor in the TextBuffer.
-// This function will then pretend as if you pressed the left/right arrow
-// keys `distance` amount of times (negative = left, positive = right).
-til::point TextBuffer::NavigateCursor(til::point position, til::CoordType distance) const
-{
-    const til::CoordType maxX = _width - 1;
-    const til::CoordType maxY = _height - 1;
-    auto x = std::clamp(position.x, 0, maxX);
-    auto y = std::clamp(position.y, 0, maxY);
-    auto row = &GetRowByOffset(y);
-
-    if (distance < 0)
-    {
-        do
-        {
-            if (x > 0)
-            {
-                x = row->NavigateToPrevious(x);
-            }
-            else if (y <= 0)
-            {
-                break;
-            }
-            else
-            {
-                --y;
-                row = &GetRowByOffset(y);
-                x = row->GetReadableColumnCount() - 1;
-            }
-        } while (++distance != 0);
-    }
-    else if (distance > 0)
-    {
-        auto rowWidth = row->GetReadableColumnCount();
-
-        do
-        {
-            if (x < rowWidth)
-            {
-                x = row->NavigateToNext(x);
-            }
-            else if (y >= maxY)
-            {
-                break;
-            }
-            else
-            {
-                ++y;
-                row = &GetRowByOffset(y);
-                rowWidth = row->GetReadableColumnCount();
-                x = 0;
-            }
-        } while (--distance != 0);
-    }
-
-    return { x, y };
-}
-
-// This function is intended for writing regular "lines" of text as it'll set the wrap flag on the given row.
-// You can continue calling the function on the same row as long as state.columnEnd < state.columnLimit.
-void TextBuffer::Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state)
-{
-    auto& r = GetMutableRowByOffset(row);
-    r.ReplaceText(state);
-    r.ReplaceAttributes(state.columnBegin, state.columnEnd, attributes);
-    TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, row, state.columnEndDirty, row + 1 }));
-}
-
-// Fills an area of the buffer with a given fill character(s) and attributes.
-void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes)
-{
-    if (!rect || fill.empty())
-    {
-        return;
-    }
-
-    auto& scratchpad = GetScratchpadRow(attributes);
-
-    // The scratchpad row gets reset to whitespace by default, so there's no need to
-    // initialize it again. Filling with whitespace is the most common operation by far.
-    if (fill != L" ")
-    {
-        RowWriteState state{
-            .columnLimit = rect.right,
-            .columnEnd = rect.left,
-        };
-
-        // Fill the scratchpad row with consecutive copies of "fill" up to the amount we need.
-        //
-        // We don't just create a single string with N copies of "fill" and write that at once,
-        // because that might join neighboring combining marks unintentionally.
-        //
-        // Building the buffer this way is very wasteful and slow, but it's still 3x
-        // faster than what we had before and no one complained about that either.
-        // It's seldom used code and probably not worth optimizing for.
-        while (state.columnEnd < rect.right)
-        {
-            state.columnBegin = state.columnEnd;
-            state.text = fill;
-            scratchpad.ReplaceText(state);
-        }
-    }
-
-    // Fill the given rows with copies of the scratchpad row. That's a little
-    // slower when filling just a single row, but will be much faster for >1 rows.
-    {
-        RowCopyTextFromState state{
-            .source = scratchpad,
-            .columnBegin = rect.left,
-            .columnLimit = rect.right,
-            .sourceColumnBegin = rect.left,
-        };
-
-        for (auto y = rect.top; y < rect.bottom; ++y)
-        {
-            auto& r = GetMutableRowByOffset(y);
-            r.CopyTextFrom(state);
-            r.ReplaceAttributes(rect.left, rect.right, attributes);
-            TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
-        }
-    }
-}
-
-// Routine Description:
-// - Writes cells to the output buffer. Writes at the cursor.
-// Arguments:
-// - givenIt - Iterator representing output cell data to write
-// Return Value:
-// - The final position of the iterator
-OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt)
-{
-    const auto& cursor = GetCursor();
-    const auto target = cursor.GetPosition();
-
-    const auto finalIt = Write(givenIt, target);
-
-    return finalIt;
-}
-
-// Routine Description:
-// - Writes cells to the output buffer.
-// Arguments:
-// - givenIt - Iterator representing output cell data to write
-// - target - the row/column to start writing the text to
-// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data
-// Return Value:
-// - The final position of the iterator
-OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt,
-                                     const til::point target,
-                                     const std::optional<bool> wrap)
-{
-    // Make mutable copy so we can walk.
-    auto it = givenIt;
-
-    // Make mutable target so we can walk down lines.
-    auto lineTarget = target;
-
-    // Get size of the text buffer so we can stay in bounds.
-    const auto size = GetSize();
-
-    // While there's still data in the iterator and we're still targeting in bounds...
-    while (it && size.IsInBounds(lineTarget))
-    {
-        // Attempt to write as much data as possible onto this line.
-        // NOTE: if wrap = true/false, we want to set the line's wrap to true/false (respectively) if we reach the end of the line
-        it = WriteLine(it, lineTarget, wrap);
-
-        // Move to the next line down.
-        lineTarget.x = 0;
-        ++lineTarget.y;
-    }
-
-    return it;
-}
-
-// Routine Description:
-// - Writes one line of text to the output buffer.
-// Arguments:
-// - givenIt - The iterator that will dereference into cell data to insert
-// - target - Coordinate targeted within output buffer
-// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data in the iterator.
-// - limitRight - Optionally restrict the right boundary for writing (e.g. stop writing earlier than the end of line)
-// Return Value:
-// - The iterator, but advanced to where we stopped writing. Use to find input consumed length or cells written length.
-OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
-                                         const til::point target,
-                                         const std::optional<bool> wrap,
-                                         std::optional<til::CoordType> limitRight)
-{
-    // If we're not in bounds, exit early.
-    if (!GetSize().IsInBounds(target))
-    {
-        return givenIt;
-    }
-
-    //  Get the row and write the cells
-    auto& row = GetMutableRowByOffset(target.y);
-    const auto newIt = row.WriteCells(givenIt, target.x, wrap, limitRight);
-
-    // Take the cell distance written and notify that it needs to be repainted.
-    const auto written = newIt.GetCellDistance(givenIt);
-    const auto paint = Viewport::FromDimensions(target, { written, 1 });
-    TriggerRedraw(paint);
-
-    return newIt;
-}
-
-//Routine Description:
-// - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
-//Arguments:
-// - chars - The codepoint to insert
-// - dbcsAttribute - Double byte information associated with the codepoint
-// - bAttr - Color data associated with the character
-//Return Value:
-// - true if we successfully inserted the character
-// - false otherwise (out of memory)
-void TextBuffer::InsertCharacter(const std::wstring_view chars,
-                                 const DbcsAttribute dbcsAttribute,
-                                 const TextAttribute attr)
-{
-    // Ensure consistent buffer state for double byte characters based on the character type we're about to insert
-    _PrepareForDoubleByteSequence(dbcsAttribute);
-
-    // Get the current cursor position
-    const auto iRow = GetCursor().GetPosition().y; // row stored as logical position, not array position
-    const auto iCol = GetCursor().GetPosition().x; // column logical and array positions are equal.
-
-    // Get the row associated with the given logical position
-    auto& Row = GetMutableRowByOffset(iRow);
-
-    // Store character and double byte data
-    switch (dbcsAttribute)
-    {
-    case DbcsAttribute::Leading:
-        Row.ReplaceCharacters(iCol, 2, chars);
-        break;
-    case DbcsAttribute::Trailing:
-        Row.ReplaceCharacters(iCol - 1, 2, chars);
-        break;
-    default:
-        Row.ReplaceCharacters(iCol, 1, chars);
-        break;
-    }
-
-    // Store color data
-    Row.SetAttrToEnd(iCol, attr);
-    IncrementCursor();
-}
-
-//Routine Description:
-// - Inserts one ucs2 codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
-//Arguments:
-// - wch - The codepoint to insert
-// - dbcsAttribute - Double byte information associated with the codepoint
-// - bAttr - Color data associated with the character
-//Return Value:
-// - true if we successfully inserted the character
-// - false otherwise (out of memory)
-void TextBuffer::InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr)
-{
-    InsertCharacter({ &wch, 1 }, dbcsAttribute, attr);
-}
-
-//Routine Description:
-// - Finds the current row in the buffer (as indicated by the cursor position)
-//   and specifies that we have forced a line wrap on that row
-//Arguments:
-// - <none> - Always sets to wrap
-//Return Value:
-// - <none>
-void TextBuffer::_SetWrapOnCurrentRow()
-{
-    _AdjustWrapOnCurrentRow(true);
-}
-
-//Routine Description:
-// - Finds the current row in the buffer (as indicated by the cursor position)
-//   and specifies whether or not it should have a line wrap flag.
-//Arguments:
-// - fSet - True if this row has a wrap. False otherwise.
-//Return Value:
-// - <none>
-void TextBuffer::_AdjustWrapOnCurrentRow(const bool fSet)
-{
-    // The vertical position of the cursor represents the current row we're manipulating.
-    const auto uiCurrentRowOffset = GetCursor().GetPosition().y;
-
-    // Set the wrap status as appropriate
-    GetMutableRowByOffset(uiCurrentRowOffset).SetWrapForced(fSet);
-}
-
-//Routine Description:
-// - Increments the cursor one position in the buffer as if text is being typed into the buffer.
-// - NOTE: Will introduce a wrap marker if we run off the end of the current row
-//Arguments:
-// - <none>
-//Return Value:
-// - true if we successfully moved the cursor.
-// - false otherwise (out of memory)
-void TextBuffer::IncrementCursor()
-{
-    // Cursor position is stored as logical array indices (starts at 0) for the window
-    // Buffer Size is specified as the "length" of the array. It would say 80 for valid values of 0-79.
-    // So subtract 1 from buffer size in each direction to find the index of the final column in the buffer
-    const auto iFinalColumnIndex = GetLineWidth(GetCursor().GetPosition().y) - 1;
-
-    // Move the cursor one position to the right
-    GetCursor().IncrementXPosition(1);
-
-    // If we've passed the final valid column...
-    if (GetCursor().GetPosition().x > iFinalColumnIndex)
-    {
-        // Then mark that we've been forced to wrap
-        _SetWrapOnCurrentRow();
-
-        // Then move the cursor to a new line
-        NewlineCursor();
-    }
-}
-
-//Routine Description:
-// - Increments the cursor one line down in the buffer and to the beginning of the line
-//Arguments:
-// - <none>
-//Return Value:
-// - true if we successfully moved the cursor.
-void TextBuffer::NewlineCursor()
-{
-    const auto iFinalRowIndex = GetSize().BottomInclusive();
-
-    // Reset the cursor position to 0 and move down one line
-    GetCursor().SetXPosition(0);
-    GetCursor().IncrementYPosition(1);
-
-    // If we've passed the final valid row...
-    if (GetCursor().GetPosition().y > iFinalRowIndex)
-    {
-        // Stay on the final logical/offset row of the buffer.
-        GetCursor().SetYPosition(iFinalRowIndex);
-
-        // Instead increment the circular buffer to move us into the "oldest" row of the backing buffer
-        IncrementCircularBuffer();
-    }
-}
-
-//Routine Description:
-// - Increments the circular buffer by one. Circular buffer is represented by FirstRow variable.
-//Arguments:
-// - fillAttributes - the attributes with which the recycled row will be initialized.
-//Return Value:
-// - true if we successfully incremented the buffer.
-void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
-{
-    // FirstRow is at any given point in time the array index in the circular buffer that corresponds
-    // to the logical position 0 in the window (cursor coordinates and all other coordinates).
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerFlush(true);
-    }
-
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
-
-    // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
-    GetMutableRowByOffset(0).Reset(fillAttributes);
-    {
-        // Now proceed to increment.
-        // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
-        _firstRow++;
-
-        // If we pass up the height of the buffer, loop back to 0.
-        if (_firstRow >= GetSize().Height())
-        {
-            _firstRow = 0;
-        }
-    }
-}
-
-//Routine Description:
-// - Retrieves the position of the last non-space character in the given
-//   viewport
-// - By default, we search the entire buffer to find the last non-space
-//   character.
-// - If we know the last character is within the given viewport (so we don't
-//   need to check the entire buffer), we can provide a value in viewOptional
-//   that we'll use to search for the last character in.
-//Arguments:
-// - The viewport
-//Return value:
-// - Coordinate position (relative to the text buffer)
-til::point TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::Console::Types::Viewport> viewOptional) const
-{
-    const auto viewport = viewOptional.has_value() ? viewOptional.value() : GetSize();
-
-    til::point coordEndOfText;
-    // Search the given viewport by starting at the bottom.
-    coordEndOfText.y = std::min(viewport.BottomInclusive(), _estimateOffsetOfLastCommittedRow());
-
-    const auto& currRow = GetRowByOffset(coordEndOfText.y);
-    // The X position of the end of the valid text is the Right draw boundary (which is one beyond the final valid character)
-    coordEndOfText.x = currRow.MeasureRight() - 1;
-
-    // If the X coordinate turns out to be -1, the row was empty, we need to search backwards for the real end of text.
-    const auto viewportTop = viewport.Top();
-    auto fDoBackUp = (coordEndOfText.x < 0 && coordEndOfText.y > viewportTop); // this row is empty, and we're not at the top
-    while (fDoBackUp)
-    {
-        coordEndOfText.y--;
-        const auto& backupRow = GetRowByOffset(coordEndOfText.y);
-        // We need to back up to the previous row if this line is empty, AND there are more rows
-
-        coordEndOfText.x = backupRow.MeasureRight() - 1;
-        fDoBackUp = (coordEndOfText.x < 0 && coordEndOfText.y > viewportTop);
-    }
-
-    // don't allow negative results
-    coordEndOfText.y = std::max(coordEndOfText.y, 0);
-    coordEndOfText.x = std::max(coordEndOfText.x, 0);
-
-    return coordEndOfText;
-}
-
-// Routine Description:
-// - Retrieves the position of the previous character relative to the current cursor position
-// Arguments:
-// - <none>
-// Return Value:
-// - Coordinate position in screen coordinates of the character just before the cursor.
-// - NOTE: Will return 0,0 if already in the top left corner
-til::point TextBuffer::_GetPreviousFromCursor() const
-{
-    auto coordPosition = GetCursor().GetPosition();
-
-    // If we're not at the left edge, simply move the cursor to the left by one
-    if (coordPosition.x > 0)
-    {
-        coordPosition.x--;
-    }
-    else
-    {
-        // Otherwise, only if we're not on the top row (e.g. we don't move anywhere in the top left corner. there is no previous)
-        if (coordPosition.y > 0)
-        {
-            // move the cursor up one line
-            coordPosition.y--;
-
-            // and to the right edge
-            coordPosition.x = GetLineWidth(coordPosition.y) - 1;
-        }
-    }
-
-    return coordPosition;
-}
-
-const til::CoordType TextBuffer::GetFirstRowIndex() const noexcept
-{
-    return _firstRow;
-}
-
-const Viewport TextBuffer::GetSize() const noexcept
-{
-    return Viewport::FromDimensions({ _width, _height });
-}
-
-void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
-{
-    _firstRow = FirstRowIndex;
-}
-
-void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size, const til::CoordType delta)
-{
-    if (delta == 0)
-    {
-        return;
-    }
-
-    // Since the for() loop uses !=, we must ensure that size is positive.
-    // A negative size doesn't make any sense anyways.
-    size = std::max(0, size);
-
-    til::CoordType y = 0;
-    til::CoordType end = 0;
-    til::CoordType step = 0;
-
-    if (delta < 0)
-    {
-        // The layout is like this:
-        // delta is -2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3 A. firstRow + delta (because delta is negative)
-        // | 4
-        // | 5 B. firstRow
-        // | 6
-        // | 7
-        // | 8 C. firstRow + size
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
-        y = firstRow;
-        end = firstRow + size;
-        step = 1;
-    }
-    else
-    {
-        // The layout is like this:
-        // delta is 2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 5 A. firstRow
-        // | 6
-        // | 7
-        // | 8 B. firstRow + size
-        // | 9
-        // | 10 C. firstRow + size + delta
-        // | 11
-        // - end
-        // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
-        y = firstRow + size - 1;
-        end = firstRow - 1;
-        step = -1;
-    }
-
-    for (; y != end; y += step)
-    {
-        GetMutableRowByOffset(y + delta).CopyFrom(GetRowByOffset(y));
-    }
-}
-
-Cursor& TextBuffer::GetCursor() noexcept
-{
-    return _cursor;
-}
-
-const Cursor& TextBuffer::GetCursor() const noexcept
-{
-    return _cursor;
-}
-
-uint64_t TextBuffer::GetLastMutationId() const noexcept
-{
-    return _lastMutationId;
-}
-
-const TextAttribute& TextBuffer::GetCurrentAttributes() const noexcept
-{
-    return _currentAttributes;
-}
-
-void TextBuffer::SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept
-{
-    _currentAttributes = currentAttributes;
-}
-
-void TextBuffer::SetWrapForced(const til::CoordType y, bool wrap)
-{
-    GetMutableRowByOffset(y).SetWrapForced(wrap);
-}
-
-void TextBuffer::SetCurrentLineRendition(const LineRendition lineRendition, const TextAttribute& fillAttributes)
-{
-    const auto cursorPosition = GetCursor().GetPosition();
-    const auto rowIndex = cursorPosition.y;
-    auto& row = GetMutableRowByOffset(rowIndex);
-    if (row.GetLineRendition() != lineRendition)
-    {
-        row.SetLineRendition(lineRendition);
-        // If the line rendition has changed, the row can no longer be wrapped.
-        row.SetWrapForced(false);
-        // And if it's no longer single width, the right half of the row should be erased.
-        if (lineRendition != LineRendition::SingleWidth)
-        {
-            const auto fillChar = L' ';
-            const auto fillOffset = GetLineWidth(rowIndex);
-            const auto fillLength = gsl::narrow<size_t>(GetSize().Width() - fillOffset);
-            const OutputCellIterator fillData{ fillChar, fillAttributes, fillLength };
-            row.WriteCells(fillData, fillOffset, false);
-            // We also need to make sure the cursor is clamped within the new width.
-            GetCursor().SetPosition(ClampPositionWithinLine(cursorPosition));
-        }
-        TriggerRedraw(Viewport::FromDimensions({ 0, rowIndex }, { GetSize().Width(), 1 }));
-    }
-}
-
-void TextBuffer::ResetLineRenditionRange(const til::CoordType startRow, const til::CoordType endRow)
-{
-    for (auto row = startRow; row < endRow; row++)
-    {
-        GetMutableRowByOffset(row).SetLineRendition(LineRendition::SingleWidth);
-    }
-}
-
-LineRendition TextBuffer::GetLineRendition(const til::CoordType row) const
-{
-    return GetRowByOffset(row).GetLineRendition();
-}
-
-bool TextBuffer::IsDoubleWidthLine(const til::CoordType row) const
-{
-    return GetLineRendition(row) != LineRendition::SingleWidth;
-}
-
-til::CoordType TextBuffer::GetLineWidth(const til::CoordType row) const
-{
-    // Use shift right to quickly divide the width by 2 for double width lines.
-    const auto scale = IsDoubleWidthLine(row) ? 1 : 0;
-    return GetSize().Width() >> scale;
-}
-
-til::point TextBuffer::ClampPositionWithinLine(const til::point position) const
-{
-    const auto rightmostColumn = GetLineWidth(position.y) - 1;
-    return { std::min(position.x, rightmostColumn), position.y };
-}
-
-til::point TextBuffer::ScreenToBufferPosition(const til::point position) const
-{
-    // Use shift right to quickly divide the X pos by 2 for double width lines.
-    const auto scale = IsDoubleWidthLine(position.y) ? 1 : 0;
-    return { position.x >> scale, position.y };
-}
-
-til::point TextBuffer::BufferToScreenPosition(const til::point position) const
-{
-    // Use shift left to quickly multiply the X pos by 2 for double width lines.
-    const auto scale = IsDoubleWidthLine(position.y) ? 1 : 0;
-    return { position.x << scale, position.y };
-}
-
-// Routine Description:
-// - Resets the text contents of this buffer with the default character
-//   and the default current color attributes
-void TextBuffer::Reset() noexcept
-{
-    _decommit();
-    _initialAttributes = _currentAttributes;
-}
-
-// Routine Description:
-// - This is the legacy screen resize with minimal changes
-// Arguments:
-// - newSize - new size of screen.
-// Return Value:
-// - Success if successful. Invalid parameter if screen buffer size is unexpected. No memory if allocation failed.
-[[nodiscard]] NTSTATUS TextBuffer::ResizeTraditional(til::size newSize) noexcept
-{
-    // Guard against resizing the text buffer to 0 columns/rows, which would break being able to insert text.
-    newSize.width = std::max(newSize.width, 1);
-    newSize.height = std::max(newSize.height, 1);
-
-    try
-    {
-        TextBuffer newBuffer{ newSize, _currentAttributes, 0, false, _renderer };
-        const auto cursorRow = GetCursor().GetPosition().y;
-        const auto copyableRows = std::min<til::CoordType>(_height, newSize.height);
-        til::CoordType srcRow = 0;
-        til::CoordType dstRow = 0;
-
-        if (cursorRow >= newSize.height)
-        {
-            srcRow = cursorRow - newSize.height + 1;
-        }
-
-        for (; dstRow < copyableRows; ++dstRow, ++srcRow)
-        {
-            newBuffer.GetMutableRowByOffset(dstRow).CopyFrom(GetRowByOffset(srcRow));
-        }
-
-        // NOTE: Keep this in sync with _reserve().
-        _buffer = std::move(newBuffer._buffer);
-        _bufferEnd = newBuffer._bufferEnd;
-        _commitWatermark = newBuffer._commitWatermark;
-        _initialAttributes = newBuffer._initialAttributes;
-        _bufferRowStride = newBuffer._bufferRowStride;
-        _bufferOffsetChars = newBuffer._bufferOffsetChars;
-        _bufferOffsetCharOffsets = newBuffer._bufferOffsetCharOffsets;
-        _width = newBuffer._width;
-        _height = newBuffer._height;
-
-        _SetFirstRowIndex(0);
-    }
-    CATCH_RETURN();
-
-    return S_OK;
-}
-
-void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
-{
-    _isActiveBuffer = isActiveBuffer;
-}
-
-bool TextBuffer::IsActiveBuffer() const noexcept
-{
-    return _isActiveBuffer;
-}
-
-Microsoft::Console::Render::Renderer& TextBuffer::GetRenderer() noexcept
-{
-    return _renderer;
-}
-
-void TextBuffer::TriggerRedraw(const Viewport& viewport)
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerRedraw(viewport);
-    }
-}
-
-void TextBuffer::TriggerRedrawCursor(const til::point position)
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerRedrawCursor(&position);
-    }
-}
-
-void TextBuffer::TriggerRedrawAll()
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerRedrawAll();
-    }
-}
-
-void TextBuffer::TriggerScroll()
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerScroll();
-    }
-}
-
-void TextBuffer::TriggerScroll(const til::point delta)
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerScroll(&delta);
-    }
-}
-
-void TextBuffer::TriggerNewTextNotification(const std::wstring_view newText)
-{
-    if (_isActiveBuffer)
-    {
-        _renderer.TriggerNewTextNotification(newText);
-    }
-}
-
-// Method Description:
-// - get delimiter class for buffer cell position
-// - used for double click selection and uia word navigation
-// Arguments:
-// - pos: the buffer cell under observation
-// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
-// Return Value:
-// - the delimiter class for the given char
-DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const
-{
-    return GetRowByOffset(pos.y).DelimiterClassAt(pos.x, wordDelimiters);
-}
-
-// Method Description:
-// - Get the til::point for the beginning of the word you are on
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// - accessibilityMode - when enabled, we continue expanding left until we are at the beginning of a readable word.
-//                        Otherwise, expand left until a character of a new delimiter class is found
-//                        (or a row boundary is encountered)
-// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
-// Return Value:
-// - The til::point for the first character on the "word" (inclusive)
-til::point TextBuffer::GetWordStart(const til::point target, const std::wstring_view wordDelimiters, bool accessibilityMode, std::optional<til::point> limitOptional) const
-{
-    // Consider a buffer with this text in it:
-    // "  word   other  "
-    // In selection (accessibilityMode = false),
-    //  a "word" is defined as the range between two delimiters
-    //  so the words in the example include ["  ", "word", "   ", "other", "  "]
-    // In accessibility (accessibilityMode = true),
-    //  a "word" includes the delimiters after a range of readable characters
-    //  so the words in the example include ["word   ", "other  "]
-    // NOTE: the start anchor (this one) is inclusive, whereas the end anchor (GetWordEnd) is exclusive
-
-#pragma warning(suppress : 26496)
-    auto copy{ target };
-    const auto bufferSize{ GetSize() };
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-    if (target == bufferSize.Origin())
-    {
-        // can't expand left
-        return target;
-    }
-    else if (target == bufferSize.EndExclusive())
-    {
-        // GH#7664: Treat EndExclusive as EndInclusive so
-        // that it actually points to a space in the buffer
-        copy = bufferSize.BottomRightInclusive();
-    }
-    else if (bufferSize.CompareInBounds(target, limit, true) >= 0)
-    {
-        // if at/past the limit --> clamp to limit
-        copy = limitOptional.value_or(bufferSize.BottomRightInclusive());
-    }
-
-    if (accessibilityMode)
-    {
-        return _GetWordStartForAccessibility(copy, wordDelimiters);
-    }
-    else
-    {
-        return _GetWordStartForSelection(copy, wordDelimiters);
-    }
-}
-
-// Method Description:
-// - Helper method for GetWordStart(). Get the til::point for the beginning of the word (accessibility definition) you are on
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// Return Value:
-// - The til::point for the first character on the current/previous READABLE "word" (inclusive)
-til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const
-{
-    auto result = target;
-    const auto bufferSize = GetSize();
-    auto stayAtOrigin = false;
-
-    // ignore left boundary. Continue until readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a DelimiterChar or ControlChar
-            // we can't move any further back
-            stayAtOrigin = true;
-            break;
-        }
-    }
-
-    // make sure we expand to the left boundary or the beginning of the word
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
-    {
-        if (!bufferSize.DecrementInBounds(result))
-        {
-            // first char in buffer is a RegularChar
-            // we can't move any further back
-            break;
-        }
-    }
-
-    // move off of delimiter and onto word start
-    if (!stayAtOrigin && _GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
-    {
-        bufferSize.IncrementInBounds(result);
-    }
-
-    return result;
-}
-
-// Method Description:
-// - Helper method for GetWordStart(). Get the til::point for the beginning of the word (selection definition) you are on
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// Return Value:
-// - The til::point for the first character on the current word or delimiter run (stopped by the left margin)
-til::point TextBuffer::_GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const
-{
-    auto result = target;
-    const auto bufferSize = GetSize();
-
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
-
-    // expand left until we hit the left boundary or a different delimiter class
-    while (result.x > bufferSize.Left() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.DecrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.IncrementInBounds(result);
-    }
-
-    return result;
-}
-
-// Method Description:
-// - Get the til::point for the beginning of the NEXT word
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// - accessibilityMode - when enabled, we continue expanding right until we are at the beginning of the next READABLE word
-//                        Otherwise, expand right until a character of a new delimiter class is found
-//                        (or a row boundary is encountered)
-// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
-// Return Value:
-// - The til::point for the last character on the "word" (inclusive)
-til::point TextBuffer::GetWordEnd(const til::point target, const std::wstring_view wordDelimiters, bool accessibilityMode, std::optional<til::point> limitOptional) const
-{
-    // Consider a buffer with this text in it:
-    // "  word   other  "
-    // In selection (accessibilityMode = false),
-    //  a "word" is defined as the range between two delimiters
-    //  so the words in the example include ["  ", "word", "   ", "other", "  "]
-    // In accessibility (accessibilityMode = true),
-    //  a "word" includes the delimiters after a range of readable characters
-    //  so the words in the example include ["word   ", "other  "]
-    // NOTE: the end anchor (this one) is exclusive, whereas the start anchor (GetWordStart) is inclusive
-
-    // Already at/past the limit. Can't move forward.
-    const auto bufferSize{ GetSize() };
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-    if (bufferSize.CompareInBounds(target, limit, true) >= 0)
-    {
-        return target;
-    }
-
-    if (accessibilityMode)
-    {
-        return _GetWordEndForAccessibility(target, wordDelimiters, limit);
-    }
-    else
-    {
-        return _GetWordEndForSelection(target, wordDelimiters);
-    }
-}
-
-// Method Description:
-// - Helper method for GetWordEnd(). Get the til::point for the beginning of the next READABLE word
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// - limit - the last "valid" position in the text buffer (to improve performance)
-// Return Value:
-// - The til::point for the first character of the next readable "word". If no next word, return one past the end of the buffer
-til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const
-{
-    const auto bufferSize{ GetSize() };
-    auto result{ target };
-
-    if (bufferSize.CompareInBounds(target, limit, true) >= 0)
-    {
-        // if we're already on/past the last RegularChar,
-        // clamp result to that position
-        result = limit;
-
-        // make the result exclusive
-        bufferSize.IncrementInBounds(result, true);
-    }
-    else
-    {
-        auto iter{ GetCellDataAt(result, bufferSize) };
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) == DelimiterClass::RegularChar)
-        {
-            // Iterate through readable text
-            ++iter;
-        }
-
-        while (iter && iter.Pos() != limit && _GetDelimiterClassAt(iter.Pos(), wordDelimiters) != DelimiterClass::RegularChar)
-        {
-            // expand to the beginning of the NEXT word
-            ++iter;
-        }
-
-        result = iter.Pos();
-
-        // Special case: we tried to move one past the end of the buffer,
-        // but iter prevented that (because that pos doesn't exist).
-        // Manually increment onto the EndExclusive point.
-        if (!iter)
-        {
-            bufferSize.IncrementInBounds(result, true);
-        }
-    }
-
-    return result;
-}
-
-// Method Description:
-// - Helper method for GetWordEnd(). Get the til::point for the beginning of the NEXT word
-// Arguments:
-// - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// Return Value:
-// - The til::point for the last character of the current word or delimiter run (stopped by right margin)
-til::point TextBuffer::_GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const
-{
-    const auto bufferSize = GetSize();
-
-    // can't expand right
-    if (target.x == bufferSize.RightInclusive())
-    {
-        return target;
-    }
-
-    auto result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
-
-    // expand right until we hit the right boundary or a different delimiter class
-    while (result.x < bufferSize.RightInclusive() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.IncrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
-    {
-        // move off of delimiter
-        bufferSize.DecrementInBounds(result);
-    }
-
-    return result;
-}
-
-void TextBuffer::_PruneHyperlinks()
-{
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = GetRowByOffset(0).GetHyperlinks();
-
-    if (!hyperlinks.empty())
-    {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (til::CoordType i = 1; i < total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
-        {
-            RemoveHyperlinkFromMap(hyperlinkReference);
-        }
-    }
-}
-
-// Method Description:
-// - Update pos to be the position of the first character of the next word. This is used for accessibility
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
-// Return Value:
-// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
-// - pos - The til::point for the first character on the "word" (inclusive)
-bool TextBuffer::MoveToNextWord(til::point& pos, const std::wstring_view wordDelimiters, std::optional<til::point> limitOptional) const
-{
-    // move to the beginning of the next word
-    // NOTE: _GetWordEnd...() returns the exclusive position of the "end of the word"
-    //       This is also the inclusive start of the next word.
-    const auto bufferSize{ GetSize() };
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-    const auto copy{ _GetWordEndForAccessibility(pos, wordDelimiters, limit) };
-
-    if (bufferSize.CompareInBounds(copy, limit, true) >= 0)
-    {
-        return false;
-    }
-
-    pos = copy;
-    return true;
-}
-
-// Method Description:
-// - Update pos to be the position of the first character of the previous word. This is used for accessibility
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
-// Return Value:
-// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
-// - pos - The til::point for the first character on the "word" (inclusive)
-bool TextBuffer::MoveToPreviousWord(til::point& pos, std::wstring_view wordDelimiters) const
-{
-    // move to the beginning of the current word
-    auto copy{ GetWordStart(pos, wordDelimiters, true) };
-
-    if (!GetSize().DecrementInBounds(copy, true))
-    {
-        // can't move behind current word
-        return false;
-    }
-
-    // move to the beginning of the previous word
-    pos = GetWordStart(copy, wordDelimiters, true);
-    return true;
-}
-
-// Method Description:
-// - Update pos to be the beginning of the current glyph/character. This is used for accessibility
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
-// Return Value:
-// - pos - The til::point for the first cell of the current glyph (inclusive)
-til::point TextBuffer::GetGlyphStart(const til::point pos, std::optional<til::point> limitOptional) const
-{
-    auto resultPos = pos;
-    const auto bufferSize = GetSize();
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-
-    // Clamp pos to limit
-    if (bufferSize.CompareInBounds(resultPos, limit, true) > 0)
-    {
-        resultPos = limit;
-    }
-
-    // limit is exclusive, so we need to move back to be within valid bounds
-    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Trailing)
-    {
-        bufferSize.DecrementInBounds(resultPos, true);
-    }
-
-    return resultPos;
-}
-
-// Method Description:
-// - Update pos to be the end of the current glyph/character.
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// - accessibilityMode - this is being used for accessibility; make the end exclusive.
-// Return Value:
-// - pos - The til::point for the last cell of the current glyph (exclusive)
-til::point TextBuffer::GetGlyphEnd(const til::point pos, bool accessibilityMode, std::optional<til::point> limitOptional) const
-{
-    auto resultPos = pos;
-    const auto bufferSize = GetSize();
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-
-    // Clamp pos to limit
-    if (bufferSize.CompareInBounds(resultPos, limit, true) > 0)
-    {
-        resultPos = limit;
-    }
-
-    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Leading)
-    {
-        bufferSize.IncrementInBounds(resultPos, true);
-    }
-
-    // increment one more time to become exclusive
-    if (accessibilityMode)
-    {
-        bufferSize.IncrementInBounds(resultPos, true);
-    }
-    return resultPos;
-}
-
-// Method Description:
-// - Update pos to be the beginning of the next glyph/character. This is used for accessibility
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// - allowExclusiveEnd - allow result to be the exclusive limit (one past limit)
-// - limit - boundaries for the iterator to operate within
-// Return Value:
-// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
-// - pos - The til::point for the first cell of the current glyph (inclusive)
-bool TextBuffer::MoveToNextGlyph(til::point& pos, bool allowExclusiveEnd, std::optional<til::point> limitOptional) const
-{
-    const auto bufferSize = GetSize();
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-
-    const auto distanceToLimit{ bufferSize.CompareInBounds(pos, limit, true) };
-    if (distanceToLimit >= 0)
-    {
-        // Corner Case: we're on/past the limit
-        // Clamp us to the limit
-        pos = limit;
-        return false;
-    }
-    else if (!allowExclusiveEnd && distanceToLimit == -1)
-    {
-        // Corner Case: we're just before the limit
-        // and we are not allowed onto the exclusive end.
-        // Fail to move.
-        return false;
-    }
-
-    // Try to move forward, but if we hit the buffer boundary, we fail to move.
-    auto iter{ GetCellDataAt(pos, bufferSize) };
-    const bool success{ ++iter };
-
-    // Move again if we're on a wide glyph
-    if (success && iter->DbcsAttr() == DbcsAttribute::Trailing)
-    {
-        ++iter;
-    }
-
-    pos = iter.Pos();
-    return success;
-}
-
-// Method Description:
-// - Update pos to be the beginning of the previous glyph/character. This is used for accessibility
-// Arguments:
-// - pos - a til::point on the word you are currently on
-// Return Value:
-// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
-// - pos - The til::point for the first cell of the previous glyph (inclusive)
-bool TextBuffer::MoveToPreviousGlyph(til::point& pos, std::optional<til::point> limitOptional) const
-{
-    auto resultPos = pos;
-    const auto bufferSize = GetSize();
-    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-
-    if (bufferSize.CompareInBounds(pos, limit, true) > 0)
-    {
-        // we're past the end
-        // clamp us to the limit
-        pos = limit;
-        return true;
-    }
-
-    // try to move. If we can't, we're done.
-    const auto success = bufferSize.DecrementInBounds(resultPos, true);
-    if (resultPos != bufferSize.EndExclusive() && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Leading)
-    {
-        bufferSize.DecrementInBounds(resultPos, true);
-    }
-
-    pos = resultPos;
-    return success;
-}
-
-// Method Description:
-// - Determines the line-by-line rectangles based on two COORDs
-// - expands the rectangles to support wide glyphs
-// - used for selection rects and UIA bounding rects
-// Arguments:
-// - start: a corner of the text region of interest (inclusive)
-// - end: the other corner of the text region of interest (inclusive)
-// - blockSelection: when enabled, only get the rectangular text region,
-//                   as opposed to the text extending to the left/right
-//                   buffer margins
-// - bufferCoordinates: when enabled, treat the coordinates as relative to
-//                      the buffer rather than the screen.
-// Return Value:
-// - One or more rects corresponding to the selection area
-const std::vector<til::inclusive_rect> TextBuffer::GetTextRects(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const
-{
-    std::vector<til::inclusive_rect> textRects;
-
-    const auto bufferSize = GetSize();
-
-    // (0,0) is the top-left of the screen
-    // the physically "higher" coordinate is closer to the top-left
-    // the physically "lower" coordinate is closer to the bottom-right
-    const auto [higherCoord, lowerCoord] = bufferSize.CompareInBounds(start, end) <= 0 ?
-                                               std::make_tuple(start, end) :
-                                               std::make_tuple(end, start);
-
-    const auto textRectSize = 1 + lowerCoord.y - higherCoord.y;
-    textRects.reserve(textRectSize);
-    for (auto row = higherCoord.y; row <= lowerCoord.y; row++)
-    {
-        til::inclusive_rect textRow;
-
-        textRow.top = row;
-        textRow.bottom = row;
-
-        if (blockSelection || higherCoord.y == lowerCoord.y)
-        {
-            // set the left and right margin to the left-/right-most respectively
-            textRow.left = std::min(higherCoord.x, lowerCoord.x);
-            textRow.right = std::max(higherCoord.x, lowerCoord.x);
-        }
-        else
-        {
-            textRow.left = (row == higherCoord.y) ? higherCoord.x : bufferSize.Left();
-            textRow.right = (row == lowerCoord.y) ? lowerCoord.x : bufferSize.RightInclusive();
-        }
-
-        // If we were passed screen coordinates, convert the given range into
-        // equivalent buffer offsets, taking line rendition into account.
-        if (!bufferCoordinates)
-        {
-            textRow = ScreenToBufferLine(textRow, GetLineRendition(row));
-        }
-
-        _ExpandTextRow(textRow);
-        textRects.emplace_back(textRow);
-    }
-
-    return textRects;
-}
-
-// Method Description:
-// - Computes the span(s) for the given selection
-// - If not a blockSelection, returns a single span (start - end)
-// - Else if a blockSelection, returns spans corresponding to each line in the block selection
-// Arguments:
-// - start: beginning of the text region of interest (inclusive)
-// - end: the other end of the text region of interest (inclusive)
-// - blockSelection: when enabled, get spans for each line covered by the block
-// - bufferCoordinates: when enabled, treat the coordinates as relative to
-//                      the buffer rather than the screen.
-// Return Value:
-// - one or more sets of start-end coordinates, representing spans of text in the buffer
-std::vector<til::point_span> TextBuffer::GetTextSpans(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const
-{
-    std::vector<til::point_span> textSpans;
-    if (blockSelection)
-    {
-        // If blockSelection, this is effectively the same operation as GetTextRects, but
-        // expressed in til::point coordinates.
-        const auto rects = GetTextRects(start, end, /*blockSelection*/ true, bufferCoordinates);
-        textSpans.reserve(rects.size());
-
-        for (auto rect : rects)
-        {
-            const til::point first = { rect.left, rect.top };
-            const til::point second = { rect.right, rect.bottom };
-            textSpans.emplace_back(first, second);
-        }
-    }
-    else
-    {
-        const auto bufferSize = GetSize();
-
-        // (0,0) is the top-left of the screen
-        // the physically "higher" coordinate is closer to the top-left
-        // the physically "lower" coordinate is closer to the bottom-right
-        auto [higherCoord, lowerCoord] = start <= end ?
-                                             std::make_tuple(start, end) :
-                                             std::make_tuple(end, start);
-
-        textSpans.reserve(1);
-
-        // If we were passed screen coordinates, convert the given range into
-        // equivalent buffer offsets, taking line rendition into account.
-        if (!bufferCoordinates)
-        {
-            higherCoord = ScreenToBufferLine(higherCoord, GetLineRendition(higherCoord.y));
-            lowerCoord = ScreenToBufferLine(lowerCoord, GetLineRendition(lowerCoord.y));
-        }
-
-        til::inclusive_rect asRect = { higherCoord.x, higherCoord.y, lowerCoord.x, lowerCoord.y };
-        _ExpandTextRow(asRect);
-        higherCoord.x = asRect.left;
-        higherCoord.y = asRect.top;
-        lowerCoord.x = asRect.right;
-        lowerCoord.y = asRect.bottom;
-
-        textSpans.emplace_back(higherCoord, lowerCoord);
-    }
-
-    return textSpans;
-}
-
-// Method Description:
-// - Expand the selection row according to include wide glyphs fully
-// - this is particularly useful for box selections (ALT + selection)
-// Arguments:
-// - selectionRow: the selection row to be expanded
-// Return Value:
-// - modifies selectionRow's Left and Right values to expand properly
-void TextBuffer::_ExpandTextRow(til::inclusive_rect& textRow) const
-{
-    const auto bufferSize = GetSize();
-
-    // expand left side of rect
-    til::point targetPoint{ textRow.left, textRow.top };
-    if (GetCellDataAt(targetPoint)->DbcsAttr() == DbcsAttribute::Trailing)
-    {
-        if (targetPoint.x == bufferSize.Left())
-        {
-            bufferSize.IncrementInBounds(targetPoint);
-        }
-        else
-        {
-            bufferSize.DecrementInBounds(targetPoint);
-        }
-        textRow.left = targetPoint.x;
-    }
-
-    // expand right side of rect
-    targetPoint = { textRow.right, textRow.bottom };
-    if (GetCellDataAt(targetPoint)->DbcsAttr() == DbcsAttribute::Leading)
-    {
-        if (targetPoint.x == bufferSize.RightInclusive())
-        {
-            bufferSize.DecrementInBounds(targetPoint);
-        }
-        else
-        {
-            bufferSize.IncrementInBounds(targetPoint);
-        }
-        textRow.right = targetPoint.x;
-    }
-}
-
-// Routine Description:
-// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
-// Arguments:
-// - includeCRLF - inject CRLF pairs to the end of each line
-// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
-// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
-// - GetAttributeColors - function used to map TextAttribute to RGB COLORREFs. If null, only extract the text.
-// - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
-// Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
-const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
-                                                   const bool trimTrailingWhitespace,
-                                                   const std::vector<til::inclusive_rect>& selectionRects,
-                                                   std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors,
-                                                   const bool formatWrappedRows) const
-{
-    TextAndColor data;
-    const auto copyTextColor = GetAttributeColors != nullptr;
-
-    // preallocate our vectors to reduce reallocs
-    const auto rows = selectionRects.size();
-    data.text.reserve(rows);
-    if (copyTextColor)
-    {
-        data.FgAttr.reserve(rows);
-        data.BkAttr.reserve(rows);
-    }
-
-    // for each row in the selection
-    for (size_t i = 0; i < rows; i++)
-    {
-        const auto iRow = selectionRects.at(i).top;
-
-        const auto highlight = Viewport::FromInclusive(selectionRects.at(i));
-
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
-
-        // allocate a string buffer
-        std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
-
-        // preallocate to avoid reallocs
-        selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        if (copyTextColor)
-        {
-            selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-            selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-        }
-
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
-        {
-            const auto& cell = *it;
-
-            if (cell.DbcsAttr() != DbcsAttribute::Trailing)
-            {
-                const auto chars = cell.Chars();
-                selectionText.append(chars);
-
-                if (copyTextColor)
-                {
-                    const auto cellData = cell.TextAttr();
-                    const auto [CellFgAttr, CellBkAttr] = GetAttributeColors(cellData);
-                    for (size_t j = 0; j < chars.size(); ++j)
-                    {
-                        selectionFgAttr.push_back(CellFgAttr);
-                        selectionBkAttr.push_back(CellBkAttr);
-                    }
-                }
-            }
-
-            ++it;
-        }
-
-        // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
-        const auto shouldFormatRow = formatWrappedRows || !GetRowByOffset(iRow).WasWrapForced();
-
-        if (trimTrailingWhitespace)
-        {
-            if (shouldFormatRow)
-            {
-                // remove the spaces at the end (aka trim the trailing whitespace)
-                while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
-                {
-                    selectionText.pop_back();
-                    if (copyTextColor)
-                    {
-                        selectionFgAttr.pop_back();
-                        selectionBkAttr.pop_back();
-                    }
-                }
-            }
-        }
-
-        // apply CR/LF to the end of the final string, unless we're the last line.
-        // a.k.a if we're earlier than the bottom, then apply CR/LF.
-        if (includeCRLF && i < selectionRects.size() - 1)
-        {
-            if (shouldFormatRow)
-            {
-                // then we can assume a CR/LF is proper
-                selectionText.push_back(UNICODE_CARRIAGERETURN);
-                selectionText.push_back(UNICODE_LINEFEED);
-
-                if (copyTextColor)
-                {
-                    // can't see CR/LF so just use black FG & BK
-                    const auto Blackness = RGB(0x00, 0x00, 0x00);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                }
-            }
-        }
-
-        data.text.emplace_back(std::move(selectionText));
-        if (copyTextColor)
-        {
-            data.FgAttr.emplace_back(std::move(selectionFgAttr));
-            data.BkAttr.emplace_back(std::move(selectionBkAttr));
-        }
-    }
-
-    return data;
-}
-
-size_t TextBuffer::SpanLength(const til::point coordStart, const til::point coordEnd) const
-{
-    const auto bufferSize = GetSize();
-    // The coords are inclusive, so to get the (inclusive) length we add 1.
-    const auto length = bufferSize.CompareInBounds(coordEnd, coordStart) + 1;
-    return gsl::narrow<size_t>(length);
-}
-
-// Routine Description:
-// - Retrieves the plain text data between the specified coordinates.
-// Arguments:
-// - trimTrailingWhitespace - remove the trailing whitespace at the end of the result.
-// - start - where to start getting text (should be at or prior to "end")
-// - end - where to end getting text
-// Return Value:
-// - Just the text.
-std::wstring TextBuffer::GetPlainText(const til::point& start, const til::point& end) const
-{
-    std::wstring text;
-    auto spanLength = SpanLength(start, end);
-    text.reserve(spanLength);
-
-    auto it = GetCellDataAt(start);
-
-    for (; it && spanLength > 0; ++it, --spanLength)
-    {
-        const auto& cell = *it;
-        if (cell.DbcsAttr() != DbcsAttribute::Trailing)
-        {
-            const auto chars = cell.Chars();
-            text.append(chars);
-        }
-    }
-
-    return text;
-}
-
-// Routine Description:
-// - Generates a CF_HTML compliant structure based on the passed in text and color data
-// Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
-// Return Value:
-// - string containing the generated HTML
-std::string TextBuffer::GenHTML(const TextAndColor& rows,
-                                const int fontHeightPoints,
-                                const std::wstring_view fontFaceName,
-                                const COLORREF backgroundColor)
-{
-    try
-    {
-        std::ostringstream htmlBuilder;
-
-        // First we have to add some standard
-        // HTML boiler plate required for CF_HTML
-        // as part of the HTML Clipboard format
-        const std::string htmlHeader =
-            "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
-
-        htmlBuilder << "<!--StartFragment -->";
-
-        // apply global style in div element
-        {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
-            // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
-
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
-
-            // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
-
-            htmlBuilder << "\">";
-        }
-
-        // copy text and info color from buffer
-        auto hasWrittenAnyText = false;
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); row++)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                htmlBuilder << "<BR>";
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    if (hasWrittenAnyText)
-                    {
-                        htmlBuilder << "</SPAN>";
-                    }
-
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
-                }
-
-                hasWrittenAnyText = true;
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
-        }
-
-        if (hasWrittenAnyText)
-        {
-            // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
-        }
-
-        htmlBuilder << "</DIV>";
-
-        htmlBuilder << "<!--EndFragment -->";
-
-        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
-
-        // once filled with values, there will be exactly 157 bytes in the clipboard header
-        constexpr size_t ClipboardHeaderSize = 157;
-
-        // these values are byte offsets from start of clipboard
-        const auto htmlStartPos = ClipboardHeaderSize;
-        const auto htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const auto fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
-        const auto fragEndPos = htmlEndPos - HtmlFooter.length();
-
-        // header required by HTML 0.9 format
-        std::ostringstream clipHeaderBuilder;
-        clipHeaderBuilder << "Version:0.9\r\n";
-        clipHeaderBuilder << std::setfill('0');
-        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
-        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
-        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
-        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
-
-        return clipHeaderBuilder.str() + htmlBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
-    }
-}
-
-// Routine Description:
-// - Generates an RTF document based on the passed in text and color data
-//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
-// Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
-// - htmlTitle - value used in title tag of html header. Used to name the application
-// Return Value:
-// - string containing the generated RTF
-std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
-{
-    try
-    {
-        std::ostringstream rtfBuilder;
-
-        // start rtf
-        rtfBuilder << "{";
-
-        // Standard RTF header.
-        // This is similar to the header generated by WordPad.
-        // \ansi - specifies that the ANSI char set is used in the current doc
-        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
-        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
-        // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
-
-        // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
-
-        // map to keep track of colors:
-        // keys are colors represented by COLORREF
-        // values are indices of the corresponding colors in the color table
-        std::unordered_map<COLORREF, int> colorMap;
-        auto nextColorIndex = 1; // leave 0 for the default color and start from 1.
-
-        // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
-
-        // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
-
-        // paragraph styles
-        // \fs specifies font size in half-points i.e. \fs20 results in a font size
-        // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
-
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); ++row)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                contentBuilder << "\\line "; // new line
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto text = std::wstring_view{ rows.text.at(row) }.substr(startOffset, col - startOffset + includeCurrent);
-                        _AppendRTFText(contentBuilder, text);
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    auto bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
-
-                    auto fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
-
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
-                }
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
-        }
-
-        // end colortbl
-        colorTableBuilder << "}";
-
-        // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
-
-        // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
-
-        // end rtf
-        rtfBuilder << "}";
-
-        return rtfBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
-    }
-}
-
-void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
-{
-    for (const auto codeUnit : text)
-    {
-        if (codeUnit <= 127)
-        {
-            switch (codeUnit)
-            {
-            case L'\\':
-            case L'{':
-            case L'}':
-                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
-                break;
-            default:
-                contentBuilder << gsl::narrow<char>(codeUnit);
-            }
-        }
-        else
-        {
-            // Windows uses unsigned wchar_t - RTF uses signed ones.
-            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
-        }
-    }
-}
-
-// Function Description:
-// - Reflow the contents from the old buffer into the new buffer. The new buffer
-//   can have different dimensions than the old buffer. If it does, then this
-//   function will attempt to maintain the logical contents of the old buffer,
-//   by continuing wrapped lines onto the next line in the new buffer.
-// Arguments:
-// - oldBuffer - the text buffer to copy the contents FROM
-// - newBuffer - the text buffer to copy the contents TO
-// - lastCharacterViewport - Optional. If the caller knows that the last
-//   nonspace character is in a particular Viewport, the caller can provide this
-//   parameter as an optimization, as opposed to searching the entire buffer.
-// - positionInfo - Optional. The caller can provide a pair of rows in this
-//   parameter and we'll calculate the position of the _end_ of those rows in
-//   the new buffer. The rows's new value is placed back into this parameter.
-// Return Value:
-// - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
-HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
-                           TextBuffer& newBuffer,
-                           const std::optional<Viewport> lastCharacterViewport,
-                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
-try
-{
-    const auto& oldCursor = oldBuffer.GetCursor();
-    auto& newCursor = newBuffer.GetCursor();
-
-    // We need to save the old cursor position so that we can
-    // place the new cursor back on the equivalent character in
-    // the new buffer.
-    const auto cOldCursorPos = oldCursor.GetPosition();
-    const auto cOldLastChar = oldBuffer.GetLastNonSpaceCharacter(lastCharacterViewport);
-
-    const auto cOldRowsTotal = cOldLastChar.y + 1;
-
-    til::point cNewCursorPos;
-    auto fFoundCursorPos = false;
-    auto foundOldMutable = false;
-    auto foundOldVisible = false;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    til::CoordType iOldRow = 0;
-    for (; iOldRow < cOldRowsTotal; iOldRow++)
-    {
-        // Fetch the row and its "right" which is the last printable character.
-        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
-        const auto cOldColsTotal = oldBuffer.GetLineWidth(iOldRow);
-        auto iRight = row.MeasureRight();
-
-        // If we're starting a new row, try and preserve the line rendition
-        // from the row in the original buffer.
-        const auto newBufferPos = newCursor.GetPosition();
-        if (newBufferPos.x == 0)
-        {
-            auto& newRow = newBuffer.GetMutableRowByOffset(newBufferPos.y);
-            newRow.SetLineRendition(row.GetLineRendition());
-        }
-
-        // There is a special case here. If the row has a "wrap"
-        // flag on it, but the right isn't equal to the width (one
-        // index past the final valid index in the row) then there
-        // were a bunch trailing of spaces in the row.
-        // (But the measuring functions for each row Left/Right do
-        // not count spaces as "displayable" so they're not
-        // included.)
-        // As such, adjust the "right" to be the width of the row
-        // to capture all these spaces
-        if (row.WasWrapForced())
-        {
-            iRight = cOldColsTotal;
-
-            // And a combined special case.
-            // If we wrapped off the end of the row by adding a
-            // piece of padding because of a double byte LEADING
-            // character, then remove one from the "right" to
-            // leave this padding out of the copy process.
-            if (row.WasDoubleBytePadded())
-            {
-                iRight--;
-            }
-        }
-
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        til::CoordType iOldCol = 0;
-        const auto copyRight = iRight;
-        for (; iOldCol < copyRight; iOldCol++)
-        {
-            if (iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
-            {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
-            }
-
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto glyph = row.GlyphAt(iOldCol);
-            const auto dbcsAttr = row.DbcsAttrAt(iOldCol);
-            const auto textAttr = row.GetAttrByColumn(iOldCol);
-
-            newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr);
-        }
-
-        // GH#32: Copy the attributes from the rest of the row into this new buffer.
-        // From where we are in the old buffer, to the end of the row, copy the
-        // remaining attributes.
-        // - if the old buffer is smaller than the new buffer, then just copy
-        //   what we have, as it was. We already copied all _text_ with colors,
-        //   but it's possible for someone to just put some color into the
-        //   buffer to the right of that without any text (as just spaces). The
-        //   buffer looks weird to the user when we resize and it starts losing
-        //   those colors, so we need to copy them over too... as long as there
-        //   is space. The last attr in the row will be extended to the end of
-        //   the row in the new buffer.
-        // - if the old buffer is WIDER, than we might have wrapped onto a new
-        //   line. Use the cursor's position's Y so that we know where the new
-        //   row is, and start writing at the cursor position. Again, the attr
-        //   in the last column of the old row will be extended to the end of the
-        //   row that the text was flowed onto.
-        //   - if the text in the old buffer didn't actually fill the whole
-        //     line in the new buffer, then we didn't wrap. That's fine. just
-        //     copy attributes from the old row till the end of the new row, and
-        //     move on.
-        const auto newRowY = newCursor.GetPosition().y;
-        auto& newRow = newBuffer.GetMutableRowByOffset(newRowY);
-        auto newAttrColumn = newCursor.GetPosition().x;
-        const auto newWidth = newBuffer.GetLineWidth(newRowY);
-        // Stop when we get to the end of the buffer width, or the new position
-        // for inserting an attr would be past the right of the new buffer.
-        for (auto copyAttrCol = iOldCol;
-             copyAttrCol < cOldColsTotal && newAttrColumn < newWidth;
-             copyAttrCol++, newAttrColumn++)
-        {
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto textAttr = row.GetAttrByColumn(copyAttrCol);
-            newRow.SetAttrToEnd(newAttrColumn, textAttr);
-        }
-
-        // If we found the old row that the caller was interested in, set the
-        // out value of that parameter to the cursor's current Y position (the
-        // new location of the _end_ of that row in the buffer).
-        if (positionInfo.has_value())
-        {
-            if (!foundOldMutable)
-            {
-                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
-                {
-                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().y;
-                    foundOldMutable = true;
-                }
-            }
-
-            if (!foundOldVisible)
-            {
-                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
-                {
-                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().y;
-                    foundOldVisible = true;
-                }
-            }
-        }
-
-        // If we didn't have a full row to copy, insert a new
-        // line into the new buffer.
-        // Only do so if we were not forced to wrap. If we did
-        // force a word wrap, then the existing line break was
-        // only because we ran out of space.
-        if (iRight < cOldColsTotal && !row.WasWrapForced())
-        {
-            if (!fFoundCursorPos && (iRight == cOldCursorPos.x && iOldRow == cOldCursorPos.y))
-            {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
-            }
-            // Only do this if it's not the final line in the buffer.
-            // On the final line, we want the cursor to sit
-            // where it is done printing for the cursor
-            // adjustment to follow.
-            if (iOldRow < cOldRowsTotal - 1)
-            {
-                newBuffer.NewlineCursor();
-            }
-            else
-            {
-                // If we are on the final line of the buffer, we have one more check.
-                // We got into this code path because we are at the right most column of a row in the old buffer
-                // that had a hard return (no wrap was forced).
-                // However, as we're inserting, the old row might have just barely fit into the new buffer and
-                // caused a new soft return (wrap was forced) putting the cursor at x=0 on the line just below.
-                // We need to preserve the memory of the hard return at this point by inserting one additional
-                // hard newline, otherwise we've lost that information.
-                // We only do this when the cursor has just barely poured over onto the next line so the hard return
-                // isn't covered by the soft one.
-                // e.g.
-                // The old line was:
-                // |aaaaaaaaaaaaaaaaaaa | with no wrap which means there was a newline after that final a.
-                // The cursor was here ^
-                // And the new line will be:
-                // |aaaaaaaaaaaaaaaaaaa| and show a wrap at the end
-                // |                   |
-                //  ^ and the cursor is now there.
-                // If we leave it like this, we've lost the newline information.
-                // So we insert one more newline so a continued reflow of this buffer by resizing larger will
-                // continue to look as the original output intended with the newline data.
-                // After this fix, it looks like this:
-                // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
-                // |                   |
-                //  ^ and the cursor is now here.
-                const auto coordNewCursor = newCursor.GetPosition();
-                if (coordNewCursor.x == 0 && coordNewCursor.y > 0)
-                {
-                    if (newBuffer.GetRowByOffset(coordNewCursor.y - 1).WasWrapForced())
-                    {
-                        newBuffer.NewlineCursor();
-                    }
-                }
-            }
-        }
-    }
-
-    // Finish copying buffer attributes to remaining rows below the last
-    // printable character. This is to fix the `color 2f` scenario, where you
-    // change the buffer colors then resize and everything below the last
-    // printable char gets reset. See GH #12567
-    auto newRowY = newCursor.GetPosition().y + 1;
-    const auto newHeight = newBuffer.GetSize().Height();
-    const auto oldHeight = oldBuffer._estimateOffsetOfLastCommittedRow() + 1;
-    for (;
-         iOldRow < oldHeight && newRowY < newHeight;
-         iOldRow++)
-    {
-        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
-
-        // Optimization: Since all these rows are below the last printable char,
-        // we can reasonably assume that they are filled with just spaces.
-        // That's convenient, we can just copy the attr row from the old buffer
-        // into the new one, and resize the row to match. We'll rely on the
-        // behavior of ATTR_ROW::Resize to trim down when narrower, or extend
-        // the last attr when wider.
-        auto& newRow = newBuffer.GetMutableRowByOffset(newRowY);
-        const auto newWidth = newBuffer.GetLineWidth(newRowY);
-        newRow.TransferAttributes(row.Attributes(), newWidth);
-
-        newRowY++;
-    }
-
-    // Finish copying remaining parameters from the old text buffer to the new one
-    newBuffer.CopyProperties(oldBuffer);
-    newBuffer.CopyHyperlinkMaps(oldBuffer);
-
-    // If we found where to put the cursor while placing characters into the buffer,
-    //   just put the cursor there. Otherwise we have to advance manually.
-    if (fFoundCursorPos)
-    {
-        newCursor.SetPosition(cNewCursorPos);
-    }
-    else
-    {
-        // Advance the cursor to the same offset as before
-        // get the number of newlines and spaces between the old end of text and the old cursor,
-        //   then advance that many newlines and chars
-        auto iNewlines = cOldCursorPos.y - cOldLastChar.y;
-        const auto iIncrements = cOldCursorPos.x - cOldLastChar.x;
-        const auto cNewLastChar = newBuffer.GetLastNonSpaceCharacter();
-
-        // If the last row of the new buffer wrapped, there's going to be one less newline needed,
-        //   because the cursor is already on the next line
-        if (newBuffer.GetRowByOffset(cNewLastChar.y).WasWrapForced())
-        {
-            iNewlines = std::max(iNewlines - 1, 0);
-        }
-        else
-        {
-            // if this buffer didn't wrap, but the old one DID, then the d(columns) of the
-            //   old buffer will be one more than in this buffer, so new need one LESS.
-            if (oldBuffer.GetRowByOffset(cOldLastChar.y).WasWrapForced())
-            {
-                iNewlines = std::max(iNewlines - 1, 0);
-            }
-        }
-
-        for (auto r = 0; r < iNewlines; r++)
-        {
-            newBuffer.NewlineCursor();
-        }
-        for (auto c = 0; c < iIncrements - 1; c++)
-        {
-            newBuffer.IncrementCursor();
-        }
-    }
-
-    // Save old cursor size before we delete it
-    const auto ulSize = oldCursor.GetSize();
-
-    // Set size back to real size as it will be taking over the rendering duties.
-    newCursor.SetSize(ulSize);
-
-    newBuffer._marks = oldBuffer._marks;
-    newBuffer._trimMarksOutsideBuffer();
-
-    return S_OK;
-}
-CATCH_RETURN()
-
-// Method Description:
-// - Adds or updates a hyperlink in our hyperlink table
-// Arguments:
-// - The hyperlink URI, the hyperlink id (could be new or old)
-void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
-{
-    _hyperlinkMap[id] = uri;
-}
-
-// Method Description:
-// - Retrieves the URI associated with a particular hyperlink ID
-// Arguments:
-// - The hyperlink ID
-// Return Value:
-// - The URI
-std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
-{
-    return _hyperlinkMap.at(id);
-}
-
-// Method description:
-// - Provides the hyperlink ID to be assigned as a text attribute, based on the optional custom id provided
-// Arguments:
-// - The user-defined id
-// Return value:
-// - The internal hyperlink ID
-uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
-{
-    uint16_t numericId = 0;
-    if (id.empty())
-    {
-        // no custom id specified, return our internal count
-        numericId = _currentHyperlinkId;
-        ++_currentHyperlinkId;
-    }
-    else
-    {
-        // assign _currentHyperlinkId if the custom id does not already exist
-        std::wstring newId{ id };
-        // hash the URL and add it to the custom ID - GH#7698
-        newId += L"%" + std::to_wstring(til::hash(uri));
-        const auto result = _hyperlinkCustomIdMap.emplace(newId, _currentHyperlinkId);
-        if (result.second)
-        {
-            // the custom id did not already exist
-            ++_currentHyperlinkId;
-        }
-        numericId = (*(result.first)).second;
-    }
-    // _currentHyperlinkId could overflow, make sure its not 0
-    if (_currentHyperlinkId == 0)
-    {
-        ++_currentHyperlinkId;
-    }
-    return numericId;
-}
-
-// Method Description:
-// - Removes a hyperlink from the hyperlink map and the associated
-//   user defined id from the custom id map (if there is one)
-// Arguments:
-// - The ID of the hyperlink to be removed
-void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
-{
-    _hyperlinkMap.erase(id);
-    for (const auto& customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            _hyperlinkCustomIdMap.erase(customIdPair.first);
-            break;
-        }
-    }
-}
-
-// Method Description:
-// - Obtains the custom ID, if there was one, associated with the
-//   uint16_t id of a hyperlink
-// Arguments:
-// - The uint16_t id of the hyperlink
-// Return Value:
-// - The custom ID if there was one, empty string otherwise
-std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
-{
-    for (auto customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            return customIdPair.first;
-        }
-    }
-    return {};
-}
-
-// Method Description:
-// - Copies the hyperlink/customID maps of the old buffer into this one,
-//   also copies currentHyperlinkId
-// Arguments:
-// - The other buffer
-void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
-{
-    _hyperlinkMap = other._hyperlinkMap;
-    _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
-    _currentHyperlinkId = other._currentHyperlinkId;
-}
-
-// Searches through the entire (committed) text buffer for `needle` and returns the coordinates in absolute coordinates.
-// The end coordinates of the returned ranges are considered inclusive.
-std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive) const
-{
-    return SearchText(needle, caseInsensitive, 0, til::CoordTypeMax);
-}
-
-// Searches through the given rows [rowBeg,rowEnd) for `needle` and returns the coordinates in absolute coordinates.
-// While the end coordinates of the returned ranges are considered inclusive, the [rowBeg,rowEnd) range is half-open.
-std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const
-{
-    rowEnd = std::min(rowEnd, _estimateOffsetOfLastCommittedRow() + 1);
-
-    std::vector<til::point_span> results;
-
-    // All whitespace strings would match the not-yet-written parts of the TextBuffer which would be weird.
-    if (allWhitespace(needle) || rowBeg >= rowEnd)
-    {
-        return results;
-    }
-
-    auto text = ICU::UTextFromTextBuffer(*this, rowBeg, rowEnd);
-
-    uint32_t flags = UREGEX_LITERAL;
-    WI_SetFlagIf(flags, UREGEX_CASE_INSENSITIVE, caseInsensitive);
-
-    UErrorCode status = U_ZERO_ERROR;
-    const auto re = ICU::CreateRegex(needle, flags, &status);
-    uregex_setUText(re.get(), &text, &status);
-
-    if (uregex_find(re.get(), -1, &status))
-    {
-        do
-        {
-            results.emplace_back(ICU::BufferRangeFromMatch(&text, re.get()));
-        } while (uregex_findNext(re.get(), &status));
-    }
-
-    return results;
-}
-
-const std::vector<ScrollMark>& TextBuffer::GetMarks() const noexcept
-{
-    return _marks;
-}
-
-// Remove all marks between `start` & `end`, inclusive.
-void TextBuffer::ClearMarksInRange(
-    const til::point start,
-    const til::point end)
-{
-    auto inRange = [&start, &end](const ScrollMark& m) {
-        return (m.start >= start && m.start <= end) ||
-               (m.end >= start && m.end <= end);
-    };
-
-    _marks.erase(std::remove_if(_marks.begin(),
-                                _marks.end(),
-                                inRange),
-                 _marks.end());
-}
-void TextBuffer::ClearAllMarks() noexcept
-{
-    _marks.clear();
-}
-
-// Adjust all the marks in the y-direction by `delta`. Positive values move the
-// marks down (the positive y direction). Negative values move up. This will
-// trim marks that are no longer have a start in the bounds of the buffer
-void TextBuffer::ScrollMarks(const int delta)
-{
-    for (auto& mark : _marks)
-    {
-        mark.start.y += delta;
-
-        // If the mark had sub-regions, then move those pointers too
-        if (mark.commandEnd.has_value())
-        {
-            (*mark.commandEnd).y += delta;
-        }
-        if (mark.outputEnd.has_value())
-        {
-            (*mark.outputEnd).y += delta;
-        }
-    }
-    _trimMarksOutsideBuffer();
-}
-
-// Method Description:
-// - Add a mark to our list of marks, and treat it as the active "prompt". For
-//   the sake of shell integration, we need to know which mark represents the
-//   current prompt/command/output. Internally, we'll always treat the _last_
-//   mark in the list as the current prompt.
-// Arguments:
-// - m: the mark to add.
-void TextBuffer::StartPromptMark(const ScrollMark& m)
-{
-    _marks.push_back(m);
-}
-// Method Description:
-// - Add a mark to our list of marks. Don't treat this as the active prompt.
-//   This should be used for marks created by the UI or from other user input.
-//   By inserting at the start of the list, we can separate out marks that were
-//   generated by client programs vs ones created by the user.
-// Arguments:
-// - m: the mark to add.
-void TextBuffer::AddMark(const ScrollMark& m)
-{
-    _marks.insert(_marks.begin(), m);
-}
-
-void TextBuffer::_trimMarksOutsideBuffer()
-{
-    const auto height = GetSize().Height();
-    _marks.erase(std::remove_if(_marks.begin(),
-                                _marks.end(),
-                                [height](const auto& m) {
-                                    return (m.start.y < 0) ||
-                                           (m.start.y >= height);
-                                }),
-                 _marks.end());
-}
-
-std::wstring_view TextBuffer::CurrentCommand() const
-{
-    if (_marks.size() == 0)
-    {
-        return L"";
-    }
-
-    const auto& curr{ _marks.back() };
-    const auto& start{ curr.end };
-    const auto& end{ GetCursor().GetPosition() };
-
-    const auto line = start.y;
-    const auto& row = GetRowByOffset(line);
-    return row.GetText(start.x, end.x);
-}
-
-void TextBuffer::SetCurrentPromptEnd(const til::point pos) noexcept
-{
-    if (_marks.empty())
-    {
-        return;
-    }
-    auto& curr{ _marks.back() };
-    curr.end = pos;
-}
-void TextBuffer::SetCurrentCommandEnd(const til::point pos) noexcept
-{
-    if (_marks.empty())
-    {
-        return;
-    }
-    auto& curr{ _marks.back() };
-    curr.commandEnd = pos;
-}
-void TextBuffer::SetCurrentOutputEnd(const til::point pos, ::MarkCategory category) noexcept
-{
-    if (_marks.empty())
-    {
-        return;
-    }
-    auto& curr{ _marks.back() };
-    curr.outputEnd = pos;
-    curr.category = category;
-}
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "textBuffer.hpp"
+
+#include <til/hash.h>
+#include <til/unicode.h>
+
+#include "UTextAdapter.h"
+#include "../../types/inc/GlyphWidth.hpp"
+#include "../renderer/base/renderer.hpp"
+#include "../types/inc/convert.hpp"
+#include "../types/inc/utils.hpp"
+
+using namespace Microsoft::Console;
+using namespace Microsoft::Console::Types;
+
+using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+
+constexpr bool allWhitespace(const std::wstring_view& text) noexcept
+{
+    for (const auto ch : text)
+    {
+        if (ch != L' ')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::atomic<uint64_t> s_lastMutationIdInitialValue;
+static std::atomic<bool> s_largePagesEnabled;
+
+// Returns the size of a large page or 0 if this process can't allocate them. It needs the SeLockMemoryPrivilege,
+// which is usually only granted via group policy. It's enabled for the whole process once and the result is cached.
+static size_t largePageSize() noexcept
+{
+    static const auto size = []() noexcept -> size_t {
+        const auto minimum = GetLargePageMinimum();
+        if (minimum == 0)
+        {
+            return 0;
+        }
+
+        wil::unique_handle token;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, token.addressof()))
+        {
+            return 0;
+        }
+
+        TOKEN_PRIVILEGES privileges{};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        if (!LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid))
+        {
+            return 0;
+        }
+
+        // AdjustTokenPrivileges() also succeeds if the privilege wasn't granted and reports that via ERROR_NOT_ALL_ASSIGNED.
+        if (!AdjustTokenPrivileges(token.get(), FALSE, &privileges, 0, nullptr, nullptr) || GetLastError() != ERROR_SUCCESS)
+        {
+            return 0;
+        }
+
+        return minimum;
+    }();
+    return size;
+}
+
+// Routine Description:
+// - Creates a new instance of TextBuffer
+// Arguments:
+// - screenBufferSize - The X by Y dimensions of the new screen buffer
+// - defaultAttributes - The attributes with which the buffer will be initialized
+// - cursorSize - The height of the cursor within this buffer
+// - isActiveBuffer - Whether this is the currently active buffer
+// - renderer - The renderer to use for triggering a redraw
+// Return Value:
+// - constructed object
+// Note: may throw exception
+TextBuffer::TextBuffer(til::size screenBufferSize,
+                       const TextAttribute defaultAttributes,
+                       const UINT cursorSize,
+                       const bool isActiveBuffer,
+                       Microsoft::Console::Render::Renderer& renderer) :
+    _renderer{ renderer },
+    _currentAttributes{ defaultAttributes },
+    // This way every TextBuffer will start with a ""unique"" _lastMutationId
+    // and so it'll compare unequal with the counter of other TextBuffers.
+    _lastMutationId{ s_lastMutationIdInitialValue.fetch_add(0x100000000) },
+    _cursor{ cursorSize, *this },
+    _isActiveBuffer{ isActiveBuffer }
+{
+    // Guard against resizing the text buffer to 0 columns/rows, which would break being able to insert text.
+    screenBufferSize.width = std::max(screenBufferSize.width, 1);
+    screenBufferSize.height = std::max(screenBufferSize.height, 1);
+    _reserve(screenBufferSize, defaultAttributes);
+}
+
+TextBuffer::~TextBuffer()
+{
+    if (_buffer)
+    {
+        _destroy();
+    }
+}
+
+// I put these functions in a block at the start of the class, because they're the most
+// fundamental aspect of TextBuffer: It implements the basic gap buffer text storage.
+// It's also fairly tricky code.
+#pragma region buffer management
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// MEM_RESERVEs memory sufficient to store height-many ROW structs,
+// as well as their ROW::_chars and ROW::_charOffsets buffers.
+//
+// We use explicit virtual memory allocations to not taint the general purpose allocator
+// with our huge allocation, as well as to be able to reduce the private working set of
+// the application by only committing what we actually need. This reduces conhost's
+// memory usage from ~7MB down to just ~2MB at startup in the general case.
+void TextBuffer::_reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes)
+{
+    const auto w = gsl::narrow<uint16_t>(screenBufferSize.width);
+    const auto h = gsl::narrow<uint16_t>(screenBufferSize.height);
+
+    constexpr auto rowSize = ROW::CalculateRowSize();
+    const auto charsBufferSize = ROW::CalculateCharsBufferSize(w);
+    const auto charOffsetsBufferSize = ROW::CalculateCharOffsetsBufferSize(w);
+    const auto rowStride = rowSize + charsBufferSize + charOffsetsBufferSize;
+    assert(rowStride % alignof(ROW) == 0);
+
+    // 65535*65535 cells would result in a allocSize of 8GiB.
+    // --> Use uint64_t so that we can safely do our calculations even on x86.
+    // We allocate 1 additional row, which will be used for GetScratchpadRow().
+    const auto rowCount = ::base::strict_cast<uint64_t>(h) + 1;
+    const auto allocSize = gsl::narrow<size_t>(rowCount * rowStride);
+
+    // Large pages must be reserved and committed at once. If that fails, because the system
+    // is out of contiguous physical memory for instance, we fall back to regular pages.
+    void* buffer = nullptr;
+    auto largePages = false;
+    if (s_largePagesEnabled.load(std::memory_order_relaxed))
+    {
+        if (const auto pageSize = largePageSize(); pageSize != 0 && allocSize >= pageSize * _largePageMinimumCount)
+        {
+            const auto size = (allocSize + pageSize - 1) & ~(pageSize - 1);
+            buffer = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGE, PAGE_READWRITE);
+            largePages = buffer != nullptr;
+        }
+    }
+    if (!buffer)
+    {
+        buffer = THROW_LAST_ERROR_IF_NULL(VirtualAlloc(nullptr, allocSize, MEM_RESERVE, PAGE_READWRITE));
+    }
+
+    // NOTE: Modifications to this block of code might have to be mirrored over to ResizeTraditional().
+    // It constructs a temporary TextBuffer and then extracts the members below, overwriting itself.
+    _buffer = wil::unique_virtualalloc_ptr<std::byte>{ static_cast<std::byte*>(buffer) };
+    _bufferEnd = _buffer.get() + allocSize;
+    _largePages = largePages;
+    _commitWatermark = _buffer.get();
+    _initialAttributes = defaultAttributes;
+    _bufferRowStride = rowStride;
+    _bufferOffsetChars = rowSize;
+    _bufferOffsetCharOffsets = rowSize + charsBufferSize;
+    _width = w;
+    _height = h;
+    // Every block counts as modified when the buffer is created, which
+    // makes this buffer's rows appear modified to users of other buffers.
+    _rowMutationIds.assign(h, _lastMutationId);
+    _blockMutationIds.assign((h + _mutationBlockRowCount - 1) / _mutationBlockRowCount, _lastMutationId);
+    _rowGenerations.assign(gsl::narrow_cast<size_t>(rowCount), _rowGeneration);
+}
+
+// MEM_COMMITs the memory and constructs all ROWs up to and including the given row pointer.
+// It's expected that the caller verifies the parameter. It goes hand in hand with _getRowByOffsetDirect().
+//
+// Declaring this function as noinline allows _getRowByOffsetDirect() to be inlined,
+// which improves overall TextBuffer performance by ~6%. And all it cost is this annotation.
+// The compiler doesn't understand the likelihood of our branches. (PGO does, but that's imperfect.)
+__declspec(noinline) void TextBuffer::_commit(const std::byte* row)
+{
+    const auto rowEnd = row + _bufferRowStride;
+    const auto remaining = gsl::narrow_cast<uintptr_t>(_bufferEnd - _commitWatermark);
+    const auto minimum = gsl::narrow_cast<uintptr_t>(rowEnd - _commitWatermark);
+    const auto ideal = minimum + _bufferRowStride * _commitReadAheadRowCount;
+    const auto size = std::min(remaining, ideal);
+
+    if (!_largePages)
+    {
+        THROW_LAST_ERROR_IF_NULL(VirtualAlloc(_commitWatermark, size, MEM_COMMIT, PAGE_READWRITE));
+    }
+
+    // Newly constructed ROWs are blank and so they're up to date with the current _rowGeneration.
+    const auto beg = _rowGenerations.begin() + (_commitWatermark - _buffer.get()) / _bufferRowStride;
+    _construct(_commitWatermark + size);
+    const auto end = _rowGenerations.begin() + (_commitWatermark - _buffer.get()) / _bufferRowStride;
+    std::fill(beg, end, _rowGeneration);
+}
+
+// Commits and constructs the first `count` ROWs after the scratchpad row (by their position in memory) in a single
+// VirtualAlloc() call. Operations that are known to touch all of them, like filling a new buffer during Reflow(),
+// can use this to avoid going through _commit() once every _commitReadAheadRowCount rows.
+void TextBuffer::_commitRows(const size_t count)
+{
+    const auto row = _buffer.get() + _bufferRowStride * std::min(count, size_t{ _height });
+    if (count != 0 && row >= _commitWatermark)
+    {
+        _commit(row);
+    }
+}
+
+// Destructs and MEM_DECOMMITs all previously constructed ROWs.
+// You can use this (or rather the Recycle() method) to fully clear the TextBuffer.
+void TextBuffer::_decommit() noexcept
+{
+    _destroy();
+    _resetAttributeArenas(0, _height);
+    if (!_largePages)
+    {
+        VirtualFree(_buffer.get(), 0, MEM_DECOMMIT);
+    }
+    _commitWatermark = _buffer.get();
+    _coldBlocks.clear();
+    _coldBlockCount = 0;
+    _coldAttributes.clear();
+    _staleRowCount = 0;
+}
+
+// Constructs ROWs up to (excluding) the ROW pointed to by `until`.
+void TextBuffer::_construct(const std::byte* until) noexcept
+{
+    for (; _commitWatermark < until; _commitWatermark += _bufferRowStride)
+    {
+        _constructRow(_commitWatermark);
+    }
+}
+
+// Constructs a single ROW at the given address, which must point into committed memory.
+void TextBuffer::_constructRow(std::byte* row) const noexcept
+{
+    const auto chars = reinterpret_cast<wchar_t*>(row + _bufferOffsetChars);
+    const auto indices = reinterpret_cast<uint16_t*>(row + _bufferOffsetCharOffsets);
+    const auto offset = gsl::narrow_cast<size_t>((row - _buffer.get()) / _bufferRowStride);
+    AttributeArena* attributeArena = nullptr;
+
+    // The GetScratchpadRow() at offset 0 is reset all the time. There's no point in giving it an arena.
+    if (_attributeArenaEnabled && offset != 0)
+    {
+        attributeArena = &_attributeArenas[(offset - 1) / _attributeArenaRowCount];
+    }
+
+    std::construct_at(reinterpret_cast<ROW*>(row), chars, indices, _width, _initialAttributes, attributeArena);
+}
+
+// Destroys all previously constructed ROWs.
+// Be careful! This doesn't reset any of the members, in particular the _commitWatermark.
+void TextBuffer::_destroy() const noexcept
+{
+    size_t offset = 0;
+    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride, ++offset)
+    {
+        // ROWs in cold blocks have already been destroyed by _freezeColdBlock().
+        if (!_isColdRow(offset))
+        {
+            std::destroy_at(reinterpret_cast<ROW*>(it));
+        }
+    }
+}
+
+// Marks all constructed ROWs (including cold ones) as stale, which makes _getRowByOffsetDirect()
+// reset them to the given attributes once they're accessed next. This is O(1) except for the
+// _markAllRowsMutated() call, which is a plain memset of a few bytes per row.
+void TextBuffer::_invalidateRows(const TextAttribute& attributes) noexcept
+{
+    _rowGeneration++;
+    _staleRowAttributes = attributes;
+    // The scratchpad row is reset by each GetScratchpadRow() call anyway.
+    _staleRowCount = std::max<size_t>(1, (_commitWatermark - _buffer.get()) / _bufferRowStride) - 1;
+    til::at(_rowGenerations, 0) = _rowGeneration;
+    _markAllRowsMutated();
+}
+
+// Resets the ROW at the given offset if it was marked as stale by _invalidateRows().
+// This is noinline for the same reason as _commit(): It keeps _getRowByOffsetDirect() small.
+__declspec(noinline) void TextBuffer::_resetStaleRow(const size_t offset) noexcept
+{
+    auto& generation = til::at(_rowGenerations, offset);
+    if (generation != _rowGeneration)
+    {
+        generation = _rowGeneration;
+        _staleRowCount--;
+        reinterpret_cast<ROW*>(_buffer.get() + _bufferRowStride * offset)->Reset(_staleRowAttributes);
+    }
+}
+
+// Releases the memory of the AttributeArenas for the rows in the given range (by their position in memory, excluding
+// the scratchpad row), which must be a multiple of _attributeArenaRowCount. Their ROWs must have been destroyed already.
+void TextBuffer::_resetAttributeArenas(const size_t beg, const size_t end) noexcept
+{
+    if (!_attributeArenas)
+    {
+        return;
+    }
+
+    const auto arenaEnd = std::min<size_t>(end, _height + _attributeArenaRowCount - 1) / _attributeArenaRowCount;
+    for (auto arena = beg / _attributeArenaRowCount; arena < arenaEnd; ++arena)
+    {
+        _attributeArenas[arena].Reset();
+    }
+}
+
+// Returns the range of memory occupied by the ROWs of the given cold block.
+// Blocks start at offset 1, because offset 0 is the GetScratchpadRow(). The last block may be smaller than the others.
+std::pair<std::byte*, std::byte*> TextBuffer::_coldBlockRange(const size_t block) const noexcept
+{
+    const auto beg = block * _coldBlockRowCount + 1;
+    const auto end = std::min<size_t>(beg + _coldBlockRowCount, _height + 1u);
+    return { _buffer.get() + beg * _bufferRowStride, _buffer.get() + end * _bufferRowStride };
+}
+
+// Returns the range of memory pages that lie entirely within the given cold block.
+// The pages that it shares with neighboring blocks stay committed, which is fine, because blocks span dozens of pages.
+std::pair<uintptr_t, uintptr_t> TextBuffer::_coldBlockPageRange(const size_t block) const noexcept
+{
+    static constexpr uintptr_t pageSize = 4096;
+    const auto [beg, end] = _coldBlockRange(block);
+    const auto pageBeg = (reinterpret_cast<uintptr_t>(beg) + pageSize - 1) & ~(pageSize - 1);
+    const auto pageEnd = reinterpret_cast<uintptr_t>(end) & ~(pageSize - 1);
+    return { pageBeg, std::max(pageBeg, pageEnd) };
+}
+
+// Returns true if the ROW at the given offset (as used by _getRowByOffsetDirect()) is currently compressed.
+bool TextBuffer::_isColdRow(const size_t offset) const noexcept
+{
+    return _coldBlockCount != 0 && offset != 0 && !til::at(_coldBlocks, (offset - 1) / _coldBlockRowCount).empty();
+}
+
+// Compresses all ROWs in the given block, destroys them and decommits the memory pages that lie entirely within the block.
+void TextBuffer::_freezeColdBlock(const size_t block)
+{
+    // Large pages can't be decommitted, so compressing the block wouldn't save any memory.
+    if (_largePages)
+    {
+        return;
+    }
+
+    const auto [beg, end] = _coldBlockRange(block);
+    if (end > _commitWatermark || (!_coldBlocks.empty() && !til::at(_coldBlocks, block).empty()))
+    {
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    for (auto it = beg; it < end; it += _bufferRowStride)
+    {
+        reinterpret_cast<const ROW*>(it)->Compress(data, &_coldAttributes);
+    }
+    data.shrink_to_fit();
+
+    if (_coldBlocks.empty())
+    {
+        _coldBlocks.resize((_height + _coldBlockRowCount - 1) / _coldBlockRowCount);
+    }
+
+    // Nothing below this point throws and so the block cannot end up half frozen.
+    for (auto it = beg; it < end; it += _bufferRowStride)
+    {
+        std::destroy_at(reinterpret_cast<ROW*>(it));
+    }
+
+    // Cold blocks consist of whole attribute arenas, whose memory we can now release as well.
+    static_assert(_coldBlockRowCount % _attributeArenaRowCount == 0);
+    _resetAttributeArenas(block * _coldBlockRowCount, (block + 1) * _coldBlockRowCount);
+
+    const auto [pageBeg, pageEnd] = _coldBlockPageRange(block);
+    if (pageBeg < pageEnd)
+    {
+        VirtualFree(reinterpret_cast<void*>(pageBeg), pageEnd - pageBeg, MEM_DECOMMIT);
+    }
+
+    til::at(_coldBlocks, block) = std::move(data);
+    _coldBlockCount++;
+}
+
+// Recommits and decompresses the cold block that contains the ROW at the given offset, if there is one.
+// This is noinline for the same reason as _commit(): It keeps _getRowByOffsetDirect() small.
+__declspec(noinline) void TextBuffer::_thawColdBlock(const size_t offset)
+{
+    if (!_isColdRow(offset))
+    {
+        return;
+    }
+
+    const auto block = (offset - 1) / _coldBlockRowCount;
+    const auto [beg, end] = _coldBlockRange(block);
+    auto& data = til::at(_coldBlocks, block);
+
+    THROW_LAST_ERROR_IF_NULL(VirtualAlloc(beg, gsl::narrow_cast<size_t>(end - beg), MEM_COMMIT, PAGE_READWRITE));
+
+    auto it = data.data();
+    for (auto row = beg; row < end; row += _bufferRowStride)
+    {
+        _constructRow(row);
+        it = reinterpret_cast<ROW*>(row)->Decompress(it, &_coldAttributes);
+    }
+
+    data = {};
+    _coldBlockCount--;
+
+    // The handles are only referenced by cold blocks. Starting over avoids filling up the table over time.
+    if (_coldBlockCount == 0)
+    {
+        _coldAttributes.clear();
+    }
+}
+
+// This function is "direct" because it trusts the caller to properly wrap the "offset"
+// parameter modulo the _height of the buffer, etc. But keep in mind that a offset=0
+// is the GetScratchpadRow() and not the GetRowByOffset(0). That one is offset=1.
+ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
+{
+    const auto row = _buffer.get() + _bufferRowStride * offset;
+    THROW_HR_IF(E_UNEXPECTED, row < _buffer.get() || row >= _bufferEnd);
+
+    if (row >= _commitWatermark)
+    {
+        _commit(row);
+    }
+    else
+    {
+        if (_coldBlockCount != 0)
+        {
+            _thawColdBlock(offset);
+        }
+        if (_staleRowCount != 0)
+        {
+            _resetStaleRow(offset);
+        }
+    }
+
+    return *reinterpret_cast<ROW*>(row);
+}
+
+// Returns the position of the given row in the circular buffer, in the range [0, _height).
+til::CoordType TextBuffer::_getRowOffset(til::CoordType y) const noexcept
+{
+    // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
+    auto offset = (_firstRow + y) % _height;
+
+    // Support negative wrap around. This way an index of -1 will
+    // wrap to _rowCount-1 and make implementing scrolling easier.
+    if (offset < 0)
+    {
+        offset += _height;
+    }
+
+    return offset;
+}
+
+ROW& TextBuffer::_getRow(til::CoordType y) const
+{
+    // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
+#pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
+    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(gsl::narrow_cast<size_t>(_getRowOffset(y)) + 1);
+}
+
+// Marks all rows as modified, for operations that replace the contents of the entire buffer.
+void TextBuffer::_markAllRowsMutated() noexcept
+{
+    _lastMutationId++;
+    std::fill(_rowMutationIds.begin(), _rowMutationIds.end(), _lastMutationId);
+    std::fill(_blockMutationIds.begin(), _blockMutationIds.end(), _lastMutationId);
+}
+
+// Returns the "user-visible" index of the last committed row, which can be used
+// to short-circuit some algorithms that try to scan the entire buffer.
+// Returns 0 if no rows are committed in.
+til::CoordType TextBuffer::_estimateOffsetOfLastCommittedRow() const noexcept
+{
+    const auto lastRowOffset = (_commitWatermark - _buffer.get()) / _bufferRowStride;
+    // This subtracts 2 from the offset to account for the:
+    // * scratchpad row at offset 0, whereas regular rows start at offset 1.
+    // * fact that _commitWatermark points _past_ the last committed row,
+    //   but we want to return an index pointing at the last row.
+    return std::max(0, gsl::narrow_cast<til::CoordType>(lastRowOffset - 2));
+}
+
+// Retrieves a row from the buffer by its offset from the first row of the text buffer
+// (what corresponds to the top row of the screen buffer).
+const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
+{
+    return _getRow(index);
+}
+
+// Retrieves a row from the buffer by its offset from the first row of the text buffer
+// (what corresponds to the top row of the screen buffer).
+ROW& TextBuffer::GetMutableRowByOffset(const til::CoordType index)
+{
+    _lastMutationId++;
+
+    const auto offset = _getRowOffset(index);
+    til::at(_rowMutationIds, gsl::narrow_cast<size_t>(offset)) = _lastMutationId;
+    til::at(_blockMutationIds, gsl::narrow_cast<size_t>(offset) / _mutationBlockRowCount) = _lastMutationId;
+
+    return _getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
+}
+
+// Returns a row filled with whitespace and the current attributes, for you to freely use.
+ROW& TextBuffer::GetScratchpadRow()
+{
+    return GetScratchpadRow(_currentAttributes);
+}
+
+// Returns a row filled with whitespace and the given attributes, for you to freely use.
+ROW& TextBuffer::GetScratchpadRow(const TextAttribute& attributes)
+{
+    auto& r = _getRowByOffsetDirect(0);
+    r.Reset(attributes);
+    return r;
+}
+
+#pragma warning(pop)
+#pragma endregion
+
+// Routine Description:
+// - Copies properties from another text buffer into this one.
+// - This is primarily to copy properties that would otherwise not be specified during CreateInstance
+// Arguments:
+// - OtherBuffer - The text buffer to copy properties from
+// Return Value:
+// - <none>
+void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer) noexcept
+{
+    GetCursor().CopyProperties(OtherBuffer.GetCursor());
+}
+
+// Routine Description:
+// - Gets the number of rows in the buffer
+// Arguments:
+// - <none>
+// Return Value:
+// - Total number of rows in the buffer
+til::CoordType TextBuffer::TotalRowCount() const noexcept
+{
+    return _height;
+}
+
+// Method Description:
+// - Gets the number of glyphs in the buffer between two points.
+// - IMPORTANT: Make sure that start is before end, or this will never return!
+// Arguments:
+// - start - The starting point of the range to get the glyph count for.
+// - end - The ending point of the range to get the glyph count for.
+// Return Value:
+// - The number of glyphs in the buffer between the two points.
+size_t TextBuffer::GetCellDistance(const til::point from, const til::point to) const
+{
+    auto startCell = GetCellDataAt(from);
+    const auto endCell = GetCellDataAt(to);
+    auto delta = 0;
+    while (startCell != endCell)
+    {
+        ++startCell;
+        ++delta;
+    }
+    return delta;
+}
+
+// Routine Description:
+// - Retrieves read-only text iterator at the given buffer location
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// Return Value:
+// - Read-only iterator of text data only.
+TextBufferTextIterator TextBuffer::GetTextDataAt(const til::point at) const
+{
+    return TextBufferTextIterator(GetCellDataAt(at));
+}
+
+// Routine Description:
+// - Retrieves read-only cell iterator at the given buffer location
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// Return Value:
+// - Read-only iterator of cell data.
+TextBufferCellIterator TextBuffer::GetCellDataAt(const til::point at) const
+{
+    return TextBufferCellIterator(*this, at);
+}
+
+// Routine Description:
+// - Retrieves read-only text iterator at the given buffer location
+//   but restricted to only the specific line (Y coordinate).
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// Return Value:
+// - Read-only iterator of text data only.
+TextBufferTextIterator TextBuffer::GetTextLineDataAt(const til::point at) const
+{
+    return TextBufferTextIterator(GetCellLineDataAt(at));
+}
+
+// Routine Description:
+// - Retrieves read-only cell iterator at the given buffer location
+//   but restricted to only the specific line (Y coordinate).
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// Return Value:
+// - Read-only iterator of cell data.
+TextBufferCellIterator TextBuffer::GetCellLineDataAt(const til::point at) const
+{
+    til::inclusive_rect limit;
+    limit.top = at.y;
+    limit.bottom = at.y;
+    limit.left = 0;
+    limit.right = GetSize().RightInclusive();
+
+    return TextBufferCellIterator(*this, at, Viewport::FromInclusive(limit));
+}
+
+// Routine Description:
+// - Retrieves read-only text iterator at the given buffer location
+//   but restricted to operate only inside the given viewport.
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// - limit - boundaries for the iterator to operate within
+// Return Value:
+// - Read-only iterator of text data only.
+TextBufferTextIterator TextBuffer::GetTextDataAt(const til::point at, const Viewport limit) const
+{
+    return TextBufferTextIterator(GetCellDataAt(at, limit));
+}
+
+// Routine Description:
+// - Retrieves read-only cell iterator at the given buffer location
+//   but restricted to operate only inside the given viewport.
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// - limit - boundaries for the iterator to operate within
+// Return Value:
+// - Read-only iterator of cell data.
+TextBufferCellIterator TextBuffer::GetCellDataAt(const til::point at, const Viewport limit) const
+{
+    return TextBufferCellIterator(*this, at, limit);
+}
+
+//Routine Description:
+// - Call before inserting a character into the buffer.
+// - This will ensure a consistent double byte state (KAttrs line) within the text buffer
+// - It will attempt to correct the buffer if we're inserting an unexpected double byte character type
+//   and it will pad out the buffer if we're going to split a double byte sequence across two rows.
+//Arguments:
+// - dbcsAttribute - Double byte information associated with the character about to be inserted into the buffer
+//Return Value:
+// - true if we successfully prepared the buffer and moved the cursor
+// - false otherwise (out of memory)
+void TextBuffer::_PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute)
+{
+    // Now compensate if we don't have enough space for the upcoming double byte sequence
+    // We only need to compensate for leading bytes
+    if (dbcsAttribute == DbcsAttribute::Leading)
+    {
+        const auto cursorPosition = GetCursor().GetPosition();
+        const auto lineWidth = GetLineWidth(cursorPosition.y);
+
+        // If we're about to lead on the last column in the row, we need to add a padding space
+        if (cursorPosition.x == lineWidth - 1)
+        {
+            // set that we're wrapping for double byte reasons
+            auto& row = GetMutableRowByOffset(cursorPosition.y);
+            row.SetDoubleBytePadded(true);
+
+            // then move the cursor forward and onto the next row
+            IncrementCursor();
+        }
+    }
+}
+
+// Given the character offset `position` in the `chars` string, this function returns the starting position of the next grapheme.
+// For instance, given a `chars` of L"x\uD83D\uDE42y" and a `position` of 1 it'll return 3.
+// GraphemePrev would do the exact inverse of this operation.
+// In the future, these functions are expected to also deliver information about how many columns a grapheme occupies.
+size_t TextBuffer::GraphemeNext(const std::wstring_view& chars, size_t position) noexcept
+{
+    return til::utf16_grapheme_next(chars, position);
+}
+
+// It's the counterpart to GraphemeNext. See GraphemeNext.
+size_t TextBuffer::GraphemePrev(const std::wstring_view& chars, size_t position) noexcept
+{
+    return til::utf16_grapheme_prev(chars, position);
+}
+
+// Pretend as if `position` is a regular cursor in the TextBuffer.
+// This function will then pretend as if you pressed the left/right arrow
+// keys `distance` amount of times (negative = left, positive = right).
+til::point TextBuffer::NavigateCursor(til::point position, til::CoordType distance) const
+{
+    const til::CoordType maxX = _width - 1;
+    const til::CoordType maxY = _height - 1;
+    auto x = std::clamp(position.x, 0, maxX);
+    auto y = std::clamp(position.y, 0, maxY);
+    auto row = &GetRowByOffset(y);
+
+    if (distance < 0)
+    {
+        do
+        {
+            if (x > 0)
+            {
+                x = row->NavigateToPrevious(x);
+            }
+            else if (y <= 0)
+            {
+                break;
+            }
+            else
+            {
+                --y;
+                row = &GetRowByOffset(y);
+                x = row->GetReadableColumnCount() - 1;
+            }
+        } while (++distance != 0);
+    }
+    else if (distance > 0)
+    {
+        auto rowWidth = row->GetReadableColumnCount();
+
+        do
+        {
+            if (x < rowWidth)
+            {
+                x = row->NavigateToNext(x);
+            }
+            else if (y >= maxY)
+            {
+                break;
+            }
+            else
+            {
+                ++y;
+                row = &GetRowByOffset(y);
+                rowWidth = row->GetReadableColumnCount();
+                x = 0;
+            }
+        } while (--distance != 0);
+    }
+
+    return { x, y };
+}
+
+// This function is intended for writing regular "lines" of text as it'll set the wrap flag on the given row.
+// You can continue calling the function on the same row as long as state.columnEnd < state.columnLimit.
+void TextBuffer::Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state)
+{
+    auto& r = GetMutableRowByOffset(row);
+    r.ReplaceText(state);
+    r.ReplaceAttributes(state.columnBegin, state.columnEnd, attributes);
+    TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, row, state.columnEndDirty, row + 1 }));
+}
+
+// Fills an area of the buffer with a given fill character(s) and attributes.
+void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes)
+{
+    if (!rect || fill.empty())
+    {
+        return;
+    }
+
+    // Filling with a single narrow character (whitespace, most commonly) doesn't need
+    // the scratchpad row. ROW::FillText() generates the row contents directly.
+    if (fill.size() == 1 && !IsGlyphFullWidth(fill.front()))
+    {
+        RowWriteState state{
+            .text = fill,
+            .columnBegin = rect.left,
+            .columnLimit = rect.right,
+        };
+
+        for (auto y = rect.top; y < rect.bottom; ++y)
+        {
+            auto& r = GetMutableRowByOffset(y);
+            r.FillText(state);
+            r.ReplaceAttributes(rect.left, rect.right, attributes);
+            TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
+        }
+        return;
+    }
+
+    auto& scratchpad = GetScratchpadRow(attributes);
+
+    // The scratchpad row gets reset to whitespace by default, so there's no need to
+    // initialize it again. Filling with whitespace is the most common operation by far.
+    if (fill != L" ")
+    {
+        RowWriteState state{
+            .columnLimit = rect.right,
+            .columnEnd = rect.left,
+        };
+
+        // Fill the scratchpad row with consecutive copies of "fill" up to the amount we need.
+        //
+        // We don't just create a single string with N copies of "fill" and write that at once,
+        // because that might join neighboring combining marks unintentionally.
+        //
+        // Building the buffer this way is very wasteful and slow, but it's still 3x
+        // faster than what we had before and no one complained about that either.
+        // It's seldom used code and probably not worth optimizing for.
+        while (state.columnEnd < rect.right)
+        {
+            state.columnBegin = state.columnEnd;
+            state.text = fill;
+            scratchpad.ReplaceText(state);
+        }
+    }
+
+    // Fill the given rows with copies of the scratchpad row. That's a little
+    // slower when filling just a single row, but will be much faster for >1 rows.
+    {
+        RowCopyTextFromState state{
+            .source = scratchpad,
+            .columnBegin = rect.left,
+            .columnLimit = rect.right,
+            .sourceColumnBegin = rect.left,
+        };
+
+        for (auto y = rect.top; y < rect.bottom; ++y)
+        {
+            auto& r = GetMutableRowByOffset(y);
+            r.CopyTextFrom(state);
+            r.ReplaceAttributes(rect.left, rect.right, attributes);
+            TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
+        }
+    }
+}
+
+// Fills `count` cells starting at `target` with the given narrow character without changing their attributes,
+// continuing on the following rows up to the end of the buffer. This is the same as a Write() with a fill
+// OutputCellIterator, including that the wrap flag of each row filled up to its last column gets unset.
+// Return Value:
+// - The number of cells that were filled.
+size_t TextBuffer::FillCharacters(const til::point target, const size_t count, const wchar_t ch)
+{
+    if (!GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    RowWriteState state{
+        .text = { &ch, 1 },
+    };
+    size_t filled = 0;
+
+    for (auto pos = target; filled < count && pos.y < _height; pos.x = 0, ++pos.y)
+    {
+        const auto columns = std::min<size_t>(count - filled, gsl::narrow_cast<size_t>(_width - pos.x));
+        state.columnBegin = pos.x;
+        state.columnLimit = pos.x + gsl::narrow_cast<til::CoordType>(columns);
+
+        auto& r = GetMutableRowByOffset(pos.y);
+        r.FillText(state);
+        if (state.columnLimit == _width)
+        {
+            r.SetWrapForced(false);
+        }
+
+        TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, pos.y, state.columnEndDirty, pos.y + 1 }));
+        filled += columns;
+    }
+
+    return filled;
+}
+
+// Same as FillCharacters(), but only fills in the attributes and leaves the text and wrap flags alone.
+// Return Value:
+// - The number of cells that were filled.
+size_t TextBuffer::FillAttributes(const til::point target, const size_t count, const TextAttribute& attributes)
+{
+    if (!GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    size_t filled = 0;
+
+    for (auto pos = target; filled < count && pos.y < _height; pos.x = 0, ++pos.y)
+    {
+        const auto columns = std::min<size_t>(count - filled, gsl::narrow_cast<size_t>(_width - pos.x));
+        const auto columnEnd = pos.x + gsl::narrow_cast<til::CoordType>(columns);
+
+        GetMutableRowByOffset(pos.y).ReplaceAttributes(pos.x, columnEnd, attributes);
+        TriggerRedraw(Viewport::FromExclusive({ pos.x, pos.y, columnEnd, pos.y + 1 }));
+        filled += columns;
+    }
+
+    return filled;
+}
+
+// Writes a single row of CHAR_INFOs (as passed to WriteConsoleOutput) at the given position.
+// Cells past the end of the row are ignored, unlike Write() which would continue on the next row.
+void TextBuffer::WriteCharInfos(const std::span<const CHAR_INFO> charInfos, const til::point target)
+{
+    if (charInfos.empty() || !GetSize().IsInBounds(target))
+    {
+        return;
+    }
+
+    auto& r = GetMutableRowByOffset(target.y);
+    const auto columnEnd = r.WriteCharInfos(charInfos, target.x);
+    TriggerRedraw(Viewport::FromExclusive({ target.x, target.y, columnEnd, target.y + 1 }));
+}
+
+// Routine Description:
+// - Writes cells to the output buffer. Writes at the cursor.
+// Arguments:
+// - givenIt - Iterator representing output cell data to write
+// Return Value:
+// - The final position of the iterator
+OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt)
+{
+    const auto& cursor = GetCursor();
+    const auto target = cursor.GetPosition();
+
+    const auto finalIt = Write(givenIt, target);
+
+    return finalIt;
+}
+
+// Routine Description:
+// - Writes cells to the output buffer.
+// Arguments:
+// - givenIt - Iterator representing output cell data to write
+// - target - the row/column to start writing the text to
+// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data
+// Return Value:
+// - The final position of the iterator
+OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt,
+                                     const til::point target,
+                                     const std::optional<bool> wrap)
+{
+    // Make mutable copy so we can walk.
+    auto it = givenIt;
+
+    // Make mutable target so we can walk down lines.
+    auto lineTarget = target;
+
+    // Get size of the text buffer so we can stay in bounds.
+    const auto size = GetSize();
+
+    // While there's still data in the iterator and we're still targeting in bounds...
+    while (it && size.IsInBounds(lineTarget))
+    {
+        // Attempt to write as much data as possible onto this line.
+        // NOTE: if wrap = true/false, we want to set the line's wrap to true/false (respectively) if we reach the end of the line
+        it = WriteLine(it, lineTarget, wrap);
+
+        // Move to the next line down.
+        lineTarget.x = 0;
+        ++lineTarget.y;
+    }
+
+    return it;
+}
+
+// Routine Description:
+// - Writes one line of text to the output buffer.
+// Arguments:
+// - givenIt - The iterator that will dereference into cell data to insert
+// - target - Coordinate targeted within output buffer
+// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data in the iterator.
+// - limitRight - Optionally restrict the right boundary for writing (e.g. stop writing earlier than the end of line)
+// Return Value:
+// - The iterator, but advanced to where we stopped writing. Use to find input consumed length or cells written length.
+OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
+                                         const til::point target,
+                                         const std::optional<bool> wrap,
+                                         std::optional<til::CoordType> limitRight)
+{
+    // If we're not in bounds, exit early.
+    if (!GetSize().IsInBounds(target))
+    {
+        return givenIt;
+    }
+
+    //  Get the row and write the cells
+    auto& row = GetMutableRowByOffset(target.y);
+    const auto newIt = row.WriteCells(givenIt, target.x, wrap, limitRight);
+
+    // Take the cell distance written and notify that it needs to be repainted.
+    const auto written = newIt.GetCellDistance(givenIt);
+    const auto paint = Viewport::FromDimensions(target, { written, 1 });
+    TriggerRedraw(paint);
+
+    return newIt;
+}
+
+//Routine Description:
+// - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
+//Arguments:
+// - chars - The codepoint to insert
+// - dbcsAttribute - Double byte information associated with the codepoint
+// - bAttr - Color data associated with the character
+//Return Value:
+// - true if we successfully inserted the character
+// - false otherwise (out of memory)
+void TextBuffer::InsertCharacter(const std::wstring_view chars,
+                                 const DbcsAttribute dbcsAttribute,
+                                 const TextAttribute attr)
+{
+    // Ensure consistent buffer state for double byte characters based on the character type we're about to insert
+    _PrepareForDoubleByteSequence(dbcsAttribute);
+
+    // Get the current cursor position
+    const auto iRow = GetCursor().GetPosition().y; // row stored as logical position, not array position
+    const auto iCol = GetCursor().GetPosition().x; // column logical and array positions are equal.
+
+    // Get the row associated with the given logical position
+    auto& Row = GetMutableRowByOffset(iRow);
+
+    // Store character and double byte data
+    switch (dbcsAttribute)
+    {
+    case DbcsAttribute::Leading:
+        Row.ReplaceCharacters(iCol, 2, chars);
+        break;
+    case DbcsAttribute::Trailing:
+        Row.ReplaceCharacters(iCol - 1, 2, chars);
+        break;
+    default:
+        Row.ReplaceCharacters(iCol, 1, chars);
+        break;
+    }
+
+    // Store color data
+    Row.SetAttrToEnd(iCol, attr);
+    IncrementCursor();
+}
+
+//Routine Description:
+// - Inserts one ucs2 codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
+//Arguments:
+// - wch - The codepoint to insert
+// - dbcsAttribute - Double byte information associated with the codepoint
+// - bAttr - Color data associated with the character
+//Return Value:
+// - true if we successfully inserted the character
+// - false otherwise (out of memory)
+void TextBuffer::InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr)
+{
+    InsertCharacter({ &wch, 1 }, dbcsAttribute, attr);
+}
+
+//Routine Description:
+// - Finds the current row in the buffer (as indicated by the cursor position)
+//   and specifies that we have forced a line wrap on that row
+//Arguments:
+// - <none> - Always sets to wrap
+//Return Value:
+// - <none>
+void TextBuffer::_SetWrapOnCurrentRow()
+{
+    _AdjustWrapOnCurrentRow(true);
+}
+
+//Routine Description:
+// - Finds the current row in the buffer (as indicated by the cursor position)
+//   and specifies whether or not it should have a line wrap flag.
+//Arguments:
+// - fSet - True if this row has a wrap. False otherwise.
+//Return Value:
+// - <none>
+void TextBuffer::_AdjustWrapOnCurrentRow(const bool fSet)
+{
+    // The vertical position of the cursor represents the current row we're manipulating.
+    const auto uiCurrentRowOffset = GetCursor().GetPosition().y;
+
+    // Set the wrap status as appropriate
+    GetMutableRowByOffset(uiCurrentRowOffset).SetWrapForced(fSet);
+}
+
+//Routine Description:
+// - Increments the cursor one position in the buffer as if text is being typed into the buffer.
+// - NOTE: Will introduce a wrap marker if we run off the end of the current row
+//Arguments:
+// - <none>
+//Return Value:
+// - true if we successfully moved the cursor.
+// - false otherwise (out of memory)
+void TextBuffer::IncrementCursor()
+{
+    // Cursor position is stored as logical array indices (starts at 0) for the window
+    // Buffer Size is specified as the "length" of the array. It would say 80 for valid values of 0-79.
+    // So subtract 1 from buffer size in each direction to find the index of the final column in the buffer
+    const auto iFinalColumnIndex = GetLineWidth(GetCursor().GetPosition().y) - 1;
+
+    // Move the cursor one position to the right
+    GetCursor().IncrementXPosition(1);
+
+    // If we've passed the final valid column...
+    if (GetCursor().GetPosition().x > iFinalColumnIndex)
+    {
+        // Then mark that we've been forced to wrap
+        _SetWrapOnCurrentRow();
+
+        // Then move the cursor to a new line
+        NewlineCursor();
+    }
+}
+
+//Routine Description:
+// - Increments the cursor one line down in the buffer and to the beginning of the line
+//Arguments:
+// - <none>
+//Return Value:
+// - true if we successfully moved the cursor.
+void TextBuffer::NewlineCursor()
+{
+    const auto iFinalRowIndex = GetSize().BottomInclusive();
+
+    // Reset the cursor position to 0 and move down one line
+    GetCursor().SetXPosition(0);
+    GetCursor().IncrementYPosition(1);
+
+    // If we've passed the final valid row...
+    if (GetCursor().GetPosition().y > iFinalRowIndex)
+    {
+        // Stay on the final logical/offset row of the buffer.
+        GetCursor().SetYPosition(iFinalRowIndex);
+
+        // Instead increment the circular buffer to move us into the "oldest" row of the backing buffer
+        IncrementCircularBuffer();
+    }
+}
+
+//Routine Description:
+// - Increments the circular buffer by one. Circular buffer is represented by FirstRow variable.
+//Arguments:
+// - fillAttributes - the attributes with which the recycled row will be initialized.
+//Return Value:
+// - true if we successfully incremented the buffer.
+void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
+{
+    // FirstRow is at any given point in time the array index in the circular buffer that corresponds
+    // to the logical position 0 in the window (cursor coordinates and all other coordinates).
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerFlush(true);
+    }
+
+    // Preserve the row that is about to be recycled, if the scrollback archive is enabled.
+    if (_archive)
+    {
+        _archive->Append(GetRowByOffset(0));
+    }
+
+    // Prune hyperlinks to delete obsolete references
+    _PruneHyperlinks();
+
+    // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
+    GetMutableRowByOffset(0).Reset(fillAttributes);
+    // Its text is gone now, and so are its trigrams in the search index.
+    if (!_searchIndex.empty())
+    {
+        til::at(_searchIndex, gsl::narrow_cast<size_t>(_firstRow) / _mutationBlockRowCount).built = false;
+    }
+    {
+        // Now proceed to increment.
+        // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
+        _firstRow++;
+
+        // If we pass up the height of the buffer, loop back to 0.
+        if (_firstRow >= GetSize().Height())
+        {
+            _firstRow = 0;
+        }
+
+        _rotationCount++;
+    }
+
+    // Lastly, compress the block of ROWs that may have just aged out of the newest _hotRowCount rows.
+    // It's the one whose last ROW is now the row right above the hot ones. As long as the buffer is at least
+    // _hotRowCount+_coldBlockRowCount high, the block cannot wrap around into the hot rows at the bottom.
+    if (_height >= _hotRowCount + _coldBlockRowCount)
+    {
+        const auto offset = (gsl::narrow_cast<size_t>(_firstRow) + _height - _hotRowCount - 1) % _height;
+        if ((offset + 1) % _coldBlockRowCount == 0 || offset + 1 == _height)
+        {
+            _freezeColdBlock(offset / _coldBlockRowCount);
+        }
+    }
+}
+
+// Routine Description:
+// - Compresses all fully committed blocks of ROWs above the given row and decommits their memory, regardless
+//   of whether they're among the newest _hotRowCount rows. Unlike the freezing in IncrementCircularBuffer(),
+//   this also applies to buffers smaller than _hotRowCount+_coldBlockRowCount rows. This is meant for buffers
+//   that nobody looks at for a while, like those of hidden tabs. Accessing a ROW decompresses its block as usual.
+// Arguments:
+// - firstKeptRow - The blocks containing this row or any below it stay uncompressed. This should be the top
+//   of the viewport (or above), as the viewport is read all the time and where any new output goes.
+void TextBuffer::TrimWorkingSet(const til::CoordType firstKeptRow)
+{
+    const auto height = size_t{ _height };
+    const auto first = std::clamp<til::CoordType>(firstKeptRow, 0, _height - 1);
+    const auto keptBeg = gsl::narrow_cast<size_t>(_getRowOffset(first));
+    const auto keptCount = height - gsl::narrow_cast<size_t>(first);
+    const auto blockCount = (height + _coldBlockRowCount - 1) / _coldBlockRowCount;
+
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        // The kept rows are contiguous, but may wrap around the end of the buffer. A block intersects them
+        // if its first or last row is within keptCount rows from keptBeg (going forward with wrap around)
+        // or if it contains keptBeg, in which case the distance of its last row is smaller than that of its first.
+        const auto blockBeg = block * _coldBlockRowCount;
+        const auto blockLast = std::min(blockBeg + _coldBlockRowCount, height) - 1;
+        const auto distBeg = (blockBeg + height - keptBeg) % height;
+        const auto distLast = (blockLast + height - keptBeg) % height;
+        if (distBeg >= keptCount && distLast >= keptCount && distLast >= distBeg)
+        {
+            _freezeColdBlock(block);
+        }
+    }
+}
+
+// Routine Description:
+// - Estimates the memory used by this buffer. This walks all uncompressed ROWs and is cheap enough to be called
+//   every couple seconds, but not on every frame. It doesn't decompress any ROWs.
+// Return Value:
+// - The memory usage broken down into its largest contributors.
+TextBufferMemoryUsage TextBuffer::GetMemoryUsage() const noexcept
+{
+    TextBufferMemoryUsage usage;
+
+    usage.rows = gsl::narrow_cast<size_t>((_largePages ? _bufferEnd : _commitWatermark) - _buffer.get());
+    usage.rows += _rowGenerations.capacity() * sizeof(uint32_t);
+    usage.rows += (_rowMutationIds.capacity() + _blockMutationIds.capacity()) * sizeof(uint64_t);
+
+    if (_coldBlockCount != 0)
+    {
+        for (size_t block = 0; block < _coldBlocks.size(); ++block)
+        {
+            const auto& data = til::at(_coldBlocks, block);
+            if (!data.empty())
+            {
+                const auto [pageBeg, pageEnd] = _coldBlockPageRange(block);
+                usage.rows -= pageEnd - pageBeg;
+                usage.coldRows += data.capacity();
+            }
+        }
+        usage.coldRows += _coldAttributes.size() * sizeof(TextAttribute);
+    }
+
+    size_t offset = 0;
+    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride, ++offset)
+    {
+        if (_isColdRow(offset))
+        {
+            continue;
+        }
+
+        // A capacity of 1 means that the single run is stored inline. Runs allocated from an arena are accounted for below.
+        const auto& runs = reinterpret_cast<const ROW*>(it)->Attributes().runs();
+        if (runs.capacity() > 1 && !runs.get_allocator().arena)
+        {
+            usage.attributes += runs.capacity() * sizeof(runs[0]);
+        }
+    }
+
+    if (_attributeArenas)
+    {
+        const auto arenaCount = (size_t{ _height } + _attributeArenaRowCount - 1) / _attributeArenaRowCount;
+        for (size_t arena = 0; arena < arenaCount; ++arena)
+        {
+            usage.attributes += _attributeArenas[arena].GetReservedSize();
+        }
+    }
+
+    for (const auto& [id, uri] : _hyperlinkMap)
+    {
+        usage.hyperlinks += sizeof(id) + uri.capacity() * sizeof(wchar_t);
+    }
+    for (const auto& [customId, id] : _hyperlinkCustomIdMap)
+    {
+        usage.hyperlinks += sizeof(id) + customId.capacity() * sizeof(wchar_t);
+    }
+
+    usage.marks = _marks.capacity() * sizeof(ScrollMark);
+    for (const auto& mark : _marks)
+    {
+        usage.marks += mark.command.capacity() * sizeof(wchar_t);
+    }
+
+    usage.searchIndex = _searchIndex.capacity() * sizeof(SearchIndexBlock);
+    return usage;
+}
+
+// Routine Description:
+// - Enables or disables the scrollback archive. While enabled, every row that is recycled by
+//   IncrementCircularBuffer() is first appended to a file-backed ScrollbackArchive, which retains
+//   the history beyond the size of this buffer. Disabling it discards the archived rows.
+// Arguments:
+// - enabled - Whether to enable the archive.
+void TextBuffer::SetScrollbackArchiveEnabled(const bool enabled)
+{
+    if (!enabled)
+    {
+        _archive.reset();
+    }
+    else if (!_archive)
+    {
+        _archive = std::make_unique<ScrollbackArchive>();
+    }
+}
+
+// Routine Description:
+// - Enables or disables the index that SearchText() uses to skip over rows that cannot contain
+//   the needle. It's built as rows get searched and is most useful for large scrollbacks that
+//   are searched repeatedly, for instance while the user is typing the needle.
+// Arguments:
+// - enabled - Whether to enable the index.
+void TextBuffer::SetSearchIndexEnabled(const bool enabled) noexcept
+{
+    _searchIndexEnabled = enabled;
+    if (!enabled)
+    {
+        _searchIndex = {};
+    }
+}
+
+bool TextBuffer::IsSearchIndexEnabled() const noexcept
+{
+    return _searchIndexEnabled;
+}
+
+// Routine Description:
+// - Enables or disables allocating the attribute runs of ROWs from an AttributeArena per block of rows,
+//   which avoids most of the heap allocations of ReplaceAttributes() and TransferAttributes() and keeps
+//   the attributes of neighboring rows close together. Only affects ROWs constructed after this call.
+// Arguments:
+// - enabled - Whether to use the arenas.
+void TextBuffer::SetAttributeArenaEnabled(const bool enabled)
+{
+    if (enabled && !_attributeArenas)
+    {
+        _attributeArenas = std::make_unique<AttributeArena[]>((_height + _attributeArenaRowCount - 1) / _attributeArenaRowCount);
+    }
+    _attributeArenaEnabled = enabled;
+}
+
+bool TextBuffer::IsAttributeArenaEnabled() const noexcept
+{
+    return _attributeArenaEnabled;
+}
+
+// Routine Description:
+// - Makes TextBuffers that are constructed afterwards allocate their ROWs from large pages (usually 2MiB), if
+//   they're large enough and the process holds the SeLockMemoryPrivilege. Otherwise they silently use regular pages.
+//   This reduces TLB misses when walking through large scrollbacks, like when searching or reflowing them,
+//   at the cost of committing the entire buffer upfront and never compressing its cold blocks.
+// Arguments:
+// - enabled - Whether to use large pages where possible.
+void TextBuffer::SetLargePagesEnabled(const bool enabled) noexcept
+{
+    s_largePagesEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TextBuffer::IsUsingLargePages() const noexcept
+{
+    return _largePages;
+}
+
+// Routine Description:
+// - Returns the number of rows in the scrollback archive or 0 if it isn't enabled.
+size_t TextBuffer::GetArchivedRowCount() const noexcept
+{
+    return _archive ? _archive->size() : 0;
+}
+
+// Routine Description:
+// - Copies a row from the scrollback archive into the given row, for instance GetScratchpadRow().
+// Arguments:
+// - index - The index of the archived row, where 0 is the oldest one. Must be less than GetArchivedRowCount().
+// - row - The row to overwrite.
+void TextBuffer::ReadArchivedRow(const size_t index, ROW& row) const
+{
+    THROW_HR_IF(E_BOUNDS, index >= GetArchivedRowCount());
+    _archive->Read(index, row);
+}
+
+//Routine Description:
+// - Retrieves the position of the last non-space character in the given
+//   viewport
+// - By default, we search the entire buffer to find the last non-space
+//   character.
+// - If we know the last character is within the given viewport (so we don't
+//   need to check the entire buffer), we can provide a value in viewOptional
+//   that we'll use to search for the last character in.
+//Arguments:
+// - The viewport
+//Return value:
+// - Coordinate position (relative to the text buffer)
+til::point TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::Console::Types::Viewport> viewOptional) const
+{
+    const auto viewport = viewOptional.has_value() ? viewOptional.value() : GetSize();
+
+    til::point coordEndOfText;
+    // Search the given viewport by starting at the bottom.
+    coordEndOfText.y = std::min(viewport.BottomInclusive(), _estimateOffsetOfLastCommittedRow());
+
+    const auto& currRow = GetRowByOffset(coordEndOfText.y);
+    // The X position of the end of the valid text is the Right draw boundary (which is one beyond the final valid character)
+    coordEndOfText.x = currRow.MeasureRight() - 1;
+
+    // If the X coordinate turns out to be -1, the row was empty, we need to search backwards for the real end of text.
+    const auto viewportTop = viewport.Top();
+    auto fDoBackUp = (coordEndOfText.x < 0 && coordEndOfText.y > viewportTop); // this row is empty, and we're not at the top
+    while (fDoBackUp)
+    {
+        coordEndOfText.y--;
+        const auto& backupRow = GetRowByOffset(coordEndOfText.y);
+        // We need to back up to the previous row if this line is empty, AND there are more rows
+
+        coordEndOfText.x = backupRow.MeasureRight() - 1;
+        fDoBackUp = (coordEndOfText.x < 0 && coordEndOfText.y > viewportTop);
+    }
+
+    // don't allow negative results
+    coordEndOfText.y = std::max(coordEndOfText.y, 0);
+    coordEndOfText.x = std::max(coordEndOfText.x, 0);
+
+    return coordEndOfText;
+}
+
+// Routine Description:
+// - Retrieves the position of the previous character relative to the current cursor position
+// Arguments:
+// - <none>
+// Return Value:
+// - Coordinate position in screen coordinates of the character just before the cursor.
+// - NOTE: Will return 0,0 if already in the top left corner
+til::point TextBuffer::_GetPreviousFromCursor() const
+{
+    auto coordPosition = GetCursor().GetPosition();
+
+    // If we're not at the left edge, simply move the cursor to the left by one
+    if (coordPosition.x > 0)
+    {
+        coordPosition.x--;
+    }
+    else
+    {
+        // Otherwise, only if we're not on the top row (e.g. we don't move anywhere in the top left corner. there is no previous)
+        if (coordPosition.y > 0)
+        {
+            // move the cursor up one line
+            coordPosition.y--;
+
+            // and to the right edge
+            coordPosition.x = GetLineWidth(coordPosition.y) - 1;
+        }
+    }
+
+    return coordPosition;
+}
+
+const til::CoordType TextBuffer::GetFirstRowIndex() const noexcept
+{
+    return _firstRow;
+}
+
+const Viewport TextBuffer::GetSize() const noexcept
+{
+    return Viewport::FromDimensions({ _width, _height });
+}
+
+void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
+{
+    _firstRow = FirstRowIndex;
+}
+
+void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size, const til::CoordType delta)
+{
+    if (delta == 0)
+    {
+        return;
+    }
+
+    // Since the for() loop uses !=, we must ensure that size is positive.
+    // A negative size doesn't make any sense anyways.
+    size = std::max(0, size);
+
+    til::CoordType y = 0;
+    til::CoordType end = 0;
+    til::CoordType step = 0;
+
+    if (delta < 0)
+    {
+        // The layout is like this:
+        // delta is -2, size is 3, firstRow is 5
+        // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
+        // --- (storage) ----
+        // | 0 begin
+        // | 1
+        // | 2
+        // | 3 A. firstRow + delta (because delta is negative)
+        // | 4
+        // | 5 B. firstRow
+        // | 6
+        // | 7
+        // | 8 C. firstRow + size
+        // | 9
+        // | 10
+        // | 11
+        // - end
+        // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
+        y = firstRow;
+        end = firstRow + size;
+        step = 1;
+    }
+    else
+    {
+        // The layout is like this:
+        // delta is 2, size is 3, firstRow is 5
+        // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
+        // --- (storage) ----
+        // | 0 begin
+        // | 1
+        // | 2
+        // | 3
+        // | 4
+        // | 5 A. firstRow
+        // | 6
+        // | 7
+        // | 8 B. firstRow + size
+        // | 9
+        // | 10 C. firstRow + size + delta
+        // | 11
+        // - end
+        // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
+        y = firstRow + size - 1;
+        end = firstRow - 1;
+        step = -1;
+    }
+
+    for (; y != end; y += step)
+    {
+        GetMutableRowByOffset(y + delta).CopyFrom(GetRowByOffset(y));
+    }
+}
+
+// Copies the cells (text and attributes) within the source rectangle so that its top left corner ends up at target.
+// Unlike ScrollRows() this works for any rectangle, even if it isn't full-width, and the source and target may overlap.
+void TextBuffer::CopyRect(const til::rect& source, const til::point target)
+{
+    const auto width = source.width();
+    const auto height = source.height();
+
+    if (width <= 0 || height <= 0 || (source.left == target.x && source.top == target.y))
+    {
+        return;
+    }
+
+    // If the rectangle moves down, we need to start with the bottom row,
+    // or we would overwrite source rows before we got a chance to copy them.
+    const auto bottomUp = target.y > source.top;
+
+    for (til::CoordType i = 0; i < height; ++i)
+    {
+        const auto dy = bottomUp ? height - 1 - i : i;
+        const auto y = target.y + dy;
+        const auto* src = &GetRowByOffset(source.top + dy);
+        auto& dst = GetMutableRowByOffset(y);
+
+        // A row can't be copied onto itself, because the text would be overwritten while
+        // it's being read. If the rectangle moves horizontally, the scratchpad row holds a copy.
+        if (src == &dst)
+        {
+            auto& scratchpad = GetScratchpadRow();
+            RowCopyTextFromState state{
+                .source = *src,
+                .columnBegin = source.left,
+                .columnLimit = source.right,
+                .sourceColumnBegin = source.left,
+                .sourceColumnLimit = source.right,
+            };
+            scratchpad.CopyCellsFrom(state);
+            src = &scratchpad;
+        }
+
+        RowCopyTextFromState state{
+            .source = *src,
+            .columnBegin = target.x,
+            .columnLimit = target.x + width,
+            .sourceColumnBegin = source.left,
+            .sourceColumnLimit = source.right,
+        };
+        dst.CopyCellsFrom(state);
+        TriggerRedraw(Viewport::FromExclusive({ state.columnBeginDirty, y, state.columnEndDirty, y + 1 }));
+    }
+}
+
+Cursor& TextBuffer::GetCursor() noexcept
+{
+    return _cursor;
+}
+
+const Cursor& TextBuffer::GetCursor() const noexcept
+{
+    return _cursor;
+}
+
+uint64_t TextBuffer::GetLastMutationId() const noexcept
+{
+    return _lastMutationId;
+}
+
+// Returns how often IncrementCircularBuffer() has been called. Coordinates that
+// were retrieved before need to be moved up by the difference between two calls.
+uint64_t TextBuffer::GetRotationCount() const noexcept
+{
+    return _rotationCount;
+}
+
+// Routine Description:
+// - Returns the first row that has been modified since GetLastMutationId() returned `mutationId`, in current coordinates.
+//   Rows that were recycled by IncrementCircularBuffer() count as modified.
+// Arguments:
+// - mutationId - A value previously returned by GetLastMutationId(), possibly of another TextBuffer.
+// Return Value:
+// - The first modified row or TotalRowCount() if there's none.
+til::CoordType TextBuffer::GetFirstRowMutatedSince(const uint64_t mutationId) const noexcept
+{
+    return GetFirstRowMutatedSince(mutationId, 0, _height);
+}
+
+// Routine Description:
+// - Same as above, but only considers the rows in the half-open range [rowBeg,rowEnd).
+// Return Value:
+// - The first modified row in the range or rowEnd if there's none.
+til::CoordType TextBuffer::GetFirstRowMutatedSince(const uint64_t mutationId, til::CoordType rowBeg, til::CoordType rowEnd) const noexcept
+{
+    rowBeg = std::max(rowBeg, 0);
+    rowEnd = std::min(rowEnd, gsl::narrow_cast<til::CoordType>(_height));
+
+    for (auto y = rowBeg; y < rowEnd;)
+    {
+        // The remaining rows in the block are contiguous in memory and so
+        // also in coordinates, unless the circular buffer wraps around.
+        const auto offset = gsl::narrow_cast<size_t>(_getRowOffset(y));
+        const auto block = offset / _mutationBlockRowCount;
+        const auto blockEnd = std::min<size_t>((block + 1) * _mutationBlockRowCount, _height);
+        const auto end = std::min(rowEnd, y + gsl::narrow_cast<til::CoordType>(blockEnd - offset));
+
+        if (til::at(_blockMutationIds, block) <= mutationId)
+        {
+            y = end;
+            continue;
+        }
+
+        for (auto i = offset; y < end; ++i, ++y)
+        {
+            if (til::at(_rowMutationIds, i) > mutationId)
+            {
+                return y;
+            }
+        }
+    }
+
+    return rowEnd;
+}
+
+// Returns true if the given row has been modified since GetLastMutationId() returned `mutationId`.
+bool TextBuffer::IsRowMutatedSince(const til::CoordType y, const uint64_t mutationId) const noexcept
+{
+    return til::at(_rowMutationIds, gsl::narrow_cast<size_t>(_getRowOffset(y))) > mutationId;
+}
+
+// Routine Description:
+// - Copies the rows [rowBeg,rowEnd) into the given snapshot, which can then be read without holding the lock.
+// - If the snapshot was last updated from this buffer, only the rows that were modified since then are copied.
+//   The others are still up to date and get moved into place by rotating the snapshot, which makes keeping
+//   a snapshot of, for instance, the viewport up to date a lot cheaper than copying it over and over again.
+// Arguments:
+// - snapshot - The snapshot to update. It's created on first use and whenever the size of the range changes.
+// - rowBeg, rowEnd - The half-open range of rows to copy.
+void TextBuffer::UpdateSnapshot(TextBufferSnapshot& snapshot, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    rowBeg = std::clamp(rowBeg, 0, gsl::narrow_cast<til::CoordType>(_height));
+    rowEnd = std::clamp(rowEnd, rowBeg, gsl::narrow_cast<til::CoordType>(_height));
+
+    const auto rowCount = rowEnd - rowBeg;
+    // A TextBuffer can't be empty. An empty range results in a snapshot with a single blank row.
+    const til::size size{ _width, std::max(1, rowCount) };
+    const auto rotations = _rotationCount - snapshot.rotationCount;
+    auto reusable = snapshot.buffer && snapshot.source == this && rotations < gsl::narrow_cast<uint64_t>(_height);
+
+    if (!snapshot.buffer || snapshot.buffer->GetSize().Dimensions() != size)
+    {
+        snapshot.buffer = std::make_unique<TextBuffer>(size, _initialAttributes, _cursor.GetSize(), false, _renderer);
+        reusable = false;
+    }
+
+    auto& dst = *snapshot.buffer;
+    til::CoordType shift = 0;
+
+    if (reusable)
+    {
+        // Row y of the snapshot contains what's now row snapshot.firstRow + y - rotations of this buffer.
+        // Rotating the snapshot by the difference moves the rows that are still in the range into place.
+        shift = rowBeg - snapshot.firstRow + gsl::narrow_cast<til::CoordType>(rotations);
+        dst._firstRow = ((dst._firstRow + shift) % dst._height + dst._height) % dst._height;
+    }
+
+    for (til::CoordType y = 0; y < rowCount; ++y)
+    {
+        const auto previous = y + shift;
+        if (reusable && previous >= 0 && previous < rowCount && !IsRowMutatedSince(rowBeg + y, snapshot.mutationId))
+        {
+            continue;
+        }
+        dst.GetMutableRowByOffset(y).CopyFrom(GetRowByOffset(rowBeg + y));
+    }
+
+    snapshot.firstRow = rowBeg;
+    snapshot.source = this;
+    snapshot.mutationId = _lastMutationId;
+    snapshot.rotationCount = _rotationCount;
+}
+
+const TextAttribute& TextBuffer::GetCurrentAttributes() const noexcept
+{
+    return _currentAttributes;
+}
+
+void TextBuffer::SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept
+{
+    _currentAttributes = currentAttributes;
+}
+
+void TextBuffer::SetWrapForced(const til::CoordType y, bool wrap)
+{
+    GetMutableRowByOffset(y).SetWrapForced(wrap);
+}
+
+void TextBuffer::SetCurrentLineRendition(const LineRendition lineRendition, const TextAttribute& fillAttributes)
+{
+    const auto cursorPosition = GetCursor().GetPosition();
+    const auto rowIndex = cursorPosition.y;
+    auto& row = GetMutableRowByOffset(rowIndex);
+    if (row.GetLineRendition() != lineRendition)
+    {
+        row.SetLineRendition(lineRendition);
+        // If the line rendition has changed, the row can no longer be wrapped.
+        row.SetWrapForced(false);
+        // And if it's no longer single width, the right half of the row should be erased.
+        if (lineRendition != LineRendition::SingleWidth)
+        {
+            const auto fillChar = L' ';
+            const auto fillOffset = GetLineWidth(rowIndex);
+            const auto fillLength = gsl::narrow<size_t>(GetSize().Width() - fillOffset);
+            const OutputCellIterator fillData{ fillChar, fillAttributes, fillLength };
+            row.WriteCells(fillData, fillOffset, false);
+            // We also need to make sure the cursor is clamped within the new width.
+            GetCursor().SetPosition(ClampPositionWithinLine(cursorPosition));
+        }
+        TriggerRedraw(Viewport::FromDimensions({ 0, rowIndex }, { GetSize().Width(), 1 }));
+    }
+}
+
+void TextBuffer::ResetLineRenditionRange(const til::CoordType startRow, const til::CoordType endRow)
+{
+    for (auto row = startRow; row < endRow; row++)
+    {
+        GetMutableRowByOffset(row).SetLineRendition(LineRendition::SingleWidth);
+    }
+}
+
+LineRendition TextBuffer::GetLineRendition(const til::CoordType row) const
+{
+    return GetRowByOffset(row).GetLineRendition();
+}
+
+bool TextBuffer::IsDoubleWidthLine(const til::CoordType row) const
+{
+    return GetLineRendition(row) != LineRendition::SingleWidth;
+}
+
+til::CoordType TextBuffer::GetLineWidth(const til::CoordType row) const
+{
+    // Use shift right to quickly divide the width by 2 for double width lines.
+    const auto scale = IsDoubleWidthLine(row) ? 1 : 0;
+    return GetSize().Width() >> scale;
+}
+
+til::point TextBuffer::ClampPositionWithinLine(const til::point position) const
+{
+    const auto rightmostColumn = GetLineWidth(position.y) - 1;
+    return { std::min(position.x, rightmostColumn), position.y };
+}
+
+til::point TextBuffer::ScreenToBufferPosition(const til::point position) const
+{
+    // Use shift right to quickly divide the X pos by 2 for double width lines.
+    const auto scale = IsDoubleWidthLine(position.y) ? 1 : 0;
+    return { position.x >> scale, position.y };
+}
+
+til::point TextBuffer::BufferToScreenPosition(const til::point position) const
+{
+    // Use shift left to quickly multiply the X pos by 2 for double width lines.
+    const auto scale = IsDoubleWidthLine(position.y) ? 1 : 0;
+    return { position.x << scale, position.y };
+}
+
+// Routine Description:
+// - Resets the text contents of this buffer with the default character
+//   and the default current color attributes
+// - The ROWs are only marked as stale and get reset once they're accessed next,
+//   which makes this O(1) no matter how large the scrollback is.
+void TextBuffer::Reset() noexcept
+{
+    _initialAttributes = _currentAttributes;
+    _invalidateRows(_currentAttributes);
+}
+
+// Routine Description:
+// - Erases all rows from the given one to the end of the buffer, as if they were filled with
+//   whitespace and the given attributes. The erased ROWs are only marked as stale,
+//   which makes this O(y) instead of O(buffer height).
+// Arguments:
+// - y - the first row to be erased
+// - attributes - the attributes of the erased rows
+void TextBuffer::ResetRowsFrom(til::CoordType y, const TextAttribute& attributes)
+{
+    y = std::clamp<til::CoordType>(y, 0, _height);
+    if (y == _height)
+    {
+        return;
+    }
+
+    // The rows that are kept must be up to date before they're kept out of the invalidation below.
+    // This also ensures that they're committed, so that the new _initialAttributes only apply to erased rows.
+    for (til::CoordType i = 0; i < y; ++i)
+    {
+        _getRow(i);
+    }
+
+    _initialAttributes = attributes;
+    _invalidateRows(attributes);
+
+    for (til::CoordType i = 0; i < y; ++i)
+    {
+        til::at(_rowGenerations, gsl::narrow_cast<size_t>(_getRowOffset(i)) + 1) = _rowGeneration;
+        _staleRowCount--;
+    }
+
+    TriggerRedraw(Viewport::FromExclusive({ 0, y, _width, _height }));
+}
+
+// Routine Description:
+// - Makes this buffer equivalent to a newly constructed one of the same size, so that it can be reused
+//   instead of allocating a new one. Unlike Reset() this also drops the cursor state, marks and hyperlinks.
+// - Only the rows that were committed so far need to be destroyed, which makes this much cheaper
+//   than a new TextBuffer for a buffer that is repeatedly swapped in and out, like the alternate screen.
+// Arguments:
+// - attributes - the attributes the buffer is filled with, like the constructor's defaultAttributes.
+void TextBuffer::Recycle(const TextAttribute& attributes) noexcept
+{
+    _currentAttributes = attributes;
+    _decommit();
+    _initialAttributes = attributes;
+    _markAllRowsMutated();
+    _cursor.Reset();
+    ClearAllMarks();
+    _hyperlinkMap.clear();
+    _hyperlinkCustomIdMap.clear();
+    _currentHyperlinkId = 1;
+    _hyperlinkPruneCandidates.clear();
+    _rotationsSinceHyperlinkPrune = 0;
+}
+
+// Routine Description:
+// - This is the legacy screen resize with minimal changes
+// Arguments:
+// - newSize - new size of screen.
+// Return Value:
+// - Success if successful. Invalid parameter if screen buffer size is unexpected. No memory if allocation failed.
+[[nodiscard]] NTSTATUS TextBuffer::ResizeTraditional(til::size newSize) noexcept
+{
+    // Guard against resizing the text buffer to 0 columns/rows, which would break being able to insert text.
+    newSize.width = std::max(newSize.width, 1);
+    newSize.height = std::max(newSize.height, 1);
+
+    try
+    {
+        TextBuffer newBuffer{ newSize, _currentAttributes, 0, false, _renderer };
+        newBuffer.SetAttributeArenaEnabled(_attributeArenaEnabled);
+        const auto cursorRow = GetCursor().GetPosition().y;
+        const auto copyableRows = std::min<til::CoordType>(_height, newSize.height);
+        til::CoordType srcRow = 0;
+        til::CoordType dstRow = 0;
+
+        if (cursorRow >= newSize.height)
+        {
+            srcRow = cursorRow - newSize.height + 1;
+        }
+
+        for (; dstRow < copyableRows; ++dstRow, ++srcRow)
+        {
+            newBuffer.GetMutableRowByOffset(dstRow).CopyFrom(GetRowByOffset(srcRow));
+        }
+
+        // NOTE: Keep this in sync with _reserve().
+        _buffer = std::move(newBuffer._buffer);
+        _bufferEnd = newBuffer._bufferEnd;
+        _largePages = newBuffer._largePages;
+        _commitWatermark = newBuffer._commitWatermark;
+        _initialAttributes = newBuffer._initialAttributes;
+        _bufferRowStride = newBuffer._bufferRowStride;
+        _bufferOffsetChars = newBuffer._bufferOffsetChars;
+        _bufferOffsetCharOffsets = newBuffer._bufferOffsetCharOffsets;
+        _width = newBuffer._width;
+        _height = newBuffer._height;
+        _coldBlocks = std::move(newBuffer._coldBlocks);
+        _coldBlockCount = newBuffer._coldBlockCount;
+        _coldAttributes = std::move(newBuffer._coldAttributes);
+        _attributeArenaEnabled = newBuffer._attributeArenaEnabled;
+        _attributeArenas = std::move(newBuffer._attributeArenas);
+        _rowMutationIds = std::move(newBuffer._rowMutationIds);
+        _blockMutationIds = std::move(newBuffer._blockMutationIds);
+        _rowGeneration = newBuffer._rowGeneration;
+        _rowGenerations = std::move(newBuffer._rowGenerations);
+        _staleRowCount = newBuffer._staleRowCount;
+        _staleRowAttributes = newBuffer._staleRowAttributes;
+        _searchIndex.clear();
+
+        _SetFirstRowIndex(0);
+        _markAllRowsMutated();
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
+{
+    _isActiveBuffer = isActiveBuffer;
+}
+
+bool TextBuffer::IsActiveBuffer() const noexcept
+{
+    return _isActiveBuffer;
+}
+
+Microsoft::Console::Render::Renderer& TextBuffer::GetRenderer() noexcept
+{
+    return _renderer;
+}
+
+void TextBuffer::TriggerRedraw(const Viewport& viewport)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedraw(viewport);
+    }
+}
+
+void TextBuffer::TriggerRedrawCursor(const til::point position)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedrawCursor(&position);
+    }
+}
+
+void TextBuffer::TriggerRedrawAll()
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerRedrawAll();
+    }
+}
+
+void TextBuffer::TriggerScroll()
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerScroll();
+    }
+}
+
+void TextBuffer::TriggerScroll(const til::point delta)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerScroll(&delta);
+    }
+}
+
+void TextBuffer::TriggerScrollRegion(const Viewport& region, const til::CoordType delta)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerScrollRegion(region, delta);
+    }
+}
+
+void TextBuffer::TriggerNewTextNotification(const std::wstring_view newText)
+{
+    if (_isActiveBuffer)
+    {
+        _renderer.TriggerNewTextNotification(newText);
+    }
+}
+
+// Method Description:
+// - get the lookup table that classifies chars for the given word delimiters
+// - it's cached, because the delimiters only change when the settings do
+// Arguments:
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - the lookup table for the given delimiters
+const DelimiterClassTable& TextBuffer::_GetDelimiterClasses(const std::wstring_view wordDelimiters) const
+{
+    if (_delimiterClasses.Delimiters() != wordDelimiters)
+    {
+        _delimiterClasses = DelimiterClassTable{ wordDelimiters };
+    }
+    return _delimiterClasses;
+}
+
+// Method Description:
+// - get delimiter class for buffer cell position
+// - used for double click selection and uia word navigation
+// Arguments:
+// - pos: the buffer cell under observation
+// - classes: the lookup table for the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - the delimiter class for the given char
+DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const DelimiterClassTable& classes) const
+{
+    return GetRowByOffset(pos.y).DelimiterClassAt(pos.x, classes);
+}
+
+// Method Description:
+// - Get the til::point for the beginning of the word you are on
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - wordDelimiters - what characters are we considering for the separation of words
+// - accessibilityMode - when enabled, we continue expanding left until we are at the beginning of a readable word.
+//                        Otherwise, expand left until a character of a new delimiter class is found
+//                        (or a row boundary is encountered)
+// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
+// Return Value:
+// - The til::point for the first character on the "word" (inclusive)
+til::point TextBuffer::GetWordStart(const til::point target, const std::wstring_view wordDelimiters, bool accessibilityMode, std::optional<til::point> limitOptional) const
+{
+    // Consider a buffer with this text in it:
+    // "  word   other  "
+    // In selection (accessibilityMode = false),
+    //  a "word" is defined as the range between two delimiters
+    //  so the words in the example include ["  ", "word", "   ", "other", "  "]
+    // In accessibility (accessibilityMode = true),
+    //  a "word" includes the delimiters after a range of readable characters
+    //  so the words in the example include ["word   ", "other  "]
+    // NOTE: the start anchor (this one) is inclusive, whereas the end anchor (GetWordEnd) is exclusive
+
+#pragma warning(suppress : 26496)
+    auto copy{ target };
+    const auto bufferSize{ GetSize() };
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+    if (target == bufferSize.Origin())
+    {
+        // can't expand left
+        return target;
+    }
+    else if (target == bufferSize.EndExclusive())
+    {
+        // GH#7664: Treat EndExclusive as EndInclusive so
+        // that it actually points to a space in the buffer
+        copy = bufferSize.BottomRightInclusive();
+    }
+    else if (bufferSize.CompareInBounds(target, limit, true) >= 0)
+    {
+        // if at/past the limit --> clamp to limit
+        copy = limitOptional.value_or(bufferSize.BottomRightInclusive());
+    }
+
+    const auto& classes = _GetDelimiterClasses(wordDelimiters);
+    if (accessibilityMode)
+    {
+        return _GetWordStartForAccessibility(copy, classes);
+    }
+    else
+    {
+        return _GetWordStartForSelection(copy, classes);
+    }
+}
+
+// Method Description:
+// - Helper method for GetWordStart(). Get the til::point for the beginning of the word (accessibility definition) you are on
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - classes - what characters are we considering for the separation of words
+// Return Value:
+// - The til::point for the first character on the current/previous READABLE "word" (inclusive)
+til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, const DelimiterClassTable& classes) const
+{
+    auto result = target;
+    const auto bufferSize = GetSize();
+    auto stayAtOrigin = false;
+
+    // ignore left boundary. Continue until readable text found
+    // Each iteration skips an entire run of cells of the same class within the row.
+    while (_GetDelimiterClassAt(result, classes) != DelimiterClass::RegularChar)
+    {
+        result.x = GetRowByOffset(result.y).DelimiterClassRunBegin(result.x, classes);
+        if (!bufferSize.DecrementInBounds(result))
+        {
+            // first char in buffer is a DelimiterChar or ControlChar
+            // we can't move any further back
+            stayAtOrigin = true;
+            break;
+        }
+    }
+
+    // make sure we expand to the left boundary or the beginning of the word
+    while (_GetDelimiterClassAt(result, classes) == DelimiterClass::RegularChar)
+    {
+        result.x = GetRowByOffset(result.y).DelimiterClassRunBegin(result.x, classes);
+        if (!bufferSize.DecrementInBounds(result))
+        {
+            // first char in buffer is a RegularChar
+            // we can't move any further back
+            break;
+        }
+    }
+
+    // move off of delimiter and onto word start
+    if (!stayAtOrigin && _GetDelimiterClassAt(result, classes) != DelimiterClass::RegularChar)
+    {
+        bufferSize.IncrementInBounds(result);
+    }
+
+    return result;
+}
+
+// Method Description:
+// - Helper method for GetWordStart(). Get the til::point for the beginning of the word (selection definition) you are on
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - classes - what characters are we considering for the separation of words
+// Return Value:
+// - The til::point for the first character on the current word or delimiter run (stopped by the left margin)
+til::point TextBuffer::_GetWordStartForSelection(const til::point target, const DelimiterClassTable& classes) const
+{
+    // expand left until we hit the left boundary or a different delimiter class
+    return { GetRowByOffset(target.y).DelimiterClassRunBegin(target.x, classes), target.y };
+}
+
+// Method Description:
+// - Get the til::point for the beginning of the NEXT word
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - wordDelimiters - what characters are we considering for the separation of words
+// - accessibilityMode - when enabled, we continue expanding right until we are at the beginning of the next READABLE word
+//                        Otherwise, expand right until a character of a new delimiter class is found
+//                        (or a row boundary is encountered)
+// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
+// Return Value:
+// - The til::point for the last character on the "word" (inclusive)
+til::point TextBuffer::GetWordEnd(const til::point target, const std::wstring_view wordDelimiters, bool accessibilityMode, std::optional<til::point> limitOptional) const
+{
+    // Consider a buffer with this text in it:
+    // "  word   other  "
+    // In selection (accessibilityMode = false),
+    //  a "word" is defined as the range between two delimiters
+    //  so the words in the example include ["  ", "word", "   ", "other", "  "]
+    // In accessibility (accessibilityMode = true),
+    //  a "word" includes the delimiters after a range of readable characters
+    //  so the words in the example include ["word   ", "other  "]
+    // NOTE: the end anchor (this one) is exclusive, whereas the start anchor (GetWordStart) is inclusive
+
+    // Already at/past the limit. Can't move forward.
+    const auto bufferSize{ GetSize() };
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+    if (bufferSize.CompareInBounds(target, limit, true) >= 0)
+    {
+        return target;
+    }
+
+    const auto& classes = _GetDelimiterClasses(wordDelimiters);
+    if (accessibilityMode)
+    {
+        return _GetWordEndForAccessibility(target, classes, limit);
+    }
+    else
+    {
+        return _GetWordEndForSelection(target, classes);
+    }
+}
+
+// Method Description:
+// - Helper method for GetWordEnd(). Get the til::point for the beginning of the next READABLE word
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - classes - what characters are we considering for the separation of words
+// - limit - the last "valid" position in the text buffer (to improve performance)
+// Return Value:
+// - The til::point for the first character of the next readable "word". If no next word, return one past the end of the buffer
+til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, const DelimiterClassTable& classes, const til::point limit) const
+{
+    const auto bufferSize{ GetSize() };
+    auto result{ target };
+
+    if (bufferSize.CompareInBounds(target, limit, true) >= 0)
+    {
+        // if we're already on/past the last RegularChar,
+        // clamp result to that position
+        result = limit;
+
+        // make the result exclusive
+        bufferSize.IncrementInBounds(result, true);
+    }
+    else
+    {
+        const auto endExclusive = bufferSize.EndExclusive();
+
+        // Moves result past all cells of the given kind, an entire run of them within a row at a time.
+        // If this runs past the end of the buffer, result will be the EndExclusive point.
+        const auto skip = [&](const bool regular) {
+            while (result != limit && result != endExclusive)
+            {
+                const auto& row = GetRowByOffset(result.y);
+                if ((row.DelimiterClassAt(result.x, classes) == DelimiterClass::RegularChar) != regular)
+                {
+                    break;
+                }
+
+                auto end = row.DelimiterClassRunEnd(result.x, classes);
+                if (result.y == limit.y && end > limit.x)
+                {
+                    end = limit.x;
+                }
+
+                if (end <= bufferSize.RightInclusive())
+                {
+                    result.x = end;
+                }
+                else
+                {
+                    result = { bufferSize.Left(), result.y + 1 };
+                }
+            }
+        };
+
+        // Iterate through readable text
+        skip(true);
+        // expand to the beginning of the NEXT word
+        skip(false);
+    }
+
+    return result;
+}
+
+// Method Description:
+// - Helper method for GetWordEnd(). Get the til::point for the beginning of the NEXT word
+// Arguments:
+// - target - a til::point on the word you are currently on
+// - classes - what characters are we considering for the separation of words
+// Return Value:
+// - The til::point for the last character of the current word or delimiter run (stopped by right margin)
+til::point TextBuffer::_GetWordEndForSelection(const til::point target, const DelimiterClassTable& classes) const
+{
+    // expand right until we hit the right boundary or a different delimiter class
+    return { GetRowByOffset(target.y).DelimiterClassRunEnd(target.x, classes) - 1, target.y };
+}
+
+void TextBuffer::_PruneHyperlinks()
+{
+    // Check the old first row for hyperlink references
+    // If there are any, search the entire buffer for the same reference
+    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
+    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
+    // Get all the hyperlink references in the row we're erasing
+    const auto hyperlinks = GetRowByOffset(0).GetHyperlinks();
+    _hyperlinkPruneCandidates.insert(_hyperlinkPruneCandidates.end(), hyperlinks.begin(), hyperlinks.end());
+
+    // Searching the entire buffer for every recycled row that contains a hyperlink would make
+    // output that's full of them (like `ls --hyperlink`) quadratic in the buffer height. Instead we
+    // collect the candidates and search for all of them at once, once per buffer height of rotations.
+    // The sweep runs before the current row is reset, so it has to skip it.
+    if (++_rotationsSinceHyperlinkPrune < _height || _hyperlinkPruneCandidates.empty())
+    {
+        return;
+    }
+    _rotationsSinceHyperlinkPrune = 0;
+
+    {
+        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
+        // Only make it an unordered set now because set always heap allocates but vector
+        // doesn't when the set is empty (saving an allocation in the common case of no links.)
+        std::unordered_set<uint16_t> firstRowRefs{ _hyperlinkPruneCandidates.cbegin(), _hyperlinkPruneCandidates.cend() };
+        _hyperlinkPruneCandidates.clear();
+
+        const auto total = TotalRowCount();
+        // Loop through all the rows in the buffer except the first row -
+        // we have collected all hyperlink references in the recycled rows and put them in refs,
+        // now we need to search the rest of the buffer (i.e. all the rows except the first)
+        // to see if those references are anywhere else
+        for (til::CoordType i = 1; i < total; ++i)
+        {
+            const auto nextRowRefs = GetRowByOffset(i).GetHyperlinks();
+            for (auto id : nextRowRefs)
+            {
+                if (firstRowRefs.find(id) != firstRowRefs.end())
+                {
+                    firstRowRefs.erase(id);
+                }
+            }
+            if (firstRowRefs.empty())
+            {
+                // No more hyperlink references left to search for, terminate early
+                break;
+            }
+        }
+
+        // Now delete obsolete references from our map
+        for (auto hyperlinkReference : firstRowRefs)
+        {
+            RemoveHyperlinkFromMap(hyperlinkReference);
+        }
+    }
+}
+
+// Method Description:
+// - Update pos to be the position of the first character of the next word. This is used for accessibility
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// - wordDelimiters - what characters are we considering for the separation of words
+// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
+// Return Value:
+// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
+// - pos - The til::point for the first character on the "word" (inclusive)
+bool TextBuffer::MoveToNextWord(til::point& pos, const std::wstring_view wordDelimiters, std::optional<til::point> limitOptional) const
+{
+    // move to the beginning of the next word
+    // NOTE: _GetWordEnd...() returns the exclusive position of the "end of the word"
+    //       This is also the inclusive start of the next word.
+    const auto bufferSize{ GetSize() };
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+    const auto copy{ _GetWordEndForAccessibility(pos, _GetDelimiterClasses(wordDelimiters), limit) };
+
+    if (bufferSize.CompareInBounds(copy, limit, true) >= 0)
+    {
+        return false;
+    }
+
+    pos = copy;
+    return true;
+}
+
+// Method Description:
+// - Update pos to be the position of the first character of the previous word. This is used for accessibility
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// - wordDelimiters - what characters are we considering for the separation of words
+// Return Value:
+// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
+// - pos - The til::point for the first character on the "word" (inclusive)
+bool TextBuffer::MoveToPreviousWord(til::point& pos, std::wstring_view wordDelimiters) const
+{
+    // move to the beginning of the current word
+    auto copy{ GetWordStart(pos, wordDelimiters, true) };
+
+    if (!GetSize().DecrementInBounds(copy, true))
+    {
+        // can't move behind current word
+        return false;
+    }
+
+    // move to the beginning of the previous word
+    pos = GetWordStart(copy, wordDelimiters, true);
+    return true;
+}
+
+// Method Description:
+// - Update pos to be the beginning of the current glyph/character. This is used for accessibility
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// - limitOptional - (optional) the last possible position in the buffer that can be explored. This can be used to improve performance.
+// Return Value:
+// - pos - The til::point for the first cell of the current glyph (inclusive)
+til::point TextBuffer::GetGlyphStart(const til::point pos, std::optional<til::point> limitOptional) const
+{
+    auto resultPos = pos;
+    const auto bufferSize = GetSize();
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+
+    // Clamp pos to limit
+    if (bufferSize.CompareInBounds(resultPos, limit, true) > 0)
+    {
+        resultPos = limit;
+    }
+
+    // limit is exclusive, so we need to move back to be within valid bounds
+    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Trailing)
+    {
+        bufferSize.DecrementInBounds(resultPos, true);
+    }
+
+    return resultPos;
+}
+
+// Method Description:
+// - Update pos to be the end of the current glyph/character.
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// - accessibilityMode - this is being used for accessibility; make the end exclusive.
+// Return Value:
+// - pos - The til::point for the last cell of the current glyph (exclusive)
+til::point TextBuffer::GetGlyphEnd(const til::point pos, bool accessibilityMode, std::optional<til::point> limitOptional) const
+{
+    auto resultPos = pos;
+    const auto bufferSize = GetSize();
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+
+    // Clamp pos to limit
+    if (bufferSize.CompareInBounds(resultPos, limit, true) > 0)
+    {
+        resultPos = limit;
+    }
+
+    if (resultPos != limit && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Leading)
+    {
+        bufferSize.IncrementInBounds(resultPos, true);
+    }
+
+    // increment one more time to become exclusive
+    if (accessibilityMode)
+    {
+        bufferSize.IncrementInBounds(resultPos, true);
+    }
+    return resultPos;
+}
+
+// Method Description:
+// - Update pos to be the beginning of the next glyph/character. This is used for accessibility
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// - allowExclusiveEnd - allow result to be the exclusive limit (one past limit)
+// - limit - boundaries for the iterator to operate within
+// Return Value:
+// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
+// - pos - The til::point for the first cell of the current glyph (inclusive)
+bool TextBuffer::MoveToNextGlyph(til::point& pos, bool allowExclusiveEnd, std::optional<til::point> limitOptional) const
+{
+    const auto bufferSize = GetSize();
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+
+    const auto distanceToLimit{ bufferSize.CompareInBounds(pos, limit, true) };
+    if (distanceToLimit >= 0)
+    {
+        // Corner Case: we're on/past the limit
+        // Clamp us to the limit
+        pos = limit;
+        return false;
+    }
+    else if (!allowExclusiveEnd && distanceToLimit == -1)
+    {
+        // Corner Case: we're just before the limit
+        // and we are not allowed onto the exclusive end.
+        // Fail to move.
+        return false;
+    }
+
+    // Try to move forward, but if we hit the buffer boundary, we fail to move.
+    auto iter{ GetCellDataAt(pos, bufferSize) };
+    const bool success{ ++iter };
+
+    // Move again if we're on a wide glyph
+    if (success && iter->DbcsAttr() == DbcsAttribute::Trailing)
+    {
+        ++iter;
+    }
+
+    pos = iter.Pos();
+    return success;
+}
+
+// Method Description:
+// - Update pos to be the beginning of the previous glyph/character. This is used for accessibility
+// Arguments:
+// - pos - a til::point on the word you are currently on
+// Return Value:
+// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
+// - pos - The til::point for the first cell of the previous glyph (inclusive)
+bool TextBuffer::MoveToPreviousGlyph(til::point& pos, std::optional<til::point> limitOptional) const
+{
+    auto resultPos = pos;
+    const auto bufferSize = GetSize();
+    const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
+
+    if (bufferSize.CompareInBounds(pos, limit, true) > 0)
+    {
+        // we're past the end
+        // clamp us to the limit
+        pos = limit;
+        return true;
+    }
+
+    // try to move. If we can't, we're done.
+    const auto success = bufferSize.DecrementInBounds(resultPos, true);
+    if (resultPos != bufferSize.EndExclusive() && GetCellDataAt(resultPos)->DbcsAttr() == DbcsAttribute::Leading)
+    {
+        bufferSize.DecrementInBounds(resultPos, true);
+    }
+
+    pos = resultPos;
+    return success;
+}
+
+// Method Description:
+// - Determines the line-by-line rectangles based on two COORDs
+// - expands the rectangles to support wide glyphs
+// - used for selection rects and UIA bounding rects
+// Arguments:
+// - start: a corner of the text region of interest (inclusive)
+// - end: the other corner of the text region of interest (inclusive)
+// - blockSelection: when enabled, only get the rectangular text region,
+//                   as opposed to the text extending to the left/right
+//                   buffer margins
+// - bufferCoordinates: when enabled, treat the coordinates as relative to
+//                      the buffer rather than the screen.
+// Return Value:
+// - One or more rects corresponding to the selection area
+const std::vector<til::inclusive_rect> TextBuffer::GetTextRects(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const
+{
+    return GetTextRects(start, end, blockSelection, bufferCoordinates, til::CoordTypeMin, til::CoordTypeMax);
+}
+
+// Method Description:
+// - Same as the above, but only returns the rectangles for the rows in [rowBeg,rowEnd).
+// - A selection may span the entire scrollback, but consumers like the renderer
+//   only ever care about the visible rows. This avoids computing all the others.
+std::vector<til::inclusive_rect> TextBuffer::GetTextRects(til::point start, til::point end, bool blockSelection, bool bufferCoordinates, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    std::vector<til::inclusive_rect> textRects;
+
+    const auto bufferSize = GetSize();
+
+    // (0,0) is the top-left of the screen
+    // the physically "higher" coordinate is closer to the top-left
+    // the physically "lower" coordinate is closer to the bottom-right
+    const auto [higherCoord, lowerCoord] = bufferSize.CompareInBounds(start, end) <= 0 ?
+                                               std::make_tuple(start, end) :
+                                               std::make_tuple(end, start);
+
+    const auto firstRow = std::max(higherCoord.y, rowBeg);
+    const auto lastRow = std::min(lowerCoord.y, rowEnd - 1);
+    if (firstRow > lastRow)
+    {
+        return textRects;
+    }
+
+    textRects.reserve(gsl::narrow_cast<size_t>(1 + lastRow - firstRow));
+    for (auto row = firstRow; row <= lastRow; row++)
+    {
+        til::inclusive_rect textRow;
+
+        textRow.top = row;
+        textRow.bottom = row;
+
+        if (blockSelection || higherCoord.y == lowerCoord.y)
+        {
+            // set the left and right margin to the left-/right-most respectively
+            textRow.left = std::min(higherCoord.x, lowerCoord.x);
+            textRow.right = std::max(higherCoord.x, lowerCoord.x);
+        }
+        else
+        {
+            textRow.left = (row == higherCoord.y) ? higherCoord.x : bufferSize.Left();
+            textRow.right = (row == lowerCoord.y) ? lowerCoord.x : bufferSize.RightInclusive();
+        }
+
+        // If we were passed screen coordinates, convert the given range into
+        // equivalent buffer offsets, taking line rendition into account.
+        if (!bufferCoordinates)
+        {
+            textRow = ScreenToBufferLine(textRow, GetLineRendition(row));
+        }
+
+        _ExpandTextRow(textRow);
+        textRects.emplace_back(textRow);
+    }
+
+    return textRects;
+}
+
+// Method Description:
+// - Computes the span(s) for the given selection
+// - If not a blockSelection, returns a single span (start - end)
+// - Else if a blockSelection, returns spans corresponding to each line in the block selection
+// Arguments:
+// - start: beginning of the text region of interest (inclusive)
+// - end: the other end of the text region of interest (inclusive)
+// - blockSelection: when enabled, get spans for each line covered by the block
+// - bufferCoordinates: when enabled, treat the coordinates as relative to
+//                      the buffer rather than the screen.
+// Return Value:
+// - one or more sets of start-end coordinates, representing spans of text in the buffer
+std::vector<til::point_span> TextBuffer::GetTextSpans(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const
+{
+    std::vector<til::point_span> textSpans;
+    if (blockSelection)
+    {
+        // If blockSelection, this is effectively the same operation as GetTextRects, but
+        // expressed in til::point coordinates.
+        const auto rects = GetTextRects(start, end, /*blockSelection*/ true, bufferCoordinates);
+        textSpans.reserve(rects.size());
+
+        for (auto rect : rects)
+        {
+            const til::point first = { rect.left, rect.top };
+            const til::point second = { rect.right, rect.bottom };
+            textSpans.emplace_back(first, second);
+        }
+    }
+    else
+    {
+        const auto bufferSize = GetSize();
+
+        // (0,0) is the top-left of the screen
+        // the physically "higher" coordinate is closer to the top-left
+        // the physically "lower" coordinate is closer to the bottom-right
+        auto [higherCoord, lowerCoord] = start <= end ?
+                                             std::make_tuple(start, end) :
+                                             std::make_tuple(end, start);
+
+        textSpans.reserve(1);
+
+        // If we were passed screen coordinates, convert the given range into
+        // equivalent buffer offsets, taking line rendition into account.
+        if (!bufferCoordinates)
+        {
+            higherCoord = ScreenToBufferLine(higherCoord, GetLineRendition(higherCoord.y));
+            lowerCoord = ScreenToBufferLine(lowerCoord, GetLineRendition(lowerCoord.y));
+        }
+
+        til::inclusive_rect asRect = { higherCoord.x, higherCoord.y, lowerCoord.x, lowerCoord.y };
+        _ExpandTextRow(asRect);
+        higherCoord.x = asRect.left;
+        higherCoord.y = asRect.top;
+        lowerCoord.x = asRect.right;
+        lowerCoord.y = asRect.bottom;
+
+        textSpans.emplace_back(higherCoord, lowerCoord);
+    }
+
+    return textSpans;
+}
+
+// Method Description:
+// - Expand the selection row according to include wide glyphs fully
+// - this is particularly useful for box selections (ALT + selection)
+// Arguments:
+// - selectionRow: the selection row to be expanded
+// Return Value:
+// - modifies selectionRow's Left and Right values to expand properly
+void TextBuffer::_ExpandTextRow(til::inclusive_rect& textRow) const
+{
+    const auto bufferSize = GetSize();
+
+    // expand left side of rect
+    til::point targetPoint{ textRow.left, textRow.top };
+    if (GetCellDataAt(targetPoint)->DbcsAttr() == DbcsAttribute::Trailing)
+    {
+        if (targetPoint.x == bufferSize.Left())
+        {
+            bufferSize.IncrementInBounds(targetPoint);
+        }
+        else
+        {
+            bufferSize.DecrementInBounds(targetPoint);
+        }
+        textRow.left = targetPoint.x;
+    }
+
+    // expand right side of rect
+    targetPoint = { textRow.right, textRow.bottom };
+    if (GetCellDataAt(targetPoint)->DbcsAttr() == DbcsAttribute::Leading)
+    {
+        if (targetPoint.x == bufferSize.RightInclusive())
+        {
+            bufferSize.DecrementInBounds(targetPoint);
+        }
+        else
+        {
+            bufferSize.IncrementInBounds(targetPoint);
+        }
+        textRow.right = targetPoint.x;
+    }
+}
+
+// Routine Description:
+// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// Arguments:
+// - includeCRLF - inject CRLF pairs to the end of each line
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
+// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
+// - GetAttributeColors - function used to map TextAttribute to RGB COLORREFs. If null, only extract the text.
+// - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
+// Return Value:
+// - The text, background color, and foreground color data of the selected region of the text buffer.
+const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
+                                                   const bool trimTrailingWhitespace,
+                                                   const std::vector<til::inclusive_rect>& selectionRects,
+                                                   std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors,
+                                                   const bool formatWrappedRows) const
+{
+    TextAndColor data;
+    const auto copyTextColor = GetAttributeColors != nullptr;
+
+    // preallocate our vectors to reduce reallocs
+    const auto rows = selectionRects.size();
+    data.text.reserve(rows);
+    if (copyTextColor)
+    {
+        data.colors.reserve(rows);
+    }
+
+    // for each row in the selection
+    for (size_t i = 0; i < rows; i++)
+    {
+        const auto& rect = selectionRects.at(i);
+        const auto& row = GetRowByOffset(rect.top);
+        const til::CoordType columns = row.size();
+
+        // A wide glyph is part of the selection if its leading half is, just like
+        // when iterating over the cells and skipping all trailing halves.
+        auto colBeg = std::clamp(rect.left, 0, columns);
+        auto colEnd = std::clamp(rect.right + 1, colBeg, columns);
+        if (colBeg < colEnd && row.DbcsAttrAt(colBeg) == DbcsAttribute::Trailing)
+        {
+            ++colBeg;
+        }
+        if (colEnd < columns && row.DbcsAttrAt(colEnd) == DbcsAttribute::Trailing)
+        {
+            ++colEnd;
+        }
+
+        // copy the text of the row at once
+        std::wstring selectionText{ row.GetText(colBeg, colEnd) };
+        std::vector<TextAndColor::ColorRun> selectionColors;
+        size_t selectionColorsLength = 0;
+
+        // The colors are looked up once per attribute run (and not for every cell) and
+        // adjacent runs that end up with the same colors are merged into one.
+        if (copyTextColor)
+        {
+            til::CoordType runBeg = 0;
+            for (const auto& run : row.Attributes().runs())
+            {
+                auto beg = std::max(runBeg, colBeg);
+                auto end = std::min<til::CoordType>(runBeg + run.length, colEnd);
+                runBeg += run.length;
+
+                // Just like above, wide glyphs belong to the run of their leading half.
+                if (beg > colBeg && beg < colEnd && row.DbcsAttrAt(beg) == DbcsAttribute::Trailing)
+                {
+                    ++beg;
+                }
+                if (end < colEnd && row.DbcsAttrAt(end) == DbcsAttribute::Trailing)
+                {
+                    ++end;
+                }
+                if (beg >= end)
+                {
+                    continue;
+                }
+
+                const auto length = row.GetText(beg, end).size();
+                const auto [fg, bk] = GetAttributeColors(run.value);
+                selectionColorsLength += length;
+                if (!selectionColors.empty() && selectionColors.back().fg == fg && selectionColors.back().bk == bk)
+                {
+                    selectionColors.back().length += length;
+                }
+                else
+                {
+                    selectionColors.push_back({ length, fg, bk });
+                }
+
+                if (runBeg >= colEnd)
+                {
+                    break;
+                }
+            }
+        }
+
+        // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
+        const auto shouldFormatRow = formatWrappedRows || !row.WasWrapForced();
+
+        if (trimTrailingWhitespace)
+        {
+            if (shouldFormatRow)
+            {
+                // remove the spaces at the end (aka trim the trailing whitespace)
+                const auto trimmed = selectionText.find_last_not_of(UNICODE_SPACE);
+                selectionText.resize(trimmed == std::wstring::npos ? 0 : trimmed + 1);
+
+                // ...and the colors that went with them
+                for (auto excess = selectionColorsLength - std::min(selectionColorsLength, selectionText.size()); excess;)
+                {
+                    auto& last = selectionColors.back();
+                    const auto n = std::min(excess, last.length);
+                    last.length -= n;
+                    excess -= n;
+                    if (!last.length)
+                    {
+                        selectionColors.pop_back();
+                    }
+                }
+            }
+        }
+
+        // apply CR/LF to the end of the final string, unless we're the last line.
+        // a.k.a if we're earlier than the bottom, then apply CR/LF.
+        if (includeCRLF && i < selectionRects.size() - 1)
+        {
+            if (shouldFormatRow)
+            {
+                // then we can assume a CR/LF is proper
+                // (there are no colors for them, since they're invisible)
+                selectionText.push_back(UNICODE_CARRIAGERETURN);
+                selectionText.push_back(UNICODE_LINEFEED);
+            }
+        }
+
+        data.text.emplace_back(std::move(selectionText));
+        if (copyTextColor)
+        {
+            data.colors.emplace_back(std::move(selectionColors));
+        }
+    }
+
+    return data;
+}
+
+size_t TextBuffer::SpanLength(const til::point coordStart, const til::point coordEnd) const
+{
+    const auto bufferSize = GetSize();
+    // The coords are inclusive, so to get the (inclusive) length we add 1.
+    const auto length = bufferSize.CompareInBounds(coordEnd, coordStart) + 1;
+    return gsl::narrow<size_t>(length);
+}
+
+// Routine Description:
+// - Retrieves the plain text data between the specified coordinates.
+// Arguments:
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of the result.
+// - start - where to start getting text (should be at or prior to "end")
+// - end - where to end getting text
+// Return Value:
+// - Just the text.
+std::wstring TextBuffer::GetPlainText(const til::point& start, const til::point& end) const
+{
+    std::wstring text;
+    auto spanLength = SpanLength(start, end);
+    text.reserve(spanLength);
+
+    auto it = GetCellDataAt(start);
+
+    for (; it && spanLength > 0; ++it, --spanLength)
+    {
+        const auto& cell = *it;
+        if (cell.DbcsAttr() != DbcsAttribute::Trailing)
+        {
+            const auto chars = cell.Chars();
+            text.append(chars);
+        }
+    }
+
+    return text;
+}
+
+// Routine Description:
+// - Generates a CF_HTML compliant structure based on the passed in text and color data
+// Arguments:
+// - rows - the text and color data we will format & encapsulate
+// - backgroundColor - default background color for characters, also used in padding
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// Return Value:
+// - string containing the generated HTML
+std::string TextBuffer::GenHTML(const TextAndColor& rows,
+                                const int fontHeightPoints,
+                                const std::wstring_view fontFaceName,
+                                const COLORREF backgroundColor)
+{
+    try
+    {
+        std::ostringstream htmlBuilder;
+
+        // First we have to add some standard
+        // HTML boiler plate required for CF_HTML
+        // as part of the HTML Clipboard format
+        const std::string htmlHeader =
+            "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
+        htmlBuilder << htmlHeader;
+
+        htmlBuilder << "<!--StartFragment -->";
+
+        // apply global style in div element
+        {
+            htmlBuilder << "<DIV STYLE=\"";
+            htmlBuilder << "display:inline-block;";
+            htmlBuilder << "white-space:pre;";
+
+            htmlBuilder << "background-color:";
+            htmlBuilder << Utils::ColorToHexString(backgroundColor);
+            htmlBuilder << ";";
+
+            htmlBuilder << "font-family:";
+            htmlBuilder << "'";
+            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
+            htmlBuilder << "',";
+            // even with different font, add monospace as fallback
+            htmlBuilder << "monospace;";
+
+            htmlBuilder << "font-size:";
+            htmlBuilder << fontHeightPoints;
+            htmlBuilder << "pt;";
+
+            // note: MS Word doesn't support padding (in this way at least)
+            htmlBuilder << "padding:";
+            htmlBuilder << 4; // todo: customizable padding
+            htmlBuilder << "px;";
+
+            htmlBuilder << "\">";
+        }
+
+        // copy text and info color from buffer
+        auto hasWrittenAnyText = false;
+        std::optional<COLORREF> fgColor = std::nullopt;
+        std::optional<COLORREF> bkColor = std::nullopt;
+        for (size_t row = 0; row < rows.text.size(); row++)
+        {
+            if (row != 0)
+            {
+                htmlBuilder << "<BR>";
+            }
+
+            // The color runs don't cover the trailing \r\n (if any), as they don't have color
+            // attributes and are not HTML friendly. For line break we use '<BR>' instead.
+            const std::wstring_view rowText{ rows.text.at(row) };
+            size_t offset = 0;
+
+            for (const auto& run : rows.colors.at(row))
+            {
+                if (!fgColor.has_value() || !bkColor.has_value() || run.fg != fgColor.value() || run.bk != bkColor.value())
+                {
+                    fgColor = run.fg;
+                    bkColor = run.bk;
+
+                    if (hasWrittenAnyText)
+                    {
+                        htmlBuilder << "</SPAN>";
+                    }
+
+                    htmlBuilder << "<SPAN STYLE=\"";
+                    htmlBuilder << "color:";
+                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
+                    htmlBuilder << ";";
+                    htmlBuilder << "background-color:";
+                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
+                    htmlBuilder << ";";
+                    htmlBuilder << "\">";
+                }
+
+                hasWrittenAnyText = true;
+
+                // write the text of the entire run at once, escaping it as we go
+                const auto unescapedText = ConvertToA(CP_UTF8, rowText.substr(offset, run.length));
+                const std::string_view remaining{ unescapedText };
+                for (size_t pos = 0; pos < remaining.size();)
+                {
+                    const auto special = std::min(remaining.find_first_of("<>&", pos), remaining.size());
+                    htmlBuilder << remaining.substr(pos, special - pos);
+                    if (special < remaining.size())
+                    {
+                        switch (remaining[special])
+                        {
+                        case '<':
+                            htmlBuilder << "&lt;";
+                            break;
+                        case '>':
+                            htmlBuilder << "&gt;";
+                            break;
+                        default:
+                            htmlBuilder << "&amp;";
+                            break;
+                        }
+                    }
+                    pos = special + 1;
+                }
+
+                offset += run.length;
+            }
+        }
+
+        if (hasWrittenAnyText)
+        {
+            // last opened span wasn't closed in loop above, so close it now
+            htmlBuilder << "</SPAN>";
+        }
+
+        htmlBuilder << "</DIV>";
+
+        htmlBuilder << "<!--EndFragment -->";
+
+        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
+        htmlBuilder << HtmlFooter;
+
+        // once filled with values, there will be exactly 157 bytes in the clipboard header
+        constexpr size_t ClipboardHeaderSize = 157;
+
+        // these values are byte offsets from start of clipboard
+        const auto htmlStartPos = ClipboardHeaderSize;
+        const auto htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
+        const auto fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
+        const auto fragEndPos = htmlEndPos - HtmlFooter.length();
+
+        // header required by HTML 0.9 format
+        std::ostringstream clipHeaderBuilder;
+        clipHeaderBuilder << "Version:0.9\r\n";
+        clipHeaderBuilder << std::setfill('0');
+        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
+        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
+        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
+        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
+        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
+        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
+
+        return clipHeaderBuilder.str() + htmlBuilder.str();
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+// Routine Description:
+// - Generates an RTF document based on the passed in text and color data
+//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
+// Arguments:
+// - rows - the text and color data we will format & encapsulate
+// - backgroundColor - default background color for characters, also used in padding
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - htmlTitle - value used in title tag of html header. Used to name the application
+// Return Value:
+// - string containing the generated RTF
+std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
+{
+    try
+    {
+        std::ostringstream rtfBuilder;
+
+        // start rtf
+        rtfBuilder << "{";
+
+        // Standard RTF header.
+        // This is similar to the header generated by WordPad.
+        // \ansi - specifies that the ANSI char set is used in the current doc
+        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+        // \nouicompat - ?
+        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
+
+        // font table
+        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
+
+        // map to keep track of colors:
+        // keys are colors represented by COLORREF
+        // values are indices of the corresponding colors in the color table
+        std::unordered_map<COLORREF, int> colorMap;
+        auto nextColorIndex = 1; // leave 0 for the default color and start from 1.
+
+        // RTF color table
+        std::ostringstream colorTableBuilder;
+        colorTableBuilder << "{\\colortbl ;";
+        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
+                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
+                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
+                          << ";";
+        colorMap[backgroundColor] = nextColorIndex++;
+
+        // content
+        std::ostringstream contentBuilder;
+        contentBuilder << "\\viewkind4\\uc4";
+
+        // paragraph styles
+        // \fs specifies font size in half-points i.e. \fs20 results in a font size
+        // of 10 pts. That's why, font size is multiplied by 2 here.
+        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
+                       << "\\highlight1"
+                       << " ";
+
+        // Returns the index of the given color in the color table, adding it if needed.
+        const auto colorIndex = [&](const COLORREF color) {
+            const auto [it, inserted] = colorMap.emplace(color, nextColorIndex);
+            if (inserted)
+            {
+                // color not present in the map, so add it
+                colorTableBuilder << "\\red" << static_cast<int>(GetRValue(color))
+                                  << "\\green" << static_cast<int>(GetGValue(color))
+                                  << "\\blue" << static_cast<int>(GetBValue(color))
+                                  << ";";
+                nextColorIndex++;
+            }
+            return it->second;
+        };
+
+        std::optional<COLORREF> fgColor = std::nullopt;
+        std::optional<COLORREF> bkColor = std::nullopt;
+        for (size_t row = 0; row < rows.text.size(); ++row)
+        {
+            if (row != 0)
+            {
+                contentBuilder << "\\line "; // new line
+            }
+
+            // The color runs don't cover the trailing \r\n (if any), as they don't have
+            // color attributes. For line break we use \line instead.
+            const std::wstring_view rowText{ rows.text.at(row) };
+            size_t offset = 0;
+
+            for (const auto& run : rows.colors.at(row))
+            {
+                if (!fgColor.has_value() || !bkColor.has_value() || run.fg != fgColor.value() || run.bk != bkColor.value())
+                {
+                    fgColor = run.fg;
+                    bkColor = run.bk;
+
+                    const auto bkColorIndex = colorIndex(bkColor.value());
+                    const auto fgColorIndex = colorIndex(fgColor.value());
+                    contentBuilder << "\\highlight" << bkColorIndex
+                                   << "\\cf" << fgColorIndex
+                                   << " ";
+                }
+
+                _AppendRTFText(contentBuilder, rowText.substr(offset, run.length));
+                offset += run.length;
+            }
+        }
+
+        // end colortbl
+        colorTableBuilder << "}";
+
+        // add color table to the final RTF
+        rtfBuilder << colorTableBuilder.str();
+
+        // add the text content to the final RTF
+        rtfBuilder << contentBuilder.str();
+
+        // end rtf
+        rtfBuilder << "}";
+
+        return rtfBuilder.str();
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
+{
+    for (const auto codeUnit : text)
+    {
+        if (codeUnit <= 127)
+        {
+            switch (codeUnit)
+            {
+            case L'\\':
+            case L'{':
+            case L'}':
+                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
+                break;
+            default:
+                contentBuilder << gsl::narrow<char>(codeUnit);
+            }
+        }
+        else
+        {
+            // Windows uses unsigned wchar_t - RTF uses signed ones.
+            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
+        }
+    }
+}
+
+// Function Description:
+// - Reflow the contents from the old buffer into the new buffer. The new buffer
+//   can have different dimensions than the old buffer. If it does, then this
+//   function will attempt to maintain the logical contents of the old buffer,
+//   by continuing wrapped lines onto the next line in the new buffer.
+// Arguments:
+// - oldBuffer - the text buffer to copy the contents FROM
+// - newBuffer - the text buffer to copy the contents TO
+// - lastCharacterViewport - Optional. If the caller knows that the last
+//   nonspace character is in a particular Viewport, the caller can provide this
+//   parameter as an optimization, as opposed to searching the entire buffer.
+// - positionInfo - Optional. The caller can provide a pair of rows in this
+//   parameter and we'll calculate the position of the _end_ of those rows in
+//   the new buffer. The rows's new value is placed back into this parameter.
+// Return Value:
+// - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
+                           TextBuffer& newBuffer,
+                           const std::optional<Viewport> lastCharacterViewport,
+                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+try
+{
+    const auto& oldCursor = oldBuffer.GetCursor();
+    auto& newCursor = newBuffer.GetCursor();
+
+    // Rows that are evicted from the new buffer while we fill it are the next oldest ones
+    // after those in the scrollback archive. As such it needs to be handed over first.
+    newBuffer._archive = std::move(oldBuffer._archive);
+    auto restoreArchive = wil::scope_exit([&]() noexcept {
+        oldBuffer._archive = std::move(newBuffer._archive);
+    });
+    newBuffer._searchIndexEnabled = oldBuffer._searchIndexEnabled;
+    newBuffer.SetAttributeArenaEnabled(oldBuffer._attributeArenaEnabled);
+
+    // We need to save the old cursor position so that we can
+    // place the new cursor back on the equivalent character in
+    // the new buffer.
+    const auto cOldCursorPos = oldCursor.GetPosition();
+    const auto cOldLastChar = oldBuffer.GetLastNonSpaceCharacter(lastCharacterViewport);
+
+    const auto cOldRowsTotal = cOldLastChar.y + 1;
+
+    // If only the height changed, no row needs to be rewrapped and each row retains its position,
+    // as long as the text and the cursor fit into the new buffer without it having to circle.
+    // This turns resizes of panes that only grow or shrink vertically into plain row copies.
+    if (const auto newHeight = newBuffer.GetSize().Height();
+        oldBuffer.GetSize().Width() == newBuffer.GetSize().Width() && cOldRowsTotal <= newHeight && cOldCursorPos.y < newHeight)
+    {
+        const auto rowCount = std::min(oldBuffer._estimateOffsetOfLastCommittedRow() + 1, newHeight);
+        newBuffer._commitRows(gsl::narrow_cast<size_t>(rowCount));
+        for (til::CoordType y = 0; y < rowCount; ++y)
+        {
+            newBuffer.GetMutableRowByOffset(y).CopyFrom(oldBuffer.GetRowByOffset(y));
+        }
+
+        newBuffer.CopyProperties(oldBuffer);
+        newBuffer.CopyHyperlinkMaps(oldBuffer);
+        newCursor.SetPosition(cOldCursorPos);
+        newCursor.SetSize(oldCursor.GetSize());
+        newBuffer._marks = oldBuffer.GetMarks();
+        newBuffer._trimMarksOutsideBuffer();
+        restoreArchive.release();
+        return S_OK;
+    }
+
+    // Unless the rows get joined up, each old row ends up in one new row or more. It's worth committing them in one go.
+    newBuffer._commitRows(gsl::narrow_cast<size_t>(std::min(cOldRowsTotal, newBuffer.GetSize().Height())));
+
+    til::point cNewCursorPos;
+    auto fFoundCursorPos = false;
+    auto foundOldMutable = false;
+    auto foundOldVisible = false;
+    // Loop through all the rows of the old buffer and reprint them into the new buffer
+    til::CoordType iOldRow = 0;
+    for (; iOldRow < cOldRowsTotal; iOldRow++)
+    {
+        // Fetch the row and its "right" which is the last printable character.
+        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
+        const auto cOldColsTotal = oldBuffer.GetLineWidth(iOldRow);
+        auto iRight = row.MeasureRight();
+
+        // If we're starting a new row, try and preserve the line rendition
+        // from the row in the original buffer.
+        const auto newBufferPos = newCursor.GetPosition();
+        if (newBufferPos.x == 0)
+        {
+            auto& newRow = newBuffer.GetMutableRowByOffset(newBufferPos.y);
+            newRow.SetLineRendition(row.GetLineRendition());
+        }
+
+        // There is a special case here. If the row has a "wrap"
+        // flag on it, but the right isn't equal to the width (one
+        // index past the final valid index in the row) then there
+        // were a bunch trailing of spaces in the row.
+        // (But the measuring functions for each row Left/Right do
+        // not count spaces as "displayable" so they're not
+        // included.)
+        // As such, adjust the "right" to be the width of the row
+        // to capture all these spaces
+        if (row.WasWrapForced())
+        {
+            iRight = cOldColsTotal;
+
+            // And a combined special case.
+            // If we wrapped off the end of the row by adding a
+            // piece of padding because of a double byte LEADING
+            // character, then remove one from the "right" to
+            // leave this padding out of the copy process.
+            if (row.WasDoubleBytePadded())
+            {
+                iRight--;
+            }
+        }
+
+        // Copy the current row (up to the "right" boundary, which is one past
+        // the final valid character) into the new buffer. Instead of inserting
+        // it glyph by glyph, we copy as much as fits into the remainder of the
+        // current row of the new buffer at once and wrap the rest, the same way
+        // InsertCharacter() and IncrementCursor() would.
+        til::CoordType iOldCol = 0;
+        const auto copyRight = iRight;
+        while (iOldCol < copyRight)
+        {
+            const auto newPos = newCursor.GetPosition();
+            auto& newRow = newBuffer.GetMutableRowByOffset(newPos.y);
+            const auto newWidth = newBuffer.GetLineWidth(newPos.y);
+
+            RowCopyTextFromState state{
+                .source = row,
+                .columnBegin = newPos.x,
+                .columnLimit = newWidth,
+                .sourceColumnBegin = iOldCol,
+                .sourceColumnLimit = copyRight,
+            };
+            newRow.CopyTextFrom(state);
+
+            // The copied range retains its column widths, which makes mapping the
+            // cursor and the attributes from the old row to the new one trivial.
+            // (state.columnEnd can't be used here, because it's set to the columnLimit
+            // whenever the source row contains any text past what was copied.)
+            const auto sourceColumnEnd = std::min(state.sourceColumnEnd, copyRight);
+            const auto columnEnd = newPos.x + sourceColumnEnd - iOldCol;
+            if (iOldRow == cOldCursorPos.y && cOldCursorPos.x >= iOldCol && cOldCursorPos.x < sourceColumnEnd)
+            {
+                cNewCursorPos = { newPos.x + cOldCursorPos.x - iOldCol, newPos.y };
+                fFoundCursorPos = true;
+            }
+
+            auto attrColumn = newPos.x;
+            for (const auto& run : row.Attributes().slice(gsl::narrow_cast<uint16_t>(iOldCol), gsl::narrow_cast<uint16_t>(sourceColumnEnd)).runs())
+            {
+                newRow.SetAttrToEnd(attrColumn, run.value);
+                attrColumn += run.length;
+            }
+
+            if (sourceColumnEnd >= copyRight)
+            {
+                if (columnEnd < newWidth)
+                {
+                    newCursor.SetXPosition(columnEnd);
+                }
+                else
+                {
+                    // We filled the row exactly. Just like IncrementCursor() we wrap immediately.
+                    newRow.SetWrapForced(true);
+                    newBuffer.NewlineCursor();
+                }
+                break;
+            }
+
+            // Everything that follows didn't fit into this row.
+            if (columnEnd < newWidth)
+            {
+                // The next glyph is a wide glyph that would straddle the end of
+                // the row. Pad the row just like _PrepareForDoubleByteSequence.
+                if (iOldRow == cOldCursorPos.y && cOldCursorPos.x == sourceColumnEnd)
+                {
+                    cNewCursorPos = { columnEnd, newPos.y };
+                    fFoundCursorPos = true;
+                }
+                newRow.SetDoubleBytePadded(true);
+            }
+            newRow.SetWrapForced(true);
+            newBuffer.NewlineCursor();
+
+            // If nothing could be copied into an empty row, the glyph is wider than
+            // the entire new row. Drop it, as we'd otherwise loop forever.
+            iOldCol = sourceColumnEnd == iOldCol && newPos.x == 0 ? std::max(iOldCol + 1, row.NavigateToNext(iOldCol)) : sourceColumnEnd;
+        }
+
+        // GH#32: Copy the attributes from the rest of the row into this new buffer.
+        // From where we are in the old buffer, to the end of the row, copy the
+        // remaining attributes.
+        // - if the old buffer is smaller than the new buffer, then just copy
+        //   what we have, as it was. We already copied all _text_ with colors,
+        //   but it's possible for someone to just put some color into the
+        //   buffer to the right of that without any text (as just spaces). The
+        //   buffer looks weird to the user when we resize and it starts losing
+        //   those colors, so we need to copy them over too... as long as there
+        //   is space. The last attr in the row will be extended to the end of
+        //   the row in the new buffer.
+        // - if the old buffer is WIDER, than we might have wrapped onto a new
+        //   line. Use the cursor's position's Y so that we know where the new
+        //   row is, and start writing at the cursor position. Again, the attr
+        //   in the last column of the old row will be extended to the end of the
+        //   row that the text was flowed onto.
+        //   - if the text in the old buffer didn't actually fill the whole
+        //     line in the new buffer, then we didn't wrap. That's fine. just
+        //     copy attributes from the old row till the end of the new row, and
+        //     move on.
+        const auto newRowY = newCursor.GetPosition().y;
+        auto& newRow = newBuffer.GetMutableRowByOffset(newRowY);
+        auto newAttrColumn = newCursor.GetPosition().x;
+        const auto newWidth = newBuffer.GetLineWidth(newRowY);
+        // Stop when we get to the end of the buffer width, or the new position
+        // for inserting an attr would be past the right of the new buffer.
+        for (auto copyAttrCol = iOldCol;
+             copyAttrCol < cOldColsTotal && newAttrColumn < newWidth;
+             copyAttrCol++, newAttrColumn++)
+        {
+            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
+            const auto textAttr = row.GetAttrByColumn(copyAttrCol);
+            newRow.SetAttrToEnd(newAttrColumn, textAttr);
+        }
+
+        // If we found the old row that the caller was interested in, set the
+        // out value of that parameter to the cursor's current Y position (the
+        // new location of the _end_ of that row in the buffer).
+        if (positionInfo.has_value())
+        {
+            if (!foundOldMutable)
+            {
+                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
+                {
+                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().y;
+                    foundOldMutable = true;
+                }
+            }
+
+            if (!foundOldVisible)
+            {
+                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
+                {
+                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().y;
+                    foundOldVisible = true;
+                }
+            }
+        }
+
+        // If we didn't have a full row to copy, insert a new
+        // line into the new buffer.
+        // Only do so if we were not forced to wrap. If we did
+        // force a word wrap, then the existing line break was
+        // only because we ran out of space.
+        if (iRight < cOldColsTotal && !row.WasWrapForced())
+        {
+            if (!fFoundCursorPos && (iRight == cOldCursorPos.x && iOldRow == cOldCursorPos.y))
+            {
+                cNewCursorPos = newCursor.GetPosition();
+                fFoundCursorPos = true;
+            }
+            // Only do this if it's not the final line in the buffer.
+            // On the final line, we want the cursor to sit
+            // where it is done printing for the cursor
+            // adjustment to follow.
+            if (iOldRow < cOldRowsTotal - 1)
+            {
+                newBuffer.NewlineCursor();
+            }
+            else
+            {
+                // If we are on the final line of the buffer, we have one more check.
+                // We got into this code path because we are at the right most column of a row in the old buffer
+                // that had a hard return (no wrap was forced).
+                // However, as we're inserting, the old row might have just barely fit into the new buffer and
+                // caused a new soft return (wrap was forced) putting the cursor at x=0 on the line just below.
+                // We need to preserve the memory of the hard return at this point by inserting one additional
+                // hard newline, otherwise we've lost that information.
+                // We only do this when the cursor has just barely poured over onto the next line so the hard return
+                // isn't covered by the soft one.
+                // e.g.
+                // The old line was:
+                // |aaaaaaaaaaaaaaaaaaa | with no wrap which means there was a newline after that final a.
+                // The cursor was here ^
+                // And the new line will be:
+                // |aaaaaaaaaaaaaaaaaaa| and show a wrap at the end
+                // |                   |
+                //  ^ and the cursor is now there.
+                // If we leave it like this, we've lost the newline information.
+                // So we insert one more newline so a continued reflow of this buffer by resizing larger will
+                // continue to look as the original output intended with the newline data.
+                // After this fix, it looks like this:
+                // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
+                // |                   |
+                //  ^ and the cursor is now here.
+                const auto coordNewCursor = newCursor.GetPosition();
+                if (coordNewCursor.x == 0 && coordNewCursor.y > 0)
+                {
+                    if (newBuffer.GetRowByOffset(coordNewCursor.y - 1).WasWrapForced())
+                    {
+                        newBuffer.NewlineCursor();
+                    }
+                }
+            }
+        }
+    }
+
+    // Finish copying buffer attributes to remaining rows below the last
+    // printable character. This is to fix the `color 2f` scenario, where you
+    // change the buffer colors then resize and everything below the last
+    // printable char gets reset. See GH #12567
+    auto newRowY = newCursor.GetPosition().y + 1;
+    const auto newHeight = newBuffer.GetSize().Height();
+    const auto oldHeight = oldBuffer._estimateOffsetOfLastCommittedRow() + 1;
+    for (;
+         iOldRow < oldHeight && newRowY < newHeight;
+         iOldRow++)
+    {
+        const auto& row = oldBuffer.GetRowByOffset(iOldRow);
+
+        // Optimization: Since all these rows are below the last printable char,
+        // we can reasonably assume that they are filled with just spaces.
+        // That's convenient, we can just copy the attr row from the old buffer
+        // into the new one, and resize the row to match. We'll rely on the
+        // behavior of ATTR_ROW::Resize to trim down when narrower, or extend
+        // the last attr when wider.
+        auto& newRow = newBuffer.GetMutableRowByOffset(newRowY);
+        const auto newWidth = newBuffer.GetLineWidth(newRowY);
+        newRow.TransferAttributes(row.Attributes(), newWidth);
+
+        newRowY++;
+    }
+
+    // Finish copying remaining parameters from the old text buffer to the new one
+    newBuffer.CopyProperties(oldBuffer);
+    newBuffer.CopyHyperlinkMaps(oldBuffer);
+
+    // If we found where to put the cursor while placing characters into the buffer,
+    //   just put the cursor there. Otherwise we have to advance manually.
+    if (fFoundCursorPos)
+    {
+        newCursor.SetPosition(cNewCursorPos);
+    }
+    else
+    {
+        // Advance the cursor to the same offset as before
+        // get the number of newlines and spaces between the old end of text and the old cursor,
+        //   then advance that many newlines and chars
+        auto iNewlines = cOldCursorPos.y - cOldLastChar.y;
+        const auto iIncrements = cOldCursorPos.x - cOldLastChar.x;
+        const auto cNewLastChar = newBuffer.GetLastNonSpaceCharacter();
+
+        // If the last row of the new buffer wrapped, there's going to be one less newline needed,
+        //   because the cursor is already on the next line
+        if (newBuffer.GetRowByOffset(cNewLastChar.y).WasWrapForced())
+        {
+            iNewlines = std::max(iNewlines - 1, 0);
+        }
+        else
+        {
+            // if this buffer didn't wrap, but the old one DID, then the d(columns) of the
+            //   old buffer will be one more than in this buffer, so new need one LESS.
+            if (oldBuffer.GetRowByOffset(cOldLastChar.y).WasWrapForced())
+            {
+                iNewlines = std::max(iNewlines - 1, 0);
+            }
+        }
+
+        for (auto r = 0; r < iNewlines; r++)
+        {
+            newBuffer.NewlineCursor();
+        }
+        for (auto c = 0; c < iIncrements - 1; c++)
+        {
+            newBuffer.IncrementCursor();
+        }
+    }
+
+    // Save old cursor size before we delete it
+    const auto ulSize = oldCursor.GetSize();
+
+    // Set size back to real size as it will be taking over the rendering duties.
+    newCursor.SetSize(ulSize);
+
+    newBuffer._marks = oldBuffer.GetMarks();
+    newBuffer._trimMarksOutsideBuffer();
+
+    restoreArchive.release();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Method Description:
+// - Adds or updates a hyperlink in our hyperlink table
+// Arguments:
+// - The hyperlink URI, the hyperlink id (could be new or old)
+void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
+{
+    _hyperlinkMap[id] = uri;
+}
+
+// Method Description:
+// - Retrieves the URI associated with a particular hyperlink ID
+// Arguments:
+// - The hyperlink ID
+// Return Value:
+// - The URI
+std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
+{
+    return _hyperlinkMap.at(id);
+}
+
+// Method description:
+// - Provides the hyperlink ID to be assigned as a text attribute, based on the optional custom id provided
+// Arguments:
+// - The user-defined id
+// Return value:
+// - The internal hyperlink ID
+uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
+{
+    uint16_t numericId = 0;
+    if (id.empty())
+    {
+        // no custom id specified, return our internal count
+        numericId = _currentHyperlinkId;
+        ++_currentHyperlinkId;
+    }
+    else
+    {
+        // assign _currentHyperlinkId if the custom id does not already exist
+        std::wstring newId{ id };
+        // hash the URL and add it to the custom ID - GH#7698
+        newId += L"%" + std::to_wstring(til::hash(uri));
+        const auto result = _hyperlinkCustomIdMap.emplace(newId, _currentHyperlinkId);
+        if (result.second)
+        {
+            // the custom id did not already exist
+            ++_currentHyperlinkId;
+        }
+        numericId = (*(result.first)).second;
+    }
+    // _currentHyperlinkId could overflow, make sure its not 0
+    if (_currentHyperlinkId == 0)
+    {
+        ++_currentHyperlinkId;
+    }
+    return numericId;
+}
+
+// Method Description:
+// - Removes a hyperlink from the hyperlink map and the associated
+//   user defined id from the custom id map (if there is one)
+// Arguments:
+// - The ID of the hyperlink to be removed
+void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
+{
+    _hyperlinkMap.erase(id);
+    for (const auto& customIdPair : _hyperlinkCustomIdMap)
+    {
+        if (customIdPair.second == id)
+        {
+            _hyperlinkCustomIdMap.erase(customIdPair.first);
+            break;
+        }
+    }
+}
+
+// Method Description:
+// - Obtains the custom ID, if there was one, associated with the
+//   uint16_t id of a hyperlink
+// Arguments:
+// - The uint16_t id of the hyperlink
+// Return Value:
+// - The custom ID if there was one, empty string otherwise
+std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
+{
+    for (auto customIdPair : _hyperlinkCustomIdMap)
+    {
+        if (customIdPair.second == id)
+        {
+            return customIdPair.first;
+        }
+    }
+    return {};
+}
+
+// Method Description:
+// - Copies the hyperlink/customID maps of the old buffer into this one,
+//   also copies currentHyperlinkId
+// Arguments:
+// - The other buffer
+void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
+{
+    _hyperlinkMap = other._hyperlinkMap;
+    _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
+    _currentHyperlinkId = other._currentHyperlinkId;
+    _hyperlinkPruneCandidates = other._hyperlinkPruneCandidates;
+}
+
+// Searches through the entire (committed) text buffer for `needle` and returns the coordinates in absolute coordinates.
+// The end coordinates of the returned ranges are considered inclusive.
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive) const
+{
+    return SearchText(needle, caseInsensitive, 0, til::CoordTypeMax);
+}
+
+// Searches through the given rows [rowBeg,rowEnd) for `needle` and returns the coordinates in absolute coordinates.
+// While the end coordinates of the returned ranges are considered inclusive, the [rowBeg,rowEnd) range is half-open.
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    return SearchText(needle, caseInsensitive, til::point{ 0, rowBeg }, rowEnd);
+}
+
+// Searches for `needle` starting at the given position up to (excluding) rowEnd, the same way the other overloads do.
+// This allows you to continue a search after a previous match, because matches never overlap.
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd) const
+{
+    const auto rowBeg = start.y;
+    rowEnd = std::min(rowEnd, _estimateOffsetOfLastCommittedRow() + 1);
+
+    std::vector<til::point_span> results;
+
+    // All whitespace strings would match the not-yet-written parts of the TextBuffer which would be weird.
+    if (allWhitespace(needle) || rowBeg >= rowEnd)
+    {
+        return results;
+    }
+
+    if (!_searchIndexEnabled || !_searchTextIndexed(needle, caseInsensitive, start, rowEnd, results))
+    {
+        _searchTextUnindexed(needle, caseInsensitive, start, rowEnd, results);
+    }
+
+    return results;
+}
+
+// Implements SearchText() by searching through all of the given rows.
+void TextBuffer::_searchTextUnindexed(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd, std::vector<til::point_span>& results) const
+{
+    const auto rowBeg = start.y;
+    if (rowBeg >= rowEnd)
+    {
+        return;
+    }
+
+    // The searches operate on the text of the rows from rowBeg on and skip this many characters in the first one.
+    const auto charOffset = GetRowByOffset(rowBeg).GetText(0, start.x).size();
+
+    // ICU's regex engine is slow, even for literal patterns. Most needles can be found by comparing UTF-16 code units
+    // instead, as long as that cannot match half of a surrogate pair. For case-insensitive searches this only works
+    // for ASCII needles, because we only fold ASCII letters.
+    const auto isAscii = std::all_of(needle.begin(), needle.end(), [](const auto ch) { return ch < 0x80; });
+    if ((isAscii || !caseInsensitive) && !til::is_trailing_surrogate(needle.front()) && !til::is_leading_surrogate(needle.back()))
+    {
+        const auto resultCount = results.size();
+        if (_searchTextLiteral(needle, caseInsensitive, rowBeg, rowEnd, charOffset, results))
+        {
+            return;
+        }
+        results.resize(resultCount);
+    }
+
+    _searchTextRegex(needle, caseInsensitive, rowBeg, rowEnd, charOffset, results);
+}
+
+// Under full case folding, which ICU uses for case-insensitive matching, these characters fold to strings
+// containing ASCII letters. For instance U+212A KELVIN SIGN folds to "k" and U+00DF "ß" to "ss".
+// The remaining non-ASCII characters can never match an ASCII character.
+static constexpr bool foldsToAscii(const wchar_t ch) noexcept
+{
+    switch (ch)
+    {
+    case 0x00DF:
+    case 0x0130:
+    case 0x0149:
+    case 0x017F:
+    case 0x01F0:
+    case 0x1E96:
+    case 0x1E97:
+    case 0x1E98:
+    case 0x1E99:
+    case 0x1E9A:
+    case 0x1E9E:
+    case 0x212A:
+        return true;
+    default:
+        return ch >= 0xFB00 && ch <= 0xFB06;
+    }
+}
+
+// A fast path for SearchText() which compares UTF-16 code units instead of using ICU. If caseInsensitive is true,
+// the needle must consist of ASCII only. Just like the ICU based implementation, this searches through the
+// concatenated text of all rows, which means that matches may span multiple rows, and it returns non-overlapping matches.
+// Returns false if the buffer contains text for which the result would differ from ICU's.
+bool TextBuffer::_searchTextLiteral(std::wstring_view needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd, size_t charOffset, std::vector<til::point_span>& results) const
+{
+    struct RowStart
+    {
+        // The offset of the row's text relative to the haystack. It's negative if the haystack begins in the middle of the row.
+        ptrdiff_t offset;
+        til::CoordType y;
+    };
+
+    const auto foldCase = [](const wchar_t ch) noexcept {
+        return ch >= L'A' && ch <= L'Z' ? gsl::narrow_cast<wchar_t>(ch | 0x20) : ch;
+    };
+
+    std::wstring foldedNeedle;
+    if (caseInsensitive)
+    {
+        foldedNeedle.resize(needle.size());
+        std::transform(needle.begin(), needle.end(), foldedNeedle.begin(), foldCase);
+        needle = foldedNeedle;
+    }
+
+    // The haystack contains the text of the current row and the tail of the previous ones, in which a match may still begin.
+    // The rows that the haystack contains are stored in rowStarts in order to translate matches back to buffer coordinates.
+    std::wstring haystack;
+    std::vector<RowStart> rowStarts;
+    const auto needleLength = gsl::narrow_cast<ptrdiff_t>(needle.size());
+    const auto needleFirst = needle.front();
+    const auto needleRest = needle.substr(1);
+
+    const auto offsetToPoint = [&](const ptrdiff_t offset, const bool trailing) {
+        const auto it = std::prev(std::upper_bound(rowStarts.begin(), rowStarts.end(), offset, [](const ptrdiff_t off, const RowStart& r) noexcept {
+            return off < r.offset;
+        }));
+        const auto& row = GetRowByOffset(it->y);
+        const auto charOffset = offset - it->offset;
+        const auto x = trailing ? row.GetTrailingColumnAtCharOffset(charOffset) : row.GetLeadingColumnAtCharOffset(charOffset);
+        return til::point{ x, it->y };
+    };
+
+    for (auto y = rowBeg; y < rowEnd; ++y)
+    {
+        auto text = GetRowByOffset(y).GetText();
+        rowStarts.emplace_back(RowStart{ gsl::narrow_cast<ptrdiff_t>(haystack.size()), y });
+
+        if (y == rowBeg)
+        {
+            text = text.substr(charOffset);
+            rowStarts.back().offset -= gsl::narrow_cast<ptrdiff_t>(charOffset);
+        }
+
+        if (caseInsensitive)
+        {
+            for (const auto ch : text)
+            {
+                if (ch >= 0x80 && foldsToAscii(ch))
+                {
+                    return false;
+                }
+                haystack.push_back(foldCase(ch));
+            }
+        }
+        else
+        {
+            haystack.append(text);
+        }
+
+        // A match can only begin at positions that leave enough room for the entire needle.
+        // Everything past that is kept around for the next iteration.
+        const auto beg = haystack.begin();
+        const auto end = haystack.end();
+        auto it = beg;
+
+        if (end - beg >= needleLength)
+        {
+            const auto last = end - (needleLength - 1);
+
+            // std::find() and std::equal() are vectorized for wchar_t by our STL. This makes
+            // our main loop a SIMD scan for the first character of the needle followed by a memcmp.
+            while ((it = std::find(it, last, needleFirst)) != last)
+            {
+                if (std::equal(needleRest.begin(), needleRest.end(), it + 1))
+                {
+                    const auto offset = it - beg;
+                    results.emplace_back(til::point_span{ offsetToPoint(offset, false), offsetToPoint(offset + needleLength - 1, true) });
+                    it += needleLength;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            // `it` may point past `last` if the last match ended right there.
+            it = std::max(it, last);
+        }
+
+        const auto consumed = it - beg;
+        haystack.erase(0, gsl::narrow_cast<size_t>(consumed));
+        for (auto& r : rowStarts)
+        {
+            r.offset -= consumed;
+        }
+
+        // Only the last row that starts at or before the beginning of the haystack is still needed.
+        const auto firstNeeded = std::prev(std::upper_bound(rowStarts.begin(), rowStarts.end(), ptrdiff_t{ 0 }, [](const ptrdiff_t off, const RowStart& r) noexcept {
+            return off < r.offset;
+        }));
+        rowStarts.erase(rowStarts.begin(), firstNeeded);
+    }
+
+    return true;
+}
+
+// Finds `needle` using ICU's regex engine as a literal pattern. See SearchText().
+void TextBuffer::_searchTextRegex(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd, size_t charOffset, std::vector<til::point_span>& results) const
+{
+    const auto text = ICU::UTextFromTextBuffer(*this, rowBeg, rowEnd);
+
+    uint32_t flags = UREGEX_LITERAL;
+    WI_SetFlagIf(flags, UREGEX_CASE_INSENSITIVE, caseInsensitive);
+
+    UErrorCode status = U_ZERO_ERROR;
+    const auto re = ICU::CreateRegex(needle, flags, &status);
+    uregex_setUText(re.get(), text.get(), &status);
+
+    if (uregex_find64(re.get(), gsl::narrow_cast<int64_t>(charOffset), &status))
+    {
+        do
+        {
+            results.emplace_back(ICU::BufferRangeFromMatch(text.get(), re.get()));
+        } while (uregex_findNext(re.get(), &status));
+    }
+}
+
+// Returns the bit that represents the given trigram in a TextBuffer::SearchIndexBlock. ASCII letters are folded to
+// lowercase, so that the same bits can be used for case-sensitive and (ASCII) case-insensitive searches.
+static size_t searchIndexTrigramBit(const wchar_t a, const wchar_t b, const wchar_t c) noexcept
+{
+    const auto fold = [](const wchar_t ch) noexcept -> uint64_t {
+        return ch >= L'A' && ch <= L'Z' ? ch | 0x20 : ch;
+    };
+    // A multiplicative hash. Its top 12 bits are the best mixed ones and select one of the 4096 bits.
+    const auto key = fold(a) | fold(b) << 16 | fold(c) << 32;
+    return gsl::narrow_cast<size_t>((key * 0x9E3779B97F4A7C15) >> 52);
+}
+
+// Returns the search index entry for the given block of rows (by their position in memory) and (re)builds it if
+// one of its rows has been modified since. An entry also contains the trigrams that begin in its last row and continue
+// in the row that follows it in memory. If that row happens to be at the other end of the circular buffer,
+// the extra trigrams are harmless, because the index only needs to tell us which blocks definitely lack a trigram.
+const TextBuffer::SearchIndexBlock& TextBuffer::_getSearchIndexBlock(const size_t block) const
+{
+    static_assert(SearchIndexBlock::bitCount == size_t{ 1 } << 12);
+
+    const size_t height = _height;
+    const auto beg = block * _mutationBlockRowCount;
+    const auto end = std::min(beg + _mutationBlockRowCount, height);
+    const auto next = end % height;
+    auto& entry = til::at(_searchIndex, block);
+
+    if (entry.built && til::at(_blockMutationIds, block) <= entry.mutationId && til::at(_blockMutationIds, next / _mutationBlockRowCount) <= entry.mutationId)
+    {
+        return entry;
+    }
+
+    // ROWs that haven't been committed yet are blank, because that's how they get constructed.
+    // Reading them via _getRowByOffsetDirect() would needlessly commit their memory.
+    std::wstring text;
+    const auto appendRow = [&](const size_t offset, const size_t maxLength) {
+        if (_buffer.get() + _bufferRowStride * (offset + 1) < _commitWatermark)
+        {
+#pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
+            text.append(const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(offset + 1).GetText().substr(0, maxLength));
+        }
+        else
+        {
+            text.append(std::min<size_t>(_width, maxLength), L' ');
+        }
+    };
+
+    for (auto offset = beg; offset < end; ++offset)
+    {
+        appendRow(offset, std::wstring_view::npos);
+    }
+    appendRow(next, 2);
+
+    entry = {};
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const auto ch = til::at(text, i);
+        if (ch >= 0x80 && foldsToAscii(ch))
+        {
+            entry.foldsToAscii = true;
+        }
+        if (i + 2 < text.size())
+        {
+            const auto bit = searchIndexTrigramBit(ch, til::at(text, i + 1), til::at(text, i + 2));
+            til::at(entry.trigrams, bit / 64) |= uint64_t{ 1 } << (bit % 64);
+        }
+    }
+    entry.mutationId = _lastMutationId;
+    entry.built = true;
+    return entry;
+}
+
+// Implements SearchText() with the help of the search index. Returns false if the index cannot be used for this needle.
+//
+// Every row contains at least _width/2 characters (in case it's full of wide glyphs), which means that a match
+// which begins in a row cannot extend further than `reach` rows past it. All trigrams of such a match begin
+// within these rows, so they're only worth searching if their index entries contain all of the needle's trigrams.
+// The rows for which that's the case are then searched in runs of consecutive rows.
+bool TextBuffer::_searchTextIndexed(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd, std::vector<til::point_span>& results) const
+{
+    // With at least 2 characters per row a trigram never spans more than 2 rows, which _getSearchIndexBlock() relies on.
+    // Just like _searchTextLiteral() the index only folds ASCII letters, which is insufficient for other case-insensitive needles.
+    const auto isAscii = std::all_of(needle.begin(), needle.end(), [](const auto ch) { return ch < 0x80; });
+    if (needle.size() < 3 || _width < 4 || (caseInsensitive && !isAscii))
+    {
+        return false;
+    }
+
+    if (_searchIndex.size() != _blockMutationIds.size())
+    {
+        _searchIndex.assign(_blockMutationIds.size(), {});
+    }
+
+    std::vector<size_t> needleBits;
+    for (size_t i = 0; i + 2 < needle.size(); ++i)
+    {
+        needleBits.emplace_back(searchIndexTrigramBit(til::at(needle, i), til::at(needle, i + 1), til::at(needle, i + 2)));
+    }
+
+    const auto reach = gsl::narrow_cast<til::CoordType>(needle.size() / (_width / 2u)) + 1;
+    const auto isCandidate = [&](const til::CoordType y) {
+        const auto last = std::min(y + reach, rowEnd - 1);
+        for (const auto bit : needleBits)
+        {
+            auto found = false;
+            // Visit each block that contains one of the rows [y,last] once.
+            for (auto r = y; r <= last && !found;)
+            {
+                const auto offset = gsl::narrow_cast<size_t>(_getRowOffset(r));
+                const auto block = offset / _mutationBlockRowCount;
+                const auto& entry = _getSearchIndexBlock(block);
+                found = (caseInsensitive && entry.foldsToAscii) || WI_IsFlagSet(til::at(entry.trigrams, bit / 64), uint64_t{ 1 } << (bit % 64));
+                r += gsl::narrow_cast<til::CoordType>(std::min((block + 1) * _mutationBlockRowCount, size_t{ _height }) - offset);
+            }
+            if (!found)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto from = start;
+    for (auto y = start.y; y < rowEnd; ++y)
+    {
+        if (!isCandidate(y))
+        {
+            continue;
+        }
+
+        auto runEnd = y + 1;
+        while (runEnd < rowEnd && isCandidate(runEnd))
+        {
+            ++runEnd;
+        }
+
+        std::vector<til::point_span> runResults;
+        _searchTextUnindexed(needle, caseInsensitive, std::max(from, til::point{ 0, y }), std::min(rowEnd, runEnd + reach), runResults);
+
+        for (const auto& r : runResults)
+        {
+            // Matches that begin after the run will be found again by the next one, if any.
+            if (r.start.y >= runEnd)
+            {
+                break;
+            }
+            results.emplace_back(r);
+            // Matches never overlap, so the next one must begin after this one.
+            from = { r.end.x + 1, r.end.y };
+        }
+
+        // The loop's increment skips past runEnd, which we already know isn't a candidate.
+        y = runEnd;
+    }
+
+    return true;
+}
+
+const std::vector<ScrollMark>& TextBuffer::GetMarks() const noexcept
+{
+    _applyPendingMarksScroll();
+    return _marks;
+}
+
+// Returns true if there are any marks. Unlike GetMarks() this doesn't apply
+// a pending ScrollMarks(), so it may include marks that are about to be trimmed.
+bool TextBuffer::HasMarks() const noexcept
+{
+    return !_marks.empty();
+}
+
+// Remove all marks between `start` & `end`, inclusive.
+void TextBuffer::ClearMarksInRange(
+    const til::point start,
+    const til::point end)
+{
+    _applyPendingMarksScroll();
+
+    auto inRange = [&start, &end](const ScrollMark& m) {
+        return (m.start >= start && m.start <= end) ||
+               (m.end >= start && m.end <= end);
+    };
+
+    _marks.erase(std::remove_if(_marks.begin(),
+                                _marks.end(),
+                                inRange),
+                 _marks.end());
+}
+void TextBuffer::ClearAllMarks() noexcept
+{
+    _marks.clear();
+    _pendingMarksScroll = 0;
+}
+
+// Adjust all the marks in the y-direction by `delta`. Positive values move the
+// marks down (the positive y direction). Negative values move up. This will
+// trim marks that are no longer have a start in the bounds of the buffer
+// The adjustment is deferred until the marks are accessed next, see _applyPendingMarksScroll().
+void TextBuffer::ScrollMarks(const int delta)
+{
+    if (_marks.empty())
+    {
+        return;
+    }
+
+    _pendingMarksScroll += delta;
+
+    // Once all marks have been scrolled out of the buffer, there's no point in accumulating further.
+    if (std::abs(_pendingMarksScroll) >= GetSize().Height())
+    {
+        ClearAllMarks();
+    }
+}
+
+// Applies the delta accumulated by ScrollMarks() to all marks and trims the ones
+// that no longer have a start in the bounds of the buffer.
+void TextBuffer::_applyPendingMarksScroll() const noexcept
+{
+    if (_pendingMarksScroll == 0)
+    {
+        return;
+    }
+
+    const auto delta = std::exchange(_pendingMarksScroll, 0);
+
+    for (auto& mark : _marks)
+    {
+        mark.start.y += delta;
+
+        // If the mark had sub-regions, then move those pointers too
+        if (mark.commandEnd.has_value())
+        {
+            (*mark.commandEnd).y += delta;
+        }
+        if (mark.outputEnd.has_value())
+        {
+            (*mark.outputEnd).y += delta;
+        }
+    }
+
+    _trimMarksOutsideBuffer();
+}
+
+// Method Description:
+// - Add a mark to our list of marks, and treat it as the active "prompt". For
+//   the sake of shell integration, we need to know which mark represents the
+//   current prompt/command/output. Internally, we'll always treat the _last_
+//   mark in the list as the current prompt.
+// Arguments:
+// - m: the mark to add.
+void TextBuffer::StartPromptMark(const ScrollMark& m)
+{
+    _applyPendingMarksScroll();
+    _marks.push_back(m);
+}
+// Method Description:
+// - Add a mark to our list of marks. Don't treat this as the active prompt.
+//   This should be used for marks created by the UI or from other user input.
+//   By inserting at the start of the list, we can separate out marks that were
+//   generated by client programs vs ones created by the user.
+// Arguments:
+// - m: the mark to add.
+void TextBuffer::AddMark(const ScrollMark& m)
+{
+    _applyPendingMarksScroll();
+    _marks.insert(_marks.begin(), m);
+}
+
+void TextBuffer::_trimMarksOutsideBuffer() const noexcept
+{
+    const auto height = GetSize().Height();
+    _marks.erase(std::remove_if(_marks.begin(),
+                                _marks.end(),
+                                [height](const auto& m) {
+                                    return (m.start.y < 0) ||
+                                           (m.start.y >= height);
+                                }),
+                 _marks.end());
+}
+
+std::wstring_view TextBuffer::CurrentCommand() const
+{
+    _applyPendingMarksScroll();
+    if (_marks.size() == 0)
+    {
+        return L"";
+    }
+
+    const auto& curr{ _marks.back() };
+    const auto& start{ curr.end };
+    const auto& end{ GetCursor().GetPosition() };
+
+    const auto line = start.y;
+    const auto& row = GetRowByOffset(line);
+    return row.GetText(start.x, end.x);
+}
+
+void TextBuffer::SetCurrentPromptEnd(const til::point pos) noexcept
+{
+    _applyPendingMarksScroll();
+    if (_marks.empty())
+    {
+        return;
+    }
+    auto& curr{ _marks.back() };
+    curr.end = pos;
+}
+void TextBuffer::SetCurrentCommandEnd(const til::point pos) noexcept
+try
+{
+    _applyPendingMarksScroll();
+    if (_marks.empty())
+    {
+        return;
+    }
+    auto& curr{ _marks.back() };
+    curr.commandEnd = pos;
+    curr.command.clear();
+
+    // The command text is between the `end` (which denotes the end of the prompt) and the `commandEnd`.
+    if (curr.HasCommand())
+    {
+        const auto& row = GetRowByOffset(curr.end.y);
+        const auto commandText = row.GetText(curr.end.x, pos.x);
+        const auto strEnd = commandText.find_last_not_of(UNICODE_SPACE);
+        if (strEnd != std::wstring_view::npos)
+        {
+            curr.command.assign(commandText.substr(0, strEnd + 1));
+        }
+    }
+}
+CATCH_LOG()
+void TextBuffer::SetCurrentOutputEnd(const til::point pos, ::MarkCategory category) noexcept
+{
+    _applyPendingMarksScroll();
+    if (_marks.empty())
+    {
+        return;
+    }
+    auto& curr{ _marks.back() };
+    curr.outputEnd = pos;
+    curr.category = category;
+}
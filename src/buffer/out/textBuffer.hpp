@@ -49,10 +49,12 @@ filling in the last row, and updating the screen.
 
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include "cursor.h"
 #include "Row.hpp"
+#include "ScrollbackArchive.hpp"
 #include "TextAttribute.hpp"
 #include "../types/inc/Viewport.hpp"
 
@@ -83,6 +85,9 @@ struct ScrollMark
     std::optional<til::point> outputEnd;
 
     MarkCategory category{ MarkCategory::Info };
+    // The text of the command, without trailing whitespace. It's captured by
+    // SetCurrentCommandEnd(), so that it doesn't need to be read from the buffer again.
+    std::wstring command;
     // Other things we may want to think about in the future are listed in
     // GH#11000
 
@@ -101,6 +106,38 @@ struct ScrollMark
     }
 };
 
+// The memory occupied by a TextBuffer in bytes, as returned by TextBuffer::GetMemoryUsage().
+struct TextBufferMemoryUsage
+{
+    // The committed memory of the uncompressed ROWs and their per-row bookkeeping.
+    size_t rows = 0;
+    // The compressed blocks of cold ROWs.
+    size_t coldRows = 0;
+    // Attribute runs that didn't fit into their ROW, including the AttributeArenas.
+    size_t attributes = 0;
+    size_t hyperlinks = 0;
+    size_t marks = 0;
+    size_t searchIndex = 0;
+
+    size_t Total() const noexcept
+    {
+        return rows + coldRows + attributes + hyperlinks + marks + searchIndex;
+    }
+
+    TextBufferMemoryUsage& operator+=(const TextBufferMemoryUsage& other) noexcept
+    {
+        rows += other.rows;
+        coldRows += other.coldRows;
+        attributes += other.attributes;
+        hyperlinks += other.hyperlinks;
+        marks += other.marks;
+        searchIndex += other.searchIndex;
+        return *this;
+    }
+};
+
+struct TextBufferSnapshot;
+
 class TextBuffer final
 {
 public:
@@ -143,6 +180,9 @@ public:
     // Text insertion functions
     void Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
+    size_t FillCharacters(const til::point target, const size_t count, const wchar_t ch);
+    size_t FillAttributes(const til::point target, const size_t count, const TextAttribute& attributes);
+    void WriteCharInfos(const std::span<const CHAR_INFO> charInfos, const til::point target);
 
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
@@ -163,17 +203,39 @@ public:
     // Scroll needs access to this to quickly rotate around the buffer.
     void IncrementCircularBuffer(const TextAttribute& fillAttributes = {});
 
+    void TrimWorkingSet(til::CoordType firstKeptRow);
+    TextBufferMemoryUsage GetMemoryUsage() const noexcept;
+
+    void SetScrollbackArchiveEnabled(const bool enabled);
+    size_t GetArchivedRowCount() const noexcept;
+    void ReadArchivedRow(const size_t index, ROW& row) const;
+
+    void SetSearchIndexEnabled(const bool enabled) noexcept;
+    bool IsSearchIndexEnabled() const noexcept;
+
+    void SetAttributeArenaEnabled(const bool enabled);
+    bool IsAttributeArenaEnabled() const noexcept;
+
+    static void SetLargePagesEnabled(const bool enabled) noexcept;
+    bool IsUsingLargePages() const noexcept;
+
     til::point GetLastNonSpaceCharacter(std::optional<const Microsoft::Console::Types::Viewport> viewOptional = std::nullopt) const;
 
     Cursor& GetCursor() noexcept;
     const Cursor& GetCursor() const noexcept;
 
     uint64_t GetLastMutationId() const noexcept;
+    uint64_t GetRotationCount() const noexcept;
+    til::CoordType GetFirstRowMutatedSince(const uint64_t mutationId) const noexcept;
+    til::CoordType GetFirstRowMutatedSince(const uint64_t mutationId, til::CoordType rowBeg, til::CoordType rowEnd) const noexcept;
+    bool IsRowMutatedSince(const til::CoordType y, const uint64_t mutationId) const noexcept;
+    void UpdateSnapshot(TextBufferSnapshot& snapshot, til::CoordType rowBeg, til::CoordType rowEnd) const;
     const til::CoordType GetFirstRowIndex() const noexcept;
 
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
 
     void ScrollRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta);
+    void CopyRect(const til::rect& source, const til::point target);
 
     til::CoordType TotalRowCount() const noexcept;
 
@@ -193,6 +255,8 @@ public:
     til::point BufferToScreenPosition(const til::point position) const;
 
     void Reset() noexcept;
+    void ResetRowsFrom(til::CoordType y, const TextAttribute& attributes);
+    void Recycle(const TextAttribute& attributes) noexcept;
 
     [[nodiscard]] HRESULT ResizeTraditional(const til::size newSize) noexcept;
 
@@ -206,6 +270,7 @@ public:
     void TriggerRedrawAll();
     void TriggerScroll();
     void TriggerScroll(const til::point delta);
+    void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& region, const til::CoordType delta);
     void TriggerNewTextNotification(const std::wstring_view newText);
 
     til::point GetWordStart(const til::point target, const std::wstring_view wordDelimiters, bool accessibilityMode = false, std::optional<til::point> limitOptional = std::nullopt) const;
@@ -219,6 +284,7 @@ public:
     bool MoveToPreviousGlyph(til::point& pos, std::optional<til::point> limitOptional = std::nullopt) const;
 
     const std::vector<til::inclusive_rect> GetTextRects(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const;
+    std::vector<til::inclusive_rect> GetTextRects(til::point start, til::point end, bool blockSelection, bool bufferCoordinates, til::CoordType rowBeg, til::CoordType rowEnd) const;
     std::vector<til::point_span> GetTextSpans(til::point start, til::point end, bool blockSelection, bool bufferCoordinates) const;
 
     void AddHyperlinkToMap(std::wstring_view uri, uint16_t id);
@@ -231,9 +297,17 @@ public:
     class TextAndColor
     {
     public:
+        // A run of consecutive UTF-16 code units within a row of `text` that share the same colors.
+        // The runs of a row cover its text up to (but not including) any trailing CR/LF.
+        struct ColorRun
+        {
+            size_t length;
+            COLORREF fg;
+            COLORREF bk;
+        };
+
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        std::vector<std::vector<ColorRun>> colors;
     };
 
     size_t SpanLength(const til::point coordStart, const til::point coordEnd) const;
@@ -269,8 +343,10 @@ public:
 
     std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive) const;
     std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const;
+    std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd) const;
 
     const std::vector<ScrollMark>& GetMarks() const noexcept;
+    bool HasMarks() const noexcept;
     void ClearMarksInRange(const til::point start, const til::point end);
     void ClearAllMarks() noexcept;
     void ScrollMarks(const int delta);
@@ -282,13 +358,27 @@ public:
     std::wstring_view CurrentCommand() const;
 
 private:
+    struct SearchIndexBlock;
+
     void _reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes);
     void _commit(const std::byte* row);
+    void _commitRows(size_t count);
     void _decommit() noexcept;
     void _construct(const std::byte* until) noexcept;
+    void _constructRow(std::byte* row) const noexcept;
     void _destroy() const noexcept;
+    void _invalidateRows(const TextAttribute& attributes) noexcept;
+    void _resetStaleRow(size_t offset) noexcept;
+    std::pair<std::byte*, std::byte*> _coldBlockRange(size_t block) const noexcept;
+    std::pair<uintptr_t, uintptr_t> _coldBlockPageRange(size_t block) const noexcept;
+    void _resetAttributeArenas(size_t beg, size_t end) noexcept;
+    bool _isColdRow(size_t offset) const noexcept;
+    void _freezeColdBlock(size_t block);
+    void _thawColdBlock(size_t offset);
     ROW& _getRowByOffsetDirect(size_t offset);
+    til::CoordType _getRowOffset(til::CoordType y) const noexcept;
     ROW& _getRow(til::CoordType y) const;
+    void _markAllRowsMutated() noexcept;
     til::CoordType _estimateOffsetOfLastCommittedRow() const noexcept;
 
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
@@ -298,13 +388,20 @@ private:
     // Assist with maintaining proper buffer state for Double Byte character sequences
     void _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
     void _ExpandTextRow(til::inclusive_rect& selectionRow) const;
-    DelimiterClass _GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
-    til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
+    const DelimiterClassTable& _GetDelimiterClasses(const std::wstring_view wordDelimiters) const;
+    DelimiterClass _GetDelimiterClassAt(const til::point pos, const DelimiterClassTable& classes) const;
+    til::point _GetWordStartForAccessibility(const til::point target, const DelimiterClassTable& classes) const;
+    til::point _GetWordStartForSelection(const til::point target, const DelimiterClassTable& classes) const;
+    til::point _GetWordEndForAccessibility(const til::point target, const DelimiterClassTable& classes, const til::point limit) const;
+    til::point _GetWordEndForSelection(const til::point target, const DelimiterClassTable& classes) const;
     void _PruneHyperlinks();
-    void _trimMarksOutsideBuffer();
+    bool _searchTextLiteral(std::wstring_view needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd, size_t charOffset, std::vector<til::point_span>& results) const;
+    void _searchTextRegex(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd, size_t charOffset, std::vector<til::point_span>& results) const;
+    void _searchTextUnindexed(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd, std::vector<til::point_span>& results) const;
+    bool _searchTextIndexed(const std::wstring_view& needle, bool caseInsensitive, til::point start, til::CoordType rowEnd, std::vector<til::point_span>& results) const;
+    const SearchIndexBlock& _getSearchIndexBlock(size_t block) const;
+    void _trimMarksOutsideBuffer() const noexcept;
+    void _applyPendingMarksScroll() const noexcept;
 
     static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
 
@@ -313,6 +410,9 @@ private:
     std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
     uint16_t _currentHyperlinkId = 1;
+    // The hyperlink ids referenced by the rows that were recycled since the last _PruneHyperlinks() sweep.
+    std::vector<uint16_t> _hyperlinkPruneCandidates;
+    til::CoordType _rotationsSinceHyperlinkPrune = 0;
 
     // This block describes the state of the underlying virtual memory buffer that holds all ROWs, text and attributes.
     // Initially memory is only allocated with MEM_RESERVE to reduce the private working set of conhost.
@@ -354,6 +454,12 @@ private:
     // There's probably a better metric than this. (This comment was written when ROW had both,
     // a _chars array containing text and a _charOffsets array contain column-to-text indices.)
     static constexpr size_t _commitReadAheadRowCount = 128;
+    // If SetLargePagesEnabled() was called, buffers spanning at least this many large pages are allocated with
+    // MEM_LARGE_PAGE, if the process is permitted to. Large pages get committed upfront and can't be decommitted,
+    // so in that case the _commitWatermark only tracks which ROWs have been constructed. It also means that
+    // cold blocks aren't worth compressing. Smaller buffers would waste too much memory to the rounding.
+    static constexpr size_t _largePageMinimumCount = 4;
+    bool _largePages = false;
     // Before TextBuffer was made to use virtual memory it initialized the entire memory arena with the initial
     // attributes right away. To ensure it continues to work the way it used to, this stores these initial attributes.
     TextAttribute _initialAttributes;
@@ -371,12 +477,75 @@ private:
     // The height of the buffer in rows, excluding the scratchpad row.
     uint16_t _height = 0;
 
+    // Long scrollbacks are mostly made up of rows that nobody will look at again, but each of them still costs
+    // _bufferRowStride bytes of committed memory. To reduce this, ROWs are grouped into blocks of _coldBlockRowCount
+    // by their position in memory. Once all ROWs of a block are older than the newest _hotRowCount rows, the block
+    // gets compressed via ROW::Compress() and its memory is decommitted. Accessing any ROW in such a "cold" block
+    // decompresses the entire block again. This only happens for buffers with at least _hotRowCount+_coldBlockRowCount rows.
+    static constexpr size_t _coldBlockRowCount = 256;
+    static constexpr size_t _hotRowCount = 2048;
+    // Indexed by block. An empty vector means that the block isn't compressed.
+    std::vector<std::vector<uint8_t>> _coldBlocks;
+    // The number of non-empty _coldBlocks. Allows _getRowByOffsetDirect() to skip the lookup in the common case.
+    size_t _coldBlockCount = 0;
+    // The attribute runs of cold ROWs are stored as handles into this table. Most scrollbacks only contain
+    // a handful of distinct attributes, so this shrinks each run from 14 to 4 bytes.
+    TextAttributeTable _coldAttributes;
+
+    // Reset() and ResetRowsFrom() don't clear every ROW right away, which would make them O(n) in the size of the
+    // scrollback. Instead they increment _rowGeneration and any ROW whose entry in _rowGenerations (indexed by its
+    // position in memory, including the scratchpad row) differs from it, is reset to _staleRowAttributes the next
+    // time _getRowByOffsetDirect() returns it. _staleRowCount allows it to skip the lookup in the common case.
+    uint32_t _rowGeneration = 0;
+    std::vector<uint32_t> _rowGenerations;
+    size_t _staleRowCount = 0;
+    TextAttribute _staleRowAttributes;
+
+    // If enabled, ROWs allocate their attribute runs from the AttributeArena of their block of _attributeArenaRowCount
+    // rows (by their position in memory), instead of the heap. Enabling it only affects ROWs constructed afterwards.
+    // The arenas are kept even if it gets disabled again, because existing ROWs may still reference them.
+    static constexpr size_t _attributeArenaRowCount = 64;
+    bool _attributeArenaEnabled = false;
+    std::unique_ptr<AttributeArena[]> _attributeArenas;
+
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
     uint64_t _lastMutationId = 0;
+    // For each row (by its position in memory), this stores the _lastMutationId at which GetMutableRowByOffset()
+    // last returned it. _blockMutationIds stores the maximum for each block of _mutationBlockRowCount rows,
+    // which allows GetFirstRowMutatedSince() to quickly skip over unmodified rows. See IsRowMutatedSince().
+    static constexpr size_t _mutationBlockRowCount = 16;
+    std::vector<uint64_t> _rowMutationIds;
+    std::vector<uint64_t> _blockMutationIds;
+    uint64_t _rotationCount = 0;
+
+    // An optional index for SearchText(). For each block of _mutationBlockRowCount rows, it stores a bitset of
+    // the hashes of all trigrams (sequences of 3 UTF-16 code units, with ASCII letters folded to lowercase) that
+    // begin in one of its rows. SearchText() only needs to look at rows whose blocks contain all of the trigrams
+    // of the needle. The entries are built on demand and remain valid until one of their rows is modified.
+    struct SearchIndexBlock
+    {
+        static constexpr size_t bitCount = 4096;
+        std::array<uint64_t, bitCount / 64> trigrams{};
+        uint64_t mutationId = 0;
+        bool built = false;
+        // True if the block contains a character that foldsToAscii(). Case-insensitive searches must always check it.
+        bool foldsToAscii = false;
+    };
+    bool _searchIndexEnabled = false;
+    // This is a cache and as such it's mutable. SearchText() is only ever called under the console lock.
+    mutable std::vector<SearchIndexBlock> _searchIndex;
 
     Cursor _cursor;
-    std::vector<ScrollMark> _marks;
+    // ScrollMarks() is called whenever the buffer circles, which would make adjusting every mark
+    // O(rows * marks). Instead it only accumulates the delta, which is applied to the marks when
+    // they're accessed next. As such these are mutable, just like the search index above.
+    mutable std::vector<ScrollMark> _marks;
+    mutable til::CoordType _pendingMarksScroll = 0;
+    // The word delimiters rarely ever change, so the lookup table for them is only rebuilt when they do.
+    mutable DelimiterClassTable _delimiterClasses;
+    // If set, rows that are recycled by IncrementCircularBuffer() are stored here first.
+    std::unique_ptr<ScrollbackArchive> _archive;
     bool _isActiveBuffer = false;
 
 #ifdef UNIT_TESTING
@@ -384,3 +553,18 @@ private:
     friend class UiaTextRangeTests;
 #endif
 };
+
+// A private copy of a range of rows of a TextBuffer, filled by TextBuffer::UpdateSnapshot(). It doesn't share any
+// state with the source buffer, which allows long running consumers to read it without holding the lock that
+// protects the source buffer. Keep it around and update it again later, to only copy the rows that changed since.
+struct TextBufferSnapshot
+{
+    // The copied rows. Row 0 of the snapshot is row `firstRow` of the source buffer.
+    std::unique_ptr<TextBuffer> buffer;
+    til::CoordType firstRow = 0;
+
+    // The state of the source buffer when the snapshot was last updated.
+    const TextBuffer* source = nullptr;
+    uint64_t mutationId = 0;
+    uint64_t rotationCount = 0;
+};
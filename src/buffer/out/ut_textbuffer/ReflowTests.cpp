@@ -87,6 +87,44 @@ namespace
                 },
             },
         },
+        TestCase{
+            L"Height-only resize doesn't rewrap",
+            {
+                TestBuffer{
+                    { 6, 5 },
+                    {
+                        { L"ABCDEF", false },
+                        { L"$     ", false },
+                        { L"GH    ", true },
+                        { L"IJ    ", false },
+                        { L"      ", false },
+                    },
+                    { 0, 1 } // cursor on $
+                },
+                TestBuffer{
+                    { 6, 4 }, // reduce height by 1
+                    {
+                        { L"ABCDEF", false }, // no exact wrap bug, since nothing is rewrapped
+                        { L"$     ", false },
+                        { L"GH    ", true },
+                        { L"IJ    ", false },
+                    },
+                    { 0, 1 } // cursor on $
+                },
+                TestBuffer{
+                    { 6, 6 }, // grow height
+                    {
+                        { L"ABCDEF", false },
+                        { L"$     ", false },
+                        { L"GH    ", true },
+                        { L"IJ    ", false },
+                        { L"      ", false },
+                        { L"      ", false },
+                    },
+                    { 0, 1 } // cursor on $
+                },
+            },
+        },
         TestCase{
             L"SBCS, cursor remains in buffer, no circling, no original wrap",
             {
@@ -192,7 +192,7 @@ HwndTerminal::~HwndTerminal()
     Teardown();
 }
 
-HRESULT HwndTerminal::Initialize()
+HRESULT HwndTerminal::Initialize(bool useAtlasEngine)
 {
     _terminal = std::make_unique<::Microsoft::Terminal::Core::Terminal>();
     auto renderThread = std::make_unique<::Microsoft::Console::Render::RenderThread>();
@@ -204,10 +204,20 @@ HRESULT HwndTerminal::Initialize()
     RETURN_HR_IF_NULL(E_POINTER, localPointerToThread);
     RETURN_IF_FAILED(localPointerToThread->Initialize(_renderer.get()));
 
-    auto dxEngine = std::make_unique<::Microsoft::Console::Render::DxEngine>();
-    RETURN_IF_FAILED(dxEngine->SetHwnd(_hwnd.get()));
-    RETURN_IF_FAILED(dxEngine->Enable());
-    _renderer->AddRenderEngine(dxEngine.get());
+    // The AtlasEngine is the same renderer that the Windows Terminal uses. It's opt-in,
+    // so that existing users of the WPF control don't see any change in behavior.
+    std::unique_ptr<::Microsoft::Console::Render::IRenderEngine> renderEngine;
+    if (useAtlasEngine)
+    {
+        renderEngine = std::make_unique<::Microsoft::Console::Render::AtlasEngine>();
+    }
+    else
+    {
+        renderEngine = std::make_unique<::Microsoft::Console::Render::DxEngine>();
+    }
+    RETURN_IF_FAILED(renderEngine->SetHwnd(_hwnd.get()));
+    RETURN_IF_FAILED(renderEngine->Enable());
+    _renderer->AddRenderEngine(renderEngine.get());
 
     _UpdateFont(USER_DEFAULT_SCREEN_DPI);
     RECT windowRect;
@@ -215,12 +225,12 @@ HRESULT HwndTerminal::Initialize()
 
     const til::size windowSize{ windowRect.right - windowRect.left, windowRect.bottom - windowRect.top };
 
-    // Fist set up the dx engine with the window size in pixels.
+    // Fist set up the render engine with the window size in pixels.
     // Then, using the font, get the number of characters that can fit.
     const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, windowSize);
-    RETURN_IF_FAILED(dxEngine->SetWindowSize({ viewInPixels.Width(), viewInPixels.Height() }));
+    RETURN_IF_FAILED(renderEngine->SetWindowSize({ viewInPixels.Width(), viewInPixels.Height() }));
 
-    _renderEngine = std::move(dxEngine);
+    _renderEngine = std::move(renderEngine);
 
     _terminal->Create({ 80, 25 }, 9001, *_renderer);
     _terminal->SetWriteInputCallback([=](std::wstring_view input) noexcept { _WriteTextToConnection(input); });
@@ -384,10 +394,35 @@ void HwndTerminal::SendOutput(std::wstring_view data)
     _terminal->Write(data);
 }
 
+void HwndTerminal::SendOutputUtf8(std::string_view data)
+{
+    if (!_terminal)
+    {
+        return;
+    }
+    if (SUCCEEDED_LOG(til::u8u16(data, _u16Buffer, _u8State)))
+    {
+        _terminal->Write(_u16Buffer);
+    }
+}
+
 HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal)
+{
+    return CreateTerminalWithRenderer(parentHwnd, false, hwnd, terminal);
+}
+
+/// <summary>
+/// Creates a terminal just like CreateTerminal, but allows selecting the renderer.
+/// </summary>
+/// <param name="parentHwnd">The window the terminal window is a child of.</param>
+/// <param name="useAtlasEngine">True to render with the AtlasEngine instead of the DxEngine.</param>
+/// <param name="hwnd">Out parameter containing the terminal's window.</param>
+/// <param name="terminal">Out parameter containing the terminal pointer.</param>
+/// <returns>HRESULT of the creation.</returns>
+HRESULT _stdcall CreateTerminalWithRenderer(HWND parentHwnd, bool useAtlasEngine, _Out_ void** hwnd, _Out_ void** terminal)
 {
     auto _terminal = std::make_unique<HwndTerminal>(parentHwnd);
-    RETURN_IF_FAILED(_terminal->Initialize());
+    RETURN_IF_FAILED(_terminal->Initialize(useAtlasEngine));
 
     *hwnd = _terminal->GetHwnd();
     *terminal = _terminal.release();
@@ -413,6 +448,20 @@ void _stdcall TerminalSendOutput(void* terminal, LPCWSTR data)
     publicTerminal->SendOutput(data);
 }
 
+/// <summary>
+/// Writes UTF-8 output to the terminal. Unlike TerminalSendOutput the data doesn't need
+/// to be null-terminated, or converted to UTF-16 by the caller, and may contain partial
+/// code points at its end, which are completed by the next call.
+/// </summary>
+/// <param name="terminal">Terminal pointer.</param>
+/// <param name="data">The UTF-8 encoded output.</param>
+/// <param name="length">The length of data in bytes.</param>
+void _stdcall TerminalSendOutputUtf8(void* terminal, _In_reads_(length) const char* data, size_t length)
+{
+    const auto publicTerminal = static_cast<HwndTerminal*>(terminal);
+    publicTerminal->SendOutputUtf8({ data, length });
+}
+
 /// <summary>
 /// Triggers a terminal resize using the new width and height in pixel.
 /// </summary>
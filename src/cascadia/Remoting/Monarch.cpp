@@ -82,6 +82,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             }
 
             auto newPeasantsId = peasant.GetID();
+            auto newPeasantsName = peasant.WindowName();
 
             // Keep track of which peasant we are
             // SAFETY: this is only true for one peasant, and each peasant
@@ -102,6 +103,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             {
                 std::unique_lock lock{ _peasantsMutex };
                 _peasants[newPeasantsId] = peasant;
+                _peasantNames[newPeasantsId] = std::move(newPeasantsName);
             }
 
             TraceLoggingWrite(g_hRemotingProvider,
@@ -206,6 +208,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         {
             std::unique_lock lock{ _peasantsMutex };
             _peasants.erase(peasantId);
+            _peasantNames.erase(peasantId);
         }
         _WindowClosedHandlers(nullptr, nullptr);
     }
@@ -275,6 +278,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             {
                 std::unique_lock lock{ _peasantsMutex };
                 _peasants.erase(peasantID);
+                _peasantNames.erase(peasantID);
             }
 
             if (clearMruPeasantOnFailure)
@@ -289,8 +293,9 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
     // Method Description:
     // - Find the ID of the peasant with the given name. If no such peasant
-    //   exists, then we'll return 0. If we encounter any peasants who have died
-    //   during this process, then we'll remove them from the set of _peasants
+    //   exists, then we'll return 0. The name is looked up in our local copy of
+    //   the peasant names, and only the matching peasant is asked whether it's
+    //   still alive. If it died, we'll remove it from the set of _peasants
     // Arguments:
     // - name: The window name to look for
     // Return Value:
@@ -308,26 +313,28 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         }
 
         uint64_t result = 0;
-
-        const auto callback = [&](const auto& id, const auto& p) {
-            auto otherName = p.WindowName();
-            if (otherName == name)
+        {
+            std::shared_lock lock{ _peasantsMutex };
+            for (const auto& [id, otherName] : _peasantNames)
             {
-                result = id;
-                return false;
+                if (otherName == name)
+                {
+                    result = id;
+                    break;
+                }
             }
-            return true;
-        };
+        }
 
-        const auto onError = [&](const auto& id) {
+        // _getPeasant will clean up after the peasant if it turns out to be dead.
+        if (result != 0 && !_getPeasant(result))
+        {
             TraceLoggingWrite(g_hRemotingProvider,
                               "Monarch_lookupPeasantIdForName_Failed",
-                              TraceLoggingInt64(id, "peasantID", "The ID of the peasant which we could not get the name of"),
+                              TraceLoggingInt64(result, "peasantID", "The ID of the peasant with that name, which was dead"),
                               TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                               TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-        };
-
-        _forEachPeasant(callback, onError);
+            result = 0;
+        }
 
         TraceLoggingWrite(g_hRemotingProvider,
                           "Monarch_lookupPeasantIdForName",
@@ -338,6 +345,21 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         return result;
     }
 
+    // Method Description:
+    // - Check our local copy of the peasant names to see if the given peasant
+    //   has the given name. This doesn't validate that the peasant is alive.
+    // Arguments:
+    // - peasantID: The ID of the peasant to check
+    // - name: The window name to compare against
+    // Return Value:
+    // - true if we know the peasant by that name.
+    bool Monarch::_peasantHasName(uint64_t peasantID, std::wstring_view name)
+    {
+        std::shared_lock lock{ _peasantsMutex };
+        const auto search = _peasantNames.find(peasantID);
+        return search != _peasantNames.end() && search->second == name;
+    }
+
     // Method Description:
     // - Handler for the `Peasant::WindowActivated` event. We'll make a in-proc
     //   copy of the WindowActivatedArgs from the peasant. That way, we won't
@@ -555,7 +577,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
                 continue;
             }
 
-            if (ignoreQuakeWindow && peasant.WindowName() == QuakeWindowName)
+            if (ignoreQuakeWindow && _peasantHasName(mruWindowArgs.PeasantID(), QuakeWindowName))
             {
                 // The _quake window should never be treated as the MRU window.
                 // Skip it if we see it. Users can still target it with `wt -w
@@ -841,7 +863,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
     //   indicating if the request was successful.
     // Return Value:
     // - <none>
-    void Monarch::_renameRequested(const winrt::Windows::Foundation::IInspectable& /*sender*/,
+    void Monarch::_renameRequested(const winrt::Windows::Foundation::IInspectable& sender,
                                    const winrt::Microsoft::Terminal::Remoting::RenameRequestArgs& args)
     {
         auto successfullyRenamed = false;
@@ -858,6 +880,15 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
                 // be renamed.
                 args.Succeeded(true);
                 successfullyRenamed = true;
+
+                // The peasant will adopt the name once we return. Update our
+                // copy of it now, so that lookups by name stay local.
+                const auto peasantID = sender.as<Remoting::IPeasant>().GetID();
+                std::unique_lock lock{ _peasantsMutex };
+                if (const auto search = _peasantNames.find(peasantID); search != _peasantNames.end())
+                {
+                    search->second = name;
+                }
             }
 
             TraceLoggingWrite(g_hRemotingProvider,
@@ -995,26 +1026,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
     bool Monarch::DoesQuakeWindowExist()
     {
-        auto result = false;
-        const auto func = [&](const auto& /*id*/, const auto& p) {
-            if (p.WindowName() == QuakeWindowName)
-            {
-                result = true;
-            }
-            // continue if we didn't get a positive result
-            return !result;
-        };
-
-        const auto onError = [&](const auto& id) {
-            TraceLoggingWrite(g_hRemotingProvider,
-                              "Monarch_DoesQuakeWindowExist_Failed",
-                              TraceLoggingInt64(id, "peasantID", "The ID of the peasant which we could not ask for its name"),
-                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-        };
-
-        _forEachPeasant(func, onError);
-        return result;
+        return _lookupPeasantIdForName(QuakeWindowName) != 0;
     }
 
     void Monarch::SummonAllWindows()
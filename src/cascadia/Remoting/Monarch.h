@@ -120,6 +120,10 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         winrt::com_ptr<IVirtualDesktopManager> _desktopManager{ nullptr };
 
         std::unordered_map<uint64_t, winrt::Microsoft::Terminal::Remoting::IPeasant> _peasants;
+        // A local copy of each peasant's window name, guarded by _peasantsMutex.
+        // Names only change through _renameRequested, so we can answer name
+        // lookups without asking every (possibly out-of-proc) peasant.
+        std::unordered_map<uint64_t, winrt::hstring> _peasantNames;
         std::vector<Remoting::WindowActivatedArgs> _mruPeasants;
         // These should not be locked at the same time to prevent deadlocks
         // unless they are both shared_locks.
@@ -129,6 +133,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         winrt::Microsoft::Terminal::Remoting::IPeasant _getPeasant(uint64_t peasantID, bool clearMruPeasantOnFailure = true);
         uint64_t _getMostRecentPeasantID(bool limitToCurrentDesktop, const bool ignoreQuakeWindow);
         uint64_t _lookupPeasantIdForName(std::wstring_view name);
+        bool _peasantHasName(uint64_t peasantID, std::wstring_view name);
 
         void _peasantWindowActivated(const winrt::Windows::Foundation::IInspectable& sender,
                                      const winrt::Microsoft::Terminal::Remoting::WindowActivatedArgs& args);
@@ -215,6 +220,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
                     for (const auto& id : peasantsToErase)
                     {
                         _peasants.erase(id);
+                        _peasantNames.erase(id);
                     }
                 }
                 _clearOldMruEntries(peasantsToErase);
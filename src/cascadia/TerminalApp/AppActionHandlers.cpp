@@ -855,54 +855,26 @@ namespace winrt::TerminalApp::implementation
     }
 
     // Function Description:
-    // - Helper to launch a new WT instance. It can either launch the instance
-    //   elevated or unelevated.
-    // - To launch elevated, it will as the shell to elevate the process for us.
-    //   This might cause a UAC prompt. The elevation is performed on a
-    //   background thread, as to not block the UI thread.
+    // - Helper to open a new (unelevated) window with a single tab in it.
+    // - The window is created by this process, the same way we create a window
+    //   for a tab that was dragged out of this one. That way, we don't need to
+    //   spawn a new wt.exe, have it find the monarch and hand its commandline
+    //   over, just so the monarch can make the window. The new window shares
+    //   our already loaded settings.
     // Arguments:
     // - newTerminalArgs: A NewTerminalArgs describing the terminal instance
     //   that should be spawned. The Profile should be filled in with the GUID
     //   of the profile we want to launch.
     // Return Value:
     // - <none>
-    // Important: Don't take the param by reference, since we'll be doing work
-    // on another thread.
-    fire_and_forget TerminalPage::_OpenNewWindow(const NewTerminalArgs newTerminalArgs)
-    {
-        // Hop to the BG thread
-        co_await winrt::resume_background();
-
-        // This will get us the correct exe for dev/preview/release. If you
-        // don't stick this in a local, it'll get mangled by ShellExecute. I
-        // have no idea why.
-        const auto exePath{ GetWtExePath() };
-
-        // Build the commandline to pass to wt for this set of NewTerminalArgs
-        // `-w -1` will ensure a new window is created.
-        winrt::hstring cmdline{
-            fmt::format(L"-w -1 new-tab {}",
-                        newTerminalArgs ? newTerminalArgs.ToCommandline().c_str() :
-                                          L"")
-        };
-
-        // Build the args to ShellExecuteEx. We need to use ShellExecuteEx so we
-        // can pass the SEE_MASK_NOASYNC flag. That flag allows us to safely
-        // call this on the background thread, and have ShellExecute _not_ call
-        // back to us on the main thread. Without this, if you close the
-        // Terminal quickly after the UAC prompt, the elevated WT will never
-        // actually spawn.
-        SHELLEXECUTEINFOW seInfo{ 0 };
-        seInfo.cbSize = sizeof(seInfo);
-        seInfo.fMask = SEE_MASK_NOASYNC;
-        // `open` will just run the executable normally.
-        seInfo.lpVerb = L"open";
-        seInfo.lpFile = exePath.c_str();
-        seInfo.lpParameters = cmdline.c_str();
-        seInfo.nShow = SW_SHOWNORMAL;
-        LOG_IF_WIN32_BOOL_FALSE(ShellExecuteExW(&seInfo));
-
-        co_return;
+    void TerminalPage::_OpenNewWindow(const NewTerminalArgs& newTerminalArgs)
+    {
+        ActionAndArgs newTabAction{};
+        newTabAction.Action(ShortcutAction::NewTab);
+        newTabAction.Args(NewTabArgs{ newTerminalArgs ? newTerminalArgs : NewTerminalArgs{} });
+
+        // "new" tells the monarch to make a new window for this content.
+        _MoveContent({ std::move(newTabAction) }, L"new", 0);
     }
 
     void TerminalPage::_HandleNewWindow(const IInspectable& /*sender*/,
@@ -201,6 +201,13 @@ void AppCommandlineArgs::_buildParser()
                     _loadPersistedLayoutIdx,
                     RS_A(L"CmdSavedLayoutArgDesc"));
 
+    // --startup-profile is read straight from the process' command line by StartupTimeline.h,
+    // because most of the startup happens before or outside of the commandline parsing.
+    // It's only parsed here, so that it doesn't get mistaken for the start of a new-tab commandline.
+    _app.add_option("--startup-profile",
+                    _startupProfilePath,
+                    RS_A(L"CmdStartupProfileArgDesc"));
+
     // Subcommands
     _buildNewTabParser();
     _buildSplitPaneParser();
@@ -1095,6 +1102,7 @@ void AppCommandlineArgs::FullResetState()
     _isHandoffListener = false;
 
     _windowTarget = {};
+    _startupProfilePath = {};
 }
 
 std::string_view AppCommandlineArgs::GetTargetWindow() const noexcept
@@ -7,10 +7,12 @@
 #include "AppLogic.g.cpp"
 #include "FindTargetWindowResult.g.cpp"
 #include "SettingsLoadEventArgs.h"
+#include "TerminalPage.h"
 
 #include <LibraryResources.h>
 #include <WtExeUtils.h>
 #include <wil/token_helpers.h>
+#include <StartupTimeline.h>
 
 #include "../../types/inc/utils.hpp"
 
@@ -203,7 +205,9 @@ namespace winrt::TerminalApp::implementation
 
         try
         {
+            ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalAppProvider, "SettingsLoadBegin");
             auto newSettings = CascadiaSettings::LoadAll();
+            ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalAppProvider, "SettingsLoadEnd");
 
             if (newSettings.GetLoadingError())
             {
@@ -715,7 +719,9 @@ namespace winrt::TerminalApp::implementation
             }
         }
 
-        ApplicationState::SharedInstance().PersistedWindowLayouts(winrt::single_threaded_vector(std::move(converted)));
+        const auto persisted = winrt::single_threaded_vector(std::move(converted));
+        ApplicationState::SharedInstance().PersistedWindowLayouts(persisted);
+        TerminalPage::CleanUpBufferSnapshots(persisted);
     }
 
     TerminalApp::ParseCommandlineResult AppLogic::GetParseCommandlineMessage(array_view<const winrt::hstring> args)
@@ -19,6 +19,31 @@ using namespace winrt::Microsoft::Terminal::Settings::Model;
 
 namespace winrt::TerminalApp::implementation
 {
+    // GH#9941: search should be locale-aware. Instead of calling lstrcmpi() for every pair
+    // of characters, the filter and the name are lowercased once and compared directly.
+    // The result has the same length as the input, so that offsets into it are valid for both.
+    static std::wstring foldCase(const std::wstring_view& str)
+    {
+        std::wstring result(str.size(), L'\0');
+        const auto length = gsl::narrow_cast<int>(str.size());
+        if (length == 0 ||
+            LCMapStringEx(LOCALE_NAME_USER_DEFAULT, LCMAP_LOWERCASE | LCMAP_LINGUISTIC_CASING, str.data(), length, result.data(), length, nullptr, nullptr, 0) != length)
+        {
+            std::transform(str.begin(), str.end(), result.begin(), [](wchar_t ch) { return gsl::narrow_cast<wchar_t>(std::towlower(ch)); });
+        }
+        return result;
+    }
+
+    static uint64_t charMask(const std::wstring_view& str) noexcept
+    {
+        uint64_t mask = 0;
+        for (const auto ch : str)
+        {
+            mask |= uint64_t{ 1 } << (ch & 63);
+        }
+        return mask;
+    }
+
     // This class is a wrapper of PaletteItem, that is used as an item of a filterable list in CommandPalette.
     // It manages a highlighted text that is computed by matching search filter characters to item name
     FilteredCommand::FilteredCommand(const winrt::TerminalApp::PaletteItem& item) :
@@ -26,6 +51,7 @@ namespace winrt::TerminalApp::implementation
         _Filter(L""),
         _Weight(0)
     {
+        _updateFoldedName();
         _HighlightedName = _computeHighlightedName();
 
         // Recompute the highlighted name if the item name changes
@@ -33,6 +59,7 @@ namespace winrt::TerminalApp::implementation
             auto filteredCommand{ weakThis.get() };
             if (filteredCommand && e.PropertyName() == L"Name")
             {
+                filteredCommand->_updateFoldedName();
                 filteredCommand->HighlightedName(filteredCommand->_computeHighlightedName());
                 filteredCommand->Weight(filteredCommand->_computeWeight());
             }
@@ -45,12 +72,42 @@ namespace winrt::TerminalApp::implementation
         // that might result in triggering a notification event
         if (filter != _Filter)
         {
+            // If the previous filter didn't match, none of its extensions can match either.
+            // This is the common case while typing and lets us skip most items entirely.
+            const auto narrowed = _Weight == 0 && !_Filter.empty() && std::wstring_view{ filter }.starts_with(_Filter);
+
             Filter(filter);
+
+            if (narrowed || !_mightMatch())
+            {
+                // A weight of 0 means that the name isn't highlighted already.
+                if (_Weight != 0)
+                {
+                    const auto segments = winrt::single_threaded_observable_vector<winrt::TerminalApp::HighlightedTextSegment>({ winrt::make<HighlightedTextSegment>(_Item.Name(), false) });
+                    HighlightedName(winrt::make<HighlightedText>(segments));
+                    Weight(0);
+                }
+                return;
+            }
+
             HighlightedName(_computeHighlightedName());
             Weight(_computeWeight());
         }
     }
 
+    void FilteredCommand::_updateFoldedName()
+    {
+        _foldedName = foldCase(_Item.Name());
+        _foldedNameMask = charMask(_foldedName);
+    }
+
+    // Returns false if the filter contains characters that the name doesn't.
+    // The reverse isn't true, as this doesn't account for the order of characters.
+    bool FilteredCommand::_mightMatch() const
+    {
+        return (charMask(foldCase(_Filter)) & ~_foldedNameMask) == 0;
+    }
+
     // Method Description:
     // - Looks up the filter characters within the item name.
     // Iterating through the filter and the item name it tries to associate the next filter character
@@ -74,13 +131,13 @@ namespace winrt::TerminalApp::implementation
     {
         const auto segments = winrt::single_threaded_observable_vector<winrt::TerminalApp::HighlightedTextSegment>();
         auto commandName = _Item.Name();
+        const auto foldedFilter = foldCase(_Filter);
         auto isProcessingMatchedSegment = false;
         uint32_t nextOffsetToReport = 0;
         uint32_t currentOffset = 0;
 
-        for (const auto searchChar : _Filter)
+        for (const auto searchChar : foldedFilter)
         {
-            const WCHAR searchCharAsString[] = { searchChar, L'\0' };
             while (true)
             {
                 if (currentOffset == commandName.size())
@@ -93,10 +150,8 @@ namespace winrt::TerminalApp::implementation
                     return winrt::make<HighlightedText>(segments);
                 }
 
-                // GH#9941: search should be locale-aware as well
-                // We use the same comparison method as upon sorting to guarantee consistent behavior
-                const WCHAR currentCharAsString[] = { commandName[currentOffset], L'\0' };
-                auto isCurrentCharMatched = lstrcmpi(searchCharAsString, currentCharAsString) == 0;
+                // GH#9941: search should be locale-aware as well (see foldCase).
+                const auto isCurrentCharMatched = _foldedName[currentOffset] == searchChar;
                 if (isProcessingMatchedSegment != isCurrentCharMatched)
                 {
                     // We reached the end of the region (matched character came after a series of unmatched or vice versa).
@@ -30,8 +30,15 @@ namespace winrt::TerminalApp::implementation
         WINRT_OBSERVABLE_PROPERTY(int, Weight, _PropertyChangedHandlers);
 
     private:
+        void _updateFoldedName();
+        bool _mightMatch() const;
         winrt::TerminalApp::HighlightedText _computeHighlightedName();
         int _computeWeight();
+
+        // Item().Name() lowercased with the user's locale and a bitmask of the characters it contains.
+        // They allow us to reject most items on every keystroke without calling into WinRT.
+        std::wstring _foldedName;
+        uint64_t _foldedNameMask = 0;
         Windows::UI::Xaml::Data::INotifyPropertyChanged::PropertyChanged_revoker _itemChangedRevoker;
 
         friend class TerminalAppLocalTests::FilteredCommandTests;
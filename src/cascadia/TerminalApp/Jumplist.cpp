@@ -11,6 +11,10 @@
 
 using namespace winrt::Microsoft::Terminal::Settings::Model;
 
+// The hash of the profile entries that were last committed to the jumplist.
+// Settings get reloaded far more often than the jumplist relevant parts of them change.
+static std::atomic<size_t> s_committedHash{ 0 };
+
 //  This property key isn't already defined in propkey.h, but is used by UWP Jumplist to determine the icon of the jumplist item.
 //  IShellLink's SetIconLocation isn't going to read "ms-appx://" icon paths, so we'll need to use this to set the icon.
 DEFINE_PROPERTYKEY(PKEY_AppUserModel_DestListLogoUri, 0x9F4C2855, 0x9F79, 0x4B39, 0xA8, 0xD0, 0xE1, 0xD4, 0x2D, 0xE1, 0xD5, 0xF3, 29);
@@ -75,9 +79,28 @@ winrt::fire_and_forget Jumplist::UpdateJumplist(const CascadiaSettings& settings
         co_return;
     }
 
-    // make sure to capture the settings _before_ the co_await
-    const auto strongSettings = settings;
+    // Collect everything we need from the settings _before_ the co_await.
+    std::vector<ProfileEntry> entries;
+    try
+    {
+        for (const auto& profile : settings.ActiveProfiles())
+        {
+            entries.push_back({ profile.Name(), profile.Icon(), profile.Guid() });
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        co_return;
+    }
+
+    const auto hash = _hashProfileEntries(entries);
+    if (hash == s_committedHash.load(std::memory_order_relaxed))
+    {
+        co_return;
+    }
 
+    // Creating the shell links and resolving their icon paths is comparatively slow.
     co_await winrt::resume_background();
 
     try
@@ -90,7 +113,7 @@ winrt::fire_and_forget Jumplist::UpdateJumplist(const CascadiaSettings& settings
         jumplistItems.capture(jumplistInstance, &ICustomDestinationList::BeginList, &slots);
 
         // Update the list of profiles.
-        _updateProfiles(jumplistItems.get(), strongSettings.ActiveProfiles().GetView());
+        _updateProfiles(jumplistItems.get(), entries);
 
         // TODO GH#1571: Add items from the future customizable new tab dropdown as well.
         // This could either replace the default profiles, or be added alongside them.
@@ -101,31 +124,57 @@ winrt::fire_and_forget Jumplist::UpdateJumplist(const CascadiaSettings& settings
         THROW_IF_FAILED(jumplistInstance->AddUserTasks(jumplistItems.get()));
 
         THROW_IF_FAILED(jumplistInstance->CommitList());
+
+        s_committedHash.store(hash, std::memory_order_relaxed);
     }
     CATCH_LOG();
 }
 
+// Method Description:
+// - Hashes the given profile entries, so that we can tell whether the jumplist needs to be updated.
+// Arguments:
+// - entries - The profile entries to hash
+// Return Value:
+// - The hash of the entries
+size_t Jumplist::_hashProfileEntries(const std::vector<ProfileEntry>& entries) noexcept
+{
+    til::hasher h;
+    h.write(entries.size());
+    for (const auto& entry : entries)
+    {
+        // The lengths are hashed as well, so that moving characters between the strings changes the hash.
+        const std::wstring_view name{ entry.name };
+        const std::wstring_view icon{ entry.icon };
+        h.write(name.size());
+        h.write(name);
+        h.write(icon.size());
+        h.write(icon);
+        h.write(entry.guid);
+    }
+    return h.finalize();
+}
+
 // Method Description:
 // - Creates and adds a ShellLink object to the Jumplist for each profile.
 // Arguments:
 // - jumplistItems - The jumplist item list
-// - profiles - The profiles to add to the jumplist
+// - entries - The profiles to add to the jumplist
 // Return Value:
 // - S_OK or HRESULT failure code.
-void Jumplist::_updateProfiles(IObjectCollection* jumplistItems, winrt::Windows::Foundation::Collections::IVectorView<Profile> profiles)
+void Jumplist::_updateProfiles(IObjectCollection* jumplistItems, const std::vector<ProfileEntry>& entries)
 {
     // It's easier to clear the list and re-add everything. The settings aren't
     // updated often, and there likely isn't a huge amount of items to add.
     THROW_IF_FAILED(jumplistItems->Clear());
 
-    for (const auto& profile : profiles)
+    for (const auto& entry : entries)
     {
         // Craft the arguments following "wt.exe"
-        auto args = fmt::format(L"-p {}", to_hstring(profile.Guid()));
+        auto args = fmt::format(L"-p {}", to_hstring(entry.guid));
 
         // Create the shell link object for the profile
-        const auto normalizedIconPath{ _normalizeIconPath(profile.Icon()) };
-        const auto shLink = _createShellLink(profile.Name(), normalizedIconPath, args);
+        const auto normalizedIconPath{ _normalizeIconPath(entry.icon) };
+        const auto shLink = _createShellLink(entry.name, normalizedIconPath, args);
         THROW_IF_FAILED(jumplistItems->AddObject(shLink.get()));
     }
 }
@@ -21,6 +21,15 @@ public:
     static winrt::fire_and_forget UpdateJumplist(const winrt::Microsoft::Terminal::Settings::Model::CascadiaSettings& settings) noexcept;
 
 private:
-    static void _updateProfiles(IObjectCollection* jumplistItems, winrt::Windows::Foundation::Collections::IVectorView<winrt::Microsoft::Terminal::Settings::Model::Profile> profiles);
+    // The parts of a profile that end up in its jumplist item.
+    struct ProfileEntry
+    {
+        winrt::hstring name;
+        winrt::hstring icon;
+        winrt::guid guid;
+    };
+
+    static size_t _hashProfileEntries(const std::vector<ProfileEntry>& entries) noexcept;
+    static void _updateProfiles(IObjectCollection* jumplistItems, const std::vector<ProfileEntry>& entries);
     static winrt::com_ptr<IShellLinkW> _createShellLink(const std::wstring_view name, const std::wstring_view path, const std::wstring_view args);
 };
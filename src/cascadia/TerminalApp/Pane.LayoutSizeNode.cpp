@@ -6,6 +6,7 @@
 
 Pane::LayoutSizeNode::LayoutSizeNode(const float minSize) :
     size{ minSize },
+    cellSize{ 0 },
     isMinimumSize{ true },
     firstChild{ nullptr },
     secondChild{ nullptr },
@@ -16,6 +17,7 @@ Pane::LayoutSizeNode::LayoutSizeNode(const float minSize) :
 
 Pane::LayoutSizeNode::LayoutSizeNode(const LayoutSizeNode& other) :
     size{ other.size },
+    cellSize{ other.cellSize },
     isMinimumSize{ other.isMinimumSize },
     firstChild{ other.firstChild ? std::make_unique<LayoutSizeNode>(*other.firstChild) : nullptr },
     secondChild{ other.secondChild ? std::make_unique<LayoutSizeNode>(*other.secondChild) : nullptr },
@@ -34,13 +36,31 @@ Pane::LayoutSizeNode::LayoutSizeNode(const LayoutSizeNode& other) :
 // - itself
 Pane::LayoutSizeNode& Pane::LayoutSizeNode::operator=(const LayoutSizeNode& other)
 {
+    // _AdvanceSnappedDimension() assigns nodes of the same shape to each other for every
+    // step of the layout. Assigning to the existing children keeps that allocation-free.
+    static constexpr auto assign = [](std::unique_ptr<LayoutSizeNode>& dst, const std::unique_ptr<LayoutSizeNode>& src) {
+        if (!src)
+        {
+            dst.reset();
+        }
+        else if (dst)
+        {
+            *dst = *src;
+        }
+        else
+        {
+            dst = std::make_unique<LayoutSizeNode>(*src);
+        }
+    };
+
     size = other.size;
+    cellSize = other.cellSize;
     isMinimumSize = other.isMinimumSize;
 
-    firstChild = other.firstChild ? std::make_unique<LayoutSizeNode>(*other.firstChild) : nullptr;
-    secondChild = other.secondChild ? std::make_unique<LayoutSizeNode>(*other.secondChild) : nullptr;
-    nextFirstChild = other.nextFirstChild ? std::make_unique<LayoutSizeNode>(*other.nextFirstChild) : nullptr;
-    nextSecondChild = other.nextSecondChild ? std::make_unique<LayoutSizeNode>(*other.nextSecondChild) : nullptr;
+    assign(firstChild, other.firstChild);
+    assign(secondChild, other.secondChild);
+    assign(nextFirstChild, other.nextFirstChild);
+    assign(nextSecondChild, other.nextSecondChild);
 
     return *this;
 }
@@ -177,6 +177,13 @@ NewTerminalArgs Pane::GetTerminalArgsForPane(const bool asContent) const
         args.ContentId(_control.ContentId());
     }
 
+    // The session ID ties the persisted layout to the buffer snapshot this
+    // connection writes, so that the next session can restore it.
+    if (const auto conpty{ _control.Connection().try_as<ConptyConnection>() })
+    {
+        args.SessionId(conpty.Guid());
+    }
+
     return args;
 }
 
@@ -2788,11 +2795,12 @@ Pane::SnapChildrenSizeResult Pane::_CalcSnappedChildrenSizes(const bool widthOrH
     // size, but it doesn't seem to be beneficial.
 
     auto sizeTree = _CreateMinSizeTree(widthOrHeight);
-    auto lastSizeTree{ sizeTree };
+    // Only the sizes of our children are needed from the previous step. Copying the whole tree instead would be costly.
+    std::pair<float, float> lastSizes{ sizeTree.firstChild->size, sizeTree.secondChild->size };
 
     while (sizeTree.size < fullSize)
     {
-        lastSizeTree = sizeTree;
+        lastSizes = { sizeTree.firstChild->size, sizeTree.secondChild->size };
         _AdvanceSnappedDimension(widthOrHeight, sizeTree);
 
         if (sizeTree.size == fullSize)
@@ -2804,10 +2812,10 @@ Pane::SnapChildrenSizeResult Pane::_CalcSnappedChildrenSizes(const bool widthOrH
         }
     }
 
-    // We exceeded the requested size in the loop above, so lastSizeTree will have
+    // We exceeded the requested size in the loop above, so lastSizes will have
     // the last good sizes (so that children fit in) and sizeTree has the next possible
     // snapped sizes. Return them as lower and higher snap possibilities.
-    return { { lastSizeTree.firstChild->size, lastSizeTree.secondChild->size },
+    return { lastSizes,
              { sizeTree.firstChild->size, sizeTree.secondChild->size } };
 }
 
@@ -2931,8 +2939,7 @@ void Pane::_AdvanceSnappedDimension(const bool widthOrHeight, LayoutSizeNode& si
         }
         else
         {
-            const auto cellSize = _control.CharacterDimensions();
-            sizeNode.size += widthOrHeight ? cellSize.Width : cellSize.Height;
+            sizeNode.size += sizeNode.cellSize;
         }
     }
     else
@@ -3075,7 +3082,13 @@ Pane::LayoutSizeNode Pane::_CreateMinSizeTree(const bool widthOrHeight) const
 {
     const auto size = _GetMinSize();
     LayoutSizeNode node(widthOrHeight ? size.Width : size.Height);
-    if (!_IsLeaf())
+    if (_IsLeaf())
+    {
+        // Cached, because _AdvanceSnappedDimension() would otherwise have to ask the control for every single step.
+        const auto cellSize = _control.CharacterDimensions();
+        node.cellSize = widthOrHeight ? cellSize.Width : cellSize.Height;
+    }
+    else
     {
         node.firstChild = std::make_unique<LayoutSizeNode>(_firstChild->_CreateMinSizeTree(widthOrHeight));
         node.secondChild = std::make_unique<LayoutSizeNode>(_secondChild->_CreateMinSizeTree(widthOrHeight));
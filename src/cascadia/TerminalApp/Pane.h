@@ -398,6 +398,8 @@ private:
     struct LayoutSizeNode
     {
         float size;
+        // The width or height of a cell of a leaf pane's terminal.
+        float cellSize;
         bool isMinimumSize;
         std::unique_ptr<LayoutSizeNode> firstChild;
         std::unique_ptr<LayoutSizeNode> secondChild;
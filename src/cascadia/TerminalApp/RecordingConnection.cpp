@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "RecordingConnection.h"
+
+using namespace ::winrt::Microsoft::Terminal::TerminalConnection;
+using namespace ::winrt::Windows::Foundation;
+using namespace ::Microsoft::Console::VtRecording;
+
+namespace winrt::Microsoft::TerminalApp::implementation
+{
+    RecordingConnection::RecordingConnection(ITerminalConnection wrappedConnection, wil::unique_hfile file) :
+        _wrappedConnection{ std::move(wrappedConnection) },
+        _file{ std::move(file) },
+        _start{ std::chrono::steady_clock::now() }
+    {
+        _buffer.reserve(_flushThreshold);
+        _outputRevoker = _wrappedConnection.TerminalOutput(winrt::auto_revoke, { this, &RecordingConnection::_OutputHandler });
+    }
+
+    RecordingConnection::~RecordingConnection()
+    {
+        _outputRevoker.revoke();
+
+        const std::lock_guard guard{ _mutex };
+        _flush();
+    }
+
+    void RecordingConnection::Start()
+    {
+        _wrappedConnection.Start();
+    }
+
+    void RecordingConnection::WriteInput(const hstring& data)
+    {
+        _recordText(RecordType::Input, data);
+        _wrappedConnection.WriteInput(data);
+    }
+
+    void RecordingConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        const ResizePayload payload{ rows, columns };
+        {
+            const std::lock_guard guard{ _mutex };
+            _record(RecordType::Resize, &payload, sizeof(payload));
+        }
+        _wrappedConnection.Resize(rows, columns);
+    }
+
+    void RecordingConnection::Close()
+    {
+        _outputRevoker.revoke();
+        {
+            const std::lock_guard guard{ _mutex };
+            _flush();
+            _file.reset();
+        }
+        _wrappedConnection.Close();
+    }
+
+    ConnectionState RecordingConnection::State() const noexcept
+    {
+        return _wrappedConnection.State();
+    }
+
+    winrt::event_token RecordingConnection::TerminalOutput(const TerminalOutputHandler& handler)
+    {
+        return _wrappedConnection.TerminalOutput(handler);
+    }
+
+    void RecordingConnection::TerminalOutput(const winrt::event_token& token) noexcept
+    {
+        _wrappedConnection.TerminalOutput(token);
+    }
+
+    winrt::event_token RecordingConnection::StateChanged(const TypedEventHandler<ITerminalConnection, IInspectable>& handler)
+    {
+        return _wrappedConnection.StateChanged(handler);
+    }
+
+    void RecordingConnection::StateChanged(const winrt::event_token& token) noexcept
+    {
+        _wrappedConnection.StateChanged(token);
+    }
+
+    void RecordingConnection::_OutputHandler(const hstring& str)
+    {
+        _recordText(RecordType::Output, str);
+    }
+
+    void RecordingConnection::_recordText(RecordType type, std::wstring_view text)
+    {
+        const std::lock_guard guard{ _mutex };
+        if (SUCCEEDED_LOG(til::u16u8(text, _scratch)))
+        {
+            _record(type, _scratch.data(), _scratch.size());
+        }
+    }
+
+    // Method Description:
+    // - Appends a record to the buffer and flushes it once it's full. Must be called with _mutex held.
+    void RecordingConnection::_record(RecordType type, const void* data, size_t size)
+    {
+        if (!_file)
+        {
+            return;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start);
+        const RecordHeader header{
+            .timestamp = gsl::narrow_cast<uint64_t>(elapsed.count()),
+            .size = gsl::narrow<uint32_t>(size),
+            .type = type,
+        };
+
+        const auto headerBytes = reinterpret_cast<const uint8_t*>(&header);
+        const auto dataBytes = static_cast<const uint8_t*>(data);
+        _buffer.insert(_buffer.end(), headerBytes, headerBytes + sizeof(header));
+        _buffer.insert(_buffer.end(), dataBytes, dataBytes + size);
+
+        if (_buffer.size() >= _flushThreshold)
+        {
+            _flush();
+        }
+    }
+
+    // Method Description:
+    // - Writes the buffered records to the file. Must be called with _mutex held.
+    //   If writing fails, recording stops, but the connection continues to work.
+    void RecordingConnection::_flush()
+    {
+        if (!_file || _buffer.empty())
+        {
+            return;
+        }
+
+        DWORD written = 0;
+        if (!WriteFile(_file.get(), _buffer.data(), gsl::narrow<DWORD>(_buffer.size()), &written, nullptr))
+        {
+            LOG_LAST_ERROR();
+            _file.reset();
+        }
+
+        _buffer.clear();
+    }
+}
+
+// Function Description
+// - Wraps the given connection in a RecordingConnection which records the session into the given file.
+//   If the file can't be created, the original connection is returned instead.
+ITerminalConnection OpenRecordingConnection(ITerminalConnection baseConnection, const std::filesystem::path& path)
+try
+{
+    wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    static constexpr FileHeader header{ Magic, Version };
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), &header, sizeof(header), &written, nullptr));
+
+    return winrt::make<winrt::Microsoft::TerminalApp::implementation::RecordingConnection>(baseConnection, std::move(file));
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return baseConnection;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <winrt/Microsoft.Terminal.TerminalConnection.h>
+
+#include "../../inc/VtRecording.h"
+
+namespace winrt::Microsoft::TerminalApp::implementation
+{
+    // RecordingConnection wraps another connection and writes everything that passes through it
+    // (output, input and resizes) with timestamps into a file, so that it can be replayed later
+    // with the vtreplay tool. See VtRecording.h for the file format.
+    class RecordingConnection : public winrt::implements<RecordingConnection, winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection>
+    {
+    public:
+        RecordingConnection(Microsoft::Terminal::TerminalConnection::ITerminalConnection wrappedConnection, wil::unique_hfile file);
+        ~RecordingConnection();
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& /*settings*/){};
+        void Start();
+        void WriteInput(const hstring& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close();
+        winrt::Microsoft::Terminal::TerminalConnection::ConnectionState State() const noexcept;
+
+        winrt::event_token TerminalOutput(const winrt::Microsoft::Terminal::TerminalConnection::TerminalOutputHandler& handler);
+        void TerminalOutput(const winrt::event_token& token) noexcept;
+        winrt::event_token StateChanged(const winrt::Windows::Foundation::TypedEventHandler<winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection, winrt::Windows::Foundation::IInspectable>& handler);
+        void StateChanged(const winrt::event_token& token) noexcept;
+
+    private:
+        // Records are buffered and written out in batches of this size, to keep the I/O off the output path.
+        static constexpr size_t _flushThreshold = 64 * 1024;
+
+        void _OutputHandler(const hstring& str);
+        void _recordText(::Microsoft::Console::VtRecording::RecordType type, std::wstring_view text);
+        void _record(::Microsoft::Console::VtRecording::RecordType type, const void* data, size_t size);
+        void _flush();
+
+        Microsoft::Terminal::TerminalConnection::ITerminalConnection _wrappedConnection;
+        Microsoft::Terminal::TerminalConnection::ITerminalConnection::TerminalOutput_revoker _outputRevoker;
+
+        // Output arrives on the connection's thread, while input and resizes arrive on the UI thread.
+        std::mutex _mutex;
+        wil::unique_hfile _file;
+        std::vector<uint8_t> _buffer;
+        std::string _scratch;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection OpenRecordingConnection(winrt::Microsoft::Terminal::TerminalConnection::ITerminalConnection baseConnection, const std::filesystem::path& path);
@@ -21,6 +21,7 @@
 #include "App.h"
 #include "ColorHelper.h"
 #include "DebugTapConnection.h"
+#include "RecordingConnection.h"
 #include "SettingsTab.h"
 #include "TabRowControl.h"
 #include "Utils.h"
@@ -587,10 +588,26 @@ namespace winrt::TerminalApp::implementation
             _WindowProperties.VirtualWorkingDirectory(cwd);
         }
 
+        // The window stays hidden until we _CompleteInitialization(), but building a tab takes a while
+        // (XAML, the control, its connection). With a startup layout of many tabs, we show the
+        // window as soon as the first tab is done and build the others afterwards.
+        // Tabs that aren't selected don't initialize their renderer or connection until they are.
+        auto initializationPending = initial;
+
         if (auto page{ weakThis.get() })
         {
             for (const auto& action : actions)
             {
+                if (initializationPending && action.Action() == ShortcutAction::NewTab && _tabs.Size() != 0)
+                {
+                    initializationPending = false;
+                    _CompleteInitialization();
+
+                    // Give the window a chance to show and paint the first tab. The Initialized event and
+                    // AppHost's ShowWindow() are both dispatched with Low priority, so we must wait for Idle.
+                    co_await wil::resume_foreground(Dispatcher(), CoreDispatcherPriority::Idle);
+                }
+
                 if (auto page{ weakThis.get() })
                 {
                     _actionDispatch->DoAction(action);
@@ -609,7 +626,7 @@ namespace winrt::TerminalApp::implementation
                 control.Focus(FocusState::Programmatic);
             }
         }
-        if (initial)
+        if (initializationPending)
         {
             _CompleteInitialization();
         }
@@ -1185,11 +1202,14 @@ namespace winrt::TerminalApp::implementation
     // Arguments:
     // - the profile we want the settings from
     // - the terminal settings
+    // - whether the connection should inherit the cursor position
+    // - the session ID to reuse, if we're restoring a persisted layout, or a null GUID for a new one
     // Return value:
     // - the desired connection
     TerminalConnection::ITerminalConnection TerminalPage::_CreateConnectionFromSettings(Profile profile,
                                                                                         TerminalSettings settings,
-                                                                                        const bool inheritCursor)
+                                                                                        const bool inheritCursor,
+                                                                                        const winrt::guid& sessionId)
     {
         TerminalConnection::ITerminalConnection connection{ nullptr };
 
@@ -1227,6 +1247,21 @@ namespace winrt::TerminalApp::implementation
             connection.Initialize(valueSet);
         }
 
+        else if (connectionType == TerminalConnection::SharedMemoryConnection::ConnectionType())
+        {
+            // VT producers that speak the VtSharedMemory protocol are hosted without conpty.
+            // The settings have the same keys as those of a ConptyConnection, so we reuse its helper.
+            connection = TerminalConnection::SharedMemoryConnection{};
+            connection.Initialize(TerminalConnection::ConptyConnection::CreateSettings(settings.Commandline(),
+                                                                                      _evaluatePathForCwd(settings.StartingDirectory()),
+                                                                                      settings.StartingTitle(),
+                                                                                      nullptr,
+                                                                                      settings.InitialRows(),
+                                                                                      settings.InitialCols(),
+                                                                                      winrt::guid(),
+                                                                                      profile.Guid()));
+        }
+
         else
         {
             const auto environment = settings.EnvironmentVariables() != nullptr ?
@@ -1256,7 +1291,7 @@ namespace winrt::TerminalApp::implementation
                                                                                  environment,
                                                                                  settings.InitialRows(),
                                                                                  settings.InitialCols(),
-                                                                                 winrt::guid(),
+                                                                                 sessionId,
                                                                                  profile.Guid());
 
             valueSet.Insert(L"passthroughMode", Windows::Foundation::PropertyValue::CreateBoolean(settings.VtPassthrough()));
@@ -1322,7 +1357,7 @@ namespace winrt::TerminalApp::implementation
             }
         }
 
-        return _CreateConnectionFromSettings(profile, controlSettings.DefaultSettings(), true);
+        return _CreateConnectionFromSettings(profile, controlSettings.DefaultSettings(), true, {});
     }
 
     // Method Description:
@@ -2956,9 +2991,88 @@ namespace winrt::TerminalApp::implementation
         // TermControl will copy the settings out of the settings passed to it.
 
         const auto content = _manager.CreateCore(settings.DefaultSettings(), settings.UnfocusedSettings(), connection);
+
+        // The snapshot is named after the session, which the persisted layout
+        // remembers, so that the next session can pick up where this one left off.
+        if constexpr (Feature_BufferSnapshots::IsEnabled())
+        {
+            if (_settings.GlobalSettings().ShouldUsePersistedLayout())
+            {
+                if (const auto conpty{ connection.try_as<TerminalConnection::ConptyConnection>() })
+                {
+                    content.Core().EnableBufferSnapshots(_bufferSnapshotPath(conpty.Guid()).native());
+                }
+            }
+        }
+
         return _SetupControl(TermControl{ content });
     }
 
+    std::filesystem::path TerminalPage::_bufferSnapshotPath(const winrt::guid& sessionId)
+    {
+        std::filesystem::path path{ std::wstring_view{ CascadiaSettings::SettingsPath() } };
+        path.replace_filename(fmt::format(L"buffer_{}.bin", ::Microsoft::Console::Utils::GuidToString(sessionId)));
+        return path;
+    }
+
+    // Method Description:
+    // - Deletes the buffer snapshots that none of the given layouts refer to anymore,
+    //   for instance because their tab was closed. Snapshots that are still being
+    //   written to can't be deleted, which is fine, as they belong to a live session.
+    // Arguments:
+    // - layouts: The window layouts that were just persisted.
+    void TerminalPage::CleanUpBufferSnapshots(const IVector<WindowLayout>& layouts)
+    {
+        if constexpr (Feature_BufferSnapshots::IsEnabled())
+        {
+            std::unordered_set<std::wstring> keep;
+            if (layouts)
+            {
+                for (const auto& layout : layouts)
+                {
+                    const auto tabLayout = layout ? layout.TabLayout() : nullptr;
+                    if (!tabLayout)
+                    {
+                        continue;
+                    }
+
+                    for (const auto& actionAndArgs : tabLayout)
+                    {
+                        NewTerminalArgs terminalArgs{ nullptr };
+                        if (const auto newTab{ actionAndArgs.Args().try_as<NewTabArgs>() })
+                        {
+                            terminalArgs = newTab.TerminalArgs();
+                        }
+                        else if (const auto splitPane{ actionAndArgs.Args().try_as<SplitPaneArgs>() })
+                        {
+                            terminalArgs = splitPane.TerminalArgs();
+                        }
+
+                        if (terminalArgs && terminalArgs.SessionId() != winrt::guid{})
+                        {
+                            keep.emplace(_bufferSnapshotPath(terminalArgs.SessionId()).filename().native());
+                        }
+                    }
+                }
+            }
+
+            try
+            {
+                const auto directory = _bufferSnapshotPath({}).parent_path();
+                for (const auto& entry : std::filesystem::directory_iterator{ directory })
+                {
+                    const auto filename = entry.path().filename().native();
+                    if (til::starts_with(filename, L"buffer_") && til::ends_with(filename, L".bin") && !keep.contains(filename))
+                    {
+                        std::error_code ec;
+                        std::filesystem::remove(entry.path(), ec);
+                    }
+                }
+            }
+            CATCH_LOG();
+        }
+    }
+
     TermControl TerminalPage::_AttachControlToContent(const uint64_t& contentId)
     {
         if (const auto& content{ _manager.TryLookupCore(contentId) })
@@ -3056,12 +3170,22 @@ namespace winrt::TerminalApp::implementation
             return nullptr;
         }
 
-        auto connection = existingConnection ? existingConnection : _CreateConnectionFromSettings(profile, controlSettings.DefaultSettings(), false);
+        const auto sessionId = newTerminalArgs ? newTerminalArgs.SessionId() : winrt::guid{};
+        auto connection = existingConnection ? existingConnection : _CreateConnectionFromSettings(profile, controlSettings.DefaultSettings(), false, sessionId);
         if (existingConnection)
         {
             connection.Resize(controlSettings.DefaultSettings().InitialRows(), controlSettings.DefaultSettings().InitialCols());
         }
 
+        // Record the session for later replay, if the user asked for it. This must wrap the connection
+        // before the debug tap does, so that the tap doesn't end up in the recording.
+        if (const auto recordingDirectory = _settings.GlobalSettings().SessionRecordingDirectory(); !recordingDirectory.empty())
+        {
+            std::filesystem::path path{ std::wstring_view{ recordingDirectory } };
+            path /= fmt::format(L"session_{}.wtrec", ::Microsoft::Console::Utils::GuidToString(::Microsoft::Console::Utils::CreateGuid()));
+            connection = OpenRecordingConnection(connection, path);
+        }
+
         TerminalConnection::ITerminalConnection debugConnection{ nullptr };
         if (_settings.GlobalSettings().DebugFeaturesEnabled())
         {
@@ -77,6 +77,22 @@ namespace winrt::TerminalApp::implementation
     // - <none>
     void TerminalTab::_Setup()
     {
+        const auto dispatcher = winrt::Windows::System::DispatcherQueue::GetForCurrentThread();
+        _updateTitle = std::make_shared<ThrottledFuncTrailing<>>(dispatcher, UpdateThrottleDelay, [weakThis = get_weak()]() {
+            if (auto tab{ weakThis.get() })
+            {
+                // The title of the control changed, but not necessarily the title of the tab.
+                // Set the tab's text to the active panes' text.
+                tab->UpdateTitle();
+            }
+        });
+        _updateProgressState = std::make_shared<ThrottledFuncTrailing<>>(dispatcher, UpdateThrottleDelay, [weakThis = get_weak()]() {
+            if (auto tab{ weakThis.get() })
+            {
+                tab->_UpdateProgressState();
+            }
+        });
+
         _rootClosedToken = _rootPane->Closed([=](auto&& /*s*/, auto&& /*e*/) {
             _ClosedHandlers(nullptr, nullptr);
         });
@@ -918,15 +934,8 @@ namespace winrt::TerminalApp::implementation
         auto dispatcher = TabViewItem().Dispatcher();
         ControlEventTokens events{};
 
-        events.titleToken = control.TitleChanged([dispatcher, weakThis](auto&&, auto&&) -> winrt::fire_and_forget {
-            co_await wil::resume_foreground(dispatcher);
-            // Check if Tab's lifetime has expired
-            if (auto tab{ weakThis.get() })
-            {
-                // The title of the control changed, but not necessarily the title of the tab.
-                // Set the tab's text to the active panes' text.
-                tab->UpdateTitle();
-            }
+        events.titleToken = control.TitleChanged([updateTitle = _updateTitle](auto&&, auto&&) {
+            updateTitle->Run();
         });
 
         events.colorToken = control.TabColorChanged([dispatcher, weakThis](auto&&, auto&&) -> winrt::fire_and_forget {
@@ -940,13 +949,8 @@ namespace winrt::TerminalApp::implementation
             }
         });
 
-        events.taskbarToken = control.SetTaskbarProgress([dispatcher, weakThis](auto&&, auto&&) -> winrt::fire_and_forget {
-            co_await wil::resume_foreground(dispatcher);
-            // Check if Tab's lifetime has expired
-            if (auto tab{ weakThis.get() })
-            {
-                tab->_UpdateProgressState();
-            }
+        events.taskbarToken = control.SetTaskbarProgress([updateProgressState = _updateProgressState](auto&&, auto&&) {
+            updateProgressState->Run();
         });
 
         events.readOnlyToken = control.ReadOnlyChanged([dispatcher, weakThis](auto&&, auto&&) -> winrt::fire_and_forget {
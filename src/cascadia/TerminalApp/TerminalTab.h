@@ -7,6 +7,8 @@
 #include "TabBase.h"
 #include "TerminalTab.g.h"
 
+#include <ThrottledFunc.h>
+
 // fwdecl unittest classes
 namespace TerminalAppLocalTests
 {
@@ -103,6 +105,7 @@ namespace winrt::TerminalApp::implementation
     private:
         static constexpr double HeaderRenameBoxWidthDefault{ 165 };
         static constexpr double HeaderRenameBoxWidthTitleLength{ std::numeric_limits<double>::infinity() };
+        static constexpr std::chrono::milliseconds UpdateThrottleDelay{ 16 };
 
         std::shared_ptr<Pane> _rootPane{ nullptr };
         std::shared_ptr<Pane> _activePane{ nullptr };
@@ -134,6 +137,11 @@ namespace winrt::TerminalApp::implementation
         };
         std::unordered_map<uint32_t, ControlEventTokens> _controlEvents;
 
+        // Applications may change their title and progress for every single line they print.
+        // These coalesce the updates to the tab header (and through it the window) to at most one per frame.
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateTitle;
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateProgressState;
+
         winrt::event_token _rootClosedToken{};
 
         std::vector<uint32_t> _mruPanes;
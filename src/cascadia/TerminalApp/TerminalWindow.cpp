@@ -8,6 +8,7 @@
 #include "../inc/WindowingBehavior.h"
 
 #include <LibraryResources.h>
+#include <StartupTimeline.h>
 
 #include "TerminalWindow.g.cpp"
 #include "SettingsLoadEventArgs.g.cpp"
@@ -236,7 +237,9 @@ namespace winrt::TerminalApp::implementation
             }
 
             AppLogic::Current()->NotifyRootInitialized();
+            ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalAppProvider, "TerminalPageInitialized");
         });
+        ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalAppProvider, "TerminalPageCreate");
         _root->Create();
 
         AppLogic::Current()->SettingsChanged({ get_weak(), &TerminalWindow::UpdateSettingsHandler });
@@ -916,7 +919,9 @@ namespace winrt::TerminalApp::implementation
                 {
                     layout.InitialPosition(pos);
                     const auto state = ApplicationState::SharedInstance();
-                    state.PersistedWindowLayouts(winrt::single_threaded_vector<WindowLayout>({ layout }));
+                    const auto layouts = winrt::single_threaded_vector<WindowLayout>({ layout });
+                    state.PersistedWindowLayouts(layouts);
+                    TerminalPage::CleanUpBufferSnapshots(layouts);
                 }
             }
 
@@ -930,6 +935,7 @@ namespace winrt::TerminalApp::implementation
         {
             auto state = ApplicationState::SharedInstance();
             state.PersistedWindowLayouts(nullptr);
+            TerminalPage::CleanUpBufferSnapshots(nullptr);
         }
     }
 
@@ -187,8 +187,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         if (_state == AzureState::TermConnected)
         {
-            auto buff{ winrt::to_string(data) };
-            WinHttpWebSocketSend(_webSocket.get(), WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE, buff.data(), gsl::narrow<DWORD>(buff.size()));
+            // The conversion state carries surrogate pairs that are split across two calls.
+            if (FAILED(til::u16u8(data, _u8Str, _u16State)) || _u8Str.empty())
+            {
+                return;
+            }
+            WinHttpWebSocketSend(_webSocket.get(), WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE, _u8Str.data(), gsl::narrow<DWORD>(_u8Str.size()));
             return;
         }
 
@@ -390,18 +394,31 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 {
                     _transitionToState(ConnectionState::Connected);
 
+                    // The number of bytes of the current message that are already in _buffer.
+                    size_t filled = 0;
+
                     while (true)
                     {
                         WINHTTP_WEB_SOCKET_BUFFER_TYPE bufferType{};
                         DWORD read{};
-                        THROW_IF_WIN32_ERROR(WinHttpWebSocketReceive(_webSocket.get(), _buffer.data(), gsl::narrow<DWORD>(_buffer.size()), &read, &bufferType));
+                        THROW_IF_WIN32_ERROR(WinHttpWebSocketReceive(_webSocket.get(), _buffer.data() + filled, gsl::narrow<DWORD>(_buffer.size() - filled), &read, &bufferType));
 
                         switch (bufferType)
                         {
                         case WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE:
                         case WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE:
                         {
-                            const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
+                            filled += read;
+
+                            // The remainder of a fragmented message is already on its way. We collect it
+                            // so that it's passed on as a single TerminalOutput event, unless _buffer is full.
+                            if (bufferType == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE && filled < _buffer.size())
+                            {
+                                continue;
+                            }
+
+                            const auto result{ til::u8u16(std::string_view{ _buffer.data(), filled }, _u16Str, _u8State) };
+                            filled = 0;
                             if (FAILED(result))
                             {
                                 // EXIT POINT
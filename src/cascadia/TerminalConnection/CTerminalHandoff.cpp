@@ -11,6 +11,12 @@ using namespace Microsoft::WRL;
 static NewHandoffFunction _pfnHandoff = nullptr;
 // The registration ID of the class object for clean up later
 static DWORD g_cTerminalHandoffRegistration = 0;
+// The callback function when a connection is received through the persistent registration
+static NewHandoffFunction _pfnPersistentHandoff = nullptr;
+// The registration ID of the persistent class object. It's never revoked.
+static DWORD g_cTerminalHandoffPersistentRegistration = 0;
+// True if the persistent registration is made once the single-use one has received its handoff.
+static bool _persistentDeferred = false;
 // Mutex so we only do start/stop/establish one at a time.
 static std::shared_mutex _mtx;
 
@@ -43,6 +49,60 @@ try
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Starts listening for TerminalHandoff requests for the remaining lifetime of the process.
+//   Unlike s_StartListening(), this registration handles any number of handoffs, which means that
+//   COM hands all future console applications to this process instead of launching a new Terminal.
+// - Only one of the two registrations can exist at a time. If a single-use registration is active,
+//   or if afterNextHandoff is true, the persistent one is made after the next single-use handoff.
+// Arguments:
+// - pfnHandoff - Function to callback when a handoff is received
+// - afterNextHandoff - Wait for the upcoming s_StartListening() handoff. This is meant for processes that
+//   COM started for a handoff, whose single-use registration may not have been made yet.
+// Return Value:
+// - S_OK, E_NOT_VALID_STATE (start called when already started) or relevant COM registration error.
+HRESULT CTerminalHandoff::s_StartListeningPersistently(NewHandoffFunction pfnHandoff, bool afterNextHandoff)
+try
+{
+    std::unique_lock lock{ _mtx };
+
+    RETURN_HR_IF(E_NOT_VALID_STATE, _pfnPersistentHandoff != nullptr);
+
+    _pfnPersistentHandoff = pfnHandoff;
+
+    if (afterNextHandoff || _pfnHandoff != nullptr)
+    {
+        _persistentDeferred = true;
+        return S_OK;
+    }
+
+    return s_RegisterPersistentLocked();
+}
+CATCH_RETURN()
+
+// See s_StartListeningPersistently()
+HRESULT CTerminalHandoff::s_RegisterPersistentLocked()
+{
+    const auto classFactory = Make<SimpleClassFactory<CTerminalHandoff>>();
+
+    RETURN_IF_NULL_ALLOC(classFactory);
+
+    ComPtr<IUnknown> unk;
+    RETURN_IF_FAILED(classFactory.As(&unk));
+
+    RETURN_IF_FAILED(CoRegisterClassObject(__uuidof(CTerminalHandoff), unk.Get(), CLSCTX_LOCAL_SERVER, REGCLS_MULTIPLEUSE, &g_cTerminalHandoffPersistentRegistration));
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Returns true if the persistent registration (see s_StartListeningPersistently) is receiving handoffs.
+bool CTerminalHandoff::s_IsListeningPersistently()
+{
+    std::shared_lock lock{ _mtx };
+    return g_cTerminalHandoffPersistentRegistration != 0;
+}
+
 // Routine Description:
 // - Stops listening for TerminalHandoff requests by revoking the registration
 //   our class and interface with COM
@@ -113,9 +173,23 @@ HRESULT CTerminalHandoff::EstablishPtyHandoff(HANDLE in, HANDLE out, HANDLE sign
 #pragma warning(suppress : 26429) // Symbol '...' is never tested for nullness, it can be marked as not_null (f.23).
         auto localPfnHandoff = _pfnHandoff;
 
-        // Because we are REGCLS_SINGLEUSE... we need to `CoRevokeClassObject` after we handle this ONE call.
-        // COM does not automatically clean that up for us. We must do it.
-        LOG_IF_FAILED(s_StopListeningLocked());
+        if (localPfnHandoff)
+        {
+            // Because we are REGCLS_SINGLEUSE... we need to `CoRevokeClassObject` after we handle this ONE call.
+            // COM does not automatically clean that up for us. We must do it.
+            LOG_IF_FAILED(s_StopListeningLocked());
+
+            // The persistent registration takes over from here on.
+            if (_persistentDeferred)
+            {
+                _persistentDeferred = false;
+                LOG_IF_FAILED(s_RegisterPersistentLocked());
+            }
+        }
+        else if (g_cTerminalHandoffPersistentRegistration)
+        {
+            localPfnHandoff = _pfnPersistentHandoff;
+        }
 
         // Report an error if no one registered a handoff function before calling this.
         THROW_HR_IF_NULL(E_NOT_VALID_STATE, localPfnHandoff);
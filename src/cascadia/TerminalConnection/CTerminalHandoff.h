@@ -45,10 +45,13 @@ struct __declspec(uuid(__CLSID_CTerminalHandoff))
 #pragma endregion
 
     static HRESULT s_StartListening(NewHandoffFunction pfnHandoff);
+    static HRESULT s_StartListeningPersistently(NewHandoffFunction pfnHandoff, bool afterNextHandoff);
     static HRESULT s_StopListening();
+    static bool s_IsListeningPersistently();
 
 private:
     static HRESULT s_StopListeningLocked();
+    static HRESULT s_RegisterPersistentLocked();
 };
 
 // Disable warnings from the CoCreatableClass macro as the value it provides for
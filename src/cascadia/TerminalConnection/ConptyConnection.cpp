@@ -7,7 +7,10 @@
 #include <conpty-static.h>
 #include <til/string.h>
 #include <til/env.h>
+#include <til/mutex.h>
+#include <future>
 #include <winternl.h>
+#include <StartupTimeline.h>
 
 #include "CTerminalHandoff.h"
 #include "LibraryResources.h"
@@ -50,40 +53,224 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile inPipeOurSide, inPipePseudoConsoleSide;
 
         RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&inPipePseudoConsoleSide, &inPipeOurSide, nullptr, 0));
-        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&outPipeOurSide, &outPipePseudoConsoleSide, nullptr, 0));
+        // The output pipe gets a buffer as large as our read buffer, so that a single ReadFile()
+        // in _OutputThread can drain everything conpty has written in the meantime.
+        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&outPipeOurSide, &outPipePseudoConsoleSide, nullptr, gsl::narrow_cast<DWORD>(ConptyConnection::OutputReadSize)));
         RETURN_IF_FAILED(ConptyCreatePseudoConsole(size, inPipePseudoConsoleSide.get(), outPipePseudoConsoleSide.get(), dwFlags, phPC));
         *phInput = inPipeOurSide.release();
         *phOutput = outPipeOurSide.release();
         return S_OK;
     }
 
+    // Feature_ConptyWarmPool: A spare pseudoconsole for the next connection. See _takeWarmPseudoConsole().
+    struct WarmPseudoConsole
+    {
+        wil::unique_hfile inPipe;
+        wil::unique_hfile outPipe;
+        HPCON hPC = nullptr;
+        bool refilling = false;
+    };
+    static til::shared_mutex<WarmPseudoConsole> s_warmPseudoConsole;
+
     // Function Description:
-    // - launches the client application attached to the new pseudoconsole
-    HRESULT ConptyConnection::_LaunchAttachedClient() noexcept
+    // - CreatePseudoConsole() launches an OpenConsole process and waits for it to
+    //   connect, which is a large part of the time it takes to open a new tab.
+    //   We keep one spare pseudoconsole with the default flags around and hand it to
+    //   the next connection that needs one, resized to its dimensions. Afterwards
+    //   a new spare one is created in the background.
+    // Arguments:
+    // - dimensions: The size of the conpty that the caller needs.
+    // - phInput, phOutput, phPC: See _CreatePseudoConsoleAndPipes().
+    // Return Value:
+    // - true if the out parameters received the spare pseudoconsole.
+    bool ConptyConnection::_takeWarmPseudoConsole(const til::size dimensions, HANDLE* phInput, HANDLE* phOutput, HPCON* phPC) noexcept
+    {
+        auto taken = false;
+        auto refill = false;
+
+        {
+            auto warm = s_warmPseudoConsole.lock();
+            if (warm->hPC)
+            {
+                *phInput = warm->inPipe.release();
+                *phOutput = warm->outPipe.release();
+                *phPC = std::exchange(warm->hPC, nullptr);
+                taken = true;
+            }
+            if (!warm->refilling)
+            {
+                warm->refilling = true;
+                refill = true;
+            }
+        }
+
+        // The out parameters point into the caller's smart pointers,
+        // which will clean up the handles if we return false here.
+        if (taken && FAILED_LOG(ConptyResizePseudoConsole(*phPC, til::unwrap_coord_size(dimensions))))
+        {
+            taken = false;
+        }
+
+        if (refill)
+        {
+            _refillWarmPseudoConsole(dimensions);
+        }
+
+        return taken;
+    }
+
+    // Function Description:
+    // - Feature_ConptySharedMemory: Creates the pseudoconsole with a VtSharedMemory section,
+    //   so that OpenConsole writes its output into a ring buffer that the output thread reads
+    //   from directly and reads its input from another one, instead of using the pipes.
+    //   The pipes are created regardless, because a console host that doesn't
+    //   support this (see ConptyCreatePseudoConsoleWithSharedMemory()) uses them instead.
+    // Arguments:
+    // - dimensions: The size of the conpty to create, in characters.
+    // - flags: The PSEUDOCONSOLE_* flags to create it with.
+    // Return Value:
+    // - true if the pseudoconsole was created, whether it accepted the section or not.
+    bool ConptyConnection::_createPseudoConsoleWithSharedMemory(const til::size dimensions, const DWORD flags) noexcept
     try
     {
-        STARTUPINFOEX siEx{ 0 };
-        siEx.StartupInfo.cb = sizeof(STARTUPINFOEX);
-        siEx.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
-        SIZE_T size{};
-        // This call will return an error (by design); we are ignoring it.
-        InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
-#pragma warning(suppress : 26414) // We don't move/touch this smart pointer, but we have to allocate strangely for the adjustable size list.
-        auto attrList{ std::make_unique<std::byte[]>(size) };
-#pragma warning(suppress : 26490) // We have to use reinterpret_cast because we allocated a byte array as a proxy for the adjustable size list.
-        siEx.lpAttributeList = reinterpret_cast<PPROC_THREAD_ATTRIBUTE_LIST>(attrList.get());
-        RETURN_IF_WIN32_BOOL_FALSE(InitializeProcThreadAttributeList(siEx.lpAttributeList, 1, 0, &size));
+        wil::unique_hfile outPipeOurSide, outPipePseudoConsoleSide;
+        wil::unique_hfile inPipeOurSide, inPipePseudoConsoleSide;
+        THROW_IF_WIN32_BOOL_FALSE(CreatePipe(&inPipePseudoConsoleSide, &inPipeOurSide, nullptr, 0));
+        THROW_IF_WIN32_BOOL_FALSE(CreatePipe(&outPipeOurSide, &outPipePseudoConsoleSide, nullptr, 0));
 
-        RETURN_IF_WIN32_BOOL_FALSE(UpdateProcThreadAttribute(siEx.lpAttributeList,
-                                                             0,
-                                                             PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE,
-                                                             _hPC.get(),
-                                                             sizeof(HPCON),
-                                                             nullptr,
-                                                             nullptr));
+        // winconpty duplicates the section and events for OpenConsole itself, so they needn't be inheritable.
+        _sharedMemory.emplace(gsl::narrow_cast<uint32_t>(dimensions.height), gsl::narrow_cast<uint32_t>(dimensions.width), false);
+        auto resetSharedMemory = wil::scope_exit([&]() noexcept {
+            _sharedMemory.reset();
+        });
 
-        auto cmdline{ wil::ExpandEnvironmentStringsW<std::wstring>(_commandline.c_str()) }; // mutable copy -- required for CreateProcessW
+        wil::unique_handle conptyProcess;
+        const auto hr = ConptyCreatePseudoConsoleWithSharedMemory(til::unwrap_coord_size(dimensions),
+                                                                  inPipePseudoConsoleSide.get(),
+                                                                  outPipePseudoConsoleSide.get(),
+                                                                  _sharedMemory->Section(),
+                                                                  flags,
+                                                                  &_hPC,
+                                                                  conptyProcess.addressof());
+        THROW_IF_FAILED(hr);
+
+        _inPipe = std::move(inPipeOurSide);
+        _outPipe = std::move(outPipeOurSide);
+        if (hr == S_OK)
+        {
+            _conptyProcess = std::move(conptyProcess);
+            resetSharedMemory.release();
+        }
+        return true;
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    winrt::fire_and_forget ConptyConnection::_refillWarmPseudoConsole(const til::size dimensions)
+    {
+        co_await winrt::resume_background();
+
+        wil::unique_hfile inPipe;
+        wil::unique_hfile outPipe;
+        HPCON hPC = nullptr;
+        const auto hr = _CreatePseudoConsoleAndPipes(til::unwrap_coord_size(dimensions), PSEUDOCONSOLE_RESIZE_QUIRK, &inPipe, &outPipe, &hPC);
+        LOG_IF_FAILED(hr);
+
+        auto warm = s_warmPseudoConsole.lock();
+        warm->refilling = false;
 
+        if (SUCCEEDED(hr))
+        {
+            if (warm->hPC)
+            {
+                closePseudoConsoleAsync(warm->hPC);
+            }
+            warm->inPipe = std::move(inPipe);
+            warm->outPipe = std::move(outPipe);
+            warm->hPC = hPC;
+        }
+    }
+
+    // The result of til::env::regenerate(), shared by all connections. See _getRegeneratedEnvironment().
+    struct EnvironmentSnapshot
+    {
+        // Signaled by the registry when one of the keys changes.
+        wil::unique_event changed;
+        std::array<wil::unique_hkey, 3> keys;
+        std::optional<til::env> environment;
+    };
+    static til::shared_mutex<EnvironmentSnapshot> s_environmentSnapshot;
+
+    // Function Description:
+    // - Returns the environment that til::env::regenerate() produces for a freshly logged on user.
+    // - Building it reads several registry keys, which is slow for large environments. We thus keep
+    //   a snapshot and only rebuild it once the registry notifies us that one of the keys changed.
+    //   Such a change precedes every WM_SETTINGCHANGE "Environment" broadcast, but unlike that
+    //   message it doesn't need a window, which the connection doesn't have.
+    static til::env _getRegeneratedEnvironment()
+    {
+        auto snapshot = s_environmentSnapshot.lock();
+
+        if (snapshot->environment && !snapshot->changed.is_signaled())
+        {
+            return *snapshot->environment;
+        }
+
+        if (!snapshot->changed)
+        {
+            snapshot->changed.create(wil::EventOptions::ManualReset);
+        }
+        snapshot->changed.ResetEvent();
+
+        // The notifications are one-shot and get re-armed before the keys are read,
+        // so that a change that happens while we read them isn't missed.
+        const std::array<std::pair<HKEY, wil::zwstring_view>, 3> watched{ {
+            { HKEY_LOCAL_MACHINE, til::details::vars::reg::system_env_var_root },
+            { HKEY_CURRENT_USER, til::details::vars::reg::user_env_var_root },
+            { HKEY_CURRENT_USER, til::details::vars::reg::user_volatile_env_var_root },
+        } };
+        auto armed = true;
+        for (size_t i = 0; i < watched.size(); ++i)
+        {
+            const auto& [root, subkey] = til::at(watched, i);
+            auto& key = til::at(snapshot->keys, i);
+            if (!key && RegOpenKeyExW(root, subkey.c_str(), 0, KEY_NOTIFY, key.put()) != ERROR_SUCCESS)
+            {
+                armed = false;
+                continue;
+            }
+            constexpr DWORD filter = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+            armed = armed && RegNotifyChangeKeyValue(key.get(), TRUE, filter, snapshot->changed.get(), TRUE) == ERROR_SUCCESS;
+        }
+
+        til::env environment;
+        environment.regenerate();
+
+        // If we can't get notified about changes we must not keep the snapshot around.
+        if (armed)
+        {
+            snapshot->environment = environment;
+        }
+        else
+        {
+            snapshot->environment.reset();
+        }
+        return environment;
+    }
+
+    // Function Description:
+    // - Builds the environment block for the client process: the current (or reloaded)
+    //   environment, WT_SESSION, WT_PROFILE_ID, the profile's variables and WSLENV.
+    // - This doesn't depend on the pseudoconsole, which is why Start() runs it
+    //   concurrently with the creation of the pseudoconsole.
+    // Arguments:
+    // - newEnvVars: Receives the environment block, as expected by CreateProcessW.
+    HRESULT ConptyConnection::_BuildEnvironmentBlock(std::vector<wchar_t>& newEnvVars) noexcept
+    try
+    {
         til::env environment;
         auto zeroEnvMap = wil::scope_exit([&]() noexcept {
             environment.clear();
@@ -92,7 +279,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // Populate the environment map with the current environment.
         if (_reloadEnvironmentVariables)
         {
-            environment.regenerate();
+            environment = _getRegeneratedEnvironment();
         }
         else
         {
@@ -148,14 +335,41 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             environment.as_map().insert_or_assign(L"WSLENV", wslEnv);
         }
 
-        std::vector<wchar_t> newEnvVars;
-        auto zeroNewEnv = wil::scope_exit([&]() noexcept {
-            ::SecureZeroMemory(newEnvVars.data(),
-                               newEnvVars.size() * sizeof(decltype(newEnvVars.begin())::value_type));
-        });
-
         RETURN_IF_FAILED(environment.to_environment_strings_w(newEnvVars));
 
+        return S_OK;
+    }
+    CATCH_RETURN();
+
+    // Function Description:
+    // - launches the client application attached to the new pseudoconsole
+    // Arguments:
+    // - newEnvVars: The environment block built by _BuildEnvironmentBlock().
+    HRESULT ConptyConnection::_LaunchAttachedClient(std::vector<wchar_t>& newEnvVars) noexcept
+    try
+    {
+        STARTUPINFOEX siEx{ 0 };
+        siEx.StartupInfo.cb = sizeof(STARTUPINFOEX);
+        siEx.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+        SIZE_T size{};
+        // This call will return an error (by design); we are ignoring it.
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
+#pragma warning(suppress : 26414) // We don't move/touch this smart pointer, but we have to allocate strangely for the adjustable size list.
+        auto attrList{ std::make_unique<std::byte[]>(size) };
+#pragma warning(suppress : 26490) // We have to use reinterpret_cast because we allocated a byte array as a proxy for the adjustable size list.
+        siEx.lpAttributeList = reinterpret_cast<PPROC_THREAD_ATTRIBUTE_LIST>(attrList.get());
+        RETURN_IF_WIN32_BOOL_FALSE(InitializeProcThreadAttributeList(siEx.lpAttributeList, 1, 0, &size));
+
+        RETURN_IF_WIN32_BOOL_FALSE(UpdateProcThreadAttribute(siEx.lpAttributeList,
+                                                             0,
+                                                             PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE,
+                                                             _hPC.get(),
+                                                             sizeof(HPCON),
+                                                             nullptr,
+                                                             nullptr));
+
+        auto cmdline{ wil::ExpandEnvironmentStringsW<std::wstring>(_commandline.c_str()) }; // mutable copy -- required for CreateProcessW
+
         auto lpEnvironment = newEnvVars.empty() ? nullptr : newEnvVars.data();
 
         // If we have a startingTitle, create a mutable character buffer to add
@@ -283,6 +497,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _passthroughMode = winrt::unbox_value_or<bool>(settings.TryLookup(L"passthroughMode").try_as<Windows::Foundation::IPropertyValue>(), _passthroughMode);
             }
             _inheritCursor = winrt::unbox_value_or<bool>(settings.TryLookup(L"inheritCursor").try_as<Windows::Foundation::IPropertyValue>(), _inheritCursor);
+            _coalesceOutputReads = winrt::unbox_value_or<bool>(settings.TryLookup(L"coalesceOutputReads").try_as<Windows::Foundation::IPropertyValue>(), _coalesceOutputReads);
             _reloadEnvironmentVariables = winrt::unbox_value_or<bool>(settings.TryLookup(L"reloadEnvironmentVariables").try_as<Windows::Foundation::IPropertyValue>(),
                                                                       _reloadEnvironmentVariables);
             _profileGuid = winrt::unbox_value_or<winrt::guid>(settings.TryLookup(L"profileGuid").try_as<Windows::Foundation::IPropertyValue>(), _profileGuid);
@@ -317,6 +532,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     void ConptyConnection::Start()
     try
     {
+        ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalConnectionProvider, "ConptyStartBegin");
         _transitionToState(ConnectionState::Connecting);
 
         const til::size dimensions{ gsl::narrow<til::CoordType>(_cols), gsl::narrow<til::CoordType>(_rows) };
@@ -325,6 +541,18 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // handoff from an already-started PTY process.
         if (!_inPipe)
         {
+            // Building the environment block may involve reloading it from the registry. Since it doesn't
+            // depend on the pseudoconsole, it's done while CreatePseudoConsole() waits for OpenConsole to start.
+            // The future is declared after the vector, so that an exception can't destroy the vector while it's in use.
+            std::vector<wchar_t> newEnvVars;
+            auto zeroNewEnv = wil::scope_exit([&]() noexcept {
+                ::SecureZeroMemory(newEnvVars.data(),
+                                   newEnvVars.size() * sizeof(decltype(newEnvVars.begin())::value_type));
+            });
+            auto environment = std::async(std::launch::async, [&]() {
+                return _BuildEnvironmentBlock(newEnvVars);
+            });
+
             DWORD flags = PSEUDOCONSOLE_RESIZE_QUIRK;
 
             // If we're using an existing buffer, we want the new connection
@@ -345,7 +573,24 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 }
             }
 
-            THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(til::unwrap_coord_size(dimensions), flags, &_inPipe, &_outPipe, &_hPC));
+            auto created = false;
+            if constexpr (Feature_ConptySharedMemory::IsEnabled())
+            {
+                created = _createPseudoConsoleWithSharedMemory(dimensions, flags);
+            }
+
+            if constexpr (Feature_ConptyWarmPool::IsEnabled())
+            {
+                if (!created && flags == PSEUDOCONSOLE_RESIZE_QUIRK)
+                {
+                    created = _takeWarmPseudoConsole(dimensions, &_inPipe, &_outPipe, &_hPC);
+                }
+            }
+
+            if (!created)
+            {
+                THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(til::unwrap_coord_size(dimensions), flags, &_inPipe, &_outPipe, &_hPC));
+            }
 
             if (_initialParentHwnd != 0)
             {
@@ -358,7 +603,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 THROW_IF_FAILED(ConptyShowHidePseudoConsole(_hPC.get(), _initialVisibility));
             }
 
-            THROW_IF_FAILED(_LaunchAttachedClient());
+            THROW_IF_FAILED(environment.get());
+            THROW_IF_FAILED(_LaunchAttachedClient(newEnvVars));
         }
         // But if it was an inbound handoff... attempt to synchronize the size of it with what our connection
         // window is expecting it to be on the first layout.
@@ -409,7 +655,29 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"ConptyConnection Output Thread"));
 
+        // Writing into the input pipe blocks once it's full. Since input may be broadcast to many
+        // panes at once, a single stuck client shouldn't hold up the UI thread and thus all the others.
+        _hInputThread.reset(CreateThread(
+            nullptr,
+            0,
+            [](LPVOID lpParameter) noexcept {
+                const auto pInstance = static_cast<ConptyConnection*>(lpParameter);
+                if (pInstance)
+                {
+                    return pInstance->_InputThread();
+                }
+                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+            },
+            this,
+            0,
+            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hInputThread);
+
+        LOG_IF_FAILED(SetThreadDescription(_hInputThread.get(), L"ConptyConnection Input Thread"));
+
         _transitionToState(ConnectionState::Connected);
+        ::Microsoft::Console::StartupTimeline::Mark(g_hTerminalConnectionProvider, "ConptyStartEnd");
     }
     catch (...)
     {
@@ -479,10 +747,82 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             return;
         }
 
+        // A lone Ctrl+C is sent through the signal pipe instead, so that it isn't
+        // stuck behind earlier input while a runaway client floods the output.
+        // If the conpty can't handle it that way, it goes through the input pipe as usual.
+        if (data == L"\x03" && SUCCEEDED(ConptyInterruptPseudoConsole(_hPC.get())))
+        {
+            return;
+        }
+
         // convert from UTF-16LE to UTF-8 as ConPty expects UTF-8
         // TODO GH#3378 reconcile and unify UTF-8 converters
-        auto str = winrt::to_string(data);
-        LOG_IF_WIN32_BOOL_FALSE(WriteFile(_inPipe.get(), str.c_str(), (DWORD)str.length(), nullptr, nullptr));
+        const auto str = winrt::to_string(data);
+
+        {
+            const std::lock_guard lock{ _inputMutex };
+            _inputQueue.append(str);
+        }
+        _inputEvent.notify_one();
+    }
+
+    // Method Description:
+    // - The body of _hInputThread. Waits for WriteInput() to queue up input and writes it to
+    //   ConPTY. Any input queued while a previous write was blocked is written out in one go.
+    // Return Value:
+    // - 0 once the connection has been closed.
+    DWORD ConptyConnection::_InputThread()
+    {
+        std::string str;
+
+        for (;;)
+        {
+            {
+                std::unique_lock lock{ _inputMutex };
+                _inputEvent.wait(lock, [&]() { return _inputClosed || !_inputQueue.empty(); });
+                if (_inputClosed)
+                {
+                    return 0;
+                }
+                // Swapping the buffers retains the capacity of both and avoids allocations.
+                str.clear();
+                _inputQueue.swap(str);
+            }
+
+            _WriteInputToConpty(str);
+        }
+    }
+
+    // Method Description:
+    // - Writes the given UTF-8 input to ConPTY, which blocks while it's not reading its input.
+    void ConptyConnection::_WriteInputToConpty(std::string_view str) noexcept
+    {
+        if (_sharedMemory)
+        {
+            // Just like writing into a full pipe, this blocks until OpenConsole made room for the input.
+            // The input is dropped if OpenConsole exits (or we're closed) in the meantime.
+            const auto& input = _sharedMemory->Input();
+            const std::array<HANDLE, 2> handles{ input.DrainedEvent(), _conptyProcess.get() };
+            auto remaining = str;
+
+            while (!remaining.empty())
+            {
+                const auto written = input.TryWrite(remaining);
+                remaining = remaining.substr(written);
+
+                if (written == 0)
+                {
+                    if (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE) != WAIT_OBJECT_0 ||
+                        !_isConnected())
+                    {
+                        return;
+                    }
+                }
+            }
+            return;
+        }
+
+        LOG_IF_WIN32_BOOL_FALSE(WriteFile(_inPipe.get(), str.data(), gsl::narrow_cast<DWORD>(str.size()), nullptr, nullptr));
     }
 
     void ConptyConnection::Resize(uint32_t rows, uint32_t columns)
@@ -541,11 +881,42 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     {
         _transitionToState(ConnectionState::Closing);
 
+        // This wakes up the output thread and OpenConsole, in case either is waiting on the other.
+        if (_sharedMemory)
+        {
+            _sharedMemory->Close();
+        }
+
         // .reset()ing either of these two will signal ConPTY to send out a CTRL_CLOSE_EVENT to all attached clients.
         // FYI: The other members of this class are concurrently read by the _hOutputThread
         // thread running in the background and so they're not safe to be .reset().
         _hPC.reset();
+
+        if (_hInputThread)
+        {
+            {
+                const std::lock_guard lock{ _inputMutex };
+                _inputClosed = true;
+            }
+            _inputEvent.notify_one();
+
+            // Just like with the output thread below, this aborts a WriteFile() that's stuck on a full pipe.
+            for (;;)
+            {
+                CancelSynchronousIo(_hInputThread.get());
+
+                const auto result = WaitForSingleObject(_hInputThread.get(), 1000);
+                if (result == WAIT_OBJECT_0)
+                {
+                    break;
+                }
+
+                LOG_LAST_ERROR();
+            }
+        }
+
         _inPipe.reset();
+        _hInputThread.reset();
 
         if (_hOutputThread)
         {
@@ -577,6 +948,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         _outPipe.reset();
         _hOutputThread.reset();
         _piClient.reset();
+        _conptyProcess.reset();
 
         _transitionToState(ConnectionState::Closed);
     }
@@ -620,13 +992,49 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // won't wait for us, and the known exit points _do_.
         auto strongThis{ get_strong() };
 
+        if (_sharedMemory)
+        {
+            return _sharedMemoryOutputThread();
+        }
+
+        _buffer.resize(OutputReadSize);
+        size_t smallReads = 0;
+
         // process the data of the output pipe in a loop
         while (true)
         {
             DWORD read{};
 
+            // This region includes the time spent waiting for the application to produce output.
+            TIL_TRACE_REGION_EVENT(g_hTerminalConnectionProvider, "PipeRead", WINEVENT_OPCODE_START);
             const auto readFail{ !ReadFile(_outPipe.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &read, nullptr) };
 
+            // If the application is producing output faster than we can consume it, there's usually more
+            // output waiting in the pipe by the time ReadFile() returns. Draining it now means that it'll
+            // be passed to TerminalOutput in one go, which in turn means one acquisition of the terminal's
+            // write lock (and one render notification) instead of many, and less contention with the renderer.
+            // Errors are left for the next iteration's ReadFile() to report, so that we don't drop what we've read so far.
+            if (_coalesceOutputReads && !readFail)
+            {
+                while (read < _buffer.size())
+                {
+                    DWORD available{};
+                    if (!PeekNamedPipe(_outPipe.get(), nullptr, 0, nullptr, &available, nullptr) || !available)
+                    {
+                        break;
+                    }
+
+                    DWORD more{};
+                    const auto remaining = gsl::narrow_cast<DWORD>(_buffer.size() - read);
+                    if (!ReadFile(_outPipe.get(), _buffer.data() + read, std::min(available, remaining), &more, nullptr))
+                    {
+                        break;
+                    }
+                    read += more;
+                }
+            }
+            TIL_TRACE_REGION_EVENT(g_hTerminalConnectionProvider, "PipeRead", WINEVENT_OPCODE_STOP);
+
             // When we call CancelSynchronousIo() in Close() this is the branch that's taken and gets us out of here.
             if (_isStateAtOrBeyond(ConnectionState::Closing))
             {
@@ -650,7 +1058,9 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 }
             }
 
+            TIL_TRACE_REGION_EVENT(g_hTerminalConnectionProvider, "Utf8Decode", WINEVENT_OPCODE_START);
             const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
+            TIL_TRACE_REGION_EVENT(g_hTerminalConnectionProvider, "Utf8Decode", WINEVENT_OPCODE_STOP);
             if (FAILED(result))
             {
                 // EXIT POINT
@@ -682,13 +1092,105 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
             // Pass the output to our registered event handlers
             _TerminalOutputHandlers(_u16Str);
+
+            // Adapt the read size to the rate at which output arrives: If a read filled the entire
+            // buffer, there's likely more output pending, so we double the read size. If we
+            // repeatedly get far less than that, the burst is over and we give the memory back.
+            if (read == _buffer.size())
+            {
+                if (_buffer.size() < OutputReadSizeMax)
+                {
+                    _buffer.resize(_buffer.size() * 2);
+                }
+                smallReads = 0;
+            }
+            else if (read >= _buffer.size() / 8)
+            {
+                smallReads = 0;
+            }
+            else if (_buffer.size() > OutputReadSize && ++smallReads >= 16)
+            {
+                _buffer.resize(_buffer.size() / 2);
+                _buffer.shrink_to_fit();
+                smallReads = 0;
+            }
         }
 
         return 0;
     }
 
+    // Method Description:
+    // - The output thread for Feature_ConptySharedMemory: Instead of reading
+    //   the output pipe, it reads the output ring of the VtSharedMemory section.
+    //   The ring has no broken pipe, so we wait for OpenConsole to exit instead.
+    DWORD ConptyConnection::_sharedMemoryOutputThread()
+    {
+        _buffer.resize(OutputReadSizeMax);
+        const auto& output = _sharedMemory->Output();
+        const std::array<HANDLE, 2> handles{ output.WrittenEvent(), _conptyProcess.get() };
+        auto conptyExited = false;
+
+        while (true)
+        {
+            const auto read = output.TryRead(_buffer);
+
+            // Close() sets the output's WrittenEvent(), which is the branch that gets us out of here.
+            if (_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                return 0;
+            }
+
+            if (read == 0)
+            {
+                // OpenConsole may have written more before it exited, which is why we only
+                // leave once a read after noticing its exit comes up empty.
+                if (conptyExited)
+                {
+                    // EXIT POINT
+                    _LastConPtyClientDisconnected();
+                    return 0;
+                }
+
+                const auto wait = WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+                if (wait == WAIT_OBJECT_0 + 1)
+                {
+                    conptyExited = true;
+                }
+                else if (wait != WAIT_OBJECT_0)
+                {
+                    // EXIT POINT
+                    const auto lastError = GetLastError();
+                    _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
+                    _transitionToState(ConnectionState::Failed);
+                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
+                }
+                continue;
+            }
+
+            const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
+            if (FAILED(result))
+            {
+                // EXIT POINT
+                _indicateExitWithStatus(result); // print a message
+                _transitionToState(ConnectionState::Failed);
+                return gsl::narrow_cast<DWORD>(result);
+            }
+
+            if (!_u16Str.empty())
+            {
+                // Pass the output to our registered event handlers
+                _TerminalOutputHandlers(_u16Str);
+            }
+        }
+    }
+
     static winrt::event<NewConnectionHandler> _newConnectionHandlers;
 
+    // Handoffs received by the persistent listener, which are waiting for a tab to be created for them.
+    static std::mutex _pendingConnectionsMutex;
+    static std::deque<TerminalConnection::ConptyConnection> _pendingConnections;
+    static PendingConnectionHandler _pendingConnectionHandler{ nullptr };
+
     winrt::event_token ConptyConnection::NewConnection(const NewConnectionHandler& handler) { return _newConnectionHandlers.add(handler); };
     void ConptyConnection::NewConnection(const winrt::event_token& token) { _newConnectionHandlers.remove(token); };
 
@@ -706,11 +1208,58 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     }
     CATCH_RETURN()
 
+    // Unlike NewHandoff(), this doesn't wait for a tab to be created for the connection. It returns to the console host
+    // right away and the handler of StartPersistentInboundListener() arranges for StartInboundListener() to be called.
+    HRESULT ConptyConnection::NewPersistentHandoff(HANDLE in, HANDLE out, HANDLE signal, HANDLE ref, HANDLE server, HANDLE client, TERMINAL_STARTUP_INFO startupInfo) noexcept
+    try
+    {
+        {
+            std::lock_guard lock{ _pendingConnectionsMutex };
+            _pendingConnections.emplace_back(winrt::make<ConptyConnection>(signal, in, out, ref, server, client, startupInfo));
+        }
+
+        _pendingConnectionHandler();
+        return S_OK;
+    }
+    CATCH_RETURN()
+
     void ConptyConnection::StartInboundListener()
     {
+        // Once the persistent listener is up, handoffs don't wait for someone to listen for them.
+        // Instead, they're queued up and handed to the NewConnection handlers one by one.
+        if (CTerminalHandoff::s_IsListeningPersistently())
+        {
+            TerminalConnection::ConptyConnection connection{ nullptr };
+            {
+                std::lock_guard lock{ _pendingConnectionsMutex };
+                if (_pendingConnections.empty())
+                {
+                    return;
+                }
+                connection = std::move(_pendingConnections.front());
+                _pendingConnections.pop_front();
+            }
+
+            _newConnectionHandlers(connection);
+            return;
+        }
+
         THROW_IF_FAILED(CTerminalHandoff::s_StartListening(&ConptyConnection::NewHandoff));
     }
 
+    // Function Description:
+    // - Keeps receiving handoffs for the remaining lifetime of the process, so that COM doesn't have to
+    //   launch a new Terminal for each console application. The handler is called on a COM thread for each
+    //   handoff and should result in a call to StartInboundListener(), which hands out the connection.
+    // Arguments:
+    // - afterNextHandoff: Set if COM started this process for a handoff. That one is first received as usual.
+    // - handler: Called whenever a connection is waiting for StartInboundListener().
+    void ConptyConnection::StartPersistentInboundListener(const bool afterNextHandoff, const PendingConnectionHandler& handler)
+    {
+        _pendingConnectionHandler = handler;
+        THROW_IF_FAILED(CTerminalHandoff::s_StartListeningPersistently(&ConptyConnection::NewPersistentHandoff, afterNextHandoff));
+    }
+
     void ConptyConnection::StopInboundListener()
     {
         THROW_IF_FAILED(CTerminalHandoff::s_StopListening());
@@ -8,6 +8,10 @@
 
 #include "ITerminalHandoff.h"
 
+#include <VtSharedMemory.h>
+
+#include <condition_variable>
+
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
     struct ConptyConnection : ConptyConnectionT<ConptyConnection>, ConnectionStateHolder<ConptyConnection>
@@ -42,6 +46,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         static void StartInboundListener();
         static void StopInboundListener();
+        static void StartPersistentInboundListener(bool afterNextHandoff, const PendingConnectionHandler& handler);
 
         static winrt::event_token NewConnection(const NewConnectionHandler& handler);
         static void NewConnection(const winrt::event_token& token);
@@ -57,12 +62,24 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
 
+        // The size of the chunks the output thread reads from conpty. Larger reads mean fewer
+        // UTF-8 conversions and TerminalOutput events (each of which acquires the terminal lock)
+        // when an application produces a lot of output. The read size grows up
+        // to OutputReadSizeMax while the output pipe keeps filling our buffer.
+        static constexpr size_t OutputReadSize = 64 * 1024;
+        static constexpr size_t OutputReadSizeMax = 1024 * 1024;
+
     private:
         static void closePseudoConsoleAsync(HPCON hPC) noexcept;
         static HRESULT NewHandoff(HANDLE in, HANDLE out, HANDLE signal, HANDLE ref, HANDLE server, HANDLE client, TERMINAL_STARTUP_INFO startupInfo) noexcept;
+        static HRESULT NewPersistentHandoff(HANDLE in, HANDLE out, HANDLE signal, HANDLE ref, HANDLE server, HANDLE client, TERMINAL_STARTUP_INFO startupInfo) noexcept;
         static winrt::hstring _commandlineFromProcess(HANDLE process);
 
-        HRESULT _LaunchAttachedClient() noexcept;
+        static bool _takeWarmPseudoConsole(const til::size dimensions, HANDLE* phInput, HANDLE* phOutput, HPCON* phPC) noexcept;
+        static winrt::fire_and_forget _refillWarmPseudoConsole(const til::size dimensions);
+        bool _createPseudoConsoleWithSharedMemory(const til::size dimensions, const DWORD flags) noexcept;
+        HRESULT _BuildEnvironmentBlock(std::vector<wchar_t>& newEnvVars) noexcept;
+        HRESULT _LaunchAttachedClient(std::vector<wchar_t>& newEnvVars) noexcept;
         void _indicateExitWithStatus(unsigned int status) noexcept;
         void _LastConPtyClientDisconnected() noexcept;
 
@@ -83,12 +100,24 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile _inPipe; // The pipe for writing input to
         wil::unique_hfile _outPipe; // The pipe for reading output from
         wil::unique_handle _hOutputThread;
+        wil::unique_handle _hInputThread;
         wil::unique_process_information _piClient;
         wil::unique_any<HPCON, decltype(closePseudoConsoleAsync), closePseudoConsoleAsync> _hPC;
+        // Feature_ConptySharedMemory: Set if OpenConsole accepted the section. See _createPseudoConsoleWithSharedMemory().
+        std::optional<::Microsoft::Console::VtSharedMemory::Server> _sharedMemory;
+        wil::unique_handle _conptyProcess;
+
+        // The input is handed to _hInputThread, so that a client that doesn't read
+        // its input fast enough doesn't block the UI thread (and other panes).
+        std::string _inputQueue;
+        std::condition_variable _inputEvent;
+        std::mutex _inputMutex;
+        bool _inputClosed{ false };
 
         til::u8state _u8State{};
         std::wstring _u16Str{};
-        std::array<char, 4096> _buffer{};
+        std::vector<char> _buffer;
+        bool _coalesceOutputReads{ true };
         bool _passthroughMode{};
         bool _inheritCursor{ false };
         bool _reloadEnvironmentVariables{};
@@ -104,6 +133,9 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         } _startupInfo{};
 
         DWORD _OutputThread();
+        DWORD _sharedMemoryOutputThread();
+        DWORD _InputThread();
+        void _WriteInputToConpty(std::string_view str) noexcept;
     };
 }
 
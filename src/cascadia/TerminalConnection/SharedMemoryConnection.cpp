@@ -0,0 +1,312 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SharedMemoryConnection.h"
+
+#include <til/env.h>
+
+#include "LibraryResources.h"
+#include "../../types/inc/utils.hpp"
+
+#include "SharedMemoryConnection.g.cpp"
+
+using namespace ::Microsoft::Console;
+using namespace std::string_view_literals;
+
+// Format is: "DecimalResult (HexadecimalForm)"
+static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
+
+static constexpr winrt::guid SharedMemoryConnectionType = { 0x6c3e5a0d, 0x2b7f, 0x4e91, { 0xa4, 0x58, 0x1d, 0x93, 0x0c, 0x7e, 0xb2, 0x4f } };
+
+// Notes:
+// The connection ends when it's Close()d, when Start() fails or when the client process exits.
+// To figure out where we handle these, search for comments containing "EXIT POINT"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    winrt::guid SharedMemoryConnection::ConnectionType() noexcept
+    {
+        return SharedMemoryConnectionType;
+    }
+
+    void SharedMemoryConnection::Initialize(const Windows::Foundation::Collections::ValueSet& settings)
+    {
+        if (settings)
+        {
+            _commandline = winrt::unbox_value_or<winrt::hstring>(settings.TryLookup(L"commandline").try_as<Windows::Foundation::IPropertyValue>(), _commandline);
+            _startingDirectory = winrt::unbox_value_or<winrt::hstring>(settings.TryLookup(L"startingDirectory").try_as<Windows::Foundation::IPropertyValue>(), _startingDirectory);
+            _rows = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialRows").try_as<Windows::Foundation::IPropertyValue>(), _rows);
+            _cols = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialCols").try_as<Windows::Foundation::IPropertyValue>(), _cols);
+            _profileGuid = winrt::unbox_value_or<winrt::guid>(settings.TryLookup(L"profileGuid").try_as<Windows::Foundation::IPropertyValue>(), _profileGuid);
+        }
+    }
+
+    // Function Description:
+    // - Launches the client process and hands it the section (and only that).
+    //   It's created without a console, because it doesn't need one to talk to us.
+    void SharedMemoryConnection::_launchClient()
+    {
+        auto environment = til::env::from_current_environment();
+        environment.as_map().insert_or_assign(VtSharedMemory::EnvironmentVariableName, std::to_wstring(reinterpret_cast<uintptr_t>(_server->Section())));
+        environment.as_map().insert_or_assign(L"WT_PROFILE_ID", Utils::GuidToString(_profileGuid));
+
+        std::vector<wchar_t> newEnvVars;
+        THROW_IF_FAILED(environment.to_environment_strings_w(newEnvVars));
+
+        auto inheritedHandles = _server->Handles();
+
+        STARTUPINFOEX siEx{ 0 };
+        siEx.StartupInfo.cb = sizeof(STARTUPINFOEX);
+        SIZE_T size{};
+        // This call will return an error (by design); we are ignoring it.
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
+#pragma warning(suppress : 26414) // We don't move/touch this smart pointer, but we have to allocate strangely for the adjustable size list.
+        auto attrList{ std::make_unique<std::byte[]>(size) };
+#pragma warning(suppress : 26490) // We have to use reinterpret_cast because we allocated a byte array as a proxy for the adjustable size list.
+        siEx.lpAttributeList = reinterpret_cast<PPROC_THREAD_ATTRIBUTE_LIST>(attrList.get());
+        THROW_IF_WIN32_BOOL_FALSE(InitializeProcThreadAttributeList(siEx.lpAttributeList, 1, 0, &size));
+        const auto deleteAttrList = wil::scope_exit([&]() noexcept {
+            DeleteProcThreadAttributeList(siEx.lpAttributeList);
+        });
+
+        THROW_IF_WIN32_BOOL_FALSE(UpdateProcThreadAttribute(siEx.lpAttributeList,
+                                                            0,
+                                                            PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
+                                                            inheritedHandles.data(),
+                                                            sizeof(inheritedHandles),
+                                                            nullptr,
+                                                            nullptr));
+
+        auto cmdline{ wil::ExpandEnvironmentStringsW<std::wstring>(_commandline.c_str()) }; // mutable copy -- required for CreateProcessW
+        const auto startingDirectory = _startingDirectory.empty() ? nullptr : _startingDirectory.c_str();
+
+        THROW_IF_WIN32_BOOL_FALSE(CreateProcessW(
+            nullptr,
+            cmdline.data(),
+            nullptr, // lpProcessAttributes
+            nullptr, // lpThreadAttributes
+            true, // bInheritHandles, restricted to inheritedHandles by PROC_THREAD_ATTRIBUTE_HANDLE_LIST
+            EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | DETACHED_PROCESS, // dwCreationFlags
+            newEnvVars.data(), // lpEnvironment
+            startingDirectory,
+            &siEx.StartupInfo, // lpStartupInfo
+            &_piClient // lpProcessInformation
+            ));
+    }
+
+    void SharedMemoryConnection::Start()
+    try
+    {
+        _transitionToState(ConnectionState::Connecting);
+
+        // All handles are inheritable, so that _launchClient() can pass them to the client process.
+        _server.emplace(gsl::narrow_cast<uint32_t>(_rows), gsl::narrow_cast<uint32_t>(_cols), true);
+        _launchClient();
+
+        _hOutputThread.reset(CreateThread(
+            nullptr,
+            0,
+            [](LPVOID lpParameter) noexcept {
+                const auto pInstance = static_cast<SharedMemoryConnection*>(lpParameter);
+                if (pInstance)
+                {
+                    return pInstance->_OutputThread();
+                }
+                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+            },
+            this,
+            0,
+            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hOutputThread);
+
+        LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"SharedMemoryConnection Output Thread"));
+
+        _transitionToState(ConnectionState::Connected);
+    }
+    catch (...)
+    {
+        // EXIT POINT
+        const auto hr = wil::ResultFromCaughtException();
+
+        // GH#11556 - make sure to format the error code to this string as an UNSIGNED int
+        winrt::hstring failureText{ fmt::format(std::wstring_view{ RS_(L"ProcessFailedToLaunch") },
+                                                fmt::format(_errorFormat, static_cast<unsigned int>(hr)),
+                                                _commandline) };
+        _TerminalOutputHandlers(failureText);
+
+        _transitionToState(ConnectionState::Failed);
+    }
+
+    // Method Description:
+    // - prints out the "process exited" message formatted with the exit code
+    // Arguments:
+    // - status: the exit code.
+    void SharedMemoryConnection::_indicateExitWithStatus(unsigned int status) noexcept
+    {
+        try
+        {
+            // GH#11556 - make sure to format the error code to this string as an UNSIGNED int
+            winrt::hstring exitText{ fmt::format(std::wstring_view{ RS_(L"ProcessExited") }, fmt::format(_errorFormat, status)) };
+            _TerminalOutputHandlers(L"\r\n");
+            _TerminalOutputHandlers(exitText);
+            _TerminalOutputHandlers(L"\r\n");
+            _TerminalOutputHandlers(RS_(L"CtrlDToClose"));
+            _TerminalOutputHandlers(L"\r\n");
+        }
+        CATCH_LOG();
+    }
+
+    // Method Description:
+    // - called when the client process exited and all of its output has been processed
+    void SharedMemoryConnection::_clientExited() noexcept
+    try
+    {
+        DWORD exitCode{ 0 };
+        GetExitCodeProcess(_piClient.hProcess, &exitCode);
+
+        _transitionToState(exitCode == 0 ? ConnectionState::Closed : ConnectionState::Failed);
+        _indicateExitWithStatus(exitCode);
+    }
+    CATCH_LOG()
+
+    void SharedMemoryConnection::WriteInput(const hstring& data)
+    {
+        if (!_isConnected())
+        {
+            return;
+        }
+
+        // Just like writing into a full pipe, this blocks until the client made room for the input.
+        // The input is dropped if the client exits (or we're closed) in the meantime.
+        const auto str = winrt::to_string(data);
+        std::string_view remaining{ str };
+        const auto& input = _server->Input();
+        const std::array<HANDLE, 2> handles{ input.DrainedEvent(), _piClient.hProcess };
+
+        while (!remaining.empty())
+        {
+            const auto written = input.TryWrite(remaining);
+            remaining = remaining.substr(written);
+
+            if (written == 0)
+            {
+                if (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE) != WAIT_OBJECT_0 ||
+                    !_isConnected())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    void SharedMemoryConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        // Always keep these in case we ever want to disconnect/restart
+        _rows = rows;
+        _cols = columns;
+
+        if (_isConnected())
+        {
+            _server->Resize(rows, columns);
+        }
+    }
+
+    void SharedMemoryConnection::Close() noexcept
+    try
+    {
+        _transitionToState(ConnectionState::Closing);
+
+        if (_server)
+        {
+            _server->Close();
+        }
+
+        if (_hOutputThread)
+        {
+            // Waiting for the output thread to exit ensures that all pending _TerminalOutputHandlers()
+            // calls have returned and won't notify our caller (ControlCore) anymore. This ensures that
+            // we don't call a destroyed event handler asynchronously from a background thread (GH#13880).
+            WaitForSingleObject(_hOutputThread.get(), INFINITE);
+        }
+
+        // Now that the background thread is done, we can safely clean up the other system objects.
+        _hOutputThread.reset();
+        _piClient.reset();
+
+        _transitionToState(ConnectionState::Closed);
+    }
+    CATCH_LOG()
+
+    DWORD SharedMemoryConnection::_OutputThread()
+    {
+        // Keep us alive until the output thread terminates; the destructor
+        // won't wait for us, and the known exit points _do_.
+        auto strongThis{ get_strong() };
+
+        _buffer.resize(OutputReadSize);
+        const auto& output = _server->Output();
+        const std::array<HANDLE, 2> handles{ output.WrittenEvent(), _piClient.hProcess };
+        auto clientExited = false;
+
+        while (true)
+        {
+            const auto read = output.TryRead(_buffer);
+
+            // Close() sets the output's WrittenEvent(), which is the branch that gets us out of here.
+            if (_isStateAtOrBeyond(ConnectionState::Closing))
+            {
+                return 0;
+            }
+
+            if (read == 0)
+            {
+                // The client may have written more before it exited, which is why we only
+                // leave once a read after noticing its exit comes up empty.
+                if (clientExited)
+                {
+                    // EXIT POINT
+                    _clientExited();
+                    return 0;
+                }
+
+                const auto wait = WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+                if (wait == WAIT_OBJECT_0 + 1)
+                {
+                    clientExited = true;
+                }
+                else if (wait != WAIT_OBJECT_0)
+                {
+                    // EXIT POINT
+                    const auto lastError = GetLastError();
+                    _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
+                    _transitionToState(ConnectionState::Failed);
+                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
+                }
+                continue;
+            }
+
+            const auto result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
+            if (FAILED(result))
+            {
+                // EXIT POINT
+                _indicateExitWithStatus(result); // print a message
+                _transitionToState(ConnectionState::Failed);
+                return gsl::narrow_cast<DWORD>(result);
+            }
+
+            if (!_u16Str.empty())
+            {
+                // Pass the output to our registered event handlers
+                _TerminalOutputHandlers(_u16Str);
+            }
+        }
+    }
+
+    winrt::fire_and_forget SharedMemoryConnection::final_release(std::unique_ptr<SharedMemoryConnection> connection)
+    {
+        co_await winrt::resume_background(); // move to background
+        connection.reset(); // explicitly destruct
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "SharedMemoryConnection.g.h"
+#include "ConnectionStateHolder.h"
+
+#include <VtSharedMemory.h>
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // A connection for programs that produce VT natively. Instead of going through conpty, the client
+    // process writes UTF-8 encoded VT straight into a ring buffer in a section shared with us and reads
+    // its input from another one. See VtSharedMemory.h for the protocol and the client side of it.
+    struct SharedMemoryConnection : SharedMemoryConnectionT<SharedMemoryConnection>, ConnectionStateHolder<SharedMemoryConnection>
+    {
+        SharedMemoryConnection() noexcept = default;
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        static winrt::guid ConnectionType() noexcept;
+        static winrt::fire_and_forget final_release(std::unique_ptr<SharedMemoryConnection> connection);
+
+        void Start();
+        void WriteInput(const hstring& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close() noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+
+        // The size of the chunks the output thread reads from the output ring at once.
+        static constexpr size_t OutputReadSize = 64 * 1024;
+
+    private:
+        void _launchClient();
+        void _indicateExitWithStatus(unsigned int status) noexcept;
+        void _clientExited() noexcept;
+        DWORD _OutputThread();
+
+        til::CoordType _rows{};
+        til::CoordType _cols{};
+        hstring _commandline{};
+        hstring _startingDirectory{};
+        guid _profileGuid{};
+
+        std::optional<::Microsoft::Console::VtSharedMemory::Server> _server;
+
+        wil::unique_handle _hOutputThread;
+        wil::unique_process_information _piClient;
+
+        til::u8state _u8State{};
+        std::wstring _u16Str{};
+        std::vector<char> _buffer;
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(SharedMemoryConnection);
+}
@@ -16,6 +16,7 @@
 #include "EventArgs.h"
 #include "../../types/inc/GlyphWidth.hpp"
 #include "../../buffer/out/search.h"
+#include "../../buffer/out/BufferSnapshot.hpp"
 #include "../../renderer/atlas/AtlasEngine.h"
 #include "../../renderer/dx/DxRenderer.hpp"
 
@@ -39,8 +40,29 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// The minimum delay between writing the rows that scrolled out of the viewport to the buffer snapshot.
+constexpr const auto BufferSnapshotInterval = std::chrono::seconds(2);
+
+// How long the control needs to be hidden before the memory of its buffer and renderer gets trimmed.
+constexpr const auto TrimMemoryDelay = std::chrono::seconds(30);
+
+// The interval at which the memory usage of all controls is traced and checked against the memory budget.
+constexpr const auto MemoryAccountingInterval = std::chrono::seconds(10);
+
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
+    // The ControlCores of this process, for ControlCore::_memoryAccountingTick(). This is intentionally
+    // leaked, because closing the timer during DLL unload would wait for its callback to finish.
+    struct MemoryAccounting
+    {
+        std::vector<ControlCore*> cores;
+        PTP_TIMER timer = nullptr;
+    };
+    static til::shared_mutex<MemoryAccounting>& s_memoryAccounting = *new til::shared_mutex<MemoryAccounting>();
+    // The "experimental.memoryBudget" in bytes. It's a global setting and so every control stores the same value.
+    // This isn't part of s_memoryAccounting, because UpdateSettings() holds the terminal lock, which the tick acquires after it.
+    static std::atomic<size_t> s_memoryBudget{ 0 };
+
     static winrt::Microsoft::Terminal::Core::OptionalColor OptionalFromColor(const til::color& c)
     {
         Core::OptionalColor result;
@@ -122,6 +144,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         auto pfnCompletionsChanged = [=](auto&& menuJson, auto&& replaceLength) { _terminalCompletionsChanged(menuJson, replaceLength); };
         _terminal->CompletionsChangedCallback(pfnCompletionsChanged);
 
+        _registerMemoryAccounting(this);
+
         // MSFT 33353327: Initialize the renderer in the ctor instead of Initialize().
         // We need the renderer to be ready to accept new engines before the SwapChainPanel is ready to go.
         // If we wait, a screen reader may try to get the AutomationPeer (aka the UIA Engine), and we won't be able to attach
@@ -142,6 +166,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _renderer->SetBackgroundColorChangedCallback([this]() { _rendererBackgroundColorChanged(); });
             _renderer->SetFrameColorChangedCallback([this]() { _rendererTabColorChanged(); });
             _renderer->SetRendererEnteredErrorStateCallback([this]() { _RendererEnteredErrorStateHandlers(nullptr, nullptr); });
+            _renderer->SetFramePresentedCallback([this]() { _rendererFramePresented(); });
 
             THROW_IF_FAILED(localPointerToThread->Initialize(_renderer.get()));
         }
@@ -176,6 +201,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         //   need to hop across the process boundary every time text is output.
         //   We can throttle this to once every 8ms, which will get us out of
         //   the way of the main output & rendering threads.
+        // * _trimMemory: Not a throttle as such. It's used as a timer that fires
+        //   a while after the control got hidden. See _updateRenderingSuspended().
         const auto shared = _shared.lock();
         shared->tsfTryRedrawCanvas = std::make_shared<ThrottledFuncTrailing<>>(
             _dispatcher,
@@ -199,19 +226,64 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
-        shared->updateScrollBar = std::make_shared<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>>(
+        // Same as above, this runs on a background thread so that writing
+        // the snapshot to disk doesn't hold up the UI, or the terminal lock.
+        shared->captureBufferSnapshot = std::make_unique<til::throttled_func_trailing<>>(
+            BufferSnapshotInterval,
+            [weakTerminal = std::weak_ptr{ _terminal }, weakSnapshot = std::weak_ptr{ _bufferSnapshot }]() {
+                const auto t = weakTerminal.lock();
+                const auto s = weakSnapshot.lock();
+                if (!t || !s)
+                {
+                    return;
+                }
+
+                const auto snapshot = s->lock();
+                if (!*snapshot)
+                {
+                    return;
+                }
+
+                {
+                    const auto lock = t->LockForReading();
+                    t->CaptureBufferSnapshot(**snapshot, false);
+                }
+
+                try
+                {
+                    (*snapshot)->Flush();
+                }
+                CATCH_LOG();
+            });
+
+        // The arguments are stored as plain integers and only turned into a WinRT object once
+        // per throttled invocation, as the scroll position changes with every line of output.
+        shared->updateScrollBar = std::make_shared<ThrottledFuncTrailing<int, int, int>>(
             _dispatcher,
             ScrollBarUpdateInterval,
-            [weakThis = get_weak()](const auto& update) {
+            [weakThis = get_weak()](const int viewTop, const int viewHeight, const int bufferSize) {
                 if (auto core{ weakThis.get() }; !core->_IsClosing())
                 {
-                    core->_ScrollPositionChangedHandlers(*core, update);
+                    core->_ScrollPositionChangedHandlers(*core, winrt::make<ScrollPositionChangedArgs>(viewTop, viewHeight, bufferSize));
+                }
+            });
+
+        shared->trimMemory = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            TrimMemoryDelay,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_trimMemory();
                 }
             });
     }
 
     ControlCore::~ControlCore()
     {
+        // This must happen first, as _memoryAccountingTick() may be accessing us right now.
+        _unregisterMemoryAccounting(this);
+
         Close();
 
         if (_renderer)
@@ -233,6 +305,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         shared->tsfTryRedrawCanvas.reset();
         shared->updatePatternLocations.reset();
         shared->updateScrollBar.reset();
+        shared->captureBufferSnapshot.reset();
+        shared->trimMemory.reset();
     }
 
     void ControlCore::AttachToNewControl(const Microsoft::Terminal::Control::IKeyBindings& keyBindings)
@@ -376,6 +450,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             _terminal->CreateFromSettings(*_settings, *_renderer);
 
+            if (!_bufferSnapshotPath.empty())
+            {
+                _startBufferSnapshotsUnderLock();
+            }
+
             // IMPORTANT! Set this callback up sooner than later. If we do it
             // after Enable, then it'll be possible to paint the frame once
             // _before_ the warning handler is set up, and then warnings from
@@ -393,6 +472,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _renderEngine->SetPixelShaderPath(_settings->PixelShaderPath());
             _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
             _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+            _renderEngine->SetPixelShaderPartialRedraw(_settings->PixelShaderPartialRedraw());
+            _renderEngine->SetPixelShaderMaxFrameRate(_settings->PixelShaderMaxFrameRate());
 
             _updateAntiAliasingMode();
 
@@ -402,6 +483,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             THROW_IF_FAILED(_renderEngine->Enable());
 
+            _updateCursorPositionUnderLock();
             _initializedTerminal.store(true, std::memory_order_relaxed);
         } // scope for TerminalLock
 
@@ -422,7 +504,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - <none>
     void ControlCore::EnablePainting()
     {
-        if (_initializedTerminal.load(std::memory_order_relaxed))
+        if (_initializedTerminal.load(std::memory_order_relaxed) && !_renderingSuspended)
         {
             _renderer->EnablePainting();
         }
@@ -486,6 +568,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _handleControlC();
         }
 
+        _recordLatencyInput();
         return _terminal->SendCharEvent(ch, scanCode, modifiers);
     }
 
@@ -630,6 +713,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // If the terminal translated the key, mark the event as handled.
         // This will prevent the system from trying to get the character out
         // of it and sending us a CharacterReceived event.
+        if (vkey && keyDown)
+        {
+            _recordLatencyInput();
+        }
         return vkey ? _terminal->SendKeyEvent(vkey,
                                               scanCode,
                                               modifiers,
@@ -804,12 +891,45 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _lastHoveredCell.has_value() ? Windows::Foundation::IReference<Core::Point>{ _lastHoveredCell.value().to_core_point() } : nullptr;
     }
 
+    template<typename T>
+    static bool mapsEqual(const T& a, const T& b)
+    {
+        if (!a || !b)
+        {
+            return !a && !b;
+        }
+        if (a.Size() != b.Size())
+        {
+            return false;
+        }
+        for (const auto& [key, value] : a)
+        {
+            if (!b.HasKey(key) || b.Lookup(key) != value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns true if the two settings result in the same font for _setFontSizeUnderLock().
+    static bool fontSettingsEqual(const ControlSettings& a, const ControlSettings& b)
+    {
+        return a.FontFace() == b.FontFace() &&
+               a.FontSize() == b.FontSize() &&
+               a.FontWeight().Weight == b.FontWeight().Weight &&
+               a.CellWidth() == b.CellWidth() &&
+               a.CellHeight() == b.CellHeight() &&
+               mapsEqual(a.FontFeatures(), b.FontFeatures()) &&
+               mapsEqual(a.FontAxes(), b.FontAxes());
+    }
+
     // Method Description:
     // - Updates the settings of the current terminal.
     // - INVARIANT: This method can only be called if the caller DOES NOT HAVE writing lock on the terminal.
     void ControlCore::UpdateSettings(const IControlSettings& settings, const IControlAppearance& newAppearance)
     {
-        _settings = winrt::make_self<implementation::ControlSettings>(settings, newAppearance);
+        const auto oldSettings = std::exchange(_settings, winrt::make_self<implementation::ControlSettings>(settings, newAppearance));
 
         auto lock = _terminal->LockForWriting();
 
@@ -820,10 +940,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // Manually turn off acrylic if they turn off transparency.
         _runtimeUseAcrylic = _settings->Opacity() < 1.0 && _settings->UseAcrylic();
 
-        const auto sizeChanged = _setFontSizeUnderLock(_settings->FontSize());
+        // A settings reload updates every pane, but usually none of them has a different font.
+        // Reloading the font means rebuilding the renderer's glyph cache, so we avoid it if we can.
+        // A changed _desiredFont size is still reset, as that's the result of zooming the font.
+        const auto fontChanged = !oldSettings ||
+                                 !fontSettingsEqual(*oldSettings, *_settings) ||
+                                 _desiredFont.GetFontSize() != std::max(_settings->FontSize(), 1.0f);
+        const auto sizeChanged = fontChanged && _setFontSizeUnderLock(_settings->FontSize());
 
         // Update the terminal core with its new Core settings
+        TextBuffer::SetLargePagesEnabled(_settings->LargePageBuffers());
         _terminal->UpdateSettings(*_settings);
+        s_memoryBudget.store(gsl::narrow_cast<size_t>(std::max(0, _settings->MemoryBudget())) * 1024 * 1024, std::memory_order_relaxed);
 
         if (!_initializedTerminal.load(std::memory_order_relaxed))
         {
@@ -834,6 +962,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
         _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+        _renderEngine->SetPixelShaderPartialRedraw(_settings->PixelShaderPartialRedraw());
+        _renderEngine->SetPixelShaderMaxFrameRate(_settings->PixelShaderMaxFrameRate());
         // Inform the renderer of our opacity
         _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
 
@@ -1048,6 +1178,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             _connection.Resize(vp.Height(), vp.Width());
         }
+        _updateCursorPositionUnderLock();
     }
 
     void ControlCore::SizeChanged(const float width,
@@ -1170,41 +1301,56 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // extract text from buffer
         // RetrieveSelectedTextFromBuffer will lock while it's reading
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
+        // The snapshot is shared with the HTML/RTF generators below, which may run later.
+        const auto bufferData = std::make_shared<const TextBuffer::TextAndColor>(_terminal->RetrieveSelectedTextFromBuffer(singleLine));
 
         // convert text: vector<string> --> string
+        size_t textLength = 0;
+        for (const auto& text : bufferData->text)
+        {
+            textLength += text.size();
+        }
+
         std::wstring textData;
-        for (const auto& text : bufferData.text)
+        textData.reserve(textLength);
+        for (const auto& text : bufferData->text)
         {
             textData += text;
         }
 
         const auto bgColor = _terminal->GetAttributeColors({}).second;
+        const auto fontHeight = _actualFont.GetUnscaledSize().height;
+        const auto fontFaceName = std::wstring{ _actualFont.GetFaceName() };
+
+        // The rich formats are only generated if the consumer of the event actually asks for
+        // them, since copying into a plain-text editor is by far the most common case.
+        std::function<winrt::hstring()> htmlGenerator;
+        std::function<winrt::hstring()> rtfGenerator;
 
         // convert text to HTML format
         // GH#5347 - Don't provide a title for the generated HTML, as many
         // web applications will paste the title first, followed by the HTML
         // content, which is unexpected.
-        const auto htmlData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML) ?
-                                  TextBuffer::GenHTML(bufferData,
-                                                      _actualFont.GetUnscaledSize().height,
-                                                      _actualFont.GetFaceName(),
-                                                      bgColor) :
-                                  "";
+        if (formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML))
+        {
+            htmlGenerator = [=]() {
+                return winrt::to_hstring(TextBuffer::GenHTML(*bufferData, fontHeight, fontFaceName, bgColor));
+            };
+        }
 
         // convert to RTF format
-        const auto rtfData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF) ?
-                                 TextBuffer::GenRTF(bufferData,
-                                                    _actualFont.GetUnscaledSize().height,
-                                                    _actualFont.GetFaceName(),
-                                                    bgColor) :
-                                 "";
+        if (formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF))
+        {
+            rtfGenerator = [=]() {
+                return winrt::to_hstring(TextBuffer::GenRTF(*bufferData, fontHeight, fontFaceName, bgColor));
+            };
+        }
 
         // send data up for clipboard
         _CopyToClipboardHandlers(*this,
                                  winrt::make<CopyToClipboardEventArgs>(winrt::hstring{ textData },
-                                                                       winrt::to_hstring(htmlData),
-                                                                       winrt::to_hstring(rtfData),
+                                                                       std::move(htmlGenerator),
+                                                                       std::move(rtfGenerator),
                                                                        formats));
         return true;
     }
@@ -1444,27 +1590,29 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // TODO GH#9617: refine locking around pattern tree
         _terminal->ClearPatternTree();
 
-        // Start the throttled update of our scrollbar.
-        auto update{ winrt::make<ScrollPositionChangedArgs>(viewTop,
-                                                            viewHeight,
-                                                            bufferSize) };
+        // The viewport-relative cursor position changes when the viewport moves.
+        _updateCursorPositionUnderLock();
 
+        // Start the throttled update of our scrollbar.
         if (_inUnitTests) [[unlikely]]
         {
-            _ScrollPositionChangedHandlers(*this, update);
+            _ScrollPositionChangedHandlers(*this, winrt::make<ScrollPositionChangedArgs>(viewTop, viewHeight, bufferSize));
         }
         else
         {
             const auto shared = _shared.lock_shared();
             if (shared->updateScrollBar)
             {
-                shared->updateScrollBar->Run(update);
+                shared->updateScrollBar->Run(viewTop, viewHeight, bufferSize);
             }
         }
     }
 
     void ControlCore::_terminalCursorPositionChanged()
     {
+        // We're called by the Terminal while it's locked for writing.
+        _updateCursorPositionUnderLock();
+
         // When the buffer's cursor moves, start the throttled func to
         // eventually dispatch a CursorPositionChanged event.
         const auto shared = _shared.lock_shared();
@@ -1474,6 +1622,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Updates the cached cursor position returned by CursorPosition().
+    //   Must be called while the terminal is locked.
+    void ControlCore::_updateCursorPositionUnderLock() noexcept
+    {
+        _cursorPosition.store(_terminal->GetViewportRelativeCursorPosition(), std::memory_order_relaxed);
+    }
+
     void ControlCore::_terminalTaskbarProgressChanged()
     {
         _TaskbarProgressChangedHandlers(*this, nullptr);
@@ -1486,17 +1642,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     }
 
     // Method Description:
-    // - Plays a single MIDI note, blocking for the duration.
+    // - Queues a single MIDI note for playback. This doesn't block.
     // Arguments:
     // - noteNumber - The MIDI note number to be played (0 - 127).
     // - velocity - The force with which the note should be played (0 - 127).
     // - duration - How long the note should be sustained (in microseconds).
     void ControlCore::_terminalPlayMidiNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration)
     {
-        // The UI thread might try to acquire the console lock from time to time.
-        // --> Unlock it, so the UI doesn't hang while we're busy.
-        const auto suspension = _terminal->SuspendLock();
-        // This call will block for the duration, unless shutdown early.
         _midiAudio.PlayNote(reinterpret_cast<HWND>(_owningHwnd), noteNumber, velocity, std::chrono::duration_cast<std::chrono::milliseconds>(duration));
     }
 
@@ -1552,6 +1704,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         const auto foundMatch = _searcher.SelectCurrent();
+        _searchMemoryUsage.store(_searcher.GetMemoryUsage(), std::memory_order_relaxed);
         if (foundMatch)
         {
             // this is used for search,
@@ -1567,9 +1720,138 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _FoundMatchHandlers(*this, winrt::make<implementation::FoundResultsArgs>(foundMatch));
     }
 
+    // Method Description:
+    // - Searches through a snapshot of the buffer on a background thread, so that searching
+    //   through a large scrollback doesn't block output processing. This allows searching
+    //   through many controls at once. The terminal lock is only held while the snapshot
+    //   is updated and while the results are handed to the searcher.
+    // - The results are adopted by the same searcher that Search() uses, so that a Search()
+    //   for the same text afterwards jumps to a match without searching again.
+    // - Starting another background search or calling ClearSearch() cancels this one.
+    // Arguments:
+    // - text: The text to search for.
+    // - caseSensitive: If true, the search is case sensitive.
+    // Return Value:
+    // - The number of matches, or 0 if the search got cancelled.
+    Windows::Foundation::IAsyncOperation<uint32_t> ControlCore::SearchInBackground(const winrt::hstring& text, const bool caseSensitive)
+    {
+        const auto weakThis{ get_weak() };
+        const auto dispatcher = _dispatcher;
+        const std::wstring needle{ text };
+        const auto caseInsensitive = !caseSensitive;
+
+        _searchCancellation.cancel();
+        _searchCancellation = {};
+        const auto cancellation = _searchCancellation.token();
+
+        // The previous snapshot is reused unless a previous search is still reading it,
+        // because updating it only copies the rows that changed since.
+        if (!_searchSnapshot || _searchSnapshot.use_count() > 1)
+        {
+            _searchSnapshot = std::make_shared<TextBufferSnapshot>();
+        }
+        const auto snapshot = _searchSnapshot;
+
+        {
+            const auto lock = _terminal->LockForReading();
+            const auto& textBuffer = _terminal->GetTextBuffer();
+            textBuffer.UpdateSnapshot(*snapshot, 0, textBuffer.TotalRowCount());
+        }
+
+        co_await winrt::resume_background();
+
+        auto results = ::Search::SearchSnapshot(*snapshot, needle, caseInsensitive, cancellation);
+
+        co_await wil::resume_foreground(dispatcher);
+
+        const auto core = weakThis.get();
+        if (!core || !results || cancellation.is_cancelled())
+        {
+            co_return 0;
+        }
+
+        const auto lock = _terminal->LockForWriting();
+
+        // The results belong to a buffer that isn't shown anymore (for instance, because the
+        // alternate buffer got activated). ResetIfStale() below searches the current one instead.
+        if (snapshot->source == &_terminal->GetTextBuffer())
+        {
+            _searcher.AdoptResults(*GetRenderData(), *snapshot, needle, false, caseInsensitive, std::move(*results));
+        }
+
+        // This catches up on anything that was written to the buffer while the search was running.
+        _searcher.ResetIfStale(*GetRenderData(), needle, false, caseInsensitive);
+        _searcher.MovePastCurrentSelection();
+        _searchMemoryUsage.store(_searcher.GetMemoryUsage(), std::memory_order_relaxed);
+
+        co_return gsl::narrow_cast<uint32_t>(_searcher.GetResultCount());
+    }
+
     void ControlCore::ClearSearch()
     {
+        _searchCancellation.cancel();
         _searcher = {};
+        _searchMemoryUsage.store(0, std::memory_order_relaxed);
+    }
+
+    // Method Description:
+    // - Enables snapshotting the buffer to the given path, so that its contents
+    //   can be restored by the next session. Must be called before Initialize().
+    // Arguments:
+    // - path: The file to restore the buffer from and to write the snapshot to.
+    void ControlCore::EnableBufferSnapshots(const winrt::hstring& path)
+    {
+        _bufferSnapshotPath = path;
+    }
+
+    // Method Description:
+    // - Restores the previous snapshot into the freshly created buffer and starts a new one
+    //   in its place. Failing to do either only means that there won't be a snapshot.
+    // - The terminal lock must be held.
+    void ControlCore::_startBufferSnapshotsUnderLock()
+    {
+        const std::filesystem::path path{ std::wstring_view{ _bufferSnapshotPath } };
+
+        try
+        {
+            _terminal->RestoreBufferSnapshot(path);
+        }
+        CATCH_LOG();
+
+        try
+        {
+            *_bufferSnapshot->lock() = std::make_unique<::BufferSnapshot>(path);
+        }
+        CATCH_LOG();
+    }
+
+    // Method Description:
+    // - Writes the remaining rows, including the viewport, to the snapshot and closes it.
+    void ControlCore::_finishBufferSnapshot()
+    {
+        if (_bufferSnapshotPath.empty() || !_initializedTerminal.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        const auto snapshot = _bufferSnapshot->lock();
+        if (!*snapshot)
+        {
+            return;
+        }
+
+        {
+            const auto lock = _terminal->LockForReading();
+            _terminal->CaptureBufferSnapshot(**snapshot, true);
+        }
+
+        try
+        {
+            (*snapshot)->Flush();
+        }
+        CATCH_LOG();
+
+        snapshot->reset();
     }
 
     void ControlCore::Close()
@@ -1585,6 +1867,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _connectionOutputEventRevoker.revoke();
             _connectionStateChangedRevoker.revoke();
             _connection.Close();
+
+            _finishBufferSnapshot();
         }
     }
 
@@ -1633,6 +1917,60 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _TabColorChangedHandlers(*this, nullptr);
     }
 
+    // Method Description:
+    // - Called on the render thread after a frame has been painted. If a key press
+    //   and its echo from the connection have been recorded, this completes the
+    //   measurement and emits the "InputLatency" event with the time from input
+    //   to echo, from echo to present and the total in microseconds.
+    // - The echo is only correlated heuristically (the first output after the input)
+    //   and the frame may have started shortly before the echo arrived.
+    void ControlCore::_rendererFramePresented()
+    {
+        const auto echo = _latencyEchoTime.load(std::memory_order_relaxed);
+        if (!echo)
+        {
+            return;
+        }
+
+        // Clearing the input first prevents the output handler from recording a new echo
+        // for it, before we clear the echo as well.
+        const auto input = _latencyInputTime.exchange(0, std::memory_order_relaxed);
+        _latencyEchoTime.store(0, std::memory_order_relaxed);
+
+        LARGE_INTEGER now;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&now);
+        QueryPerformanceFrequency(&frequency);
+
+        const auto toMicroseconds = [&](int64_t ticks) noexcept {
+            return ticks * 1'000'000 / frequency.QuadPart;
+        };
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hTerminalControlProvider,
+                          "InputLatency",
+                          TraceLoggingDescription("Time from a key press until its echo has been presented"),
+                          TraceLoggingInt64(toMicroseconds(echo - input), "InputToEchoUs"),
+                          TraceLoggingInt64(toMicroseconds(now.QuadPart - echo), "EchoToPresentUs"),
+                          TraceLoggingInt64(toMicroseconds(now.QuadPart - input), "InputToPresentUs"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+
+    // Method Description:
+    // - Starts an input latency measurement for _rendererFramePresented(), if
+    //   the "InputLatency" event is being traced and none is in progress yet.
+    void ControlCore::_recordLatencyInput() noexcept
+    {
+        if (TraceLoggingProviderEnabled(g_hTerminalControlProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+        {
+            int64_t expected = 0;
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            _latencyInputTime.compare_exchange_strong(expected, now.QuadPart, std::memory_order_relaxed);
+        }
+    }
+
     void ControlCore::BlinkAttributeTick()
     {
         auto lock = _terminal->LockForWriting();
@@ -1685,8 +2023,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return { 0, 0 };
         }
 
-        auto lock = _terminal->LockForReading();
-        return _terminal->GetViewportRelativeCursorPosition().to_core_point();
+        return _cursorPosition.load(std::memory_order_relaxed).to_core_point();
     }
 
     // This one's really pushing the boundary of what counts as "encapsulation".
@@ -1865,12 +2202,26 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             _terminal->Write(hstr);
 
+            // The first output after a key press is assumed to be its echo.
+            if (_latencyInputTime.load(std::memory_order_relaxed))
+            {
+                int64_t expected = 0;
+                LARGE_INTEGER now;
+                QueryPerformanceCounter(&now);
+                _latencyEchoTime.compare_exchange_strong(expected, now.QuadPart, std::memory_order_relaxed);
+            }
+
             // Start the throttled update of where our hyperlinks are.
             const auto shared = _shared.lock_shared();
             if (shared->updatePatternLocations)
             {
                 (*shared->updatePatternLocations)();
             }
+
+            if (!_bufferSnapshotPath.empty() && shared->captureBufferSnapshot)
+            {
+                (*shared->captureBufferSnapshot)();
+            }
         }
         catch (...)
         {
@@ -1950,33 +2301,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     Control::CommandHistoryContext ControlCore::CommandHistory() const
     {
         auto terminalLock = _terminal->LockForWriting();
-        const auto& textBuffer = _terminal->GetTextBuffer();
 
         std::vector<winrt::hstring> commands;
 
+        // The marks hold a snapshot of their command text, so we don't need to read the buffer.
         for (const auto& mark : _terminal->GetScrollMarks())
         {
-            // The command text is between the `end` (which denotes the end of
-            // the prompt) and the `commandEnd`.
-            bool markHasCommand = mark.commandEnd.has_value() &&
-                                  mark.commandEnd != mark.end;
-            if (!markHasCommand)
+            if (!mark.command.empty())
             {
-                continue;
-            }
-
-            // Get the text of the command
-            const auto line = mark.end.y;
-            const auto& row = textBuffer.GetRowByOffset(line);
-            const auto commandText = row.GetText(mark.end.x, mark.commandEnd->x);
-
-            // Trim off trailing spaces.
-            const auto strEnd = commandText.find_last_not_of(UNICODE_SPACE);
-            if (strEnd != std::string::npos)
-            {
-                const auto trimmed = commandText.substr(0, strEnd + 1);
-
-                commands.push_back(winrt::hstring{ trimmed });
+                commands.emplace_back(mark.command);
             }
         }
         auto context = winrt::make_self<CommandHistoryContext>(std::move(commands));
@@ -2107,6 +2440,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     // Method Description:
     // - Notifies the attached PTY that the window has changed visibility state
+    //   and suspends painting while the window is hidden.
     // - NOTE: Most VT commands are generated in `TerminalDispatch` and sent to this
     //         class as the target for transmission. But since this message isn't
     //         coming in via VT parsing (and rather from a window state transition)
@@ -2125,7 +2459,227 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 conpty.ShowHide(showOrHide);
             }
         }
+
+        _windowVisible = showOrHide;
+        _updateRenderingSuspended();
+    }
+
+    // Method Description:
+    // - Called by the TermControl when it's added to or removed from the visual
+    //   tree, for instance when its tab is switched to or away from.
+    // Arguments:
+    // - visible: True if the control is part of the visual tree.
+    void ControlCore::ControlVisibilityChanged(const bool visible)
+    {
+        _controlVisible = visible;
+        _updateRenderingSuspended();
+    }
+
+    // Method Description:
+    // - Stops painting while the window is minimized or the control is hidden, and
+    //   resumes it once both are visible again. The text buffer continues to be updated
+    //   in the meantime and all of it is repainted at once on resumption, so painting
+    //   frames nobody can see is just a waste of CPU and GPU time.
+    // - If the control stays hidden for TrimMemoryDelay, _trimMemory() releases most of its memory.
+    void ControlCore::_updateRenderingSuspended()
+    {
+        if (!_initializedTerminal.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        const auto suspend = !_windowVisible || !_controlVisible;
+        if (suspend == _renderingSuspended)
+        {
+            return;
+        }
+
+        _renderingSuspended = suspend;
+
+        if (suspend)
+        {
+            _renderer->WaitForPaintCompletionAndDisable(INFINITE);
+            _renderingSuspendedSince = std::chrono::steady_clock::now();
+
+            if (const auto shared = _shared.lock_shared(); shared->trimMemory)
+            {
+                shared->trimMemory->Run();
+            }
+        }
+        else
+        {
+            _renderer->EnablePainting();
+            _renderer->TriggerRedrawAll();
+        }
+    }
+
+    // Method Description:
+    // - Called TrimMemoryDelay after the rendering got suspended. If the control is still hidden,
+    //   this compresses and decommits the scrollback and releases the renderer's caches and GPU
+    //   resources. They're all restored on demand, once the control is shown and repainted.
+    //   Tabs in the background of long-running sessions are otherwise the largest consumers of memory.
+    void ControlCore::_trimMemory()
+    {
+        if (!_renderingSuspended)
+        {
+            return;
+        }
+
+        // The control was shown and hidden again in the meantime. Check back later.
+        if (std::chrono::steady_clock::now() - _renderingSuspendedSince < TrimMemoryDelay)
+        {
+            if (const auto shared = _shared.lock_shared(); shared->trimMemory)
+            {
+                shared->trimMemory->Run();
+            }
+            return;
+        }
+
+        {
+            const auto lock = _terminal->LockForWriting();
+            _terminal->TrimMemory();
+        }
+
+        // Safe, because painting is disabled while _renderingSuspended is set.
+        _renderer->TrimMemory();
+    }
+
+    // Method Description:
+    // - Returns the current memory usage of this control. Can be called from any thread.
+    ControlCore::MemoryUsage ControlCore::_getMemoryUsage() const
+    {
+        MemoryUsage usage;
+        {
+            const auto lock = _terminal->LockForReading();
+            usage.buffer = _terminal->GetMemoryUsage();
+        }
+        usage.searchResults = _searchMemoryUsage.load(std::memory_order_relaxed);
+        usage.renderer = _renderer->GetMemoryUsage();
+        return usage;
+    }
+
+    // Method Description:
+    // - Adds the control to the ones checked by _memoryAccountingTick().
+    //   The timer for it is started along with the first control.
+    void ControlCore::_registerMemoryAccounting(ControlCore* core)
+    {
+        const auto accounting = s_memoryAccounting.lock();
+        if (!accounting->timer)
+        {
+            accounting->timer = CreateThreadpoolTimer(&_memoryAccountingTick, nullptr, nullptr);
+            THROW_LAST_ERROR_IF(!accounting->timer);
+
+            using filetime_duration = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+            const auto due = -std::chrono::duration_cast<filetime_duration>(MemoryAccountingInterval).count();
+            const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(MemoryAccountingInterval).count();
+            FILETIME dueTime;
+            memcpy(&dueTime, &due, sizeof(dueTime));
+            SetThreadpoolTimerEx(accounting->timer, &dueTime, gsl::narrow_cast<DWORD>(period), 1000);
+        }
+        accounting->cores.emplace_back(core);
+    }
+
+    void ControlCore::_unregisterMemoryAccounting(ControlCore* core) noexcept
+    {
+        const auto accounting = s_memoryAccounting.lock();
+        std::erase(accounting->cores, core);
+    }
+
+    // Method Description:
+    // - Runs on the thread pool every MemoryAccountingInterval. It emits a "MemoryUsage" event for each control
+    //   while the TerminalControl provider is traced at verbose level. If the controls use more memory than
+    //   the "experimental.memoryBudget" allows, it trims the text buffers of the largest ones first,
+    //   until the total is within the budget again. See Terminal::TrimMemory().
+    // - The renderers are only trimmed once their control gets hidden (see _trimMemory()),
+    //   because doing so requires painting to be disabled and visible panes would just recreate everything.
+    void CALLBACK ControlCore::_memoryAccountingTick(PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER) noexcept
+    try
+    {
+        const auto budget = s_memoryBudget.load(std::memory_order_relaxed);
+        const auto tracing = TraceLoggingProviderEnabled(g_hTerminalControlProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+        if (!budget && !tracing)
+        {
+            return;
+        }
+
+        // Holding the lock prevents the controls from being destroyed while we use them.
+        const auto accounting = s_memoryAccounting.lock_shared();
+        std::vector<std::pair<size_t, ControlCore*>> trimmable;
+        size_t total = 0;
+
+        for (const auto core : accounting->cores)
+        {
+            if (!core->_initializedTerminal.load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+
+            const auto usage = core->_getMemoryUsage();
+            total += usage.Total();
+            trimmable.emplace_back(usage.buffer.rows + usage.buffer.attributes, core);
+
+            if (tracing)
+            {
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+                TraceLoggingWrite(g_hTerminalControlProvider,
+                                  "MemoryUsage",
+                                  TraceLoggingDescription("The memory used by a terminal control in bytes"),
+                                  TraceLoggingPointer(core, "Core"),
+                                  TraceLoggingUInt64(usage.buffer.rows, "Rows"),
+                                  TraceLoggingUInt64(usage.buffer.coldRows, "ColdRows"),
+                                  TraceLoggingUInt64(usage.buffer.attributes, "Attributes"),
+                                  TraceLoggingUInt64(usage.buffer.hyperlinks, "Hyperlinks"),
+                                  TraceLoggingUInt64(usage.buffer.marks, "Marks"),
+                                  TraceLoggingUInt64(usage.buffer.searchIndex, "SearchIndex"),
+                                  TraceLoggingUInt64(usage.searchResults, "SearchResults"),
+                                  TraceLoggingUInt64(usage.renderer.glyphAtlas, "GlyphAtlas"),
+                                  TraceLoggingUInt64(usage.renderer.swapChain, "SwapChain"),
+                                  TraceLoggingUInt64(usage.Total(), "Total"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+        }
+
+        if (!budget || total <= budget)
+        {
+            return;
+        }
+
+        // Only the uncompressed rows and their attributes shrink when trimming a buffer.
+        std::sort(trimmable.begin(), trimmable.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first;
+        });
+
+        for (const auto& [before, core] : trimmable)
+        {
+            if (total <= budget)
+            {
+                break;
+            }
+
+            size_t after = 0;
+            {
+                const auto lock = core->_terminal->LockForWriting();
+                core->_terminal->TrimMemory();
+                const auto usage = core->_terminal->GetMemoryUsage();
+                after = usage.rows + usage.attributes;
+            }
+
+            total -= std::min(total, before - std::min(before, after));
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+            TraceLoggingWrite(g_hTerminalControlProvider,
+                              "MemoryBudgetTrim",
+                              TraceLoggingDescription("The text buffer of a terminal control was trimmed to stay within the memory budget"),
+                              TraceLoggingPointer(core, "Core"),
+                              TraceLoggingUInt64(before, "Before"),
+                              TraceLoggingUInt64(after, "After"),
+                              TraceLoggingUInt64(budget, "Budget"),
+                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
     }
+    CATCH_LOG()
 
     // Method Description:
     // - When the control gains focus, it needs to tell ConPTY about this.
@@ -2213,6 +2767,39 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return v;
     }
 
+    // Method Description:
+    // - Distributes the scroll marks over bucketCount evenly sized slices of the
+    //   buffer and returns the color of the last mark in each slice, if any.
+    // - The scrollbar can only display as many marks as it is pixels tall, regardless
+    //   of how many marks there are. This allows it to draw them without creating
+    //   (and marshalling) an element for every single mark in the buffer.
+    // Arguments:
+    // - bucketCount: the number of slices, usually the scrollbar height in pips.
+    // - totalRows: the number of buffer rows the scrollbar represents.
+    // Return Value:
+    // - An array of bucketCount colors. HasValue is false for slices without marks.
+    winrt::com_array<winrt::Microsoft::Terminal::Core::OptionalColor> ControlCore::ScrollMarkBuckets(const int32_t bucketCount, const int32_t totalRows) const
+    {
+        winrt::com_array<winrt::Microsoft::Terminal::Core::OptionalColor> buckets(gsl::narrow_cast<uint32_t>(std::max(bucketCount, 0)));
+        if (buckets.empty() || totalRows <= 0)
+        {
+            return buckets;
+        }
+
+        const auto lock = _terminal->LockForReading();
+        for (const auto& mark : _terminal->GetScrollMarks())
+        {
+            const auto bucket = int64_t{ mark.start.y } * bucketCount / totalRows;
+            if (bucket >= 0 && bucket < bucketCount)
+            {
+                // Just like ScrollMarks(), always evaluate the color to a real value.
+                buckets[gsl::narrow_cast<uint32_t>(bucket)] = OptionalFromColor(_terminal->GetColorForMark(mark));
+            }
+        }
+
+        return buckets;
+    }
+
     void ControlCore::AddMark(const Control::ScrollMark& mark)
     {
         ::ScrollMark m{};
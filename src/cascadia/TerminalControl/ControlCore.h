@@ -139,6 +139,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ColorSelection(const Control::SelectionColor& fg, const Control::SelectionColor& bg, Core::MatchMode matchMode);
 
         void Close();
+        void EnableBufferSnapshots(const winrt::hstring& path);
 
 #pragma region ICoreState
         const size_t TaskbarState() const noexcept;
@@ -160,6 +161,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         bool BracketedPasteEnabled() const noexcept;
 
         Windows::Foundation::Collections::IVector<Control::ScrollMark> ScrollMarks() const;
+        winrt::com_array<winrt::Microsoft::Terminal::Core::OptionalColor> ScrollMarkBuckets(int32_t bucketCount, int32_t totalRows) const;
         void AddMark(const Control::ScrollMark& mark);
         void ClearMark();
         void ClearAllMarks();
@@ -206,6 +208,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void SetEndSelectionPoint(const til::point position);
 
         void Search(const winrt::hstring& text, const bool goForward, const bool caseSensitive);
+        Windows::Foundation::IAsyncOperation<uint32_t> SearchInBackground(const winrt::hstring& text, const bool caseSensitive);
         void ClearSearch();
 
         void LeftClickOnTerminal(const til::point terminalPosition,
@@ -230,6 +233,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void AdjustOpacity(const double opacity, const bool relative);
 
         void WindowVisibilityChanged(const bool showOrHide);
+        void ControlVisibilityChanged(const bool visible);
 
         uint64_t OwningHwnd();
         void OwningHwnd(uint64_t owner);
@@ -282,12 +286,40 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             std::shared_ptr<ThrottledFuncTrailing<>> tsfTryRedrawCanvas;
             std::unique_ptr<til::throttled_func_trailing<>> updatePatternLocations;
-            std::shared_ptr<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>> updateScrollBar;
+            std::shared_ptr<ThrottledFuncTrailing<int, int, int>> updateScrollBar;
+            std::unique_ptr<til::throttled_func_trailing<>> captureBufferSnapshot;
+            std::shared_ptr<ThrottledFuncTrailing<>> trimMemory;
         };
 
         std::atomic<bool> _initializedTerminal{ false };
         bool _closing{ false };
 
+        // The viewport-relative cursor position as of the last time the cursor, the viewport or the size
+        // changed. CursorPosition() is queried by TSF for every layout request during an IME composition
+        // and this allows it to answer without contending with the output thread for the terminal lock.
+        std::atomic<til::point> _cursorPosition{};
+
+        // Painting is suspended while either the window or the control is hidden. See _updateRenderingSuspended().
+        bool _windowVisible{ true };
+        bool _controlVisible{ true };
+        bool _renderingSuspended{ false };
+        std::chrono::steady_clock::time_point _renderingSuspendedSince{};
+
+        // The memory used by a ControlCore in bytes. See _memoryAccountingTick().
+        struct MemoryUsage
+        {
+            TextBufferMemoryUsage buffer;
+            size_t searchResults = 0;
+            ::Microsoft::Console::Render::RenderEngineMemoryUsage renderer;
+
+            size_t Total() const noexcept
+            {
+                return buffer.Total() + searchResults + renderer.glyphAtlas + renderer.swapChain;
+            }
+        };
+        // The _searcher is only accessed on the UI thread, but _getMemoryUsage() is called on a background thread.
+        std::atomic<size_t> _searchMemoryUsage{ 0 };
+
         TerminalConnection::ITerminalConnection _connection{ nullptr };
         TerminalConnection::ITerminalConnection::TerminalOutput_revoker _connectionOutputEventRevoker;
         TerminalConnection::ITerminalConnection::StateChanged_revoker _connectionStateChangedRevoker;
@@ -305,6 +337,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer{ nullptr };
 
         ::Search _searcher;
+        // Used by SearchInBackground(). The snapshot is shared with the background thread while it's searched through.
+        std::shared_ptr<TextBufferSnapshot> _searchSnapshot;
+        til::cancellation_source _searchCancellation;
+
+        winrt::hstring _bufferSnapshotPath;
+        // Shared with the captureBufferSnapshot throttled func, which runs on a background thread.
+        std::shared_ptr<til::shared_mutex<std::unique_ptr<::BufferSnapshot>>> _bufferSnapshot{ std::make_shared<til::shared_mutex<std::unique_ptr<::BufferSnapshot>>>() };
 
         winrt::handle _lastSwapChainHandle{ nullptr };
 
@@ -339,11 +378,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         til::point _contextMenuBufferPosition{ 0, 0 };
 
         void _setupDispatcherAndCallbacks();
+        void _startBufferSnapshotsUnderLock();
+        void _finishBufferSnapshot();
 
         bool _setFontSizeUnderLock(float fontSize);
         void _updateFont();
         void _refreshSizeUnderLock();
         void _updateSelectionUI();
+        void _updateRenderingSuspended();
+        void _trimMemory();
+        MemoryUsage _getMemoryUsage() const;
+        static void _registerMemoryAccounting(ControlCore* core);
+        static void _unregisterMemoryAccounting(ControlCore* core) noexcept;
+        static void CALLBACK _memoryAccountingTick(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer) noexcept;
         bool _shouldTryUpdateSelection(const WORD vkey);
 
         void _handleControlC();
@@ -357,6 +404,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                             const int viewHeight,
                                             const int bufferSize);
         void _terminalCursorPositionChanged();
+        void _updateCursorPositionUnderLock() noexcept;
         void _terminalTaskbarProgressChanged();
         void _terminalShowWindowChanged(bool showOrHide);
         void _terminalPlayMidiNote(const int noteNumber,
@@ -370,13 +418,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         MidiAudio _midiAudio;
         winrt::Windows::System::DispatcherQueueTimer _midiAudioSkipTimer{ nullptr };
 
+        // QueryPerformanceCounter() timestamps of the pending input latency measurement.
+        // 0 means that no input/echo has been recorded yet. See _rendererFramePresented().
+        std::atomic<int64_t> _latencyInputTime{ 0 };
+        std::atomic<int64_t> _latencyEchoTime{ 0 };
+
 #pragma region RendererCallbacks
         void _rendererWarning(const HRESULT hr);
         winrt::fire_and_forget _renderEngineSwapChainChanged(const HANDLE handle);
         void _rendererBackgroundColorChanged();
         void _rendererTabColorChanged();
+        void _rendererFramePresented();
 #pragma endregion
 
+        void _recordLatencyInput() noexcept;
+
         void _raiseReadOnlyWarning();
         void _updateAntiAliasingMode();
         void _connectionOutputHandler(const hstring& hstr);
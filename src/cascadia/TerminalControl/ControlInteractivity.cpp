@@ -250,6 +250,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         const auto terminalPosition = _getTerminalPosition(til::point{ pixelPosition });
 
+        _lastPointerSelectionEnd.reset();
+
         const auto altEnabled = modifiers.IsAltPressed();
         const auto shiftEnabled = modifiers.IsShiftPressed();
         const auto ctrlEnabled = modifiers.IsCtrlPressed();
@@ -380,10 +382,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
                     // stop tracking the touchdown point
                     _singleClickTouchdownPos = std::nullopt;
+                    _lastPointerSelectionEnd.reset();
                 }
             }
 
-            SetEndSelectionPoint(pixelPosition);
+            // A mouse with a high polling rate reports many moves within the same cell, but
+            // updating the selection takes the write lock and redraws. We only need to do that
+            // once the pointer reaches another cell or the viewport has scrolled (see autoscroll).
+            const std::pair selectionEnd{ terminalPosition, _core->ScrollOffset() };
+            if (selectionEnd != _lastPointerSelectionEnd)
+            {
+                _lastPointerSelectionEnd = selectionEnd;
+                SetEndSelectionPoint(pixelPosition);
+            }
         }
 
         _core->SetHoveredCell(terminalPosition.to_core_point());
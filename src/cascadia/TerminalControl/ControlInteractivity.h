@@ -132,6 +132,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // from firing when the pointer _just happens_ to be released over the
         // terminal.
         bool _selectionNeedsToBeCopied;
+        // The cell and scroll offset of the last selection update made by PointerMoved,
+        // which is used to skip the redundant updates caused by high polling rate mice.
+        std::optional<std::pair<til::point, int>> _lastPointerSelectionEnd;
 
         std::optional<til::point> _lastHoveredCell{ std::nullopt };
         // Track the last hyperlink ID we hovered over
@@ -56,21 +56,37 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _rtf(),
             _formats(static_cast<CopyFormat>(0)) {}
 
-        CopyToClipboardEventArgs(hstring text, hstring html, hstring rtf, Windows::Foundation::IReference<CopyFormat> formats) :
+        // The HTML and RTF representations are expensive to generate for large selections and
+        // most consumers only ever want the plain text. They're produced on first access instead.
+        CopyToClipboardEventArgs(hstring text, std::function<hstring()> html, std::function<hstring()> rtf, Windows::Foundation::IReference<CopyFormat> formats) :
             _text(text),
-            _html(html),
-            _rtf(rtf),
+            _html(),
+            _rtf(),
+            _htmlGenerator(std::move(html)),
+            _rtfGenerator(std::move(rtf)),
             _formats(formats) {}
 
         hstring Text() { return _text; };
-        hstring Html() { return _html; };
-        hstring Rtf() { return _rtf; };
+        hstring Html() { return _generate(_html, _htmlGenerator); };
+        hstring Rtf() { return _generate(_rtf, _rtfGenerator); };
         Windows::Foundation::IReference<CopyFormat> Formats() { return _formats; };
 
     private:
+        static hstring _generate(hstring& cache, std::function<hstring()>& generator)
+        {
+            if (generator)
+            {
+                cache = generator();
+                generator = nullptr;
+            }
+            return cache;
+        }
+
         hstring _text;
         hstring _html;
         hstring _rtf;
+        std::function<hstring()> _htmlGenerator;
+        std::function<hstring()> _rtfGenerator;
         Windows::Foundation::IReference<CopyFormat> _formats;
     };
 
@@ -182,15 +182,27 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Make sure to unscale the font size to correct for DPI! XAML needs
         // things in DIPs, and the fontSize is in pixels.
-        TextBlock().FontSize(unscaledFontSizePx);
-        TextBlock().FontFamily(Media::FontFamily(fontArgs->FontFace()));
-        TextBlock().FontWeight(fontArgs->FontWeight());
-
-        // TextBlock's actual dimensions right after initialization is 0w x 0h. So,
-        // if an IME is displayed before TextBlock has text (like showing the emoji picker
-        // using Win+.), it'll be placed higher than intended.
-        TextBlock().MinWidth(unscaledFontSizePx);
-        TextBlock().MinHeight(unscaledFontSizePx);
+        if (_currentFontSize != unscaledFontSizePx)
+        {
+            _currentFontSize = unscaledFontSizePx;
+            TextBlock().FontSize(unscaledFontSizePx);
+
+            // TextBlock's actual dimensions right after initialization is 0w x 0h. So,
+            // if an IME is displayed before TextBlock has text (like showing the emoji picker
+            // using Win+.), it'll be placed higher than intended.
+            TextBlock().MinWidth(unscaledFontSizePx);
+            TextBlock().MinHeight(unscaledFontSizePx);
+        }
+        if (_currentFontFace != fontArgs->FontFace())
+        {
+            _currentFontFace = fontArgs->FontFace();
+            TextBlock().FontFamily(Media::FontFamily(_currentFontFace));
+        }
+        if (_currentFontWeight != fontArgs->FontWeight().Weight)
+        {
+            _currentFontWeight = fontArgs->FontWeight().Weight;
+            TextBlock().FontWeight(fontArgs->FontWeight());
+        }
         _currentTextBlockHeight = std::max(unscaledFontSizePx, _currentTextBlockHeight);
 
         const auto widthToTerminalEnd = _currentCanvasWidth - clientCursorInDips.x;
@@ -84,6 +84,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Windows::Foundation::Rect _currentControlBounds{};
         winrt::Windows::Foundation::Rect _currentTextBounds{};
         winrt::Windows::Foundation::Rect _currentWindowBounds{};
+        // The font properties last applied to the TextBlock. Setting them causes XAML
+        // to measure the TextBlock again, so they're only set when they changed.
+        double _currentFontSize = 0.0;
+        winrt::hstring _currentFontFace;
+        uint16_t _currentFontWeight = 0;
     };
 }
 namespace winrt::Microsoft::Terminal::Control::factory_implementation
@@ -109,6 +109,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _revokers.PasteFromClipboard = _interactivity.PasteFromClipboard(winrt::auto_revoke, { get_weak(), &TermControl::_bubblePasteFromClipboard });
 
+        // Controls in background tabs are removed from the visual tree. There's no point
+        // in painting them until they're shown again, so we let the core suspend rendering.
+        Loaded([weakThis = get_weak()](auto&&, auto&&) {
+            if (auto control{ weakThis.get() }; control && !control->_IsClosing())
+            {
+                control->_core.ControlVisibilityChanged(true);
+            }
+        });
+        Unloaded([weakThis = get_weak()](auto&&, auto&&) {
+            if (auto control{ weakThis.get() }; control && !control->_IsClosing())
+            {
+                control->_core.ControlVisibilityChanged(false);
+            }
+        });
+
         // Initialize the terminal only once the swapchainpanel is loaded - that
         //      way, we'll be able to query the real pixel size it got on layout
         _layoutUpdatedRevoker = SwapChainPanel().LayoutUpdated(winrt::auto_revoke, [this](auto /*s*/, auto /*e*/) {
@@ -298,12 +313,31 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             // Update scrollbar marks
             ScrollBarCanvas().Children().Clear();
-            const auto marks{ _core.ScrollMarks() };
             const auto fullHeight{ ScrollBarCanvas().ActualHeight() };
             const auto totalBufferRows{ update.newMaximum + update.newViewportSize };
 
-            for (const auto m : marks)
+            // There can be thousands of marks, but only one pip per 2px fits into
+            // the scrollbar. ControlCore buckets the marks by pip, so that we
+            // only create (at most) one rectangle per run of equally colored pips.
+            static constexpr auto pipHeight = 2.0;
+            const auto bucketCount = gsl::narrow_cast<int32_t>(std::ceil(fullHeight / pipHeight));
+            const auto buckets{ _core.ScrollMarkBuckets(bucketCount, gsl::narrow_cast<int32_t>(totalBufferRows)) };
+            const auto bucketHeight = fullHeight / std::max(bucketCount, 1);
+
+            for (uint32_t i = 0; i < buckets.size();)
             {
+                const auto color = buckets[i];
+                auto end = i + 1;
+                if (!color.HasValue)
+                {
+                    i = end;
+                    continue;
+                }
+                while (end < buckets.size() && buckets[end].HasValue && buckets[end].Color == color.Color)
+                {
+                    end++;
+                }
+
                 Windows::UI::Xaml::Shapes::Rectangle r;
                 Media::SolidColorBrush brush{};
                 // Sneaky: technically, a mark doesn't need to have a color set,
@@ -311,15 +345,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 // kind of mark. Fortunately, ControlCore is kind enough to
                 // pre-evaluate that for us, and shove the real value into the
                 // Color member, regardless if the mark has a literal value set.
-                brush.Color(static_cast<til::color>(m.Color.Color));
+                brush.Color(static_cast<til::color>(color.Color));
                 r.Fill(brush);
                 r.Width(16.0f / 3.0f); // pip width - 1/3rd of the scrollbar width.
-                r.Height(2);
-                const auto markRow = m.Start.Y;
-                const auto fractionalHeight = markRow / totalBufferRows;
-                const auto relativePos = fractionalHeight * fullHeight;
+                r.Height((end - i - 1) * bucketHeight + pipHeight);
                 ScrollBarCanvas().Children().Append(r);
-                Windows::UI::Xaml::Controls::Canvas::SetTop(r, relativePos);
+                Windows::UI::Xaml::Controls::Canvas::SetTop(r, i * bucketHeight);
+
+                i = end;
             }
         }
     }
@@ -373,6 +406,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Searches through the buffer without blocking output processing. See ControlCore::SearchInBackground().
+    Windows::Foundation::IAsyncOperation<uint32_t> TermControl::SearchInBackground(const winrt::hstring& text, const bool caseSensitive)
+    {
+        return _core.SearchInBackground(text, caseSensitive);
+    }
+
     // Method Description:
     // Find if search box text edit currently is in focus
     // Return Value:
@@ -488,6 +528,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
+        _ApplyAppearanceToXaml(newAppearance);
+        _core.ApplyAppearance(_focused);
+    }
+
+    // Method Description:
+    // - Applies the appearance to our XAML elements only. Unlike
+    //   _UpdateAppearanceFromUIThread, this leaves the core and its renderer alone.
+    // - INVARIANT: This method must be called from the UI thread.
+    // Arguments:
+    // - newAppearance: the new appearance to set
+    void TermControl::_ApplyAppearanceToXaml(const Control::IControlAppearance& newAppearance)
+    {
         _SetBackgroundImage(newAppearance);
 
         // Update our control settings
@@ -514,8 +566,6 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             foregroundBrush.Color(static_cast<til::color>(newAppearance.DefaultForeground()));
         }
         TSFInputControl().Foreground(foregroundBrush);
-
-        _core.ApplyAppearance(_focused);
     }
 
     // Method Description:
@@ -604,6 +654,44 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // that message, we'll redraw them.
     }
 
+    // Method Description:
+    // - Returns a BitmapImage for the given URI, which is shared between all
+    //   controls on this thread that use the same background image. This way
+    //   the image only gets downloaded and decoded once, no matter how many panes
+    //   show it, and changing the appearance of a pane (for instance when it gets
+    //   focused) doesn't load it again either.
+    // - XAML objects can only be used on the thread they were created on,
+    //   which is why each (window) thread gets its own cache.
+    // Arguments:
+    // - imageUri: The location of the image
+    // Return Value:
+    // - The shared image
+    Media::Imaging::BitmapImage TermControl::_GetSharedBackgroundImage(const Windows::Foundation::Uri& imageUri)
+    {
+        // The cache only holds weak references, so that an image gets freed
+        // as soon as the last control that displays it is gone.
+        thread_local std::unordered_map<std::wstring, winrt::weak_ref<Media::Imaging::BitmapImage>> cache;
+
+        std::wstring key{ imageUri.AbsoluteUri() };
+        if (const auto it = cache.find(key); it != cache.end())
+        {
+            if (auto image = it->second.get())
+            {
+                return image;
+            }
+        }
+
+        std::erase_if(cache, [](const auto& entry) { return !entry.second.get(); });
+
+        // Note that BitmapImage handles the image load asynchronously,
+        // which is especially important since the image
+        // may well be both large and somewhere out on the
+        // internet.
+        Media::Imaging::BitmapImage image{ imageUri };
+        cache.insert_or_assign(std::move(key), winrt::make_weak(image));
+        return image;
+    }
+
     // Method Description:
     // - Sets background image and applies its settings (stretch, opacity and alignment)
     // - Checks path validity
@@ -640,12 +728,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             imageSource.UriSource() == nullptr ||
             !imageSource.UriSource().Equals(imageUri))
         {
-            // Note that BitmapImage handles the image load asynchronously,
-            // which is especially important since the image
-            // may well be both large and somewhere out on the
-            // internet.
-            Media::Imaging::BitmapImage image(imageUri);
-            BackgroundImage().Source(image);
+            BackgroundImage().Source(_GetSharedBackgroundImage(imageUri));
         }
 
         // Apply stretch, opacity and alignment settings
@@ -1036,7 +1119,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         // Now that the renderer is set up, update the appearance for initialization
-        _UpdateAppearanceFromUIThread(_core.FocusedAppearance());
+        if (reason == InitializeReason::Create)
+        {
+            _UpdateAppearanceFromUIThread(_core.FocusedAppearance());
+        }
+        else
+        {
+            // The core already has its appearance applied and its renderer still holds the
+            // swap chain, glyph atlas, etc. with the last frame in it. Re-applying the appearance
+            // to the core would force a repaint of the entire viewport for no reason (and reset
+            // any colors the application changed), so only our new XAML elements need it.
+            _ApplyAppearanceToXaml(_core.FocusedAppearance());
+        }
 
         _initializedTerminal = true;
 
@@ -113,6 +113,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void CreateSearchBoxControl();
 
         void SearchMatch(const bool goForward);
+        Windows::Foundation::IAsyncOperation<uint32_t> SearchInBackground(const winrt::hstring& text, const bool caseSensitive);
 
         bool SearchBoxEditInFocus() const;
 
@@ -274,8 +275,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void _UpdateSettingsFromUIThread();
         void _UpdateAppearanceFromUIThread(Control::IControlAppearance newAppearance);
+        void _ApplyAppearanceToXaml(const Control::IControlAppearance& newAppearance);
         void _ApplyUISettings();
         winrt::fire_and_forget UpdateAppearance(Control::IControlAppearance newAppearance);
+        static Windows::UI::Xaml::Media::Imaging::BitmapImage _GetSharedBackgroundImage(const Windows::Foundation::Uri& imageUri);
         void _SetBackgroundImage(const IControlAppearance& newAppearance);
 
         void _InitializeBackgroundBrush();
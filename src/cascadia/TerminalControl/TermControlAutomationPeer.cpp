@@ -138,9 +138,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             return;
         }
+        // Coalesce: if an event is already queued on the UI thread, it'll cover this change too.
+        if (_selectionChangedPending.exchange(true, std::memory_order_relaxed))
+        {
+            return;
+        }
         dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }]() {
             if (auto strongThis{ weakThis.get() })
             {
+                strongThis->_selectionChangedPending.store(false, std::memory_order_relaxed);
                 if (auto control{ strongThis->_termControl.get() })
                 {
                     // The event that is raised when the text selection is modified.
@@ -164,9 +170,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             return;
         }
+        // Coalesce: if an event is already queued on the UI thread, it'll cover this change too.
+        if (_textChangedPending.exchange(true, std::memory_order_relaxed))
+        {
+            return;
+        }
         dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }]() {
             if (auto strongThis{ weakThis.get() })
             {
+                strongThis->_textChangedPending.store(false, std::memory_order_relaxed);
                 if (auto control{ strongThis->_termControl.get() })
                 {
                     // The event that is raised when textual content is modified.
@@ -190,9 +202,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
             return;
         }
+        // Coalesce: if an event is already queued on the UI thread, it'll cover this change too.
+        if (_cursorChangedPending.exchange(true, std::memory_order_relaxed))
+        {
+            return;
+        }
         dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }]() {
             if (auto strongThis{ weakThis.get() })
             {
+                strongThis->_cursorChangedPending.store(false, std::memory_order_relaxed);
                 if (auto control{ strongThis->_termControl.get() })
                 {
                     // The event that is raised when the text was changed in an edit control.
@@ -248,21 +266,42 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
+        // Streaming output produces a notification every frame. Instead of queueing one
+        // UI thread callback per frame, we accumulate the output until the UI thread
+        // gets around to raising it. Only the first append after a flush dispatches.
+        {
+            auto queuedOutput = _queuedOutput.lock();
+            const auto wasEmpty = queuedOutput->empty();
+            queuedOutput->append(sanitized);
+            if (!wasEmpty)
+            {
+                return;
+            }
+        }
+
         // IMPORTANT:
-        // [1] make sure the scope returns a copy of "sanitized" so that it isn't accidentally deleted
+        // [1] make sure the scope takes the queued output out of the member, so that it isn't accidentally deleted
         // [2] AutomationNotificationProcessing::All --> ensures it can be interrupted by keyboard events
         // [3] Do not "RunAsync(...).get()". For whatever reason, this causes NVDA to just not receive "SignalTextChanged()"'s events.
-        dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }, sanitizedCopy{ hstring{ sanitized } }]() {
+        dispatcher.RunAsync(Windows::UI::Core::CoreDispatcherPriority::Normal, [weakThis{ get_weak() }]() {
             if (auto strongThis{ weakThis.get() })
             {
+                const auto output = std::exchange(*strongThis->_queuedOutput.lock(), std::wstring{});
                 if (auto control{ strongThis->_termControl.get() })
                 {
                     try
                     {
-                        strongThis->RaiseNotificationEvent(AutomationNotificationKind::ActionCompleted,
-                                                           AutomationNotificationProcessing::All,
-                                                           sanitizedCopy,
-                                                           L"TerminalTextOutput");
+                        // The speech API is limited to 1000 characters at a time.
+                        // The coalesced output may exceed that, so split it up again.
+                        static constexpr size_t sapiLimit{ 1000 };
+                        const std::wstring_view outputView{ output };
+                        for (size_t offset = 0; offset < outputView.size(); offset += sapiLimit)
+                        {
+                            strongThis->RaiseNotificationEvent(AutomationNotificationKind::ActionCompleted,
+                                                               AutomationNotificationProcessing::All,
+                                                               hstring{ outputView.substr(offset, sapiLimit) },
+                                                               L"TerminalTextOutput");
+                        }
                     }
                     CATCH_LOG();
                 }
@@ -82,5 +82,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::weak_ref<Microsoft::Terminal::Control::implementation::TermControl> _termControl;
         Control::InteractivityAutomationPeer _contentAutomationPeer;
         til::shared_mutex<std::deque<wchar_t>> _keyEvents;
+
+        // Used to coalesce the UIA events raised on the UI thread, see Signal*/NotifyNewOutput.
+        til::shared_mutex<std::wstring> _queuedOutput;
+        std::atomic<bool> _selectionChangedPending{ false };
+        std::atomic<bool> _textChangedPending{ false };
+        std::atomic<bool> _cursorChangedPending{ false };
     };
 }
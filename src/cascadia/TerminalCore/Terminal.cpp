@@ -3,11 +3,14 @@
 
 #include "pch.h"
 #include "Terminal.hpp"
+#include "tracing.hpp"
 #include "../../terminal/adapter/adaptDispatch.hpp"
 #include "../../terminal/parser/OutputStateMachineEngine.hpp"
 #include "../../inc/unicode.hpp"
 #include "../../types/inc/utils.hpp"
 #include "../../types/inc/colorTable.hpp"
+#include "../../types/inc/LockProfiler.hpp"
+#include "../../buffer/out/BufferSnapshot.hpp"
 #include "../../buffer/out/search.h"
 #include "../../buffer/out/UTextAdapter.h"
 
@@ -24,8 +27,12 @@ using namespace Microsoft::Console::VirtualTerminal;
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
 #pragma warning(suppress : 26455) // default constructor is throwing, too much effort to rearrange at this time.
+// Reports the wait and hold times of _readWriteLock when tracing with TIL_KEYWORD_LOCKS.
+static Microsoft::Console::Types::EtwLockProfiler s_readWriteLockProfiler{ g_hCTerminalCoreProvider, "Terminal" };
+
 Terminal::Terminal()
 {
+    _readWriteLock.set_profiler(&s_readWriteLockProfiler);
     _renderSettings.SetColorAlias(ColorAlias::DefaultForeground, TextColor::DEFAULT_FOREGROUND, RGB(255, 255, 255));
     _renderSettings.SetColorAlias(ColorAlias::DefaultBackground, TextColor::DEFAULT_BACKGROUND, RGB(0, 0, 0));
 }
@@ -980,22 +987,28 @@ WORD Terminal::_TakeVirtualKeyFromLastKeyEvent(const WORD scanCode) noexcept
 
 // Method Description:
 // - Acquire a read lock on the terminal.
+// Arguments:
+// - site - The caller, as reported to the lock profiler.
 // Return Value:
 // - a shared_lock which can be used to unlock the terminal. The shared_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForReading()
+[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForReading(const std::source_location& site)
 {
-    return std::unique_lock{ _readWriteLock };
+    _readWriteLock.lock(site);
+    return std::unique_lock{ _readWriteLock, std::adopt_lock };
 }
 
 // Method Description:
 // - Acquire a write lock on the terminal.
+// Arguments:
+// - site - The caller, as reported to the lock profiler.
 // Return Value:
 // - a unique_lock which can be used to unlock the terminal. The unique_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForWriting()
+[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForWriting(const std::source_location& site)
 {
-    return std::unique_lock{ _readWriteLock };
+    _readWriteLock.lock(site);
+    return std::unique_lock{ _readWriteLock, std::adopt_lock };
 }
 
 // Method Description:
@@ -1209,9 +1222,143 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock()
 {
+    const auto& buffer = _activeBuffer();
+    const PatternsState state{
+        .buffer = &buffer,
+        .mutationId = buffer.GetLastMutationId(),
+        .rotationCount = buffer.GetRotationCount(),
+        .visibleStart = _VisibleStartIndex(),
+        .visibleEnd = _VisibleEndIndex(),
+    };
+
+    const auto beg = state.visibleStart;
+    const auto end = state.visibleEnd;
+    const auto rowCount = gsl::narrow_cast<size_t>(std::max(0, end - beg + 1));
+    const auto sameBuffer = _patternsState.buffer == state.buffer;
+    const auto rotations = state.rotationCount - _patternsState.rotationCount;
+
+    // This gets called after every bit of output, but the visible rows often stay the same,
+    // for instance if only the cursor moved or if we're scrolled up into the history.
+    if (sameBuffer &&
+        rotations == 0 &&
+        _patternsState.visibleStart == beg &&
+        _patternsState.visibleEnd == end &&
+        buffer.GetFirstRowMutatedSince(_patternsState.mutationId, beg, end + 1) > end)
+    {
+        return;
+    }
+
+    // rescan[i] is true if row beg+i has changed since the last time. If the previous results are for the
+    // same buffer we only need to search through those rows. NotifyBufferRotation() already moved the results
+    // up together with the text, but in case we missed a rotation, we can still fix them up here.
+    std::vector<bool> rescan(rowCount, true);
+    PointTree::interval_vector intervals;
+
+    if (sameBuffer && rowCount != 0 && rotations < gsl::narrow_cast<uint64_t>(buffer.TotalRowCount()))
+    {
+        const auto shift = gsl::narrow_cast<til::CoordType>(rotations);
+        const auto oldBeg = _patternsState.visibleStart - shift;
+        const auto oldEnd = _patternsState.visibleEnd - shift;
+
+        for (auto y = std::max(beg, oldBeg); y <= std::min(end, oldEnd); ++y)
+        {
+            rescan[gsl::narrow_cast<size_t>(y - beg)] = buffer.IsRowMutatedSince(y, _patternsState.mutationId);
+        }
+
+        // Matches at the edges of the previous range may have been cut off.
+        if (oldBeg != beg)
+        {
+            rescan.front() = true;
+        }
+        if (oldEnd != end)
+        {
+            rescan.back() = true;
+        }
+
+        _patternIntervalTree.visit_all([&](const PointTree::interval& interval) {
+            intervals.emplace_back(til::point{ interval.start.x, interval.start.y - shift }, til::point{ interval.stop.x, interval.stop.y - shift }, interval.value);
+        });
+    }
+
+    // A change in one row can affect the matches in other rows for two reasons:
+    // * A match depends on the character before it (\b), which may be at the end of the previous row.
+    // * Matches can continue in the next row. Since patterns cannot match whitespace,
+    //   this can only happen if there's non-whitespace on both sides of the row boundary.
+    // dirty is the set of rows that we need to search through, which accounts for both.
+    const auto isJoinedWithNext = [&](const til::CoordType y) {
+        const auto upper = buffer.GetRowByOffset(y).GetText();
+        const auto lower = buffer.GetRowByOffset(y + 1).GetText();
+        return !upper.empty() && !lower.empty() && upper.back() != L' ' && lower.front() != L' ';
+    };
+
+    auto dirty = rescan;
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        if (rescan[i])
+        {
+            if (i > 0)
+            {
+                dirty[i - 1] = true;
+            }
+            if (i + 1 < rowCount)
+            {
+                dirty[i + 1] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i + 1 < rowCount; ++i)
+    {
+        if (dirty[i] && !dirty[i + 1] && isJoinedWithNext(beg + gsl::narrow_cast<til::CoordType>(i)))
+        {
+            dirty[i + 1] = true;
+        }
+    }
+    for (auto i = rowCount; i > 1; --i)
+    {
+        if (dirty[i - 1] && !dirty[i - 2] && isJoinedWithNext(beg + gsl::narrow_cast<til::CoordType>(i - 2)))
+        {
+            dirty[i - 2] = true;
+        }
+    }
+
+    // The previous results for the remaining rows are still accurate.
+    const auto isDirty = [&](const til::CoordType y) {
+        return y < beg || y > end || dirty[gsl::narrow_cast<size_t>(y - beg)];
+    };
+    intervals.erase(std::remove_if(intervals.begin(), intervals.end(), [&](const PointTree::interval& interval) {
+                        for (auto y = interval.start.y; y <= interval.stop.y; ++y)
+                        {
+                            if (isDirty(y))
+                            {
+                                return true;
+                            }
+                        }
+                        return false;
+                    }),
+                    intervals.end());
+
+    for (size_t i = 0; i < rowCount;)
+    {
+        if (!dirty[i])
+        {
+            ++i;
+            continue;
+        }
+
+        auto last = i;
+        while (last + 1 < rowCount && dirty[last + 1])
+        {
+            ++last;
+        }
+
+        _appendPatterns(beg + gsl::narrow_cast<til::CoordType>(i), beg + gsl::narrow_cast<til::CoordType>(last), intervals);
+        i = last + 1;
+    }
+
     _InvalidatePatternTree(_patternIntervalTree);
-    _patternIntervalTree = _getPatterns(_VisibleStartIndex(), _VisibleEndIndex());
+    _patternIntervalTree = PointTree{ std::move(intervals) };
     _InvalidatePatternTree(_patternIntervalTree);
+    _patternsState = state;
 }
 
 // Method Description:
@@ -1220,11 +1367,78 @@ void Terminal::UpdatePatternsUnderLock()
 //   visible region is changing
 void Terminal::ClearPatternTree()
 {
-    auto oldTree = _patternIntervalTree;
+    // This is called on every scroll, so move the tree out instead of copying it.
+    auto oldTree = std::move(_patternIntervalTree);
     _patternIntervalTree = {};
+    _patternsState = {};
     _InvalidatePatternTree(oldTree);
 }
 
+// Method Description:
+// - Reduces the memory usage of a terminal that isn't visible at the moment. The scrollback
+//   gets compressed and decommitted (see TextBuffer::TrimWorkingSet()) and the spare alternate
+//   buffer is released, as recreating it is cheap compared to keeping it around indefinitely.
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+void Terminal::TrimMemory()
+{
+    // The alternate buffer is only as large as the viewport and so there's nothing to trim.
+    _mainBuffer->TrimWorkingSet(_inAltBuffer() ? _mutableViewport.Top() : _VisibleStartIndex());
+    _spareAltBuffer.reset();
+}
+
+// Method Description:
+// - Returns the memory used by the main, alternate and spare alternate buffers combined.
+// - INVARIANT: this function can only be called if the caller has the reading lock on the terminal
+TextBufferMemoryUsage Terminal::GetMemoryUsage() const noexcept
+{
+    auto usage = _mainBuffer->GetMemoryUsage();
+    for (const auto& buffer : { _altBuffer.get(), _spareAltBuffer.get() })
+    {
+        if (buffer)
+        {
+            usage += buffer->GetMemoryUsage();
+        }
+    }
+    return usage;
+}
+
+// Method Description:
+// - Captures the rows of the main buffer that haven't been saved to the given snapshot yet.
+//   The alternate buffer is never saved, as the application that owns it won't be around
+//   when the snapshot gets restored.
+// - INVARIANT: this function can only be called if the caller has the reading lock on the terminal
+// Arguments:
+// - snapshot: The snapshot to capture the rows into.
+// - final: If true, the rows in the viewport are captured too. See BufferSnapshot::CaptureFinal().
+void Terminal::CaptureBufferSnapshot(BufferSnapshot& snapshot, const bool final) const
+{
+    if (final)
+    {
+        snapshot.CaptureFinal(*_mainBuffer, _mutableViewport.Top());
+    }
+    else
+    {
+        snapshot.Capture(*_mainBuffer, _mutableViewport.Top());
+    }
+}
+
+// Method Description:
+// - Fills the main buffer with the rows of a snapshot that a previous session saved,
+//   and scrolls the viewport down to the cursor below them, as if they had been printed.
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+// Arguments:
+// - path: The path of the snapshot. Nothing happens if there's none.
+void Terminal::RestoreBufferSnapshot(const std::filesystem::path& path)
+{
+    if (BufferSnapshot::Restore(path, *_mainBuffer))
+    {
+        const auto cursorY = _mainBuffer->GetCursor().GetPosition().y;
+        const auto top = std::max(0, cursorY - _mutableViewport.Height() + 1);
+        _mutableViewport = Viewport::FromDimensions({ 0, top }, _mutableViewport.Dimensions());
+        _NotifyScrollEvent();
+    }
+}
+
 // Method Description:
 // - Returns the tab color
 // If the starting color exists, its value is preferred
@@ -1412,34 +1626,60 @@ private:
 
 static URegularExpressionInterner uregexInterner;
 
+// The patterns that we detect in the buffer. None of them can match whitespace, which UpdatePatternsUnderLock()
+// relies on. Each of them can only match text that contains its `required` string. Checking for that first
+// is a lot faster than running the regex and most rows don't contain any of them.
+struct PatternDefinition
+{
+    std::wstring_view regex;
+    std::wstring_view required;
+};
+
+static constexpr std::array patternDefinitions{
+    PatternDefinition{ LR"(\b(?:https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])", L"://" },
+};
+
 PointTree Terminal::_getPatterns(til::CoordType beg, til::CoordType end) const
 {
-    static constexpr std::array<std::wstring_view, 1> patterns{
-        LR"(\b(?:https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])",
-    };
+    PointTree::interval_vector intervals;
+    _appendPatterns(beg, end, intervals);
+    return PointTree{ std::move(intervals) };
+}
+
+// Appends the matches of all patterns in the rows [beg,end] to `intervals`.
+void Terminal::_appendPatterns(til::CoordType beg, til::CoordType end, PointTree::interval_vector& intervals) const
+{
+    const auto& buffer = _activeBuffer();
+    std::wstring haystack;
+    for (auto y = beg; y <= end; ++y)
+    {
+        haystack.append(buffer.GetRowByOffset(y).GetText());
+    }
 
-    auto text = ICU::UTextFromTextBuffer(_activeBuffer(), beg, end + 1);
+    const auto text = ICU::UTextFromTextBuffer(buffer, beg, end + 1);
     UErrorCode status = U_ZERO_ERROR;
-    PointTree::interval_vector intervals;
 
-    for (size_t i = 0; i < patterns.size(); ++i)
+    for (const auto& pattern : patternDefinitions)
     {
-        const auto re = uregexInterner.Intern(patterns.at(i));
-        uregex_setUText(re.get(), &text, &status);
+        if (haystack.find(pattern.required) == std::wstring::npos)
+        {
+            continue;
+        }
+
+        const auto re = uregexInterner.Intern(pattern.regex);
+        uregex_setUText(re.get(), text.get(), &status);
 
         if (uregex_find(re.get(), -1, &status))
         {
             do
             {
-                auto range = ICU::BufferRangeFromMatch(&text, re.get());
+                auto range = ICU::BufferRangeFromMatch(text.get(), re.get());
                 // PointTree uses half-open ranges.
                 range.end.x++;
                 intervals.push_back(PointTree::interval(range.start, range.end, 0));
             } while (uregex_findNext(re.get(), &status));
         }
     }
-
-    return PointTree{ std::move(intervals) };
 }
 
 // NOTE: This is the version of AddMark that comes from the UI. The VT api call into this too.
@@ -35,6 +35,8 @@ namespace Microsoft::Console::VirtualTerminal
     class AdaptDispatch;
 }
 
+class BufferSnapshot;
+
 namespace Microsoft::Terminal::Core
 {
     class Terminal;
@@ -100,8 +102,8 @@ public:
     // WritePastedText comes from our input and goes back to the PTY's input channel
     void WritePastedText(std::wstring_view stringView);
 
-    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForReading();
-    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForWriting();
+    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForReading(const std::source_location& site = std::source_location::current());
+    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForWriting(const std::source_location& site = std::source_location::current());
     til::recursive_ticket_lock_suspension SuspendLock() noexcept;
 
     til::CoordType GetBufferHeight() const noexcept;
@@ -206,6 +208,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
     const std::vector<size_t> GetPatternId(const til::point location) const override;
+    bool HasPatternsInRow(const til::CoordType row) const override;
 
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
     std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
@@ -236,6 +239,11 @@ public:
     void UpdatePatternsUnderLock();
     void ClearPatternTree();
 
+    void CaptureBufferSnapshot(BufferSnapshot& snapshot, const bool final) const;
+    void TrimMemory();
+    TextBufferMemoryUsage GetMemoryUsage() const noexcept;
+    void RestoreBufferSnapshot(const std::filesystem::path& path);
+
     const std::optional<til::color> GetTabColor() const;
 
     winrt::Microsoft::Terminal::Core::Scheme GetColorScheme() const;
@@ -379,6 +387,8 @@ private:
 
     std::unique_ptr<TextBuffer> _mainBuffer;
     std::unique_ptr<TextBuffer> _altBuffer;
+    // The previous alt buffer, which is recycled by the next UseAlternateScreenBuffer() if its size still fits.
+    std::unique_ptr<TextBuffer> _spareAltBuffer;
     Microsoft::Console::Types::Viewport _mutableViewport;
     til::CoordType _scrollbackLines = 0;
     bool _detectURLs = false;
@@ -403,6 +413,17 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The state of the buffer when _patternIntervalTree was last computed, which allows
+    // UpdatePatternsUnderLock() to skip the work if none of the visible rows have changed.
+    struct PatternsState
+    {
+        const TextBuffer* buffer = nullptr;
+        uint64_t mutationId = 0;
+        uint64_t rotationCount = 0;
+        til::CoordType visibleStart = 0;
+        til::CoordType visibleEnd = 0;
+    };
+    PatternsState _patternsState;
     void _InvalidatePatternTree(const interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
@@ -448,6 +469,7 @@ private:
     TextBuffer& _activeBuffer() const noexcept;
     void _updateUrlDetection();
     interval_tree::IntervalTree<til::point, size_t> _getPatterns(til::CoordType beg, til::CoordType end) const;
+    void _appendPatterns(til::CoordType beg, til::CoordType end, interval_tree::IntervalTree<til::point, size_t>::interval_vector& intervals) const;
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
@@ -12,6 +12,8 @@ using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::VirtualTerminal;
 
+using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+
 // Note: Generate GUID using TlgGuid.exe tool
 #pragma warning(suppress : 26477) // One of the macros uses 0/NULL. We don't have control to make it nullptr.
 TRACELOGGING_DEFINE_PROVIDER(g_hCTerminalCoreProvider,
@@ -80,7 +82,15 @@ void Terminal::SetWindowTitle(const std::wstring_view title)
 {
     if (!_suppressApplicationTitle)
     {
-        _title.emplace(title);
+        // Reuse the existing buffer, since shells tend to set the title on every prompt.
+        if (_title)
+        {
+            _title->assign(title);
+        }
+        else
+        {
+            _title.emplace(title);
+        }
         _pfnTitleChanged(_title.value());
     }
 }
@@ -194,12 +204,24 @@ void Terminal::UseAlternateScreenBuffer(const TextAttribute& attrs)
 
     ClearSelection();
 
-    // Create a new alt buffer
-    _altBuffer = std::make_unique<TextBuffer>(_altBufferSize,
-                                              attrs,
-                                              cursorSize,
-                                              true,
-                                              _mainBuffer->GetRenderer());
+    // Applications like vim or less switch back and forth between the buffers all the time.
+    // Reusing the previous alt buffer saves us from allocating and committing a new one each time.
+    if (_spareAltBuffer && _spareAltBuffer->GetSize().Dimensions() == _altBufferSize)
+    {
+        _altBuffer = std::move(_spareAltBuffer);
+        _altBuffer->Recycle(attrs);
+        _altBuffer->SetAsActiveBuffer(true);
+    }
+    else
+    {
+        // Create a new alt buffer
+        _spareAltBuffer.reset();
+        _altBuffer = std::make_unique<TextBuffer>(_altBufferSize,
+                                                  attrs,
+                                                  cursorSize,
+                                                  true,
+                                                  _mainBuffer->GetRenderer());
+    }
     _mainBuffer->SetAsActiveBuffer(false);
 
     // Copy our cursor state to the new buffer's cursor
@@ -261,8 +283,9 @@ void Terminal::UseMainScreenBuffer()
     }
 
     _mainBuffer->SetAsActiveBuffer(true);
-    // destroy the alt buffer
-    _altBuffer = nullptr;
+    // Keep the alt buffer around for the next switch, which will Recycle() it.
+    _altBuffer->SetAsActiveBuffer(false);
+    _spareAltBuffer = std::move(_altBuffer);
 
     if (_deferredResize.has_value())
     {
@@ -460,11 +483,21 @@ void Terminal::NotifyBufferRotation(const int delta)
         }
     }
 
-    // manually erase our pattern intervals since the locations have changed now
-    _patternIntervalTree = {};
+    // Move our pattern intervals up together with the text, so that they remain valid
+    // until the next UpdatePatternsUnderLock(), which then only needs to update the new rows.
+    PointTree::interval_vector intervals;
+    _patternIntervalTree.visit_all([&](const PointTree::interval& interval) {
+        if (interval.start.y >= delta)
+        {
+            intervals.emplace_back(til::point{ interval.start.x, interval.start.y - delta }, til::point{ interval.stop.x, interval.stop.y - delta }, interval.value);
+        }
+    });
+    _patternIntervalTree = PointTree{ std::move(intervals) };
+    _patternsState.rotationCount += delta;
+    _patternsState.visibleStart -= delta;
+    _patternsState.visibleEnd -= delta;
 
-    auto& marks{ _activeBuffer().GetMarks() };
-    const auto hasScrollMarks = marks.size() > 0;
+    const auto hasScrollMarks = _activeBuffer().HasMarks();
     if (hasScrollMarks)
     {
         _activeBuffer().ScrollMarks(-delta);
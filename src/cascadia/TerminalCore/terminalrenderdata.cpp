@@ -123,6 +123,23 @@ const std::vector<size_t> Terminal::GetPatternId(const til::point location) cons
     return {};
 }
 
+// Method Description:
+// - Returns whether any regex pattern overlaps the given row of the viewport.
+//   This allows the renderer to skip the per-cell GetPatternId() calls for all other rows.
+// Arguments:
+// - The viewport row
+// Return value:
+// - true if GetPatternId() may return a non-empty result for any cell in the row
+bool Terminal::HasPatternsInRow(const til::CoordType row) const
+{
+    // Just like in GetPatternId(), the intervals are treated as [start, stop).
+    auto found = false;
+    _patternIntervalTree.visit_overlapping({ 1, row }, { til::CoordTypeMax, row }, [&](const auto&) {
+        found = true;
+    });
+    return found;
+}
+
 std::pair<COLORREF, COLORREF> Terminal::GetAttributeColors(const TextAttribute& attr) const noexcept
 {
     return _renderSettings.GetAttributeColors(attr);
@@ -133,7 +150,16 @@ try
 {
     std::vector<Viewport> result;
 
-    for (const auto& lineRect : _GetSelectionRects())
+    if (!IsSelectionActive())
+    {
+        return result;
+    }
+
+    // The renderer can only draw the visible rows, so there's no need to compute the
+    // rectangles for the rest of a selection that may span the entire scrollback.
+    const auto viewport = _GetVisibleViewport();
+
+    for (const auto& lineRect : _activeBuffer().GetTextRects(_selection->start, _selection->end, _blockSelection, false, viewport.Top(), viewport.BottomExclusive()))
     {
         result.emplace_back(Viewport::FromInclusive(lineRect));
     }
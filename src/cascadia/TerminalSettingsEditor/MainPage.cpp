@@ -160,15 +160,15 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
                                 }
                             }
                         }
-                        else if (const auto& profileTag{ tag.try_as<ProfileViewModel>() })
+                        else if (const auto& profileTag{ tag.try_as<Model::Profile>() })
                         {
                             if (const auto& breadcrumbProfileTag{ crumb->Tag().try_as<ProfileViewModel>() })
                             {
-                                if (profileTag->OriginalProfileGuid() == breadcrumbProfileTag->OriginalProfileGuid())
+                                if (profileTag.Guid() == breadcrumbProfileTag->OriginalProfileGuid())
                                 {
                                     // found the one that was selected before the refresh
                                     SettingsNav().SelectedItem(item);
-                                    _Navigate(*profileTag, crumb->SubPage());
+                                    _Navigate(_ProfileViewModelForNavViewItem(menuItem), crumb->SubPage());
                                     return;
                                 }
                             }
@@ -283,7 +283,7 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
             {
                 _Navigate(*navString, BreadcrumbSubPage::None);
             }
-            else if (const auto profile = clickedItemContainer.Tag().try_as<Editor::ProfileViewModel>())
+            else if (const auto profile = _ProfileViewModelForNavViewItem(clickedItemContainer.try_as<MUX::Controls::NavigationViewItem>()))
             {
                 // Navigate to a page with the given profile
                 _Navigate(profile, BreadcrumbSubPage::None);
@@ -512,17 +512,17 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
             _MoveXamlParsedNavItemsIntoItemSource();
         }
 
-        // Manually create a NavigationViewItem for each profile
-        // and keep a reference to them in a map so that we
-        // can easily modify the correct one when the associated
-        // profile changes.
+        // Manually create a NavigationViewItem for each profile. Their view models are only
+        // created once they're navigated to (see _ProfileViewModelForNavViewItem), because
+        // there may be hundreds of (generated) profiles, most of which are never looked at.
         for (const auto& profile : _settingsClone.AllProfiles())
         {
             if (!profile.Deleted())
             {
-                auto profileVM = _viewModelForProfile(profile, _settingsClone);
-                profileVM.SetupAppearances(_colorSchemesPageVM.AllColorSchemes());
-                auto navItem = _CreateProfileNavViewItem(profileVM);
+                MUX::Controls::NavigationViewItem navItem;
+                navItem.Content(box_value(profile.Name()));
+                navItem.Tag(profile);
+                navItem.Icon(IconPathConverter::IconWUX(profile.Icon()));
                 _menuItemSource.Append(navItem);
             }
         }
@@ -594,8 +594,46 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
     {
         MUX::Controls::NavigationViewItem profileNavItem;
         profileNavItem.Content(box_value(profile.Name()));
-        profileNavItem.Tag(box_value<Editor::ProfileViewModel>(profile));
         profileNavItem.Icon(IconPathConverter::IconWUX(profile.Icon()));
+        _AttachProfileViewModelToNavViewItem(profileNavItem, profile);
+        return profileNavItem;
+    }
+
+    // Method Description:
+    // - Returns the view model of the profile represented by the given NavigationViewItem.
+    //   _InitializeProfilesList only tags those items with the Model::Profile. The view
+    //   model for it is created here, the first time it's needed, and replaces the tag.
+    // Arguments:
+    // - navItem - the NavigationViewItem of a profile
+    // Return value:
+    // - the profile's view model, or null if navItem isn't the item of a profile
+    Editor::ProfileViewModel MainPage::_ProfileViewModelForNavViewItem(const MUX::Controls::NavigationViewItem& navItem)
+    {
+        if (!navItem)
+        {
+            return nullptr;
+        }
+
+        const auto tag = navItem.Tag();
+        if (const auto profileViewModel = tag.try_as<Editor::ProfileViewModel>())
+        {
+            return profileViewModel;
+        }
+
+        if (const auto profile = tag.try_as<Model::Profile>())
+        {
+            const auto profileViewModel = _viewModelForProfile(profile, _settingsClone);
+            profileViewModel.SetupAppearances(_colorSchemesPageVM.AllColorSchemes());
+            _AttachProfileViewModelToNavViewItem(navItem, profileViewModel);
+            return profileViewModel;
+        }
+
+        return nullptr;
+    }
+
+    void MainPage::_AttachProfileViewModelToNavViewItem(const MUX::Controls::NavigationViewItem& profileNavItem, const Editor::ProfileViewModel& profile)
+    {
+        profileNavItem.Tag(box_value<Editor::ProfileViewModel>(profile));
 
         // Update the menu item when the icon/name changes
         auto weakMenuItem{ make_weak(profileNavItem) };
@@ -616,8 +654,6 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
 
         // Add an event handler for when the user wants to delete a profile.
         profile.DeleteProfile({ this, &MainPage::_DeleteProfile });
-
-        return profileNavItem;
     }
 
     void MainPage::_DeleteProfile(const IInspectable /*sender*/, const Editor::DeleteProfileEventArgs& args)
@@ -645,15 +681,15 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
             // navigate to the profile next to this one
             const auto newSelectedItem{ _menuItemSource.GetAt(index < _menuItemSource.Size() - 1 ? index : index - 1) };
             SettingsNav().SelectedItem(newSelectedItem);
-            const auto newTag = newSelectedItem.as<MUX::Controls::NavigationViewItem>().Tag();
-            if (const auto profileViewModel = newTag.try_as<ProfileViewModel>())
+            const auto newSelectedNavItem = newSelectedItem.as<MUX::Controls::NavigationViewItem>();
+            if (const auto profileViewModel = _ProfileViewModelForNavViewItem(newSelectedNavItem))
             {
-                profileViewModel->FocusDeleteButton(true);
-                _Navigate(*profileViewModel, BreadcrumbSubPage::None);
+                profileViewModel.FocusDeleteButton(true);
+                _Navigate(profileViewModel, BreadcrumbSubPage::None);
             }
             else
             {
-                _Navigate(newTag.as<hstring>(), BreadcrumbSubPage::None);
+                _Navigate(newSelectedNavItem.Tag().as<hstring>(), BreadcrumbSubPage::None);
             }
         }
     }
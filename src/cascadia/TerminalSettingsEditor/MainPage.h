@@ -61,6 +61,8 @@ namespace winrt::Microsoft::Terminal::Settings::Editor::implementation
         void _InitializeProfilesList();
         void _CreateAndNavigateToNewProfile(const uint32_t index, const Model::Profile& profile);
         winrt::Microsoft::UI::Xaml::Controls::NavigationViewItem _CreateProfileNavViewItem(const Editor::ProfileViewModel& profile);
+        Editor::ProfileViewModel _ProfileViewModelForNavViewItem(const winrt::Microsoft::UI::Xaml::Controls::NavigationViewItem& navItem);
+        void _AttachProfileViewModelToNavViewItem(const winrt::Microsoft::UI::Xaml::Controls::NavigationViewItem& profileNavItem, const Editor::ProfileViewModel& profile);
         void _DeleteProfile(const Windows::Foundation::IInspectable sender, const Editor::DeleteProfileEventArgs& args);
         void _AddProfileHandler(const winrt::guid profileGuid);
 
@@ -314,6 +314,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         ACTION_ARG(winrt::hstring, ColorScheme);
         ACTION_ARG(Windows::Foundation::IReference<bool>, Elevate, nullptr);
         ACTION_ARG(uint64_t, ContentId);
+        ACTION_ARG(winrt::guid, SessionId);
 
         static constexpr std::string_view CommandlineKey{ "commandline" };
         static constexpr std::string_view StartingDirectoryKey{ "startingDirectory" };
@@ -326,6 +327,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         static constexpr std::string_view ColorSchemeKey{ "colorScheme" };
         static constexpr std::string_view ElevateKey{ "elevate" };
         static constexpr std::string_view ContentKey{ "__content" };
+        static constexpr std::string_view SessionIdKey{ "sessionId" };
 
     public:
         hstring GenerateName() const;
@@ -346,7 +348,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
                        otherAsUs->_SuppressApplicationTitle == _SuppressApplicationTitle &&
                        otherAsUs->_ColorScheme == _ColorScheme &&
                        otherAsUs->_Elevate == _Elevate &&
-                       otherAsUs->_ContentId == _ContentId;
+                       otherAsUs->_ContentId == _ContentId &&
+                       otherAsUs->_SessionId == _SessionId;
             }
             return false;
         };
@@ -364,6 +367,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             JsonUtils::GetValueForKey(json, ColorSchemeKey, args->_ColorScheme);
             JsonUtils::GetValueForKey(json, ElevateKey, args->_Elevate);
             JsonUtils::GetValueForKey(json, ContentKey, args->_ContentId);
+            JsonUtils::GetValueForKey(json, SessionIdKey, args->_SessionId);
             return *args;
         }
         static Json::Value ToJson(const Model::NewTerminalArgs& val)
@@ -384,6 +388,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             JsonUtils::SetValueForKey(json, ColorSchemeKey, args->_ColorScheme);
             JsonUtils::SetValueForKey(json, ElevateKey, args->_Elevate);
             JsonUtils::SetValueForKey(json, ContentKey, args->_ContentId);
+            JsonUtils::SetValueForKey(json, SessionIdKey, args->_SessionId);
             return json;
         }
         Model::NewTerminalArgs Copy() const
@@ -399,6 +404,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             copy->_ColorScheme = _ColorScheme;
             copy->_Elevate = _Elevate;
             copy->_ContentId = _ContentId;
+            copy->_SessionId = _SessionId;
             return *copy;
         }
         size_t Hash() const
@@ -419,6 +425,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             h.write(ColorScheme());
             h.write(Elevate());
             h.write(ContentId());
+            h.write(SessionId());
         }
     };
 }
@@ -69,7 +69,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     private:
         struct JsonSettings
         {
-            Json::Value root;
+            // Shared with SettingsLoader's cache of parsed JSON. Don't modify it.
+            std::shared_ptr<const Json::Value> root;
             const Json::Value& colorSchemes;
             const Json::Value& profileDefaults;
             const Json::Value& profilesList;
@@ -79,6 +80,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         static std::pair<size_t, size_t> _lineAndColumnFromPosition(const std::string_view& string, const size_t position);
         static void _rethrowSerializationExceptionWithLocationInfo(const JsonUtils::DeserializationError& e, const std::string_view& settingsString);
         static Json::Value _parseJSON(const std::string_view& content);
+        static std::shared_ptr<const Json::Value> _parseJSONCached(const std::string_view& content);
         static const Json::Value& _getJSONValue(const Json::Value& json, const std::string_view& key) noexcept;
         std::span<const winrt::com_ptr<implementation::Profile>> _getNonUserOriginProfiles() const;
         void _parse(const OriginTag origin, const winrt::hstring& source, const std::string_view& content, ParsedSettings& settings);
@@ -87,7 +89,17 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         static winrt::com_ptr<implementation::Profile> _parseProfile(const OriginTag origin, const winrt::hstring& source, const Json::Value& profileJson);
         void _appendProfile(winrt::com_ptr<Profile>&& profile, const winrt::guid& guid, ParsedSettings& settings);
         void _addUserProfileParent(const winrt::com_ptr<implementation::Profile>& profile);
-        void _executeGenerator(const IDynamicProfileGenerator& generator);
+        struct GeneratorResult
+        {
+            std::vector<winrt::com_ptr<Profile>> profiles;
+            // The generator's new entry for the "generatedProfilesCache" in state.json.
+            // It's null if the generator doesn't support caching or failed.
+            std::string cacheName;
+            Json::Value cacheEntry;
+        };
+
+        static bool _loadCachedProfiles(const Json::Value& cacheEntry, const std::string_view& cacheKey, const winrt::hstring& source, std::vector<winrt::com_ptr<Profile>>& profiles);
+        GeneratorResult _executeGenerator(const IDynamicProfileGenerator& generator, const Json::Value& cache) const;
 
         std::unordered_set<std::wstring_view> _ignoredNamespaces;
         // See _getNonUserOriginProfiles().
@@ -6,6 +6,7 @@
 
 #include <LibraryResources.h>
 #include <fmt/chrono.h>
+#include <future>
 #include <shlobj.h>
 #include <til/latch.h>
 
@@ -162,13 +163,61 @@ SettingsLoader::SettingsLoader(const std::string_view& userJSON, const std::stri
 // (meaning profiles specified by the application rather by the user).
 void SettingsLoader::GenerateProfiles()
 {
-    _executeGenerator(PowershellCoreProfileGenerator{});
-    _executeGenerator(WslDistroGenerator{});
-    _executeGenerator(AzureCloudShellGenerator{});
-    _executeGenerator(VisualStudioGenerator{});
+    // The generators probe unrelated parts of the system (the registry, the package manager,
+    // the Visual Studio setup COM server, the file system, ...) and some of them are slow.
+    // They don't depend on each other, so we run them concurrently. Their results are
+    // appended in the order below, which keeps the profile list stable between launches.
+    //
+    // On top of that, generators that can cheaply tell whether their results changed
+    // (see IDynamicProfileGenerator::GetCacheKey) get their profiles from state.json.
+    // The cache is discarded whenever the application version changes,
+    // because the generators themselves might have changed.
+    const auto& state = winrt::get_self<ApplicationState>(ApplicationState::SharedInstance());
+    const auto applicationVersion = til::u16u8(CascadiaSettings::ApplicationVersion());
+    const auto previousCache = state->GeneratedProfilesCache();
+    Json::Value previousGenerators;
+    if (previousCache.isObject() && previousCache.get("version", Json::Value{}) == applicationVersion)
+    {
+        previousGenerators = previousCache.get("generators", Json::Value{});
+    }
+
+    const auto launch = [this, &previousGenerators](auto generator) {
+        return std::async(std::launch::async, [this, &previousGenerators, generator = std::move(generator)]() {
+            return _executeGenerator(generator, previousGenerators);
+        });
+    };
+
+    std::future<GeneratorResult> results[] = {
+        launch(PowershellCoreProfileGenerator{}),
+        launch(WslDistroGenerator{}),
+        launch(AzureCloudShellGenerator{}),
+        launch(VisualStudioGenerator{}),
 #if TIL_FEATURE_DYNAMICSSHPROFILES_ENABLED
-    _executeGenerator(SshHostGenerator{});
+        launch(SshHostGenerator{}),
 #endif
+    };
+
+    Json::Value generators{ Json::objectValue };
+
+    for (auto& future : results)
+    {
+        auto result = future.get();
+        inboxSettings.profiles.insert(inboxSettings.profiles.end(), std::make_move_iterator(result.profiles.begin()), std::make_move_iterator(result.profiles.end()));
+
+        if (!result.cacheEntry.isNull())
+        {
+            generators[result.cacheName] = std::move(result.cacheEntry);
+        }
+    }
+
+    Json::Value cache{ Json::objectValue };
+    cache["version"] = applicationVersion;
+    cache["generators"] = std::move(generators);
+
+    if (cache != previousCache)
+    {
+        state->GeneratedProfilesCache(cache);
+    }
 }
 
 // A new settings.json gets a special treatment:
@@ -341,7 +390,7 @@ void SettingsLoader::FinalizeLayering()
     if (userSettings.globals->EnableColorSelection())
     {
         const auto json = _parseJson(EnableColorSelectionSettingsJson);
-        const auto globals = GlobalAppSettings::FromJson(json.root);
+        const auto globals = GlobalAppSettings::FromJson(*json.root);
         userSettings.globals->AddLeastImportantParent(globals);
     }
 
@@ -557,7 +606,7 @@ void SettingsLoader::_parse(const OriginTag origin, const winrt::hstring& source
     settings.clear();
 
     {
-        settings.globals = GlobalAppSettings::FromJson(json.root);
+        settings.globals = GlobalAppSettings::FromJson(*json.root);
 
         for (const auto& schemeJson : json.colorSchemes)
         {
@@ -683,12 +732,56 @@ void SettingsLoader::_parseFragment(const winrt::hstring& source, const std::str
     }
 }
 
+// Every settings reload parses all inputs again, even though most of them didn't change.
+// defaults.json in particular never changes and is by far the largest one.
+// This caches the parsed JSON by the content it was parsed from, for the lifetime of the process.
+std::shared_ptr<const Json::Value> SettingsLoader::_parseJSONCached(const std::string_view& content)
+{
+    struct TransparentHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const std::string_view& str) const noexcept
+        {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+    using Cache = std::unordered_map<std::string, std::shared_ptr<const Json::Value>, TransparentHash, std::equal_to<>>;
+
+    // A settings load consists of defaults.json, settings.json, the color selection
+    // actions and the fragments. Once we exceed this limit the cache is flushed,
+    // which takes care of dropping the stale entries of edited files.
+    static constexpr size_t maxEntries = 32;
+    static til::shared_mutex<Cache> cache;
+
+    {
+        const auto guard = cache.lock_shared();
+        if (const auto it = guard->find(content); it != guard->end())
+        {
+            return it->second;
+        }
+    }
+
+    auto json = std::make_shared<const Json::Value>(_parseJSON(content));
+
+    {
+        auto guard = cache.lock();
+        if (guard->size() >= maxEntries)
+        {
+            guard->clear();
+        }
+        guard->emplace(content, json);
+    }
+
+    return json;
+}
+
 SettingsLoader::JsonSettings SettingsLoader::_parseJson(const std::string_view& content)
 {
-    auto root = content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content);
-    const auto& colorSchemes = _getJSONValue(root, SchemesKey);
-    const auto& themes = _getJSONValue(root, ThemesKey);
-    const auto& profilesObject = _getJSONValue(root, ProfilesKey);
+    auto root = content.empty() ? std::make_shared<const Json::Value>(Json::ValueType::objectValue) : _parseJSONCached(content);
+    const auto& colorSchemes = _getJSONValue(*root, SchemesKey);
+    const auto& themes = _getJSONValue(*root, ThemesKey);
+    const auto& profilesObject = _getJSONValue(*root, ProfilesKey);
     const auto& profileDefaults = _getJSONValue(profilesObject, DefaultSettingsKey);
     const auto& profilesList = profilesObject.isArray() ? profilesObject : _getJSONValue(profilesObject, ProfilesListKey);
     return JsonSettings{ std::move(root), colorSchemes, profileDefaults, profilesList, themes };
@@ -781,35 +874,105 @@ void SettingsLoader::_addUserProfileParent(const winrt::com_ptr<implementation::
 }
 
 // As the name implies it executes a generator.
-// Generated profiles are added to .inboxSettings. Used by GenerateProfiles().
-void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator)
+// Parses the profiles of a "generatedProfilesCache" entry, if its key matches the given one.
+// Returns false if the entry is stale or can't be parsed, in which case the generator must run.
+bool SettingsLoader::_loadCachedProfiles(const Json::Value& cacheEntry, const std::string_view& cacheKey, const winrt::hstring& source, std::vector<winrt::com_ptr<Profile>>& profiles)
+try
 {
+    if (!cacheEntry.isObject() || cacheEntry.get("key", Json::Value{}) != std::string{ cacheKey })
+    {
+        return false;
+    }
+
+    const auto& profilesJson = cacheEntry.get("profiles", Json::Value{});
+    if (!profilesJson.isArray())
+    {
+        return false;
+    }
+
+    for (const auto& profileJson : profilesJson)
+    {
+        profiles.emplace_back(_parseProfile(OriginTag::Generated, source, profileJson));
+    }
+    return true;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    profiles.clear();
+    return false;
+}
+
+// Returns the generated profiles, which GenerateProfiles() adds to .inboxSettings.
+// `cache` is the "generators" object of the "generatedProfilesCache" in state.json.
+// This is called on a background thread and must not modify the loader.
+SettingsLoader::GeneratorResult SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator, const Json::Value& cache) const
+{
+    GeneratorResult result;
+
     const auto generatorNamespace = generator.GetNamespace();
     if (_ignoredNamespaces.count(generatorNamespace))
     {
-        return;
+        return result;
     }
 
-    const auto previousSize = inboxSettings.profiles.size();
+    const winrt::hstring source{ generatorNamespace };
+    result.cacheName = til::u16u8(generatorNamespace);
+
+    std::string cacheKey;
+    auto fromCache = false;
+    auto succeeded = false;
 
     try
     {
-        generator.GenerateProfiles(inboxSettings.profiles);
+        // Some generators talk to COM servers (for instance VsSetupConfiguration).
+        const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+
+        cacheKey = til::u16u8(generator.GetCacheKey());
+        if (!cacheKey.empty() && cache.isObject())
+        {
+            fromCache = _loadCachedProfiles(cache.get(result.cacheName, Json::Value{}), cacheKey, source, result.profiles);
+        }
+
+        if (!fromCache)
+        {
+            generator.GenerateProfiles(result.profiles);
+        }
+
+        succeeded = true;
     }
     CATCH_LOG_MSG("Dynamic Profile Namespace: \"%.*s\"", gsl::narrow<int>(generatorNamespace.size()), generatorNamespace.data())
 
     // If the generator produced some profiles we're going to give them default attributes.
     // By setting the Origin/Source/etc. here, we deduplicate some code and ensure they aren't missing accidentally.
-    if (inboxSettings.profiles.size() > previousSize)
+    for (const auto& profile : result.profiles)
     {
-        const winrt::hstring source{ generatorNamespace };
+        profile->Origin(OriginTag::Generated);
+        profile->Source(source);
+    }
 
-        for (const auto& profile : std::span(inboxSettings.profiles).subspan(previousSize))
+    // Don't cache the results of a generator that failed half-way through.
+    if (succeeded && !cacheKey.empty())
+    {
+        if (fromCache)
         {
-            profile->Origin(OriginTag::Generated);
-            profile->Source(source);
+            result.cacheEntry = cache[result.cacheName];
+        }
+        else
+        {
+            Json::Value profilesJson{ Json::arrayValue };
+            for (const auto& profile : result.profiles)
+            {
+                profilesJson.append(profile->ToJson());
+            }
+
+            result.cacheEntry = Json::Value{ Json::objectValue };
+            result.cacheEntry["key"] = cacheKey;
+            result.cacheEntry["profiles"] = std::move(profilesJson);
         }
     }
+
+    return result;
 }
 
 // Method Description:
@@ -28,3 +28,21 @@ winrt::com_ptr<winrt::Microsoft::Terminal::Settings::Model::implementation::Prof
     profile->Icon(winrt::hstring{ iconPath });
     return profile;
 }
+
+// Method Description:
+// - Helper function for IDynamicProfileGenerator::GetCacheKey(). Appends the path
+//   and its last write time to the key. Missing paths are recorded as well,
+//   so that the key changes once they get created.
+// Arguments:
+// - key: the cache key to append to.
+// - path: the file or directory to inspect.
+void AppendLastWriteTimeToCacheKey(std::wstring& key, const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto lastWriteTime = std::filesystem::last_write_time(path, ec);
+
+    key.append(path.native());
+    key.push_back(L'=');
+    key.append(ec ? L"-" : std::to_wstring(lastWriteTime.time_since_epoch().count()));
+    key.push_back(L';');
+}
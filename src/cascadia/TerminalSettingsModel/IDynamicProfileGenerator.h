@@ -13,6 +13,10 @@ Abstract:
 - Each DPG must have a unique namespace to associate with itself. If the
   namespace is not unique, the generator risks affecting profiles from
   conflicting generators.
+- A DPG whose discovery is expensive can return a cache key, which must be cheap
+  to compute and change whenever GenerateProfiles() would return something else.
+  If the key matches the one stored in state.json, the cached profiles are used
+  instead of running the generator.
 
 Author(s):
 - Mike Griese - August 2019
@@ -31,5 +35,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model
         virtual ~IDynamicProfileGenerator() = default;
         virtual std::wstring_view GetNamespace() const noexcept = 0;
         virtual void GenerateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const = 0;
+        // An empty key disables caching.
+        virtual std::wstring GetCacheKey() const
+        {
+            return {};
+        }
     };
 };
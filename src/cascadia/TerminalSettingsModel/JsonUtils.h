@@ -620,6 +620,32 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
     };
 #endif
 
+    // Passes the JSON through unmodified. Used for blobs whose
+    // contents are interpreted by their consumer, like cached profiles.
+    template<>
+    struct ConversionTrait<Json::Value>
+    {
+        Json::Value FromJson(const Json::Value& json)
+        {
+            return json;
+        }
+
+        bool CanConvert(const Json::Value&)
+        {
+            return true;
+        }
+
+        Json::Value ToJson(const Json::Value& val)
+        {
+            return val;
+        }
+
+        std::string TypeDescription() const
+        {
+            return "any";
+        }
+    };
+
     template<>
     struct ConversionTrait<bool>
     {
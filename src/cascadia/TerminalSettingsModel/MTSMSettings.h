@@ -26,6 +26,10 @@ Author(s):
     X(bool, FocusFollowMouse, "focusFollowMouse", false)                                                                                                                                              \
     X(bool, ForceFullRepaintRendering, "experimental.rendering.forceFullRepaint", false)                                                                                                              \
     X(bool, SoftwareRendering, "experimental.rendering.software", false)                                                                                                                              \
+    X(bool, PixelShaderPartialRedraw, "experimental.rendering.pixelShaderPartialRedraw", false)                                                                                                       \
+    X(int32_t, PixelShaderMaxFrameRate, "experimental.rendering.pixelShaderMaxFrameRate", 0)                                                                                                          \
+    X(int32_t, MemoryBudget, "experimental.memoryBudget", 0)                                                                                                                                          \
+    X(bool, LargePageBuffers, "experimental.largePageBuffers", false)                                                                                                                                 \
     X(bool, UseBackgroundImageForWindow, "experimental.useBackgroundImageForWindow", false)                                                                                                           \
     X(bool, ReloadEnvironmentVariables, "compatibility.reloadEnvironmentVariables", true)                                                                                                             \
     X(bool, ForceVTInput, "experimental.input.forceVT", false)                                                                                                                                        \
@@ -67,7 +71,8 @@ Author(s):
     X(winrt::Windows::Foundation::Collections::IVector<Model::NewTabMenuEntry>, NewTabMenu, "newTabMenu", winrt::single_threaded_vector<Model::NewTabMenuEntry>({ Model::RemainingProfilesEntry{} })) \
     X(bool, AllowHeadless, "compatibility.allowHeadless", false)                                                                                                                                      \
     X(bool, IsolatedMode, "compatibility.isolatedMode", false)                                                                                                                                        \
-    X(hstring, SearchWebDefaultQueryUrl, "searchWebDefaultQueryUrl", L"https://www.bing.com/search?q=%22%s%22")
+    X(hstring, SearchWebDefaultQueryUrl, "searchWebDefaultQueryUrl", L"https://www.bing.com/search?q=%22%s%22")                                                                                       \
+    X(hstring, SessionRecordingDirectory, "experimental.sessionRecordingDirectory", L"")
 
 // Also add these settings to:
 // * Profile.idl
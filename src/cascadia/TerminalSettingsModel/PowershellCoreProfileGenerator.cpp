@@ -338,6 +338,42 @@ void PowershellCoreProfileGenerator::GenerateProfiles(std::vector<winrt::com_ptr
     }
 }
 
+// Method Description:
+// - Computes a key from the last write times of all the places
+//   _collectPowerShellInstances() looks at, which is considerably cheaper
+//   than enumerating them and asking the PackageManager about store packages.
+// Arguments:
+// - <none>
+// Return Value:
+// - The cache key.
+std::wstring PowershellCoreProfileGenerator::GetCacheKey() const
+{
+    std::wstring key;
+
+    AppendLastWriteTimeToCacheKey(key, wil::ExpandEnvironmentStringsW<std::wstring>(L"%ProgramFiles%\\PowerShell"));
+#if defined(_M_AMD64) || defined(_M_ARM64)
+    AppendLastWriteTimeToCacheKey(key, wil::ExpandEnvironmentStringsW<std::wstring>(L"%ProgramFiles(x86)%\\PowerShell"));
+#endif
+#if defined(_M_ARM64)
+    AppendLastWriteTimeToCacheKey(key, wil::ExpandEnvironmentStringsW<std::wstring>(L"%ProgramFiles(Arm)%\\PowerShell"));
+#endif
+
+    wil::unique_cotaskmem_string localAppDataFolder;
+    if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &localAppDataFolder)))
+    {
+        std::filesystem::path appExecAliasPath{ localAppDataFolder.get() };
+        appExecAliasPath /= L"Microsoft";
+        appExecAliasPath /= L"WindowsApps";
+        AppendLastWriteTimeToCacheKey(key, appExecAliasPath / POWERSHELL_PREVIEW_PFN);
+        AppendLastWriteTimeToCacheKey(key, appExecAliasPath / POWERSHELL_PFN);
+    }
+
+    AppendLastWriteTimeToCacheKey(key, wil::ExpandEnvironmentStringsW<std::wstring>(L"%USERPROFILE%\\.dotnet\\tools\\pwsh.exe"));
+    AppendLastWriteTimeToCacheKey(key, wil::ExpandEnvironmentStringsW<std::wstring>(L"%USERPROFILE%\\scoop\\shims\\pwsh.exe"));
+
+    return key;
+}
+
 // Function Description:
 // - Returns the thing it's named for.
 // Return value:
@@ -352,6 +352,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _FocusFollowMouse = globalSettings.FocusFollowMouse();
         _ForceFullRepaintRendering = globalSettings.ForceFullRepaintRendering();
         _SoftwareRendering = globalSettings.SoftwareRendering();
+        _PixelShaderPartialRedraw = globalSettings.PixelShaderPartialRedraw();
+        _PixelShaderMaxFrameRate = globalSettings.PixelShaderMaxFrameRate();
+        _MemoryBudget = globalSettings.MemoryBudget();
+        _LargePageBuffers = globalSettings.LargePageBuffers();
         _UseBackgroundImageForWindow = globalSettings.UseBackgroundImageForWindow();
         _ForceVTInput = globalSettings.ForceVTInput();
         _TrimBlockSelection = globalSettings.TrimBlockSelection();
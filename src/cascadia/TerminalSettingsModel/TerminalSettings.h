@@ -154,6 +154,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         INHERITABLE_SETTING(Model::TerminalSettings, bool, RetroTerminalEffect, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ForceFullRepaintRendering, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, SoftwareRendering, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, bool, PixelShaderPartialRedraw, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, PixelShaderMaxFrameRate, 0);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, MemoryBudget, 0);
+        INHERITABLE_SETTING(Model::TerminalSettings, bool, LargePageBuffers, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, UseBackgroundImageForWindow, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ForceVTInput, false);
 
@@ -30,3 +30,28 @@ void VisualStudioGenerator::GenerateProfiles(std::vector<winrt::com_ptr<implemen
         hidden = true;
     }
 }
+
+// Method Description:
+// - The Visual Studio installer keeps a state.json for every instance under
+//   %ProgramData%\Microsoft\VisualStudio\Packages\_Instances and rewrites it whenever
+//   the instance changes. Checking those is much cheaper than starting the
+//   SetupConfiguration COM server and querying every instance.
+// Arguments:
+// - <none>
+// Return Value:
+// - The cache key.
+std::wstring VisualStudioGenerator::GetCacheKey() const
+{
+    const std::filesystem::path root{ wil::ExpandEnvironmentStringsW<std::wstring>(L"%ProgramData%\\Microsoft\\VisualStudio\\Packages\\_Instances") };
+
+    std::wstring key;
+    AppendLastWriteTimeToCacheKey(key, root);
+
+    std::error_code ec;
+    for (const auto& instanceDir : std::filesystem::directory_iterator{ root, ec })
+    {
+        AppendLastWriteTimeToCacheKey(key, instanceDir.path() / L"state.json");
+    }
+
+    return key;
+}
@@ -40,6 +40,7 @@ namespace ControlUnitTests
 
         TEST_METHOD(TestSelectCommandSimple);
         TEST_METHOD(TestSelectOutputSimple);
+        TEST_METHOD(TestCommandHistory);
 
         TEST_METHOD(TestSimpleClickSelection);
 
@@ -502,6 +503,43 @@ namespace ControlUnitTests
         }
     }
 
+    void ControlCoreTests::TestCommandHistory()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+        Log::Comment(L"Create ControlCore object");
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        Log::Comment(L"Run a couple of commands");
+
+        _writePrompt(conn, L"C:\\Windows");
+        conn->WriteInput(L"Foo-bar   ");
+        conn->WriteInput(L"\x1b]133;C\x7");
+        conn->WriteInput(L"\r\n");
+        conn->WriteInput(L"This is some text     \r\n");
+
+        _writePrompt(conn, L"C:\\Windows");
+        conn->WriteInput(L"\x1b]133;C\x7");
+        conn->WriteInput(L"\r\n");
+
+        _writePrompt(conn, L"C:\\Windows");
+        conn->WriteInput(L"Boo-far");
+        conn->WriteInput(L"\x1b]133;C\x7");
+        conn->WriteInput(L"\r\n");
+
+        _writePrompt(conn, L"C:\\Windows");
+        conn->WriteInput(L"Far-boo");
+
+        Log::Comment(L"The empty command is skipped and trailing whitespace is trimmed");
+        const auto history = core->CommandHistory();
+        const auto commands = history.History();
+        VERIFY_ARE_EQUAL(2u, commands.Size());
+        VERIFY_ARE_EQUAL(L"Foo-bar", commands.GetAt(0));
+        VERIFY_ARE_EQUAL(L"Boo-far", commands.GetAt(1));
+        VERIFY_ARE_EQUAL(L"Far-boo", history.CurrentCommandline());
+    }
+
     void ControlCoreTests::TestSimpleClickSelection()
     {
         // Create a simple selection with the mouse, then click somewhere else,
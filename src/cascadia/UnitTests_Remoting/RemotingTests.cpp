@@ -1125,7 +1125,9 @@ namespace RemotingUnitTests
 
         Log::Comment(L"Rename p2");
 
-        p2->WindowName(L"foo");
+        Remoting::RenameRequestArgs eventArgs{ L"foo" };
+        p2->RequestRename(eventArgs);
+        VERIFY_IS_TRUE(eventArgs.Succeeded());
 
         VERIFY_ARE_EQUAL(0, m0->_lookupPeasantIdForName(L"two"));
         VERIFY_ARE_EQUAL(p2->GetID(), m0->_lookupPeasantIdForName(L"foo"));
@@ -53,6 +53,10 @@ class TerminalCoreUnitTests::TerminalBufferTests final
 
     TEST_METHOD(TestCursorNotifications);
 
+    TEST_METHOD(TestIncrementalPatternDetection);
+
+    TEST_METHOD(TestAltBufferReuse);
+
     TEST_METHOD_SETUP(MethodSetup)
     {
         // STEP 1: Set up the Terminal
@@ -636,3 +640,92 @@ void TerminalBufferTests::TestCursorNotifications()
     VERIFY_ARE_EQUAL(0, expectedCallbacks);
     VERIFY_IS_TRUE(callbackWasCalled);
 }
+
+void TerminalBufferTests::TestIncrementalPatternDetection()
+{
+    using Interval = interval_tree::Interval<til::point, size_t>;
+    auto& termSm = *term->_stateMachine;
+
+    const auto getIntervals = [](const interval_tree::IntervalTree<til::point, size_t>& tree) {
+        std::vector<Interval> intervals;
+        tree.visit_all([&](const Interval& interval) {
+            intervals.emplace_back(interval);
+        });
+        std::sort(intervals.begin(), intervals.end(), [](const Interval& lhs, const Interval& rhs) {
+            return lhs.start < rhs.start || (lhs.start == rhs.start && lhs.stop < rhs.stop);
+        });
+        return intervals;
+    };
+
+    // UpdatePatternsUnderLock() only searches through the changed rows,
+    // but it must produce the same results as a search through the entire viewport.
+    const auto verify = [&]() {
+        term->UpdatePatternsUnderLock();
+
+        const auto expected = getIntervals(term->_getPatterns(term->_VisibleStartIndex(), term->_VisibleEndIndex()));
+        const auto actual = getIntervals(term->_patternIntervalTree);
+
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(til::at(expected, i).start, til::at(actual, i).start);
+            VERIFY_ARE_EQUAL(til::at(expected, i).stop, til::at(actual, i).stop);
+        }
+        return actual.size();
+    };
+
+    termSm.ProcessString(L"see https://example.com/a and\r\n");
+    // This one wraps into the next row.
+    termSm.ProcessString(L"https://example.com/" + std::wstring(100, L'x') + L"\r\n");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify());
+
+    termSm.ProcessString(L"\x1b[1;5Hx");
+    VERIFY_ARE_EQUAL(size_t{ 1 }, verify());
+    termSm.ProcessString(L"\x1b[1;5Hh");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify());
+
+    // The URL in the 5th row doesn't begin at a word boundary, until the 4th row changes.
+    termSm.ProcessString(L"\x1b[4;1H" + std::wstring(80, L'a') + L"https://b.com\r\n");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify());
+    termSm.ProcessString(L"\x1b[4;80H ");
+    VERIFY_ARE_EQUAL(size_t{ 3 }, verify());
+
+    // Scroll some of the URLs out of the viewport and then rotate the buffer.
+    termSm.ProcessString(L"\x1b[6;1H");
+    for (auto i = 0; i < 28; ++i)
+    {
+        termSm.ProcessString(L"line\r\n");
+        verify();
+    }
+    for (auto i = 0; i < 200; ++i)
+    {
+        termSm.ProcessString(i % 10 ? L"line\r\n" : L"https://c.com\r\n");
+        verify();
+    }
+}
+
+void TerminalBufferTests::TestAltBufferReuse()
+{
+    auto& termSm = *term->_stateMachine;
+
+    termSm.ProcessString(L"\x1b[?1049h");
+    const auto firstAltBuffer = term->_altBuffer.get();
+    termSm.ProcessString(L"\x1b[5;5H\x1b]8;;https://example.com\x1b\\link\x1b]8;;\x1b\\\x1b[?25l");
+    termSm.ProcessString(L"\x1b[?1049l");
+    VERIFY_IS_FALSE(term->_inAltBuffer());
+
+    Log::Comment(L"Switching back should reuse the previous buffer, but present it as if it was new.");
+    termSm.ProcessString(L"\x1b[?25h\x1b[?1049h");
+    auto& altTb = *term->_altBuffer;
+    VERIFY_ARE_EQUAL(firstAltBuffer, &altTb);
+    VERIFY_IS_TRUE(altTb.IsActiveBuffer());
+    VERIFY_IS_TRUE(altTb.GetCursor().IsVisible());
+    VERIFY_IS_FALSE(altTb.GetCursor().IsDelayedEOLWrap());
+    TestUtils::VerifyExpectedString(altTb, std::wstring(TerminalViewWidth, L' '), { 0, 4 });
+    termSm.ProcessString(L"\x1b[?1049l");
+
+    Log::Comment(L"A resize in the main buffer shouldn't result in a reused alt buffer of the wrong size.");
+    VERIFY_SUCCEEDED(term->UserResize({ TerminalViewWidth - 10, TerminalViewHeight }));
+    termSm.ProcessString(L"\x1b[?1049h");
+    VERIFY_ARE_EQUAL(TerminalViewWidth - 10, term->_altBuffer->GetSize().Width());
+}
@@ -12,6 +12,7 @@
 #include "icon.h"
 
 #include <TerminalThemeHelpers.h>
+#include <StartupTimeline.h>
 
 using namespace winrt::Windows::UI;
 using namespace winrt::Windows::UI::Composition;
@@ -42,6 +43,7 @@ AppHost::AppHost(const winrt::TerminalApp::AppLogic& logic,
     _desktopManager{ winrt::try_create_instance<IVirtualDesktopManager>(__uuidof(VirtualDesktopManager)) }
 {
     _started = std::chrono::high_resolution_clock::now();
+    ::Microsoft::Console::StartupTimeline::Mark(g_hWindowsTerminalProvider, "AppHostCreate");
 
     _HandleCommandlineArgs(args);
 
@@ -13,6 +13,8 @@
 #include "resource.h"
 #include "NotificationIcon.h"
 
+#include <winrt/Microsoft.Terminal.TerminalConnection.h>
+
 using namespace winrt;
 using namespace winrt::Microsoft::Terminal;
 using namespace winrt::Microsoft::Terminal::Settings::Model;
@@ -108,6 +110,7 @@ bool WindowEmperor::HandleCommandlineArgs()
     Remoting::CommandlineArgs eventArgs{ { args }, { cwd }, showWindow };
 
     const auto isolatedMode{ _app.Logic().IsolatedMode() };
+    _startedForHandoff = std::find(args.begin(), args.end(), L"-Embedding") != args.end();
 
     const auto result = _manager.ProposeCommandline(eventArgs, isolatedMode);
 
@@ -339,6 +342,8 @@ void WindowEmperor::_becomeMonarch()
 
     _setupGlobalHotkeys();
 
+    _startPersistentHandoffListener();
+
     // When the settings change, we'll want to update our global hotkeys and our
     // notification icon based on the new settings.
     _app.Logic().SettingsChanged([this](auto&&, const TerminalApp::SettingsLoadEventArgs& args) {
@@ -368,6 +373,47 @@ void WindowEmperor::_becomeMonarch()
     _getWindowLayoutThrottler.value()();
 }
 
+// Method Description:
+// - Keeps this process registered for default terminal handoffs. Console applications that are launched
+//   afterwards get handed straight to us, instead of COM launching another WindowsTerminal.exe -Embedding,
+//   which would have to start up, find the monarch and propose its commandline to us.
+// - We propose that "-Embedding" commandline ourselves instead, so the handoff still ends up in a new tab or
+//   window according to the windowing behavior. That window picks up the queued connection once it calls
+//   ConptyConnection::StartInboundListener().
+void WindowEmperor::_startPersistentHandoffListener()
+{
+    // Default terminal handoffs aren't supported for elevated windows and an isolated
+    // process shouldn't capture the handoffs that other windows would receive.
+    if (_app.Logic().IsRunningElevated() || _app.Logic().IsolatedMode())
+    {
+        return;
+    }
+
+    try
+    {
+        // If COM started us for a handoff, our first window is yet to receive it the usual way.
+        TerminalConnection::ConptyConnection::StartPersistentInboundListener(_startedForHandoff, [this]() {
+            _dispatcher.TryEnqueue([this]() {
+                _handlePendingHandoff();
+            });
+        });
+    }
+    CATCH_LOG();
+}
+
+void WindowEmperor::_handlePendingHandoff()
+{
+    std::array<winrt::hstring, 2> args{ L"wt.exe", L"-Embedding" };
+    const auto cwd{ wil::GetCurrentDirectoryW<std::wstring>() };
+    Remoting::CommandlineArgs eventArgs{ { args }, { cwd }, SW_SHOW };
+
+    try
+    {
+        _manager.ProposeCommandline(eventArgs, _app.Logic().IsolatedMode());
+    }
+    CATCH_LOG();
+}
+
 // sender and args are always nullptr
 void WindowEmperor::_numberOfWindowsChanged(const winrt::Windows::Foundation::IInspectable&,
                                             const winrt::Windows::Foundation::IInspectable&)
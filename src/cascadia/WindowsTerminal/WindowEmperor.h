@@ -55,12 +55,15 @@ private:
     std::unique_ptr<NotificationIcon> _notificationIcon;
 
     bool _quitting{ false };
+    bool _startedForHandoff{ false };
 
     void _windowStartedHandlerPostXAML(const std::shared_ptr<WindowThread>& sender);
     void _removeWindow(uint64_t senderID);
     void _decrementWindowCount();
 
     void _becomeMonarch();
+    void _startPersistentHandoffListener();
+    void _handlePendingHandoff();
     void _numberOfWindowsChanged(const winrt::Windows::Foundation::IInspectable&, const winrt::Windows::Foundation::IInspectable&);
     void _quitAllRequested(const winrt::Windows::Foundation::IInspectable&,
                            const winrt::Microsoft::Terminal::Remoting::QuitAllRequestedArgs&);
@@ -6,6 +6,7 @@
 #include "resource.h"
 #include "../types/inc/User32Utils.hpp"
 #include <WilErrorReporting.h>
+#include <StartupTimeline.h>
 
 using namespace winrt;
 using namespace winrt::Windows::UI;
@@ -87,6 +88,7 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
 {
     TraceLoggingRegister(g_hWindowsTerminalProvider);
     ::Microsoft::Console::ErrorReporting::EnableFallbackFailureReporting(g_hWindowsTerminalProvider);
+    ::Microsoft::Console::StartupTimeline::Mark(g_hWindowsTerminalProvider, "ProcessStart");
 
     // If Terminal is spawned by a shortcut that requests that it run in a new process group
     // while attached to a console session, that request is nonsense. That request will, however,
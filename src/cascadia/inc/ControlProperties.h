@@ -71,6 +71,10 @@
     X(winrt::Microsoft::Terminal::Control::TextAntialiasingMode, AntialiasingMode, winrt::Microsoft::Terminal::Control::TextAntialiasingMode::Grayscale) \
     X(bool, ForceFullRepaintRendering, false)                                                                                                            \
     X(bool, SoftwareRendering, false)                                                                                                                    \
+    X(bool, PixelShaderPartialRedraw, false)                                                                                                             \
+    X(int32_t, PixelShaderMaxFrameRate, 0)                                                                                                               \
+    X(int32_t, MemoryBudget, 0)                                                                                                                          \
+    X(bool, LargePageBuffers, false)                                                                                                                     \
     X(bool, UseAtlasEngine, false)                                                                                                                       \
     X(bool, UseBackgroundImageForWindow, false)                                                                                                          \
     X(bool, ShowMarks, false)                                                                                                                            \
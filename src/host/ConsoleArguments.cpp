@@ -11,6 +11,7 @@ const std::wstring_view ConsoleArguments::VT_MODE_ARG = L"--vtmode";
 const std::wstring_view ConsoleArguments::HEADLESS_ARG = L"--headless";
 const std::wstring_view ConsoleArguments::SERVER_HANDLE_ARG = L"--server";
 const std::wstring_view ConsoleArguments::SIGNAL_HANDLE_ARG = L"--signal";
+const std::wstring_view ConsoleArguments::SHARED_MEMORY_HANDLE_ARG = L"--sharedMemory";
 const std::wstring_view ConsoleArguments::HANDLE_PREFIX = L"0x";
 const std::wstring_view ConsoleArguments::CLIENT_COMMANDLINE_ARG = L"--";
 const std::wstring_view ConsoleArguments::FORCE_V1_ARG = L"-ForceV1";
@@ -118,6 +119,7 @@ ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
     _createServerHandle = true;
     _serverHandle = 0;
     _signalHandle = 0;
+    _sharedMemoryHandle = 0;
     _forceV1 = false;
     _forceNoHandoff = false;
     _width = 0;
@@ -143,6 +145,7 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments& other)
         _createServerHandle = other._createServerHandle;
         _serverHandle = other._serverHandle;
         _signalHandle = other._signalHandle;
+        _sharedMemoryHandle = other._sharedMemoryHandle;
         _forceV1 = other._forceV1;
         _width = other._width;
         _height = other._height;
@@ -447,6 +450,16 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
                 hr = s_ParseHandleArg(signalHandleVal, _signalHandle);
             }
         }
+        else if (arg == SHARED_MEMORY_HANDLE_ARG)
+        {
+            std::wstring sharedMemoryHandleVal;
+            hr = s_GetArgumentValue(args, i, &sharedMemoryHandleVal);
+
+            if (SUCCEEDED(hr))
+            {
+                hr = s_ParseHandleArg(sharedMemoryHandleVal, _sharedMemoryHandle);
+            }
+        }
         else if (arg == FORCE_V1_ARG)
         {
             // -ForceV1 command line switch for NTVDM support
@@ -572,6 +585,18 @@ bool ConsoleArguments::HasSignalHandle() const
     return IsValidHandle(GetSignalHandle());
 }
 
+// Routine Description:
+// - Returns true if we were passed a seemingly valid VtSharedMemory section on startup.
+//   See ConptyCreatePseudoConsoleWithSharedMemory() in winconpty.cpp.
+// Arguments:
+// - <none> - uses internal state
+// Return Value:
+// - True or false (see description)
+bool ConsoleArguments::HasSharedMemoryHandle() const
+{
+    return IsValidHandle(GetSharedMemoryHandle());
+}
+
 // Routine Description:
 // - Returns true if we already have at least one handle for conpty streams.
 // Arguments:
@@ -617,6 +642,11 @@ HANDLE ConsoleArguments::GetSignalHandle() const
     return ULongToHandle(_signalHandle);
 }
 
+HANDLE ConsoleArguments::GetSharedMemoryHandle() const
+{
+    return ULongToHandle(_sharedMemoryHandle);
+}
+
 HANDLE ConsoleArguments::GetVtInHandle() const
 {
     return _vtInHandle;
@@ -45,6 +45,9 @@ public:
     bool HasSignalHandle() const;
     HANDLE GetSignalHandle() const;
 
+    bool HasSharedMemoryHandle() const;
+    HANDLE GetSharedMemoryHandle() const;
+
     std::wstring GetOriginalCommandLine() const;
     std::wstring GetClientCommandline() const;
     std::wstring GetVtMode() const;
@@ -64,6 +67,7 @@ public:
     static const std::wstring_view HEADLESS_ARG;
     static const std::wstring_view SERVER_HANDLE_ARG;
     static const std::wstring_view SIGNAL_HANDLE_ARG;
+    static const std::wstring_view SHARED_MEMORY_HANDLE_ARG;
     static const std::wstring_view HANDLE_PREFIX;
     static const std::wstring_view CLIENT_COMMANDLINE_ARG;
     static const std::wstring_view FORCE_V1_ARG;
@@ -140,6 +144,7 @@ private:
     bool _createServerHandle;
     DWORD _serverHandle;
     DWORD _signalHandle;
+    DWORD _sharedMemoryHandle{ 0 };
     bool _inheritCursor;
     bool _resizeQuirk{ false };
 
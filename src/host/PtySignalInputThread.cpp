@@ -7,7 +7,9 @@
 
 #include "output.h"
 #include "handle.h"
+#include "input.h"
 #include "../interactivity/inc/ServiceLocator.hpp"
+#include "../interactivity/inc/VtApiRedirection.hpp"
 
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Interactivity;
@@ -129,6 +131,11 @@ try
             _DoClearBuffer();
             break;
         }
+        case PtySignal::Interrupt:
+        {
+            _DoInterrupt();
+            break;
+        }
         case PtySignal::ResizeWindow:
         {
             ResizeWindowData resizeMsg = { 0 };
@@ -137,6 +144,12 @@ try
                 return S_OK;
             }
 
+            // Drag-resizing the terminal produces a burst of these and each one reflows
+            // the entire buffer. Only the latest size matters, so we skip the others.
+            while (_GetSupersedingResize(resizeMsg))
+            {
+            }
+
             _DoResizeWindow(resizeMsg);
             break;
         }
@@ -204,6 +217,37 @@ void PtySignalInputThread::_DoClearBuffer() const
     THROW_IF_FAILED(gci.GetActiveOutputBuffer().ClearBuffer());
 }
 
+// Method Description:
+// - Handles a Ctrl+C that the terminal sent out of band, so that it gets
+//   handled even if the input pipe is still full of earlier input.
+// - It's processed exactly like a typed Ctrl+C: In processed input mode it
+//   raises CTRL_C_EVENT and terminates pending reads, otherwise it's written
+//   into the input buffer as a key event.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void PtySignalInputThread::_DoInterrupt() const
+{
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    if (!_consoleConnected)
+    {
+        return;
+    }
+
+    INPUT_RECORD record{};
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.bKeyDown = TRUE;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = 'C';
+    record.Event.KeyEvent.wVirtualScanCode = gsl::narrow_cast<WORD>(OneCoreSafeMapVirtualKeyW('C', MAPVK_VK_TO_VSC));
+    record.Event.KeyEvent.uChar.UnicodeChar = 0x03;
+    record.Event.KeyEvent.dwControlKeyState = LEFT_CTRL_PRESSED;
+    HandleGenericKeyEvent(record, true);
+}
+
 void PtySignalInputThread::_DoShowHide(const ShowHideData& data)
 {
     LockConsole();
@@ -289,6 +333,38 @@ void PtySignalInputThread::_DoSetWindowParent(const SetParentData& data)
 // - cbBuffer - Count of bytes in the given buffer.
 // Return Value:
 // - True if data was retrieved successfully. False otherwise.
+// Method Description:
+// - Checks whether the next signal in the pipe is another resize and reads it if so.
+//   Signals are written atomically by the other side, so either all of it is there or nothing.
+// Arguments:
+// - data - Receives the size of the next resize signal, if there is one.
+// Return Value:
+// - true if another resize signal was read into data.
+[[nodiscard]] bool PtySignalInputThread::_GetSupersedingResize(ResizeWindowData& data)
+{
+    struct
+    {
+        PtySignal signalId;
+        ResizeWindowData data;
+    } next{};
+    static_assert(sizeof(next) == sizeof(PtySignal) + sizeof(ResizeWindowData));
+
+    DWORD available = 0;
+    if (!_hFile || !PeekNamedPipe(_hFile.get(), &next, sizeof(next), &available, nullptr, nullptr) ||
+        available != sizeof(next) || next.signalId != PtySignal::ResizeWindow)
+    {
+        return false;
+    }
+
+    if (!_GetData(&next, sizeof(next)))
+    {
+        return false;
+    }
+
+    data = next.data;
+    return true;
+}
+
 [[nodiscard]] bool PtySignalInputThread::_GetData(_Out_writes_bytes_(cbBuffer) void* const pBuffer, const DWORD cbBuffer)
 {
     if (!_hFile)
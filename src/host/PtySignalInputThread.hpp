@@ -41,6 +41,7 @@ namespace Microsoft::Console
             ShowHideWindow = 1,
             ClearBuffer = 2,
             SetParent = 3,
+            Interrupt = 4,
             ResizeWindow = 8
         };
 
@@ -62,9 +63,11 @@ namespace Microsoft::Console
 
         [[nodiscard]] HRESULT _InputThread() noexcept;
         [[nodiscard]] bool _GetData(_Out_writes_bytes_(cbBuffer) void* const pBuffer, const DWORD cbBuffer);
+        [[nodiscard]] bool _GetSupersedingResize(ResizeWindowData& data);
         void _DoResizeWindow(const ResizeWindowData& data);
         void _DoSetWindowParent(const SetParentData& data);
         void _DoClearBuffer() const;
+        void _DoInterrupt() const;
         void _DoShowHide(const ShowHideData& data);
         void _Shutdown();
 
@@ -39,7 +39,8 @@ VtApiRoutines::VtApiRoutines() :
     m_outputMode(),
     m_pUsualRoutines(),
     m_pVtEngine(),
-    m_listeningForDSR(false)
+    m_listeningForDSR(false),
+    m_cursorSynchronized(false)
 {
 }
 
@@ -99,12 +100,37 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // TODO GH#10001: we only need to do this in cooked read mode.
     if (waiter)
     {
-        m_listeningForDSR = true;
-        (void)m_pVtEngine->_ListenForDSR();
-        (void)m_pVtEngine->RequestCursor();
+        _RequestCursor();
     }
 }
 
+// Routine Description:
+// - Asks the terminal for its cursor position with a DSR-CPR, unless nothing was written to it since the last time we asked.
+// - The reply arrives via SetConsoleCursorPositionImpl() and updates our text buffer's cursor. As long as we haven't
+//   transmitted anything since then, that cursor is still accurate and we can answer with it locally, which saves
+//   a round trip to the terminal for every single ReadConsole() and GetConsoleInput() call that has to wait.
+void VtApiRoutines::_RequestCursor() noexcept
+{
+    if (m_cursorSynchronized)
+    {
+        return;
+    }
+
+    m_listeningForDSR = true;
+    m_cursorSynchronized = true;
+    (void)m_pVtEngine->_ListenForDSR();
+    (void)m_pVtEngine->RequestCursor();
+}
+
+// Routine Description:
+// - Flushes everything we've transmitted to the terminal. Since any of it may have moved the
+//   terminal's cursor, this invalidates the cursor position we got from the last DSR-CPR.
+void VtApiRoutines::_Flush() noexcept
+{
+    m_cursorSynchronized = false;
+    (void)m_pVtEngine->_Flush();
+}
+
 [[nodiscard]] HRESULT VtApiRoutines::GetConsoleInputImpl(
     IConsoleInputObject& context,
     InputEventQueue& outEvents,
@@ -137,9 +163,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     // TODO GH10001: we only need to do this in cooked read mode.
     if (clientHandle)
     {
-        m_listeningForDSR = true;
-        (void)m_pVtEngine->_ListenForDSR();
-        (void)m_pVtEngine->RequestCursor();
+        _RequestCursor();
     }
     return hr;
 }
@@ -159,7 +183,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
         (void)m_pVtEngine->WriteTerminalW(ConvertToW(m_outputCodepage, buffer));
     }
 
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     read = buffer.size();
     return S_OK;
 }
@@ -171,7 +195,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
                                                        std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     (void)m_pVtEngine->WriteTerminalW(buffer);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     read = buffer.size();
     return S_OK;
 }
@@ -191,7 +215,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute), true);
     (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute >> 4), false);
     (void)m_pVtEngine->_WriteFill(lengthToWrite, s_readBackAscii.Char.AsciiChar);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     cellsModified = lengthToWrite;
     return S_OK;
 }
@@ -208,7 +232,7 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     {
         (void)m_pVtEngine->_CursorPosition(startingCoordinate);
         (void)m_pVtEngine->_WriteFill(lengthToWrite, character);
-        (void)m_pVtEngine->_Flush();
+        _Flush();
         cellsModified = lengthToWrite;
         return S_OK;
     }
@@ -229,14 +253,25 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
     (void)m_pVtEngine->_CursorPosition(startingCoordinate);
     const std::wstring_view sv{ &character, 1 };
 
-    // TODO GH10001: horrible. it'll WC2MB over and over...we should do that once then emit... and then rep...
-    // TODO GH10001: there's probably an optimization for if ((character & 0x7F) == character) --> call the UTF8 one.
-    for (size_t i = 0; i < lengthToWrite; ++i)
+    // Convert the character only once and then repeat the UTF-8 encoding.
+    // TODO GH10001: This could emit the character once followed by a REP sequence.
+    std::string utf8;
+    if (SUCCEEDED(til::u16u8(sv, utf8)))
     {
-        (void)m_pVtEngine->WriteTerminalW(sv);
+        if (utf8.size() == 1)
+        {
+            (void)m_pVtEngine->_WriteFill(lengthToWrite, utf8.front());
+        }
+        else
+        {
+            for (size_t i = 0; i < lengthToWrite; ++i)
+            {
+                (void)m_pVtEngine->_Write(utf8);
+            }
+        }
     }
 
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     cellsModified = lengthToWrite;
     return S_OK;
 }
@@ -281,7 +316,7 @@ void VtApiRoutines::GetConsoleCursorInfoImpl(const SCREEN_INFORMATION& context,
                                                               const bool isVisible) noexcept
 {
     isVisible ? (void)m_pVtEngine->_ShowCursor() : (void)m_pVtEngine->_HideCursor();
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -303,7 +338,7 @@ void VtApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& c
     //color table?
     // popup attributes... hold internally?
     // TODO GH10001: popups are gonna erase the stuff behind them... deal with that somehow.
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -325,7 +360,7 @@ void VtApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& c
     else
     {
         (void)m_pVtEngine->_CursorPosition(position);
-        (void)m_pVtEngine->_Flush();
+        _Flush();
     }
     return S_OK;
 }
@@ -365,7 +400,7 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
 {
     (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute), true);
     (void)m_pVtEngine->_SetGraphicsRendition16Color(static_cast<BYTE>(attribute >> 4), false);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -374,7 +409,7 @@ void VtApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& co
                                                               const til::inclusive_rect& windowRect) noexcept
 {
     (void)m_pVtEngine->_ResizeWindow(windowRect.right - windowRect.left + 1, windowRect.bottom - windowRect.top + 1);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -467,7 +502,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
         pos += width;
     }
 
-    (void)m_pVtEngine->_Flush();
+    _Flush();
 
     //TODO GH10001: trim to buffer size?
     writtenRectangle = requestRectangle;
@@ -488,7 +523,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
         (void)m_pVtEngine->WriteTerminalUtf8(std::string_view{ &s_readBackAscii.Char.AsciiChar, 1 });
     }
 
-    (void)m_pVtEngine->_Flush();
+    _Flush();
 
     used = attrs.size();
     return S_OK;
@@ -503,7 +538,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
     {
         (void)m_pVtEngine->_CursorPosition(target);
         (void)m_pVtEngine->WriteTerminalUtf8(text);
-        (void)m_pVtEngine->_Flush();
+        _Flush();
         return S_OK;
     }
     else
@@ -519,7 +554,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
 {
     (void)m_pVtEngine->_CursorPosition(target);
     (void)m_pVtEngine->WriteTerminalW(text);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -611,7 +646,7 @@ extern HRESULT _ConvertCellsToWInplace(const UINT codepage,
 [[nodiscard]] HRESULT VtApiRoutines::SetConsoleTitleWImpl(const std::wstring_view title) noexcept
 {
     (void)m_pVtEngine->UpdateTitle(title);
-    (void)m_pVtEngine->_Flush();
+    _Flush();
     return S_OK;
 }
 
@@ -359,8 +359,11 @@ public:
     ULONG m_inputMode;
     ULONG m_outputMode;
     bool m_listeningForDSR;
+    bool m_cursorSynchronized;
     Microsoft::Console::Render::Xterm256Engine* m_pVtEngine;
 
 private:
     void _SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) noexcept;
+    void _RequestCursor() noexcept;
+    void _Flush() noexcept;
 };
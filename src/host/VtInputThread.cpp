@@ -10,6 +10,7 @@
 #include "../terminal/parser/InputStateMachineEngine.hpp"
 #include "../terminal/adapter/InteractDispatch.hpp"
 #include "../types/inc/convert.hpp"
+#include "../inc/VtSharedMemory.h"
 #include "server.h"
 #include "output.h"
 #include "handle.h"
@@ -35,6 +36,7 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
 
     auto dispatch = std::make_unique<InteractDispatch>();
+    _pDispatch = dispatch.get();
 
     auto engine = std::make_unique<InputStateMachineEngine>(std::move(dispatch), inheritCursor);
 
@@ -53,31 +55,35 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 // Method Description:
 // - Processes a string of input characters. The characters should be UTF-8
 //      encoded, and will get converted to wstring to be processed by the
-//      input state machine.
+//      input state machine. The resulting input is written to the input
+//      buffer in bulk, once the entire string has been processed.
 // Arguments:
 // - u8Str - the UTF-8 string received.
 // Return Value:
 // - S_OK on success, otherwise an appropriate failure.
 [[nodiscard]] HRESULT VtInputThread::_HandleRunInput(const std::string_view u8Str)
 {
-    // Make sure to call the GLOBAL Lock/Unlock, not the gci's lock/unlock.
-    // Only the global unlock attempts to dispatch ctrl events. If you use the
-    //      gci's unlock, when you press C-c, it won't be dispatched until the
-    //      next console API call. For something like `powershell sleep 60`,
-    //      that won't happen for 60s
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
-
     try
     {
-        std::wstring wstr{};
-        auto hr = til::u8u16(u8Str, wstr, _u8State);
+        // _wstr and _u8State are only used by this thread, so the conversion doesn't need the lock.
+        // _wstr is reused across calls, so that high-rate input doesn't allocate for every read.
+        auto hr = til::u8u16(u8Str, _wstr, _u8State);
         // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
         if (FAILED(hr))
         {
             return S_FALSE;
         }
-        _pInputStateMachine->ProcessString(wstr);
+
+        // Make sure to call the GLOBAL Lock/Unlock, not the gci's lock/unlock.
+        // Only the global unlock attempts to dispatch ctrl events. If you use the
+        //      gci's unlock, when you press C-c, it won't be dispatched until the
+        //      next console API call. For something like `powershell sleep 60`,
+        //      that won't happen for 60s
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        _pInputStateMachine->ProcessString(_wstr);
+        _pDispatch->FlushInput();
     }
     CATCH_RETURN();
 
@@ -107,11 +113,27 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
+    // Large enough that the state machine gets to process long runs of printable
+    // input (pastes, automation) in bulk, instead of acquiring the console lock
+    // and dispatching to the InputBuffer for every 256 bytes.
+    char buffer[4096];
     DWORD dwRead = 0;
-    auto fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
 
-    if (!fSuccess)
+    if (_sharedMemory)
+    {
+        // The terminal resizes us via the signal pipe and never via the section,
+        // so an empty read means that it closed the connection.
+        dwRead = gsl::narrow_cast<DWORD>(_sharedMemory->Read(buffer));
+        if (dwRead == 0)
+        {
+            if (_sharedMemory->IsClosed())
+            {
+                _exitRequested = true;
+            }
+            return;
+        }
+    }
+    else if (!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr))
     {
         _exitRequested = true;
         return;
@@ -139,6 +161,14 @@ void VtInputThread::SetLookingForDSR(const bool looking) noexcept
     }
 }
 
+// Method Description:
+// - Makes us read our input from the given VtSharedMemory section instead of the pipe.
+//   Must be called before Start().
+void VtInputThread::SetSharedMemory(std::shared_ptr<VtSharedMemory::Client> sharedMemory) noexcept
+{
+    _sharedMemory = std::move(sharedMemory);
+}
+
 // Method Description:
 // - The ThreadProc for the VT Input Thread. Reads input from the pipe, and
 //      passes it to _HandleRunInput to be processed by the
@@ -16,6 +16,16 @@ Author(s):
 
 #include "../terminal/parser/StateMachine.hpp"
 
+namespace Microsoft::Console::VirtualTerminal
+{
+    class InteractDispatch;
+}
+
+namespace Microsoft::Console::VtSharedMemory
+{
+    class Client;
+}
+
 namespace Microsoft::Console
 {
     class VtInputThread
@@ -27,12 +37,15 @@ namespace Microsoft::Console
         static DWORD WINAPI StaticVtInputThreadProc(_In_ LPVOID lpParameter);
         void DoReadInput(const bool throwOnFail);
         void SetLookingForDSR(const bool looking) noexcept;
+        void SetSharedMemory(std::shared_ptr<Microsoft::Console::VtSharedMemory::Client> sharedMemory) noexcept;
 
     private:
         [[nodiscard]] HRESULT _HandleRunInput(const std::string_view u8Str);
         void _InputThread();
 
         wil::unique_hfile _hFile;
+        // If set, the input is read from here instead of the _hFile.
+        std::shared_ptr<Microsoft::Console::VtSharedMemory::Client> _sharedMemory;
         wil::unique_handle _hThread;
         DWORD _dwThreadId;
 
@@ -41,6 +54,9 @@ namespace Microsoft::Console
         std::function<void(bool)> _pfnSetLookingForDSR;
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
+        // Owned by _pInputStateMachine's engine.
+        Microsoft::Console::VirtualTerminal::InteractDispatch* _pDispatch = nullptr;
         til::u8state _u8State;
+        std::wstring _wstr;
     };
 }
@@ -10,6 +10,7 @@
 
 #include "../renderer/base/renderer.hpp"
 #include "../types/inc/utils.hpp"
+#include "../inc/VtSharedMemory.h"
 #include "handle.h" // LockConsole
 #include "input.h" // ProcessCtrlEvents
 #include "output.h" // CloseConsoleProcessState
@@ -76,7 +77,21 @@ VtIo::VtIo() :
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
     {
-        return _Initialize(pArgs->GetVtInHandle(), pArgs->GetVtOutHandle(), pArgs->GetVtMode(), pArgs->GetSignalHandle());
+        RETURN_IF_FAILED(_Initialize(pArgs->GetVtInHandle(), pArgs->GetVtOutHandle(), pArgs->GetVtMode(), pArgs->GetSignalHandle()));
+
+        // See ConptyCreatePseudoConsoleWithSharedMemory(): If the terminal gave us a section,
+        // our VT input and output go through it instead of the pipes. The terminal
+        // believes that we do once it handed us the section, so failing to map it is fatal.
+        if (pArgs->HasSharedMemoryHandle())
+        {
+            try
+            {
+                const wil::unique_handle section{ pArgs->GetSharedMemoryHandle() };
+                _sharedMemory = std::make_shared<VtSharedMemory::Client>(section.get());
+            }
+            CATCH_RETURN();
+        }
+        return S_OK;
     }
     // Didn't need to initialize if we didn't have VT stuff. It's still OK, but report we did nothing.
     else
@@ -149,6 +164,10 @@ VtIo::VtIo() :
         if (IsValidHandle(_hInput.get()))
         {
             _pVtInputThread = std::make_unique<VtInputThread>(std::move(_hInput), _lookingForCursorPosition);
+            if (_sharedMemory)
+            {
+                _pVtInputThread->SetSharedMemory(_sharedMemory);
+            }
         }
 
         if (IsValidHandle(_hOutput.get()))
@@ -217,6 +236,10 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+                if (_sharedMemory)
+                {
+                    _pVtRenderEngine->SetSharedMemory(_sharedMemory);
+                }
             }
         }
     }
@@ -10,6 +10,11 @@
 
 class ConsoleArguments;
 
+namespace Microsoft::Console::VtSharedMemory
+{
+    class Client;
+}
+
 namespace Microsoft::Console::Render
 {
     class VtEngine;
@@ -60,6 +65,8 @@ namespace Microsoft::Console::VirtualTerminal
         wil::unique_hfile _hOutput;
         // After CreateAndStartSignalThread is called, this will be invalid.
         wil::unique_hfile _hSignal;
+        // Shared by the _pVtRenderEngine and _pVtInputThread, if the terminal gave us a section.
+        std::shared_ptr<Microsoft::Console::VtSharedMemory::Client> _sharedMemory;
         VtIoMode _IoMode;
 
         bool _initialized;
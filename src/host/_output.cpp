@@ -10,6 +10,7 @@
 #include "misc.h"
 
 #include "../interactivity/inc/ServiceLocator.hpp"
+#include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/Viewport.hpp"
 #include "../types/inc/convert.hpp"
 
@@ -215,10 +216,8 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
 
     try
     {
-        TextAttribute useThisAttr(attribute);
-        const OutputCellIterator it(useThisAttr, lengthToWrite);
-        const auto done = screenBuffer.Write(it, startingCoordinate);
-        const auto cellsModifiedCoord = done.GetCellDistance(it);
+        const TextAttribute useThisAttr(attribute);
+        const auto cellsModifiedCoord = screenBuffer.GetTextBuffer().FillAttributes(startingCoordinate, lengthToWrite, useThisAttr);
 
         cellsModified = cellsModifiedCoord;
 
@@ -277,12 +276,21 @@ void WriteToScreen(SCREEN_INFORMATION& screenInfo, const Viewport& region)
     auto hr = S_OK;
     try
     {
-        const OutputCellIterator it(character, lengthToWrite);
-
         // when writing to the buffer, specifically unset wrap if we get to the last column.
         // a fill operation should UNSET wrap in that scenario. See GH #1126 for more details.
-        const auto done = screenInfo.Write(it, startingCoordinate, false);
-        const auto cellsModifiedCoord = done.GetInputDistance(it);
+        size_t cellsModifiedCoord = 0;
+        if (!IsGlyphFullWidth(character))
+        {
+            // Narrow characters (most commonly whitespace to clear the screen) are filled
+            // in a row at a time. FillCharacters() unsets the wrap flag just like Write().
+            cellsModifiedCoord = screenInfo.GetTextBuffer().FillCharacters(startingCoordinate, lengthToWrite, character);
+        }
+        else
+        {
+            const OutputCellIterator it(character, lengthToWrite);
+            const auto done = screenInfo.Write(it, startingCoordinate, false);
+            cellsModifiedCoord = done.GetInputDistance(it);
+        }
 
         cellsModified = cellsModifiedCoord;
 
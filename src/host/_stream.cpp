@@ -132,6 +132,36 @@ static void _writeCharsLegacyUnprocessed(SCREEN_INFORMATION& screenInfo, const s
     }
 }
 
+// Returns the first character in [it, end) that isn't an IS_GLYPH_CHAR, or end if there is none.
+// Legacy console applications mostly write long runs of plain text, which makes this worth vectorizing.
+static const wchar_t* _findNextControlChar(const wchar_t* it, const wchar_t* const end) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if defined(TIL_SSE_INTRINSICS)
+    for (; end - it >= 8; it += 8)
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        // (wch < 0x20) is checked as "max(0, wch - 0x1f) == 0", just like findActionableFromGround.
+        const auto a = _mm_cmpeq_epi16(_mm_subs_epu16(wch, _mm_set1_epi16(0x1f)), _mm_setzero_si128());
+        const auto b = _mm_cmpeq_epi16(wch, _mm_set1_epi16(0x7f));
+        const auto mask = _mm_movemask_epi8(_mm_or_si128(a, b));
+        if (mask)
+        {
+            unsigned long offset;
+            _BitScanForward(&offset, mask);
+            return it + offset / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; it != end && IS_GLYPH_CHAR(*it); ++it)
+    {
+    }
+    return it;
+}
+
 // This routine writes a string to the screen while handling control characters.
 // `interactive` exists for COOKED_READ_DATA which uses it to transform control characters into visible text like "^X".
 // Similarly, `psScrollY` is also used by it to track whether the underlying buffer circled. It requires this information to know where the input line moved to.
@@ -142,8 +172,8 @@ void WriteCharsLegacy(SCREEN_INFORMATION& screenInfo, const std::wstring_view& t
     auto& textBuffer = screenInfo.GetTextBuffer();
     auto& cursor = textBuffer.GetCursor();
     const auto wrapAtEOL = WI_IsFlagSet(screenInfo.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT);
-    auto it = text.begin();
-    const auto end = text.end();
+    auto it = text.data();
+    const auto end = it + text.size();
 
     // In VT mode, when you have a 120-column terminal you can write 120 columns without the cursor wrapping.
     // Whenever the cursor is in that 120th column IsDelayedEOLWrap() will return true. I'm not sure why the VT parts
@@ -174,7 +204,7 @@ void WriteCharsLegacy(SCREEN_INFORMATION& screenInfo, const std::wstring_view& t
 
     while (it != end)
     {
-        const auto nextControlChar = std::find_if(it, end, [](const auto& wch) { return !IS_GLYPH_CHAR(wch); });
+        const auto nextControlChar = _findNextControlChar(it, end);
         if (nextControlChar != it)
         {
             _writeCharsLegacyUnprocessed(screenInfo, { it, nextControlChar }, interactive, psScrollY);
@@ -234,6 +264,16 @@ void WriteCharsLegacy(SCREEN_INFORMATION& screenInfo, const std::wstring_view& t
             {
                 auto pos = cursor.GetPosition();
                 pos.x = 0;
+
+                // CRLF is by far the most common line ending here. Moving the cursor to the start
+                // of the next line in one go saves us from updating (and redrawing) it twice.
+                if (end - it >= 2 && it[1] == UNICODE_LINEFEED)
+                {
+                    ++it;
+                    textBuffer.GetMutableRowByOffset(pos.y).SetWrapForced(false);
+                    pos.y = pos.y + 1;
+                }
+
                 AdjustCursorPosition(screenInfo, pos, interactive, psScrollY);
                 continue;
             }
@@ -371,6 +411,57 @@ NT_CATCH_RETURN()
     CATCH_RETURN();
 }
 
+static constexpr size_t Utf8WriteChunkSize = 64 * 1024;
+
+// Routine Description:
+// - Writes UTF-8 text in slices of at most Utf8WriteChunkSize bytes, converting each slice right before it's written.
+//   This way large writes never need a UTF-16 copy of the entire buffer.
+// - Partial sequences at slice boundaries are carried over in the u8state just like they are across calls.
+// - Console lock must be held when calling this routine.
+// Arguments:
+// - screenInfo - the screen buffer to write the text into
+// - buffer - UTF-8 text provided by the client application
+// - u8State - the partials cache shared with the unchunked conversion in WriteConsoleAImpl
+// - read - number of bytes consumed from buffer
+// - requiresVtQuirk - whether the client relies on the legacy VT color quirk
+// - waiter - filled if the console got blocked while writing
+// Return Value:
+// - S_OK if successful.
+// - Or a suitable HRESULT code for math/string/memory failures.
+[[nodiscard]] static HRESULT WriteConsoleUtf8Chunked(SCREEN_INFORMATION& screenInfo,
+                                                     const std::string_view buffer,
+                                                     til::u8state& u8State,
+                                                     size_t& read,
+                                                     bool requiresVtQuirk,
+                                                     std::unique_ptr<IWaitRoutine>& waiter) noexcept
+try
+{
+    std::wstring wstr;
+
+    for (size_t offset = 0; offset < buffer.size(); offset += Utf8WriteChunkSize)
+    {
+        const auto chunk = buffer.substr(offset, Utf8WriteChunkSize);
+        RETURN_IF_FAILED(til::u8u16(chunk, wstr, u8State));
+        read = offset + chunk.size();
+
+        std::unique_ptr<WriteData> writeDataWaiter;
+        size_t wcBufferWritten{};
+        RETURN_IF_FAILED(WriteConsoleWImplHelper(screenInfo, wstr, wcBufferWritten, requiresVtQuirk, writeDataWaiter));
+
+        // The caller only takes this path if the console isn't blocked, but if it gets blocked anyway,
+        // we return a partial write. The client will retry the remaining slices itself.
+        if (writeDataWaiter)
+        {
+            writeDataWaiter->SetUtf8ConsumedCharacters(read);
+            waiter.reset(writeDataWaiter.release());
+            break;
+        }
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
 // Routine Description:
 // - Writes non-Unicode formatted data into the given console output object.
 // - This method will convert from the given input into wide characters before chain calling the wide character version of the function.
@@ -416,6 +507,12 @@ NT_CATCH_RETURN()
         // Convert our input parameters to Unicode
         if (codepage == CP_UTF8)
         {
+            // A waiter has to hold on to the entire converted text, so we can only slice the write if we won't block.
+            if (buffer.size() > Utf8WriteChunkSize && WI_AreAllFlagsClear(consoleInfo.Flags, CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING))
+            {
+                return WriteConsoleUtf8Chunked(screenInfo, buffer, u8State, read, requiresVtQuirk, waiter);
+            }
+
             RETURN_IF_FAILED(til::u8u16(buffer, wstr, u8State));
             read = buffer.size();
         }
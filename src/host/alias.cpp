@@ -40,9 +40,16 @@ struct case_insensitive_equality
     }
 };
 
+// The target text as it was set, plus its precompiled form for s_MatchAndCopyAlias.
+struct AliasTarget
+{
+    std::wstring text;
+    Alias::Expansion expansion;
+};
+
 std::unordered_map<std::wstring,
                    std::unordered_map<std::wstring,
-                                      std::wstring,
+                                      AliasTarget,
                                       case_insensitive_hash,
                                       case_insensitive_equality>,
                    case_insensitive_hash,
@@ -114,7 +121,8 @@ std::unordered_map<std::wstring,
         else
         {
             // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
+            auto expansion = Alias::s_Compile(targetString);
+            g_aliasData[exeNameString][sourceString] = AliasTarget{ std::move(targetString), std::move(expansion) };
         }
     }
     CATCH_RETURN();
@@ -156,10 +164,10 @@ std::unordered_map<std::wstring,
     // We use .find for the iterators then dereference to search without creating entries.
     const auto exeIter = g_aliasData.find(exeNameString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
+    const auto& exeData = exeIter->second;
     const auto sourceIter = exeData.find(sourceString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto& targetString = sourceIter->second.text;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -333,18 +341,18 @@ static std::wstring aliasesSeparator(L"=");
         auto exeIter = g_aliasData.find(exeNameString);
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
+            const auto& list = exeIter->second;
             for (auto& pair : list)
             {
                 // Alias stores lengths in bytes.
                 auto cchSource = pair.first.size();
-                auto cchTarget = pair.second.size();
+                auto cchTarget = pair.second.text.size();
 
                 // If we're counting how much multibyte space will be needed, trial convert the source and target strings before we add.
                 if (!countInUnicode)
                 {
                     cchSource = GetALengthFromW(codepage, pair.first);
-                    cchTarget = GetALengthFromW(codepage, pair.second);
+                    cchTarget = GetALengthFromW(codepage, pair.second.text);
                 }
 
                 // Accumulate all sizes to the final string count.
@@ -464,12 +472,12 @@ void Alias::s_ClearCmdExeAliases()
     auto exeIter = g_aliasData.find(exeNameString);
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
+        const auto& list = exeIter->second;
         for (auto& pair : list)
         {
             // Alias stores lengths in bytes.
             const auto cchSource = pair.first.size();
-            const auto cchTarget = pair.second.size();
+            const auto cchTarget = pair.second.text.size();
 
             // Add up how many characters we will need for the full alias data.
             size_t cchNeeded = 0;
@@ -499,7 +507,7 @@ void Alias::s_ClearCmdExeAliases()
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, aliasesSeparator.size(), &cchAliasBufferRemaining));
                 AliasesBufferPtrW += aliasesSeparator.size();
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.data(), cchTarget));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.text.data(), cchTarget));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchTarget, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchTarget;
 
@@ -1024,58 +1032,65 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Parses the macros in an alias target into an Expansion, so that
+//   s_MatchAndCopyAlias doesn't need to do so for every command line.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - target - The alias target text, which may contain substitution macros indicated by $.
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The compiled target. Its lineCount is the number of commands in the final string (line feeds, CRLFs).
+Alias::Expansion Alias::s_Compile(const std::wstring_view target)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    Expansion expansion;
+    auto& literals = expansion.literals;
+    auto& segments = expansion.segments;
+
+    size_t literalsFlushed = 0;
+
+    // Turns all literals appended since the last call into a literal segment.
+    const auto flushLiterals = [&]() {
+        if (literals.size() > literalsFlushed)
+        {
+            segments.push_back({ gsl::narrow<uint32_t>(literalsFlushed), gsl::narrow<uint32_t>(literals.size() - literalsFlushed), Expansion::NoArg });
+            literalsFlushed = literals.size();
+        }
+    };
+    const auto pushArg = [&](const uint8_t arg) {
+        flushLiterals();
+        segments.push_back({ 0, 0, arg });
+    };
 
-    // The target text may contain substitution macros indicated by $.
-    // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    for (auto ch = target.cbegin(); ch < target.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < target.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
+                auto isProcessed = true;
+                if (*chNext >= L'1' && *chNext <= L'9')
                 {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
+                    // Numerical macros substitute that numbered argument
+                    pushArg(gsl::narrow_cast<uint8_t>(*chNext - L'0'));
                 }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
+                else if (L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
+                    // Wildcard substitutes all arguments
+                    pushArg(Expansion::AllArgs);
                 }
-                if (!isProcessed)
+                else
                 {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
+                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, literals) ||
+                                  s_TryReplaceOutputRedirMacro(*chNext, literals) ||
+                                  s_TryReplacePipeRedirMacro(*chNext, literals) ||
+                                  s_TryReplaceNextCommandMacro(*chNext, literals, expansion.lineCount);
                 }
                 if (!isProcessed)
                 {
                     // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
+                    literals.push_back(*ch);
+                    literals.push_back(*chNext);
                 }
 
                 // Since we read ahead and used that character,
@@ -1085,22 +1100,21 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
             else
             {
                 // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
+                literals.push_back(*ch);
             }
         }
         else
         {
             // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            literals.push_back(*ch);
         }
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(literals, expansion.lineCount);
+    flushLiterals();
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    return expansion;
 }
 
 // Routine Description:
@@ -1116,32 +1130,37 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
 std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount)
 {
     // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter == g_aliasData.end())
     {
         // We found no data for this exe. Give back an empty string.
         return std::wstring();
     }
 
-    auto exeList = exeIter->second;
+    const auto& exeList = exeIter->second;
     if (exeList.size() == 0)
     {
         // If there's no match, give back an empty string.
         return std::wstring();
     }
 
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceText);
-
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
+    // Tokenize the text by spaces, the same way s_Tokenize does. Token 0 is the alias and
+    // macros can only refer to the arguments 1-9, so we don't need to look any further.
+    std::array<std::wstring_view, 10> tokens;
+    size_t tokenCount = 0;
+    for (size_t beg = 0; tokenCount < tokens.size();)
     {
-        return std::wstring();
+        const auto end = sourceText.find(L' ', beg);
+        til::at(tokens, tokenCount++) = sourceText.substr(beg, end - beg);
+        if (end == std::wstring_view::npos)
+        {
+            break;
+        }
+        beg = end + 1;
     }
 
     // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
+    const auto aliasIter = exeList.find(std::wstring{ tokens.front() });
     if (aliasIter == exeList.end())
     {
         // We found no alias pair with this name. Give back an empty string.
@@ -1149,18 +1168,46 @@ std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std:
     }
 
     const auto& target = aliasIter->second;
-    if (target.size() == 0)
+    if (target.text.size() == 0)
     {
         return std::wstring();
     }
 
-    // Get the string of all parameters as a shorthand for $* later.
-    const auto allParams = s_GetArgString(sourceText);
+    // Get the string of all parameters as a shorthand for $* later. Same as s_GetArgString.
+    std::wstring_view allParams;
+    if (const auto firstSpace = sourceText.find(L' '); firstSpace != std::wstring_view::npos)
+    {
+        allParams = sourceText.substr(firstSpace + 1);
+    }
 
     // The final text will be the target but with macros replaced.
-    auto finalText = target;
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
+    const std::wstring_view literals{ target.expansion.literals };
+    const auto resolve = [&](const Expansion::Segment& segment) -> std::wstring_view {
+        switch (segment.arg)
+        {
+        case Expansion::NoArg:
+            return literals.substr(segment.offset, segment.length);
+        case Expansion::AllArgs:
+            return allParams;
+        default:
+            return segment.arg < tokenCount ? til::at(tokens, segment.arg) : std::wstring_view{};
+        }
+    };
+
+    size_t finalSize = 0;
+    for (const auto& segment : target.expansion.segments)
+    {
+        finalSize += resolve(segment).size();
+    }
+
+    std::wstring finalText;
+    finalText.reserve(finalSize);
+    for (const auto& segment : target.expansion.segments)
+    {
+        finalText.append(resolve(segment));
+    }
 
+    lineCount = target.expansion.lineCount;
     return finalText;
 }
 
@@ -1169,7 +1216,7 @@ void Alias::s_TestAddAlias(std::wstring& exe,
                            std::wstring& alias,
                            std::wstring& target)
 {
-    g_aliasData[exe][alias] = target;
+    g_aliasData[exe][alias] = AliasTarget{ target, s_Compile(target) };
 }
 
 void Alias::s_TestClearAliases()
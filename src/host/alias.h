@@ -14,16 +14,33 @@ Abstract:
 class Alias
 {
 public:
+    // An alias target with its macros already parsed. Expanding it only requires
+    // concatenating the literal segments with the referenced arguments.
+    struct Expansion
+    {
+        static constexpr uint8_t NoArg = 0;
+        static constexpr uint8_t AllArgs = 0xff;
+
+        struct Segment
+        {
+            uint32_t offset; // into literals, if arg is NoArg
+            uint32_t length;
+            uint8_t arg; // NoArg, 1-9 for $1-$9 or AllArgs for $*
+        };
+
+        std::wstring literals;
+        std::vector<Segment> segments;
+        size_t lineCount = 0;
+    };
+
     static void s_ClearCmdExeAliases();
 
     static std::wstring s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount);
+    static Expansion s_Compile(const std::wstring_view target);
 
 private:
     static std::deque<std::wstring> s_Tokenize(const std::wstring_view str);
     static std::wstring s_GetArgString(const std::wstring_view str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
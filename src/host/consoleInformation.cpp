@@ -14,19 +14,28 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/convert.hpp"
+#include "../types/inc/LockProfiler.hpp"
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::VtIo;
 
+// Reports the wait and hold times of the console lock when tracing with TIL_KEYWORD_LOCKS.
+static Microsoft::Console::Types::EtwLockProfiler s_consoleLockProfiler{ g_hConhostV2EventTraceProvider, "Console" };
+
+CONSOLE_INFORMATION::CONSOLE_INFORMATION()
+{
+    _lock.set_profiler(&s_consoleLockProfiler);
+}
+
 bool CONSOLE_INFORMATION::IsConsoleLocked() const noexcept
 {
     return _lock.is_locked();
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
-void CONSOLE_INFORMATION::LockConsole() noexcept
+void CONSOLE_INFORMATION::LockConsole(const std::source_location& site) noexcept
 {
-    _lock.lock();
+    _lock.lock(site);
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
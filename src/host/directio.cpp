@@ -470,7 +470,6 @@ CATCH_RETURN();
 {
     try
     {
-        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         const auto& storageBuffer = context.GetActiveBuffer().GetTextBuffer();
         const auto storageSize = storageBuffer.GetSize().Dimensions();
 
@@ -505,44 +504,19 @@ CATCH_RETURN();
         // The final "request rectangle" or the area inside the buffer we want to read, is the clipped dimensions.
         const auto clippedRequestRectangle = Viewport::FromExclusive(clip);
 
-        // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
-        const auto sourcePoint = clippedRequestRectangle.Origin();
-
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        til::point targetPos;
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Export each row of the clipped request into its place in the user's buffer at once.
+        // The parts of the user's buffer outside of it (because we clipped the request) are left untouched.
+        const auto clippedWidth = gsl::narrow_cast<size_t>(std::max(0, clip.right - clip.left));
+        for (auto y = clip.top; y < clip.bottom && clippedWidth; ++y)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            const auto targetOffset = gsl::narrow_cast<size_t>((targetPoint.y + y - clip.top) * targetSize.width + targetPoint.x);
+            if (targetOffset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                ++sourceIter;
+                break;
             }
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            ++targetIter;
-
-            // Increment the target
-            targetPos.x++;
-            if (targetPos.x >= targetSize.width)
-            {
-                targetPos.x = 0;
-                targetPos.y++;
-            }
+            const auto target = targetBuffer.subspan(targetOffset, std::min(clippedWidth, targetBuffer.size() - targetOffset));
+            storageBuffer.GetRowByOffset(y).ExportCharInfos(clip.left, target);
         }
 
         // Reply with the region we read out of the backing buffer (potentially clipped)
@@ -667,6 +641,7 @@ CATCH_RETURN();
         }
 
         const auto writeRectangle = Viewport::FromInclusive(writeRegion);
+        auto& textBuffer = storageBuffer.GetTextBuffer();
 
         auto target = writeRectangle.Origin();
 
@@ -683,12 +658,8 @@ CATCH_RETURN();
             // Now we make a subspan starting from that offset for as much of the original request as would fit
             const auto subspan = buffer.subspan(totalOffset, writeRectangle.Width());
 
-            // Convert to a CHAR_INFO view to fit into the iterator
-            const auto charInfos = std::span<const CHAR_INFO>(subspan.data(), subspan.size());
-
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            // Write the entire row segment at once, instead of going through an OutputCellIterator cell by cell.
+            textBuffer.WriteCharInfos({ subspan.data(), subspan.size() }, target);
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
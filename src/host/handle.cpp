@@ -10,10 +10,10 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
-void LockConsole()
+void LockConsole(const std::source_location& site)
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.LockConsole();
+    gci.LockConsole(site);
 }
 
 void UnlockConsole()
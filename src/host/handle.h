@@ -17,5 +17,7 @@ Revision History:
 
 #pragma once
 
-void LockConsole();
+#include <source_location>
+
+void LockConsole(const std::source_location& site = std::source_location::current());
 void UnlockConsole();
@@ -120,21 +120,27 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if (GetNumberOfCommands() == _maxCommands)
             {
-                _commands.erase(_commands.cbegin());
+                _IndexErase(0);
+                _commands.pop_front();
+                _firstId++;
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
             }
 
+            // This ensures that _IndexInsert() below can't fail after we've already modified _commands.
+            _prefixIndex.reserve(_prefixIndex.size() + 1);
+
             // add newCommand to array
             if (!reuse.empty())
             {
-                _commands.emplace_back(reuse);
+                _commands.emplace_back(std::move(reuse));
             }
             else
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexInsert(GetNumberOfCommands() - 1);
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -162,7 +168,7 @@ std::wstring_view CommandHistory::GetNth(Index index) const
     return {};
 }
 
-const std::vector<std::wstring>& CommandHistory::GetCommands() const noexcept
+const std::deque<std::wstring>& CommandHistory::GetCommands() const noexcept
 {
     return _commands;
 }
@@ -210,7 +216,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 
 void CommandHistory::Empty()
 {
-    _commands.clear();
+    _Clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -243,7 +249,9 @@ void CommandHistory::Realloc(const Index commands)
         return;
     }
 
-    _commands.resize(std::min(_commands.size(), gsl::narrow_cast<size_t>(std::max(0, commands))));
+    const auto size = std::min(_commands.size(), gsl::narrow_cast<size_t>(std::max(0, commands)));
+    std::erase_if(_prefixIndex, [&](const size_t id) { return id - _firstId >= size; });
+    _commands.resize(size);
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = GetNumberOfCommands() - 1;
@@ -348,7 +356,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     {
         if (!SameApp)
         {
-            BestCandidate->_commands.clear();
+            BestCandidate->_Clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -412,9 +420,20 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return {};
     }
 
+    _IndexErase(iDel);
     const auto str = std::move(_commands.at(iDel));
     _commands.erase(_commands.begin() + iDel);
 
+    // All commands after iDel moved one slot towards the front.
+    const auto idDel = _firstId + gsl::narrow_cast<size_t>(iDel);
+    for (auto& id : _prefixIndex)
+    {
+        if (id > idDel)
+        {
+            --id;
+        }
+    }
+
     if (LastDisplayed == iDel)
     {
         LastDisplayed = -1;
@@ -455,25 +474,83 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return true;
     }
 
-    try
+    const auto count = GetNumberOfCommands();
+    if (indexFound < 0 || indexFound >= count)
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        return false;
+    }
+
+    // All commands starting with givenCommand are adjacent in _prefixIndex, starting at its lower bound.
+    // Since it's sorted, commands that are equal to givenCommand are the first ones in that range.
+    // Of all the matches, we want the one that's found first when searching backwards from indexFound,
+    // wrapping around at the start. That is the one with the shortest distance "behind" indexFound.
+    const auto exactMatch = WI_IsFlagSet(options, MatchOptions::ExactMatch);
+    const auto beg = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), givenCommand, [this](const size_t id, const std::wstring_view& command) {
+        return std::wstring_view{ _commands[id - _firstId] } < command;
+    });
+    auto bestDistance = count;
+    auto bestIndex = indexFound;
+
+    for (auto it = beg; it != _prefixIndex.end(); ++it)
+    {
+        const auto index = gsl::narrow_cast<Index>(*it - _firstId);
+        const std::wstring_view storedCommand{ _commands[index] };
+        if (!til::starts_with(storedCommand, givenCommand) || (exactMatch && storedCommand.size() != givenCommand.size()))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
-            {
-                if (til::starts_with(storedCommand, givenCommand))
-                {
-                    return true;
-                }
-            }
+            break;
+        }
 
-            _Prev(indexFound);
+        const auto distance = (indexFound - index + count) % count;
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            bestIndex = index;
         }
     }
-    CATCH_LOG();
 
-    return false;
+    // If no command matched, this leaves indexFound unchanged, just like a full backwards search would.
+    indexFound = bestIndex;
+    return bestDistance != count;
+}
+
+void CommandHistory::_Clear() noexcept
+{
+    _commands.clear();
+    _prefixIndex.clear();
+    _firstId = 0;
+}
+
+// Orders _prefixIndex entries by their command text and by their position for equal texts.
+bool CommandHistory::_IndexLess(const size_t lhs, const size_t rhs) const noexcept
+{
+    const std::wstring_view a{ _commands[lhs - _firstId] };
+    const std::wstring_view b{ _commands[rhs - _firstId] };
+    const auto cmp = a.compare(b);
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+// Adds the command at the given index to _prefixIndex. It must already be stored in _commands.
+void CommandHistory::_IndexInsert(const Index index)
+{
+    const auto id = _firstId + gsl::narrow_cast<size_t>(index);
+    const auto it = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), id, [this](const size_t lhs, const size_t rhs) {
+        return _IndexLess(lhs, rhs);
+    });
+    _prefixIndex.insert(it, id);
+}
+
+// Removes the command at the given index from _prefixIndex. It must still be stored in _commands.
+void CommandHistory::_IndexErase(const Index index)
+{
+    const auto id = _firstId + gsl::narrow_cast<size_t>(index);
+    const auto it = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), id, [this](const size_t lhs, const size_t rhs) {
+        return _IndexLess(lhs, rhs);
+    });
+    assert(it != _prefixIndex.end() && *it == id);
+    if (it != _prefixIndex.end() && *it == id)
+    {
+        _prefixIndex.erase(it);
+    }
 }
 
 #ifdef UNIT_TESTING
@@ -495,7 +572,12 @@ void CommandHistory::Swap(const Index indexA, const Index indexB)
         indexA >= 0 && indexA < num &&
         indexB >= 0 && indexB < num)
     {
+        // The capacity of _prefixIndex suffices to reinsert both entries without throwing.
+        _IndexErase(indexA);
+        _IndexErase(indexB);
         std::swap(_commands.at(indexA), _commands.at(indexB));
+        _IndexInsert(indexA);
+        _IndexInsert(indexB);
     }
 }
 
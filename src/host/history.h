@@ -48,7 +48,7 @@ public:
 
     Index GetNumberOfCommands() const;
     std::wstring_view GetNth(Index index) const;
-    const std::vector<std::wstring>& GetCommands() const noexcept;
+    const std::deque<std::wstring>& GetCommands() const noexcept;
 
     void Realloc(Index commands);
     void Empty();
@@ -73,9 +73,19 @@ private:
     void _Dec(Index& ind) const;
     void _Inc(Index& ind) const;
 
-    // NOTE: In conhost v1 this used to be a circular buffer because removal at the
-    // start is a very common operation. It seems this was lost in the C++ refactor.
-    std::vector<std::wstring> _commands;
+    void _Clear() noexcept;
+    bool _IndexLess(size_t lhs, size_t rhs) const noexcept;
+    void _IndexInsert(Index index);
+    void _IndexErase(Index index);
+
+    // Removal at the start is a very common operation (evicting the least recently used command),
+    // which is why this is a deque. In conhost v1 this used to be a circular buffer for the same reason.
+    std::deque<std::wstring> _commands;
+    // All commands sorted by their text, which places commands with a common prefix next to each other
+    // and allows FindMatchingCommand() to binary search. An entry refers to _commands[entry - _firstId].
+    // Storing it offset by _firstId means that evicting the first command doesn't require updating the rest.
+    std::vector<size_t> _prefixIndex;
+    size_t _firstId = 0;
     Index _maxCommands = 0;
 
     std::wstring _appName;
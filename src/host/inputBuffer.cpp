@@ -10,6 +10,7 @@
 #include <til/bytes.h>
 
 #include "misc.h"
+#include "../interactivity/inc/EventSynthesis.hpp"
 #include "../interactivity/inc/ServiceLocator.hpp"
 
 #define INPUT_BUFFER_DEFAULT_INPUT_MODE (ENABLE_LINE_INPUT | ENABLE_PROCESSED_INPUT | ENABLE_ECHO_INPUT | ENABLE_MOUSE_INPUT)
@@ -157,15 +158,8 @@ size_t InputBuffer::ConsumeCached(bool isUnicode, size_t count, InputEventQueue&
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
-
-    while (i < count && !_cachedInputEvents.empty())
-    {
-        target.push_back(std::move(_cachedInputEvents.front()));
-        _cachedInputEvents.pop_front();
-        i++;
-    }
-
+    const auto i = _copyRecords(_cachedInputEvents, count, target);
+    _cachedInputEvents.pop_front(i);
     return i;
 }
 
@@ -174,20 +168,27 @@ size_t InputBuffer::PeekCached(bool isUnicode, size_t count, InputEventQueue& ta
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
+    return _copyRecords(_cachedInputEvents, count, target);
+}
+
+// Copies up to `count` records from the front of `source` into `target` in bulk.
+size_t InputBuffer::_copyRecords(const InputRecordRing& source, size_t count, InputEventQueue& target)
+{
+    size_t copied = 0;
 
-    for (const auto& e : _cachedInputEvents)
+    while (copied < count)
     {
-        if (i >= count)
+        auto run = source.contiguous(copied);
+        if (run.empty())
         {
             break;
         }
-
-        target.push_back(e);
-        i++;
+        run = run.first(std::min(run.size(), count - copied));
+        target.insert(target.end(), run.begin(), run.end());
+        copied += run.size();
     }
 
-    return i;
+    return copied;
 }
 
 // Trims `source` to have a size below or equal to `expectedSourceSize` by
@@ -198,14 +199,153 @@ void InputBuffer::Cache(bool isUnicode, InputEventQueue& source, size_t expected
 
     if (source.size() > expectedSourceSize)
     {
-        _cachedInputEvents.insert(
-            _cachedInputEvents.end(),
-            std::make_move_iterator(source.begin() + expectedSourceSize),
-            std::make_move_iterator(source.end()));
+        _cachedInputEvents.append({ source.begin() + expectedSourceSize, source.end() });
         source.resize(expectedSourceSize);
     }
 }
 
+// Routine Description:
+// - Writes text to the end of the buffer without turning it into key events.
+//   Stream readers (ReadConsole & co.) consume it directly via ConsumeText(), while
+//   ReadConsoleInput readers get key events synthesized for it on demand.
+// Arguments:
+// - text - The text to write.
+// Return Value:
+// - The number of characters written.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteString(const std::wstring_view& text)
+{
+    try
+    {
+        if (text.empty())
+        {
+            return 0;
+        }
+
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // In VT input mode each key needs to be translated by _termInput and if output is
+        // suspended, any keyboard input releases it. Both need to observe individual key events.
+        // Control characters are special-cased by stream readers (see GetChar), so they do as well.
+        const auto hasControlChars = std::any_of(text.begin(), text.end(), [](const wchar_t wch) { return wch < L' '; });
+        if (IsInVirtualTerminalInputMode() || WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) || hasControlChars)
+        {
+            InputEventQueue events;
+            for (const auto& wch : text)
+            {
+                Interactivity::CharToKeyEvents(wch, gci.OutputCP, events);
+            }
+            Write(events);
+            return text.size();
+        }
+
+        const auto initiallyEmpty = _storage.empty() && _pendingTextReader.empty();
+
+        const auto off = _pendingText.empty() ? 0 : _pendingTextReader.data() - _pendingText.data();
+        _pendingText.append(text);
+        _pendingTextReader = std::wstring_view{ _pendingText }.substr(off);
+
+        if (initiallyEmpty)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+        }
+        WakeUpReadersWaitingForData();
+        return text.size();
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Pops the next character of the text written via WriteString(), if no other input precedes it.
+// Arguments:
+// - wch - On success, receives the character.
+// Return Value:
+// - true if a character was read.
+bool InputBuffer::ConsumeText(wchar_t& wch) noexcept
+{
+    if (_pendingTextReader.empty() || !_storage.empty())
+    {
+        return false;
+    }
+
+    // Our caller would otherwise Read() a single key event in this mode,
+    // which would've returned any cached events first.
+    _switchReadingMode(ReadingMode::InputEventsW);
+    if (!_cachedInputEvents.empty())
+    {
+        return false;
+    }
+
+    wch = _pendingTextReader.front();
+    _pendingTextReader = _pendingTextReader.substr(1);
+    _ReleasePendingTextIfConsumed();
+    return true;
+}
+
+// Routine Description:
+// - Same as Consume(), but with the text written via WriteString() as the source,
+//   as long as no other input precedes it.
+// Arguments:
+// - isUnicode - true if `target` receives UTF-16, false for the input codepage.
+// - target - The buffer to copy the text into. Its start will be advanced past the copied data.
+// Return Value:
+// - true if anything was copied into `target`.
+bool InputBuffer::ConsumeText(bool isUnicode, std::span<char>& target)
+{
+    if (_pendingTextReader.empty() || !_storage.empty())
+    {
+        return false;
+    }
+
+    const auto initialSize = target.size();
+    Consume(isUnicode, _pendingTextReader, target);
+    _ReleasePendingTextIfConsumed();
+    return target.size() != initialSize;
+}
+
+// Turns up to `count` characters of the text written via WriteString() into key events.
+void InputBuffer::_SynthesizePendingText(size_t count)
+{
+    if (_pendingTextReader.empty())
+    {
+        return;
+    }
+
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto text = _pendingTextReader.substr(0, count);
+    InputEventQueue events;
+
+    for (const auto& wch : text)
+    {
+        events.clear();
+        Interactivity::CharToKeyEvents(wch, gci.OutputCP, events);
+        _storage.append(events);
+    }
+
+    _pendingTextReader = _pendingTextReader.substr(text.size());
+    _ReleasePendingTextIfConsumed();
+}
+
+void InputBuffer::_ReleasePendingTextIfConsumed() noexcept
+{
+    if (_pendingTextReader.empty())
+    {
+        // This is just so that we release memory eagerly.
+        _pendingText = std::wstring{};
+        _pendingTextReader = {};
+
+        if (_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+    }
+}
+
 void InputBuffer::_switchReadingMode(ReadingMode mode)
 {
     if (_readingMode != mode)
@@ -222,7 +362,7 @@ void InputBuffer::_switchReadingModeSlowPath(ReadingMode mode)
     _cachedTextW = std::wstring{};
     _cachedTextReaderW = {};
 
-    _cachedInputEvents = std::deque<INPUT_RECORD>{};
+    _cachedInputEvents = InputRecordRing{};
 
     _readingMode = mode;
 }
@@ -275,6 +415,8 @@ void InputBuffer::ReinitializeInputBuffer()
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
     _storage.clear();
+    _pendingText = std::wstring{};
+    _pendingTextReader = {};
 }
 
 // Routine Description:
@@ -307,9 +449,11 @@ void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 // - The number of events currently in the input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
+// - Text written via WriteString() is counted as a key down/up pair per character,
+//   which is what most characters get synthesized into.
 size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 {
-    return _storage.size();
+    return _storage.size() + _pendingTextReader.size() * 2;
 }
 
 // Routine Description:
@@ -323,6 +467,8 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 void InputBuffer::Flush()
 {
     _storage.clear();
+    _pendingText = std::wstring{};
+    _pendingTextReader = {};
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -336,10 +482,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const INPUT_RECORD& event) {
+    _storage.erase_if([](const INPUT_RECORD& event) {
         return event.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ Render::VtEngine* const pTtyConnection)
@@ -369,7 +514,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Note:
 // - The console lock must be held when calling this routine.
 // Arguments:
-// - OutEvents - deque to store the read events
+// - OutEvents - queue to store the read events
 // - AmountToRead - the amount of events to try to read
 // - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
 // - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
@@ -400,14 +545,47 @@ try
         ConsumeCached(Unicode, AmountToRead, OutEvents);
     }
 
-    auto it = _storage.begin();
-    const auto end = _storage.end();
+    // Text from WriteString() only gets turned into key events as far as this read needs it.
+    // Each character results in at least one event, so this synthesizes sufficiently many.
+    if (!_pendingTextReader.empty() && _storage.size() < AmountToRead - OutEvents.size())
+    {
+        _SynthesizePendingText(AmountToRead - OutEvents.size() - _storage.size());
+    }
+
+    size_t consumed = 0;
+    const auto available = _storage.size();
 
-    while (it != end && OutEvents.size() < AmountToRead)
+    while (consumed < available && OutEvents.size() < AmountToRead)
     {
-        if (it->EventType == KEY_EVENT)
+        // Records that are passed through unmodified are copied in bulk. This is the common
+        // case for W-reads and it avoids touching each record individually during large pastes.
+        if (Unicode)
+        {
+            auto run = _storage.contiguous(consumed);
+            run = run.first(std::min(run.size(), AmountToRead - OutEvents.size()));
+
+            size_t passthrough = run.size();
+            if (Stream)
+            {
+                const auto it = std::find_if(run.begin(), run.end(), [](const INPUT_RECORD& r) {
+                    return r.EventType == KEY_EVENT && r.Event.KeyEvent.wRepeatCount > 1;
+                });
+                passthrough = gsl::narrow_cast<size_t>(it - run.begin());
+            }
+
+            if (passthrough)
+            {
+                OutEvents.insert(OutEvents.end(), run.begin(), run.begin() + passthrough);
+                consumed += passthrough;
+                continue;
+            }
+        }
+
+        auto& record = _storage[consumed];
+
+        if (record.EventType == KEY_EVENT)
         {
-            auto event = *it;
+            auto event = record;
             WORD repeat = 1;
 
             // for stream reads we need to split any key events that have been coalesced
@@ -450,21 +628,21 @@ try
 
             if (repeat && !Peek)
             {
-                it->Event.KeyEvent.wRepeatCount = repeat;
+                record.Event.KeyEvent.wRepeatCount = repeat;
                 break;
             }
         }
         else
         {
-            OutEvents.push_back(*it);
+            OutEvents.push_back(record);
         }
 
-        ++it;
+        ++consumed;
     }
 
     if (!Peek)
     {
-        _storage.erase(_storage.begin(), it);
+        _storage.pop_front(consumed);
     }
 
     Cache(Unicode, OutEvents, AmountToRead);
@@ -473,7 +651,7 @@ try
     {
         return WaitForData ? CONSOLE_STATUS_WAIT : STATUS_SUCCESS;
     }
-    if (_storage.empty())
+    if (_storage.empty() && _pendingTextReader.empty())
     {
         ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     }
@@ -510,12 +688,14 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<INPUT_RECORD> existingStorage;
+        // (pending text must be turned into records first, or it'd end up before the prepended ones)
+        _SynthesizePendingText(SIZE_MAX);
+        InputRecordRing existingStorage;
         existingStorage.swap(_storage);
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we swapped the storage out from under it with an empty ring, it will always
+        // return true after the first one (as it is filling the newly emptied backing ring.)
         // Then after the second one, because we've inserted some input, it will always say false.
         auto unusedWaitStatus = false;
 
@@ -524,10 +704,10 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
         _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
-        for (const auto& event : existingStorage)
-        {
-            _storage.push_back(event);
-        }
+        // The ring holds its records in at most two contiguous runs.
+        const auto head = existingStorage.contiguous(0);
+        _storage.append(head);
+        _storage.append(existingStorage.contiguous(head.size()));
 
         // We need to set the wait event if there were 0 events in the
         // input queue when we started.
@@ -624,7 +804,8 @@ void InputBuffer::WriteFocusEvent(bool focused) noexcept
     else
     {
         // This is a mini-version of Write().
-        const auto wasEmpty = _storage.empty();
+        const auto wasEmpty = _storage.empty() && _pendingTextReader.empty();
+        _SynthesizePendingText(SIZE_MAX);
         _storage.push_back(SynthesizeFocusEvent(focused));
         if (wasEmpty)
         {
@@ -697,10 +878,22 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
 
     eventsWritten = 0;
     setWaitEvent = false;
-    const auto initiallyEmptyQueue = _storage.empty();
+    const auto initiallyEmptyQueue = _storage.empty() && _pendingTextReader.empty();
+
+    // Pending text precedes the new events, so it needs to be turned into records now.
+    _SynthesizePendingText(SIZE_MAX);
+
     const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
+    // The VT sequences of consecutive events are written in one go, instead of one at a time.
+    // Events that aren't handled by _termInput flush them first, which preserves their order.
+    _termInputBatch.clear();
+    const auto flushTermInputBatch = [&]() {
+        _HandleTerminalInputCallback(_termInputBatch);
+        _termInputBatch.clear();
+    };
+
     for (const auto& inEvent : inEvents)
     {
         if (inEvent.EventType == KEY_EVENT && inEvent.Event.KeyEvent.bKeyDown)
@@ -726,14 +919,15 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
         if (vtInputMode)
         {
             // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
-            if (const auto out = _termInput.HandleKey(inEvent))
+            if (_termInput.HandleKey(inEvent, _termInputBatch))
             {
-                _HandleTerminalInputCallback(*out);
                 eventsWritten++;
                 continue;
             }
         }
 
+        flushTermInputBatch();
+
         // we only check for possible coalescing when storing one
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
@@ -748,6 +942,8 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
         _storage.push_back(inEvent);
         ++eventsWritten;
     }
+    flushTermInputBatch();
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -835,6 +1031,8 @@ void InputBuffer::_HandleTerminalInputCallback(const TerminalInput::StringType&
             return;
         }
 
+        _SynthesizePendingText(SIZE_MAX);
+
         for (const auto& wch : text)
         {
             _storage.push_back(SynthesizeKeyEvent(true, 1, 0, 0, wch, 0));
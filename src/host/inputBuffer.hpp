@@ -10,14 +10,156 @@
 #include "../server/ObjectHeader.h"
 #include "../terminal/input/terminalInput.hpp"
 
-#include <deque>
-
 namespace Microsoft::Console::Render
 {
     class Renderer;
     class VtEngine;
 }
 
+// A contiguous, growable ring buffer of INPUT_RECORDs.
+// Unlike std::deque it doesn't allocate a node per handful of records, which matters when
+// a paste pushes millions of events through the buffer. The records can be accessed as
+// (at most two) contiguous spans, which allows Read() to copy them in bulk.
+class InputRecordRing
+{
+public:
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    INPUT_RECORD& operator[](size_t offset) noexcept
+    {
+        assert(offset < _size);
+        return _data[(_head + offset) & (_capacity - 1)];
+    }
+
+    const INPUT_RECORD& operator[](size_t offset) const noexcept
+    {
+        assert(offset < _size);
+        return _data[(_head + offset) & (_capacity - 1)];
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    // Returns the longest contiguous run of records starting at the given offset.
+    std::span<const INPUT_RECORD> contiguous(size_t offset) const noexcept
+    {
+        if (offset >= _size)
+        {
+            return {};
+        }
+        const auto beg = (_head + offset) & (_capacity - 1);
+        const auto len = std::min(_size - offset, _capacity - beg);
+        return { _data.get() + beg, len };
+    }
+
+    void push_back(const INPUT_RECORD& record)
+    {
+        if (_size == _capacity)
+        {
+            _grow(_size + 1);
+        }
+        _data[(_head + _size) & (_capacity - 1)] = record;
+        _size++;
+    }
+
+    void append(const std::span<const INPUT_RECORD>& records)
+    {
+        if (records.size() > _capacity - _size)
+        {
+            _grow(_size + records.size());
+        }
+
+        auto remaining = records;
+        while (!remaining.empty())
+        {
+            const auto beg = (_head + _size) & (_capacity - 1);
+            const auto len = std::min(remaining.size(), _capacity - beg);
+            std::copy_n(remaining.data(), len, _data.get() + beg);
+            remaining = remaining.subspan(len);
+            _size += len;
+        }
+    }
+
+    void pop_front(size_t count = 1) noexcept
+    {
+        assert(count <= _size);
+        _size -= count;
+        // Resetting the head on empty keeps the next writes contiguous.
+        _head = _size == 0 ? 0 : (_head + count) & (_capacity - 1);
+    }
+
+    void clear() noexcept
+    {
+        _head = 0;
+        _size = 0;
+    }
+
+    // Removes all records for which pred returns true, preserving the order of the others.
+    template<typename Pred>
+    void erase_if(Pred&& pred)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            auto& record = (*this)[i];
+            if (!pred(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+    }
+
+    void swap(InputRecordRing& other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_capacity, other._capacity);
+        std::swap(_head, other._head);
+        std::swap(_size, other._size);
+    }
+
+private:
+    void _grow(size_t minCapacity)
+    {
+        // The capacity is kept at a power of 2 so that offsets can be wrapped with a mask.
+        auto newCapacity = std::max<size_t>(_capacity * 2, 64);
+        while (newCapacity < minCapacity)
+        {
+            newCapacity *= 2;
+        }
+
+        auto newData = std::make_unique_for_overwrite<INPUT_RECORD[]>(newCapacity);
+        const auto first = contiguous(0);
+        const auto second = contiguous(first.size());
+        std::copy_n(first.data(), first.size(), newData.get());
+        std::copy_n(second.data(), second.size(), newData.get() + first.size());
+
+        _data = std::move(newData);
+        _capacity = newCapacity;
+        _head = 0;
+    }
+
+    std::unique_ptr<INPUT_RECORD[]> _data;
+    size_t _capacity = 0;
+    size_t _head = 0;
+    size_t _size = 0;
+};
+
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
@@ -35,6 +177,10 @@ public:
     size_t ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target);
     size_t PeekCached(bool isUnicode, size_t count, InputEventQueue& target);
     void Cache(bool isUnicode, InputEventQueue& source, size_t expectedSourceSize);
+    // Bulk text APIs (e.g. for pastes), which avoid synthesizing key events unless needed
+    size_t WriteString(const std::wstring_view& text);
+    bool ConsumeText(wchar_t& wch) noexcept;
+    bool ConsumeText(bool isUnicode, std::span<char>& target);
 
     // storage API for partial dbcs bytes being written to the buffer
     bool IsWritePartialByteSequenceAvailable() const noexcept;
@@ -79,13 +225,19 @@ private:
     std::string_view _cachedTextReaderA;
     std::wstring _cachedTextW;
     std::wstring_view _cachedTextReaderW;
-    std::deque<INPUT_RECORD> _cachedInputEvents;
+    InputRecordRing _cachedInputEvents;
     ReadingMode _readingMode = ReadingMode::StringA;
 
-    std::deque<INPUT_RECORD> _storage;
+    InputRecordRing _storage;
+    // Text written via WriteString(). It logically follows all records in _storage
+    // and is only turned into key events once something needs to read it as such.
+    std::wstring _pendingText;
+    std::wstring_view _pendingTextReader;
     INPUT_RECORD _writePartialByteSequence{};
     bool _writePartialByteSequenceAvailable = false;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
+    // _WriteBuffer() collects the VT sequences of consecutive events here. It's reused to avoid allocations.
+    Microsoft::Console::VirtualTerminal::TerminalInput::StringType _termInputBatch;
     Microsoft::Console::Render::VtEngine* _pTtyConnection;
 
     // This flag is used in _HandleTerminalInputCallback
@@ -96,6 +248,9 @@ private:
 
     void _switchReadingMode(ReadingMode mode);
     void _switchReadingModeSlowPath(ReadingMode mode);
+    static size_t _copyRecords(const InputRecordRing& source, size_t count, InputEventQueue& target);
+    void _SynthesizePendingText(size_t count);
+    void _ReleasePendingTextIfConsumed() noexcept;
     void _WriteBuffer(const std::span<const INPUT_RECORD>& inRecords, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent);
     bool _CoalesceEvent(const INPUT_RECORD& inEvent) noexcept;
     void _HandleTerminalInputCallback(const Microsoft::Console::VirtualTerminal::TerminalInput::StringType& text);
@@ -92,28 +92,10 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
-    {
-        const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-        do
-        {
-            const auto current = next;
-            source.WalkInBounds(sourcePos, walkDirection);
-            next = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.GetTextBuffer().WriteLine(OutputCellIterator({ &current, 1 }), targetPos);
-        } while (target.WalkInBounds(targetPos, walkDirection));
-    }
+    // 2. Any other scenario is copied row by row, moving the text and attributes of each row
+    //    segment in a single block. The text buffer takes care of choosing the order in which
+    //    rows are copied, so that it doesn't erase the source material before it's been moved.
+    screenInfo.GetTextBuffer().CopyRect(source.ToExclusive(), targetOrigin);
 }
 
 // Routine Description:
@@ -140,34 +122,29 @@ std::vector<WORD> ReadOutputAttributes(const SCREEN_INFORMATION& screenInfo,
         return {};
     }
 
-    // Get iterator to the position we should start reading at.
-    auto it = screenInfo.GetCellDataAt(coordRead);
-    // Count up the number of cells we've attempted to read.
-    ULONG amountRead = 0;
-    // Prepare the return value string.
-    std::vector<WORD> retVal;
-    // Reserve the number of cells. If we have >U+FFFF, it will auto-grow later and that's OK.
-    retVal.reserve(amountToRead);
+    // The read continues on the following rows until the end of the buffer.
+    const auto& textBuffer = screenInfo.GetTextBuffer();
+    const auto bufferSize = screenInfo.GetBufferSize().Dimensions();
+    const auto available = gsl::narrow_cast<size_t>(bufferSize.width) * (bufferSize.height - coordRead.y) - coordRead.x;
 
-    // While we haven't read enough cells yet and the iterator is still valid (hasn't reached end of buffer)
-    while (amountRead < amountToRead && it)
-    {
-        const auto legacyAttributes = it->TextAttr().GetLegacyAttributes();
+    std::vector<WORD> retVal(std::min(amountToRead, available));
+    size_t amountRead = 0;
 
-        // If the first thing we read is trailing, pad with a space.
-        // OR If the last thing we read is leading, pad with a space.
-        if ((amountRead == 0 && it->DbcsAttr() == DbcsAttribute::Trailing) ||
-            (amountRead == (amountToRead - 1) && it->DbcsAttr() == DbcsAttribute::Leading))
-        {
-            retVal.push_back(legacyAttributes);
-        }
-        else
-        {
-            retVal.push_back(legacyAttributes | GeneratePublicApiAttributeFormat(it->DbcsAttr()));
-        }
+    // Export the attributes a row at a time instead of walking a cell iterator.
+    for (auto pos = coordRead; amountRead < retVal.size(); pos.x = 0, ++pos.y)
+    {
+        amountRead += textBuffer.GetRowByOffset(pos.y).ExportLegacyAttributes(pos.x, std::span{ retVal }.subspan(amountRead));
+    }
 
-        amountRead++;
-        it++;
+    // If the first thing we read is trailing, pad with a space.
+    // OR If the last thing we read is leading, pad with a space.
+    if (WI_IsFlagSet(retVal.front(), COMMON_LVB_TRAILING_BYTE))
+    {
+        WI_ClearFlag(retVal.front(), COMMON_LVB_TRAILING_BYTE);
+    }
+    if (retVal.size() == amountToRead && WI_IsFlagSet(retVal.back(), COMMON_LVB_LEADING_BYTE))
+    {
+        WI_ClearFlag(retVal.back(), COMMON_LVB_LEADING_BYTE);
     }
 
     return retVal;
@@ -289,24 +289,18 @@ void ConhostInternalGetSet::SetWorkingDirectory(const std::wstring_view /*uri*/)
 }
 
 // Routine Description:
-// - Plays a single MIDI note, blocking for the duration.
+// - Queues a single MIDI note for playback. This doesn't block.
 // Arguments:
 // - noteNumber - The MIDI note number to be played (0 - 127).
 // - velocity - The force with which the note should be played (0 - 127).
 // - duration - How long the note should be sustained (in milliseconds).
 // Return value:
-// - true if successful. false otherwise.
+// - <none>
 void ConhostInternalGetSet::PlayMidiNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration)
 {
-    // Unlock the console, so the UI doesn't hang while we're busy.
-    UnlockConsole();
-
-    // This call will block for the duration, unless shutdown early.
     const auto windowHandle = ServiceLocator::LocateConsoleWindow()->GetWindowHandle();
     auto& midiAudio = ServiceLocator::LocateGlobals().getConsoleInformation().GetMidiAudio();
     midiAudio.PlayNote(windowHandle, noteNumber, velocity, std::chrono::duration_cast<std::chrono::milliseconds>(duration));
-
-    LockConsole();
 }
 
 // Routine Description:
@@ -232,6 +232,8 @@ void COOKED_READ_DATA::EraseBeforeResize()
         _unwindCursorPosition(_distanceEnd);
         _distanceCursor = 0;
         _distanceEnd = 0;
+        _drawnBuffer.clear();
+        _drawnCheckpoints.clear();
     }
 }
 
@@ -746,12 +748,55 @@ void COOKED_READ_DATA::_flushBuffer()
 
     if (WI_IsFlagSet(_pInputBuffer->InputMode, ENABLE_ECHO_INPUT))
     {
-        _unwindCursorPosition(_distanceCursor);
-
         const std::wstring_view view{ _buffer };
-        const auto distanceBeforeCursor = _writeChars(view.substr(0, _bufferCursor));
-        const auto distanceAfterCursor = _writeChars(view.substr(_bufferCursor));
-        const auto distanceEnd = distanceBeforeCursor + distanceAfterCursor;
+
+        // Only the text after the first difference to what's on screen needs to be redrawn. We resume drawing
+        // at the last checkpoint before that point (and before the cursor, whose distance we need to know).
+        const auto mismatch = std::mismatch(view.begin(), view.end(), _drawnBuffer.begin(), _drawnBuffer.end());
+        const auto unchanged = std::min<size_t>(mismatch.first - view.begin(), _bufferCursor);
+        const auto checkpoint = std::find_if(_drawnCheckpoints.rbegin(), _drawnCheckpoints.rend(), [&](const auto& c) {
+            return c.offset <= unchanged;
+        });
+        const auto resume = checkpoint == _drawnCheckpoints.rend() ? DrawnCheckpoint{ 0, 0 } : *checkpoint;
+
+        _drawnCheckpoints.erase(checkpoint.base(), _drawnCheckpoints.end());
+        _moveCursorBy(resume.distance - _distanceCursor);
+
+        // The text is written in grapheme-aligned chunks, each of which ends in a new checkpoint.
+        // Checkpoints are skipped while the cursor is in the delayed EOL wrap state, because
+        // moving the cursor there and resuming drawing would overwrite the last column.
+        static constexpr size_t chunkSize = 256;
+        const auto& cursor = _screenInfo.GetTextBuffer().GetCursor();
+        auto distance = resume.distance;
+        auto distanceBeforeCursor = resume.distance;
+
+        for (auto offset = resume.offset; offset < view.size();)
+        {
+            auto end = std::min(offset + chunkSize, view.size());
+            if (offset < _bufferCursor)
+            {
+                end = std::min(end, _bufferCursor);
+            }
+            if (end < view.size() && end != _bufferCursor)
+            {
+                end = TextBuffer::GraphemeNext(view, TextBuffer::GraphemePrev(view, end));
+            }
+
+            distance += _writeChars(view.substr(offset, end - offset));
+            offset = end;
+
+            if (offset == _bufferCursor)
+            {
+                distanceBeforeCursor = distance;
+            }
+            if (!cursor.IsDelayedEOLWrap())
+            {
+                _drawnCheckpoints.push_back({ offset, distance });
+            }
+        }
+
+        const auto distanceEnd = distance;
+        const auto distanceAfterCursor = distanceEnd - distanceBeforeCursor;
         const auto eraseDistance = std::max(0, _distanceEnd - distanceEnd);
 
         // If the contents of _buffer became shorter we'll have to erase the previously printed contents.
@@ -760,11 +805,29 @@ void COOKED_READ_DATA::_flushBuffer()
 
         _distanceCursor = distanceBeforeCursor;
         _distanceEnd = distanceEnd;
+        _drawnBuffer.replace(resume.offset, std::wstring::npos, view.substr(resume.offset));
     }
 
     _bufferDirty = false;
 }
 
+// Moves the cursor by `distance`-many cells inside the text buffer (backwards if negative).
+void COOKED_READ_DATA::_moveCursorBy(til::CoordType distance) const
+{
+    if (distance < 0)
+    {
+        _unwindCursorPosition(-distance);
+    }
+    else if (distance > 0)
+    {
+        const auto& cursor = _screenInfo.GetTextBuffer().GetCursor();
+        const auto pos = _offsetPosition(cursor.GetPosition(), distance);
+
+        std::ignore = _screenInfo.SetCursorPosition(pos, true);
+        _screenInfo.MakeCursorVisible(pos);
+    }
+}
+
 // This is just a small helper to fill the next N cells starting at the current cursor position with whitespace.
 // The implementation is inefficient for `count`s larger than 7, but such calls are uncommon to happen (namely only when resizing the window).
 void COOKED_READ_DATA::_erase(const til::CoordType distance)
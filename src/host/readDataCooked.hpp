@@ -113,6 +113,7 @@ private:
     void _handlePostCharInputLoop(bool isUnicode, size_t& numBytes, ULONG& controlKeyState);
     void _markAsDirty();
     void _flushBuffer();
+    void _moveCursorBy(til::CoordType distance) const;
     void _erase(til::CoordType distance);
     til::CoordType _writeChars(const std::wstring_view& text) const;
     til::point _offsetPosition(til::point pos, til::CoordType distance) const;
@@ -138,11 +139,22 @@ private:
     ULONG _controlKeyState = 0;
     std::unique_ptr<ConsoleHandleData> _tempHandle;
 
+    // A position in _drawnBuffer with a known distance (in cells) from the start of the
+    // prompt. _flushBuffer() uses them to only redraw the text after the first change.
+    struct DrawnCheckpoint
+    {
+        size_t offset;
+        til::CoordType distance;
+    };
+
     std::wstring _buffer;
     size_t _bufferCursor = 0;
-    til::CoordType _distanceCursor;
-    til::CoordType _distanceEnd;
+    til::CoordType _distanceCursor = 0;
+    til::CoordType _distanceEnd = 0;
     bool _bufferDirty = false;
+    // What _flushBuffer() last drew on the screen and where it can resume drawing.
+    std::wstring _drawnBuffer;
+    std::vector<DrawnCheckpoint> _drawnCheckpoints;
     bool _insertMode = false;
 
     std::vector<Popup> _popups;
@@ -61,6 +61,7 @@ const FontInfo& RenderData::GetFontInfo() const noexcept
 // Method Description:
 // - Retrieves one rectangle per line describing the area of the viewport
 //   that should be highlighted in some way to represent a user-interactive selection
+// - Rows outside of the viewport aren't returned, since they can't be drawn anyways.
 // Return Value:
 // - Vector of Viewports describing the area selected
 std::vector<Viewport> RenderData::GetSelectionRects() noexcept
@@ -69,7 +70,8 @@ std::vector<Viewport> RenderData::GetSelectionRects() noexcept
 
     try
     {
-        for (const auto& select : Selection::Instance().GetSelectionRects())
+        const auto viewport = GetViewport();
+        for (const auto& select : Selection::Instance().GetSelectionRects(viewport.Top(), viewport.BottomExclusive()))
         {
             result.emplace_back(Viewport::FromInclusive(select));
         }
@@ -318,6 +320,11 @@ const std::vector<size_t> RenderData::GetPatternId(const til::point /*location*/
     return {};
 }
 
+bool RenderData::HasPatternsInRow(const til::CoordType /*row*/) const
+{
+    return false;
+}
+
 // Routine Description:
 // - Converts a text attribute into the RGB values that should be presented, applying
 //   relevant table translation information and preferences.
@@ -7,10 +7,9 @@
 
 #pragma hdrstop
 
-RenderFontDefaults::RenderFontDefaults()
-{
-    LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
-}
+// The list of TrueType fonts is read from the registry on first use, instead of during startup,
+// because ConPTY sessions never need it and a lot of them are short-lived.
+RenderFontDefaults::RenderFontDefaults() = default;
 
 RenderFontDefaults::~RenderFontDefaults()
 {
@@ -21,6 +20,10 @@ RenderFontDefaults::~RenderFontDefaults()
                                                                              std::wstring& outFaceName)
 try
 {
+    std::call_once(_initialized, []() {
+        LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
+    });
+
     // GH#3123: Propagate font length changes up through Settings and propsheet
     wchar_t faceName[LF_FACESIZE]{ 0 };
     auto status = TrueTypeFontList::s_SearchByCodePage(codePage, faceName, ARRAYSIZE(faceName));
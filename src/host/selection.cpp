@@ -37,11 +37,12 @@ Selection& Selection::Instance()
 // - Determines the line-by-line selection rectangles based on global selection state.
 // Arguments:
 // - <none> - Uses internal state to know what area is selected already.
+// - rowBeg, rowEnd - Only the rectangles for rows in [rowBeg,rowEnd) are returned.
 // Return Value:
 // - Returns a vector where each til::inclusive_rect is one Row worth of the area to be selected.
 // - Returns empty vector if no rows are selected.
 // - Throws exceptions for out of memory issues
-std::vector<til::inclusive_rect> Selection::GetSelectionRects() const
+std::vector<til::inclusive_rect> Selection::GetSelectionRects(til::CoordType rowBeg, til::CoordType rowEnd) const
 {
     if (!_fSelectionVisible)
     {
@@ -58,7 +59,7 @@ std::vector<til::inclusive_rect> Selection::GetSelectionRects() const
     endSelectionAnchor.y = (_coordSelectionAnchor.y == _srSelectionRect.top) ? _srSelectionRect.bottom : _srSelectionRect.top;
 
     const auto blockSelection = !IsLineSelection();
-    return screenInfo.GetTextBuffer().GetTextRects(_coordSelectionAnchor, endSelectionAnchor, blockSelection, false);
+    return screenInfo.GetTextBuffer().GetTextRects(_coordSelectionAnchor, endSelectionAnchor, blockSelection, false, rowBeg, rowEnd);
 }
 
 // Routine Description:
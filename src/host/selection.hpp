@@ -28,7 +28,7 @@ class Selection
 public:
     ~Selection() = default;
 
-    std::vector<til::inclusive_rect> GetSelectionRects() const;
+    std::vector<til::inclusive_rect> GetSelectionRects(til::CoordType rowBeg = til::CoordTypeMin, til::CoordType rowEnd = til::CoordTypeMax) const;
 
     void ShowSelection();
     void HideSelection();
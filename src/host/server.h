@@ -76,7 +76,7 @@ class CONSOLE_INFORMATION :
     public Microsoft::Console::IIoProvider
 {
 public:
-    CONSOLE_INFORMATION() = default;
+    CONSOLE_INFORMATION();
     CONSOLE_INFORMATION(const CONSOLE_INFORMATION& c) = delete;
     CONSOLE_INFORMATION& operator=(const CONSOLE_INFORMATION& c) = delete;
 
@@ -100,7 +100,7 @@ public:
 
     ConsoleImeInfo ConsoleIme;
 
-    void LockConsole() noexcept;
+    void LockConsole(const std::source_location& site = std::source_location::current()) noexcept;
     void UnlockConsole() noexcept;
     bool IsConsoleLocked() const noexcept;
     ULONG GetCSRecursionCount() const noexcept;
@@ -141,6 +141,12 @@ static bool IsCommandLineEditingKey(const KEY_EVENT_RECORD& event)
         *pdwKeyState = 0;
     }
 
+    // Text written in bulk (e.g. a paste) can be read without synthesizing key events for it.
+    if (pInputBuffer->ConsumeText(*pwchOut))
+    {
+        return STATUS_SUCCESS;
+    }
+
     for (;;)
     {
         InputEventQueue events;
@@ -422,6 +428,13 @@ try
 
     while (writer.size() >= charSize)
     {
+        // Text written in bulk (e.g. a paste) can be copied over as a whole.
+        if (inputBuffer.ConsumeText(unicode, writer))
+        {
+            noDataReadYet = false;
+            continue;
+        }
+
         wchar_t wch;
         // We don't need to wait for input if `ConsumeCached` read something already, which is
         // indicated by the writer having been advanced (= it's shorter than the original buffer).
@@ -3,6 +3,9 @@
 
 #include "precomp.h"
 #include "tracing.hpp"
+
+#include <bit>
+
 #include "../types/UiaTextRangeBase.hpp"
 #include "../types/ScreenInfoUiaProviderBase.h"
 
@@ -22,6 +25,7 @@ enum TraceKeywords
     UIA = 0x800,
     CookedRead = 0x1000,
     ConsoleAttachDetach = 0x2000,
+    ApiCall = 0x4000,
     All = 0x1FFF
 };
 DEFINE_ENUM_FLAG_OPERATORS(TraceKeywords);
@@ -208,6 +212,54 @@ void Tracing::s_TraceConsoleAttachDetach(_In_ ConsoleProcessHandle* const pConso
     }
 }
 
+// Routine Description:
+// - Returns true if someone listens for per-API call events. The API sorter checks this
+//   before taking any timestamps, so that the instrumentation costs nothing by default.
+bool Tracing::s_IsApiCallTracingEnabled() noexcept
+{
+    return TraceLoggingProviderEnabled(g_hConhostV2EventTraceProvider, WINEVENT_LEVEL_VERBOSE, TraceKeywords::ApiCall);
+}
+
+// Routine Description:
+// - Records a single dispatched console API call.
+// - Besides the raw duration, the event carries a log2 bucket of the latency in microseconds,
+//   so that a trace can be grouped by API, process and bucket to get per-client histograms.
+// Arguments:
+// - pConsoleProcessHandle - The client that issued the call, if known.
+// - pszApiName - The API's name as listed in the API sorter's descriptor table.
+// - inputSize - Size of the client's input buffer in bytes.
+// - outputSize - Size of the client's output buffer in bytes.
+// - status - The status the call completed with.
+// - pending - True if the reply was deferred to a wait block. The duration then only covers the dispatch.
+// - duration - Time spent in the API routine, including the time spent waiting for the console lock.
+void Tracing::s_TraceApiCall(_In_opt_ const ConsoleProcessHandle* const pConsoleProcessHandle,
+                             _In_z_ const char* const pszApiName,
+                             const ULONG inputSize,
+                             const ULONG outputSize,
+                             const NTSTATUS status,
+                             const bool pending,
+                             const std::chrono::steady_clock::duration duration)
+{
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    const auto latencyUs = ::base::saturated_cast<uint64_t>(us);
+    const auto latencyBucket = static_cast<uint32_t>(std::bit_width(latencyUs));
+
+    TraceLoggingWrite(
+        g_hConhostV2EventTraceProvider,
+        "ApiCall",
+        TraceLoggingString(pszApiName, "Api"),
+        TraceLoggingPid(pConsoleProcessHandle ? pConsoleProcessHandle->dwProcessId : 0, "OriginatingProcess"),
+        TraceLoggingUInt32(inputSize, "InputBytes"),
+        TraceLoggingUInt32(outputSize, "OutputBytes"),
+        TraceLoggingNTStatus(status, "Status"),
+        TraceLoggingBool(pending, "Pending"),
+        TraceLoggingUInt64(latencyUs, "LatencyUs"),
+        TraceLoggingUInt32(latencyBucket, "LatencyBucket"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE),
+        TraceLoggingKeyword(TraceKeywords::ApiCall));
+}
+
 void __stdcall Tracing::TraceFailure(const wil::FailureInfo& failure) noexcept
 {
     TraceLoggingWrite(
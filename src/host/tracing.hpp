@@ -17,6 +17,7 @@ Author(s):
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 
 #include "../types/inc/Viewport.hpp"
@@ -54,6 +55,15 @@ public:
     static void s_TraceCookedRead(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, const std::wstring_view& text);
     static void s_TraceConsoleAttachDetach(_In_ ConsoleProcessHandle* const pConsoleProcessHandle, _In_ bool bIsAttach);
 
+    static bool s_IsApiCallTracingEnabled() noexcept;
+    static void s_TraceApiCall(_In_opt_ const ConsoleProcessHandle* const pConsoleProcessHandle,
+                               _In_z_ const char* const pszApiName,
+                               const ULONG inputSize,
+                               const ULONG outputSize,
+                               const NTSTATUS status,
+                               const bool pending,
+                               const std::chrono::steady_clock::duration duration);
+
     static void __stdcall TraceFailure(const wil::FailureInfo& failure) noexcept;
 
 private:
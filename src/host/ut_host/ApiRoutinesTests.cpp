@@ -418,6 +418,40 @@ class ApiRoutinesTests
         }
     }
 
+    TEST_METHOD(ApiWriteConsoleALargeUtf8)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        gci.OutputCP = CP_UTF8;
+        SetConsoleCPInfo(TRUE);
+
+        // Large writes are converted in 64kB slices. Place a 3 byte katakana across the boundary
+        // of the first slice, right at the beginning of a new line, so we can find it afterwards.
+        std::string text(64 * 1024 - 3, 'a');
+        text.append("\r\n\xe3\x82\xab");
+        text.append(1024, 'b');
+        text.append("\r\n");
+
+        size_t cchRead = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+        const auto hr = _pApiRoutines->WriteConsoleAImpl(si, text, cchRead, false, waiter);
+
+        VERIFY_ARE_EQUAL(S_OK, hr);
+        VERIFY_IS_NULL(waiter.get());
+        VERIFY_ARE_EQUAL(text.size(), cchRead);
+
+        // Walk back to the row holding the katakana. It's followed by the 1024 b's and the final newline.
+        const auto& textBuffer = si.GetTextBuffer();
+        const auto width = textBuffer.GetSize().Width();
+        const auto rows = (2 + 1024 + width - 1) / width;
+        const auto cursorY = textBuffer.GetCursor().GetPosition().y;
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\x30ab" }, si.GetCellDataAt({ 0, cursorY - rows })->Chars());
+    }
+
     TEST_METHOD(ApiWriteConsoleW)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -50,6 +50,43 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(BmpTableMatchesRanges)
+    {
+        CodepointWidthDetector table;
+        CodepointWidthDetector ranges;
+        // Without any blocks, all lookups go through the list of ranges.
+        ranges._bmpBlockIndices.fill(CodepointWidthDetector::_bmpNoBlock);
+
+        size_t mismatches = 0;
+        for (char32_t codepoint = 0; codepoint < 0x10000; ++codepoint)
+        {
+            const auto wch = gsl::narrow_cast<wchar_t>(codepoint);
+            if (table.GetWidth({ &wch, 1 }) != ranges.GetWidth({ &wch, 1 }))
+            {
+                Log::Comment(NoThrowString().Format(L"U+%04X", codepoint));
+                mismatches++;
+            }
+        }
+        VERIFY_ARE_EQUAL(0u, mismatches);
+    }
+
+    TEST_METHOD(CanCountLeadingAscii)
+    {
+        VERIFY_ARE_EQUAL(0u, CodepointWidthDetector::CountLeadingAscii({}));
+        VERIFY_ARE_EQUAL(3u, CodepointWidthDetector::CountLeadingAscii(L"abc"));
+
+        // Checks every position for the first non-ASCII character in both the vectorized and the scalar part.
+        for (size_t length = 1; length <= 20; ++length)
+        {
+            for (size_t pos = 0; pos < length; ++pos)
+            {
+                std::wstring text(length, L'\x7f');
+                text[pos] = L'\x80';
+                VERIFY_ARE_EQUAL(pos, CodepointWidthDetector::CountLeadingAscii(text));
+            }
+        }
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
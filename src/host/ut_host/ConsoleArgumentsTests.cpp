@@ -31,6 +31,7 @@ public:
 
     TEST_METHOD(HeadlessArgTests);
     TEST_METHOD(SignalHandleTests);
+    TEST_METHOD(SharedMemoryHandleTests);
     TEST_METHOD(FeatureArgTests);
 };
 
@@ -1191,6 +1192,23 @@ void ConsoleArgumentsTests::SignalHandleTests()
                    false); // successful parse?
 }
 
+void ConsoleArgumentsTests::SharedMemoryHandleTests()
+{
+    ConsoleArguments args{ L"conhost.exe --headless --signal 0x8 --sharedMemory 0xc", INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE };
+    VERIFY_SUCCEEDED(args.ParseCommandline());
+    VERIFY_IS_TRUE(args.HasSharedMemoryHandle());
+    VERIFY_ARE_EQUAL(UlongToHandle(0xc), args.GetSharedMemoryHandle());
+    VERIFY_ARE_EQUAL(UlongToHandle(0x8), args.GetSignalHandle());
+
+    ConsoleArguments noSharedMemory{ L"conhost.exe --headless --signal 0x8", INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE };
+    VERIFY_SUCCEEDED(noSharedMemory.ParseCommandline());
+    VERIFY_IS_FALSE(noSharedMemory.HasSharedMemoryHandle());
+
+    ConsoleArguments badSharedMemory{ L"conhost.exe --sharedMemory ASDF", INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE };
+    VERIFY_FAILED(badSharedMemory.ParseCommandline());
+    VERIFY_IS_FALSE(badSharedMemory.HasSharedMemoryHandle());
+}
+
 void ConsoleArgumentsTests::FeatureArgTests()
 {
     // Just some assorted positive values that could be valid handles. No specific correlation to anything.
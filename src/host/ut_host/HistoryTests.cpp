@@ -242,6 +242,45 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandByPrefix)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        // This evicts the first 2 items ("dir" and "dir /w").
+        for (const auto& item : _manyHistoryItems)
+        {
+            VERIFY_SUCCEEDED(history->Add(item, false));
+        }
+        VERIFY_ARE_EQUAL(s_BufferSize, history->GetNumberOfCommands());
+
+        constexpr auto options = CommandHistory::MatchOptions::JustLooking;
+        CommandHistory::Index index;
+
+        // The closest match searching backwards from the starting index is "ipconfig /all" (index 3).
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 9, index, options));
+        VERIFY_ARE_EQUAL(3, index);
+
+        // An exact match skips "ipconfig /all" and the search wraps around at the start.
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 2, index, options | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(2, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 2, index, options));
+        VERIFY_ARE_EQUAL(3, index);
+
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dir /w", 9, index, options));
+
+        history->Swap(0, 9);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 9, index, options));
+        VERIFY_ARE_EQUAL(9, index);
+        VERIFY_ARE_EQUAL(L"dir /p /w", history->GetNth(index));
+
+        VERIFY_ARE_EQUAL(L"ipconfig /all", history->Remove(3));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 8, index, options));
+        VERIFY_ARE_EQUAL(2, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 7, index, options));
+        VERIFY_ARE_EQUAL(8, index);
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
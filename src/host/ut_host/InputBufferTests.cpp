@@ -642,4 +642,80 @@ class InputBufferTests
         VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(outEvents.front().Event.KeyEvent.wRepeatCount, 1u);
     }
+
+    TEST_METHOD(ReadingAcrossRingWraparoundPreservesOrder)
+    {
+        InputBuffer inputBuffer;
+        InputEventQueue records;
+        InputEventQueue outEvents;
+        WORD next = 0;
+        WORD expected = 0;
+
+        // Repeatedly write more than we read, so that the ring's head moves
+        // forward, its contents wrap around the end and it has to grow.
+        for (auto i = 0; i < 20; ++i)
+        {
+            records.clear();
+            for (auto j = 0; j < 50; ++j)
+            {
+                records.push_back(MakeKeyEvent(true, 1, next++, 0, L'a', 0));
+            }
+            VERIFY_ARE_EQUAL(inputBuffer.Write(records), records.size());
+
+            outEvents.clear();
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 30, false, false, true, false));
+            VERIFY_ARE_EQUAL(outEvents.size(), 30u);
+            for (const auto& e : outEvents)
+            {
+                VERIFY_ARE_EQUAL(e.Event.KeyEvent.wVirtualKeyCode, expected++);
+            }
+        }
+
+        outEvents.clear();
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, SIZE_MAX, false, false, true, false));
+        VERIFY_ARE_EQUAL(outEvents.size(), static_cast<size_t>(next - expected));
+        for (const auto& e : outEvents)
+        {
+            VERIFY_ARE_EQUAL(e.Event.KeyEvent.wVirtualKeyCode, expected++);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(WrittenStringIsConsumedAsText)
+    {
+        InputBuffer inputBuffer;
+        wchar_t wch = 0;
+
+        VERIFY_ARE_EQUAL(inputBuffer.WriteString(L"ab"), 2u);
+        VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(wch));
+        VERIFY_ARE_EQUAL(L'a', wch);
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(wch));
+        VERIFY_ARE_EQUAL(L'b', wch);
+        VERIFY_IS_FALSE(inputBuffer.ConsumeText(wch));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(WrittenStringIsSynthesizedInOrder)
+    {
+        InputBuffer inputBuffer;
+        const auto record = MakeKeyEvent(true, 1, L'Z', 0, L'Z', SHIFT_PRESSED);
+        InputEventQueue outEvents;
+        wchar_t wch = 0;
+
+        VERIFY_ARE_EQUAL(inputBuffer.WriteString(L"ab"), 2u);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(record), 1u);
+
+        // The text now precedes a key event, so it can't be consumed as text anymore.
+        VERIFY_IS_FALSE(inputBuffer.ConsumeText(wch));
+
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, SIZE_MAX, false, false, true, false));
+        VERIFY_IS_GREATER_THAN(outEvents.size(), 2u);
+        VERIFY_ARE_EQUAL(L'a', outEvents.front().Event.KeyEvent.uChar.UnicodeChar);
+        VERIFY_IS_TRUE(!!outEvents.front().Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(record, outEvents.back());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
 };
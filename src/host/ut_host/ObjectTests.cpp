@@ -97,4 +97,37 @@ class ObjectTests
         VERIFY_ARE_EQUAL(1ul, newOutputAsHeader->_ulWriterCount);
         VERIFY_ARE_EQUAL(0ul, newOutputAsHeader->_ulWriteShareCount);
     }
+
+    TEST_METHOD(TestHandleAllocationIsRecycled)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& existingOutput = gci.GetActiveOutputBuffer();
+
+        SCREEN_INFORMATION* newOutput;
+
+        VERIFY_NT_SUCCESS(SCREEN_INFORMATION::CreateInstance(existingOutput.GetViewport().Dimensions(),
+                                                             existingOutput.GetCurrentFont(),
+                                                             existingOutput.GetBufferSize().Dimensions(),
+                                                             existingOutput.GetAttributes(),
+                                                             existingOutput.GetPopupAttributes(),
+                                                             existingOutput.GetTextBuffer().GetCursor().GetSize(),
+                                                             &newOutput));
+
+        Log::Comment(L"Keep one handle open, so that closing the other one doesn't remove the buffer.");
+        std::unique_ptr<ConsoleHandleData> keepAlive;
+        VERIFY_SUCCEEDED(newOutput->AllocateIoHandle(ConsoleHandleData::HandleType::Output, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, keepAlive));
+        keepAlive.release(); // leak the pointer because destruction would remove the buffer
+
+        std::unique_ptr<ConsoleHandleData> handle;
+        VERIFY_SUCCEEDED(newOutput->AllocateIoHandle(ConsoleHandleData::HandleType::Output, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, handle));
+        const auto first = handle.get();
+        handle.reset();
+
+        Log::Comment(L"Closing a handle returns its memory to the free list, where the next one gets it from.");
+        VERIFY_SUCCEEDED(newOutput->AllocateIoHandle(ConsoleHandleData::HandleType::Output, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, handle));
+        VERIFY_ARE_EQUAL(first, handle.get());
+        handle.release(); // leak the pointer because destruction would remove the buffer
+
+        VERIFY_ARE_EQUAL(2ul, static_cast<ConsoleObjectHeader*>(newOutput)->_ulOpenCount);
+    }
 };
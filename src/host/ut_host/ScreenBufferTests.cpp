@@ -163,6 +163,7 @@ class ScreenBufferTests
 
     TEST_METHOD(BackspaceDefaultAttrs);
     TEST_METHOD(BackspaceDefaultAttrsWriteCharsLegacy);
+    TEST_METHOD(WriteCharsLegacyControlCharRuns);
 
     TEST_METHOD(BackspaceDefaultAttrsInPrompt);
 
@@ -2960,6 +2961,35 @@ void ScreenBufferTests::BackspaceDefaultAttrsWriteCharsLegacy()
     VERIFY_ARE_EQUAL(magenta, renderSettings.GetAttributeColors(attrB).second);
 }
 
+void ScreenBufferTests::WriteCharsLegacyControlCharRuns()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const auto& tbi = si.GetTextBuffer();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+
+    VERIFY_SUCCEEDED(si.SetViewportOrigin(true, til::point(0, 0), true));
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(L"Control characters have to be found no matter where they are within the vectorized scan.");
+    WriteCharsLegacy(si, L"0123456789abcdef\x7f\r\nab\tc\r\n012345\n", false, nullptr);
+
+    VERIFY_ARE_EQUAL(til::point(0, 3), cursor.GetPosition());
+    VERIFY_ARE_EQUAL(L"0123456789abcdef", tbi.GetRowByOffset(0).GetText().substr(0, 16));
+    VERIFY_ARE_NOT_EQUAL(L'\x7f', tbi.GetRowByOffset(0).GetText().at(16));
+    VERIFY_ARE_EQUAL(L"ab      c", tbi.GetRowByOffset(1).GetText().substr(0, 9));
+    VERIFY_ARE_EQUAL(L"012345", tbi.GetRowByOffset(2).GetText().substr(0, 6));
+
+    Log::Comment(L"A CRLF returns the cursor even if LF alone wouldn't.");
+    WI_SetFlag(si.OutputMode, DISABLE_NEWLINE_AUTO_RETURN);
+    auto restoreMode = wil::scope_exit([&] { WI_ClearFlag(si.OutputMode, DISABLE_NEWLINE_AUTO_RETURN); });
+
+    WriteCharsLegacy(si, L"abc\n", false, nullptr);
+    VERIFY_ARE_EQUAL(til::point(3, 4), cursor.GetPosition());
+    WriteCharsLegacy(si, L"d\r\n", false, nullptr);
+    VERIFY_ARE_EQUAL(til::point(0, 5), cursor.GetPosition());
+}
+
 void ScreenBufferTests::BackspaceDefaultAttrsInPrompt()
 {
     // Tests MSFT:19853701 - when you edit the prompt line at a bash prompt,
@@ -158,4 +158,38 @@ class SearchTests
         s.ResetIfStale(gci.renderData, L"\x304b", true, true);
         DoFoundChecks(s, { 2, 3 }, -1);
     }
+
+    TEST_METHOD(IncrementalUpdateMatchesFullSearch)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        Search s;
+        s.ResetIfStale(gci.renderData, L"AB", false, false);
+
+        // Modify a row, including one that spans into the next one, and rotate the first row out of the buffer.
+        const auto width = textBuffer.GetSize().Width();
+        RowWriteState state{ .text = L"xAB" };
+        textBuffer.GetMutableRowByOffset(5).ReplaceText(state);
+        state = { .text = L"A", .columnBegin = width - 1 };
+        textBuffer.GetMutableRowByOffset(6).ReplaceText(state);
+        state = { .text = L"B" };
+        textBuffer.GetMutableRowByOffset(7).ReplaceText(state);
+        textBuffer.IncrementCircularBuffer();
+
+        // ResetIfStale() only searches through the modified rows, which must yield the same results as a new search.
+        VERIFY_IS_TRUE(s.ResetIfStale(gci.renderData, L"AB", false, false));
+
+        Search expected;
+        expected.ResetIfStale(gci.renderData, L"AB", false, false);
+
+        const auto first = *expected.GetCurrent();
+        do
+        {
+            VERIFY_ARE_EQUAL(expected.GetCurrent()->start, s.GetCurrent()->start);
+            VERIFY_ARE_EQUAL(expected.GetCurrent()->end, s.GetCurrent()->end);
+            expected.FindNext();
+            s.FindNext();
+        } while (expected.GetCurrent()->start != first.start);
+    }
 };
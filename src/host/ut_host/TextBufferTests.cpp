@@ -12,6 +12,7 @@
 
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
+#include "../buffer/out/BufferSnapshot.hpp"
 
 #include "input.h"
 #include "_stream.h"
@@ -141,6 +142,8 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsPreservesCombiningCharacters);
+    TEST_METHOD(TestRowReplaceTextGraphemes);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -148,12 +151,27 @@ class TextBufferTests
     TEST_METHOD(TestBurrito);
     TEST_METHOD(TestOverwriteChars);
     TEST_METHOD(TestRowReplaceText);
+    TEST_METHOD(TestCopyRect);
+    TEST_METHOD(TestWriteCharInfos);
+    TEST_METHOD(TestExportCharInfos);
+    TEST_METHOD(TestFillCharacters);
+    TEST_METHOD(TestColdScrollback);
+    TEST_METHOD(TestTrimWorkingSet);
+    TEST_METHOD(TestLargePages);
+    TEST_METHOD(TestSnapshot);
+    TEST_METHOD(TestScrollbackArchive);
+    TEST_METHOD(TestBufferSnapshot);
+    TEST_METHOD(TestSearchTextLiteral);
+    TEST_METHOD(TestSearchTextIndexed);
+    TEST_METHOD(TestRowMutationTracking);
+    TEST_METHOD(TestAttributeArena);
 
     TEST_METHOD(TestAppendRTFText);
 
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
     TEST_METHOD(MoveByWord);
+    TEST_METHOD(GetWordBoundariesAcrossGlyphs);
     TEST_METHOD(GetGlyphBoundaries);
 
     TEST_METHOD(GetTextRects);
@@ -161,6 +179,8 @@ class TextBufferTests
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+
+    TEST_METHOD(LazyRowReset);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1866,6 +1886,33 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// ScrollRows() copies rows of the same width verbatim. This tests that this works
+// for rows whose text doesn't fit into their buffer and had to be stored on the heap.
+void TextBufferTests::ScrollRowsPreservesCombiningCharacters()
+{
+    const til::size bufferSize{ 8, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // Each column holds an "e" and a combining acute accent, which makes the text twice as long as the row is wide.
+    const auto accented = L"e\x0301";
+    for (til::CoordType x = 0; x < bufferSize.width; ++x)
+    {
+        _buffer->GetMutableRowByOffset(0).ReplaceCharacters(x, 1, accented);
+    }
+    const std::wstring expected{ _buffer->GetRowByOffset(0).GetText() };
+    VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(bufferSize.width * 2), expected.size());
+
+    _buffer->ScrollRows(0, 1, 2);
+    VERIFY_ARE_EQUAL(expected, std::wstring{ _buffer->GetRowByOffset(2).GetText() });
+
+    // Scrolling a short row over it must not leave any of the long text behind.
+    _buffer->GetMutableRowByOffset(3).ReplaceCharacters(0, 1, L"x");
+    _buffer->ScrollRows(3, 1, -1);
+    VERIFY_ARE_EQUAL(L"x       ", std::wstring{ _buffer->GetRowByOffset(2).GetText() });
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -2084,6 +2131,634 @@ void TextBufferTests::TestRowReplaceText()
 #undef complex
 }
 
+void TextBufferTests::TestRowReplaceTextGraphemes()
+{
+    static constexpr til::size bufferSize{ 10, 1 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& row = buffer.GetMutableRowByOffset(0);
+
+#define accented L"e\x0301"
+#define family L"\U0001F468\x200D\U0001F469\x200D\U0001F467"
+
+    // The combining accent and the ZWJ sequence are stored in the column of the codepoint they're joined with.
+    RowWriteState state{ .text = L"a" accented family L"x" };
+    row.ReplaceText(state);
+    VERIFY_ARE_EQUAL(5, state.columnEnd);
+    VERIFY_ARE_EQUAL(L"", state.text);
+    VERIFY_ARE_EQUAL(L"a", row.GlyphAt(0));
+    VERIFY_ARE_EQUAL(accented, row.GlyphAt(1));
+    VERIFY_ARE_EQUAL(family, row.GlyphAt(2));
+    VERIFY_ARE_EQUAL(L"x", row.GlyphAt(4));
+
+    // A combining mark right after the last column that fits into the row still belongs to it.
+    state = RowWriteState{ .text = L"123456789" accented L"z" };
+    row.ReplaceText(state);
+    VERIFY_ARE_EQUAL(10, state.columnEnd);
+    VERIFY_ARE_EQUAL(L"z", state.text);
+    VERIFY_ARE_EQUAL(accented, row.GlyphAt(9));
+
+#undef family
+#undef accented
+}
+
+void TextBufferTests::TestCopyRect()
+{
+    til::size bufferSize{ 10, 3 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextAttribute red{ 0x4c };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+// scientist emoji U+1F9D1 U+200D U+1F52C
+#define complex L"\U0001F9D1\U0000200D\U0001F52C"
+
+    auto& row0 = buffer.GetMutableRowByOffset(0);
+    row0.ReplaceCharacters(0, 1, L"a");
+    row0.ReplaceCharacters(1, 2, complex);
+    row0.ReplaceCharacters(3, 1, L"b");
+    row0.ReplaceCharacters(4, 1, L"c");
+    row0.ReplaceAttributes(3, 4, red);
+
+    // Moving a block to the right within the same row copies it as-is, attributes included.
+    buffer.CopyRect({ 0, 0, 4, 1 }, { 5, 0 });
+    VERIFY_ARE_EQUAL(L"a" complex L"bc" L"a" complex L"b ", buffer.GetRowByOffset(0).GetText());
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(0).GetAttrByColumn(8));
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(0).GetAttrByColumn(9));
+
+    // Wide glyphs that are cut in half by the source rectangle turn into whitespace.
+    // Moving the rows down must not overwrite rows that haven't been copied yet.
+    buffer.CopyRect({ 2, 0, 5, 1 }, { 0, 1 });
+    buffer.CopyRect({ 0, 0, 10, 2 }, { 0, 1 });
+    VERIFY_ARE_EQUAL(L"a" complex L"bc" L"a" complex L"b ", buffer.GetRowByOffset(1).GetText());
+    VERIFY_ARE_EQUAL(L" bc       ", buffer.GetRowByOffset(2).GetText());
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(2).GetAttrByColumn(1));
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(2).GetAttrByColumn(2));
+
+#undef complex
+}
+
+void TextBufferTests::TestWriteCharInfos()
+{
+    til::size bufferSize{ 10, 1 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    const auto& row = buffer.GetRowByOffset(0);
+
+    const CHAR_INFO charInfos[]{
+        { { L'a' }, 0x1f },
+        { { L'\u304b' }, 0x1f | COMMON_LVB_LEADING_BYTE },
+        { { L'\u304b' }, 0x1f | COMMON_LVB_TRAILING_BYTE },
+        { { L'b' }, 0x2f },
+        { { L'c' }, 0x2f | COMMON_LVB_TRAILING_BYTE },
+        { { L'd' }, 0x2f },
+        { { L'\u304c' }, 0x2f | COMMON_LVB_LEADING_BYTE },
+    };
+
+    // Complete lead/trail pairs are written as wide glyphs, orphaned trailing halves are ignored
+    // and a leading half that doesn't fit into the last column gets replaced with whitespace.
+    buffer.WriteCharInfos(charInfos, { 3, 0 });
+    VERIFY_ARE_EQUAL(L"   a\u304bb d ", row.GetText());
+    VERIFY_IS_TRUE(row.WasDoubleBytePadded());
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x1f }, row.GetAttrByColumn(5));
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x2f }, row.GetAttrByColumn(9));
+
+    // A trailing half at the start of the request restores the entire wide glyph.
+    buffer.WriteCharInfos(std::span{ charInfos }.subspan(2, 2), { 1, 0 });
+    VERIFY_ARE_EQUAL(L"\u304bba\u304bb d ", row.GetText());
+}
+
+void TextBufferTests::TestExportCharInfos()
+{
+    til::size bufferSize{ 10, 1 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& row = buffer.GetMutableRowByOffset(0);
+
+    row.ReplaceCharacters(0, 1, L"a");
+    row.ReplaceCharacters(1, 2, L"\u304b");
+    row.ReplaceCharacters(3, 2, L"\U0001F52C");
+    row.ReplaceAttributes(2, 4, TextAttribute{ 0x1f });
+
+    // Starting on a trailing half and ending on a leading half keeps their flags, and
+    // glyphs that don't fit into a single UTF-16 code unit are replaced with U+FFFD.
+    std::array<CHAR_INFO, 3> charInfos{};
+    VERIFY_ARE_EQUAL(size_t{ 3 }, row.ExportCharInfos(2, charInfos));
+    VERIFY_ARE_EQUAL(L'\u304b', charInfos[0].Char.UnicodeChar);
+    VERIFY_ARE_EQUAL(WORD{ 0x1f | COMMON_LVB_TRAILING_BYTE }, charInfos[0].Attributes);
+    VERIFY_ARE_EQUAL(UNICODE_REPLACEMENT, charInfos[1].Char.UnicodeChar);
+    VERIFY_ARE_EQUAL(WORD{ 0x1f | COMMON_LVB_LEADING_BYTE }, charInfos[1].Attributes);
+    VERIFY_ARE_EQUAL(UNICODE_REPLACEMENT, charInfos[2].Char.UnicodeChar);
+    VERIFY_ARE_EQUAL(WORD{ 0x7f | COMMON_LVB_TRAILING_BYTE }, charInfos[2].Attributes);
+
+    // The export stops at the end of the row.
+    std::array<WORD, 4> attributes{};
+    VERIFY_ARE_EQUAL(size_t{ 2 }, row.ExportLegacyAttributes(8, attributes));
+    VERIFY_ARE_EQUAL(WORD{ 0x7f }, attributes[0]);
+    VERIFY_ARE_EQUAL(WORD{ 0x7f }, attributes[1]);
+}
+
+void TextBufferTests::TestFillCharacters()
+{
+    til::size bufferSize{ 10, 2 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& row0 = buffer.GetMutableRowByOffset(0);
+    auto& row1 = buffer.GetMutableRowByOffset(1);
+
+    row0.ReplaceCharacters(1, 2, L"\u304b");
+    row0.ReplaceCharacters(5, 2, L"\U0001F52C");
+    row0.SetWrapForced(true);
+
+    // Wide glyphs cut in half by the filled range turn into whitespace.
+    RowWriteState state{
+        .text = L"x",
+        .columnBegin = 2,
+        .columnLimit = 6,
+    };
+    row0.FillText(state);
+    VERIFY_ARE_EQUAL(L"  xxxx    ", row0.GetText());
+    VERIFY_ARE_EQUAL(1, state.columnBeginDirty);
+    VERIFY_ARE_EQUAL(6, state.columnEnd);
+    VERIFY_ARE_EQUAL(7, state.columnEndDirty);
+
+    // Filling continues on the next row and unsets the wrap flag of the rows it filled up to the end.
+    VERIFY_ARE_EQUAL(size_t{ 12 }, buffer.FillCharacters({ 4, 0 }, 12, L'y'));
+    VERIFY_ARE_EQUAL(L"  xxyyyyyy", row0.GetText());
+    VERIFY_ARE_EQUAL(L"yyyyyy    ", row1.GetText());
+    VERIFY_IS_FALSE(row0.WasWrapForced());
+
+    // Filling stops at the end of the buffer.
+    VERIFY_ARE_EQUAL(size_t{ 2 }, buffer.FillAttributes({ 8, 1 }, 5, TextAttribute{ 0x1f }));
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x1f }, row1.GetAttrByColumn(8));
+    VERIFY_ARE_EQUAL(attr, row1.GetAttrByColumn(7));
+}
+
+void TextBufferTests::TestColdScrollback()
+{
+    // The buffer needs to be large enough for TextBuffer to compress the rows that aged out of the hot ones.
+    static constexpr til::CoordType width = 20;
+    static constexpr auto height = gsl::narrow_cast<til::CoordType>(TextBuffer::_hotRowCount + 2 * TextBuffer::_coldBlockRowCount);
+    static constexpr auto scrolled = gsl::narrow_cast<til::CoordType>(TextBuffer::_coldBlockRowCount);
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ { width, height }, attr, 12, false, _renderer };
+
+    const auto expectedText = [](til::CoordType y) {
+        // Every third row contains a wide glyph, which ROW::Compress() can't store in its simplified form.
+        auto text = fmt::format(L"{}{}", y, y % 3 == 0 ? L"\U0001F41B" : L"");
+        text.resize(width, L' ');
+        return text;
+    };
+    const auto expectedAttr = [](til::CoordType y) {
+        return TextAttribute{ gsl::narrow_cast<WORD>(y % 16) };
+    };
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        auto& row = buffer.GetMutableRowByOffset(y);
+        RowWriteState state{ .text = expectedText(y) };
+        row.ReplaceText(state);
+        row.ReplaceAttributes(0, 1, expectedAttr(y));
+        row.SetWrapForced(y % 2 == 1);
+    }
+
+    // Scrolling by one block moves the block right above the hot rows out of them.
+    for (til::CoordType i = 0; i < scrolled; ++i)
+    {
+        buffer.IncrementCircularBuffer();
+    }
+    VERIFY_ARE_EQUAL(size_t{ 1 }, buffer._coldBlockCount);
+    // The cold rows store their runs as handles to the 16 distinct attributes of column 0 and the fill attribute.
+    VERIFY_ARE_EQUAL(size_t{ 17 }, buffer._coldAttributes.size());
+
+    // Reading the rows must transparently decompress them again.
+    for (til::CoordType y = 0; y < height - scrolled; ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(expectedText(y + scrolled), row.GetText());
+        VERIFY_ARE_EQUAL(expectedAttr(y + scrolled), row.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(attr, row.GetAttrByColumn(1));
+        VERIFY_ARE_EQUAL((y + scrolled) % 2 == 1, row.WasWrapForced());
+    }
+    VERIFY_ARE_EQUAL(size_t{ 0 }, buffer._coldBlockCount);
+    VERIFY_ARE_EQUAL(size_t{ 0 }, buffer._coldAttributes.size());
+}
+
+void TextBufferTests::TestTrimWorkingSet()
+{
+    // Unlike the cold scrollback above, trimming also applies to buffers smaller than _hotRowCount.
+    static constexpr til::CoordType width = 20;
+    static constexpr auto height = gsl::narrow_cast<til::CoordType>(4 * TextBuffer::_coldBlockRowCount);
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ { width, height }, attr, 12, false, _renderer };
+
+    const auto expectedText = [](til::CoordType y) {
+        auto text = fmt::format(L"{}", y);
+        text.resize(width, L' ');
+        return text;
+    };
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        RowWriteState state{ .text = expectedText(y) };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    }
+
+    // The block with the first kept row in it stays uncompressed.
+    const auto before = buffer.GetMemoryUsage();
+    buffer.TrimWorkingSet(height - 1);
+    VERIFY_ARE_EQUAL(size_t{ 3 }, buffer._coldBlockCount);
+
+    const auto after = buffer.GetMemoryUsage();
+    VERIFY_ARE_EQUAL(size_t{ 0 }, before.coldRows);
+    VERIFY_IS_GREATER_THAN(after.coldRows, size_t{ 0 });
+    VERIFY_IS_LESS_THAN(after.rows, before.rows);
+
+    // Trimming twice doesn't change anything.
+    buffer.TrimWorkingSet(height - 1);
+    VERIFY_ARE_EQUAL(size_t{ 3 }, buffer._coldBlockCount);
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        VERIFY_ARE_EQUAL(expectedText(y), buffer.GetRowByOffset(y).GetText());
+    }
+    VERIFY_ARE_EQUAL(size_t{ 0 }, buffer._coldBlockCount);
+}
+
+void TextBufferTests::TestLargePages()
+{
+    // Whether this gets large pages depends on the SeLockMemoryPrivilege. Either way, the buffer must work the same.
+    static constexpr til::CoordType width = 200;
+    static constexpr til::CoordType height = 10000;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer::SetLargePagesEnabled(true);
+    auto reset = wil::scope_exit([]() noexcept { TextBuffer::SetLargePagesEnabled(false); });
+    TextBuffer buffer{ { width, height }, attr, 12, false, _renderer };
+    Log::Comment(buffer.IsUsingLargePages() ? L"Using large pages" : L"Using regular pages");
+
+    const auto expectedText = [](til::CoordType y, til::CoordType w) {
+        auto text = fmt::format(L"{}", y);
+        text.resize(w, L' ');
+        return text;
+    };
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        RowWriteState state{ .text = expectedText(y, width) };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    }
+
+    // Large pages can't be decommitted, so they're never compressed. Otherwise all but the last block are.
+    buffer.TrimWorkingSet(height - 1);
+    VERIFY_ARE_EQUAL(buffer.IsUsingLargePages() ? size_t{ 0 } : (height - 1) / TextBuffer::_coldBlockRowCount, buffer._coldBlockCount);
+
+    TextBuffer newBuffer{ { width / 2, height }, attr, 12, false, _renderer };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(buffer, newBuffer));
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        VERIFY_ARE_EQUAL(expectedText(y, width / 2), newBuffer.GetRowByOffset(y).GetText());
+    }
+}
+
+void TextBufferTests::TestSnapshot()
+{
+    static constexpr til::size bufferSize{ 10, 20 };
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+
+    const auto write = [&](til::CoordType y, std::wstring_view text) {
+        RowWriteState state{ .text = text };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    };
+    const auto verifySnapshot = [&](const TextBufferSnapshot& snapshot, til::CoordType rowBeg, til::CoordType rowEnd) {
+        VERIFY_ARE_EQUAL(rowBeg, snapshot.firstRow);
+        VERIFY_ARE_EQUAL(rowEnd - rowBeg, snapshot.buffer->TotalRowCount());
+        for (auto y = rowBeg; y < rowEnd; ++y)
+        {
+            VERIFY_ARE_EQUAL(buffer.GetRowByOffset(y).GetText(), snapshot.buffer->GetRowByOffset(y - rowBeg).GetText());
+        }
+    };
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        write(y, fmt::format(L"{}", y));
+    }
+
+    TextBufferSnapshot snapshot;
+    buffer.UpdateSnapshot(snapshot, 5, 15);
+    verifySnapshot(snapshot, 5, 15);
+
+    // The snapshot is a copy and doesn't change together with the buffer.
+    const std::wstring unchanged{ buffer.GetRowByOffset(7).GetText() };
+    write(7, L"changed");
+    VERIFY_ARE_EQUAL(unchanged, snapshot.buffer->GetRowByOffset(2).GetText());
+
+    // After scrolling by 2 rows, the modified row is now the first one of the range. The following 7 rows
+    // are still in the snapshot and only need to be moved, while the last 2 rows are new to it.
+    buffer.IncrementCircularBuffer();
+    buffer.IncrementCircularBuffer();
+    const auto mutationId = snapshot.buffer->GetLastMutationId();
+    buffer.UpdateSnapshot(snapshot, 5, 15);
+    verifySnapshot(snapshot, 5, 15);
+
+    for (til::CoordType y = 0; y < 10; ++y)
+    {
+        const auto copied = y == 0 || y >= 8;
+        VERIFY_ARE_EQUAL(copied, snapshot.buffer->IsRowMutatedSince(y, mutationId));
+    }
+
+    // A range of a different size results in a new snapshot.
+    buffer.UpdateSnapshot(snapshot, 0, 20);
+    verifySnapshot(snapshot, 0, 20);
+}
+
+void TextBufferTests::TestScrollbackArchive()
+{
+    static constexpr til::size bufferSize{ 10, 3 };
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+    buffer.SetScrollbackArchiveEnabled(true);
+
+    static constexpr std::array<std::wstring_view, 4> lines{ L"a", L"bb", L"c\U0001F41B", L"dddd" };
+
+    // Each line gets written into the bottom row and is recycled into the archive 3 scrolls later.
+    for (const auto& line : lines)
+    {
+        RowWriteState state{ .text = line };
+        buffer.GetMutableRowByOffset(bufferSize.height - 1).ReplaceText(state);
+        buffer.IncrementCircularBuffer();
+    }
+
+    // The 2 initially blank rows come first, followed by all but the last 2 lines.
+    VERIFY_ARE_EQUAL(size_t{ 4 }, buffer.GetArchivedRowCount());
+
+    for (size_t i = 0; i < buffer.GetArchivedRowCount(); ++i)
+    {
+        std::wstring expected{ i < 2 ? L"" : til::at(lines, i - 2) };
+        expected.resize(bufferSize.width, L' ');
+
+        auto& row = buffer.GetScratchpadRow();
+        buffer.ReadArchivedRow(i, row);
+        VERIFY_ARE_EQUAL(expected, row.GetText());
+    }
+
+    buffer.SetScrollbackArchiveEnabled(false);
+    VERIFY_ARE_EQUAL(size_t{ 0 }, buffer.GetArchivedRowCount());
+}
+
+void TextBufferTests::TestBufferSnapshot()
+{
+    static constexpr til::size bufferSize{ 10, 5 };
+    const TextAttribute attr{ 0x7f };
+    const auto path = std::filesystem::temp_directory_path() / L"TextBufferTests_TestBufferSnapshot.bin";
+    const auto cleanup = wil::scope_exit([&]() { std::filesystem::remove(path); });
+
+    const auto writeRow = [](TextBuffer& buffer, til::CoordType y, std::wstring_view text) {
+        RowWriteState state{ .text = text };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    };
+
+    {
+        TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+        writeRow(buffer, 0, L"a");
+        writeRow(buffer, 1, L"bb");
+        writeRow(buffer, 2, L"ccc");
+        buffer.GetCursor().SetPosition({ 0, 2 });
+
+        BufferSnapshot snapshot{ path };
+
+        // The first 2 rows are above the viewport and get captured right away.
+        snapshot.Capture(buffer, 2);
+        snapshot.Flush();
+
+        // Changing a row that was already written out makes the snapshot start over.
+        writeRow(buffer, 0, L"A");
+        snapshot.CaptureFinal(buffer, 2);
+        snapshot.Flush();
+    }
+
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+    VERIFY_IS_TRUE(BufferSnapshot::Restore(path, buffer));
+    VERIFY_ARE_EQUAL(3, buffer.GetCursor().GetPosition().y);
+
+    static constexpr std::array<std::wstring_view, 3> lines{ L"A", L"bb", L"ccc" };
+    for (til::CoordType y = 0; y < 3; ++y)
+    {
+        std::wstring expected{ til::at(lines, y) };
+        expected.resize(bufferSize.width, L' ');
+        VERIFY_ARE_EQUAL(expected, buffer.GetRowByOffset(y).GetText());
+    }
+}
+
+void TextBufferTests::TestSearchTextLiteral()
+{
+    static constexpr til::size bufferSize{ 10, 4 };
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x7f }, 12, false, _renderer };
+
+    static constexpr std::array<std::wstring_view, 4> rows{
+        L"abcAbcaaa",
+        L"a\U0001F41Bbc ABC",
+        L"ssSS\u00fc\u304baaa",
+        L"aaaaaaaaaa",
+    };
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        RowWriteState state{ .text = til::at(rows, y) };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    }
+
+    // Some of these span multiple rows, just like they would with ICU.
+    static constexpr std::array<std::wstring_view, 11> needles{
+        L"a",
+        L"abc",
+        L"aa",
+        L"a a",
+        L"c a",
+        L"bc",
+        L"ss",
+        L"aaaaaaaaaaaa",
+        L"\U0001F41B",
+        L"\u304b",
+        L"\u00fc",
+    };
+
+    // The literal fast path must return the exact same results as the ICU based implementation.
+    for (const auto& needle : needles)
+    {
+        for (const auto caseInsensitive : { false, true })
+        {
+            const auto isAscii = std::all_of(needle.begin(), needle.end(), [](const auto ch) { return ch < 0x80; });
+            if (caseInsensitive && !isAscii)
+            {
+                continue;
+            }
+
+            Log::Comment(NoThrowString().Format(L"needle: \"%.*s\", caseInsensitive: %d", gsl::narrow_cast<int>(needle.size()), needle.data(), caseInsensitive));
+
+            std::vector<til::point_span> expected;
+            std::vector<til::point_span> actual;
+            buffer._searchTextRegex(needle, caseInsensitive, 0, bufferSize.height, 0, expected);
+            VERIFY_IS_TRUE(buffer._searchTextLiteral(needle, caseInsensitive, 0, bufferSize.height, 0, actual));
+
+            VERIFY_ARE_EQUAL(expected.size(), actual.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(til::at(expected, i).start, til::at(actual, i).start);
+                VERIFY_ARE_EQUAL(til::at(expected, i).end, til::at(actual, i).end);
+            }
+        }
+    }
+
+    // U+212A KELVIN SIGN folds to "k" and so case-insensitive searches must fall back to ICU.
+    RowWriteState state{ .text = L"\u212A" };
+    buffer.GetMutableRowByOffset(0).ReplaceText(state);
+    std::vector<til::point_span> results;
+    VERIFY_IS_FALSE(buffer._searchTextLiteral(L"k", true, 0, bufferSize.height, 0, results));
+    VERIFY_ARE_EQUAL(size_t{ 1 }, buffer.SearchText(L"k", true).size());
+}
+
+void TextBufferTests::TestSearchTextIndexed()
+{
+    // 40 rows make for 3 index blocks, the last of which is shorter than the others.
+    static constexpr til::size bufferSize{ 10, 40 };
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x7f }, 12, false, _renderer };
+    buffer.SetSearchIndexEnabled(true);
+
+    const auto write = [&](const til::CoordType y, const std::wstring_view& text, const til::CoordType x = 0) {
+        RowWriteState state{ .text = text, .columnBegin = x };
+        buffer.GetMutableRowByOffset(y).ReplaceText(state);
+    };
+
+    // The index must return the exact same results as a search through all rows.
+    const auto verify = [&](const std::wstring_view& needle, const bool caseInsensitive) {
+        Log::Comment(NoThrowString().Format(L"needle: \"%.*s\", caseInsensitive: %d", gsl::narrow_cast<int>(needle.size()), needle.data(), caseInsensitive));
+
+        std::vector<til::point_span> expected;
+        buffer._searchTextUnindexed(needle, caseInsensitive, {}, bufferSize.height, expected);
+        const auto actual = buffer.SearchText(needle, caseInsensitive);
+
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(til::at(expected, i).start, til::at(actual, i).start);
+            VERIFY_ARE_EQUAL(til::at(expected, i).end, til::at(actual, i).end);
+        }
+        return actual.size();
+    };
+
+    write(3, L"foo bar");
+    write(15, L"foo", 7);
+    write(16, L" baz");
+    write(38, L"FOO BAR");
+    VERIFY_ARE_EQUAL(size_t{ 1 }, verify(L"foo bar", false));
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify(L"foo bar", true));
+    VERIFY_ARE_EQUAL(size_t{ 0 }, verify(L"foobar", true));
+    VERIFY_ARE_EQUAL(size_t{ 1 }, verify(L"bar   ", false));
+
+    // Longer than a row.
+    write(20, L"0123456789");
+    write(21, L"0123456789");
+    VERIFY_ARE_EQUAL(size_t{ 1 }, verify(L"6789012345678", false));
+
+    // Modifications must invalidate the index. Row 16 is the first one of the second block,
+    // but it also contains the end of trigrams that begin in the last row of the first block.
+    write(16, L" bar");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify(L"foo bar", false));
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify(L"foo", false));
+
+    // U+212A KELVIN SIGN folds to "k", which the index doesn't know about.
+    write(30, L"\u212Aey");
+    VERIFY_ARE_EQUAL(size_t{ 1 }, verify(L"key", true));
+    VERIFY_ARE_EQUAL(size_t{ 0 }, verify(L"key", false));
+
+    // Rotating the buffer must drop the recycled row from the index.
+    for (auto i = 0; i < 4; ++i)
+    {
+        buffer.IncrementCircularBuffer();
+    }
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify(L"foo bar", true));
+    write(bufferSize.height - 1, L"foo bar");
+    VERIFY_ARE_EQUAL(size_t{ 2 }, verify(L"foo bar", false));
+
+    buffer.SetSearchIndexEnabled(false);
+    VERIFY_IS_TRUE(buffer._searchIndex.empty());
+}
+
+void TextBufferTests::TestRowMutationTracking()
+{
+    static constexpr til::size bufferSize{ 10, 40 };
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x7f }, 12, false, _renderer };
+
+    auto mutationId = buffer.GetLastMutationId();
+    VERIFY_ARE_EQUAL(bufferSize.height, buffer.GetFirstRowMutatedSince(mutationId));
+
+    // Rows are tracked individually, even though they're checked in blocks of 16 rows.
+    buffer.GetMutableRowByOffset(20);
+    buffer.GetMutableRowByOffset(23);
+    VERIFY_ARE_EQUAL(20, buffer.GetFirstRowMutatedSince(mutationId));
+    VERIFY_ARE_EQUAL(23, buffer.GetFirstRowMutatedSince(mutationId, 21, bufferSize.height));
+    VERIFY_ARE_EQUAL(22, buffer.GetFirstRowMutatedSince(mutationId, 21, 22));
+    VERIFY_IS_TRUE(buffer.IsRowMutatedSince(20, mutationId));
+    VERIFY_IS_FALSE(buffer.IsRowMutatedSince(21, mutationId));
+
+    // The recycled row counts as modified and it's now the last one.
+    mutationId = buffer.GetLastMutationId();
+    const auto rotationCount = buffer.GetRotationCount();
+    buffer.IncrementCircularBuffer();
+    VERIFY_ARE_EQUAL(rotationCount + 1, buffer.GetRotationCount());
+    VERIFY_ARE_EQUAL(bufferSize.height - 1, buffer.GetFirstRowMutatedSince(mutationId));
+
+    // The rows of the last block wrap around to the beginning of the buffer.
+    mutationId = buffer.GetLastMutationId();
+    buffer.GetMutableRowByOffset(bufferSize.height - 1);
+    buffer.GetMutableRowByOffset(5);
+    VERIFY_ARE_EQUAL(5, buffer.GetFirstRowMutatedSince(mutationId));
+    VERIFY_ARE_EQUAL(bufferSize.height - 1, buffer.GetFirstRowMutatedSince(mutationId, 6, bufferSize.height));
+}
+
+void TextBufferTests::TestAttributeArena()
+{
+    static constexpr til::size bufferSize{ 10, 100 };
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x7f }, 12, false, _renderer };
+    buffer.SetAttributeArenaEnabled(true);
+
+    // Give the rows between 2 and 10 attribute runs, none of which fit into the inline storage of a ROW.
+    std::vector<RowAttributes> expected;
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        auto& row = buffer.GetMutableRowByOffset(y);
+        for (til::CoordType x = 0; x <= y % 5; ++x)
+        {
+            row.ReplaceAttributes(x * 2, x * 2 + 1, TextAttribute{ gsl::narrow_cast<WORD>(x) });
+        }
+        expected.emplace_back(row.Attributes());
+    }
+
+    const auto arenaOf = [&](til::CoordType y) {
+        return buffer.GetRowByOffset(y).Attributes().runs().get_allocator().arena;
+    };
+
+    // Copies of the attributes don't allocate from the arena...
+    VERIFY_IS_NULL(expected.front().runs().get_allocator().arena);
+    // ...but the ROWs do, with 1 arena per 64 rows (the first ROW in memory is the scratchpad row).
+    VERIFY_IS_NOT_NULL(arenaOf(0));
+    VERIFY_ARE_EQUAL(arenaOf(0), arenaOf(62));
+    VERIFY_ARE_NOT_EQUAL(arenaOf(62), arenaOf(63));
+    VERIFY_IS_GREATER_THAN(arenaOf(0)->GetReservedSize(), size_t{ 0 });
+
+    VERIFY_SUCCEEDED(buffer.ResizeTraditional({ bufferSize.width, 50 }));
+
+    for (til::CoordType y = 0; y < 50; ++y)
+    {
+        VERIFY_IS_NOT_NULL(arenaOf(y));
+        VERIFY_IS_TRUE(buffer.GetRowByOffset(y).Attributes() == til::at(expected, y));
+    }
+}
+
 void TextBufferTests::TestAppendRTFText()
 {
     {
@@ -2328,6 +3003,51 @@ void TextBufferTests::MoveByWord()
     }
 }
 
+void TextBufferTests::GetWordBoundariesAcrossGlyphs()
+{
+    til::size bufferSize{ 80, 9001 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // The first line contains a delimiter outside of the ASCII range and a combining mark after the "e".
+    // The second line contains two wide glyphs, which occupy 2 columns each.
+    const std::vector<std::wstring> text = { L"ab\u2502cd e\u0301f",
+                                             L"\u3042\u3042 x" };
+    WriteLinesToBuffer(text, *_buffer);
+
+    const std::wstring_view delimiters = L" \u2502";
+
+    VERIFY_ARE_EQUAL(til::point(0, 0), _buffer->GetWordStart({ 1, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(1, 0), _buffer->GetWordEnd({ 0, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(2, 0), _buffer->GetWordStart({ 2, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(2, 0), _buffer->GetWordEnd({ 2, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(3, 0), _buffer->GetWordStart({ 4, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(6, 0), _buffer->GetWordStart({ 7, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(7, 0), _buffer->GetWordEnd({ 6, 0 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(79, 0), _buffer->GetWordEnd({ 8, 0 }, delimiters));
+
+    VERIFY_ARE_EQUAL(til::point(0, 1), _buffer->GetWordStart({ 3, 1 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(3, 1), _buffer->GetWordEnd({ 0, 1 }, delimiters));
+    VERIFY_ARE_EQUAL(til::point(3, 1), _buffer->GetWordEnd({ 1, 1 }, delimiters));
+
+    // Without the wide delimiter "ab\u2502cd" is a single word.
+    VERIFY_ARE_EQUAL(til::point(0, 0), _buffer->GetWordStart({ 4, 0 }, L" "));
+    VERIFY_ARE_EQUAL(til::point(4, 0), _buffer->GetWordEnd({ 0, 0 }, L" "));
+
+    auto pos = til::point{ 0, 0 };
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(3, 0), pos);
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(6, 0), pos);
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(0, 1), pos);
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(5, 1), pos);
+    VERIFY_IS_TRUE(_buffer->MoveToPreviousWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(0, 1), pos);
+}
+
 void TextBufferTests::GetGlyphBoundaries()
 {
     struct ExpectedResult
@@ -2725,8 +3445,14 @@ void TextBufferTests::HyperlinkTrim()
     _buffer->GetMutableRowByOffset(otherPos.y).SetAttrToEnd(otherPos.x, newAttr);
     _buffer->AddHyperlinkToMap(otherUrl, otherId);
 
-    // Increment the circular buffer
-    _buffer->IncrementCircularBuffer();
+    // Increment the circular buffer. Obsolete references are only collected once per
+    // buffer height of increments, so we need to circle it entirely. We keep writing
+    // the other hyperlink into the newest row, so that it remains in the buffer.
+    for (auto i = 0; i < bufferSize.height; ++i)
+    {
+        _buffer->IncrementCircularBuffer();
+        _buffer->GetMutableRowByOffset(bufferSize.height - 1).SetAttrToEnd(otherPos.x, newAttr);
+    }
 
     const auto finalCustomId = fmt::format(L"{}%{}", customId, til::hash(url));
     const auto finalOtherCustomId = fmt::format(L"{}%{}", otherCustomId, til::hash(otherUrl));
@@ -2775,3 +3501,49 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// Reset() and ResetRowsFrom() only mark rows as stale. They must still look erased when they're accessed later.
+void TextBufferTests::LazyRowReset()
+{
+    const til::size bufferSize{ 20, 10 };
+    const TextAttribute attr{ 0x7f };
+    const TextAttribute eraseAttr{ 0x1e };
+    TextBuffer buffer{ bufferSize, attr, 12, false, _renderer };
+
+    const auto write = [&](til::CoordType y, std::wstring_view text) {
+        auto& row = buffer.GetMutableRowByOffset(y);
+        RowWriteState state{ .text = text };
+        row.ReplaceText(state);
+        row.SetLineRendition(LineRendition::DoubleWidth);
+    };
+    const auto verifyErased = [&](til::CoordType y, const TextAttribute& expected) {
+        const auto& row = buffer.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(std::wstring(bufferSize.width, L' '), std::wstring{ row.GetText() });
+        VERIFY_ARE_EQUAL(expected, row.GetAttrByColumn(0));
+        VERIFY_IS_TRUE(row.GetLineRendition() == LineRendition::SingleWidth);
+    };
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        write(y, L"abc");
+    }
+
+    Log::Comment(L"ResetRowsFrom() keeps the rows above the given one.");
+    buffer.ResetRowsFrom(3, eraseAttr);
+    for (til::CoordType y = 0; y < 3; ++y)
+    {
+        VERIFY_ARE_EQUAL(L"abc", buffer.GetRowByOffset(y).GetText().substr(0, 3));
+    }
+    for (til::CoordType y = 3; y < bufferSize.height; ++y)
+    {
+        verifyErased(y, eraseAttr);
+    }
+
+    Log::Comment(L"Rows written after a Reset() must not be reset again when they're accessed next.");
+    buffer.SetCurrentAttributes(attr);
+    buffer.Reset();
+    write(5, L"def");
+    VERIFY_ARE_EQUAL(L"def", buffer.GetRowByOffset(5).GetText().substr(0, 3));
+    verifyErased(0, attr);
+    verifyErased(9, attr);
+}
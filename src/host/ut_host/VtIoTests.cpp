@@ -392,6 +392,11 @@ public:
     {
         return {};
     }
+
+    bool HasPatternsInRow(const til::CoordType /*row*/) const
+    {
+        return false;
+    }
 };
 
 void VtIoTests::RendererDtorAndThread()
@@ -69,6 +69,7 @@ class Microsoft::Console::Render::VtRendererTest
     TEST_METHOD(Xterm256TestCursor);
     TEST_METHOD(Xterm256TestExtendedAttributes);
     TEST_METHOD(Xterm256TestAttributesAcrossReset);
+    TEST_METHOD(Xterm256TestResetIfShorter);
 
     TEST_METHOD(XtermTestInvalidate);
     TEST_METHOD(XtermTestColors);
@@ -79,6 +80,10 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestWrapping);
 
+    TEST_METHOD(TestSkipUnchangedCells);
+
+    TEST_METHOD(TestScrollRegion);
+
     TEST_METHOD(TestResize);
 
     TEST_METHOD(TestCursorVisibility);
@@ -890,6 +895,61 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
     VerifyExpectedInputsDrained();
 }
 
+void VtRendererTest::Xterm256TestResetIfShorter()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    VerifyFirstPaint(*engine);
+
+    TextAttribute plainAttrs;
+    plainAttrs.SetForeground(TextColor{ 0x00030201 });
+
+    auto fancyAttrs = plainAttrs;
+    fancyAttrs.SetIntense(true);
+    fancyAttrs.SetUnderlined(true);
+    fancyAttrs.SetItalic(true);
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Turn on a few attributes");
+        qExpectedInput.push_back("\x1b[38;2;1;2;3m");
+        qExpectedInput.push_back("\x1b[1m");
+        qExpectedInput.push_back("\x1b[4m");
+        qExpectedInput.push_back("\x1b[3m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(fancyAttrs, renderSettings, &renderData, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Turning the three off individually (15 bytes) is shorter than SGR 0 and the color (16 bytes)");
+        qExpectedInput.push_back("\x1b[22m");
+        qExpectedInput.push_back("\x1b[24m");
+        qExpectedInput.push_back("\x1b[23m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(plainAttrs, renderSettings, &renderData, false, false));
+    });
+
+    fancyAttrs.SetBlinking(true);
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Turn on one more attribute");
+        qExpectedInput.push_back("\x1b[1m");
+        qExpectedInput.push_back("\x1b[4m");
+        qExpectedInput.push_back("\x1b[3m");
+        qExpectedInput.push_back("\x1b[5m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(fancyAttrs, renderSettings, &renderData, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Now SGR 0 and the color (16 bytes) are shorter than turning the four off (20 bytes)");
+        qExpectedInput.push_back("\x1b[m");
+        qExpectedInput.push_back("\x1b[38;2;1;2;3m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(plainAttrs, renderSettings, &renderData, false, false));
+    });
+}
+
 void VtRendererTest::XtermTestInvalidate()
 {
     auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -1427,6 +1487,122 @@ void VtRendererTest::TestWrapping()
     });
 }
 
+void VtRendererTest::TestSkipUnchangedCells()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    VerifyFirstPaint(*engine);
+
+    const auto makeClusters = [](const std::wstring_view line) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1);
+        }
+        return clusters;
+    };
+
+    const auto clusters1 = makeClusters(L"asdfghjkl");
+    const auto clusters2 = makeClusters(L"asdfXhjkl");
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Make sure the cursor is at 0,0"));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting a line for the first time writes all of it."));
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters1.data(), clusters1.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting the same line again shouldn't write anything."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters1.data(), clusters1.size() }, { 0, 0 }, false, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing a single cell should only write that cell."));
+        qExpectedInput.push_back("\x1b[1;5H");
+        qExpectedInput.push_back("X");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters2.data(), clusters2.size() }, { 0, 0 }, false, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Writing a string we don't understand makes us repaint everything."));
+        qExpectedInput.push_back("\x1b[?1004h");
+        VERIFY_SUCCEEDED(engine->WriteTerminalW(L"\x1b[?1004h"));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("asdfXhjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters2.data(), clusters2.size() }, { 0, 0 }, false, false));
+    });
+}
+
+void VtRendererTest::TestScrollRegion()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    VerifyFirstPaint(*engine);
+
+    const auto view = SetUpViewport();
+    const til::rect region{ 0, 2, view.Width(), 10 };
+
+    Log::Comment(NoThrowString().Format(
+        L"Scrolling a region up moves the pending invalidation along and reveals the bottom row"));
+    til::rect invalid{ 0, 9, 5, 10 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    VERIFY_ARE_EQUAL(S_OK, engine->InvalidateScrollRegion(&region, -1));
+
+    Log::Comment(NoThrowString().Format(
+        L"A different region or direction can't be combined with the pending scroll"));
+    const til::rect otherRegion{ 0, 3, view.Width(), 10 };
+    VERIFY_ARE_EQUAL(S_FALSE, engine->InvalidateScrollRegion(&otherRegion, -1));
+    VERIFY_ARE_EQUAL(S_FALSE, engine->InvalidateScrollRegion(&region, 1));
+
+    TestPaint(*engine, [&]() {
+        const auto runs = engine->_invalidMap.runs();
+        VERIFY_ARE_EQUAL(2u, runs.size());
+        VERIFY_ARE_EQUAL((til::rect{ 0, 8, 5, 9 }), runs[0]);
+        VERIFY_ARE_EQUAL((til::rect{ 0, 9, view.Width(), 10 }), runs[1]);
+
+        qExpectedInput.push_back("\x1b[3;10r");
+        qExpectedInput.push_back("\x1b[S");
+        qExpectedInput.push_back("\x1b[r");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+        VERIFY_ARE_EQUAL(0, engine->_regionScrollDelta);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Consecutive scrolls of the same region get combined"));
+    VERIFY_ARE_EQUAL(S_OK, engine->InvalidateScrollRegion(&region, 1));
+    VERIFY_ARE_EQUAL(S_OK, engine->InvalidateScrollRegion(&region, 2));
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[3;10r");
+        qExpectedInput.push_back("\x1b[3T");
+        qExpectedInput.push_back("\x1b[r");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"When the whole viewport needs repainting, the region isn't scrolled"));
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    VERIFY_ARE_EQUAL(S_FALSE, engine->InvalidateScrollRegion(&region, -1));
+}
+
 void VtRendererTest::TestResize()
 {
     auto view = SetUpViewport();
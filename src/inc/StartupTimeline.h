@@ -0,0 +1,118 @@
+/*++
+Copyright (c) Microsoft Corporation.
+Licensed under the MIT license.
+
+Module Name:
+- StartupTimeline.h
+
+Abstract:
+- Marks the phases of the Windows Terminal startup, from wWinMain() to the first Present()
+  of the AtlasEngine. Every Mark() is logged as a "StartupPhase" TraceLogging event with the
+  TIL_KEYWORD_STARTUP keyword. If Terminal was launched with `--startup-profile <path>`,
+  it's additionally appended to that file as a line of the form `<microseconds>\t<phase>\n`.
+  Invoke-StartupBenchmark in tools/OpenConsole.psm1 uses those files.
+- The timestamps are QueryPerformanceCounter() based, which makes them monotonic and
+  comparable between all modules of the process.
+- Every module has its own copy of the state below. That's fine, because it's derived
+  from the command line of the process, which is the same for all of them.
+
+--*/
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <TraceLoggingProvider.h>
+
+namespace Microsoft::Console::StartupTimeline
+{
+    namespace details
+    {
+        // Returns the argument that follows "--startup-profile" on the command line of the process.
+        // This doesn't use CommandLineToArgvW(), because conhost links the AtlasEngine as well,
+        // and it shouldn't have to load shell32.dll just to find out that it's not being profiled.
+        inline std::wstring findProfilePath()
+        {
+            static constexpr std::wstring_view flag{ L"--startup-profile" };
+            static constexpr std::wstring_view whitespace{ L" \t" };
+
+            const std::wstring_view commandline{ GetCommandLineW() };
+            const auto pos = commandline.find(flag);
+            if (pos == std::wstring_view::npos)
+            {
+                return {};
+            }
+
+            auto rest = commandline.substr(pos + flag.size());
+            const auto beg = rest.find_first_not_of(whitespace);
+            if (beg == 0 || beg == std::wstring_view::npos)
+            {
+                return {};
+            }
+
+            rest = rest.substr(beg);
+            if (rest.front() == L'"')
+            {
+                rest = rest.substr(1);
+                return std::wstring{ rest.substr(0, rest.find(L'"')) };
+            }
+            return std::wstring{ rest.substr(0, rest.find_first_of(whitespace)) };
+        }
+
+        inline const std::wstring& profilePath()
+        {
+            static const auto path = findProfilePath();
+            return path;
+        }
+
+        inline uint64_t nowInMicroseconds() noexcept
+        {
+            LARGE_INTEGER counter;
+            LARGE_INTEGER frequency;
+            QueryPerformanceCounter(&counter);
+            QueryPerformanceFrequency(&frequency);
+
+            // This is split up, because counter * 1000000 overflows after a couple days of uptime.
+            const auto c = static_cast<uint64_t>(counter.QuadPart);
+            const auto f = static_cast<uint64_t>(frequency.QuadPart);
+            return c / f * 1000000 + c % f * 1000000 / f;
+        }
+    }
+
+    // Records that the startup reached the given phase. The phase names are PascalCase and
+    // come in Begin/End pairs for phases that take a while, like "SettingsLoadBegin".
+    // Phases that happen more than once (for instance, once per pane) are recorded every time.
+    inline void Mark(const TraceLoggingHProvider provider, const char* phase) noexcept
+    try
+    {
+        const auto timestamp = details::nowInMicroseconds();
+
+        TraceLoggingWrite(provider,
+                          "StartupPhase",
+                          TraceLoggingDescription("Logged when Windows Terminal reaches a phase of its startup"),
+                          TraceLoggingString(phase, "Phase"),
+                          TraceLoggingUInt64(timestamp, "TimestampUs", "QueryPerformanceCounter() in microseconds"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_STARTUP));
+
+        const auto& path = details::profilePath();
+        if (path.empty())
+        {
+            return;
+        }
+
+        auto line = std::to_string(timestamp);
+        line.push_back('\t');
+        line.append(phase);
+        line.push_back('\n');
+
+        // Each line is written with a single append, so the lines of different threads and processes don't interleave.
+        const wil::unique_hfile file{ CreateFileW(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (file)
+        {
+            DWORD written = 0;
+            LOG_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), line.data(), static_cast<DWORD>(line.size()), &written, nullptr));
+        }
+    }
+    CATCH_LOG()
+}
@@ -0,0 +1,54 @@
+/*++
+Copyright (c) Microsoft Corporation.
+Licensed under the MIT license.
+
+Module Name:
+- VtRecording.h
+
+Abstract:
+- The file format shared by the session recorder in TerminalApp (RecordingConnection)
+  and the vtreplay tool. A recording consists of a FileHeader followed by records.
+  Each record is a RecordHeader followed by `size` bytes of payload:
+  * Output, Input: the UTF-8 encoded text that the connection sent or received.
+  * Resize: a ResizePayload.
+- All values are little-endian.
+
+--*/
+#pragma once
+
+#include <cstdint>
+
+namespace Microsoft::Console::VtRecording
+{
+    inline constexpr uint32_t Magic = 0x52565457; // "WTVR"
+    inline constexpr uint32_t Version = 1;
+
+    enum class RecordType : uint8_t
+    {
+        Output = 0,
+        Input = 1,
+        Resize = 2,
+    };
+
+#pragma pack(push, 1)
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct RecordHeader
+    {
+        // In microseconds since the start of the recording.
+        uint64_t timestamp;
+        uint32_t size;
+        RecordType type;
+    };
+
+    struct ResizePayload
+    {
+        uint32_t rows;
+        uint32_t columns;
+    };
+#pragma pack(pop)
+}
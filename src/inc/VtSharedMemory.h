@@ -0,0 +1,355 @@
+/*++
+Copyright (c) Microsoft Corporation.
+Licensed under the MIT license.
+
+Module Name:
+- VtSharedMemory.h
+
+Abstract:
+- The protocol shared by the SharedMemoryConnection in TerminalConnection and the
+  VT producers it hosts, as well as a small client for the latter (see Client below).
+- ConptyConnection uses the same protocol to talk to OpenConsole, if the pseudoconsole
+  was created with ConptyCreatePseudoConsoleWithSharedMemory (see winconpty.cpp).
+- A section starts with a Header, which is followed by two single-producer single-consumer
+  byte rings of Header::ringCapacity bytes each: The output ring carries UTF-8 encoded VT
+  from the client to the terminal and the input ring carries it in the opposite direction.
+- The terminal creates the section and its events (see Server below) and passes the
+  section's handle value to the client process in the EnvironmentVariableName variable.
+  The Header stores the event handles as they're valid in the client process.
+  Since inherited handles have the same value in both processes, the terminal's
+  own values work if it creates them as inheritable handles.
+
+--*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cwchar>
+#include <span>
+#include <string_view>
+
+#include <wil/resource.h>
+
+namespace Microsoft::Console::VtSharedMemory
+{
+    inline constexpr uint32_t Magic = 0x4D535457; // "WTSM"
+    inline constexpr uint32_t Version = 1;
+    inline constexpr wchar_t EnvironmentVariableName[] = L"WT_VT_SHARED_MEMORY";
+    // Must be a power of 2.
+    inline constexpr uint32_t DefaultRingCapacity = 1024 * 1024;
+
+    // The write and read positions only ever increase. `write - read` is the number of unread bytes.
+    struct RingState
+    {
+        alignas(64) std::atomic<uint64_t> write;
+        alignas(64) std::atomic<uint64_t> read;
+        // Auto-reset events. The producer sets writtenEvent if the consumer caught up with it
+        // and the consumer sets drainedEvent if the producer might be waiting for free space.
+        alignas(64) uint64_t writtenEvent;
+        uint64_t drainedEvent;
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t ringCapacity;
+        // Set by the terminal once the connection is closed. All events are set afterwards.
+        std::atomic<uint32_t> closed;
+        // The size of the terminal in cells. sizeGeneration is incremented after
+        // each change and the input ring's writtenEvent gets set.
+        std::atomic<uint32_t> rows;
+        std::atomic<uint32_t> columns;
+        std::atomic<uint32_t> sizeGeneration;
+        RingState output;
+        RingState input;
+    };
+
+    constexpr size_t SectionSize(const uint32_t ringCapacity) noexcept
+    {
+        return sizeof(Header) + 2 * size_t{ ringCapacity };
+    }
+
+    // Either end of one of the two rings of a mapped section.
+    //
+    // Both ends publish their position and then check the other one's with sequentially consistent
+    // ordering. This guarantees that either the other end sees the new position, or we see that it's
+    // waiting for it (or might be), which is why an end only needs to set an event in the latter case.
+    class Ring
+    {
+    public:
+        Ring() = default;
+
+        Ring(RingState& state, char* data, const uint32_t capacity, HANDLE writtenEvent, HANDLE drainedEvent) noexcept :
+            _state{ &state },
+            _data{ data },
+            _capacity{ capacity },
+            _writtenEvent{ writtenEvent },
+            _drainedEvent{ drainedEvent }
+        {
+        }
+
+        // Copies as much of `text` into the ring as fits. Returns the number of bytes written.
+        size_t TryWrite(const std::string_view& text) const noexcept
+        {
+            const auto write = _state->write.load(std::memory_order_relaxed);
+            const auto read = _state->read.load();
+            const auto count = static_cast<size_t>(std::min<uint64_t>(text.size(), _capacity - (write - read)));
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            const auto offset = static_cast<size_t>(write & (_capacity - 1));
+            const auto first = std::min<size_t>(count, _capacity - offset);
+            memcpy(_data + offset, text.data(), first);
+            memcpy(_data, text.data() + first, count - first);
+
+            _state->write.store(write + count);
+            if (_state->read.load() == write)
+            {
+                SetEvent(WrittenEvent());
+            }
+            return count;
+        }
+
+        // Copies as much of the ring's contents into `buffer` as fits. Returns the number of bytes read.
+        size_t TryRead(const std::span<char> buffer) const noexcept
+        {
+            const auto read = _state->read.load(std::memory_order_relaxed);
+            const auto write = _state->write.load();
+            const auto count = static_cast<size_t>(std::min<uint64_t>(buffer.size(), write - read));
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            const auto offset = static_cast<size_t>(read & (_capacity - 1));
+            const auto first = std::min<size_t>(count, _capacity - offset);
+            memcpy(buffer.data(), _data + offset, first);
+            memcpy(buffer.data() + first, _data, count - first);
+
+            _state->read.store(read + count);
+            if (_state->write.load() - read == _capacity)
+            {
+                SetEvent(DrainedEvent());
+            }
+            return count;
+        }
+
+        HANDLE WrittenEvent() const noexcept
+        {
+            return _writtenEvent;
+        }
+
+        HANDLE DrainedEvent() const noexcept
+        {
+            return _drainedEvent;
+        }
+
+    private:
+        RingState* _state = nullptr;
+        char* _data = nullptr;
+        uint32_t _capacity = 0;
+        HANDLE _writtenEvent = nullptr;
+        HANDLE _drainedEvent = nullptr;
+    };
+
+    // The terminal end of a section. It creates the section and its events and reads
+    // the client's output from Output() and writes input for it into Input().
+    class Server
+    {
+    public:
+        Server(const uint32_t rows, const uint32_t columns, const bool inheritable, const uint32_t ringCapacity = DefaultRingCapacity)
+        {
+            const auto size = SectionSize(ringCapacity);
+            SECURITY_ATTRIBUTES sa{ sizeof(sa), nullptr, inheritable };
+
+            _section.reset(CreateFileMappingW(INVALID_HANDLE_VALUE, &sa, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr));
+            THROW_LAST_ERROR_IF(!_section);
+            _view.reset(static_cast<Header*>(MapViewOfFile(_section.get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size)));
+            THROW_LAST_ERROR_IF(!_view);
+
+            _outputWritten.create(wil::EventOptions::None, nullptr, &sa);
+            _outputDrained.create(wil::EventOptions::None, nullptr, &sa);
+            _inputWritten.create(wil::EventOptions::None, nullptr, &sa);
+            _inputDrained.create(wil::EventOptions::None, nullptr, &sa);
+
+            // The section is zero-initialized, which is what all the atomics need to be.
+            const auto header = _view.get();
+            header->magic = Magic;
+            header->version = Version;
+            header->ringCapacity = ringCapacity;
+            header->rows = rows;
+            header->columns = columns;
+            header->output.writtenEvent = reinterpret_cast<uintptr_t>(_outputWritten.get());
+            header->output.drainedEvent = reinterpret_cast<uintptr_t>(_outputDrained.get());
+            header->input.writtenEvent = reinterpret_cast<uintptr_t>(_inputWritten.get());
+            header->input.drainedEvent = reinterpret_cast<uintptr_t>(_inputDrained.get());
+
+            const auto data = reinterpret_cast<char*>(header + 1);
+            _output = Ring{ header->output, data, ringCapacity, _outputWritten.get(), _outputDrained.get() };
+            _input = Ring{ header->input, data + ringCapacity, ringCapacity, _inputWritten.get(), _inputDrained.get() };
+        }
+
+        HANDLE Section() const noexcept
+        {
+            return _section.get();
+        }
+
+        // The section followed by the 4 events, for passing them to the client process.
+        std::array<HANDLE, 5> Handles() const noexcept
+        {
+            return { _section.get(), _outputWritten.get(), _outputDrained.get(), _inputWritten.get(), _inputDrained.get() };
+        }
+
+        const Ring& Output() const noexcept
+        {
+            return _output;
+        }
+
+        const Ring& Input() const noexcept
+        {
+            return _input;
+        }
+
+        void Resize(const uint32_t rows, const uint32_t columns) const noexcept
+        {
+            _view->rows.store(rows, std::memory_order_relaxed);
+            _view->columns.store(columns, std::memory_order_relaxed);
+            _view->sizeGeneration.fetch_add(1, std::memory_order_release);
+            _inputWritten.SetEvent();
+        }
+
+        // Tells the client that we're gone, and wakes up both of us, in case either is waiting on the other.
+        void Close() const noexcept
+        {
+            _view->closed.store(1, std::memory_order_release);
+            _outputWritten.SetEvent();
+            _outputDrained.SetEvent();
+            _inputWritten.SetEvent();
+            _inputDrained.SetEvent();
+        }
+
+    private:
+        wil::unique_handle _section;
+        wil::unique_mapview_ptr<Header> _view;
+        wil::unique_event _outputWritten;
+        wil::unique_event _outputDrained;
+        wil::unique_event _inputWritten;
+        wil::unique_event _inputDrained;
+        Ring _output;
+        Ring _input;
+    };
+
+    // The client end of a section, for use by the process hosted by a SharedMemoryConnection.
+    // It writes VT output with Write() and receives VT input and size changes with Read().
+    class Client
+    {
+    public:
+        // Opens the section whose handle value was passed to this process via EnvironmentVariableName.
+        static Client FromEnvironment()
+        {
+            wchar_t value[32]{};
+            const auto length = GetEnvironmentVariableW(EnvironmentVariableName, &value[0], 32);
+            THROW_LAST_ERROR_IF(length == 0);
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), length >= 32);
+            return Client{ reinterpret_cast<HANDLE>(static_cast<uintptr_t>(wcstoull(&value[0], nullptr, 10))) };
+        }
+
+        explicit Client(HANDLE section)
+        {
+            _view.reset(static_cast<Header*>(MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0)));
+            THROW_LAST_ERROR_IF(!_view);
+
+            MEMORY_BASIC_INFORMATION info{};
+            THROW_LAST_ERROR_IF(!VirtualQuery(_view.get(), &info, sizeof(info)));
+
+            const auto capacity = _view->ringCapacity;
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _view->magic != Magic || _view->version != Version);
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), capacity == 0 || (capacity & (capacity - 1)) != 0);
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), info.RegionSize < SectionSize(capacity));
+
+            const auto data = reinterpret_cast<char*>(_view.get() + 1);
+            _output = Ring{ _view->output, data, capacity, _event(_view->output.writtenEvent), _event(_view->output.drainedEvent) };
+            _input = Ring{ _view->input, data + capacity, capacity, _event(_view->input.writtenEvent), _event(_view->input.drainedEvent) };
+            _sizeGeneration = _view->sizeGeneration.load(std::memory_order_acquire);
+        }
+
+        // Returns true once the terminal closed the connection. Write() and Read() fail from then on.
+        bool IsClosed() const noexcept
+        {
+            return _view->closed.load(std::memory_order_acquire) != 0;
+        }
+
+        uint32_t Rows() const noexcept
+        {
+            return _view->rows.load(std::memory_order_relaxed);
+        }
+
+        uint32_t Columns() const noexcept
+        {
+            return _view->columns.load(std::memory_order_relaxed);
+        }
+
+        // Blocks until all of `text` was written. Returns false if the connection got closed first.
+        bool Write(std::string_view text) const noexcept
+        {
+            while (!text.empty())
+            {
+                if (IsClosed())
+                {
+                    return false;
+                }
+
+                const auto written = _output.TryWrite(text);
+                text = text.substr(written);
+
+                if (written == 0)
+                {
+                    WaitForSingleObject(_output.DrainedEvent(), INFINITE);
+                }
+            }
+            return true;
+        }
+
+        // Blocks until input is available, the size changed, or the connection got closed.
+        // Returns the number of bytes read, and 0 for the latter two (see Rows(), Columns() and IsClosed()).
+        size_t Read(const std::span<char> buffer) noexcept
+        {
+            for (;;)
+            {
+                const auto sizeGeneration = _view->sizeGeneration.load(std::memory_order_acquire);
+                if (sizeGeneration != _sizeGeneration)
+                {
+                    _sizeGeneration = sizeGeneration;
+                    return 0;
+                }
+
+                if (const auto read = _input.TryRead(buffer))
+                {
+                    return read;
+                }
+
+                if (IsClosed())
+                {
+                    return 0;
+                }
+
+                WaitForSingleObject(_input.WrittenEvent(), INFINITE);
+            }
+        }
+
+    private:
+        static HANDLE _event(const uint64_t value) noexcept
+        {
+            return reinterpret_cast<HANDLE>(static_cast<uintptr_t>(value));
+        }
+
+        wil::unique_mapview_ptr<Header> _view;
+        Ring _output;
+        Ring _input;
+        uint32_t _sizeGeneration = 0;
+    };
+}
@@ -51,6 +51,33 @@
 // We will therefore try to reserve 32..42 for TIL
 // as common flags for the entire Terminal team projects.
 #define TIL_KEYWORD_TRACE 0x0000000100000000 // bit 32
+// Use TIL_KEYWORD_LOCKS for the til::lock_profiler events.
+// Acquiring a lock is frequent enough that these should only be enabled on purpose.
+#define TIL_KEYWORD_LOCKS 0x0000000200000000 // bit 33
+// Use TIL_KEYWORD_PIPELINE for the TIL_TRACE_REGION events that mark the stages
+// of the output pipeline (pipe read, decode, parse, buffer write, paint, present).
+#define TIL_KEYWORD_PIPELINE 0x0000000400000000 // bit 34
+// Use TIL_KEYWORD_STARTUP for the phases of the Windows Terminal startup. See StartupTimeline.h.
+#define TIL_KEYWORD_STARTUP 0x0000000800000000 // bit 35
+
+// TIL_TRACE_REGION(provider, "Name") logs a START event of the given name now and
+// the matching STOP event once the current scope is left. They're meant to be turned
+// into regions in WPA (see ConsolePerf.regions.xml). When the provider isn't enabled,
+// each event costs no more than the check whether it is.
+// The name must be a string literal, as required by TraceLoggingWrite.
+#define TIL_TRACE_REGION_EVENT(provider, name, opcode)           \
+    TraceLoggingWrite(provider,                                  \
+                      name,                                      \
+                      TraceLoggingOpcode(opcode),                \
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE), \
+                      TraceLoggingKeyword(TIL_KEYWORD_PIPELINE))
+#define TIL_TRACE_REGION_CONCAT2(a, b) a##b
+#define TIL_TRACE_REGION_CONCAT(a, b) TIL_TRACE_REGION_CONCAT2(a, b)
+#define TIL_TRACE_REGION(provider, name)                                                             \
+    TIL_TRACE_REGION_EVENT(provider, name, WINEVENT_OPCODE_START);                                   \
+    const auto TIL_TRACE_REGION_CONCAT(_tilTraceRegion, __LINE__) = wil::scope_exit([&]() noexcept { \
+        TIL_TRACE_REGION_EVENT(provider, name, WINEVENT_OPCODE_STOP);                                \
+    })
 
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
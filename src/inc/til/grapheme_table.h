@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This file was generated from the Unicode 14.0 character database: The Grapheme_Cluster_Break property
+// from GraphemeBreakProperty.txt combined with Extended_Pictographic from emoji-data.txt.
+// Each entry is the first codepoint of a range shifted left by 4, ORed with its grapheme_property.
+// A range extends up to the next entry. The Hangul syllables U+AC00-D7A3 are split into LV and LVT
+// algorithmically by til::grapheme_property_of() and are all listed as LV here to keep the table small.
+
+namespace til::details
+{
+    // clang-format off
+    inline constexpr uint32_t grapheme_property_table[]{
+        0x00000003, 0x000000a2, 0x000000b3, 0x000000d1, 0x000000e3, 0x00000200, 0x000007f3, 0x00000a00,
+        0x00000a9e, 0x00000aa0, 0x00000ad3, 0x00000aee, 0x00000af0, 0x00003004, 0x00003700, 0x00004834,
+        0x000048a0, 0x00005914, 0x00005be0, 0x00005bf4, 0x00005c00, 0x00005c14, 0x00005c30, 0x00005c44,
+        0x00005c60, 0x00005c74, 0x00005c80, 0x00006007, 0x00006060, 0x00006104, 0x000061b0, 0x000061c3,
+        0x000061d0, 0x000064b4, 0x00006600, 0x00006704, 0x00006710, 0x00006d64, 0x00006dd7, 0x00006de0,
+        0x00006df4, 0x00006e50, 0x00006e74, 0x00006e90, 0x00006ea4, 0x00006ee0, 0x000070f7, 0x00007100,
+        0x00007114, 0x00007120, 0x00007304, 0x000074b0, 0x00007a64, 0x00007b10, 0x00007eb4, 0x00007f40,
+        0x00007fd4, 0x00007fe0, 0x00008164, 0x000081a0, 0x000081b4, 0x00008240, 0x00008254, 0x00008280,
+        0x00008294, 0x000082e0, 0x00008594, 0x000085c0, 0x00008907, 0x00008920, 0x00008984, 0x00008a00,
+        0x00008ca4, 0x00008e27, 0x00008e34, 0x00009038, 0x00009040, 0x000093a4, 0x000093b8, 0x000093c4,
+        0x000093d0, 0x000093e8, 0x00009414, 0x00009498, 0x000094d4, 0x000094e8, 0x00009500, 0x00009514,
+        0x00009580, 0x00009624, 0x00009640, 0x00009814, 0x00009828, 0x00009840, 0x00009bc4, 0x00009bd0,
+        0x00009be4, 0x00009bf8, 0x00009c14, 0x00009c50, 0x00009c78, 0x00009c90, 0x00009cb8, 0x00009cd4,
+        0x00009ce0, 0x00009d74, 0x00009d80, 0x00009e24, 0x00009e40, 0x00009fe4, 0x00009ff0, 0x0000a014,
+        0x0000a038, 0x0000a040, 0x0000a3c4, 0x0000a3d0, 0x0000a3e8, 0x0000a414, 0x0000a430, 0x0000a474,
+        0x0000a490, 0x0000a4b4, 0x0000a4e0, 0x0000a514, 0x0000a520, 0x0000a704, 0x0000a720, 0x0000a754,
+        0x0000a760, 0x0000a814, 0x0000a838, 0x0000a840, 0x0000abc4, 0x0000abd0, 0x0000abe8, 0x0000ac14,
+        0x0000ac60, 0x0000ac74, 0x0000ac98, 0x0000aca0, 0x0000acb8, 0x0000acd4, 0x0000ace0, 0x0000ae24,
+        0x0000ae40, 0x0000afa4, 0x0000b000, 0x0000b014, 0x0000b028, 0x0000b040, 0x0000b3c4, 0x0000b3d0,
+        0x0000b3e4, 0x0000b408, 0x0000b414, 0x0000b450, 0x0000b478, 0x0000b490, 0x0000b4b8, 0x0000b4d4,
+        0x0000b4e0, 0x0000b554, 0x0000b580, 0x0000b624, 0x0000b640, 0x0000b824, 0x0000b830, 0x0000bbe4,
+        0x0000bbf8, 0x0000bc04, 0x0000bc18, 0x0000bc30, 0x0000bc68, 0x0000bc90, 0x0000bca8, 0x0000bcd4,
+        0x0000bce0, 0x0000bd74, 0x0000bd80, 0x0000c004, 0x0000c018, 0x0000c044, 0x0000c050, 0x0000c3c4,
+        0x0000c3d0, 0x0000c3e4, 0x0000c418, 0x0000c450, 0x0000c464, 0x0000c490, 0x0000c4a4, 0x0000c4e0,
+        0x0000c554, 0x0000c570, 0x0000c624, 0x0000c640, 0x0000c814, 0x0000c828, 0x0000c840, 0x0000cbc4,
+        0x0000cbd0, 0x0000cbe8, 0x0000cbf4, 0x0000cc08, 0x0000cc24, 0x0000cc38, 0x0000cc50, 0x0000cc64,
+        0x0000cc78, 0x0000cc90, 0x0000cca8, 0x0000ccc4, 0x0000cce0, 0x0000cd54, 0x0000cd70, 0x0000ce24,
+        0x0000ce40, 0x0000d004, 0x0000d028, 0x0000d040, 0x0000d3b4, 0x0000d3d0, 0x0000d3e4, 0x0000d3f8,
+        0x0000d414, 0x0000d450, 0x0000d468, 0x0000d490, 0x0000d4a8, 0x0000d4d4, 0x0000d4e7, 0x0000d4f0,
+        0x0000d574, 0x0000d580, 0x0000d624, 0x0000d640, 0x0000d814, 0x0000d828, 0x0000d840, 0x0000dca4,
+        0x0000dcb0, 0x0000dcf4, 0x0000dd08, 0x0000dd24, 0x0000dd50, 0x0000dd64, 0x0000dd70, 0x0000dd88,
+        0x0000ddf4, 0x0000de00, 0x0000df28, 0x0000df40, 0x0000e314, 0x0000e320, 0x0000e338, 0x0000e344,
+        0x0000e3b0, 0x0000e474, 0x0000e4f0, 0x0000eb14, 0x0000eb20, 0x0000eb38, 0x0000eb44, 0x0000ebd0,
+        0x0000ec84, 0x0000ece0, 0x0000f184, 0x0000f1a0, 0x0000f354, 0x0000f360, 0x0000f374, 0x0000f380,
+        0x0000f394, 0x0000f3a0, 0x0000f3e8, 0x0000f400, 0x0000f714, 0x0000f7f8, 0x0000f804, 0x0000f850,
+        0x0000f864, 0x0000f880, 0x0000f8d4, 0x0000f980, 0x0000f994, 0x0000fbd0, 0x0000fc64, 0x0000fc70,
+        0x000102d4, 0x00010318, 0x00010324, 0x00010380, 0x00010394, 0x000103b8, 0x000103d4, 0x000103f0,
+        0x00010568, 0x00010584, 0x000105a0, 0x000105e4, 0x00010610, 0x00010714, 0x00010750, 0x00010824,
+        0x00010830, 0x00010848, 0x00010854, 0x00010870, 0x000108d4, 0x000108e0, 0x000109d4, 0x000109e0,
+        0x00011009, 0x0001160a, 0x00011a8b, 0x00012000, 0x000135d4, 0x00013600, 0x00017124, 0x00017158,
+        0x00017160, 0x00017324, 0x00017348, 0x00017350, 0x00017524, 0x00017540, 0x00017724, 0x00017740,
+        0x00017b44, 0x00017b68, 0x00017b74, 0x00017be8, 0x00017c64, 0x00017c78, 0x00017c94, 0x00017d40,
+        0x00017dd4, 0x00017de0, 0x000180b4, 0x000180e3, 0x000180f4, 0x00018100, 0x00018854, 0x00018870,
+        0x00018a94, 0x00018aa0, 0x00019204, 0x00019238, 0x00019274, 0x00019298, 0x000192c0, 0x00019308,
+        0x00019324, 0x00019338, 0x00019394, 0x000193c0, 0x0001a174, 0x0001a198, 0x0001a1b4, 0x0001a1c0,
+        0x0001a558, 0x0001a564, 0x0001a578, 0x0001a584, 0x0001a5f0, 0x0001a604, 0x0001a610, 0x0001a624,
+        0x0001a630, 0x0001a654, 0x0001a6d8, 0x0001a734, 0x0001a7d0, 0x0001a7f4, 0x0001a800, 0x0001ab04,
+        0x0001acf0, 0x0001b004, 0x0001b048, 0x0001b050, 0x0001b344, 0x0001b3b8, 0x0001b3c4, 0x0001b3d8,
+        0x0001b424, 0x0001b438, 0x0001b450, 0x0001b6b4, 0x0001b740, 0x0001b804, 0x0001b828, 0x0001b830,
+        0x0001ba18, 0x0001ba24, 0x0001ba68, 0x0001ba84, 0x0001baa8, 0x0001bab4, 0x0001bae0, 0x0001be64,
+        0x0001be78, 0x0001be84, 0x0001bea8, 0x0001bed4, 0x0001bee8, 0x0001bef4, 0x0001bf28, 0x0001bf40,
+        0x0001c248, 0x0001c2c4, 0x0001c348, 0x0001c364, 0x0001c380, 0x0001cd04, 0x0001cd30, 0x0001cd44,
+        0x0001ce18, 0x0001ce24, 0x0001ce90, 0x0001ced4, 0x0001cee0, 0x0001cf44, 0x0001cf50, 0x0001cf78,
+        0x0001cf84, 0x0001cfa0, 0x0001dc04, 0x0001e000, 0x000200b3, 0x000200c4, 0x000200d5, 0x000200e3,
+        0x00020100, 0x00020283, 0x000202f0, 0x000203ce, 0x000203d0, 0x0002049e, 0x000204a0, 0x00020603,
+        0x00020650, 0x00020663, 0x00020700, 0x00020d04, 0x00020f10, 0x0002122e, 0x00021230, 0x0002139e,
+        0x000213a0, 0x0002194e, 0x000219a0, 0x00021a9e, 0x00021ab0, 0x000231ae, 0x000231c0, 0x0002328e,
+        0x00023290, 0x0002388e, 0x00023890, 0x00023cfe, 0x00023d00, 0x00023e9e, 0x00023f40, 0x00023f8e,
+        0x00023fb0, 0x00024c2e, 0x00024c30, 0x00025aae, 0x00025ac0, 0x00025b6e, 0x00025b70, 0x00025c0e,
+        0x00025c10, 0x00025fbe, 0x00025ff0, 0x0002600e, 0x00026060, 0x0002607e, 0x00026130, 0x0002614e,
+        0x00026860, 0x0002690e, 0x00027060, 0x0002708e, 0x00027130, 0x0002714e, 0x00027150, 0x0002716e,
+        0x00027170, 0x000271de, 0x000271e0, 0x0002721e, 0x00027220, 0x0002728e, 0x00027290, 0x0002733e,
+        0x00027350, 0x0002744e, 0x00027450, 0x0002747e, 0x00027480, 0x000274ce, 0x000274d0, 0x000274ee,
+        0x000274f0, 0x0002753e, 0x00027560, 0x0002757e, 0x00027580, 0x0002763e, 0x00027680, 0x0002795e,
+        0x00027980, 0x00027a1e, 0x00027a20, 0x00027b0e, 0x00027b10, 0x00027bfe, 0x00027c00, 0x0002934e,
+        0x00029360, 0x0002b05e, 0x0002b080, 0x0002b1be, 0x0002b1d0, 0x0002b50e, 0x0002b510, 0x0002b55e,
+        0x0002b560, 0x0002cef4, 0x0002cf20, 0x0002d7f4, 0x0002d800, 0x0002de04, 0x0002e000, 0x000302a4,
+        0x0003030e, 0x00030310, 0x000303de, 0x000303e0, 0x00030994, 0x000309b0, 0x0003297e, 0x00032980,
+        0x0003299e, 0x000329a0, 0x000a66f4, 0x000a6730, 0x000a6744, 0x000a67e0, 0x000a69e4, 0x000a6a00,
+        0x000a6f04, 0x000a6f20, 0x000a8024, 0x000a8030, 0x000a8064, 0x000a8070, 0x000a80b4, 0x000a80c0,
+        0x000a8238, 0x000a8254, 0x000a8278, 0x000a8280, 0x000a82c4, 0x000a82d0, 0x000a8808, 0x000a8820,
+        0x000a8b48, 0x000a8c44, 0x000a8c60, 0x000a8e04, 0x000a8f20, 0x000a8ff4, 0x000a9000, 0x000a9264,
+        0x000a92e0, 0x000a9474, 0x000a9528, 0x000a9540, 0x000a9609, 0x000a97d0, 0x000a9804, 0x000a9838,
+        0x000a9840, 0x000a9b34, 0x000a9b48, 0x000a9b64, 0x000a9ba8, 0x000a9bc4, 0x000a9be8, 0x000a9c10,
+        0x000a9e54, 0x000a9e60, 0x000aa294, 0x000aa2f8, 0x000aa314, 0x000aa338, 0x000aa354, 0x000aa370,
+        0x000aa434, 0x000aa440, 0x000aa4c4, 0x000aa4d8, 0x000aa4e0, 0x000aa7c4, 0x000aa7d0, 0x000aab04,
+        0x000aab10, 0x000aab24, 0x000aab50, 0x000aab74, 0x000aab90, 0x000aabe4, 0x000aac00, 0x000aac14,
+        0x000aac20, 0x000aaeb8, 0x000aaec4, 0x000aaee8, 0x000aaf00, 0x000aaf58, 0x000aaf64, 0x000aaf70,
+        0x000abe38, 0x000abe54, 0x000abe68, 0x000abe84, 0x000abe98, 0x000abeb0, 0x000abec8, 0x000abed4,
+        0x000abee0, 0x000ac00c, 0x000d7a40, 0x000d7b0a, 0x000d7c70, 0x000d7cbb, 0x000d7fc0, 0x000d8003,
+        0x000e0000, 0x000fb1e4, 0x000fb1f0, 0x000fe004, 0x000fe100, 0x000fe204, 0x000fe300, 0x000feff3,
+        0x000ff000, 0x000ff9e4, 0x000ffa00, 0x000fff93, 0x000fffc0, 0x00101fd4, 0x00101fe0, 0x00102e04,
+        0x00102e10, 0x00103764, 0x001037b0, 0x0010a014, 0x0010a040, 0x0010a054, 0x0010a070, 0x0010a0c4,
+        0x0010a100, 0x0010a384, 0x0010a3b0, 0x0010a3f4, 0x0010a400, 0x0010ae54, 0x0010ae70, 0x0010d244,
+        0x0010d280, 0x0010eab4, 0x0010ead0, 0x0010f464, 0x0010f510, 0x0010f824, 0x0010f860, 0x00110008,
+        0x00110014, 0x00110028, 0x00110030, 0x00110384, 0x00110470, 0x00110704, 0x00110710, 0x00110734,
+        0x00110750, 0x001107f4, 0x00110828, 0x00110830, 0x00110b08, 0x00110b34, 0x00110b78, 0x00110b94,
+        0x00110bb0, 0x00110bd7, 0x00110be0, 0x00110c24, 0x00110c30, 0x00110cd7, 0x00110ce0, 0x00111004,
+        0x00111030, 0x00111274, 0x001112c8, 0x001112d4, 0x00111350, 0x00111458, 0x00111470, 0x00111734,
+        0x00111740, 0x00111804, 0x00111828, 0x00111830, 0x00111b38, 0x00111b64, 0x00111bf8, 0x00111c10,
+        0x00111c27, 0x00111c40, 0x00111c94, 0x00111cd0, 0x00111ce8, 0x00111cf4, 0x00111d00, 0x001122c8,
+        0x001122f4, 0x00112328, 0x00112344, 0x00112358, 0x00112364, 0x00112380, 0x001123e4, 0x001123f0,
+        0x00112df4, 0x00112e08, 0x00112e34, 0x00112eb0, 0x00113004, 0x00113028, 0x00113040, 0x001133b4,
+        0x001133d0, 0x001133e4, 0x001133f8, 0x00113404, 0x00113418, 0x00113450, 0x00113478, 0x00113490,
+        0x001134b8, 0x001134e0, 0x00113574, 0x00113580, 0x00113628, 0x00113640, 0x00113664, 0x001136d0,
+        0x00113704, 0x00113750, 0x00114358, 0x00114384, 0x00114408, 0x00114424, 0x00114458, 0x00114464,
+        0x00114470, 0x001145e4, 0x001145f0, 0x00114b04, 0x00114b18, 0x00114b34, 0x00114b98, 0x00114ba4,
+        0x00114bb8, 0x00114bd4, 0x00114be8, 0x00114bf4, 0x00114c18, 0x00114c24, 0x00114c40, 0x00115af4,
+        0x00115b08, 0x00115b24, 0x00115b60, 0x00115b88, 0x00115bc4, 0x00115be8, 0x00115bf4, 0x00115c10,
+        0x00115dc4, 0x00115de0, 0x00116308, 0x00116334, 0x001163b8, 0x001163d4, 0x001163e8, 0x001163f4,
+        0x00116410, 0x00116ab4, 0x00116ac8, 0x00116ad4, 0x00116ae8, 0x00116b04, 0x00116b68, 0x00116b74,
+        0x00116b80, 0x001171d4, 0x00117200, 0x00117224, 0x00117268, 0x00117274, 0x001172c0, 0x001182c8,
+        0x001182f4, 0x00118388, 0x00118394, 0x001183b0, 0x00119304, 0x00119318, 0x00119360, 0x00119378,
+        0x00119390, 0x001193b4, 0x001193d8, 0x001193e4, 0x001193f7, 0x00119408, 0x00119417, 0x00119428,
+        0x00119434, 0x00119440, 0x00119d18, 0x00119d44, 0x00119d80, 0x00119da4, 0x00119dc8, 0x00119e04,
+        0x00119e10, 0x00119e48, 0x00119e50, 0x0011a014, 0x0011a0b0, 0x0011a334, 0x0011a398, 0x0011a3a7,
+        0x0011a3b4, 0x0011a3f0, 0x0011a474, 0x0011a480, 0x0011a514, 0x0011a578, 0x0011a594, 0x0011a5c0,
+        0x0011a847, 0x0011a8a4, 0x0011a978, 0x0011a984, 0x0011a9a0, 0x0011c2f8, 0x0011c304, 0x0011c370,
+        0x0011c384, 0x0011c3e8, 0x0011c3f4, 0x0011c400, 0x0011c924, 0x0011ca80, 0x0011ca98, 0x0011caa4,
+        0x0011cb18, 0x0011cb24, 0x0011cb48, 0x0011cb54, 0x0011cb70, 0x0011d314, 0x0011d370, 0x0011d3a4,
+        0x0011d3b0, 0x0011d3c4, 0x0011d3e0, 0x0011d3f4, 0x0011d467, 0x0011d474, 0x0011d480, 0x0011d8a8,
+        0x0011d8f0, 0x0011d904, 0x0011d920, 0x0011d938, 0x0011d954, 0x0011d968, 0x0011d974, 0x0011d980,
+        0x0011ef34, 0x0011ef58, 0x0011ef70, 0x00134303, 0x00134390, 0x0016af04, 0x0016af50, 0x0016b304,
+        0x0016b370, 0x0016f4f4, 0x0016f500, 0x0016f518, 0x0016f880, 0x0016f8f4, 0x0016f930, 0x0016fe44,
+        0x0016fe50, 0x0016ff08, 0x0016ff20, 0x001bc9d4, 0x001bc9f0, 0x001bca03, 0x001bca40, 0x001cf004,
+        0x001cf2e0, 0x001cf304, 0x001cf470, 0x001d1654, 0x001d1668, 0x001d1674, 0x001d16a0, 0x001d16d8,
+        0x001d16e4, 0x001d1733, 0x001d17b4, 0x001d1830, 0x001d1854, 0x001d18c0, 0x001d1aa4, 0x001d1ae0,
+        0x001d2424, 0x001d2450, 0x001da004, 0x001da370, 0x001da3b4, 0x001da6d0, 0x001da754, 0x001da760,
+        0x001da844, 0x001da850, 0x001da9b4, 0x001daa00, 0x001daa14, 0x001dab00, 0x001e0004, 0x001e0070,
+        0x001e0084, 0x001e0190, 0x001e01b4, 0x001e0220, 0x001e0234, 0x001e0250, 0x001e0264, 0x001e02b0,
+        0x001e1304, 0x001e1370, 0x001e2ae4, 0x001e2af0, 0x001e2ec4, 0x001e2f00, 0x001e8d04, 0x001e8d70,
+        0x001e9444, 0x001e94b0, 0x001f000e, 0x001f1000, 0x001f10de, 0x001f1100, 0x001f12fe, 0x001f1300,
+        0x001f16ce, 0x001f1720, 0x001f17ee, 0x001f1800, 0x001f18ee, 0x001f18f0, 0x001f191e, 0x001f19b0,
+        0x001f1ade, 0x001f1e66, 0x001f2000, 0x001f201e, 0x001f2100, 0x001f21ae, 0x001f21b0, 0x001f22fe,
+        0x001f2300, 0x001f232e, 0x001f23b0, 0x001f23ce, 0x001f2400, 0x001f249e, 0x001f3fb4, 0x001f400e,
+        0x001f53e0, 0x001f546e, 0x001f6500, 0x001f680e, 0x001f7000, 0x001f774e, 0x001f7800, 0x001f7d5e,
+        0x001f8000, 0x001f80ce, 0x001f8100, 0x001f848e, 0x001f8500, 0x001f85ae, 0x001f8600, 0x001f888e,
+        0x001f8900, 0x001f8aee, 0x001f9000, 0x001f90ce, 0x001f93b0, 0x001f93ce, 0x001f9460, 0x001f947e,
+        0x001fb000, 0x001fc00e, 0x001fffe0, 0x00e00013, 0x00e00020, 0x00e00204, 0x00e00800, 0x00e01004,
+        0x00e01f00,
+    };
+    // clang-format on
+}
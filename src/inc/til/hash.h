@@ -285,6 +285,59 @@ namespace til
         h.write(data, len);
         return h.finalize();
     }
+
+    namespace details
+    {
+#if defined(TIL_HASH_X64)
+        inline const bool hash_short_hardware = [] {
+            int info[4];
+            __cpuid(&info[0], 1);
+            return (info[2] & (1 << 25)) != 0; // AES-NI
+        }();
+#elif defined(_M_ARM64)
+        inline const bool hash_short_hardware = IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != FALSE;
+#endif
+    }
+
+    // A hash for keys of up to 16 bytes, like short glyph clusters or font face keys, for use in hash tables.
+    // For such keys wyhash spends most of its time on its setup and finalization. If the CPU supports it,
+    // this uses 2 rounds of AES instead, which are enough to mix every byte of the key into all 16 bytes of the result.
+    // Longer keys and CPUs without AES instructions fall back to til::hash.
+    //
+    // Unlike til::hash, the result depends on the CPU and must not be persisted.
+    inline size_t hash_short(const void* data, size_t len, size_t seed = 0) noexcept
+    {
+#if defined(TIL_HASH_X64) || defined(_M_ARM64)
+        if (len <= 16 && details::hash_short_hardware) [[likely]]
+        {
+            alignas(16) uint8_t buffer[16]{};
+            memcpy(&buffer[0], data, len);
+
+            // The length is mixed into the key, so that keys with trailing zeroes don't collide with shorter ones.
+#if defined(TIL_HASH_X64)
+            const auto k0 = _mm_set_epi64x(static_cast<int64_t>(0xe7037ed1a0b428db ^ len), static_cast<int64_t>(0xa0761d6478bd642f ^ seed));
+            const auto k1 = _mm_set_epi64x(static_cast<int64_t>(0x589965cc75374cc3), static_cast<int64_t>(0x8ebc6af09c88c6e3));
+            auto v = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(&buffer[0])), k0);
+            v = _mm_aesenc_si128(v, k1);
+            v = _mm_aesenc_si128(v, k0);
+            return static_cast<size_t>(_mm_cvtsi128_si64(v)) ^ static_cast<size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)));
+#else
+            const uint64_t keys[4]{ 0xa0761d6478bd642f ^ seed, 0xe7037ed1a0b428db ^ len, 0x8ebc6af09c88c6e3, 0x589965cc75374cc3 };
+            const auto k0 = vreinterpretq_u8_u64(vld1q_u64(&keys[0]));
+            const auto k1 = vreinterpretq_u8_u64(vld1q_u64(&keys[2]));
+            // vaeseq_u8 XORs the key before (!) SubBytes and ShiftRows, unlike _mm_aesenc_si128 which XORs it after MixColumns.
+            auto v = vaesmcq_u8(vaeseq_u8(vld1q_u8(&buffer[0]), k0));
+            v = veorq_u8(vaesmcq_u8(vaeseq_u8(v, k1)), k0);
+            const auto v64 = vreinterpretq_u64_u8(v);
+            return vgetq_lane_u64(v64, 0) ^ vgetq_lane_u64(v64, 1);
+#endif
+        }
+#endif
+
+        hasher h{ seed };
+        h.write(data, len);
+        return h.finalize();
+    }
 }
 
 #pragma warning(pop)
@@ -0,0 +1,573 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <bit>
+
+#include "atomic.h"
+#include "spsc.h"
+
+// til: Terminal Implementation Library. Also: "Today I Learned".
+// mpsc: Multi Producer Single Consumer. A MPSC queue/channel sends data from any number of senders to one receiver.
+//
+// The API mirrors til::spsc, except that producer<T> is copyable. Each copy may be used
+// from a different thread and the consumer will see the end of the channel once all of them are gone.
+namespace til::mpsc
+{
+    using size_type = uint32_t;
+
+    // Block until at least one item has been written into the sender / read from the receiver.
+    using spsc::block_initially;
+
+    // Block until all items have been written into the sender / read from the receiver.
+    using spsc::block_forever;
+
+    namespace details
+    {
+        using spsc::details::enable_if_wait_policy_t;
+
+        inline constexpr size_type max_capacity = size_type{ 1 } << (std::numeric_limits<size_type>::digits - 1u);
+
+        // An eventcount lets a thread sleep until a condition that's tracked elsewhere changes,
+        // without requiring the side that changes it to perform a syscall or RMW operation. Usage:
+        //   const auto key = ec.prepare_wait();
+        //   if (condition_is_met()) ec.cancel_wait(); else ec.wait(key);
+        // The other side simply calls notify() after modifying the condition.
+        struct eventcount
+        {
+            uint32_t prepare_wait() noexcept
+            {
+                // The seq_cst RMW pairs with the seq_cst fence in notify(): Either notify() sees our
+                // increment and bumps the _epoch, or we see the condition change it was called for.
+                _waiters.fetch_add(1, std::memory_order_seq_cst);
+                return _epoch.load(std::memory_order_seq_cst);
+            }
+
+            void cancel_wait() noexcept
+            {
+                _waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void wait(uint32_t key) noexcept
+            {
+                while (_epoch.load(std::memory_order_acquire) == key)
+                {
+                    til::atomic_wait(_epoch, key);
+                }
+                _waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void notify() noexcept
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (_waiters.load(std::memory_order_relaxed) != 0)
+                {
+                    _epoch.fetch_add(1, std::memory_order_release);
+                    til::atomic_notify_all(_epoch);
+                }
+            }
+
+        private:
+            std::atomic<uint32_t> _epoch{ 0 };
+            std::atomic<uint32_t> _waiters{ 0 };
+        };
+
+        template<typename T>
+        struct slot
+        {
+            // See arc<T> for how the sequence number is used.
+            std::atomic<uint64_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+
+            T* get() noexcept
+            {
+                return std::launder(reinterpret_cast<T*>(&storage[0]));
+            }
+        };
+
+        template<typename T>
+        struct acquisition
+        {
+            // The slot that may be written to / read from respectively,
+            // or nullptr if the queue is full / empty or the other side is gone.
+            slot<T>* target;
+            // The position of the slot in the queue. Only valid if target isn't nullptr.
+            uint64_t position;
+            // If the other side of the queue hasn't been destroyed yet, alive will be true.
+            bool alive;
+        };
+
+        // arc implements the bounded queue described by Dmitry Vyukov:
+        //   https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+        //
+        // The queue is a ring buffer of capacity-many slots, each of which contains a sequence number.
+        // _tail and _head are the positions the producers / the consumer will next write to / read from.
+        // Unlike with spsc's arc<T> they aren't modulo the capacity. Instead, the slot for a
+        // position is found at `position & _mask` and thanks to 64-bit positions they never wrap around.
+        //
+        // A slot's sequence number states whose turn it is:
+        // * sequence == position: The slot is free and the producer that claims position may write to it.
+        //   Producers claim positions by incrementing _tail with a CAS, which is the only point of contention.
+        // * sequence == position + 1: The producer has finished writing and the consumer may read the slot.
+        // * After reading, the consumer sets the sequence to position + capacity, which is the
+        //   position at which the slot will be reused, marking it as free for the next revolution.
+        // * If the sequence is less than the position a producer wants to claim, the queue is full.
+        //
+        // Since a producer may be preempted between claiming a position and writing to its slot,
+        // the consumer will wait for that producer even if others have finished writing to later slots.
+        // This keeps the queue FIFO, which is what all of its users want anyways.
+        //
+        // Blocking is implemented with two eventcounts, so that pushing and popping only costs
+        // a fence and a load if no one is waiting, instead of a WakeByAddress call each time.
+        template<typename T>
+        struct arc
+        {
+            explicit arc(size_type capacity) :
+                _slots(spsc::details::alloc_raw_memory<slot<T>>(static_cast<size_t>(capacity) * sizeof(slot<T>))),
+                _mask(capacity - 1)
+            {
+                for (size_type i = 0; i < capacity; ++i)
+                {
+                    new (&_slots[i].sequence) std::atomic<uint64_t>(i);
+                }
+            }
+
+            ~arc()
+            {
+                // All handles are gone, so there can't be any half written slots.
+                for (auto position = _head;; ++position)
+                {
+                    auto& s = _slots[position & _mask];
+                    if (s.sequence.load(std::memory_order_acquire) != position + 1)
+                    {
+                        break;
+                    }
+                    std::destroy_at(s.get());
+                }
+
+                spsc::details::free_raw_memory(_slots);
+            }
+
+            void add_producer() noexcept
+            {
+                _producers.fetch_add(1, std::memory_order_relaxed);
+                _references.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void drop_producer() noexcept
+            {
+                // The release ordering ensures that the consumer sees everything written
+                // by the producer when it observes that the last producer is gone.
+                if (_producers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    _notEmpty.notify();
+                }
+                release_reference();
+            }
+
+            void drop_consumer() noexcept
+            {
+                _consumerAlive.store(false, std::memory_order_relaxed);
+                _notFull.notify();
+                release_reference();
+            }
+
+            acquisition<T> producer_acquire(bool blocking) noexcept
+            {
+                for (;;)
+                {
+                    if (!_consumerAlive.load(std::memory_order_relaxed))
+                    {
+                        return { nullptr, 0, false };
+                    }
+
+                    auto position = _tail.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        auto& s = _slots[position & _mask];
+                        // This acquire read synchronizes with the release write in consumer_release().
+                        const auto sequence = s.sequence.load(std::memory_order_acquire);
+                        const auto diff = static_cast<int64_t>(sequence - position);
+
+                        if (diff == 0)
+                        {
+                            // On failure, compare_exchange_weak() updates position with the current _tail.
+                            if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                            {
+                                return { &s, position, true };
+                            }
+                        }
+                        else if (diff < 0)
+                        {
+                            break;
+                        }
+                        else
+                        {
+                            // Another producer claimed this position in the meantime.
+                            position = _tail.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    if (!blocking)
+                    {
+                        return { nullptr, 0, true };
+                    }
+
+                    const auto key = _notFull.prepare_wait();
+                    if (!_is_full() || !_consumerAlive.load(std::memory_order_seq_cst))
+                    {
+                        _notFull.cancel_wait();
+                        continue;
+                    }
+                    _notFull.wait(key);
+                }
+            }
+
+            void producer_release(acquisition<T> acquisition) noexcept
+            {
+                // This release write synchronizes with the acquire read in consumer_acquire().
+                acquisition.target->sequence.store(acquisition.position + 1, std::memory_order_release);
+                _notEmpty.notify();
+            }
+
+            acquisition<T> consumer_acquire(bool blocking) noexcept
+            {
+                for (;;)
+                {
+                    auto& s = _slots[_head & _mask];
+                    if (s.sequence.load(std::memory_order_acquire) == _head + 1)
+                    {
+                        return { &s, _head, true };
+                    }
+
+                    // A producer may have written an item right before leaving.
+                    // This is why the slot is checked again after observing that all producers are gone.
+                    if (_producers.load(std::memory_order_acquire) == 0)
+                    {
+                        if (s.sequence.load(std::memory_order_acquire) == _head + 1)
+                        {
+                            continue;
+                        }
+                        return { nullptr, 0, false };
+                    }
+
+                    if (!blocking)
+                    {
+                        return { nullptr, 0, true };
+                    }
+
+                    const auto key = _notEmpty.prepare_wait();
+                    if (s.sequence.load(std::memory_order_seq_cst) == _head + 1 || _producers.load(std::memory_order_seq_cst) == 0)
+                    {
+                        _notEmpty.cancel_wait();
+                        continue;
+                    }
+                    _notEmpty.wait(key);
+                }
+            }
+
+            void consumer_release(acquisition<T> acquisition) noexcept
+            {
+                // This release write synchronizes with the acquire read in producer_acquire().
+                acquisition.target->sequence.store(acquisition.position + _mask + 1, std::memory_order_release);
+                _head = acquisition.position + 1;
+                _notFull.notify();
+            }
+
+        private:
+            bool _is_full() const noexcept
+            {
+                const auto position = _tail.load(std::memory_order_seq_cst);
+                const auto sequence = _slots[position & _mask].sequence.load(std::memory_order_seq_cst);
+                return static_cast<int64_t>(sequence - position) < 0;
+            }
+
+            void release_reference() noexcept
+            {
+                // The contents are only deleted when all producers and the consumer have been dropped.
+                if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    delete this;
+                }
+            }
+
+            slot<T>* const _slots;
+            const uint64_t _mask;
+
+            // _tail is shared between all producers, while _head is only ever accessed by the consumer.
+            // Keeping them on separate cache lines prevents pushes from slowing down pops and vice versa.
+            alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> _tail{ 0 };
+            alignas(std::hardware_destructive_interference_size) uint64_t _head = 0;
+
+            alignas(std::hardware_destructive_interference_size) eventcount _notEmpty;
+            eventcount _notFull;
+
+            std::atomic<size_t> _producers{ 1 };
+            std::atomic<size_t> _references{ 2 };
+            std::atomic<bool> _consumerAlive{ true };
+        };
+    }
+
+    template<typename T>
+    struct producer
+    {
+        explicit producer(details::arc<T>* arc) noexcept :
+            _arc(arc) {}
+
+        producer(const producer<T>& other) noexcept :
+            _arc(other._arc)
+        {
+            if (_arc)
+            {
+                _arc->add_producer();
+            }
+        }
+
+        producer<T>& operator=(const producer<T>& other) noexcept
+        {
+            if (this != &other)
+            {
+                drop();
+                _arc = other._arc;
+                if (_arc)
+                {
+                    _arc->add_producer();
+                }
+            }
+            return *this;
+        }
+
+        producer(producer<T>&& other) noexcept :
+            _arc(std::exchange(other._arc, nullptr))
+        {
+        }
+
+        producer<T>& operator=(producer<T>&& other) noexcept
+        {
+            drop();
+            _arc = std::exchange(other._arc, nullptr);
+            return *this;
+        }
+
+        ~producer()
+        {
+            drop();
+        }
+
+        // emplace constructs an item in-place at the end of the queue.
+        // It returns true, if the item was successfully placed within the queue.
+        // The return value will be false, if the consumer is gone.
+        template<typename... Args>
+        bool emplace(Args&&... args) const
+        {
+            const auto acquisition = _arc->producer_acquire(true);
+            if (!acquisition.target)
+            {
+                return false;
+            }
+
+            new (&acquisition.target->storage[0]) T(std::forward<Args>(args)...);
+
+            _arc->producer_release(acquisition);
+            return true;
+        }
+
+        // try_emplace is like emplace, but returns false instead of blocking if the queue is full.
+        template<typename... Args>
+        bool try_emplace(Args&&... args) const
+        {
+            const auto acquisition = _arc->producer_acquire(false);
+            if (!acquisition.target)
+            {
+                return false;
+            }
+
+            new (&acquisition.target->storage[0]) T(std::forward<Args>(args)...);
+
+            _arc->producer_release(acquisition);
+            return true;
+        }
+
+        template<typename InputIt>
+        std::pair<size_t, bool> push(InputIt first, InputIt last) const
+        {
+            return push_n(block_forever, first, std::distance(first, last));
+        }
+
+        // push writes the items between first and last into the queue.
+        // The amount of successfully written items is returned as the first pair field.
+        // The second pair field will be false if the consumer is gone.
+        template<typename WaitPolicy, typename InputIt, details::enable_if_wait_policy_t<WaitPolicy> = 0>
+        std::pair<size_t, bool> push(WaitPolicy&& policy, InputIt first, InputIt last) const
+        {
+            return push_n(std::forward<WaitPolicy>(policy), first, std::distance(first, last));
+        }
+
+        template<typename InputIt>
+        std::pair<size_t, bool> push_n(InputIt first, size_t count) const
+        {
+            return push_n(block_forever, first, count);
+        }
+
+        // push_n writes count items from first into the queue.
+        // The amount of successfully written items is returned as the first pair field.
+        // The second pair field will be false if the consumer is gone.
+        //
+        // Items pushed by other producers at the same time may be interleaved with these.
+        template<typename WaitPolicy, typename InputIt, details::enable_if_wait_policy_t<WaitPolicy> = 0>
+        std::pair<size_t, bool> push_n(WaitPolicy&&, InputIt first, size_t count) const
+        {
+            auto blocking = true;
+            size_t written = 0;
+
+            for (; written < count; ++written, ++first)
+            {
+                const auto acquisition = _arc->producer_acquire(blocking);
+                if (!acquisition.target)
+                {
+                    return { written, acquisition.alive };
+                }
+
+                new (&acquisition.target->storage[0]) T(*first);
+                _arc->producer_release(acquisition);
+
+                if constexpr (!std::remove_reference_t<WaitPolicy>::_block_forever)
+                {
+                    blocking = false;
+                }
+            }
+
+            return { written, true };
+        }
+
+    private:
+        void drop() noexcept
+        {
+            if (_arc)
+            {
+                _arc->drop_producer();
+            }
+        }
+
+        details::arc<T>* _arc = nullptr;
+    };
+
+    template<typename T>
+    struct consumer
+    {
+        explicit consumer(details::arc<T>* arc) noexcept :
+            _arc(arc) {}
+
+        consumer(const consumer<T>&) = delete;
+        consumer<T>& operator=(const consumer<T>&) = delete;
+
+        consumer(consumer<T>&& other) noexcept :
+            _arc(std::exchange(other._arc, nullptr))
+        {
+        }
+
+        consumer<T>& operator=(consumer<T>&& other) noexcept
+        {
+            drop();
+            _arc = std::exchange(other._arc, nullptr);
+            return *this;
+        }
+
+        ~consumer()
+        {
+            drop();
+        }
+
+        // pop returns the next item in the queue, or std::nullopt if all producers are gone.
+        std::optional<T> pop() const
+        {
+            return _pop(true);
+        }
+
+        // try_pop returns the next item in the queue, or std::nullopt if the queue is empty.
+        std::optional<T> try_pop() const
+        {
+            return _pop(false);
+        }
+
+        template<typename OutputIt>
+        std::pair<size_t, bool> pop_n(OutputIt first, size_t count) const
+        {
+            return pop_n(block_forever, first, count);
+        }
+
+        // pop_n reads up to count items into first.
+        // The amount of successfully read items is returned as the first pair field.
+        // The second pair field will be false if all producers are gone.
+        template<typename WaitPolicy, typename OutputIt, details::enable_if_wait_policy_t<WaitPolicy> = 0>
+        std::pair<size_t, bool> pop_n(WaitPolicy&&, OutputIt first, size_t count) const
+        {
+            auto blocking = true;
+            size_t read = 0;
+
+            for (; read < count; ++read, ++first)
+            {
+                const auto acquisition = _arc->consumer_acquire(blocking);
+                if (!acquisition.target)
+                {
+                    return { read, acquisition.alive };
+                }
+
+                const auto item = acquisition.target->get();
+                *first = std::move(*item);
+                std::destroy_at(item);
+                _arc->consumer_release(acquisition);
+
+                if constexpr (!std::remove_reference_t<WaitPolicy>::_block_forever)
+                {
+                    blocking = false;
+                }
+            }
+
+            return { read, true };
+        }
+
+    private:
+        std::optional<T> _pop(bool blocking) const
+        {
+            const auto acquisition = _arc->consumer_acquire(blocking);
+            if (!acquisition.target)
+            {
+                return std::nullopt;
+            }
+
+            const auto item = acquisition.target->get();
+            std::optional<T> result{ std::move(*item) };
+            std::destroy_at(item);
+
+            _arc->consumer_release(acquisition);
+            return result;
+        }
+
+        void drop() noexcept
+        {
+            if (_arc)
+            {
+                _arc->drop_consumer();
+            }
+        }
+
+        details::arc<T>* _arc = nullptr;
+    };
+
+    // channel returns a bounded, lock-free, multi-producer, single-consumer
+    // FIFO queue ("channel") with at least the given capacity.
+    // The capacity is rounded up to the next power of two.
+    template<typename T>
+    std::pair<producer<T>, consumer<T>> channel(uint32_t capacity)
+    {
+        if (capacity == 0 || capacity > details::max_capacity)
+        {
+            throw std::invalid_argument{ "invalid capacity" };
+        }
+
+        const auto arc = new details::arc<T>(std::bit_ceil(capacity));
+        return { std::piecewise_construct, std::forward_as_tuple(arc), std::forward_as_tuple(arc) };
+    }
+}
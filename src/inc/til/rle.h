@@ -378,6 +378,15 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             }
         }
 
+        basic_rle(const size_type length, const value_type& value, const allocator_type& allocator) :
+            _runs(allocator), _total_length(length)
+        {
+            if (length)
+            {
+                _runs.emplace_back(value, length);
+            }
+        }
+
         void swap(basic_rle& other) noexcept
         {
             std::swap(_runs, other._runs);
@@ -1037,8 +1046,8 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     template<typename T, typename S = std::size_t>
     using rle = basic_rle<T, S, std::vector<rle_pair<T, S>>>;
 
-    template<typename T, typename S = std::size_t, std::size_t N = 1>
-    using small_rle = basic_rle<T, S, til::small_vector<rle_pair<T, S>, N>>;
+    template<typename T, typename S = std::size_t, std::size_t N = 1, typename Allocator = std::allocator<rle_pair<T, S>>>
+    using small_rle = basic_rle<T, S, til::small_vector<rle_pair<T, S>, N, Allocator>>;
 };
 
 #ifdef __WEX_COMMON_H__
@@ -0,0 +1,314 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <memory>
+#include <thread>
+
+namespace til
+{
+    // A cancellation_token is handed to long running work, which should check
+    // is_cancelled() regularly and stop early if it returns true.
+    // A default constructed token can never be cancelled.
+    struct cancellation_token
+    {
+        cancellation_token() = default;
+
+        bool is_cancelled() const noexcept
+        {
+            return _flag && _flag->load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend struct cancellation_source;
+
+        explicit cancellation_token(std::shared_ptr<std::atomic<bool>> flag) noexcept :
+            _flag{ std::move(flag) }
+        {
+        }
+
+        std::shared_ptr<std::atomic<bool>> _flag;
+    };
+
+    // A cancellation_source hands out tokens and cancels all of them at once.
+    // It's safe to call cancel() from any thread, including while the tokens are being checked.
+    struct cancellation_source
+    {
+        cancellation_source() :
+            _flag{ std::make_shared<std::atomic<bool>>(false) }
+        {
+        }
+
+        cancellation_token token() const noexcept
+        {
+            return cancellation_token{ _flag };
+        }
+
+        void cancel() const noexcept
+        {
+            _flag->store(true, std::memory_order_relaxed);
+        }
+
+        bool is_cancelled() const noexcept
+        {
+            return _flag->load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _flag;
+    };
+
+    struct parallel_for_options
+    {
+        // The smallest number of indices that are worth being processed on another thread.
+        // parallel_for() hands out work in chunks of this size.
+        size_t grain = 1;
+        // The maximum number of threads, including the calling thread, that may
+        // work on the range at the same time. 0 means one per logical processor.
+        size_t max_concurrency = 0;
+        // Once cancelled, no further chunks are started and parallel_for() returns early.
+        cancellation_token cancellation;
+    };
+
+    namespace details
+    {
+        // The [begin, end) chunk range of a participant is packed into a single
+        // 64-bit integer, so that it can be modified with a single CAS.
+        struct chunk_range
+        {
+            uint32_t begin;
+            uint32_t end;
+
+            static chunk_range unpack(uint64_t v) noexcept
+            {
+                return { static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32) };
+            }
+
+            uint64_t pack() const noexcept
+            {
+                return static_cast<uint64_t>(end) << 32 | begin;
+            }
+        };
+
+        // The state shared between all participants of a parallel_for() call.
+        //
+        // Each participant owns a contiguous range of chunks, initially an equal share of the whole range,
+        // and works its way through it from the front. Once it runs out, it steals the back half of the
+        // range of another participant. Since chunks are only ever handed out by shrinking these ranges,
+        // a participant that finds all of them empty knows that nothing is left to be started.
+        // This balances the work, if some chunks take longer than others or if a thread pool
+        // thread starts late, without any participant waiting on another, or on a lock.
+        //
+        // The calling thread is participant 0 and always helps. That's why parallel_for() is guaranteed
+        // to finish even if the thread pool doesn't get around to running any of the helpers, and
+        // why it's safe to call parallel_for() from within a parallel_for() callback.
+        struct parallel_for_state
+        {
+            void* context;
+            void (*run)(void* context, size_t begin, size_t end, size_t participant);
+            size_t begin;
+            size_t end;
+            size_t grain;
+            const cancellation_token* cancellation;
+
+            std::unique_ptr<std::atomic<uint64_t>[]> ranges;
+            size_t participants;
+            std::atomic<size_t> nextParticipant{ 1 };
+            std::atomic<bool> stop{ false };
+            std::exception_ptr exception;
+            std::atomic<bool> exceptionSet{ false };
+
+            bool pop(size_t participant, uint32_t& chunk) noexcept
+            {
+                auto& range = ranges[participant];
+                auto v = range.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    auto r = chunk_range::unpack(v);
+                    if (r.begin >= r.end)
+                    {
+                        return false;
+                    }
+                    chunk = r.begin++;
+                    if (range.compare_exchange_weak(v, r.pack(), std::memory_order_relaxed))
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            bool steal(size_t participant) noexcept
+            {
+                for (size_t i = 1; i < participants; ++i)
+                {
+                    auto& victim = ranges[(participant + i) % participants];
+                    auto v = victim.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        auto r = chunk_range::unpack(v);
+                        if (r.begin >= r.end)
+                        {
+                            break;
+                        }
+
+                        const auto stolen = (r.end - r.begin + 1) / 2;
+                        const chunk_range mine{ r.end - stolen, r.end };
+                        r.end -= stolen;
+
+                        if (victim.compare_exchange_weak(v, r.pack(), std::memory_order_relaxed))
+                        {
+                            // Our own range is empty, so others will at most try to steal from it, which fails
+                            // until this store is visible. Their CAS will fail afterwards, as the value changed.
+                            ranges[participant].store(mine.pack(), std::memory_order_relaxed);
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            void participate(size_t participant) noexcept
+            {
+                uint32_t chunk = 0;
+
+                while (!stop.load(std::memory_order_relaxed) && !cancellation->is_cancelled())
+                {
+                    if (!pop(participant, chunk))
+                    {
+                        // Someone might steal what we stole before we get to pop() it, which is why we loop around.
+                        if (steal(participant))
+                        {
+                            continue;
+                        }
+                        break;
+                    }
+
+                    const auto chunkBegin = begin + chunk * grain;
+                    const auto chunkEnd = std::min(end, chunkBegin + grain);
+
+                    try
+                    {
+                        run(context, chunkBegin, chunkEnd, participant);
+                    }
+                    catch (...)
+                    {
+                        // Only the first exception is kept. Everyone else stops as soon as possible.
+                        if (!exceptionSet.exchange(true, std::memory_order_relaxed))
+                        {
+                            exception = std::current_exception();
+                        }
+                        stop.store(true, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            static void CALLBACK callback(PTP_CALLBACK_INSTANCE, void* context, PTP_WORK) noexcept
+            {
+                const auto self = static_cast<parallel_for_state*>(context);
+                const auto participant = self->nextParticipant.fetch_add(1, std::memory_order_relaxed);
+                if (participant < self->participants)
+                {
+                    self->participate(participant);
+                }
+            }
+        };
+
+        inline size_t default_concurrency() noexcept
+        {
+            static const size_t concurrency = std::max<size_t>(1, std::thread::hardware_concurrency());
+            return concurrency;
+        }
+    }
+
+    // parallel_for calls func for consecutive subranges of [begin, end) on the calling thread and
+    // the system thread pool and returns once all of them have been processed. func is called with either
+    //   (size_t begin, size_t end), or
+    //   (size_t begin, size_t end, size_t participant)
+    // where participant is in the range [0, max_concurrency) and unique among the concurrently running calls.
+    // It can be used to index into per-thread state, like scratch buffers.
+    //
+    // If func throws, no further subranges are started and the first exception is rethrown.
+    // The same happens without an exception if the options' cancellation token is cancelled.
+    //
+    // This uses the process-wide system thread pool instead of threads of its own,
+    // so that multiple users of parallel_for() don't compete with each other for the CPU.
+    template<typename Func>
+    void parallel_for(size_t begin, size_t end, Func&& func, const parallel_for_options& options = {})
+    {
+        if (begin >= end || options.cancellation.is_cancelled())
+        {
+            return;
+        }
+
+        const auto grain = std::max<size_t>(1, options.grain);
+        const auto chunks = (end - begin + grain - 1) / grain;
+        const auto maxConcurrency = options.max_concurrency ? options.max_concurrency : details::default_concurrency();
+        const auto participants = std::min({ chunks, maxConcurrency, details::default_concurrency() });
+
+        const auto invoke = [&](size_t b, size_t e, size_t participant) {
+            if constexpr (std::is_invocable_v<Func&, size_t, size_t, size_t>)
+            {
+                func(b, e, participant);
+            }
+            else
+            {
+                func(b, e);
+            }
+        };
+
+        if (participants <= 1)
+        {
+            for (auto b = begin; b < end && !options.cancellation.is_cancelled(); b += grain)
+            {
+                invoke(b, std::min(end, b + grain), 0);
+            }
+            return;
+        }
+
+        if (chunks > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::overflow_error{ "range too large for parallel_for" };
+        }
+
+        using Invoke = decltype(invoke);
+        details::parallel_for_state state{
+            .context = const_cast<void*>(static_cast<const void*>(&invoke)),
+            .run = [](void* context, size_t b, size_t e, size_t participant) {
+                (*static_cast<const Invoke*>(context))(b, e, participant);
+            },
+            .begin = begin,
+            .end = end,
+            .grain = grain,
+            .cancellation = &options.cancellation,
+            .ranges = std::make_unique<std::atomic<uint64_t>[]>(participants),
+            .participants = participants,
+        };
+
+        for (size_t i = 0; i < participants; ++i)
+        {
+            const auto b = static_cast<uint32_t>(chunks * i / participants);
+            const auto e = static_cast<uint32_t>(chunks * (i + 1) / participants);
+            state.ranges[i].store(details::chunk_range{ b, e }.pack(), std::memory_order_relaxed);
+        }
+
+        const wil::unique_threadpool_work work{ CreateThreadpoolWork(&details::parallel_for_state::callback, &state, nullptr) };
+        THROW_LAST_ERROR_IF(!work);
+
+        for (size_t i = 1; i < participants; ++i)
+        {
+            SubmitThreadpoolWork(work.get());
+        }
+
+        state.participate(0);
+
+        // All chunks have been started at this point. Helpers that haven't started yet would find
+        // nothing to do, so they're cancelled instead, while we wait for the running ones to finish.
+        WaitForThreadpoolWorkCallbacks(work.get(), TRUE);
+
+        if (state.exception)
+        {
+            std::rethrow_exception(state.exception);
+        }
+    }
+}
@@ -313,16 +313,21 @@ namespace til
         }
     };
 
-    template<typename T, size_t N>
+    // The Allocator is only used for the heap allocated storage beyond the first N items.
+    // Stateful allocators are supported, but their allocations must be freeable by any instance of the
+    // allocator (is_always_equal), because moving a small_vector transfers its storage unconditionally.
+    template<typename T, size_t N, typename Allocator = std::allocator<T>>
     class small_vector
     {
+        using allocator_traits = std::allocator_traits<Allocator>;
+
     public:
         static_assert(N != 0, "A small_vector without a small buffer isn't very useful");
         static_assert(std::is_nothrow_move_assignable_v<T>, "_generic_insert doesn't guard against exceptions");
         static_assert(std::is_nothrow_move_constructible_v<T>, "_grow/_generic_insert don't guard against exceptions");
 
         using value_type = T;
-        using allocator_type = std::allocator<T>;
+        using allocator_type = Allocator;
         using pointer = T*;
         using const_pointer = const T*;
         using reference = T&;
@@ -335,6 +340,8 @@ namespace til
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+        static_assert(allocator_traits::is_always_equal::value, "small_vector transfers storage between allocators on move");
+
         small_vector() noexcept :
             _data{ &_buffer[0] },
             _capacity{ N },
@@ -342,6 +349,14 @@ namespace til
         {
         }
 
+        explicit small_vector(const Allocator& allocator) noexcept :
+            _allocator{ allocator },
+            _data{ &_buffer[0] },
+            _capacity{ N },
+            _size{ 0 }
+        {
+        }
+
         explicit small_vector(size_type count, const T& value = T{}) :
             small_vector{}
         {
@@ -363,7 +378,7 @@ namespace til
 
         // NOTE: If an exception is thrown while copying, the vector is left empty.
         small_vector(const small_vector& other) :
-            small_vector{}
+            small_vector{ allocator_traits::select_on_container_copy_construction(other._allocator) }
         {
             _copy_assign(other);
         }
@@ -380,7 +395,8 @@ namespace til
             return *this;
         }
 
-        small_vector(small_vector&& other) noexcept
+        small_vector(small_vector&& other) noexcept :
+            _allocator{ other._allocator }
         {
             _move_assign(other);
         }
@@ -392,7 +408,12 @@ namespace til
                 std::destroy(begin(), end());
                 if (_capacity != N)
                 {
-                    _deallocate(_data);
+                    _deallocate(_data, _capacity);
+                }
+
+                if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+                {
+                    _allocator = other._allocator;
                 }
 
                 _move_assign(other);
@@ -406,10 +427,15 @@ namespace til
             std::destroy(begin(), end());
             if (_capacity != N)
             {
-                _deallocate(_data);
+                _deallocate(_data, _capacity);
             }
         }
 
+        allocator_type get_allocator() const noexcept
+        {
+            return _allocator;
+        }
+
         constexpr size_type max_size() const noexcept { return static_cast<size_t>(-1) / sizeof(T); }
 
         constexpr pointer data() noexcept { return _data; }
@@ -606,7 +632,7 @@ namespace til
 
             std::uninitialized_move(begin(), end(), data);
             std::destroy(begin(), end());
-            _deallocate(_data);
+            _deallocate(_data, _capacity);
 
             _data = data;
             _capacity = capacity;
@@ -620,7 +646,7 @@ namespace til
 
             if (_capacity != N)
             {
-                _deallocate(_data);
+                _deallocate(_data, _capacity);
             }
 
             _data = &_buffer[0];
@@ -733,27 +759,41 @@ namespace til
             throw std::length_error("small_vector too long");
         }
 
-        static T* _allocate(size_t size)
+        T* _allocate(size_t size)
         {
-            if constexpr (alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            if constexpr (std::is_same_v<Allocator, std::allocator<T>>)
             {
-                return static_cast<T*>(::operator new(size * sizeof(T)));
+                if constexpr (alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                {
+                    return static_cast<T*>(::operator new(size * sizeof(T)));
+                }
+                else
+                {
+                    return static_cast<T*>(::operator new(size * sizeof(T), static_cast<std::align_val_t>(alignof(T))));
+                }
             }
             else
             {
-                return static_cast<T*>(::operator new(size * sizeof(T), static_cast<std::align_val_t>(alignof(T))));
+                return allocator_traits::allocate(_allocator, size);
             }
         }
 
-        static void _deallocate(T* data) noexcept
+        void _deallocate(T* data, size_t capacity) noexcept
         {
-            if constexpr (alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            if constexpr (std::is_same_v<Allocator, std::allocator<T>>)
             {
-                ::operator delete(data);
+                if constexpr (alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                {
+                    ::operator delete(data);
+                }
+                else
+                {
+                    ::operator delete(data, static_cast<std::align_val_t>(alignof(T)));
+                }
             }
             else
             {
-                ::operator delete(data, static_cast<std::align_val_t>(alignof(T)));
+                allocator_traits::deallocate(_allocator, data, capacity);
             }
         }
 
@@ -832,7 +872,7 @@ namespace til
 
             if (_capacity != N)
             {
-                _deallocate(_data);
+                _deallocate(_data, _capacity);
             }
 
             _data = data;
@@ -919,6 +959,7 @@ namespace til
             }
         }
 
+        [[msvc::no_unique_address]] Allocator _allocator;
         T* _data;
         size_t _capacity;
         size_t _size;
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <array>
+#include <bit>
+#include <source_location>
+
 #include "atomic.h"
 
 namespace til
@@ -41,6 +45,17 @@ namespace til
             til::atomic_notify_all(_now_serving);
         }
 
+        // Returns the number of threads that are currently waiting for the lock.
+        // This is only a snapshot and can be outdated by the time it returns.
+        uint32_t waiters() const noexcept
+        {
+            const auto next = _next_ticket.load(std::memory_order_relaxed);
+            const auto serving = _now_serving.load(std::memory_order_relaxed);
+            // The difference includes the current owner, if any.
+            const auto queued = next - serving;
+            return queued ? queued - 1 : 0;
+        }
+
     private:
         // You may be inclined to add alignas(std::hardware_destructive_interference_size)
         // here to force the two atomics on separate cache lines, but I suggest to carefully
@@ -54,14 +69,81 @@ namespace til
         std::atomic<uint32_t> _now_serving{ 0 };
     };
 
+    // lock_profiler can be attached to a recursive_ticket_lock to measure how long it's waited for and held.
+    // It's only consulted for the outermost lock()/unlock() pair and only if enabled() returns true,
+    // so that the instrumentation costs no more than a well-predicted branch if nobody's listening.
+    struct lock_profiler
+    {
+        // Bucket i counts the durations in the range [2^(i-1), 2^i) microseconds.
+        // The last bucket also counts everything longer than that.
+        static constexpr size_t bucket_count = 24;
+        using histogram = std::array<uint64_t, bucket_count>;
+
+        struct sample
+        {
+            // Where the lock was acquired.
+            std::source_location site;
+            uint64_t wait_us = 0;
+            uint64_t hold_us = 0;
+            // The number of threads that were already waiting when this one arrived.
+            uint32_t waiters = 0;
+        };
+
+        virtual ~lock_profiler() = default;
+
+        // Called on every outermost lock(). Must be cheap.
+        virtual bool enabled() const noexcept = 0;
+        // Called after the lock was acquired. hold_us is still 0.
+        virtual void acquired(const sample& sample) noexcept = 0;
+        // Called after the lock was released, after record() updated the histograms.
+        virtual void released(const sample& sample) noexcept = 0;
+
+        histogram wait_histogram() const noexcept
+        {
+            return _load(_wait_histogram);
+        }
+
+        histogram hold_histogram() const noexcept
+        {
+            return _load(_hold_histogram);
+        }
+
+        void record(const sample& sample) noexcept
+        {
+            _wait_histogram[_bucket(sample.wait_us)].fetch_add(1, std::memory_order_relaxed);
+            _hold_histogram[_bucket(sample.hold_us)].fetch_add(1, std::memory_order_relaxed);
+            released(sample);
+        }
+
+    private:
+        static constexpr size_t _bucket(uint64_t us) noexcept
+        {
+            return std::min<size_t>(std::bit_width(us), bucket_count - 1);
+        }
+
+        static histogram _load(const std::array<std::atomic<uint64_t>, bucket_count>& atomics) noexcept
+        {
+            histogram h{};
+            for (size_t i = 0; i < bucket_count; ++i)
+            {
+                h[i] = atomics[i].load(std::memory_order_relaxed);
+            }
+            return h;
+        }
+
+        std::array<std::atomic<uint64_t>, bucket_count> _wait_histogram{};
+        std::array<std::atomic<uint64_t>, bucket_count> _hold_histogram{};
+    };
+
     struct recursive_ticket_lock
     {
         struct recursive_ticket_lock_suspension
         {
-            constexpr recursive_ticket_lock_suspension(recursive_ticket_lock& lock, uint32_t owner, uint32_t recursion) noexcept :
+            constexpr recursive_ticket_lock_suspension(recursive_ticket_lock& lock, uint32_t owner, uint32_t recursion, const std::source_location& site) noexcept :
                 _lock{ lock },
                 _owner{ owner },
-                _recursion{ recursion }
+                _recursion{ recursion },
+                _site{ site }
             {
             }
 
@@ -79,7 +161,7 @@ namespace til
                     // If someone reacquired the lock on the current thread, we shouldn't lock it again.
                     if (_lock._owner.load(std::memory_order_relaxed) != _owner)
                     {
-                        _lock._lock.lock(); // lock-lock-lock lol
+                        _lock._acquire(_site); // lock-lock-lock lol
                         _lock._owner.store(_owner, std::memory_order_relaxed);
                     }
                     // ...but we should restore the original recursion count.
@@ -93,15 +175,24 @@ namespace til
             recursive_ticket_lock& _lock;
             uint32_t _owner = 0;
             uint32_t _recursion = 0;
+            std::source_location _site;
         };
 
-        void lock() noexcept
+        // The profiler must outlive the lock. Must not be called while the lock is held.
+        void set_profiler(lock_profiler* profiler) noexcept
+        {
+            _profiler = profiler;
+        }
+
+        // The site is recorded by the profiler, if any. std::unique_lock and friends will pass
+        // their own location, so callers that care should call lock() themselves and adopt it.
+        void lock(const std::source_location& site = std::source_location::current()) noexcept
         {
             const auto id = GetCurrentThreadId();
 
             if (_owner.load(std::memory_order_relaxed) != id)
             {
-                _lock.lock();
+                _acquire(site);
                 _owner.store(id, std::memory_order_relaxed);
             }
 
@@ -113,7 +204,7 @@ namespace til
             if (--_recursion == 0)
             {
                 _owner.store(0, std::memory_order_relaxed);
-                _lock.unlock();
+                _release();
             }
         }
 
@@ -129,10 +220,10 @@ namespace til
                 recursion = _recursion;
                 _owner.store(0, std::memory_order_relaxed);
                 _recursion = 0;
-                _lock.unlock();
+                _release();
             }
 
-            return { *this, owner, recursion };
+            return { *this, owner, recursion, _sample.site };
         }
 
         uint32_t is_locked() const noexcept
@@ -147,9 +238,62 @@ namespace til
         }
 
     private:
+        static uint64_t _now_us() noexcept
+        {
+            static const auto frequency = [] {
+                LARGE_INTEGER f;
+                QueryPerformanceFrequency(&f);
+                return f.QuadPart;
+            }();
+
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            return static_cast<uint64_t>(counter.QuadPart) * 1'000'000 / static_cast<uint64_t>(frequency);
+        }
+
+        void _acquire(const std::source_location& site) noexcept
+        {
+            if (!_profiler || !_profiler->enabled()) [[likely]]
+            {
+                _lock.lock();
+                return;
+            }
+
+            const auto waiters = _lock.waiters();
+            const auto beg = _now_us();
+            _lock.lock();
+            const auto end = _now_us();
+
+            _sample = { site, end - beg, 0, waiters };
+            _profiler->acquired(_sample);
+            // Taken after acquired(), so that the cost of the profiler isn't attributed to the holder.
+            _acquired_at = _now_us();
+        }
+
+        void _release() noexcept
+        {
+            if (!_acquired_at) [[likely]]
+            {
+                _lock.unlock();
+                return;
+            }
+
+            auto sample = _sample;
+            sample.hold_us = _now_us() - _acquired_at;
+            _acquired_at = 0;
+            _lock.unlock();
+
+            _profiler->record(sample);
+        }
+
         ticket_lock _lock;
         std::atomic<uint32_t> _owner = 0;
         uint32_t _recursion = 0;
+
+        // _profiler is set up before the lock is used. The others are only accessed while holding _lock.
+        lock_profiler* _profiler = nullptr;
+        lock_profiler::sample _sample;
+        uint64_t _acquired_at = 0;
     };
 
     using recursive_ticket_lock_suspension = recursive_ticket_lock::recursive_ticket_lock_suspension;
@@ -13,7 +13,12 @@ Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+functions MultiByteToWideChar and WideCharToMultiByte for the general case.
+Since then, fast paths have been added in front of them, which convert ASCII
+with SIMD and valid multi-byte sequences without the syscall overhead.
+These stop at the first invalid sequence and leave the remainder to
+the platform functions, so that error handling stays exactly the same.
+src\tools\U8U16Test measures their throughput.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -23,6 +28,305 @@ Author(s):
 
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26481 26490) // use not_null, pointer arithmetic, reinterpret_cast
+
+        // Routine Description:
+        // - Converts UTF-8 to UTF-16 from in until either the end of the input is reached, there isn't enough
+        //   space in the output, or an invalid sequence is encountered. in and out are advanced past what has been converted.
+        //   Since only valid input is converted, the result is identical to that of MultiByteToWideChar.
+        inline void u8u16_fast(const char*& in, const char* const inEnd, wchar_t*& out, const wchar_t* const outEnd) noexcept
+        {
+            auto it = reinterpret_cast<const uint8_t*>(in);
+            const auto end = reinterpret_cast<const uint8_t*>(inEnd);
+            auto o = out;
+
+            while (it != end)
+            {
+                const auto b0 = *it;
+
+                if (b0 < 0x80)
+                {
+#if defined(TIL_SSE_INTRINSICS)
+                    // Widen 16 bytes at a time, until we find a non-ASCII one. The vector is stored even if
+                    // it contains non-ASCII bytes, as it's cheaper than figuring out how much to store.
+                    // Those characters get overwritten with the correct values below.
+                    while (end - it >= 16 && outEnd - o >= 16)
+                    {
+                        const auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                        const auto zero = _mm_setzero_si128();
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_unpacklo_epi8(vec, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 8), _mm_unpackhi_epi8(vec, zero));
+
+                        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(vec));
+                        if (mask)
+                        {
+                            unsigned long offset;
+                            _BitScanForward(&offset, mask);
+                            it += offset;
+                            o += offset;
+                            break;
+                        }
+
+                        it += 16;
+                        o += 16;
+                    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+                    while (end - it >= 16 && outEnd - o >= 16)
+                    {
+                        const auto vec = vld1q_u8(it);
+                        if (vmaxvq_u8(vec) >= 0x80)
+                        {
+                            break;
+                        }
+                        vst1q_u16(reinterpret_cast<uint16_t*>(o), vmovl_u8(vget_low_u8(vec)));
+                        vst1q_u16(reinterpret_cast<uint16_t*>(o + 8), vmovl_high_u8(vec));
+                        it += 16;
+                        o += 16;
+                    }
+#endif
+                    if (it == end || *it >= 0x80)
+                    {
+                        continue;
+                    }
+                    if (o == outEnd)
+                    {
+                        break;
+                    }
+                    *o++ = *it++;
+                    continue;
+                }
+
+                if (o == outEnd)
+                {
+                    break;
+                }
+
+                const auto avail = end - it;
+
+                // 110xxxxx 10xxxxxx: U+0080..U+07FF. C0 and C1 would be overlong encodings.
+                if (b0 >= 0xC2 && b0 <= 0xDF)
+                {
+                    if (avail < 2 || (it[1] & 0xC0) != 0x80)
+                    {
+                        break;
+                    }
+                    *o++ = static_cast<wchar_t>((b0 & 0x1F) << 6 | (it[1] & 0x3F));
+                    it += 2;
+                    continue;
+                }
+
+                // 1110xxxx 10xxxxxx 10xxxxxx: U+0800..U+FFFF, except for surrogates.
+                if ((b0 & 0xF0) == 0xE0)
+                {
+                    if (avail < 3 || (it[1] & 0xC0) != 0x80 || (it[2] & 0xC0) != 0x80)
+                    {
+                        break;
+                    }
+                    const auto cp = static_cast<uint32_t>((b0 & 0x0F) << 12 | (it[1] & 0x3F) << 6 | (it[2] & 0x3F));
+                    if (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF))
+                    {
+                        break;
+                    }
+                    *o++ = static_cast<wchar_t>(cp);
+                    it += 3;
+                    continue;
+                }
+
+                // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx: U+10000..U+10FFFF as a surrogate pair.
+                if (b0 >= 0xF0 && b0 <= 0xF4)
+                {
+                    if (avail < 4 || (it[1] & 0xC0) != 0x80 || (it[2] & 0xC0) != 0x80 || (it[3] & 0xC0) != 0x80)
+                    {
+                        break;
+                    }
+                    const auto cp = static_cast<uint32_t>((b0 & 0x07) << 18 | (it[1] & 0x3F) << 12 | (it[2] & 0x3F) << 6 | (it[3] & 0x3F));
+                    if (cp < 0x10000 || cp > 0x10FFFF || outEnd - o < 2)
+                    {
+                        break;
+                    }
+                    o[0] = static_cast<wchar_t>(0xD7C0 + (cp >> 10));
+                    o[1] = static_cast<wchar_t>(0xDC00 | (cp & 0x3FF));
+                    o += 2;
+                    it += 4;
+                    continue;
+                }
+
+                break;
+            }
+
+            in = reinterpret_cast<const char*>(it);
+            out = o;
+        }
+
+        // Routine Description:
+        // - Converts UTF-16 to UTF-8. See u8u16_fast() for the details.
+        inline void u16u8_fast(const wchar_t*& in, const wchar_t* const inEnd, char*& out, const char* const outEnd) noexcept
+        {
+            auto it = in;
+            const auto end = inEnd;
+            auto o = reinterpret_cast<uint8_t*>(out);
+            const auto oEnd = reinterpret_cast<const uint8_t*>(outEnd);
+
+            while (it != end)
+            {
+                const auto c = static_cast<uint32_t>(*it);
+
+                if (c < 0x80)
+                {
+#if defined(TIL_SSE_INTRINSICS)
+                    // Narrow 16 characters at a time, until we find a non-ASCII one. Just like in u8u16_fast(),
+                    // the vector is stored even if it contains non-ASCII characters, which get overwritten below.
+                    const auto nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xff80));
+                    const auto zero = _mm_setzero_si128();
+
+                    while (end - it >= 16 && oEnd - o >= 16)
+                    {
+                        const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                        const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 8));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_packus_epi16(lo, hi));
+
+                        // Each of the 16 characters results in 1 bit in the mask, which is set if it's not ASCII.
+                        const auto loAscii = _mm_cmpeq_epi16(_mm_and_si128(lo, nonAsciiBits), zero);
+                        const auto hiAscii = _mm_cmpeq_epi16(_mm_and_si128(hi, nonAsciiBits), zero);
+                        const auto mask = ~static_cast<unsigned long>(_mm_movemask_epi8(_mm_packs_epi16(loAscii, hiAscii))) & 0xffff;
+                        if (mask)
+                        {
+                            unsigned long offset;
+                            _BitScanForward(&offset, mask);
+                            it += offset;
+                            o += offset;
+                            break;
+                        }
+
+                        it += 16;
+                        o += 16;
+                    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+                    while (end - it >= 8 && oEnd - o >= 8)
+                    {
+                        const auto vec = vld1q_u16(reinterpret_cast<const uint16_t*>(it));
+                        if (vmaxvq_u16(vec) >= 0x80)
+                        {
+                            break;
+                        }
+                        vst1_u8(o, vmovn_u16(vec));
+                        it += 8;
+                        o += 8;
+                    }
+#endif
+                    if (it == end || *it >= 0x80)
+                    {
+                        continue;
+                    }
+                    if (o == oEnd)
+                    {
+                        break;
+                    }
+                    *o++ = static_cast<uint8_t>(*it++);
+                    continue;
+                }
+
+                const auto space = oEnd - o;
+
+                if (c < 0x800)
+                {
+                    if (space < 2)
+                    {
+                        break;
+                    }
+                    o[0] = static_cast<uint8_t>(0xC0 | (c >> 6));
+                    o[1] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+                    o += 2;
+                    it += 1;
+                    continue;
+                }
+
+                if (c < 0xD800 || c > 0xDFFF)
+                {
+                    if (space < 3)
+                    {
+                        break;
+                    }
+                    o[0] = static_cast<uint8_t>(0xE0 | (c >> 12));
+                    o[1] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+                    o[2] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+                    o += 3;
+                    it += 1;
+                    continue;
+                }
+
+                // A high surrogate followed by a low one. Anything else is invalid.
+                if (c <= 0xDBFF && end - it >= 2 && it[1] >= 0xDC00 && it[1] <= 0xDFFF && space >= 4)
+                {
+                    const auto cp = 0x10000 + ((c - 0xD800) << 10) + (static_cast<uint32_t>(it[1]) - 0xDC00);
+                    o[0] = static_cast<uint8_t>(0xF0 | (cp >> 18));
+                    o[1] = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+                    o[2] = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+                    o[3] = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+                    o += 4;
+                    it += 2;
+                    continue;
+                }
+
+                break;
+            }
+
+            in = it;
+            out = reinterpret_cast<char*>(o);
+        }
+
+#pragma warning(pop)
+
+        // Routine Description:
+        // - A drop-in replacement for MultiByteToWideChar(CP_UTF8, 0, ...), which uses u8u16_fast() for as much of the input as possible.
+        // Return Value:
+        // - The number of UTF-16 code units written to out, or 0 if the conversion failed.
+        inline int u8u16_convert(const char* in, int inLength, wchar_t* out, int outCapacity) noexcept
+        {
+            const auto inEnd = in + inLength;
+            const auto outBeg = out;
+            u8u16_fast(in, inEnd, out, outBeg + outCapacity);
+
+            auto written = gsl::narrow_cast<int>(out - outBeg);
+            if (in != inEnd)
+            {
+                const auto len = MultiByteToWideChar(CP_UTF8, 0UL, in, gsl::narrow_cast<int>(inEnd - in), out, outCapacity - written);
+                if (!len)
+                {
+                    return 0;
+                }
+                written += len;
+            }
+            return written;
+        }
+
+        // Routine Description:
+        // - A drop-in replacement for WideCharToMultiByte(CP_UTF8, 0, ...), which uses u16u8_fast() for as much of the input as possible.
+        // Return Value:
+        // - The number of UTF-8 code units written to out, or 0 if the conversion failed.
+        inline int u16u8_convert(const wchar_t* in, int inLength, char* out, int outCapacity) noexcept
+        {
+            const auto inEnd = in + inLength;
+            const auto outBeg = out;
+            u16u8_fast(in, inEnd, out, outBeg + outCapacity);
+
+            auto written = gsl::narrow_cast<int>(out - outBeg);
+            if (in != inEnd)
+            {
+                const auto len = WideCharToMultiByte(CP_UTF8, 0UL, in, gsl::narrow_cast<int>(inEnd - in), out, outCapacity - written, nullptr, nullptr);
+                if (!len)
+                {
+                    return 0;
+                }
+                written += len;
+            }
+            return written;
+        }
+    }
+
     // state structure for maintenance of UTF-8 partials
     struct u8state
     {
@@ -70,7 +374,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
+            const int lengthOut = details::u8u16_convert(in.data(), lengthRequired, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -120,7 +424,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                     return S_OK;
                 }
 
-                len16 = MultiByteToWideChar(CP_UTF8, 0UL, &state.partials[0], gsl::narrow_cast<int>(state.have), out.data(), capa16);
+                len16 = details::u8u16_convert(&state.partials[0], gsl::narrow_cast<int>(state.have), out.data(), capa16);
                 RETURN_HR_IF(E_UNEXPECTED, !len16);
 
                 capa16 -= len16;
@@ -158,7 +462,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
+                const auto convLen{ details::u8u16_convert(cursor8, len8, out.data() + len16, capa16) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len16 += convLen;
@@ -197,7 +501,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
             out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
+            const int lengthOut = details::u16u8_convert(in.data(), lengthIn, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -238,7 +542,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             if (state.partials[0])
             {
                 state.partials[1] = *cursor16;
-                len8 = WideCharToMultiByte(CP_UTF8, 0UL, &state.partials[0], 2, out.data(), capa8, nullptr, nullptr);
+                len8 = details::u16u8_convert(&state.partials[0], 2, out.data(), capa8);
                 RETURN_HR_IF(E_UNEXPECTED, !len8);
 
                 state.reset();
@@ -259,7 +563,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len16)
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
+                const auto convLen{ details::u16u8_convert(cursor16, len16, out.data() + len8, capa8) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len8 += convLen;
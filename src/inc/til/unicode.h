@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "grapheme_table.h"
+
 namespace til
 {
     namespace details
@@ -187,4 +189,279 @@ namespace til
         std::wstring_view _value;
         bool _advance = true;
     };
+
+    // The Grapheme_Cluster_Break property of UAX #29 with Extended_Pictographic folded in as another value,
+    // because no codepoint is both Extended_Pictographic and anything but Other. The order matches grapheme_table.h.
+    enum class grapheme_property : uint8_t
+    {
+        Other,
+        CR,
+        LF,
+        Control,
+        Extend,
+        ZWJ,
+        RegionalIndicator,
+        Prepend,
+        SpacingMark,
+        L,
+        V,
+        T,
+        LV,
+        LVT,
+        ExtendedPictographic,
+    };
+
+    constexpr grapheme_property grapheme_property_of(const char32_t cp) noexcept
+    {
+        // Printable ASCII is by far the most common input and is all "Other".
+        if (cp - 0x20 < 0x5f)
+        {
+            return grapheme_property::Other;
+        }
+
+        const auto& table = details::grapheme_property_table;
+        const auto it = std::upper_bound(std::begin(table), std::end(table), static_cast<uint32_t>(cp) << 4 | 0xf);
+        auto prop = static_cast<grapheme_property>(*(it - 1) & 0xf);
+
+        // Every 28th Hangul syllable starting at U+AC00 is an LV, the others are LVT. See grapheme_table.h.
+        if (prop == grapheme_property::LV && (cp - 0xAC00) % 28 != 0)
+        {
+            prop = grapheme_property::LVT;
+        }
+
+        return prop;
+    }
+
+    namespace details
+    {
+        // Decodes the codepoint at idx and advances idx past it. Unpaired surrogates are returned as is,
+        // which makes them a "Control" according to grapheme_property_of(), just like UAX #29 says.
+        constexpr char32_t utf16_decode_next(const std::wstring_view& wstr, size_t& idx) noexcept
+        {
+            char32_t cp = til::at(wstr, idx++);
+            if (is_leading_surrogate(static_cast<wchar_t>(cp)) && idx < wstr.size() && is_trailing_surrogate(til::at(wstr, idx)))
+            {
+                cp = (cp & 0x3FF) << 10 | (til::at(wstr, idx++) & 0x3FF);
+                cp += 0x10000;
+            }
+            return cp;
+        }
+
+        // Returns true if there's a grapheme cluster boundary between two codepoints with the given properties.
+        // GB11 and GB12/13 depend on the codepoints that precede `a` and are handled by the callers,
+        // which is why this returns true for ZWJ x ExtendedPictographic and RegionalIndicator x RegionalIndicator.
+        constexpr bool grapheme_pair_breaks(const grapheme_property a, const grapheme_property b) noexcept
+        {
+            using P = grapheme_property;
+
+            // GB3
+            if (a == P::CR && b == P::LF)
+            {
+                return false;
+            }
+            // GB4, GB5
+            if (a == P::CR || a == P::LF || a == P::Control || b == P::CR || b == P::LF || b == P::Control)
+            {
+                return true;
+            }
+            // GB6, GB7, GB8
+            switch (a)
+            {
+            case P::L:
+                if (b == P::L || b == P::V || b == P::LV || b == P::LVT)
+                {
+                    return false;
+                }
+                break;
+            case P::LV:
+            case P::V:
+                if (b == P::V || b == P::T)
+                {
+                    return false;
+                }
+                break;
+            case P::LVT:
+            case P::T:
+                if (b == P::T)
+                {
+                    return false;
+                }
+                break;
+            default:
+                break;
+            }
+            // GB9, GB9a, GB9b
+            return !(b == P::Extend || b == P::ZWJ || b == P::SpacingMark || a == P::Prepend);
+        }
+
+        // grapheme_pair_breaks(), but only for breaks that hold no matter what precedes `a`.
+        constexpr bool grapheme_pair_breaks_always(const grapheme_property a, const grapheme_property b) noexcept
+        {
+            using P = grapheme_property;
+            return grapheme_pair_breaks(a, b) &&
+                   !(a == P::ZWJ && b == P::ExtendedPictographic) &&
+                   !(a == P::RegionalIndicator && b == P::RegionalIndicator);
+        }
+
+        // Ranges of code units that are never part of a grapheme cluster with another code unit from these ranges:
+        // Latin, Greek, Cyrillic, CJK punctuation, Kana, CJK ideographs and precomposed Hangul syllables.
+        // Each is {first, count}.
+        inline constexpr uint16_t grapheme_trivial_ranges[][2]{
+            { 0x0020, 0x0300 - 0x0020 },
+            { 0x0370, 0x0483 - 0x0370 },
+            { 0x3000, 0x302A - 0x3000 },
+            { 0x3030, 0x3099 - 0x3030 },
+            { 0x309B, 0xA000 - 0x309B },
+            { 0xAC00, 0xD7A4 - 0xAC00 },
+        };
+    }
+
+    // Returns true if the given code unit is from one of details::grapheme_trivial_ranges.
+    constexpr bool utf16_is_grapheme_trivial(const wchar_t wch) noexcept
+    {
+        for (const auto& r : details::grapheme_trivial_ranges)
+        {
+            if (static_cast<uint16_t>(wch - r[0]) < r[1])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns the number of leading code units in wstr for which utf16_is_grapheme_trivial() is true.
+    // Each of them is a grapheme cluster of its own, except for the last one, which may be joined
+    // with the code unit that follows it (for instance an "e" followed by U+0301 COMBINING ACUTE ACCENT).
+    // This allows callers to skip the grapheme segmentation for most text.
+    inline size_t utf16_count_grapheme_trivial(const std::wstring_view& wstr) noexcept
+    {
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+        const auto beg = wstr.data();
+        const auto end = beg + wstr.size();
+        auto it = beg;
+
+#if defined(TIL_SSE_INTRINSICS)
+        for (; end - it >= 8; it += 8)
+        {
+            const auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            auto trivial = _mm_setzero_si128();
+
+            // A code unit x is within [first, first+count) if (x - first) saturating-minus (count - 1) is 0.
+            for (const auto& r : details::grapheme_trivial_ranges)
+            {
+                const auto off = _mm_sub_epi16(vec, _mm_set1_epi16(static_cast<short>(r[0])));
+                const auto out = _mm_subs_epu16(off, _mm_set1_epi16(static_cast<short>(r[1] - 1)));
+                trivial = _mm_or_si128(trivial, _mm_cmpeq_epi16(out, _mm_setzero_si128()));
+            }
+
+            // Each of the 8 code units results in 2 bits in the mask, which are set if it's not trivial.
+            const auto mask = ~_mm_movemask_epi8(trivial) & 0xffff;
+            if (mask)
+            {
+                unsigned long offset;
+                _BitScanForward(&offset, mask);
+                return gsl::narrow_cast<size_t>(it - beg) + offset / 2;
+            }
+        }
+#endif
+
+        for (; it != end && utf16_is_grapheme_trivial(*it); ++it)
+        {
+        }
+
+        return gsl::narrow_cast<size_t>(it - beg);
+#pragma warning(pop)
+    }
+
+    // Returns the index of the next grapheme cluster in the given wstr (i.e. after the one that idx points at),
+    // according to the extended grapheme cluster rules of UAX #29.
+    constexpr size_t utf16_grapheme_next(const std::wstring_view& wstr, size_t idx) noexcept
+    {
+        using P = grapheme_property;
+
+        if (idx >= wstr.size())
+        {
+            return idx;
+        }
+
+        auto prev = grapheme_property_of(details::utf16_decode_next(wstr, idx));
+        // GB11: Whether the codepoints up to prev are an ExtendedPictographic followed by any number of Extend.
+        auto emoji = prev == P::ExtendedPictographic;
+        // GB11: Whether prev is a ZWJ that follows such a sequence.
+        auto emojiZwj = false;
+        // GB12, GB13: Whether prev is a RegionalIndicator that isn't paired up with the one before it yet.
+        auto flag = prev == P::RegionalIndicator;
+
+        while (idx < wstr.size())
+        {
+            auto next = idx;
+            const auto cur = grapheme_property_of(details::utf16_decode_next(wstr, next));
+
+            bool breaks;
+            if (prev == P::ZWJ && cur == P::ExtendedPictographic)
+            {
+                breaks = !emojiZwj;
+            }
+            else if (prev == P::RegionalIndicator && cur == P::RegionalIndicator)
+            {
+                breaks = !flag;
+            }
+            else
+            {
+                breaks = details::grapheme_pair_breaks(prev, cur);
+            }
+
+            if (breaks)
+            {
+                break;
+            }
+
+            emojiZwj = emoji && cur == P::ZWJ;
+            emoji = cur == P::ExtendedPictographic || (emoji && cur == P::Extend);
+            flag = cur == P::RegionalIndicator && prev != P::RegionalIndicator;
+            prev = cur;
+            idx = next;
+        }
+
+        return idx;
+    }
+
+    // Returns the index of the preceding grapheme cluster in the given wstr (i.e. of the one in front of idx).
+    constexpr size_t utf16_grapheme_prev(const std::wstring_view& wstr, size_t idx) noexcept
+    {
+        if (idx == 0)
+        {
+            return 0;
+        }
+
+        // Whether there's a boundary in front of a codepoint may depend on all the codepoints of the cluster before it (GB11-13).
+        // So we walk back to a boundary that doesn't and then segment forward from there up to idx.
+        auto beg = utf16_iterate_prev(wstr, idx);
+        auto tmp = beg;
+        auto cur = grapheme_property_of(details::utf16_decode_next(wstr, tmp));
+        for (auto pos = beg; pos != 0;)
+        {
+            pos = utf16_iterate_prev(wstr, pos);
+            tmp = pos;
+            const auto prev = grapheme_property_of(details::utf16_decode_next(wstr, tmp));
+            if (details::grapheme_pair_breaks_always(prev, cur))
+            {
+                break;
+            }
+            beg = pos;
+            cur = prev;
+        }
+
+        for (;;)
+        {
+            const auto next = utf16_grapheme_next(wstr, beg);
+            if (next >= idx)
+            {
+                return beg;
+            }
+            beg = next;
+        }
+    }
 }
@@ -18,7 +18,7 @@
 // ConIoSrv.h, included above. For security-related considerations, see Trust.h
 // in the ConIoSrv directory.
 
-extern void LockConsole();
+extern void LockConsole(const std::source_location& site = std::source_location::current());
 extern void UnlockConsole();
 
 using namespace Microsoft::Console::Render;
@@ -17,16 +17,139 @@
 
 using namespace Microsoft::Console::Interactivity;
 
-INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam)
+namespace
 {
-    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    // Posted to the dialog once a FindJob has finished. wParam is the FindJob::generation it's for.
+    // WM_USER+0 to WM_USER+2 are taken by the DM_ dialog messages, which is why this uses WM_APP.
+    constexpr UINT WM_FIND_COMPLETED = WM_APP + 1;
+
+    // A search through a snapshot of the entire buffer, which runs on the thread pool,
+    // so that searching through a large scrollback doesn't block the dialog or the console.
+    struct FindJob
+    {
+        HWND hwnd = nullptr;
+        WPARAM generation = 0;
+        std::wstring needle;
+        bool caseInsensitive = false;
+        TextBufferSnapshot snapshot;
+        til::cancellation_source cancellation;
+        std::optional<std::vector<til::point_span>> results;
+    };
+
     // This bool is used to track which option - up or down - was used to perform the last search. That way, the next time the
     //   find dialog is opened, it will default to the last used option.
-    static auto reverse = true;
-    static auto caseInsensitive = true;
-    static std::wstring lastFindString;
-    static Search searcher;
+    auto reverse = true;
+    auto caseInsensitive = true;
+    std::wstring lastFindString;
+    Search searcher;
+    // The most recently started FindJob. Results of any other (older) job are ignored.
+    std::shared_ptr<FindJob> findJob;
+
+    void CALLBACK FindJobCallback(PTP_CALLBACK_INSTANCE, void* context) noexcept
+    {
+        const std::unique_ptr<std::shared_ptr<FindJob>> owner{ static_cast<std::shared_ptr<FindJob>*>(context) };
+        auto& job = **owner;
 
+        try
+        {
+            job.results = Search::SearchSnapshot(job.snapshot, job.needle, job.caseInsensitive, job.cancellation.token());
+            if (job.results)
+            {
+                LOG_IF_WIN32_BOOL_FALSE(PostMessageW(job.hwnd, WM_FIND_COMPLETED, job.generation, 0));
+            }
+        }
+        CATCH_LOG();
+    }
+
+    // Takes a snapshot of the current buffer and searches through it on the thread pool. Must be called with the console locked.
+    // Once done, WM_FIND_COMPLETED is posted to hWnd and the results are picked up by FindCompleted().
+    void StartFindJob(HWND hWnd)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& textBuffer = gci.renderData.GetTextBuffer();
+        const auto generation = findJob ? findJob->generation + 1 : 0;
+
+        // If the previous job is still referenced by the thread pool, it's cancelled and left to its own devices.
+        // Otherwise its snapshot is reused, which means that only the rows that changed since need to be copied.
+        if (findJob && findJob.use_count() == 1)
+        {
+            findJob->cancellation = {};
+            findJob->results.reset();
+        }
+        else
+        {
+            if (findJob)
+            {
+                findJob->cancellation.cancel();
+            }
+            findJob = std::make_shared<FindJob>();
+        }
+
+        findJob->hwnd = hWnd;
+        findJob->generation = generation;
+        findJob->needle = lastFindString;
+        findJob->caseInsensitive = caseInsensitive;
+        textBuffer.UpdateSnapshot(findJob->snapshot, 0, textBuffer.TotalRowCount());
+
+        auto context = std::make_unique<std::shared_ptr<FindJob>>(findJob);
+        THROW_IF_WIN32_BOOL_FALSE(TrySubmitThreadpoolCallback(&FindJobCallback, context.get(), nullptr));
+        context.release();
+    }
+
+    void CancelFindJob() noexcept
+    {
+        if (findJob)
+        {
+            findJob->cancellation.cancel();
+        }
+    }
+
+    // Returns true if the thread pool is still searching for the current needle.
+    bool IsFindJobPending() noexcept
+    {
+        return findJob && findJob.use_count() > 1 && !findJob->cancellation.is_cancelled() &&
+               findJob->needle == lastFindString && findJob->caseInsensitive == caseInsensitive;
+    }
+
+    // Selects the next result or beeps if there's none. Must be called with the console locked.
+    void SelectCurrentOrBeep()
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        if (!searcher.SelectCurrent())
+        {
+            std::ignore = gci.GetActiveOutputBuffer().SendNotifyBeep();
+        }
+    }
+
+    // Adopts the results of the given FindJob, after it posted WM_FIND_COMPLETED. Must be called with the console locked.
+    void FindCompleted(HWND hWnd, WPARAM generation)
+    {
+        if (!findJob || findJob->generation != generation || !findJob->results || findJob->cancellation.is_cancelled())
+        {
+            return;
+        }
+
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto results = std::move(*findJob->results);
+        findJob->results.reset();
+
+        // The results belong to a buffer that isn't shown anymore (for instance, because the alternate buffer got activated).
+        if (findJob->snapshot.source != &gci.renderData.GetTextBuffer())
+        {
+            StartFindJob(hWnd);
+            return;
+        }
+
+        searcher.AdoptResults(gci.renderData, findJob->snapshot, findJob->needle, reverse, findJob->caseInsensitive, std::move(results));
+        // This catches up on anything that was written to the buffer while the job was running.
+        searcher.ResetIfStale(gci.renderData, findJob->needle, reverse, findJob->caseInsensitive);
+        searcher.MovePastCurrentSelection();
+        SelectCurrentOrBeep();
+    }
+}
+
+INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam)
+{
     switch (Message)
     {
     case WM_INITDIALOG:
@@ -52,6 +175,20 @@ INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM l
             LockConsole();
             auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
+            // Searching through the entire buffer is left to the thread pool. Pressing "Find Next"
+            // again while that's still going on doesn't restart it, unless the needle changed.
+            auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+            if (searcher.NeedsFullSearch(gci.renderData.GetTextBuffer(), lastFindString, caseInsensitive))
+            {
+                if (!IsFindJobPending())
+                {
+                    StartFindJob(hWnd);
+                }
+                return TRUE;
+            }
+
+            CancelFindJob();
+
             if (searcher.ResetIfStale(gci.renderData, lastFindString, reverse, caseInsensitive))
             {
                 searcher.MovePastCurrentSelection();
@@ -61,16 +198,12 @@ INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM l
                 searcher.FindNext();
             }
 
-            if (searcher.SelectCurrent())
-            {
-                return TRUE;
-            }
-
-            std::ignore = gci.GetActiveOutputBuffer().SendNotifyBeep();
-            break;
+            SelectCurrentOrBeep();
+            return TRUE;
         }
         case IDCANCEL:
             EndDialog(hWnd, 0);
+            CancelFindJob();
             searcher = Search{};
             return TRUE;
         default:
@@ -78,6 +211,13 @@ INT_PTR CALLBACK FindDialogProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM l
         }
         break;
     }
+    case WM_FIND_COMPLETED:
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        FindCompleted(hWnd, wParam);
+        return TRUE;
+    }
     default:
         break;
     }
@@ -6,6 +6,9 @@
 
 #include "Backend.h"
 #include "../base/FontCache.h"
+#include "../inc/RenderTracing.hpp"
+
+#include <StartupTimeline.h>
 
 // #### NOTE ####
 // If you see any code in here that contains "_r." you might be seeing a race condition.
@@ -137,6 +140,12 @@ constexpr HRESULT vec2_narrow(U x, U y, vec2<T>& out) noexcept
     return S_OK;
 }
 
+[[nodiscard]] HRESULT AtlasEngine::InvalidateScrollRegion(const til::rect* const /*psrRegion*/, const til::CoordType /*delta*/) noexcept
+{
+    // We repaint the region instead.
+    return S_FALSE;
+}
+
 [[nodiscard]] HRESULT AtlasEngine::InvalidateFlush(_In_ const bool /*circled*/, _Out_ bool* const pForcePaint) noexcept
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
@@ -161,12 +170,21 @@ constexpr HRESULT vec2_narrow(U x, U y, vec2<T>& out) noexcept
 }
 
 [[nodiscard]] HRESULT AtlasEngine::UpdateSoftFont(const std::span<const uint16_t> bitPattern, const til::size cellSize, const size_t centeringHint) noexcept
+try
 {
-    const auto softFont = _api.s.write()->font.write();
-    softFont->softFontPattern = std::vector(bitPattern.begin(), bitPattern.end());
-    softFont->softFontCellSize = cellSize;
+    // DECDLD may be used to animate glyphs, in which case the same pattern is
+    // often sent over and over again. There's nothing to do in that case.
+    if (const auto& softFont = *_api.s->softFont; softFont.cellSize == cellSize && std::ranges::equal(softFont.pattern, bitPattern))
+    {
+        return S_OK;
+    }
+
+    const auto softFont = _api.s.write()->softFont.write();
+    softFont->pattern.assign(bitPattern.begin(), bitPattern.end());
+    softFont->cellSize = cellSize;
     return S_OK;
 }
+CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::UpdateDpi(const int dpi) noexcept
 {
@@ -399,6 +417,23 @@ try
 }
 CATCH_LOG()
 
+void AtlasEngine::SetPixelShaderPartialRedraw(bool enable) noexcept
+{
+    if (_api.s->misc->customPixelShaderPartialRedraw != enable)
+    {
+        _api.s.write()->misc.write()->customPixelShaderPartialRedraw = enable;
+    }
+}
+
+void AtlasEngine::SetPixelShaderMaxFrameRate(int32_t fps) noexcept
+{
+    const auto value = gsl::narrow_cast<u16>(clamp(fps, 0, 1000));
+    if (_api.s->misc->customPixelShaderMaxFrameRate != value)
+    {
+        _api.s.write()->misc.write()->customPixelShaderMaxFrameRate = value;
+    }
+}
+
 void AtlasEngine::SetRetroTerminalEffect(bool enable) noexcept
 {
     if (_api.s->misc->useRetroTerminalEffect != enable)
@@ -425,6 +460,49 @@ void AtlasEngine::SetSoftwareRendering(bool enable) noexcept
     }
 }
 
+// Method Description:
+// - Forces the use of BackendD2D, even if the GPU supports BackendD3D. This allows benchmarking both backends on the same machine.
+void AtlasEngine::SetForceD2DMode(bool enable) noexcept
+{
+    if (_api.s->target->forceD2DMode != enable)
+    {
+        _api.s.write()->target.write()->forceD2DMode = enable;
+    }
+}
+
+// Method Description:
+// - Returns the statistics that the backends accumulated since the engine was created.
+FrameStatistics AtlasEngine::GetFrameStatistics() const noexcept
+{
+    return _p.stats;
+}
+
+// Method Description:
+// - Blocks until the GPU has finished all the work that was submitted so far, including the last Present().
+//   Together with the time Present() itself takes, this approximates the GPU time of a frame.
+void AtlasEngine::WaitUntilGpuIdle() noexcept
+try
+{
+    if (!_p.device)
+    {
+        return;
+    }
+
+    static constexpr D3D11_QUERY_DESC desc{ .Query = D3D11_QUERY_EVENT };
+    wil::com_ptr<ID3D11Query> query;
+    THROW_IF_FAILED(_p.device->CreateQuery(&desc, query.addressof()));
+
+    _p.deviceContext->End(query.get());
+    _p.deviceContext->Flush();
+
+    BOOL done = FALSE;
+    while (_p.deviceContext->GetData(query.get(), &done, sizeof(done), 0) == S_FALSE)
+    {
+        YieldProcessor();
+    }
+}
+CATCH_LOG()
+
 void AtlasEngine::SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept
 {
     _p.warningCallback = std::move(pfn);
@@ -485,6 +563,30 @@ void AtlasEngine::UpdateHyperlinkHoveredId(const uint16_t hoveredId) noexcept
     _api.hyperlinkHoveredId = hoveredId;
 }
 
+// Releases the swap chain, the backend with its glyph atlas and the D3D device, as well as the _shapedRowCache.
+// All of them are recreated by the next Present(), which also redraws the entire viewport.
+void AtlasEngine::TrimMemory() noexcept
+try
+{
+    _destroySwapChain();
+    _b.reset();
+    _p.deviceContext = {};
+    _p.device = {};
+    _shapedRowCache.assign(_shapedRowCache.size(), {});
+    _api.invalidatedRows = invalidatedRowsAll;
+    _glyphAtlasMemoryUsage.store(0, std::memory_order_relaxed);
+    _swapChainMemoryUsage.store(0, std::memory_order_relaxed);
+}
+CATCH_LOG()
+
+RenderEngineMemoryUsage AtlasEngine::GetMemoryUsage() const noexcept
+{
+    return {
+        .glyphAtlas = _glyphAtlasMemoryUsage.load(std::memory_order_relaxed),
+        .swapChain = _swapChainMemoryUsage.load(std::memory_order_relaxed),
+    };
+}
+
 #pragma endregion
 
 void AtlasEngine::_resolveTransparencySettings() noexcept
@@ -508,6 +610,11 @@ void AtlasEngine::_resolveTransparencySettings() noexcept
 
 void AtlasEngine::_updateFont(const wchar_t* faceName, const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes)
 {
+    ::Microsoft::Console::StartupTimeline::Mark(g_hRenderProvider, "FontUpdateBegin");
+    const auto markEnd = wil::scope_exit([]() noexcept {
+        ::Microsoft::Console::StartupTimeline::Mark(g_hRenderProvider, "FontUpdateEnd");
+    });
+
     std::vector<DWRITE_FONT_FEATURE> fontFeatures;
     if (!features.empty())
     {
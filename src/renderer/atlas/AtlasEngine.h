@@ -1,174 +1,261 @@
-// Copyright (c) Microsoft Corporation.
-// Licensed under the MIT license.
-
-#pragma once
-
-#include <dwrite_3.h>
-#include <d3d11_2.h>
-#include <dxgi1_3.h>
-
-#include "common.h"
-
-namespace Microsoft::Console::Render::Atlas
-{
-    struct TextAnalysisSinkResult;
-
-    class AtlasEngine final : public IRenderEngine
-    {
-    public:
-        explicit AtlasEngine();
-
-        AtlasEngine(const AtlasEngine&) = delete;
-        AtlasEngine& operator=(const AtlasEngine&) = delete;
-
-        // IRenderEngine
-        [[nodiscard]] HRESULT StartPaint() noexcept override;
-        [[nodiscard]] HRESULT EndPaint() noexcept override;
-        [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
-        void WaitUntilCanRender() noexcept override;
-        [[nodiscard]] HRESULT Present() noexcept override;
-        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
-        [[nodiscard]] HRESULT ScrollFrame() noexcept override;
-        [[nodiscard]] HRESULT Invalidate(const til::rect* psrRegion) noexcept override;
-        [[nodiscard]] HRESULT InvalidateCursor(const til::rect* psrRegion) noexcept override;
-        [[nodiscard]] HRESULT InvalidateSystem(const til::rect* prcDirtyClient) noexcept override;
-        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept override;
-        [[nodiscard]] HRESULT InvalidateScroll(const til::point* pcoordDelta) noexcept override;
-        [[nodiscard]] HRESULT InvalidateAll() noexcept override;
-        [[nodiscard]] HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept override;
-        [[nodiscard]] HRESULT InvalidateTitle(std::wstring_view proposedTitle) noexcept override;
-        [[nodiscard]] HRESULT NotifyNewText(const std::wstring_view newText) noexcept override;
-        [[nodiscard]] HRESULT PrepareRenderInfo(const RenderFrameInfo& info) noexcept override;
-        [[nodiscard]] HRESULT ResetLineTransform() noexcept override;
-        [[nodiscard]] HRESULT PrepareLineTransform(LineRendition lineRendition, til::CoordType targetRow, til::CoordType viewportLeft) noexcept override;
-        [[nodiscard]] HRESULT PaintBackground() noexcept override;
-        [[nodiscard]] HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept override;
-        [[nodiscard]] HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept override;
-        [[nodiscard]] HRESULT PaintSelection(const til::rect& rect) noexcept override;
-        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
-        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> pData, bool usingSoftFont, bool isSettingDefaultBrushes) noexcept override;
-        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo) noexcept override;
-        [[nodiscard]] HRESULT UpdateSoftFont(std::span<const uint16_t> bitPattern, til::size cellSize, size_t centeringHint) noexcept override;
-        [[nodiscard]] HRESULT UpdateDpi(int iDpi) noexcept override;
-        [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect& srNewViewport) noexcept override;
-        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo, int iDpi) noexcept override;
-        [[nodiscard]] HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override;
-        [[nodiscard]] HRESULT GetFontSize(_Out_ til::size* pFontSize) noexcept override;
-        [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view glyph, _Out_ bool* pResult) noexcept override;
-        [[nodiscard]] HRESULT UpdateTitle(std::wstring_view newTitle) noexcept override;
-
-        // DxRenderer - getter
-        HRESULT Enable() noexcept override;
-        [[nodiscard]] std::wstring_view GetPixelShaderPath() noexcept override;
-        [[nodiscard]] bool GetRetroTerminalEffect() const noexcept override;
-        [[nodiscard]] float GetScaling() const noexcept override;
-        [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept override;
-        [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept override;
-        // DxRenderer - setter
-        void SetAntialiasingMode(D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept override;
-        void SetCallback(std::function<void(HANDLE)> pfn) noexcept override;
-        void EnableTransparentBackground(const bool isTransparent) noexcept override;
-        void SetForceFullRepaintRendering(bool enable) noexcept override;
-        [[nodiscard]] HRESULT SetHwnd(HWND hwnd) noexcept override;
-        void SetPixelShaderPath(std::wstring_view value) noexcept override;
-        void SetRetroTerminalEffect(bool enable) noexcept override;
-        void SetSelectionBackground(COLORREF color, float alpha = 0.5f) noexcept override;
-        void SetSoftwareRendering(bool enable) noexcept override;
-        void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept override;
-        [[nodiscard]] HRESULT SetWindowSize(til::size pixels) noexcept override;
-        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept override;
-        void UpdateHyperlinkHoveredId(uint16_t hoveredId) noexcept override;
-
-    private:
-        // AtlasEngine.cpp
-        ATLAS_ATTR_COLD void _handleSettingsUpdate();
-        void _recreateFontDependentResources();
-        void _recreateCellCountDependentResources();
-        void _flushBufferLine();
-        void _mapCharacters(const wchar_t* text, u32 textLength, u32* mappedLength, IDWriteFontFace2** mappedFontFace) const;
-        void _mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRow& row);
-        ATLAS_ATTR_COLD void _mapReplacementCharacter(u32 from, u32 to, ShapedRow& row);
-
-        // AtlasEngine.api.cpp
-        void _resolveTransparencySettings() noexcept;
-        void _updateFont(const wchar_t* faceName, const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes);
-        void _resolveFontMetrics(const wchar_t* faceName, const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, FontSettings* fontMetrics = nullptr) const;
-
-        // AtlasEngine.r.cpp
-        ATLAS_ATTR_COLD void _recreateAdapter();
-        ATLAS_ATTR_COLD void _recreateBackend();
-        ATLAS_ATTR_COLD void _handleSwapChainUpdate();
-        void _createSwapChain();
-        void _destroySwapChain();
-        void _resizeBuffers();
-        void _updateMatrixTransform();
-        void _waitUntilCanRender() noexcept;
-        void _present();
-
-        static constexpr u16 u16min = 0x0000;
-        static constexpr u16 u16max = 0xffff;
-        static constexpr i16 i16min = -0x8000;
-        static constexpr i16 i16max = 0x7fff;
-        static constexpr u16r invalidatedAreaNone = { u16max, u16max, u16min, u16min };
-        static constexpr range<u16> invalidatedRowsNone{ u16max, u16min };
-        static constexpr range<u16> invalidatedRowsAll{ u16min, u16max };
-
-        std::unique_ptr<IBackend> _b;
-        RenderingPayload _p;
-
-        struct ApiState
-        {
-            GenerationalSettings s = DirtyGenerationalSettings();
-
-            // This structure is loosely sorted in chunks from "very often accessed together"
-            // to seldom accessed and/or usually not together.
-
-            bool invalidatedTitle = false;
-            // These two are redundant with TargetSettings/MiscellaneousSettings, but that's because _resolveTransparencySettings()
-            // turns the given settings into potentially different actual settings (which are then written into the Settings).
-            bool enableTransparentBackground = false;
-            AntialiasingMode antialiasingMode = DefaultAntialiasingMode;
-
-            std::vector<wchar_t> bufferLine;
-            std::vector<u16> bufferLineColumn;
-
-            std::wstring userLocaleName;
-
-            std::array<Buffer<DWRITE_FONT_AXIS_VALUE>, 4> textFormatAxes;
-            std::vector<TextAnalysisSinkResult> analysisResults;
-            Buffer<u16> clusterMap;
-            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
-            Buffer<u16> glyphIndices;
-            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
-            Buffer<f32> glyphAdvances;
-            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
-
-            wil::com_ptr<IDWriteFontFace2> replacementCharacterFontFace;
-            u16 replacementCharacterGlyphIndex = 0;
-            bool replacementCharacterLookedUp = false;
-
-            // PrepareLineTransform()
-            LineRendition lineRendition = LineRendition::SingleWidth;
-            // UpdateDrawingBrushes()
-            u32 backgroundOpaqueMixin = 0xff000000;
-            u32 currentBackground = 0;
-            u32 currentForeground = 0;
-            FontRelevantAttributes attributes = FontRelevantAttributes::None;
-            u16x2 lastPaintBufferLineCoord{};
-            // UpdateHyperlinkHoveredId()
-            u16 hyperlinkHoveredId = 0;
-
-            // dirtyRect is a computed value based on invalidatedRows.
-            til::rect dirtyRect;
-            // These "invalidation" fields are reset in EndPaint()
-            u16r invalidatedCursorArea = invalidatedAreaNone;
-            range<u16> invalidatedRows = invalidatedRowsNone; // x is treated as "top" and y as "bottom"
-            i16 scrollOffset = 0;
-        } _api;
-    };
-}
-
-namespace Microsoft::Console::Render
-{
-    using AtlasEngine = Atlas::AtlasEngine;
-}
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <dwrite_3.h>
+#include <d3d11_2.h>
+#include <dxgi1_3.h>
+
+#include "common.h"
+
+namespace Microsoft::Console::Render::Atlas
+{
+    struct TextAnalysisSinkResult;
+    struct FontFallbackCache;
+
+    class AtlasEngine final : public IRenderEngine
+    {
+    public:
+        explicit AtlasEngine();
+
+        AtlasEngine(const AtlasEngine&) = delete;
+        AtlasEngine& operator=(const AtlasEngine&) = delete;
+
+        // IRenderEngine
+        [[nodiscard]] HRESULT StartPaint() noexcept override;
+        [[nodiscard]] HRESULT EndPaint() noexcept override;
+        [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
+        void WaitUntilCanRender() noexcept override;
+        [[nodiscard]] HRESULT Present() noexcept override;
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override;
+        [[nodiscard]] HRESULT Invalidate(const til::rect* psrRegion) noexcept override;
+        [[nodiscard]] HRESULT InvalidateCursor(const til::rect* psrRegion) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSystem(const til::rect* prcDirtyClient) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScroll(const til::point* pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const til::rect* psrRegion, til::CoordType delta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]] HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept override;
+        [[nodiscard]] HRESULT InvalidateTitle(std::wstring_view proposedTitle) noexcept override;
+        [[nodiscard]] HRESULT NotifyNewText(const std::wstring_view newText) noexcept override;
+        [[nodiscard]] HRESULT PrepareRenderInfo(const RenderFrameInfo& info) noexcept override;
+        [[nodiscard]] HRESULT ResetLineTransform() noexcept override;
+        [[nodiscard]] HRESULT PrepareLineTransform(LineRendition lineRendition, til::CoordType targetRow, til::CoordType viewportLeft) noexcept override;
+        [[nodiscard]] HRESULT PaintBackground() noexcept override;
+        [[nodiscard]] HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept override;
+        [[nodiscard]] HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept override;
+        [[nodiscard]] HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice, til::CoordType targetRow, til::CoordType viewportLeft) noexcept override;
+        [[nodiscard]] HRESULT PaintSelection(const til::rect& rect) noexcept override;
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> pData, bool usingSoftFont, bool isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo) noexcept override;
+        [[nodiscard]] HRESULT UpdateSoftFont(std::span<const uint16_t> bitPattern, til::size cellSize, size_t centeringHint) noexcept override;
+        [[nodiscard]] HRESULT UpdateDpi(int iDpi) noexcept override;
+        [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect& srNewViewport) noexcept override;
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo, int iDpi) noexcept override;
+        [[nodiscard]] HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override;
+        [[nodiscard]] HRESULT GetFontSize(_Out_ til::size* pFontSize) noexcept override;
+        [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view glyph, _Out_ bool* pResult) noexcept override;
+        [[nodiscard]] HRESULT UpdateTitle(std::wstring_view newTitle) noexcept override;
+
+        // DxRenderer - getter
+        HRESULT Enable() noexcept override;
+        [[nodiscard]] std::wstring_view GetPixelShaderPath() noexcept override;
+        [[nodiscard]] bool GetRetroTerminalEffect() const noexcept override;
+        [[nodiscard]] float GetScaling() const noexcept override;
+        [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept override;
+        [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept override;
+        // DxRenderer - setter
+        void SetAntialiasingMode(D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept override;
+        void SetCallback(std::function<void(HANDLE)> pfn) noexcept override;
+        void EnableTransparentBackground(const bool isTransparent) noexcept override;
+        void SetForceFullRepaintRendering(bool enable) noexcept override;
+        [[nodiscard]] HRESULT SetHwnd(HWND hwnd) noexcept override;
+        void SetPixelShaderPath(std::wstring_view value) noexcept override;
+        void SetPixelShaderPartialRedraw(bool enable) noexcept override;
+        void SetPixelShaderMaxFrameRate(int32_t fps) noexcept override;
+        void SetRetroTerminalEffect(bool enable) noexcept override;
+        void SetSelectionBackground(COLORREF color, float alpha = 0.5f) noexcept override;
+        void SetSoftwareRendering(bool enable) noexcept override;
+        void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept override;
+        [[nodiscard]] HRESULT SetWindowSize(til::size pixels) noexcept override;
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept override;
+        void UpdateHyperlinkHoveredId(uint16_t hoveredId) noexcept override;
+        void TrimMemory() noexcept override;
+        [[nodiscard]] RenderEngineMemoryUsage GetMemoryUsage() const noexcept override;
+
+        // Benchmarking
+        void SetForceD2DMode(bool enable) noexcept;
+        [[nodiscard]] FrameStatistics GetFrameStatistics() const noexcept;
+        void WaitUntilGpuIdle() noexcept;
+
+    private:
+        struct ShapingState;
+        struct ShapingGroup;
+
+        // AtlasEngine.cpp
+        ATLAS_ATTR_COLD void _handleSettingsUpdate();
+        void _recreateFontDependentResources();
+        void _recreateCellCountDependentResources();
+        void _flushBufferLine();
+        void _shapeBufferLines();
+        void _shapeGroupsParallel();
+        void _shapeGroup(ShapingState& s, const ShapingGroup& group);
+        size_t _hashUnshapedLines(size_t beg, size_t end) const noexcept;
+        void _shapeBufferLine(ShapingState& s);
+        void _mapCharacters(const wchar_t* text, u32 textLength, FontRelevantAttributes attributes, u32* mappedLength, IDWriteFontFace2** mappedFontFace) const;
+        void _mapComplex(ShapingState& s, IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRow& row) const;
+        ATLAS_ATTR_COLD void _lookupReplacementCharacter();
+        ATLAS_ATTR_COLD void _mapReplacementCharacter(const ShapingState& s, u32 from, u32 to, ShapedRow& row) const;
+
+        // AtlasEngine.api.cpp
+        void _resolveTransparencySettings() noexcept;
+        void _updateFont(const wchar_t* faceName, const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes);
+        void _resolveFontMetrics(const wchar_t* faceName, const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, FontSettings* fontMetrics = nullptr) const;
+
+        // AtlasEngine.r.cpp
+        ATLAS_ATTR_COLD void _recreateAdapter();
+        ATLAS_ATTR_COLD void _recreateBackend();
+        ATLAS_ATTR_COLD void _handleSwapChainUpdate();
+        void _createSwapChain();
+        void _destroySwapChain();
+        void _resizeBuffers();
+        bool _setSourceSize(u16x2 size) const noexcept;
+        void _updateMatrixTransform();
+        void _waitUntilCanRender() noexcept;
+        void _waitForFrameRateLimit() noexcept;
+        void _waitWhileOccluded() noexcept;
+        void _present();
+
+        static constexpr u16 u16min = 0x0000;
+        static constexpr u16 u16max = 0xffff;
+        static constexpr i16 i16min = -0x8000;
+        static constexpr i16 i16max = 0x7fff;
+        static constexpr u16r invalidatedAreaNone = { u16max, u16max, u16min, u16min };
+        static constexpr range<u16> invalidatedRowsNone{ u16max, u16min };
+        static constexpr range<u16> invalidatedRowsAll{ u16min, u16max };
+
+        std::unique_ptr<IBackend> _b;
+        RenderingPayload _p;
+        // Updated by Present() for GetMemoryUsage(), which may be called from any thread.
+        std::atomic<size_t> _glyphAtlasMemoryUsage{ 0 };
+        std::atomic<size_t> _swapChainMemoryUsage{ 0 };
+        // See _waitForFrameRateLimit().
+        std::chrono::steady_clock::time_point _nextContinuousFrame;
+
+        // The text lines painted by PaintBufferLine() inside the console lock. Font fallback
+        // and shaping are the most expensive part of painting a frame, so _flushBufferLine()
+        // only copies the text in here and _shapeBufferLines() processes it outside the lock.
+        struct UnshapedLine
+        {
+            u32 textOffset = 0;
+            u32 textLength = 0;
+            // Each line has textLength + 1 columns. See ApiState::bufferLineColumn.
+            u32 columnOffset = 0;
+            u16 y = 0;
+            FontRelevantAttributes attributes = FontRelevantAttributes::None;
+        };
+        struct UnshapedText
+        {
+            std::vector<UnshapedLine> lines;
+            std::vector<wchar_t> text;
+            std::vector<u16> columns;
+        } _unshaped;
+
+        // A direct-mapped cache of _shapeBufferLines() results, keyed by a hash of a row's text, columns,
+        // attributes and foreground colors. Rows that get repainted with the same contents (for instance
+        // full-screen TUI redraws or scrolling back and forth) skip font fallback and shaping that way.
+        // Scrolling within the viewport doesn't need this, since it just moves the ShapedRows around.
+        struct ShapedRowCacheEntry
+        {
+            size_t hash = 0;
+            std::vector<FontMapping> mappings;
+            std::vector<u16> glyphIndices;
+            std::vector<f32> glyphAdvances;
+            std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            std::vector<u32> colors;
+        };
+        std::vector<ShapedRowCacheEntry> _shapedRowCache;
+
+        // The scratch state of _shapeBufferLine() and the functions it calls. There's one per thread
+        // that _shapeBufferLines() shapes rows on, with _shapingStates[0] belonging to the render thread.
+        struct ShapingState
+        {
+            wil::com_ptr<IDWriteTextAnalyzer1> textAnalyzer;
+            std::vector<wchar_t> bufferLine;
+            std::vector<u16> bufferLineColumn;
+            FontRelevantAttributes attributes = FontRelevantAttributes::None;
+            u16 y = 0;
+
+            std::vector<TextAnalysisSinkResult> analysisResults;
+            Buffer<u16> clusterMap;
+            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
+            Buffer<u16> glyphIndices;
+            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
+            Buffer<f32> glyphAdvances;
+            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
+        };
+        // The lines [beg, end) of _unshaped that belong to a row that missed the _shapedRowCache.
+        struct ShapingGroup
+        {
+            u32 beg = 0;
+            u32 end = 0;
+            // 0 if the row isn't cacheable.
+            size_t hash = 0;
+        };
+        std::vector<ShapingState> _shapingStates;
+        std::vector<ShapingGroup> _shapingGroups;
+
+        struct ApiState
+        {
+            GenerationalSettings s = DirtyGenerationalSettings();
+
+            // This structure is loosely sorted in chunks from "very often accessed together"
+            // to seldom accessed and/or usually not together.
+
+            bool invalidatedTitle = false;
+            // These two are redundant with TargetSettings/MiscellaneousSettings, but that's because _resolveTransparencySettings()
+            // turns the given settings into potentially different actual settings (which are then written into the Settings).
+            bool enableTransparentBackground = false;
+            AntialiasingMode antialiasingMode = DefaultAntialiasingMode;
+
+            std::vector<wchar_t> bufferLine;
+            std::vector<u16> bufferLineColumn;
+
+            std::wstring userLocaleName;
+
+            std::array<Buffer<DWRITE_FONT_AXIS_VALUE>, 4> textFormatAxes;
+            // The caches for _mapCharacters(), indexed by FontRelevantAttributes just like textFormatAxes.
+            std::array<std::shared_ptr<FontFallbackCache>, 4> fontFallbackCaches;
+
+            wil::com_ptr<IDWriteFontFace2> replacementCharacterFontFace;
+            u16 replacementCharacterGlyphIndex = 0;
+            bool replacementCharacterLookedUp = false;
+
+            // PrepareLineTransform()
+            LineRendition lineRendition = LineRendition::SingleWidth;
+            // UpdateDrawingBrushes()
+            u32 backgroundOpaqueMixin = 0xff000000;
+            u32 currentBackground = 0;
+            u32 currentForeground = 0;
+            FontRelevantAttributes attributes = FontRelevantAttributes::None;
+            u16x2 lastPaintBufferLineCoord{};
+            // UpdateHyperlinkHoveredId()
+            u16 hyperlinkHoveredId = 0;
+
+            // dirtyRect is a computed value based on invalidatedRows.
+            til::rect dirtyRect;
+            // These "invalidation" fields are reset in EndPaint()
+            u16r invalidatedCursorArea = invalidatedAreaNone;
+            range<u16> invalidatedRows = invalidatedRowsNone; // x is treated as "top" and y as "bottom"
+            i16 scrollOffset = 0;
+        } _api;
+    };
+}
+
+namespace Microsoft::Console::Render
+{
+    using AtlasEngine = Atlas::AtlasEngine;
+}
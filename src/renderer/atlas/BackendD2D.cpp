@@ -63,6 +63,12 @@ bool BackendD2D::RequiresContinuousRedraw() noexcept
     return false;
 }
 
+size_t BackendD2D::GetGlyphAtlasMemoryUsage() const noexcept
+{
+    // Direct2D draws glyphs directly and has no glyph atlas.
+    return 0;
+}
+
 void BackendD2D::_handleSettingsUpdate(const RenderingPayload& p)
 {
     const auto renderTargetChanged = !_renderTarget;
@@ -154,6 +160,7 @@ void BackendD2D::_drawBackground(const RenderingPayload& p) noexcept
     {
         _backgroundBitmap->CopyFromMemory(nullptr, p.backgroundBitmap.data(), gsl::narrow_cast<UINT32>(p.colorBitmapRowStride * sizeof(u32)));
         _backgroundBitmapGeneration = p.colorBitmapGenerations[0];
+        p.stats.bytesUploaded += p.backgroundBitmap.size() * sizeof(u32);
     }
 
     // If the terminal was 120x30 cells and 1200x600 pixels large, this would draw the
@@ -9,6 +9,7 @@
 #include <shader_ps.h>
 #include <shader_vs.h>
 
+#include "BuiltinGlyphs.h"
 #include "dwrite.h"
 #include "../../types/inc/ColorFix.hpp"
 
@@ -65,6 +66,20 @@ struct std::hash<BackendD3D::AtlasGlyphEntry>
     }
 };
 
+template<>
+struct std::hash<BackendD3D::AtlasBuiltinGlyphEntry>
+{
+    constexpr size_t operator()(u16 key) const noexcept
+    {
+        return til::flat_set_hash_integer(key);
+    }
+
+    constexpr size_t operator()(const BackendD3D::AtlasBuiltinGlyphEntry& slot) const noexcept
+    {
+        return til::flat_set_hash_integer(slot.glyphIndex);
+    }
+};
+
 template<>
 struct std::hash<BackendD3D::AtlasFontFaceEntry>
 {
@@ -191,6 +206,17 @@ BackendD3D::BackendD3D(const RenderingPayload& p)
         THROW_IF_FAILED(p.device->CreateBlendState(&desc, _blendState.addressof()));
     }
 
+    {
+        // The scissor rect is used by _flushQuads() to limit rasterization to the dirty rect. See Render().
+        static constexpr D3D11_RASTERIZER_DESC desc{
+            .FillMode = D3D11_FILL_SOLID,
+            .CullMode = D3D11_CULL_NONE,
+            .DepthClipEnable = TRUE,
+            .ScissorEnable = TRUE,
+        };
+        THROW_IF_FAILED(p.device->CreateRasterizerState(&desc, _rasterizerState.addressof()));
+    }
+
 #ifndef NDEBUG
     _sourceDirectory = std::filesystem::path{ __FILE__ }.parent_path();
     _sourceCodeWatcher = wil::make_folder_change_reader_nothrow(_sourceDirectory.c_str(), false, wil::FolderChangeEvents::FileName | wil::FolderChangeEvents::LastWriteTime, [this](wil::FolderChangeEvent, PCWSTR path) {
@@ -234,18 +260,53 @@ void BackendD3D::Render(RenderingPayload& p)
     }
 #endif
 
+    // Any _flushQuads() calls during _drawText() (when the glyph atlas is full) happen before we know
+    // the final dirty rect, so they need to rasterize the entire viewport.
+    _scissorRect = { 0, 0, p.s->targetSize.x, p.s->targetSize.y };
+
+    // Present1() guarantees that everything outside the dirty rect retains the previous frame's contents,
+    // including the rows it shifted for us via the scroll rect. This means we only need to rasterize the
+    // dirty rect, instead of redrawing the entire viewport for every line of streaming output.
+    // Custom shaders render into their own texture, which retains its contents as well, but which doesn't
+    // get scrolled by DXGI. Scrolling the shader's output instead would be wrong for effects like vignettes.
+    // Shaders that depend on time obviously need to be redrawn in their entirety every frame.
+    auto partialRedraw = !p.swapChain.presentFallback;
+    if (_customPixelShader)
+    {
+        partialRedraw &= _customShaderPartialRedraw && !p.scrollOffset && !_customShaderNeedsFullRedraw;
+        _customShaderNeedsFullRedraw = false;
+    }
+
+    // If no rows were invalidated, the dirty rect is already final, because only _drawText() extends it
+    // (for glyphs of invalidated rows that overhang their cell). Rows outside of it would be discarded by
+    // the scissor rect anyway and can be skipped entirely. The most common case for this is the blinking
+    // cursor, for which we then only generate and upload the quads of the row it's in. See _skipRow().
+    _skipCleanRows = !ATLAS_DEBUG_SHOW_DIRTY && partialRedraw && p.invalidatedRows.empty();
+
     _drawBackground(p);
     _drawCursorBackground(p);
     _drawText(p);
+    _drawImages(p);
     _drawSelection(p);
+
 #if ATLAS_DEBUG_SHOW_DIRTY
     _debugShowDirty(p);
+#else
+    if (partialRedraw)
+    {
+        _scissorRect = {
+            clamp<LONG>(p.dirtyRectInPx.left, 0, p.s->targetSize.x),
+            clamp<LONG>(p.dirtyRectInPx.top, 0, p.s->targetSize.y),
+            clamp<LONG>(p.dirtyRectInPx.right, 0, p.s->targetSize.x),
+            clamp<LONG>(p.dirtyRectInPx.bottom, 0, p.s->targetSize.y),
+        };
+    }
 #endif
     _flushQuads(p);
 
     if (_customPixelShader)
     {
-        _executeCustomShader(p);
+        _executeCustomShader(p, partialRedraw);
     }
 
 #if ATLAS_DEBUG_DUMP_RENDER_TARGET
@@ -258,6 +319,12 @@ bool BackendD3D::RequiresContinuousRedraw() noexcept
     return _requiresContinuousRedraw;
 }
 
+size_t BackendD3D::GetGlyphAtlasMemoryUsage() const noexcept
+{
+    // The atlas is a DXGI_FORMAT_B8G8R8A8_UNORM texture.
+    return _glyphAtlas ? size_t{ _glyphAtlasSize.x } * _glyphAtlasSize.y * 4 : 0;
+}
+
 void BackendD3D::_handleSettingsUpdate(const RenderingPayload& p)
 {
     if (!_renderTargetView)
@@ -268,13 +335,21 @@ void BackendD3D::_handleSettingsUpdate(const RenderingPayload& p)
     }
 
     const auto fontChanged = _fontGeneration != p.s->font.generation();
+    const auto softFontChanged = _softFontGeneration != p.s->softFont.generation();
     const auto miscChanged = _miscGeneration != p.s->misc.generation();
     const auto cellCountChanged = _viewportCellCount != p.s->viewportCellCount;
+    // The swap chain may get resized without its buffers being recreated (see AtlasEngine::_resizeBuffers()),
+    // so this can't rely on ReleaseResources() being called to recreate the size-dependent resources.
+    const auto targetSizeChanged = _targetSize != p.s->targetSize;
 
     if (fontChanged)
     {
         _updateFontDependents(p);
     }
+    if (softFontChanged)
+    {
+        _updateSoftFontDependents(p);
+    }
     if (miscChanged)
     {
         _recreateCustomShader(p);
@@ -283,10 +358,14 @@ void BackendD3D::_handleSettingsUpdate(const RenderingPayload& p)
     {
         _recreateBackgroundColorBitmap(p);
     }
+    if (fontChanged || cellCountChanged)
+    {
+        _recreateImageAtlas(p);
+    }
 
     // Similar to _renderTargetView above, we might have to recreate the _customRenderTargetView whenever _swapChainManager
     // resets it. We only do it after calling _recreateCustomShader however, since that sets the _customPixelShader.
-    if (_customPixelShader && !_customRenderTargetView)
+    if (_customPixelShader && (!_customRenderTargetView || targetSizeChanged))
     {
         _recreateCustomRenderTargetView(p);
     }
@@ -296,6 +375,7 @@ void BackendD3D::_handleSettingsUpdate(const RenderingPayload& p)
 
     _generation = p.s.generation();
     _fontGeneration = p.s->font.generation();
+    _softFontGeneration = p.s->softFont.generation();
     _miscGeneration = p.s->misc.generation();
     _targetSize = p.s->targetSize;
     _viewportCellCount = p.s->viewportCellCount;
@@ -308,6 +388,7 @@ void BackendD3D::_updateFontDependents(const RenderingPayload& p)
     DWrite_GetRenderParams(p.dwriteFactory.get(), &_gamma, &_cleartypeEnhancedContrast, &_grayscaleEnhancedContrast, _textRenderingParams.put());
     // Clearing the atlas requires BeginDraw(), which is expensive. Defer this until we need Direct2D anyways.
     _fontChangedResetGlyphAtlas = true;
+    _glyphAtlasSinglePage = false;
     _textShadingType = font.antialiasingMode == AntialiasingMode::ClearType ? ShadingType::TextClearType : ShadingType::TextGrayscale;
 
     {
@@ -342,6 +423,51 @@ void BackendD3D::_updateFontDependents(const RenderingPayload& p)
     _softFontBitmap.reset();
 }
 
+// Redefining the soft font only evicts the glyphs whose pattern actually changed, instead of resetting
+// the entire glyph atlas like _updateFontDependents() does. The space they occupied in the atlas
+// is reclaimed the next time their page gets evicted or the atlas gets reset.
+void BackendD3D::_updateSoftFontDependents(const RenderingPayload& p)
+{
+    const auto& softFont = *p.s->softFont;
+    const auto height = static_cast<size_t>(softFont.cellSize.height);
+    const auto cellSizeChanged = _softFontCellSize != softFont.cellSize;
+
+    const auto glyphChanged = [&](size_t glyphIndex) {
+        const auto offset = glyphIndex * height;
+        if (cellSizeChanged || offset + height > softFont.pattern.size() || offset + height > _softFontPattern.size())
+        {
+            return true;
+        }
+        const auto beg = softFont.pattern.begin() + offset;
+        return !std::equal(beg, beg + height, _softFontPattern.begin() + offset);
+    };
+
+    // Soft font glyphs are the ones without a font face. There's one such entry per line rendition.
+    for (auto& fontFaceSlot : _glyphAtlasMap.container())
+    {
+        if (!fontFaceSlot.inner || fontFaceSlot.inner->fontFace)
+        {
+            continue;
+        }
+
+        for (auto& glyph : fontFaceSlot.inner->glyphs.container())
+        {
+            if (glyph && glyph.glyphIndex >= 0xEF20u && glyphChanged(glyph.glyphIndex - 0xEF20u))
+            {
+                glyph.SetEvicted(true);
+            }
+        }
+    }
+
+    if (cellSizeChanged)
+    {
+        _softFontBitmap.reset();
+    }
+
+    _softFontPattern = softFont.pattern;
+    _softFontCellSize = softFont.cellSize;
+}
+
 void BackendD3D::_d2dRenderTargetUpdateFontSettings(const RenderingPayload& p) const noexcept
 {
     const auto& font = *p.s->font;
@@ -359,6 +485,7 @@ void BackendD3D::_recreateCustomShader(const RenderingPayload& p)
     _customShaderConstantBuffer.reset();
     _customShaderSamplerState.reset();
     _requiresContinuousRedraw = false;
+    _customShaderPartialRedraw = false;
 
     if (!p.s->misc->customPixelShaderPath.empty())
     {
@@ -427,6 +554,9 @@ void BackendD3D::_recreateCustomShader(const RenderingPayload& p)
                     }
                 }
             }
+
+            // We can't know whether a user-provided shader only samples nearby pixels, so this is opt-in.
+            _customShaderPartialRedraw = !_requiresContinuousRedraw && p.s->misc->customPixelShaderPartialRedraw;
         }
         else
         {
@@ -447,8 +577,9 @@ void BackendD3D::_recreateCustomShader(const RenderingPayload& p)
     else if (p.s->misc->useRetroTerminalEffect)
     {
         THROW_IF_FAILED(p.device->CreatePixelShader(&custom_shader_ps[0], sizeof(custom_shader_ps), nullptr, _customPixelShader.put()));
-        // We know the built-in retro shader doesn't require continuous redraw.
+        // We know the built-in retro shader doesn't require continuous redraw and that it only blurs nearby pixels.
         _requiresContinuousRedraw = false;
+        _customShaderPartialRedraw = true;
     }
 
     if (_customPixelShader)
@@ -485,6 +616,7 @@ void BackendD3D::_recreateCustomShader(const RenderingPayload& p)
 void BackendD3D::_recreateCustomRenderTargetView(const RenderingPayload& p)
 {
     // Avoid memory usage spikes by releasing memory first.
+    _customRenderTargetView.reset();
     _customOffscreenTexture.reset();
     _customOffscreenTextureView.reset();
 
@@ -500,6 +632,7 @@ void BackendD3D::_recreateCustomRenderTargetView(const RenderingPayload& p)
     THROW_IF_FAILED(p.device->CreateTexture2D(&desc, nullptr, _customOffscreenTexture.addressof()));
     THROW_IF_FAILED(p.device->CreateShaderResourceView(_customOffscreenTexture.get(), nullptr, _customOffscreenTextureView.addressof()));
     THROW_IF_FAILED(p.device->CreateRenderTargetView(_customOffscreenTexture.get(), nullptr, _customRenderTargetView.addressof()));
+    _customShaderNeedsFullRedraw = true;
 }
 
 void BackendD3D::_recreateBackgroundColorBitmap(const RenderingPayload& p)
@@ -524,6 +657,33 @@ void BackendD3D::_recreateBackgroundColorBitmap(const RenderingPayload& p)
     _backgroundBitmapGeneration = {};
 }
 
+void BackendD3D::_recreateImageAtlas(const RenderingPayload& p)
+{
+    // Avoid memory usage spikes by releasing memory first.
+    _imageAtlas.reset();
+    _imageAtlasView.reset();
+    _imageAtlasSlots.clear();
+
+    const auto cellSize = p.s->font->cellSize;
+    // Twice the number of rows in the viewport means that scrolling by up to a page doesn't require re-uploading any images.
+    // This is also guaranteed to be at least as many slots as there are rows in the viewport, since targetSize.y is <= 16384.
+    const auto slots = std::min<u32>(p.s->viewportCellCount.y * 2u, D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION / cellSize.y);
+    _imageAtlasWidth = gsl::narrow_cast<u16>(std::min<u32>(p.s->viewportCellCount.x * cellSize.x, D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION));
+
+    const D3D11_TEXTURE2D_DESC desc{
+        .Width = _imageAtlasWidth,
+        .Height = slots * cellSize.y,
+        .MipLevels = 1,
+        .ArraySize = 1,
+        .Format = DXGI_FORMAT_B8G8R8A8_UNORM,
+        .SampleDesc = { 1, 0 },
+        .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+    };
+    THROW_IF_FAILED(p.device->CreateTexture2D(&desc, nullptr, _imageAtlas.addressof()));
+    THROW_IF_FAILED(p.device->CreateShaderResourceView(_imageAtlas.get(), nullptr, _imageAtlasView.addressof()));
+    _imageAtlasSlots.resize(slots);
+}
+
 void BackendD3D::_recreateConstBuffer(const RenderingPayload& p) const
 {
     {
@@ -563,12 +723,13 @@ void BackendD3D::_setupDeviceContextState(const RenderingPayload& p)
     viewport.Width = static_cast<f32>(p.s->targetSize.x);
     viewport.Height = static_cast<f32>(p.s->targetSize.y);
     p.deviceContext->RSSetViewports(1, &viewport);
+    p.deviceContext->RSSetState(_rasterizerState.get());
 
     // PS: Pixel Shader
-    ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get() };
+    ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get(), _imageAtlasView.get() };
     p.deviceContext->PSSetShader(_pixelShader.get(), nullptr, 0);
     p.deviceContext->PSSetConstantBuffers(0, 1, _psConstantBuffer.addressof());
-    p.deviceContext->PSSetShaderResources(0, 2, &resources[0]);
+    p.deviceContext->PSSetShaderResources(0, 3, &resources[0]);
 
     // OM: Output Merger
     p.deviceContext->OMSetBlendState(_blendState.get(), nullptr, 0xffffffff);
@@ -691,8 +852,8 @@ void BackendD3D::_resetGlyphAtlas(const RenderingPayload& p)
     const auto cellArea = static_cast<u32>(p.s->font->cellSize.x) * p.s->font->cellSize.y;
     const auto targetArea = static_cast<u32>(p.s->targetSize.x) * p.s->targetSize.y;
 
-    const auto minAreaByFont = cellArea * 95; // Covers all printable ASCII characters
-    const auto minAreaByGrowth = static_cast<u32>(_rectPacker.width) * _rectPacker.height * 2;
+    const auto minAreaByFont = cellArea * (95 + 16); // Covers all printable ASCII characters and the prerasterized glyphs
+    const auto minAreaByGrowth = static_cast<u32>(_glyphAtlasSize.x) * _glyphAtlasSize.y * 2;
 
     // It's hard to say what the max. size of the cache should be. Optimally I think we should use as much
     // memory as is available, but the rendering code in this project is a big mess and so integrating
@@ -714,12 +875,31 @@ void BackendD3D::_resetGlyphAtlas(const RenderingPayload& p)
     const auto u = static_cast<u16>(1u << ((index + 2) / 2));
     const auto v = static_cast<u16>(1u << ((index + 1) / 2));
 
-    if (u != _rectPacker.width || v != _rectPacker.height)
+    if (u != _glyphAtlasSize.x || v != _glyphAtlasSize.y)
     {
         _resizeGlyphAtlas(p, u, v);
     }
 
-    stbrp_init_target(&_rectPacker, u, v, _rectPackerData.data(), _rectPackerData.size());
+    // Use as many pages as possible (up to 8) while still fitting at least 8 rows of cells into each of them.
+    // Since `v` is a power of 2 and so is the page count, every page is the same, power-of-2 height,
+    // which allows _drawText() to turn texcoords into page indices with a shift.
+    const auto minPageHeight = static_cast<u32>(p.s->font->cellSize.y) * 8;
+    u16 pageCount = 1;
+    while (!_glyphAtlasSinglePage && pageCount < _glyphAtlasPages.size() && v / (pageCount * 2u) >= minPageHeight)
+    {
+        pageCount *= 2;
+    }
+
+    _glyphAtlasPageCount = pageCount;
+    _glyphAtlasPageHeight = static_cast<u16>(v / pageCount);
+    _BitScanForward(&index, _glyphAtlasPageHeight);
+    _glyphAtlasPageShift = static_cast<u8>(index);
+    _glyphAtlasPageCurrent = 0;
+
+    for (u16 i = 0; i < pageCount; ++i)
+    {
+        _initializeGlyphAtlasPage(_glyphAtlasPages[i]);
+    }
 
     // This is a little imperfect, because it only releases the memory of the glyph mappings, not the memory held by
     // any DirectWrite fonts. On the other side, the amount of fonts on a system is always finite, where "finite"
@@ -730,6 +910,9 @@ void BackendD3D::_resetGlyphAtlas(const RenderingPayload& p)
         if (slot.inner)
         {
             slot.inner->glyphs.clear();
+            // Only a font change warrants drawing all of the Powerline glyphs again. If the atlas merely ran full,
+            // they'll be redrawn on demand, so that we don't immediately fill it up again with unused glyphs.
+            slot.inner->prerasterized &= !_fontChangedResetGlyphAtlas;
         }
     }
 
@@ -739,6 +922,107 @@ void BackendD3D::_resetGlyphAtlas(const RenderingPayload& p)
     _fontChangedResetGlyphAtlas = false;
 }
 
+void BackendD3D::_initializeGlyphAtlasPage(GlyphAtlasPage& page) const noexcept
+{
+    stbrp_init_target(&page.packer, _glyphAtlasSize.x, _glyphAtlasPageHeight, page.nodes.data(), page.nodes.size());
+    page.lastUsed = 0;
+}
+
+// Finds a spot for `rect` in the glyph atlas and returns true on success. If all pages are full, it'll
+// evict the least recently used page. If that isn't possible either, the atlas gets reset and this returns false.
+bool BackendD3D::_allocateGlyphAtlasRect(const RenderingPayload& p, stbrp_rect& rect)
+{
+    // Start with the page we last allocated from, because the earlier ones are most likely full.
+    for (u16 i = 0; i < _glyphAtlasPageCount; ++i)
+    {
+        const auto pageIndex = static_cast<u8>((_glyphAtlasPageCurrent + i) & (_glyphAtlasPageCount - 1));
+        auto& page = _glyphAtlasPages[pageIndex];
+
+        if (stbrp_pack_rects(&page.packer, &rect, 1))
+        {
+            rect.y += pageIndex * _glyphAtlasPageHeight;
+            _glyphAtlasPageCurrent = pageIndex;
+            return true;
+        }
+    }
+
+    if (rect.h > _glyphAtlasPageHeight && _glyphAtlasPageCount > 1)
+    {
+        // This glyph will never fit into any of the pages. Fall back to using the entire atlas as a single page.
+        _glyphAtlasSinglePage = true;
+    }
+    else if (_evictGlyphAtlasPage(rect))
+    {
+        return true;
+    }
+
+    _drawGlyphPrepareRetry(p);
+    return false;
+}
+
+// Clears the least recently used page that isn't in use by the current frame and allocates `rect` from it.
+// Glyph entries whose texture was in that page are marked as evicted and get redrawn by _drawText() on their next use.
+// Returns false if all pages are in use by the current frame (or the glyph doesn't fit into an empty page either).
+bool BackendD3D::_evictGlyphAtlasPage(stbrp_rect& rect)
+{
+    u16 pageIndex = _glyphAtlasPageCount;
+    u32 oldest = UINT32_MAX;
+
+    for (u16 i = 0; i < _glyphAtlasPageCount; ++i)
+    {
+        const auto lastUsed = _glyphAtlasPages[i].lastUsed;
+        if (lastUsed != _glyphAtlasFrame && lastUsed < oldest)
+        {
+            pageIndex = i;
+            oldest = lastUsed;
+        }
+    }
+
+    if (pageIndex >= _glyphAtlasPageCount)
+    {
+        return false;
+    }
+
+    auto& page = _glyphAtlasPages[pageIndex];
+    const auto top = static_cast<u16>(pageIndex * _glyphAtlasPageHeight);
+    const auto bottom = static_cast<u16>(top + _glyphAtlasPageHeight);
+
+    // swiss_flat_set doesn't support erasing entries, so we flag them instead. This also keeps the hash of the
+    // glyph index around, allowing us to redraw the glyph without another lookup. Whitespace and builtin glyphs have no texture.
+    for (auto& fontFaceSlot : _glyphAtlasMap.container())
+    {
+        if (!fontFaceSlot.inner)
+        {
+            continue;
+        }
+
+        for (auto& glyph : fontFaceSlot.inner->glyphs.container())
+        {
+            if (glyph && glyph.data.GetShadingType() != ShadingType::Default && glyph.data.GetShadingType() != ShadingType::TextBuiltinGlyph && glyph.data.texcoord.y >= top && glyph.data.texcoord.y < bottom)
+            {
+                glyph.SetEvicted(true);
+            }
+        }
+    }
+
+    _initializeGlyphAtlasPage(page);
+
+    _d2dBeginDrawing();
+    const D2D1_RECT_F clipRect{ 0, static_cast<f32>(top), static_cast<f32>(_glyphAtlasSize.x), static_cast<f32>(bottom) };
+    _d2dRenderTarget->PushAxisAlignedClip(&clipRect, D2D1_ANTIALIAS_MODE_ALIASED);
+    _d2dRenderTarget->Clear();
+    _d2dRenderTarget->PopAxisAlignedClip();
+
+    if (!stbrp_pack_rects(&page.packer, &rect, 1))
+    {
+        return false;
+    }
+
+    rect.y += top;
+    _glyphAtlasPageCurrent = static_cast<u8>(pageIndex);
+    return true;
+}
+
 void BackendD3D::_resizeGlyphAtlas(const RenderingPayload& p, const u16 u, const u16 v)
 {
     _d2dRenderTarget.reset();
@@ -801,10 +1085,14 @@ void BackendD3D::_resizeGlyphAtlas(const RenderingPayload& p, const u16 u, const
         THROW_IF_FAILED(_d2dRenderTarget->CreateSolidColorBrush(&color, nullptr, _brush.put()));
     }
 
-    ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get() };
-    p.deviceContext->PSSetShaderResources(0, 2, &resources[0]);
+    ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get(), _imageAtlasView.get() };
+    p.deviceContext->PSSetShaderResources(0, 3, &resources[0]);
 
-    _rectPackerData = Buffer<stbrp_node>{ u };
+    _glyphAtlasSize = { u, v };
+    for (auto& page : _glyphAtlasPages)
+    {
+        page.nodes = Buffer<stbrp_node>{ u };
+    }
 }
 
 BackendD3D::QuadInstance& BackendD3D::_getLastQuad() noexcept
@@ -858,11 +1146,23 @@ void BackendD3D::_flushQuads(const RenderingPayload& p)
         _recreateInstanceBuffers(p);
     }
 
+    // Appending with NO_OVERWRITE promises the driver that we won't touch any of the instances
+    // that previous draw calls may still be reading. It can then hand us the same memory without
+    // the buffer renaming (or worse, stalling) that WRITE_DISCARD implies. Only once we run out of
+    // space, we discard the whole buffer, which implicitly synchronizes with the GPU for us.
+    auto mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+    if (_instancesCount > _instanceBufferCapacity - _instanceBufferOffset)
+    {
+        mapType = D3D11_MAP_WRITE_DISCARD;
+        _instanceBufferOffset = 0;
+    }
+
     {
         D3D11_MAPPED_SUBRESOURCE mapped{};
-        THROW_IF_FAILED(p.deviceContext->Map(_instanceBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-        memcpy(mapped.pData, _instances.data(), _instancesCount * sizeof(QuadInstance));
+        THROW_IF_FAILED(p.deviceContext->Map(_instanceBuffer.get(), 0, mapType, 0, &mapped));
+        memcpy(static_cast<QuadInstance*>(mapped.pData) + _instanceBufferOffset, _instances.data(), _instancesCount * sizeof(QuadInstance));
         p.deviceContext->Unmap(_instanceBuffer.get(), 0);
+        p.stats.bytesUploaded += _instancesCount * sizeof(QuadInstance);
     }
 
     // I found 4 approaches to drawing lots of quads quickly. There are probably even more.
@@ -884,7 +1184,9 @@ void BackendD3D::_flushQuads(const RenderingPayload& p)
     //   Instead I found that packing instance data as tightly as possible made the biggest performance difference,
     //   and packing 16 bit integers with ID3D11InputLayout is quite a bit more convenient too.
 
-    p.deviceContext->DrawIndexedInstanced(6, static_cast<UINT>(_instancesCount), 0, 0, 0);
+    p.deviceContext->RSSetScissorRects(1, &_scissorRect);
+    p.deviceContext->DrawIndexedInstanced(6, static_cast<UINT>(_instancesCount), 0, 0, static_cast<UINT>(_instanceBufferOffset));
+    _instanceBufferOffset += _instancesCount;
     _instancesCount = 0;
 }
 
@@ -919,6 +1221,8 @@ void BackendD3D::_recreateInstanceBuffers(const RenderingPayload& p)
     p.deviceContext->IASetVertexBuffers(0, 2, &vertexBuffers[0], &strides[0], &offsets[0]);
 
     _instanceBufferCapacity = newCapacity;
+    // The first map of the new buffer must be a WRITE_DISCARD. See _flushQuads().
+    _instanceBufferOffset = newCapacity;
 }
 
 void BackendD3D::_drawBackground(const RenderingPayload& p)
@@ -953,9 +1257,15 @@ void BackendD3D::_uploadBackgroundBitmap(const RenderingPayload& p)
     }
 
     p.deviceContext->Unmap(_backgroundBitmap.get(), 0);
+    p.stats.bytesUploaded += p.backgroundBitmap.size() * sizeof(u32);
     _backgroundBitmapGeneration = p.colorBitmapGenerations[0];
 }
 
+bool BackendD3D::_skipRow(const RenderingPayload& p, const ShapedRow& row) const noexcept
+{
+    return _skipCleanRows && (row.dirtyBottom <= p.dirtyRectInPx.top || row.dirtyTop >= p.dirtyRectInPx.bottom);
+}
+
 void BackendD3D::_drawText(RenderingPayload& p)
 {
     if (_fontChangedResetGlyphAtlas)
@@ -963,12 +1273,21 @@ void BackendD3D::_drawText(RenderingPayload& p)
         _resetGlyphAtlas(p);
     }
 
+    // Pages used by this frame must not be evicted, because we already queued up quads referencing them.
+    ++_glyphAtlasFrame;
+
     til::CoordType dirtyTop = til::CoordTypeMax;
     til::CoordType dirtyBottom = til::CoordTypeMin;
 
     u16 y = 0;
     for (const auto row : p.rows)
     {
+        if (_skipRow(p, *row))
+        {
+            ++y;
+            continue;
+        }
+
         f32 baselineX = 0;
         f32 baselineY = y * p.s->font->cellSize.y + p.s->font->baseline;
         f32 scaleX = 1;
@@ -1005,19 +1324,37 @@ void BackendD3D::_drawText(RenderingPayload& p)
                 _initializeFontFaceEntry(fontFaceEntry);
             }
 
+            if (!fontFaceEntry.prerasterized)
+            {
+                // This is set beforehand, so that a full atlas can't get us stuck in the retry loop.
+                fontFaceEntry.prerasterized = true;
+                if (!_prerasterizeGlyphs(p, fontFaceEntry))
+                {
+#pragma warning(suppress : 26438) // Avoid 'goto' (es.76).
+#pragma warning(suppress : 26448) // Consider using gsl::finally if final action is intended (gsl.util).
+                    goto drawGlyphRetry;
+                }
+            }
+
             while (x < m.glyphsTo)
             {
                 const auto [glyphEntry, inserted] = fontFaceEntry.glyphs.insert(row->glyphIndices[x]);
 
-                if (inserted && !_drawGlyph(p, fontFaceEntry, glyphEntry))
+                if (inserted || glyphEntry.IsEvicted())
                 {
-                    // A deadlock in this retry loop is detected in _drawGlyphPrepareRetry.
-                    //
-                    // Yes, I agree, avoid goto. Sometimes. It's not my fault that C++ still doesn't
-                    // have a `continue outerloop;` like other languages had it for decades. :(
+                    p.stats.glyphAtlasMisses++;
+
+                    if (!_drawGlyph(p, fontFaceEntry, glyphEntry))
+                    {
+                        // A deadlock in this retry loop is detected in _drawGlyphPrepareRetry.
+                        //
+                        // Yes, I agree, avoid goto. Sometimes. It's not my fault that C++ still doesn't
+                        // have a `continue outerloop;` like other languages had it for decades. :(
 #pragma warning(suppress : 26438) // Avoid 'goto' (es.76).
 #pragma warning(suppress : 26448) // Consider using gsl::finally if final action is intended (gsl.util).
-                    goto drawGlyphRetry;
+                        goto drawGlyphRetry;
+                    }
+                    glyphEntry.SetEvicted(false);
                 }
 
                 if (glyphEntry.data.GetShadingType() != ShadingType::Default)
@@ -1038,6 +1375,11 @@ void BackendD3D::_drawText(RenderingPayload& p)
                         .texcoord = glyphEntry.data.texcoord,
                         .color = row->colors[x],
                     };
+                    // Builtin glyphs store their descriptor in texcoord and don't use the atlas at all.
+                    if (glyphEntry.data.GetShadingType() != ShadingType::TextBuiltinGlyph)
+                    {
+                        _glyphAtlasPages[glyphEntry.data.texcoord.y >> _glyphAtlasPageShift].lastUsed = _glyphAtlasFrame;
+                    }
 
                     if (glyphEntry.data.overlapSplit)
                     {
@@ -1190,6 +1532,69 @@ void BackendD3D::_initializeFontFaceEntry(AtlasFontFaceEntryInner& fontFaceEntry
             fontFaceEntry.boxGlyphs.insert(idx);
         }
     }
+
+    // Double width and height rows are rare enough that it's not worth spending atlas space on them.
+    // Builtin glyphs are limited to them as well, because the pixel shader assumes that they're one cell large.
+    if (fontFaceEntry.lineRendition != LineRendition::SingleWidth)
+    {
+        return;
+    }
+
+    // U+2500-259F are the Box Drawing and Block Elements blocks (the rest of the above are Geometric Shapes).
+    // If a font maps multiple of them to the same glyph, the first one wins.
+    for (u32 i = 0; i < 0xA0; ++i)
+    {
+        if (const auto idx = indices[i])
+        {
+            if (const auto descriptor = BuiltinGlyphs::GetDescriptor(codepoints[i]))
+            {
+                auto [entry, inserted] = fontFaceEntry.builtinGlyphs.insert(idx);
+                if (inserted)
+                {
+                    entry.descriptor = descriptor;
+                }
+            }
+        }
+    }
+
+    // U+E0B0-E0BF are the Powerline symbols in the Private Use Area.
+    ALLOW_UNINITIALIZED_BEGIN
+    std::array<u32, 16> powerlineCodepoints;
+    std::array<u16, 16> powerlineIndices;
+    ALLOW_UNINITIALIZED_END
+
+    for (u32 i = 0; i < powerlineCodepoints.size(); ++i)
+    {
+        powerlineCodepoints[i] = 0xE0B0 + i;
+    }
+
+    THROW_IF_FAILED(fontFaceEntry.fontFace->GetGlyphIndicesW(powerlineCodepoints.data(), powerlineCodepoints.size(), powerlineIndices.data()));
+
+    fontFaceEntry.prerasterizedGlyphs.reserve(powerlineIndices.size());
+    for (const auto idx : powerlineIndices)
+    {
+        if (idx && !fontFaceEntry.builtinGlyphs.lookup(idx))
+        {
+            fontFaceEntry.prerasterizedGlyphs.emplace_back(idx);
+        }
+    }
+}
+
+// Draws all of the fontFaceEntry.prerasterizedGlyphs into the glyph atlas that aren't in it yet, so that
+// the first frame of a TUI after a font change doesn't rasterize its Powerline characters one by one
+// in between all the other work. The atlas gets reset on every font change, which makes it the per-cell-size
+// sprite sheet for these glyphs. Returns false if the atlas ran full, just like _drawGlyph().
+bool BackendD3D::_prerasterizeGlyphs(const RenderingPayload& p, AtlasFontFaceEntryInner& fontFaceEntry)
+{
+    for (const auto idx : fontFaceEntry.prerasterizedGlyphs)
+    {
+        const auto [glyphEntry, inserted] = fontFaceEntry.glyphs.insert(idx);
+        if (inserted && !_drawGlyph(p, fontFaceEntry, glyphEntry))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool BackendD3D::_drawGlyph(const RenderingPayload& p, const AtlasFontFaceEntryInner& fontFaceEntry, AtlasGlyphEntry& glyphEntry)
@@ -1199,6 +1604,12 @@ bool BackendD3D::_drawGlyph(const RenderingPayload& p, const AtlasFontFaceEntryI
         return _drawSoftFontGlyph(p, fontFaceEntry, glyphEntry);
     }
 
+    if (const auto builtin = fontFaceEntry.builtinGlyphs.lookup(glyphEntry.glyphIndex))
+    {
+        _drawBuiltinGlyph(p, builtin->descriptor, glyphEntry);
+        return true;
+    }
+
     const DWRITE_GLYPH_RUN glyphRun{
         .fontFace = fontFaceEntry.fontFace.get(),
         .fontEmSize = p.s->font->fontSize,
@@ -1370,9 +1781,8 @@ bool BackendD3D::_drawGlyph(const RenderingPayload& p, const AtlasFontFaceEntryI
         .w = br - bl,
         .h = bb - bt,
     };
-    if (!stbrp_pack_rects(&_rectPacker, &rect, 1))
+    if (!_allocateGlyphAtlasRect(p, rect))
     {
-        _drawGlyphPrepareRetry(p);
         return false;
     }
 
@@ -1466,9 +1876,8 @@ bool BackendD3D::_drawSoftFontGlyph(const RenderingPayload& p, const AtlasFontFa
         baseline <<= heightShift;
     }
 
-    if (!stbrp_pack_rects(&_rectPacker, &rect, 1))
+    if (!_allocateGlyphAtlasRect(p, rect))
     {
-        _drawGlyphPrepareRetry(p);
         return false;
     }
 
@@ -1477,8 +1886,8 @@ bool BackendD3D::_drawSoftFontGlyph(const RenderingPayload& p, const AtlasFontFa
         // Allocating such a tiny texture is very wasteful (min. texture size on GPUs
         // right now is 64kB), but this is a seldomly used feature so it's fine...
         const D2D1_SIZE_U size{
-            static_cast<UINT32>(p.s->font->softFontCellSize.width),
-            static_cast<UINT32>(p.s->font->softFontCellSize.height),
+            static_cast<UINT32>(p.s->softFont->cellSize.width),
+            static_cast<UINT32>(p.s->softFont->cellSize.height),
         };
         const D2D1_BITMAP_PROPERTIES1 bitmapProperties{
             .pixelFormat = { DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED },
@@ -1489,12 +1898,12 @@ bool BackendD3D::_drawSoftFontGlyph(const RenderingPayload& p, const AtlasFontFa
     }
 
     {
-        const auto width = static_cast<size_t>(p.s->font->softFontCellSize.width);
-        const auto height = static_cast<size_t>(p.s->font->softFontCellSize.height);
+        const auto width = static_cast<size_t>(p.s->softFont->cellSize.width);
+        const auto height = static_cast<size_t>(p.s->softFont->cellSize.height);
 
         auto bitmapData = Buffer<u32>{ width * height };
         const auto glyphIndex = glyphEntry.glyphIndex - 0xEF20u;
-        auto src = p.s->font->softFontPattern.begin() + height * glyphIndex;
+        auto src = p.s->softFont->pattern.begin() + height * glyphIndex;
         auto dst = bitmapData.begin();
 
         for (size_t y = 0; y < height; y++)
@@ -1540,6 +1949,20 @@ bool BackendD3D::_drawSoftFontGlyph(const RenderingPayload& p, const AtlasFontFa
     return true;
 }
 
+// Builtin glyphs are drawn by the pixel shader as a cell-sized quad and don't occupy any space in the glyph atlas.
+// Since the descriptor doesn't depend on the font size, all they need after a font change is this new entry.
+void BackendD3D::_drawBuiltinGlyph(const RenderingPayload& p, u32 descriptor, AtlasGlyphEntry& glyphEntry) noexcept
+{
+    glyphEntry.data.shadingType = static_cast<u16>(ShadingType::TextBuiltinGlyph);
+    glyphEntry.data.overlapSplit = 0;
+    glyphEntry.data.offset.x = 0;
+    glyphEntry.data.offset.y = -p.s->font->baseline;
+    glyphEntry.data.size.x = p.s->font->cellSize.x;
+    glyphEntry.data.size.y = p.s->font->cellSize.y;
+    glyphEntry.data.texcoord.x = static_cast<u16>(descriptor);
+    glyphEntry.data.texcoord.y = static_cast<u16>(descriptor >> 16);
+}
+
 void BackendD3D::_drawGlyphPrepareRetry(const RenderingPayload& p)
 {
     THROW_HR_IF_MSG(E_UNEXPECTED, _glyphAtlasMap.empty(), "BackendD3D::_drawGlyph deadlock");
@@ -1567,6 +1990,7 @@ void BackendD3D::_splitDoubleHeightGlyph(const RenderingPayload& p, const AtlasF
     auto& glyphCache = _glyphAtlasMap.insert(key2).first.inner->glyphs;
     auto& entry2 = glyphCache.insert(glyphEntry.glyphIndex).first;
     entry2.data = glyphEntry.data;
+    entry2.SetEvicted(false);
 
     auto& top = isTop ? glyphEntry : entry2;
     auto& bottom = isTop ? entry2 : glyphEntry;
@@ -1918,6 +2342,9 @@ size_t BackendD3D::_drawCursorForegroundSlowPath(const CursorRect& c, size_t off
         return 0;
     }
 
+    // Builtin glyphs store their descriptor in texcoord, which must not be offset like an atlas position.
+    const auto texcoordShift = it.shadingType == ShadingType::TextBuiltinGlyph ? 0 : 1;
+
     const int cursorL = c.position.x;
     const int cursorT = c.position.y;
     const int cursorR = cursorL + c.size.x;
@@ -1997,8 +2424,8 @@ size_t BackendD3D::_drawCursorForegroundSlowPath(const CursorRect& c, size_t off
         target.position.y = static_cast<i16>(cutout.top);
         target.size.x = static_cast<u16>(cutout.right - cutout.left);
         target.size.y = static_cast<u16>(cutout.bottom - cutout.top);
-        target.texcoord.x = static_cast<u16>(it.texcoord.x + cutout.left - instanceL);
-        target.texcoord.y = static_cast<u16>(it.texcoord.y + cutout.top - instanceT);
+        target.texcoord.x = static_cast<u16>(it.texcoord.x + (cutout.left - instanceL) * texcoordShift);
+        target.texcoord.y = static_cast<u16>(it.texcoord.y + (cutout.top - instanceT) * texcoordShift);
         target.color = it.color;
     }
 
@@ -2014,8 +2441,8 @@ size_t BackendD3D::_drawCursorForegroundSlowPath(const CursorRect& c, size_t off
     target.position.y = static_cast<i16>(intersectionT);
     target.size.x = static_cast<u16>(intersectionR - intersectionL);
     target.size.y = static_cast<u16>(intersectionB - intersectionT);
-    target.texcoord.x = static_cast<u16>(it.texcoord.x + intersectionL - instanceL);
-    target.texcoord.y = static_cast<u16>(it.texcoord.y + intersectionT - instanceT);
+    target.texcoord.x = static_cast<u16>(it.texcoord.x + (intersectionL - instanceL) * texcoordShift);
+    target.texcoord.y = static_cast<u16>(it.texcoord.y + (intersectionT - instanceT) * texcoordShift);
     target.color = color;
 
     return addedInstances;
@@ -2029,7 +2456,7 @@ void BackendD3D::_drawSelection(const RenderingPayload& p)
 
     for (const auto& row : p.rows)
     {
-        if (row->selectionTo > row->selectionFrom)
+        if (row->selectionTo > row->selectionFrom && !_skipRow(p, *row))
         {
             // If the current selection line matches the previous one, we can just extend the previous quad downwards.
             // The way this is implemented isn't very smart, but we also don't have very many rows to iterate through.
@@ -2060,6 +2487,103 @@ void BackendD3D::_drawSelection(const RenderingPayload& p)
     }
 }
 
+void BackendD3D::_drawImages(RenderingPayload& p)
+{
+    // Slots used by this frame must not be reused, because we already queued up quads referencing them.
+    ++_imageAtlasFrame;
+
+    const auto cellSize = p.s->font->cellSize;
+    u16 y = 0;
+
+    for (const auto& row : p.rows)
+    {
+        if (const auto& slice = row->imageSlice; slice && !_skipRow(p, *row))
+        {
+            // Double-width rows stretch the image horizontally just like they stretch the text.
+            const auto shift = gsl::narrow_cast<u8>(row->lineRendition != LineRendition::SingleWidth);
+            const auto left = row->imageColumn * (cellSize.x << shift);
+            const auto width = std::min<til::CoordType>((slice->ColumnEnd() - slice->ColumnOffset()) * (cellSize.x << shift), _imageAtlasWidth);
+            // The part of the image within the viewport, relative to the image's left edge.
+            const auto visibleBeg = std::max(0, -left);
+            const auto visibleEnd = std::min<til::CoordType>(width, p.s->targetSize.x - left);
+
+            if (visibleBeg < visibleEnd)
+            {
+                const auto slot = _uploadImageSlice(p, *slice, shift);
+                _appendQuad() = {
+                    .shadingType = ShadingType::Image,
+                    .position = {
+                        gsl::narrow_cast<i16>(left + visibleBeg),
+                        gsl::narrow_cast<i16>(cellSize.y * y),
+                    },
+                    .size = {
+                        gsl::narrow_cast<u16>(visibleEnd - visibleBeg),
+                        cellSize.y,
+                    },
+                    .texcoord = {
+                        gsl::narrow_cast<u16>(visibleBeg),
+                        gsl::narrow_cast<u16>(cellSize.y * slot),
+                    },
+                };
+            }
+        }
+
+        y++;
+    }
+}
+
+// Returns the index of the _imageAtlasSlots slot containing the given slice. If it isn't cached yet,
+// it gets scaled to the cell size and uploaded into the least recently used slot.
+u16 BackendD3D::_uploadImageSlice(RenderingPayload& p, const ImageSlice& slice, const u8 shift)
+{
+    const auto revision = slice.Revision();
+    size_t lru = 0;
+
+    // There are only about twice as many slots as there are rows, so a linear search is plenty fast.
+    for (size_t i = 0; i < _imageAtlasSlots.size(); ++i)
+    {
+        auto& s = _imageAtlasSlots[i];
+        if (s.revision == revision && s.shift == shift)
+        {
+            s.lastUsed = _imageAtlasFrame;
+            return gsl::narrow_cast<u16>(i);
+        }
+        if (s.lastUsed < _imageAtlasSlots[lru].lastUsed)
+        {
+            lru = i;
+        }
+    }
+
+    const auto cellSize = p.s->font->cellSize;
+    const auto srcWidth = gsl::narrow_cast<size_t>(slice.PixelWidth());
+    const auto srcHeight = gsl::narrow_cast<size_t>(slice.CellSize().height);
+    const auto srcPixels = slice.Pixels();
+    // dstScale is the width of the entire scaled slice, of which only the first dstWidth pixels fit into the atlas.
+    const auto dstScale = gsl::narrow_cast<size_t>(slice.ColumnEnd() - slice.ColumnOffset()) * (size_t{ cellSize.x } << shift);
+    const auto dstWidth = std::min<size_t>(dstScale, _imageAtlasWidth);
+    const auto dstHeight = size_t{ cellSize.y };
+
+    // Nearest neighbor scaling keeps the pixel art look of sixel images intact.
+    _imageScratch.resize(dstWidth * dstHeight);
+    auto dst = _imageScratch.data();
+    for (size_t dy = 0; dy < dstHeight; ++dy)
+    {
+        const auto srcRow = srcPixels.data() + dy * srcHeight / dstHeight * srcWidth;
+        for (size_t dx = 0; dx < dstWidth; ++dx)
+        {
+            *dst++ = std::bit_cast<u32>(srcRow[dx * srcWidth / dstScale]);
+        }
+    }
+
+    const auto top = gsl::narrow_cast<UINT>(lru * cellSize.y);
+    const D3D11_BOX box{ 0, top, 0, gsl::narrow_cast<UINT>(dstWidth), top + cellSize.y, 1 };
+    p.deviceContext->UpdateSubresource(_imageAtlas.get(), 0, &box, _imageScratch.data(), gsl::narrow_cast<UINT>(dstWidth * sizeof(u32)), 0);
+    p.stats.bytesUploaded += _imageScratch.size() * sizeof(u32);
+
+    _imageAtlasSlots[lru] = { revision, _imageAtlasFrame, shift };
+    return gsl::narrow_cast<u16>(lru);
+}
+
 #if ATLAS_DEBUG_SHOW_DIRTY
 void BackendD3D::_debugShowDirty(const RenderingPayload& p)
 {
@@ -2104,8 +2628,30 @@ void BackendD3D::_debugDumpRenderTarget(const RenderingPayload& p)
 }
 #endif
 
-void BackendD3D::_executeCustomShader(RenderingPayload& p)
+void BackendD3D::_executeCustomShader(RenderingPayload& p, const bool partialRedraw)
 {
+    D3D11_RECT rect{ 0, 0, p.s->targetSize.x, p.s->targetSize.y };
+
+    if (partialRedraw)
+    {
+        // Nothing changed: _present() will skip this frame anyway.
+        if (p.dirtyRectInPx.left >= p.dirtyRectInPx.right || p.dirtyRectInPx.top >= p.dirtyRectInPx.bottom)
+        {
+            return;
+        }
+
+        // Shaders like the built-in retro one blur the image. Extending the dirty rect by a cell
+        // in each direction ensures that the glow around text that changed gets updated as well.
+        const til::CoordType cellX = p.s->font->cellSize.x;
+        const til::CoordType cellY = p.s->font->cellSize.y;
+        rect = {
+            clamp<LONG>(p.dirtyRectInPx.left - cellX, 0, p.s->targetSize.x),
+            clamp<LONG>(p.dirtyRectInPx.top - cellY, 0, p.s->targetSize.y),
+            clamp<LONG>(p.dirtyRectInPx.right + cellX, 0, p.s->targetSize.x),
+            clamp<LONG>(p.dirtyRectInPx.bottom + cellY, 0, p.s->targetSize.y),
+        };
+    }
+
     {
         const CustomConstBuffer data{
             .time = std::chrono::duration<f32>(std::chrono::steady_clock::now() - _customShaderStartTime).count(),
@@ -2148,6 +2694,9 @@ void BackendD3D::_executeCustomShader(RenderingPayload& p)
         p.deviceContext->OMSetBlendState(nullptr, nullptr, 0xffffffff);
     }
 
+    // RS: Rasterizer Stage
+    p.deviceContext->RSSetScissorRects(1, &rect);
+
     p.deviceContext->Draw(4, 0);
 
     {
@@ -2165,10 +2714,10 @@ void BackendD3D::_executeCustomShader(RenderingPayload& p)
         p.deviceContext->VSSetConstantBuffers(0, 1, _vsConstantBuffer.addressof());
 
         // PS: Pixel Shader
-        ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get() };
+        ID3D11ShaderResourceView* resources[]{ _backgroundBitmapView.get(), _glyphAtlasView.get(), _imageAtlasView.get() };
         p.deviceContext->PSSetShader(_pixelShader.get(), nullptr, 0);
         p.deviceContext->PSSetConstantBuffers(0, 1, _psConstantBuffer.addressof());
-        p.deviceContext->PSSetShaderResources(0, 2, &resources[0]);
+        p.deviceContext->PSSetShaderResources(0, 3, &resources[0]);
         p.deviceContext->PSSetSamplers(0, 0, nullptr);
 
         // OM: Output Merger
@@ -2176,9 +2725,9 @@ void BackendD3D::_executeCustomShader(RenderingPayload& p)
         p.deviceContext->OMSetRenderTargets(1, _customRenderTargetView.addressof(), nullptr);
     }
 
-    // With custom shaders, everything might be invalidated, so we have to
-    // indirectly disable Present1() and its dirty rects this way.
-    p.dirtyRectInPx = { 0, 0, p.s->targetSize.x, p.s->targetSize.y };
+    // Unless the shader is limited to the dirty rect, everything might be invalidated,
+    // so we have to indirectly disable Present1() and its dirty rects this way.
+    p.dirtyRectInPx = { rect.left, rect.top, rect.right, rect.bottom };
 }
 
 TIL_FAST_MATH_END
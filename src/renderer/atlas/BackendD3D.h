@@ -18,6 +18,7 @@ namespace Microsoft::Console::Render::Atlas
         void ReleaseResources() noexcept override;
         void Render(RenderingPayload& payload) override;
         bool RequiresContinuousRedraw() noexcept override;
+        size_t GetGlyphAtlasMemoryUsage() const noexcept override;
 
         // NOTE: D3D constant buffers sizes must be a multiple of 16 bytes.
         struct alignas(16) VSConstBuffer
@@ -65,13 +66,18 @@ namespace Microsoft::Console::Render::Atlas
             TextGrayscale = 1,
             TextClearType = 2,
             TextPassthrough = 3,
-            DottedLine = 4,
-            DottedLineWide = 5,
+            // Box drawing and block element characters drawn by the pixel shader. See BuiltinGlyphs.h.
+            TextBuiltinGlyph = 4,
+            DottedLine = 5,
+            DottedLineWide = 6,
             // All items starting here will be drawing as a solid RGBA color
-            SolidLine = 6,
+            SolidLine = 7,
 
-            Cursor = 7,
-            Selection = 8,
+            Cursor = 8,
+            Selection = 9,
+
+            // Sixel images, which are read from the _imageAtlas. See _drawImages().
+            Image = 10,
 
             TextDrawingFirst = TextGrayscale,
             TextDrawingLast = SolidLine,
@@ -113,6 +119,7 @@ namespace Microsoft::Console::Render::Atlas
         {
             u16 glyphIndex;
             // All data in QuadInstance is u32-aligned anyways, so this simultaneously serves as padding.
+            // It's 1 for regular entries and 2 for entries whose atlas page got evicted by _evictGlyphAtlasPage().
             u16 _occupied;
 
             AtlasGlyphEntryData data;
@@ -133,6 +140,50 @@ namespace Microsoft::Console::Render::Atlas
                 _occupied = 1;
                 return *this;
             }
+
+            constexpr bool IsEvicted() const noexcept
+            {
+                return _occupied == 2;
+            }
+
+            constexpr void SetEvicted(bool evicted) noexcept
+            {
+                _occupied = evicted ? 2 : 1;
+            }
+        };
+
+        struct AtlasBuiltinGlyphEntry
+        {
+            u16 glyphIndex;
+            u16 _occupied;
+            u32 descriptor;
+
+            constexpr bool operator==(u16 key) const noexcept
+            {
+                return glyphIndex == key;
+            }
+
+            constexpr operator bool() const noexcept
+            {
+                return _occupied != 0;
+            }
+
+            constexpr AtlasBuiltinGlyphEntry& operator=(u16 key) noexcept
+            {
+                glyphIndex = key;
+                _occupied = 1;
+                return *this;
+            }
+        };
+
+        // The glyph atlas is split into horizontal pages with a rect packer each. When all of them are full,
+        // the least recently used one gets cleared, instead of throwing away the entire atlas.
+        struct GlyphAtlasPage
+        {
+            Buffer<stbrp_node> nodes;
+            stbrp_context packer{};
+            // The value of _glyphAtlasFrame when a glyph in this page was last drawn.
+            u32 lastUsed = 0;
         };
 
         // This exists so that we can look up a AtlasFontFaceEntry without AddRef()/Release()ing fontFace first.
@@ -150,17 +201,26 @@ namespace Microsoft::Console::Render::Atlas
             wil::com_ptr<IDWriteFontFace2> fontFace;
             LineRendition lineRendition = LineRendition::SingleWidth;
 
-            til::linear_flat_set<AtlasGlyphEntry> glyphs;
+            // This is the lookup that happens for every single glyph on every frame. A swiss_flat_set handles
+            // the scattered glyph indices of actual text better than linear probing and with less wasted memory.
+            til::swiss_flat_set<AtlasGlyphEntry> glyphs;
             // boxGlyphs gets an increased growth rate of 2^2 = 4x, because presumably fonts either contain very
             // few or almost all of the box glyphs. This reduces the cost of _initializeFontFaceEntry quite a bit.
             til::linear_flat_set<u16, 2, 2> boxGlyphs;
+            // The glyph indices of the box drawing and block element characters, which are drawn by the pixel
+            // shader instead of being rasterized into the glyph atlas. Only used for LineRendition::SingleWidth.
+            til::linear_flat_set<AtlasBuiltinGlyphEntry, 2, 2> builtinGlyphs;
+            // The glyph indices of the Powerline characters. TUIs tend to draw entire screens of
+            // them at once, so _prerasterizeGlyphs draws them all ahead of time after a font change.
+            std::vector<u16> prerasterizedGlyphs;
+            bool prerasterized = false;
         };
 
         struct AtlasFontFaceEntry
         {
             // This being a heap allocated allows us to insert into `glyphs` in `_splitDoubleHeightGlyph`
             // (which might resize the hashmap!), while the caller `_drawText` is holding onto `glyphs`.
-            // If it wasn't heap allocated, all pointers into `linear_flat_set` would be invalidated.
+            // If it wasn't heap allocated, all pointers into `swiss_flat_set` would be invalidated.
             std::unique_ptr<AtlasFontFaceEntryInner> inner;
 
             bool operator==(const AtlasFontFaceKey& key) const noexcept
@@ -195,10 +255,12 @@ namespace Microsoft::Console::Render::Atlas
 
         ATLAS_ATTR_COLD void _handleSettingsUpdate(const RenderingPayload& p);
         void _updateFontDependents(const RenderingPayload& p);
+        void _updateSoftFontDependents(const RenderingPayload& p);
         void _d2dRenderTargetUpdateFontSettings(const RenderingPayload& p) const noexcept;
         void _recreateCustomShader(const RenderingPayload& p);
         void _recreateCustomRenderTargetView(const RenderingPayload& p);
         void _recreateBackgroundColorBitmap(const RenderingPayload& p);
+        void _recreateImageAtlas(const RenderingPayload& p);
         void _recreateConstBuffer(const RenderingPayload& p) const;
         void _setupDeviceContextState(const RenderingPayload& p);
         void _debugUpdateShaders(const RenderingPayload& p) noexcept;
@@ -208,6 +270,9 @@ namespace Microsoft::Console::Render::Atlas
         void _d2dEndDrawing();
         ATLAS_ATTR_COLD void _resetGlyphAtlas(const RenderingPayload& p);
         ATLAS_ATTR_COLD void _resizeGlyphAtlas(const RenderingPayload& p, u16 u, u16 v);
+        void _initializeGlyphAtlasPage(GlyphAtlasPage& page) const noexcept;
+        [[nodiscard]] bool _allocateGlyphAtlasRect(const RenderingPayload& p, stbrp_rect& rect);
+        ATLAS_ATTR_COLD [[nodiscard]] bool _evictGlyphAtlasPage(stbrp_rect& rect);
         QuadInstance& _getLastQuad() noexcept;
         QuadInstance& _appendQuad();
         ATLAS_ATTR_COLD void _bumpInstancesSize();
@@ -215,11 +280,14 @@ namespace Microsoft::Console::Render::Atlas
         ATLAS_ATTR_COLD void _recreateInstanceBuffers(const RenderingPayload& p);
         void _drawBackground(const RenderingPayload& p);
         void _uploadBackgroundBitmap(const RenderingPayload& p);
+        bool _skipRow(const RenderingPayload& p, const ShapedRow& row) const noexcept;
         void _drawText(RenderingPayload& p);
         ATLAS_ATTR_COLD void _drawTextOverlapSplit(const RenderingPayload& p, u16 y);
         ATLAS_ATTR_COLD static void _initializeFontFaceEntry(AtlasFontFaceEntryInner& fontFaceEntry);
+        ATLAS_ATTR_COLD [[nodiscard]] bool _prerasterizeGlyphs(const RenderingPayload& p, AtlasFontFaceEntryInner& fontFaceEntry);
         ATLAS_ATTR_COLD [[nodiscard]] bool _drawGlyph(const RenderingPayload& p, const AtlasFontFaceEntryInner& fontFaceEntry, AtlasGlyphEntry& glyphEntry);
         bool _drawSoftFontGlyph(const RenderingPayload& p, const AtlasFontFaceEntryInner& fontFaceEntry, AtlasGlyphEntry& glyphEntry);
+        static void _drawBuiltinGlyph(const RenderingPayload& p, u32 descriptor, AtlasGlyphEntry& glyphEntry) noexcept;
         void _drawGlyphPrepareRetry(const RenderingPayload& p);
         void _splitDoubleHeightGlyph(const RenderingPayload& p, const AtlasFontFaceEntryInner& fontFaceEntry, AtlasGlyphEntry& glyphEntry);
         void _drawGridlines(const RenderingPayload& p, u16 y);
@@ -227,19 +295,25 @@ namespace Microsoft::Console::Render::Atlas
         ATLAS_ATTR_COLD void _drawCursorForeground();
         ATLAS_ATTR_COLD size_t _drawCursorForegroundSlowPath(const CursorRect& c, size_t offset);
         void _drawSelection(const RenderingPayload& p);
-        void _executeCustomShader(RenderingPayload& p);
+        void _drawImages(RenderingPayload& p);
+        u16 _uploadImageSlice(RenderingPayload& p, const ImageSlice& slice, u8 shift);
+        void _executeCustomShader(RenderingPayload& p, bool partialRedraw);
 
         wil::com_ptr<ID3D11RenderTargetView> _renderTargetView;
         wil::com_ptr<ID3D11InputLayout> _inputLayout;
         wil::com_ptr<ID3D11VertexShader> _vertexShader;
         wil::com_ptr<ID3D11PixelShader> _pixelShader;
         wil::com_ptr<ID3D11BlendState> _blendState;
+        wil::com_ptr<ID3D11RasterizerState> _rasterizerState;
         wil::com_ptr<ID3D11Buffer> _vsConstantBuffer;
         wil::com_ptr<ID3D11Buffer> _psConstantBuffer;
         wil::com_ptr<ID3D11Buffer> _vertexBuffer;
         wil::com_ptr<ID3D11Buffer> _indexBuffer;
         wil::com_ptr<ID3D11Buffer> _instanceBuffer;
         size_t _instanceBufferCapacity = 0;
+        // The _instanceBuffer is used as a ring buffer: Each _flushQuads() call appends to it with
+        // D3D11_MAP_WRITE_NO_OVERWRITE and only wraps around with D3D11_MAP_WRITE_DISCARD when it's full.
+        size_t _instanceBufferOffset = 0;
         Buffer<QuadInstance, 32> _instances;
         size_t _instancesCount = 0;
 
@@ -251,6 +325,10 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<ID3D11Buffer> _customShaderConstantBuffer;
         wil::com_ptr<ID3D11SamplerState> _customShaderSamplerState;
         std::chrono::steady_clock::time_point _customShaderStartTime;
+        // Set if the custom shader may be limited to the dirty rect. See Render().
+        bool _customShaderPartialRedraw = false;
+        // Set when _customOffscreenTexture was (re)created and its contents are undefined.
+        bool _customShaderNeedsFullRedraw = false;
 
         wil::com_ptr<ID3D11Texture2D> _backgroundBitmap;
         wil::com_ptr<ID3D11ShaderResourceView> _backgroundBitmapView;
@@ -259,8 +337,30 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<ID3D11Texture2D> _glyphAtlas;
         wil::com_ptr<ID3D11ShaderResourceView> _glyphAtlasView;
         til::linear_flat_set<AtlasFontFaceEntry> _glyphAtlasMap;
-        Buffer<stbrp_node> _rectPackerData;
-        stbrp_context _rectPacker{};
+        std::array<GlyphAtlasPage, 8> _glyphAtlasPages;
+        u16x2 _glyphAtlasSize{};
+        u16 _glyphAtlasPageCount = 0;
+        u16 _glyphAtlasPageHeight = 0;
+        u8 _glyphAtlasPageShift = 0;
+        u8 _glyphAtlasPageCurrent = 0;
+        // Set if a glyph didn't fit into a single page. The next _resetGlyphAtlas() will then use only 1 page.
+        bool _glyphAtlasSinglePage = false;
+        u32 _glyphAtlasFrame = 0;
+
+        // The image atlas is split up into rows of cellSize.y pixels, each of which caches one ImageSlice
+        // that's been scaled to the current cell size, because that's all the GPU needs to draw it.
+        struct ImageAtlasSlot
+        {
+            u64 revision = 0;
+            u32 lastUsed = 0;
+            u8 shift = 0;
+        };
+        wil::com_ptr<ID3D11Texture2D> _imageAtlas;
+        wil::com_ptr<ID3D11ShaderResourceView> _imageAtlasView;
+        std::vector<ImageAtlasSlot> _imageAtlasSlots;
+        std::vector<u32> _imageScratch;
+        u16 _imageAtlasWidth = 0;
+        u32 _imageAtlasFrame = 0;
         til::CoordType _ligatureOverhangTriggerLeft = 0;
         til::CoordType _ligatureOverhangTriggerRight = 0;
 
@@ -269,6 +369,10 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<ID2D1SolidColorBrush> _emojiBrush;
         wil::com_ptr<ID2D1SolidColorBrush> _brush;
         wil::com_ptr<ID2D1Bitmap1> _softFontBitmap;
+        // A copy of the soft font that the glyphs in the atlas were drawn with. It's used to figure out
+        // which glyphs changed when the soft font is redefined, so that only those get redrawn.
+        std::vector<uint16_t> _softFontPattern;
+        til::size _softFontCellSize;
         bool _d2dBeganDrawing = false;
         bool _fontChangedResetGlyphAtlas = false;
 
@@ -279,9 +383,12 @@ namespace Microsoft::Console::Render::Atlas
 
         til::generation_t _generation;
         til::generation_t _fontGeneration;
+        til::generation_t _softFontGeneration;
         til::generation_t _miscGeneration;
         u16x2 _targetSize{};
         u16x2 _viewportCellCount{};
+        D3D11_RECT _scissorRect{};
+        bool _skipCleanRows = false;
         ShadingType _textShadingType = ShadingType::Default;
 
         // An empty-box cursor spanning a wide glyph that has different
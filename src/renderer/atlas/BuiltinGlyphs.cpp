@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "BuiltinGlyphs.h"
+
+using namespace Microsoft::Console::Render::Atlas;
+using namespace Microsoft::Console::Render::Atlas::BuiltinGlyphs;
+
+namespace
+{
+    constexpr u32 _ = static_cast<u32>(Weight::None);
+    constexpr u32 l = static_cast<u32>(Weight::Light);
+    constexpr u32 h = static_cast<u32>(Weight::Heavy);
+    constexpr u32 d = static_cast<u32>(Weight::Double);
+
+    constexpr u32 lines(u32 left, u32 up, u32 right, u32 down, u32 dashes = 0) noexcept
+    {
+        return static_cast<u32>(Kind::Lines) | left << 4 | up << 6 | right << 8 | down << 10 | dashes << 12;
+    }
+
+    constexpr u32 arc(bool right, bool down) noexcept
+    {
+        return static_cast<u32>(Kind::Arc) | u32{ right } << 4 | u32{ down } << 5;
+    }
+
+    constexpr u32 diagonal(bool rising, bool falling) noexcept
+    {
+        return static_cast<u32>(Kind::Diagonal) | u32{ rising } << 4 | u32{ falling } << 5;
+    }
+
+    constexpr u32 rect(u32 left, u32 top, u32 right, u32 bottom) noexcept
+    {
+        return static_cast<u32>(Kind::Rect) | left << 4 | top << 8 | right << 12 | bottom << 16;
+    }
+
+    constexpr u32 quadrants(bool topLeft, bool topRight, bool bottomLeft, bool bottomRight) noexcept
+    {
+        return static_cast<u32>(Kind::Quadrants) | u32{ topLeft } << 4 | u32{ topRight } << 5 | u32{ bottomLeft } << 6 | u32{ bottomRight } << 7;
+    }
+
+    constexpr u32 shade(u32 quarters) noexcept
+    {
+        return static_cast<u32>(Kind::Shade) | quarters << 4;
+    }
+
+    // The arguments of lines() are in the order left, up, right, down.
+    constexpr u32 boxDrawing[0x80]{
+        lines(l, _, l, _), // U+2500 ─
+        lines(h, _, h, _), // U+2501 ━
+        lines(_, l, _, l), // U+2502 │
+        lines(_, h, _, h), // U+2503 ┃
+        lines(l, _, l, _, 3), // U+2504 ┄
+        lines(h, _, h, _, 3), // U+2505 ┅
+        lines(_, l, _, l, 3), // U+2506 ┆
+        lines(_, h, _, h, 3), // U+2507 ┇
+        lines(l, _, l, _, 4), // U+2508 ┈
+        lines(h, _, h, _, 4), // U+2509 ┉
+        lines(_, l, _, l, 4), // U+250A ┊
+        lines(_, h, _, h, 4), // U+250B ┋
+        lines(_, _, l, l), // U+250C ┌
+        lines(_, _, h, l), // U+250D ┍
+        lines(_, _, l, h), // U+250E ┎
+        lines(_, _, h, h), // U+250F ┏
+        lines(l, _, _, l), // U+2510 ┐
+        lines(h, _, _, l), // U+2511 ┑
+        lines(l, _, _, h), // U+2512 ┒
+        lines(h, _, _, h), // U+2513 ┓
+        lines(_, l, l, _), // U+2514 └
+        lines(_, l, h, _), // U+2515 ┕
+        lines(_, h, l, _), // U+2516 ┖
+        lines(_, h, h, _), // U+2517 ┗
+        lines(l, l, _, _), // U+2518 ┘
+        lines(h, l, _, _), // U+2519 ┙
+        lines(l, h, _, _), // U+251A ┚
+        lines(h, h, _, _), // U+251B ┛
+        lines(_, l, l, l), // U+251C ├
+        lines(_, l, h, l), // U+251D ┝
+        lines(_, h, l, l), // U+251E ┞
+        lines(_, l, l, h), // U+251F ┟
+        lines(_, h, l, h), // U+2520 ┠
+        lines(_, h, h, l), // U+2521 ┡
+        lines(_, l, h, h), // U+2522 ┢
+        lines(_, h, h, h), // U+2523 ┣
+        lines(l, l, _, l), // U+2524 ┤
+        lines(h, l, _, l), // U+2525 ┥
+        lines(l, h, _, l), // U+2526 ┦
+        lines(l, l, _, h), // U+2527 ┧
+        lines(l, h, _, h), // U+2528 ┨
+        lines(h, h, _, l), // U+2529 ┩
+        lines(h, l, _, h), // U+252A ┪
+        lines(h, h, _, h), // U+252B ┫
+        lines(l, _, l, l), // U+252C ┬
+        lines(h, _, l, l), // U+252D ┭
+        lines(l, _, h, l), // U+252E ┮
+        lines(h, _, h, l), // U+252F ┯
+        lines(l, _, l, h), // U+2530 ┰
+        lines(h, _, l, h), // U+2531 ┱
+        lines(l, _, h, h), // U+2532 ┲
+        lines(h, _, h, h), // U+2533 ┳
+        lines(l, l, l, _), // U+2534 ┴
+        lines(h, l, l, _), // U+2535 ┵
+        lines(l, l, h, _), // U+2536 ┶
+        lines(h, l, h, _), // U+2537 ┷
+        lines(l, h, l, _), // U+2538 ┸
+        lines(h, h, l, _), // U+2539 ┹
+        lines(l, h, h, _), // U+253A ┺
+        lines(h, h, h, _), // U+253B ┻
+        lines(l, l, l, l), // U+253C ┼
+        lines(h, l, l, l), // U+253D ┽
+        lines(l, l, h, l), // U+253E ┾
+        lines(h, l, h, l), // U+253F ┿
+        lines(l, h, l, l), // U+2540 ╀
+        lines(l, l, l, h), // U+2541 ╁
+        lines(l, h, l, h), // U+2542 ╂
+        lines(h, h, l, l), // U+2543 ╃
+        lines(l, h, h, l), // U+2544 ╄
+        lines(h, l, l, h), // U+2545 ╅
+        lines(l, l, h, h), // U+2546 ╆
+        lines(h, h, h, l), // U+2547 ╇
+        lines(h, l, h, h), // U+2548 ╈
+        lines(h, h, l, h), // U+2549 ╉
+        lines(l, h, h, h), // U+254A ╊
+        lines(h, h, h, h), // U+254B ╋
+        lines(l, _, l, _, 2), // U+254C ╌
+        lines(h, _, h, _, 2), // U+254D ╍
+        lines(_, l, _, l, 2), // U+254E ╎
+        lines(_, h, _, h, 2), // U+254F ╏
+        lines(d, _, d, _), // U+2550 ═
+        lines(_, d, _, d), // U+2551 ║
+        lines(_, _, d, l), // U+2552 ╒
+        lines(_, _, l, d), // U+2553 ╓
+        lines(_, _, d, d), // U+2554 ╔
+        lines(d, _, _, l), // U+2555 ╕
+        lines(l, _, _, d), // U+2556 ╖
+        lines(d, _, _, d), // U+2557 ╗
+        lines(_, l, d, _), // U+2558 ╘
+        lines(_, d, l, _), // U+2559 ╙
+        lines(_, d, d, _), // U+255A ╚
+        lines(d, l, _, _), // U+255B ╛
+        lines(l, d, _, _), // U+255C ╜
+        lines(d, d, _, _), // U+255D ╝
+        lines(_, l, d, l), // U+255E ╞
+        lines(_, d, l, d), // U+255F ╟
+        lines(_, d, d, d), // U+2560 ╠
+        lines(d, l, _, l), // U+2561 ╡
+        lines(l, d, _, d), // U+2562 ╢
+        lines(d, d, _, d), // U+2563 ╣
+        lines(d, _, d, l), // U+2564 ╤
+        lines(l, _, l, d), // U+2565 ╥
+        lines(d, _, d, d), // U+2566 ╦
+        lines(d, l, d, _), // U+2567 ╧
+        lines(l, d, l, _), // U+2568 ╨
+        lines(d, d, d, _), // U+2569 ╩
+        lines(d, l, d, l), // U+256A ╪
+        lines(l, d, l, d), // U+256B ╫
+        lines(d, d, d, d), // U+256C ╬
+        arc(true, true), // U+256D ╭
+        arc(false, true), // U+256E ╮
+        arc(false, false), // U+256F ╯
+        arc(true, false), // U+2570 ╰
+        diagonal(true, false), // U+2571 ╱
+        diagonal(false, true), // U+2572 ╲
+        diagonal(true, true), // U+2573 ╳
+        lines(l, _, _, _), // U+2574 ╴
+        lines(_, l, _, _), // U+2575 ╵
+        lines(_, _, l, _), // U+2576 ╶
+        lines(_, _, _, l), // U+2577 ╷
+        lines(h, _, _, _), // U+2578 ╸
+        lines(_, h, _, _), // U+2579 ╹
+        lines(_, _, h, _), // U+257A ╺
+        lines(_, _, _, h), // U+257B ╻
+        lines(l, _, h, _), // U+257C ╼
+        lines(_, l, _, h), // U+257D ╽
+        lines(h, _, l, _), // U+257E ╾
+        lines(_, h, _, l), // U+257F ╿
+    };
+
+    constexpr u32 blockElements[0x20]{
+        rect(0, 0, 8, 4), // U+2580 ▀
+        rect(0, 7, 8, 8), // U+2581 ▁
+        rect(0, 6, 8, 8), // U+2582 ▂
+        rect(0, 5, 8, 8), // U+2583 ▃
+        rect(0, 4, 8, 8), // U+2584 ▄
+        rect(0, 3, 8, 8), // U+2585 ▅
+        rect(0, 2, 8, 8), // U+2586 ▆
+        rect(0, 1, 8, 8), // U+2587 ▇
+        rect(0, 0, 8, 8), // U+2588 █
+        rect(0, 0, 7, 8), // U+2589 ▉
+        rect(0, 0, 6, 8), // U+258A ▊
+        rect(0, 0, 5, 8), // U+258B ▋
+        rect(0, 0, 4, 8), // U+258C ▌
+        rect(0, 0, 3, 8), // U+258D ▍
+        rect(0, 0, 2, 8), // U+258E ▎
+        rect(0, 0, 1, 8), // U+258F ▏
+        rect(4, 0, 8, 8), // U+2590 ▐
+        shade(1), // U+2591 ░
+        shade(2), // U+2592 ▒
+        shade(3), // U+2593 ▓
+        rect(0, 0, 8, 1), // U+2594 ▔
+        rect(7, 0, 8, 8), // U+2595 ▕
+        quadrants(false, false, true, false), // U+2596 ▖
+        quadrants(false, false, false, true), // U+2597 ▗
+        quadrants(true, false, false, false), // U+2598 ▘
+        quadrants(true, false, true, true), // U+2599 ▙
+        quadrants(true, false, false, true), // U+259A ▚
+        quadrants(true, true, true, false), // U+259B ▛
+        quadrants(true, true, false, true), // U+259C ▜
+        quadrants(false, true, false, false), // U+259D ▝
+        quadrants(false, true, true, false), // U+259E ▞
+        quadrants(false, true, true, true), // U+259F ▟
+    };
+}
+
+u32 BuiltinGlyphs::GetDescriptor(u32 codepoint) noexcept
+{
+    const auto offset = codepoint - 0x2500;
+    if (offset < std::size(boxDrawing))
+    {
+        return boxDrawing[offset];
+    }
+    if (offset - std::size(boxDrawing) < std::size(blockElements))
+    {
+        return blockElements[offset - std::size(boxDrawing)];
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "common.h"
+
+namespace Microsoft::Console::Render::Atlas::BuiltinGlyphs
+{
+    // The box drawing (U+2500-257F) and block element (U+2580-259F) characters can be drawn by shader_ps.hlsl
+    // without involving the glyph atlas, because they're just lines and rectangles. Their shape is described
+    // by a 32-bit descriptor, which is passed to the shader via QuadInstance::texcoord. Its lowest 4 bits
+    // are the Kind and the meaning of the remaining bits depends on it. This must be kept in sync with
+    // builtin_glyphs.hlsl.
+    enum class Kind : u32
+    {
+        None = 0,
+        // Bits 4-11 are the weight of the left, up, right and down arms (2 bits each, see Weight).
+        // Bits 12-14 are the number of dashes the line is split into (0 for solid lines).
+        Lines = 1,
+        // Bit 4 is set if the arc connects to the right (otherwise left), bit 5 if it connects downwards (otherwise up).
+        Arc = 2,
+        // Bit 4 draws a line from the top right to the bottom left corner, bit 5 from the top left to the bottom right.
+        Diagonal = 3,
+        // Bits 4-7, 8-11, 12-15, 16-19 are the left, top, right and bottom edges in eighths of the cell.
+        Rect = 4,
+        // Bits 4-7 fill the top left, top right, bottom left and bottom right quadrant.
+        Quadrants = 5,
+        // Bits 4-5 are the density of the shade in quarters (1-3).
+        Shade = 6,
+    };
+
+    enum class Weight : u32
+    {
+        None = 0,
+        Light = 1,
+        Heavy = 2,
+        Double = 3,
+    };
+
+    // Returns the descriptor for the given codepoint or 0 if it's not a builtin glyph.
+    u32 GetDescriptor(u32 codepoint) noexcept;
+}
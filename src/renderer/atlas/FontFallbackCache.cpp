@@ -0,0 +1,331 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "FontFallbackCache.h"
+
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+
+using namespace Microsoft::Console::Render::Atlas;
+
+// Each cache gets cleared once it reaches this many entries, which puts an upper limit on its memory usage.
+// The BMP contains ~30k CJK and Hangul code points, so this should rarely happen.
+static constexpr size_t maxEntriesPerCache = 65536;
+
+namespace
+{
+    struct CodepointRange
+    {
+        u32 first;
+        u32 last;
+    };
+
+    // Code points whose fallback font only depends on font coverage and not on the surrounding text.
+    // Characters of the "Common" script like spaces, punctuation or digits are notably absent, because
+    // MapCharacters() assigns them to the font of the preceding characters. Sorted by .first.
+    constexpr CodepointRange cacheableRanges[]{
+        { 0x1100, 0x11FF }, // Hangul Jamo
+        { 0x2E80, 0x2FDF }, // CJK Radicals Supplement, Kangxi Radicals
+        { 0x3041, 0x3098 }, // Hiragana (excluding the combining voiced sound marks)
+        { 0x309D, 0x30FF }, // Hiragana, Katakana
+        { 0x3105, 0x312F }, // Bopomofo
+        { 0x3131, 0x318E }, // Hangul Compatibility Jamo
+        { 0x31F0, 0x31FF }, // Katakana Phonetic Extensions
+        { 0x3400, 0x4DBF }, // CJK Unified Ideographs Extension A
+        { 0x4E00, 0x9FFF }, // CJK Unified Ideographs
+        { 0xA960, 0xA97F }, // Hangul Jamo Extended-A
+        { 0xAC00, 0xD7FF }, // Hangul Syllables, Hangul Jamo Extended-B
+        { 0xE000, 0xF8FF }, // Private Use Area
+        { 0xF900, 0xFAFF }, // CJK Compatibility Ideographs
+        { 0x1F300, 0x1F3FA }, // Miscellaneous Symbols and Pictographs (excluding the skin tone modifiers)
+        { 0x1F400, 0x1F64F }, // Miscellaneous Symbols and Pictographs, Emoticons
+        { 0x1F680, 0x1F6FF }, // Transport and Map Symbols
+        { 0x1F900, 0x1F9FF }, // Supplemental Symbols and Pictographs
+        { 0x1FA70, 0x1FAFF }, // Symbols and Pictographs Extended-A
+        { 0x20000, 0x3FFFF }, // CJK Unified Ideographs Extension B and later
+        { 0xF0000, 0x10FFFD }, // Supplementary Private Use Area-A and -B
+    };
+
+    bool isCacheable(u32 cp) noexcept
+    {
+        for (const auto& r : cacheableRanges)
+        {
+            if (cp < r.first)
+            {
+                return false;
+            }
+            if (cp <= r.last)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Code points that modify the preceding one, which MapCharacters() must see together with it.
+    // Splitting them from their base character would for instance break up emoji ZWJ sequences.
+    bool modifiesPrevious(u32 cp) noexcept
+    {
+        return (cp >= 0x0300 && cp <= 0x036F) || // Combining Diacritical Marks
+               (cp >= 0x1AB0 && cp <= 0x1AFF) || // Combining Diacritical Marks Extended
+               (cp >= 0x1DC0 && cp <= 0x1DFF) || // Combining Diacritical Marks Supplement
+               (cp >= 0x200C && cp <= 0x200D) || // ZWNJ, ZWJ
+               (cp >= 0x20D0 && cp <= 0x20FF) || // Combining Diacritical Marks for Symbols
+               (cp >= 0x3099 && cp <= 0x309A) || // Combining Katakana-Hiragana Voiced Sound Marks
+               (cp >= 0xFE00 && cp <= 0xFE0F) || // Variation Selectors
+               (cp >= 0xFE20 && cp <= 0xFE2F) || // Combining Half Marks
+               (cp >= 0x1F3FB && cp <= 0x1F3FF) || // Emoji Modifiers
+               (cp >= 0xE0000 && cp <= 0xE0FFF); // Tags, Variation Selectors Supplement
+    }
+
+    // Decodes the code point at text[i] and returns the number of UTF-16 code units it consists of,
+    // or 0 for unpaired surrogates, which are treated as not cacheable.
+    u32 decode(const wchar_t* text, u32 textLength, u32 i, u32& cp) noexcept
+    {
+        const u32 c = text[i];
+        if ((c & 0xF800) != 0xD800)
+        {
+            cp = c;
+            return 1;
+        }
+        if (c <= 0xDBFF && i + 1 < textLength && (text[i + 1] & 0xFC00) == 0xDC00)
+        {
+            cp = (c << 10) + text[i + 1] - 0x35FDC00;
+            return 2;
+        }
+        cp = 0;
+        return 0;
+    }
+
+    // Returns the length of the prefix of text[0, limit) that consists of cacheable code points,
+    // excluding the last one if it's followed by a code point that modifies it.
+    // If accept is given, the prefix additionally ends before the first code point it returns false for.
+    template<typename Accept>
+    u32 cacheablePrefix(const wchar_t* text, u32 textLength, u32 limit, Accept&& accept) noexcept
+    {
+        u32 end = 0;
+
+        for (u32 i = 0, cp = 0, n = 0; i < limit; i += n)
+        {
+            n = decode(text, textLength, i, cp);
+            if (!n || i + n > limit || !isCacheable(cp) || !accept(cp))
+            {
+                break;
+            }
+
+            // The next code point may be past the limit. We still need to check it, because that's how
+            // Lookup() and Insert() return identical results, even if the mappedLength ends between them.
+            u32 next = 0;
+            if (i + n < textLength && decode(text, textLength, i + n, next) && modifiesPrevious(next))
+            {
+                break;
+            }
+
+            end = i + n;
+        }
+
+        return end;
+    }
+}
+
+struct Microsoft::Console::Render::Atlas::FontFallbackCacheRegistry
+{
+    static FontFallbackCacheRegistry& Instance()
+    {
+        static FontFallbackCacheRegistry instance;
+        return instance;
+    }
+
+    std::shared_ptr<FontFallbackCache> Get(IDWriteFactory2* factory, const FontFallbackCache::Key& key)
+    {
+        const auto guard = _state.lock();
+
+        if (!guard->factory)
+        {
+            guard->factory = factory;
+            _refreshExpirationEvent(*guard);
+        }
+
+        auto& caches = guard->caches;
+
+        // Caches that no AtlasEngine uses anymore are dropped, which will naturally also drop caches for stale font collections.
+        std::erase_if(caches, [](const auto& c) { return c.use_count() == 1; });
+
+        for (const auto& c : caches)
+        {
+            if (c->_matches(key))
+            {
+                return c;
+            }
+        }
+
+        return caches.emplace_back(std::make_shared<FontFallbackCache>(key));
+    }
+
+    void Validate() noexcept
+    {
+        // This is called once per frame, so it should be cheap if nothing happened.
+        const auto event = _expirationEvent.load(std::memory_order_relaxed);
+        if (!event || WaitForSingleObject(event, 0) != WAIT_OBJECT_0)
+        {
+            return;
+        }
+
+        const auto guard = _state.lock();
+
+        // Someone else might have handled it in the meantime.
+        if (_expirationEvent.load(std::memory_order_relaxed) != event)
+        {
+            return;
+        }
+
+        for (const auto& c : guard->caches)
+        {
+            c->_clear();
+        }
+
+        _refreshExpirationEvent(*guard);
+    }
+
+private:
+    struct State
+    {
+        wil::com_ptr<IDWriteFactory2> factory;
+        // The expiration event is owned by this collection.
+        wil::com_ptr<IDWriteFontCollection3> systemFontCollection;
+        std::vector<std::shared_ptr<FontFallbackCache>> caches;
+    };
+
+    // IDWriteFontCollection3::GetExpirationEvent() returns an event that's signaled once fonts get
+    // installed or uninstalled and the collection is out of date. To get a new event, we need a new collection.
+    void _refreshExpirationEvent(State& state) noexcept
+    {
+        state.systemFontCollection.reset();
+        _expirationEvent.store(nullptr, std::memory_order_relaxed);
+
+        // IDWriteFactory3 and IDWriteFontCollection3 are supported since Windows 10, build 16299 and 17763 respectively.
+        // If they're unsupported we'll never clear our caches, same as before caching was introduced.
+        const auto factory3 = state.factory.try_query<IDWriteFactory3>();
+        if (!factory3)
+        {
+            return;
+        }
+
+        wil::com_ptr<IDWriteFontCollection1> collection;
+        if (FAILED_LOG(factory3->GetSystemFontCollection(FALSE, collection.addressof(), TRUE)))
+        {
+            return;
+        }
+
+        state.systemFontCollection = collection.try_query<IDWriteFontCollection3>();
+        if (state.systemFontCollection)
+        {
+            _expirationEvent.store(state.systemFontCollection->GetExpirationEvent(), std::memory_order_relaxed);
+        }
+    }
+
+    til::shared_mutex<State> _state;
+    std::atomic<HANDLE> _expirationEvent{ nullptr };
+};
+
+std::shared_ptr<FontFallbackCache> FontFallbackCache::Get(IDWriteFactory2* factory, const Key& key)
+{
+    return FontFallbackCacheRegistry::Instance().Get(factory, key);
+}
+
+void FontFallbackCache::Validate() noexcept
+{
+    FontFallbackCacheRegistry::Instance().Validate();
+}
+
+FontFallbackCache::FontFallbackCache(const Key& key) :
+    _fontCollection{ key.fontCollection },
+    _fontName{ key.fontName },
+    _localeName{ key.localeName },
+    _weight{ key.weight },
+    _style{ key.style },
+    _axes{ key.axes.begin(), key.axes.end() }
+{
+}
+
+u32 FontFallbackCache::Lookup(const wchar_t* text, u32 textLength, IDWriteFontFace2** fontFace) const
+{
+    // Most text is covered by the primary font and not cacheable. This avoids acquiring the lock for it.
+    if (u32 cp = 0; !textLength || !decode(text, textLength, 0, cp) || !isCacheable(cp))
+    {
+        return 0;
+    }
+
+    const auto guard = _faces.lock_shared();
+    const auto& faces = *guard;
+
+    if (faces.empty())
+    {
+        return 0;
+    }
+
+    IDWriteFontFace2* runFace = nullptr;
+    auto first = true;
+
+    const auto length = cacheablePrefix(text, textLength, textLength, [&](u32 cp) {
+        const auto it = faces.find(cp);
+        if (it == faces.end())
+        {
+            return false;
+        }
+        if (first)
+        {
+            runFace = it->second.get();
+            first = false;
+        }
+        return it->second.get() == runFace;
+    });
+
+    if (length)
+    {
+        wil::com_ptr<IDWriteFontFace2>{ runFace }.copy_to(fontFace);
+    }
+    return length;
+}
+
+u32 FontFallbackCache::Insert(const wchar_t* text, u32 textLength, u32 mappedLength, IDWriteFontFace2* fontFace)
+{
+    const auto length = cacheablePrefix(text, textLength, mappedLength, [](u32) { return true; });
+    if (!length)
+    {
+        return mappedLength;
+    }
+
+    const auto guard = _faces.lock();
+    auto& faces = *guard;
+
+    if (faces.size() >= maxEntriesPerCache)
+    {
+        faces.clear();
+    }
+
+    for (u32 i = 0, cp = 0, n = 0; i < length; i += n)
+    {
+        n = decode(text, textLength, i, cp);
+        faces.insert_or_assign(cp, fontFace);
+    }
+
+    return length;
+}
+
+bool FontFallbackCache::_matches(const Key& key) const noexcept
+{
+    return _fontCollection.get() == key.fontCollection &&
+           _fontName == key.fontName &&
+           _localeName == key.localeName &&
+           _weight == key.weight &&
+           _style == key.style &&
+           std::equal(_axes.begin(), _axes.end(), key.axes.begin(), key.axes.end(), [](const auto& a, const auto& b) {
+               return a.axisTag == b.axisTag && a.value == b.value;
+           });
+}
+
+void FontFallbackCache::_clear() noexcept
+{
+    _faces.lock()->clear();
+}
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <til/mutex.h>
+
+#include "common.h"
+
+namespace Microsoft::Console::Render::Atlas
+{
+    // IDWriteFontFallback::MapCharacters() is slow and gets called for every run of text that the
+    // primary font doesn't cover, every time a row gets invalidated, in every pane. This caches its results
+    // per code point for a specific base font and locale, including code points no font covers at all.
+    //
+    // Since MapCharacters() considers the surrounding text, only code points are cached whose fallback font
+    // only depends on coverage (CJK, Hangul, Kana, emoji and private use characters like Nerd Font icons).
+    // To return identical results no matter whether the cache is warm or cold, FontFallbackCache::Insert()
+    // truncates the results of MapCharacters() to what FontFallbackCache::Lookup() would return.
+    //
+    // Instances are shared by all AtlasEngine instances in the process that use the same base font,
+    // which works because they all share the same IDWriteFontCollection from the shared IDWriteFactory.
+    // All of them are cleared when the system font collection changes, see Validate().
+    struct FontFallbackCache
+    {
+        struct Key
+        {
+            IDWriteFontCollection* fontCollection;
+            std::wstring_view fontName;
+            std::wstring_view localeName;
+            DWRITE_FONT_WEIGHT weight;
+            DWRITE_FONT_STYLE style;
+            std::span<const DWRITE_FONT_AXIS_VALUE> axes;
+        };
+
+        // Returns the shared cache for the given base font, creating it if needed.
+        static std::shared_ptr<FontFallbackCache> Get(IDWriteFactory2* factory, const Key& key);
+        // Clears all caches if fonts have been installed or uninstalled since the last call.
+        static void Validate() noexcept;
+
+        // Returns the length of the run at the start of text, whose font face is known, or 0 if there's none.
+        // fontFace is set to the font face or to nullptr, if no font covers the run.
+        u32 Lookup(const wchar_t* text, u32 textLength, IDWriteFontFace2** fontFace) const;
+        // Caches the result of a MapCharacters() call for text and returns the mappedLength to use.
+        u32 Insert(const wchar_t* text, u32 textLength, u32 mappedLength, IDWriteFontFace2* fontFace);
+
+        // Only for use by Get(). Use Get() instead.
+        FontFallbackCache(const Key& key);
+
+    private:
+        friend struct FontFallbackCacheRegistry;
+
+        bool _matches(const Key& key) const noexcept;
+        void _clear() noexcept;
+
+        wil::com_ptr<IDWriteFontCollection> _fontCollection;
+        std::wstring _fontName;
+        std::wstring _localeName;
+        DWRITE_FONT_WEIGHT _weight;
+        DWRITE_FONT_STYLE _style;
+        std::vector<DWRITE_FONT_AXIS_VALUE> _axes;
+        // A nullptr font face marks code points that no font covers.
+        til::shared_mutex<std::unordered_map<u32, wil::com_ptr<IDWriteFontFace2>>> _faces;
+    };
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Procedural rendering of the box drawing and block element characters.
+// The descriptor format is documented in BuiltinGlyphs.h and must be kept in sync with it.
+
+// clang-format off
+#define BUILTIN_GLYPH_LINES         1
+#define BUILTIN_GLYPH_ARC           2
+#define BUILTIN_GLYPH_DIAGONAL      3
+#define BUILTIN_GLYPH_RECT          4
+#define BUILTIN_GLYPH_QUADRANTS     5
+#define BUILTIN_GLYPH_SHADE         6
+
+#define BUILTIN_GLYPH_WEIGHT_HEAVY  2
+#define BUILTIN_GLYPH_WEIGHT_DOUBLE 3
+// clang-format on
+
+// The width of a line with the given weight. Heavy lines are twice as thick as light ones and
+// double lines consist of two light ones with a gap of the same size in between them.
+int builtinGlyphLineWidth(uint weight, int thin)
+{
+    return weight == 0 ? 0 : weight == BUILTIN_GLYPH_WEIGHT_HEAVY ? 2 * thin : weight == BUILTIN_GLYPH_WEIGHT_DOUBLE ? 3 * thin : thin;
+}
+
+// Returns true if `v` is within the line of the given `width` centered on `center`.
+// All line positions are in whole pixels, which makes the result pixel-perfect at any cell size.
+bool builtinGlyphInLine(int v, int center, int width)
+{
+    const int start = center - width / 2;
+    return v >= start && v < start + width;
+}
+
+// Returns true if `v` is within one of the `dashes` dashes of a line that's `length` long.
+bool builtinGlyphInDash(int v, int length, uint dashes)
+{
+    const int i = v * int(dashes) / length;
+    const int start = i * length / int(dashes);
+    const int end = (i + 1) * length / int(dashes);
+    const int gap = max(1, (end - start) / 4);
+    return v >= start + gap / 2 && v < end - (gap - gap / 2);
+}
+
+// Returns the coverage of the builtin glyph at the given position in pixels.
+// `cellSize` is the size of the cell and `thin` the width of light lines in pixels.
+float builtinGlyphCoverage(uint descriptor, float2 position, float2 cellSize, int thin)
+{
+    const int2 size = int2(cellSize);
+    // The position within the cell. position is at the center of a pixel and so this is too.
+    const float2 local = position - floor(position / cellSize) * cellSize;
+    const int2 pixel = int2(local);
+    const int2 center = size / 2;
+
+    switch (descriptor & 0xf)
+    {
+    case BUILTIN_GLYPH_LINES:
+    {
+        const uint left = (descriptor >> 4) & 3;
+        const uint up = (descriptor >> 6) & 3;
+        const uint right = (descriptor >> 8) & 3;
+        const uint down = (descriptor >> 10) & 3;
+        const uint dashes = (descriptor >> 12) & 7;
+
+        // The horizontal and vertical extent of the vertical and horizontal lines respectively.
+        const int vWidth = max(builtinGlyphLineWidth(up, thin), builtinGlyphLineWidth(down, thin));
+        const int hWidth = max(builtinGlyphLineWidth(left, thin), builtinGlyphLineWidth(right, thin));
+        const int vx0 = center.x - vWidth / 2;
+        const int vx1 = vx0 + vWidth;
+        const int hy0 = center.y - hWidth / 2;
+        const int hy1 = hy0 + hWidth;
+        const bool hasV = vWidth != 0;
+        const bool hasH = hWidth != 0;
+
+        // The arms extend up to the far side of the perpendicular lines, so that corners and junctions are closed.
+        bool on = false;
+        on = on || (pixel.x < (hasV ? vx1 : center.x) && builtinGlyphInLine(pixel.y, center.y, builtinGlyphLineWidth(left, thin)));
+        on = on || (pixel.x >= (hasV ? vx0 : center.x) && builtinGlyphInLine(pixel.y, center.y, builtinGlyphLineWidth(right, thin)));
+        on = on || (pixel.y < (hasH ? hy1 : center.y) && builtinGlyphInLine(pixel.x, center.x, builtinGlyphLineWidth(up, thin)));
+        on = on || (pixel.y >= (hasH ? hy0 : center.y) && builtinGlyphInLine(pixel.x, center.x, builtinGlyphLineWidth(down, thin)));
+
+        // Double lines are drawn as if they were thick lines and then get the gap in their middle cut out.
+        // The gap ends at the gap of a perpendicular double line, or at the near side of a single one,
+        // which results in the inner and outer corners and junctions of double lines.
+        const bool vDouble = up == BUILTIN_GLYPH_WEIGHT_DOUBLE || down == BUILTIN_GLYPH_WEIGHT_DOUBLE;
+        const bool hDouble = left == BUILTIN_GLYPH_WEIGHT_DOUBLE || right == BUILTIN_GLYPH_WEIGHT_DOUBLE;
+        const bool inVGap = builtinGlyphInLine(pixel.x, center.x, thin);
+        const bool inHGap = builtinGlyphInLine(pixel.y, center.y, thin);
+        const int vg0 = center.x - thin / 2;
+        const int vg1 = vg0 + thin;
+        const int hg0 = center.y - thin / 2;
+        const int hg1 = hg0 + thin;
+
+        bool gap = false;
+        gap = gap || (left == BUILTIN_GLYPH_WEIGHT_DOUBLE && inHGap && pixel.x < (vDouble ? vg1 : hasV ? vx0 : center.x));
+        gap = gap || (right == BUILTIN_GLYPH_WEIGHT_DOUBLE && inHGap && pixel.x >= (vDouble ? vg0 : hasV ? vx1 : center.x));
+        gap = gap || (up == BUILTIN_GLYPH_WEIGHT_DOUBLE && inVGap && pixel.y < (hDouble ? hg1 : hasH ? hy0 : center.y));
+        gap = gap || (down == BUILTIN_GLYPH_WEIGHT_DOUBLE && inVGap && pixel.y >= (hDouble ? hg0 : hasH ? hy1 : center.y));
+
+        if (dashes != 0)
+        {
+            on = on && (hasH ? builtinGlyphInDash(pixel.x, size.x, dashes) : builtinGlyphInDash(pixel.y, size.y, dashes));
+        }
+
+        return on && !gap;
+    }
+    case BUILTIN_GLYPH_ARC:
+    {
+        // The arc is a quarter circle that connects the light lines in the center of the cell with the edges.
+        // Since cells aren't square, one of the two ends is continued with a straight line.
+        const float2 dir = float2((descriptor & 0x10) ? 1 : -1, (descriptor & 0x20) ? 1 : -1);
+        const float2 stroke = float2(center - thin / 2) + thin * 0.5f;
+        const float2 extent = dir > 0 ? cellSize - stroke : stroke;
+        const float radius = min(extent.x, extent.y);
+        const float2 rel = (local - (stroke + dir * radius)) * dir;
+
+        if (rel.x <= 0 && rel.y <= 0)
+        {
+            return saturate(thin * 0.5f + 0.5f - abs(length(rel) - radius));
+        }
+        if (rel.x > 0 && rel.y <= 0)
+        {
+            return builtinGlyphInLine(pixel.y, center.y, thin);
+        }
+        if (rel.x <= 0 && rel.y > 0)
+        {
+            return builtinGlyphInLine(pixel.x, center.x, thin);
+        }
+        return 0;
+    }
+    case BUILTIN_GLYPH_DIAGONAL:
+    {
+        // The distance to the diagonal lines through the cell corners. These are antialiased,
+        // because there's no way to make them look pixel-perfect for non-square cells anyways.
+        const float len = length(cellSize);
+        const float rising = abs(local.x * cellSize.y + local.y * cellSize.x - cellSize.x * cellSize.y) / len;
+        const float falling = abs(local.x * cellSize.y - local.y * cellSize.x) / len;
+        const float dist = min((descriptor & 0x10) ? rising : 1e9f, (descriptor & 0x20) ? falling : 1e9f);
+        return saturate(thin * 0.5f + 0.5f - dist);
+    }
+    case BUILTIN_GLYPH_RECT:
+    {
+        const int4 eighths = int4(descriptor >> uint4(4, 8, 12, 16) & 0xf);
+        const int4 edges = (eighths * size.xyxy + 4) / 8;
+        return all(pixel >= edges.xy) && all(pixel < edges.zw);
+    }
+    case BUILTIN_GLYPH_QUADRANTS:
+    {
+        // This uses the same rounding as the half blocks of BUILTIN_GLYPH_RECT, so that both line up.
+        const int2 mid = (size * 4 + 4) / 8;
+        const uint quadrant = (pixel.x >= mid.x ? 1 : 0) + (pixel.y >= mid.y ? 2 : 0);
+        return (descriptor >> (4 + quadrant)) & 1;
+    }
+    case BUILTIN_GLYPH_SHADE:
+    {
+        // The dither pattern is based on the position in the viewport (and not the cell),
+        // so that adjacent shades tile seamlessly no matter whether the cell size is odd or even.
+        const uint2 p = uint2(position) & 1;
+        switch ((descriptor >> 4) & 3)
+        {
+        case 1:
+            return !p.x && !p.y;
+        case 2:
+            return p.x == p.y;
+        default:
+            return !(p.x && p.y);
+        }
+    }
+    default:
+        return 0;
+    }
+}
@@ -315,6 +315,7 @@ namespace Microsoft::Console::Render::Atlas
         HWND hwnd = nullptr;
         bool enableTransparentBackground = false;
         bool useSoftwareRendering = false;
+        bool forceD2DMode = false;
     };
 
     enum class AntialiasingMode : u8
@@ -359,9 +360,14 @@ namespace Microsoft::Console::Render::Atlas
 
         u16 dpi = 96;
         AntialiasingMode antialiasingMode = DefaultAntialiasingMode;
+    };
 
-        std::vector<uint16_t> softFontPattern;
-        til::size softFontCellSize;
+    // The soft font (DRCS) is kept separate from the FontSettings, because applications may
+    // redefine it frequently and doing so shouldn't reset all font dependent resources.
+    struct SoftFontSettings
+    {
+        std::vector<uint16_t> pattern;
+        til::size cellSize;
     };
 
     struct CursorSettings
@@ -378,6 +384,11 @@ namespace Microsoft::Console::Render::Atlas
         u32 backgroundColor = 0;
         u32 selectionColor = 0x7fffffff;
         std::wstring customPixelShaderPath;
+        // If true, shaders that don't use the time variable only get run over the dirty rect.
+        // The built-in retro shader does this regardless, since it's known to only sample nearby pixels.
+        bool customPixelShaderPartialRedraw = false;
+        // Limits the frame rate of shaders that do use the time variable. 0 means no limit.
+        u16 customPixelShaderMaxFrameRate = 0;
         bool useRetroTerminalEffect = false;
     };
 
@@ -385,6 +396,7 @@ namespace Microsoft::Console::Render::Atlas
     {
         til::generational<TargetSettings> target;
         til::generational<FontSettings> font;
+        til::generational<SoftFontSettings> softFont;
         til::generational<CursorSettings> cursor;
         til::generational<MiscellaneousSettings> misc;
         // Size of the viewport / swap chain in pixel.
@@ -403,6 +415,7 @@ namespace Microsoft::Console::Render::Atlas
             til::generation_t{ 1 },
             til::generational<TargetSettings>{ til::generation_t{ 1 } },
             til::generational<FontSettings>{ til::generation_t{ 1 } },
+            til::generational<SoftFontSettings>{ til::generation_t{ 1 } },
             til::generational<CursorSettings>{ til::generation_t{ 1 } },
             til::generational<MiscellaneousSettings>{ til::generation_t{ 1 } },
         };
@@ -444,6 +457,8 @@ namespace Microsoft::Console::Render::Atlas
             lineRendition = LineRendition::SingleWidth;
             selectionFrom = 0;
             selectionTo = 0;
+            imageSlice.reset();
+            imageColumn = 0;
             dirtyTop = y * cellHeight;
             dirtyBottom = dirtyTop + cellHeight;
         }
@@ -457,10 +472,22 @@ namespace Microsoft::Console::Render::Atlas
         LineRendition lineRendition = LineRendition::SingleWidth;
         u16 selectionFrom = 0;
         u16 selectionTo = 0;
+        // The sixel image slice of this row, if any, and the viewport column it starts at (before applying the line rendition).
+        ImageSlice::Pointer imageSlice;
+        til::CoordType imageColumn = 0;
         til::CoordType dirtyTop = 0;
         til::CoordType dirtyBottom = 0;
     };
 
+    // Counters that the backends accumulate over their lifetime, for benchmarking. See AtlasEngine::GetFrameStatistics().
+    struct FrameStatistics
+    {
+        // The number of glyphs that had to be rasterized, because they weren't in the glyph atlas (yet or anymore).
+        u64 glyphAtlasMisses = 0;
+        // The number of bytes copied from the CPU into GPU resources, like the instance buffer and the background bitmap.
+        u64 bytesUploaded = 0;
+    };
+
     struct RenderingPayload
     {
         //// Parameters which are constant across backends.
@@ -490,8 +517,17 @@ namespace Microsoft::Console::Render::Atlas
             til::generation_t generation;
             til::generation_t targetGeneration;
             til::generation_t fontGeneration;
+            // The visible size of the swap chain. It may be smaller than bufferSize, see AtlasEngine::_resizeBuffers().
             u16x2 targetSize{};
+            u16x2 bufferSize{};
             bool waitForPresentation = false;
+            // Set if Present1() failed and we had to fall back to Present(), which
+            // doesn't preserve the previous frame's contents outside of the dirty rect.
+            bool presentFallback = false;
+            // Set if Present1() returned DXGI_STATUS_OCCLUDED. See AtlasEngine::_waitWhileOccluded().
+            bool occluded = false;
+            // Set once the occlusion ended, so that the next frame repaints everything.
+            bool occlusionEnded = false;
         } swapChain;
         wil::com_ptr<ID3D11Device2> device;
         wil::com_ptr<ID3D11DeviceContext2> deviceContext;
@@ -546,6 +582,10 @@ namespace Microsoft::Console::Render::Atlas
         // In pixel.
         i16 scrollOffset = 0;
 
+        //// Statistics.
+        // This is mutable, as the backends update it in places that otherwise only read the payload.
+        mutable FrameStatistics stats;
+
         void MarkAllAsDirty() noexcept
         {
             dirtyRectInPx = { 0, 0, s->targetSize.x, s->targetSize.y };
@@ -560,5 +600,7 @@ namespace Microsoft::Console::Render::Atlas
         virtual void ReleaseResources() noexcept = 0;
         virtual void Render(RenderingPayload& payload) = 0;
         virtual bool RequiresContinuousRedraw() noexcept = 0;
+        // The size of the glyph atlas texture in bytes.
+        virtual size_t GetGlyphAtlasMemoryUsage() const noexcept = 0;
     };
 }
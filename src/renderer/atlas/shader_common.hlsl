@@ -6,8 +6,10 @@
 #define SHADING_TYPE_TEXT_GRAYSCALE     1
 #define SHADING_TYPE_TEXT_CLEARTYPE     2
 #define SHADING_TYPE_TEXT_PASSTHROUGH   3
-#define SHADING_TYPE_DOTTED_LINE        4
-#define SHADING_TYPE_DOTTED_LINE_WIDE   5
+#define SHADING_TYPE_TEXT_BUILTIN_GLYPH 4
+#define SHADING_TYPE_DOTTED_LINE        5
+#define SHADING_TYPE_DOTTED_LINE_WIDE   6
+#define SHADING_TYPE_IMAGE              10
 // clang-format on
 
 struct VSData
@@ -26,6 +28,8 @@ struct PSData
     float2 texcoord : texcoord;
     nointerpolation uint shadingType : shadingType;
     nointerpolation float4 color : color;
+    // The descriptor of SHADING_TYPE_TEXT_BUILTIN_GLYPH quads, which is stored in their texcoord.
+    nointerpolation uint builtinGlyph : builtinGlyph;
 };
 
 float4 premultiplyColor(float4 color)
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT license.
 
+#include "builtin_glyphs.hlsl"
 #include "dwrite.hlsl"
 #include "shader_common.hlsl"
 
@@ -16,6 +17,7 @@ cbuffer ConstBuffer : register(b0)
 
 Texture2D<float4> background : register(t0);
 Texture2D<float4> glyphAtlas : register(t1);
+Texture2D<float4> imageAtlas : register(t2);
 
 struct Output
 {
@@ -71,6 +73,14 @@ Output main(PSData data) : SV_Target
         weights = color.aaaa;
         break;
     }
+    case SHADING_TYPE_TEXT_BUILTIN_GLYPH:
+    {
+        // Builtin glyphs are always exactly one cell large, which is why backgroundCellSize is their size.
+        const float coverage = builtinGlyphCoverage(data.builtinGlyph, data.position.xy, backgroundCellSize, max(1, int(round(underlineWidth))));
+        color = coverage * premultiplyColor(data.color);
+        weights = color.aaaa;
+        break;
+    }
     case SHADING_TYPE_DOTTED_LINE:
     {
         const bool on = frac(data.position.x / (2.0f * underlineWidth)) < 0.5f;
@@ -85,6 +95,13 @@ Output main(PSData data) : SV_Target
         weights = color.aaaa;
         break;
     }
+    case SHADING_TYPE_IMAGE:
+    {
+        // Images are stored with premultiplied alpha and already scaled to the cell size.
+        color = imageAtlas[data.texcoord];
+        weights = color.aaaa;
+        break;
+    }
     default:
     {
         color = premultiplyColor(data.color);
@@ -20,5 +20,6 @@ PSData main(VSData data)
     output.position.xy = (data.position + data.vertex.xy * data.size) * positionScale + float2(-1.0f, 1.0f);
     output.position.zw = float2(0, 1);
     output.texcoord = data.texcoord + data.vertex.xy * data.size;
+    output.builtinGlyph = data.texcoord.x | data.texcoord.y << 16;
     return output;
 }
@@ -59,6 +59,13 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
     return S_FALSE;
 }
 
+HRESULT RenderEngineBase::PaintImageSlice(const ImageSlice::Pointer& /*imageSlice*/,
+                                          const til::CoordType /*targetRow*/,
+                                          const til::CoordType /*viewportLeft*/) noexcept
+{
+    return S_FALSE;
+}
+
 // Method Description:
 // - By default, no one should need continuous redraw. It ruins performance
 //   in terms of CPU, memory, and battery life to just paint forever.
@@ -92,3 +99,16 @@ void RenderEngineBase::WaitUntilCanRender() noexcept
     *pForcePaint = false;
     return S_FALSE;
 }
+
+// Routine Description:
+// - Notifies us that the rows in the given region have been scrolled by delta.
+// - The default implementation doesn't know how to scroll a part of its frame.
+// Arguments:
+// - psrRegion - ignored
+// - delta - ignored
+// Return Value:
+// - S_FALSE to make the renderer invalidate the region instead.
+[[nodiscard]] HRESULT RenderEngineBase::InvalidateScrollRegion(const til::rect* const /*psrRegion*/, const til::CoordType /*delta*/) noexcept
+{
+    return S_FALSE;
+}
@@ -65,6 +65,7 @@ const std::array<COLORREF, TextColor::TABLE_SIZE>& RenderSettings::GetColorTable
 void RenderSettings::ResetColorTable() noexcept
 {
     InitializeColorTable({ _colorTable.data(), 16 });
+    _updateBrightDefaultForeground();
 }
 
 // Routine Description:
@@ -75,6 +76,7 @@ void RenderSettings::ResetColorTable() noexcept
 void RenderSettings::SetColorTableEntry(const size_t tableIndex, const COLORREF color)
 {
     _colorTable.at(tableIndex) = color;
+    _updateBrightDefaultForeground();
 }
 
 // Routine Description:
@@ -121,6 +123,7 @@ void RenderSettings::SetColorAliasIndex(const ColorAlias alias, const size_t tab
     if (tableIndex < TextColor::TABLE_SIZE)
     {
         gsl::at(_colorAliasIndices, static_cast<size_t>(alias)) = tableIndex;
+        _updateBrightDefaultForeground();
     }
 }
 
@@ -156,8 +159,8 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
     const auto dimFg = attr.IsFaint() || (_blinkShouldBeFaint && attr.IsBlinking());
     const auto swapFgAndBg = attr.IsReverseVideo() ^ GetRenderMode(Mode::ScreenReversed);
 
-    auto fg = fgTextColor.GetColor(_colorTable, defaultFgIndex, brightenFg);
-    auto bg = bgTextColor.GetColor(_colorTable, defaultBgIndex);
+    auto fg = _resolveColor(fgTextColor, defaultFgIndex, brightenFg);
+    auto bg = _resolveColor(bgTextColor, defaultBgIndex, false);
 
     if (dimFg)
     {
@@ -182,13 +185,72 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
             fg != bg &&
             (_renderMode.test(Mode::AlwaysDistinguishableColors) || (fgTextColor.IsDefaultOrLegacy() && bgTextColor.IsDefaultOrLegacy())))
         {
-            fg = ColorFix::GetPerceivableColor(fg, bg, 0.5f * 0.5f);
+            fg = _getPerceivableColor(fg, bg);
         }
     }
 
     return { fg, bg };
 }
 
+// Routine Description:
+// - Returns the same as TextColor::GetColor() with our color table, except that
+//   it uses the precomputed bright default foreground instead of searching for it.
+//   This is called twice for every attribute run that's painted.
+// Arguments:
+// - color - The color to resolve.
+// - defaultIndex - The color table index of the default color.
+// - brighten - Whether the color should be brightened (IntenseIsBright).
+// Return Value:
+// - The RGB value of the color.
+COLORREF RenderSettings::_resolveColor(const TextColor color, const size_t defaultIndex, const bool brighten) const noexcept
+{
+    if (color.IsDefault())
+    {
+        // The bright default is only ever computed for the default foreground.
+        return brighten && defaultIndex == GetColorAliasIndex(ColorAlias::DefaultForeground) ? _brightDefaultForeground : til::at(_colorTable, defaultIndex);
+    }
+    if (color.IsRgb())
+    {
+        return color.GetRGB();
+    }
+    const size_t index = color.GetIndex() | (brighten && color.IsIndex16() ? 8 : 0);
+    return til::at(_colorTable, index);
+}
+
+// Routine Description:
+// - Recomputes _brightDefaultForeground after the color table or the default foreground alias changed.
+void RenderSettings::_updateBrightDefaultForeground() noexcept
+{
+    _brightDefaultForeground = TextColor{}.GetColor(_colorTable, GetColorAliasIndex(ColorAlias::DefaultForeground), true);
+}
+
+// Routine Description:
+// - Returns ColorFix::GetPerceivableColor() for the given pair of colors.
+//   The Oklab conversion and adjustment is too costly to be done for every
+//   attribute run in every frame, which is why the results are cached.
+//   Since they only depend on the two RGB values, the cache never needs to be
+//   invalidated, not even when the color table changes.
+// Arguments:
+// - fg - The foreground color to adjust. Must be different from bg.
+// - bg - The background color it needs to be distinguishable from.
+// Return Value:
+// - The adjusted foreground color.
+COLORREF RenderSettings::_getPerceivableColor(const COLORREF fg, const COLORREF bg) const noexcept
+{
+    // Since fg != bg, a zero-initialized entry (fg == bg == 0) can never produce a false hit.
+    const auto hash = (fg * 0x9E3779B1u) ^ (bg * 0x85EBCA77u);
+    auto& entry = til::at(_perceivableColorCache, hash >> 24);
+
+    if (entry.fg != fg || entry.bg != bg)
+    {
+        entry.fg = fg;
+        entry.bg = bg;
+        entry.adjustedFg = ColorFix::GetPerceivableColor(fg, bg, 0.5f * 0.5f);
+    }
+
+    return entry.adjustedFg;
+}
+
 // Routine Description:
 // - Calculates the RGBA colors of a given text attribute, using the current
 //   color table configuration and active render settings. This differs from
@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "renderer.hpp"
+#include "../inc/RenderTracing.hpp"
 
 #pragma hdrstop
 
@@ -15,6 +16,13 @@ static constexpr auto maxRetriesForRenderEngine = 3;
 // The renderer will wait this number of milliseconds * how many tries have elapsed before trying again.
 static constexpr auto renderBackoffBaseTimeMilliseconds{ 150 };
 
+std::atomic<size_t> Renderer::_tracelogCount{ 0 };
+#pragma warning(suppress : 26477) // We don't control tracelogging macros
+TRACELOGGING_DEFINE_PROVIDER(g_hRenderProvider,
+                             "Microsoft.Windows.Terminal.Render",
+                             // {8fbedced-44b5-564e-29db-824367700dfb}
+                             (0x8fbedced, 0x44b5, 0x564e, 0x29, 0xdb, 0x82, 0x43, 0x67, 0x70, 0x0d, 0xfb));
+
 #define FOREACH_ENGINE(var)   \
     for (auto var : _engines) \
         if (!var)             \
@@ -37,6 +45,11 @@ Renderer::Renderer(const RenderSettings& renderSettings,
     _pData(pData),
     _pThread{ std::move(thread) }
 {
+    if (_tracelogCount.fetch_add(1) == 0)
+    {
+        TraceLoggingRegister(g_hRenderProvider);
+    }
+
     for (size_t i = 0; i < cEngines; i++)
     {
         AddRenderEngine(rgpEngines[i]);
@@ -54,6 +67,11 @@ Renderer::~Renderer()
     // RenderThread blocks until it has shut down.
     _destructing = true;
     _pThread.reset();
+
+    if (_tracelogCount.fetch_sub(1) == 1)
+    {
+        TraceLoggingUnregister(g_hRenderProvider);
+    }
 }
 
 // Routine Description:
@@ -64,22 +82,53 @@ Renderer::~Renderer()
 // - HRESULT S_OK, GDI error, Safe Math error, or state/argument errors.
 [[nodiscard]] HRESULT Renderer::PaintFrame()
 {
-    FOREACH_ENGINE(pEngine)
+    if (_destructing)
     {
-        auto tries = maxRetriesForRenderEngine;
-        while (tries > 0)
+        return S_FALSE;
+    }
+
+    // All engines are first painted during a single acquisition of the console lock.
+    // This way they all see the same buffer state and none of them has to wait for the
+    // Present() of another (which for VtEngine may block on the pipe) to get the lock.
+    std::array<HRESULT, std::tuple_size_v<decltype(_engines)>> results{};
+    {
+        _pData->LockConsole();
+        const auto unlock = wil::scope_exit([&]() {
+            _pData->UnlockConsole();
+        });
+
+        // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
+        try
         {
-            if (_destructing)
-            {
-                return S_FALSE;
-            }
+            _CheckViewportAndScroll();
+        }
+        CATCH_LOG();
 
-            const auto hr = _PaintFrameForEngine(pEngine);
-            if (SUCCEEDED(hr))
-            {
-                break;
-            }
+        for (size_t i = 0; i < _engines.size() && _engines[i]; ++i)
+        {
+            til::at(results, i) = _PaintFrameForEngine(til::at(_engines, i));
+        }
+    }
+
+    // Trigger out-of-lock presentation for renderers that can support it.
+    // _PaintFrameForEngine() returns S_FALSE if there was nothing to present.
+    for (size_t i = 0; i < _engines.size() && _engines[i]; ++i)
+    {
+        if (til::at(results, i) == S_OK)
+        {
+            til::at(results, i) = _PresentFrameForEngine(til::at(_engines, i));
+        }
+    }
 
+    // Engines that failed are retried one by one with some backoff.
+    for (size_t i = 0; i < _engines.size() && _engines[i]; ++i)
+    {
+        const auto pEngine = til::at(_engines, i);
+        auto hr = til::at(results, i);
+        auto tries = maxRetriesForRenderEngine;
+
+        while (FAILED(hr))
+        {
             LOG_HR_IF(hr, hr != E_PENDING);
 
             if (--tries == 0)
@@ -99,24 +148,64 @@ Renderer::~Renderer()
             // Add a bit of backoff.
             // Sleep 150ms, 300ms, 450ms before failing out and disabling the renderer.
             Sleep(renderBackoffBaseTimeMilliseconds * (maxRetriesForRenderEngine - tries));
+
+            if (_destructing)
+            {
+                return S_FALSE;
+            }
+
+            hr = _PaintAndPresentFrameForEngine(pEngine);
         }
     }
 
+    if (_pfnFramePresented)
+    {
+        _pfnFramePresented();
+    }
+
     return S_OK;
 }
 
+// Routine Description:
+// - Paints and presents a frame for a single engine. This is used to retry engines that failed in PaintFrame().
+// Arguments:
+// - pEngine - The engine to paint.
+// Return Value:
+// - S_OK or the failure of painting or presenting.
+[[nodiscard]] HRESULT Renderer::_PaintAndPresentFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
+try
+{
+    HRESULT hr;
+    {
+        _pData->LockConsole();
+        const auto unlock = wil::scope_exit([&]() {
+            _pData->UnlockConsole();
+        });
+
+        // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
+        _CheckViewportAndScroll();
+
+        hr = _PaintFrameForEngine(pEngine);
+    }
+
+    RETURN_IF_FAILED(hr);
+    return hr == S_OK ? _PresentFrameForEngine(pEngine) : S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Paints a frame for the given engine. The console lock must be held by the caller.
+// Arguments:
+// - pEngine - The engine to paint.
+// Return Value:
+// - S_OK if a frame was painted and needs to be presented,
+//   S_FALSE if there was nothing to paint, or a failure.
 [[nodiscard]] HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
 try
 {
     FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
 
-    _pData->LockConsole();
-    auto unlock = wil::scope_exit([&]() {
-        _pData->UnlockConsole();
-    });
-
-    // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
-    _CheckViewportAndScroll();
+    TIL_TRACE_REGION(g_hRenderProvider, "PaintFrame");
 
     // Try to start painting a frame
     const auto hr = pEngine->StartPaint();
@@ -127,7 +216,13 @@ try
     //      engine won't know that.
     if (S_FALSE == hr)
     {
-        return S_OK;
+        // An engine may skip frames while still asking to be called again, for
+        // instance AtlasEngine while its window is occluded.
+        if (pEngine->RequiresContinuousRedraw())
+        {
+            NotifyPaintFrame();
+        }
+        return S_FALSE;
     }
 
     auto endPaint = wil::scope_exit([&]() {
@@ -155,34 +250,48 @@ try
     RETURN_IF_FAILED(_PaintBackground(pEngine));
 
     // 2. Paint Rows of Text
-    _PaintBufferOutput(pEngine);
+    {
+        TIL_TRACE_REGION(g_hRenderProvider, "PaintBufferOutput");
+        _PaintBufferOutput(pEngine);
+    }
 
     // 3. Paint overlays that reside above the text buffer
     _PaintOverlays(pEngine);
 
     // 4. Paint Selection
-    _PaintSelection(pEngine);
+    {
+        TIL_TRACE_REGION(g_hRenderProvider, "PaintSelection");
+        _PaintSelection(pEngine);
+    }
 
     // 5. Paint Cursor
-    _PaintCursor(pEngine);
+    {
+        TIL_TRACE_REGION(g_hRenderProvider, "PaintCursor");
+        _PaintCursor(pEngine);
+    }
 
     // 6. Paint window title
     RETURN_IF_FAILED(_PaintTitle(pEngine));
 
-    // Force scope exit end paint to finish up collecting information and possibly painting
-    endPaint.reset();
-
-    // Force scope exit unlock to let go of global lock so other threads can run
-    unlock.reset();
-
-    // Trigger out-of-lock presentation for renderers that can support it
-    RETURN_IF_FAILED(pEngine->Present());
-
     // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Presents the frame previously painted by _PaintFrameForEngine(). Called outside of the console lock.
+// Arguments:
+// - pEngine - The engine to present.
+// Return Value:
+// - The result of IRenderEngine::Present().
+[[nodiscard]] HRESULT Renderer::_PresentFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
+try
+{
+    TIL_TRACE_REGION(g_hRenderProvider, "Present");
+    return pEngine->Present();
+}
+CATCH_RETURN()
+
 void Renderer::NotifyPaintFrame() noexcept
 {
     // If we're running in the unittests, we might not have a render thread.
@@ -235,15 +344,63 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
+
+        // This gets called for pretty much every change to the buffer, so instead of telling
+        // each engine about each of them, we only accumulate them here. _FlushPendingRedraw()
+        // hands them to the engines once per frame (or before anything that depends on them).
+        const auto size = view.Dimensions();
+        if (_pendingRedraw.size() != size)
         {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
+            _FlushPendingRedraw();
+            _pendingRedraw.resize(size);
         }
+        _pendingRedraw.set(srUpdateRegion);
 
         NotifyPaintFrame();
     }
 }
 
+// Routine Description:
+// - Passes the regions accumulated by TriggerRedraw() and TriggerRedrawCursor() on to the engines.
+//   The console lock must be held by the caller.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FlushPendingRedraw()
+{
+    if (_pendingRedraw.any())
+    {
+        for (const auto& rect : _pendingRedraw)
+        {
+            FOREACH_ENGINE(pEngine)
+            {
+                LOG_IF_FAILED(pEngine->Invalidate(&rect));
+            }
+        }
+
+        _pendingRedraw.reset_all();
+    }
+
+    if (_hasPendingCursor)
+    {
+        _hasPendingCursor = false;
+
+        FOREACH_ENGINE(pEngine)
+        {
+            LOG_IF_FAILED(pEngine->InvalidateCursor(&_pendingCursorFirst));
+            if (_pendingCursorTopmost != _pendingCursorFirst && _pendingCursorTopmost != _pendingCursorLast)
+            {
+                LOG_IF_FAILED(pEngine->InvalidateCursor(&_pendingCursorTopmost));
+            }
+            if (_pendingCursorLast != _pendingCursorFirst)
+            {
+                LOG_IF_FAILED(pEngine->InvalidateCursor(&_pendingCursorLast));
+            }
+        }
+    }
+}
+
 // Routine Description:
 // - Called when a particular coordinate within the console buffer has changed.
 // Arguments:
@@ -286,10 +443,21 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
         if (view.TrimToViewport(&updateRect))
         {
             view.ConvertToOrigin(&updateRect);
-            FOREACH_ENGINE(pEngine)
+
+            // During bulk output the cursor moves thousands of times per frame, but the engines only need to
+            // know where it was painted and where it has to be painted next. Just like with TriggerRedraw(),
+            // this is accumulated until _FlushPendingRedraw() hands it to the engines once per frame.
+            if (!_hasPendingCursor)
             {
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateRect));
+                _pendingCursorFirst = updateRect;
+                _pendingCursorTopmost = updateRect;
+                _hasPendingCursor = true;
             }
+            else if (updateRect.top < _pendingCursorTopmost.top)
+            {
+                _pendingCursorTopmost = updateRect;
+            }
+            _pendingCursorLast = updateRect;
 
             NotifyPaintFrame();
         }
@@ -306,6 +474,9 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
+    // Everything is getting invalidated anyways.
+    _pendingRedraw.reset_all();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateAll());
@@ -337,6 +508,7 @@ void Renderer::TriggerTeardown() noexcept
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
 
     // Then walk through and do one final paint on the caller's thread.
+    _FlushPendingRedraw();
     FOREACH_ENGINE(pEngine)
     {
         auto fEngineRequestsRepaint = false;
@@ -393,6 +565,10 @@ void Renderer::TriggerSelection()
 // - True if something changed and we scrolled. False otherwise.
 bool Renderer::_CheckViewportAndScroll()
 {
+    // The pending regions are relative to the current viewport and
+    // need to reach the engines before they learn about any scrolling.
+    _FlushPendingRedraw();
+
     const auto srOldViewport = _viewport.ToInclusive();
     const auto srNewViewport = _pData->GetViewport().ToInclusive();
 
@@ -444,6 +620,8 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
+    _FlushPendingRedraw();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
@@ -454,6 +632,50 @@ void Renderer::TriggerScroll(const til::point* const pcoordDelta)
     NotifyPaintFrame();
 }
 
+// Routine Description:
+// - Called when the rows within a region of the buffer have been scrolled vertically.
+//   The region has to span the full width of the buffer.
+// - Engines that can shift a part of their frame get told about the scroll.
+//   Everyone else (and regions extending beyond the viewport) simply get the region invalidated.
+// Arguments:
+// - region - the buffer-space region whose rows were scrolled
+// - delta - the distance the rows moved (positive is down, negative is up)
+// Return Value:
+// - <none>
+void Renderer::TriggerScrollRegion(const Viewport& region, const til::CoordType delta)
+{
+    auto view = _viewport;
+    auto srUpdateRegion = region.ToExclusive();
+
+    const auto& buffer = _pData->GetTextBuffer();
+    auto canScroll = delta != 0 && view.IsInBounds(region);
+    for (auto row = srUpdateRegion.top; canScroll && row < srUpdateRegion.bottom; row++)
+    {
+        canScroll = !buffer.IsDoubleWidthLine(row);
+    }
+
+    if (!canScroll)
+    {
+        TriggerRedraw(region);
+        return;
+    }
+
+    _FlushPendingRedraw();
+
+    view.ConvertToOrigin(&srUpdateRegion);
+    FOREACH_ENGINE(pEngine)
+    {
+        const auto hr = pEngine->InvalidateScrollRegion(&srUpdateRegion, delta);
+        LOG_IF_FAILED(hr);
+        if (hr != S_OK)
+        {
+            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
+        }
+    }
+
+    NotifyPaintFrame();
+}
+
 // Routine Description:
 // - Called when the text buffer is about to circle its backing buffer.
 //      A renderer might want to get painted before that happens.
@@ -465,6 +687,8 @@ void Renderer::TriggerFlush(const bool circling)
 {
     const auto rects = _GetSelectionRects();
 
+    _FlushPendingRedraw();
+
     FOREACH_ENGINE(pEngine)
     {
         auto fEngineRequestsRepaint = false;
@@ -751,6 +975,12 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
 
             // Ask the helper to paint through this specific line.
             _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+
+            // Inline images are painted on top of the text in the same row.
+            if (const auto& imageSlice = buffer.GetRowByOffset(bufferLine.Origin().y).GetImageSlice())
+            {
+                LOG_IF_FAILED(pEngine->PaintImageSlice(imageSlice, screenPosition.y, view.Left()));
+            }
         }
     }
 }
@@ -779,8 +1009,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
         // Retrieve the first color.
         auto color = it->TextAttr();
+        // Looking up the pattern ids of each cell is costly, so we only do it for rows that have any.
+        const auto rowHasPatterns = _pData->HasPatternsInRow(target.y);
         // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
+        auto patternIds = rowHasPatterns ? _pData->GetPatternId(target) : std::vector<size_t>{};
         // Determine whether we're using a soft font.
         auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
 
@@ -828,7 +1060,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             do
             {
                 til::point thisPoint{ screenPoint.x + cols, screenPoint.y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
+                const auto thisPointPatterns = rowHasPatterns ? _pData->GetPatternId(thisPoint) : std::vector<size_t>{};
                 const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
                 const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
                 if (color != it->TextAttr() || changedPatternOrFont)
@@ -1358,6 +1590,18 @@ void Renderer::SetRendererEnteredErrorStateCallback(std::function<void()> pfn)
     _pfnRendererEnteredErrorState = std::move(pfn);
 }
 
+// Method Description:
+// - Registers a callback that will be called on the render thread
+//   after every engine has successfully finished painting a frame.
+// Arguments:
+// - pfn: the callback
+// Return Value:
+// - <none>
+void Renderer::SetFramePresentedCallback(std::function<void()> pfn)
+{
+    _pfnFramePresented = std::move(pfn);
+}
+
 // Method Description:
 // - Attempts to restart the renderer.
 void Renderer::ResetErrorStateAndResume()
@@ -1380,6 +1624,32 @@ void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval
     _hoveredInterval = newInterval;
 }
 
+// Routine Description:
+// - Asks the engines to release their caches and GPU resources, because we won't be rendering for a while.
+// - Painting must be disabled via WaitForPaintCompletionAndDisable(), because
+//   the engines are not synchronized with the render thread.
+void Renderer::TrimMemory() noexcept
+{
+    FOREACH_ENGINE(pEngine)
+    {
+        pEngine->TrimMemory();
+    }
+}
+
+// Routine Description:
+// - Returns the memory held by all engines. Unlike most other methods, this may be called on any thread.
+RenderEngineMemoryUsage Renderer::GetMemoryUsage() const noexcept
+{
+    RenderEngineMemoryUsage usage;
+    FOREACH_ENGINE(pEngine)
+    {
+        const auto u = pEngine->GetMemoryUsage();
+        usage.glyphAtlas += u.glyphAtlas;
+        usage.swapChain += u.swapChain;
+    }
+    return usage;
+}
+
 // Method Description:
 // - Blocks until the engines are able to render without blocking.
 void Renderer::WaitUntilCanRender()
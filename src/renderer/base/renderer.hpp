@@ -57,6 +57,7 @@ namespace Microsoft::Console::Render
         void TriggerSelection();
         void TriggerScroll();
         void TriggerScroll(const til::point* const pcoordDelta);
+        void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& region, const til::CoordType delta);
 
         void TriggerFlush(const bool circling);
         void TriggerTitleChange();
@@ -87,17 +88,23 @@ namespace Microsoft::Console::Render
         void SetBackgroundColorChangedCallback(std::function<void()> pfn);
         void SetFrameColorChangedCallback(std::function<void()> pfn);
         void SetRendererEnteredErrorStateCallback(std::function<void()> pfn);
+        void SetFramePresentedCallback(std::function<void()> pfn);
         void ResetErrorStateAndResume();
 
         void UpdateHyperlinkHoveredId(uint16_t id) noexcept;
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
+        void TrimMemory() noexcept;
+        RenderEngineMemoryUsage GetMemoryUsage() const noexcept;
 
     private:
         static GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
+        [[nodiscard]] HRESULT _PaintAndPresentFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
+        [[nodiscard]] HRESULT _PresentFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
         bool _CheckViewportAndScroll();
+        void _FlushPendingRedraw();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const til::point target, const bool lineWrapped);
@@ -120,16 +127,26 @@ namespace Microsoft::Console::Render
         std::array<IRenderEngine*, 2> _engines{};
         IRenderData* _pData = nullptr; // Non-ownership pointer
         std::unique_ptr<RenderThread> _pThread;
+        static std::atomic<size_t> _tracelogCount;
         static constexpr size_t _firstSoftFontChar = 0xEF20;
         size_t _lastSoftFontChar = 0;
         uint16_t _hyperlinkHoveredId = 0;
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
+        til::bitmap _pendingRedraw;
+        // The cursor regions accumulated by TriggerRedrawCursor() until the next _FlushPendingRedraw(): Where the
+        // cursor was before it first moved, the topmost region it visited (see VtEngine::InvalidateCursor()) and
+        // where it ended up. Only valid if _hasPendingCursor is true.
+        til::rect _pendingCursorFirst;
+        til::rect _pendingCursorTopmost;
+        til::rect _pendingCursorLast;
+        bool _hasPendingCursor = false;
         std::vector<Cluster> _clusterBuffer;
         std::vector<til::rect> _previousSelection;
         std::function<void()> _pfnBackgroundColorChanged;
         std::function<void()> _pfnFrameColorChanged;
         std::function<void()> _pfnRendererEnteredErrorState;
+        std::function<void()> _pfnFramePresented;
         bool _destructing = false;
         bool _forceUpdateViewport = false;
 
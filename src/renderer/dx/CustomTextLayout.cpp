@@ -162,14 +162,20 @@ try
     _formatInUse = _fontRenderData->TextFormatWithAttribute(weight, style, stretch).Get();
     _fontInUse = _fontRenderData->FontFaceWithAttribute(weight, style, stretch).Get();
 
-    RETURN_IF_FAILED(_AnalyzeTextComplexity());
-    RETURN_IF_FAILED(_AnalyzeRuns());
-    RETURN_IF_FAILED(_ShapeGlyphRuns());
-    RETURN_IF_FAILED(_CorrectGlyphRuns());
-    // Correcting box drawing has to come after both font fallback and
-    // the glyph run advance correction (which will apply a font size scaling factor).
-    // We need to know all the proposed X and Y dimension metrics to get this right.
-    RETURN_IF_FAILED(_CorrectBoxDrawing());
+    const auto cacheKey = _HashLayoutCacheKey();
+    if (!_RestoreFromLayoutCache(cacheKey))
+    {
+        RETURN_IF_FAILED(_AnalyzeTextComplexity());
+        RETURN_IF_FAILED(_AnalyzeRuns());
+        RETURN_IF_FAILED(_ShapeGlyphRuns());
+        RETURN_IF_FAILED(_CorrectGlyphRuns());
+        // Correcting box drawing has to come after both font fallback and
+        // the glyph run advance correction (which will apply a font size scaling factor).
+        // We need to know all the proposed X and Y dimension metrics to get this right.
+        RETURN_IF_FAILED(_CorrectBoxDrawing());
+
+        _StoreInLayoutCache(cacheKey);
+    }
 
     RETURN_IF_FAILED(_DrawGlyphRuns(clientDrawingContext, renderer, { originX, originY }));
 
@@ -1002,6 +1008,80 @@ CATCH_RETURN();
     return 3 * textLength / 2 + 16;
 }
 
+// Routine Description:
+// - Hashes everything that the results of Draw()'s analysis depend on.
+// Arguments:
+// - <none> - Uses internal state
+// Return Value:
+// - The key for _layoutCache.
+[[nodiscard]] size_t CustomTextLayout::_HashLayoutCacheKey() const noexcept
+{
+    til::hasher h;
+    h.write(&_formatInUse, 1);
+    h.write(&_fontInUse, 1);
+    h.write(_text.data(), _text.size());
+    h.write(_textClusterColumns.data(), _textClusterColumns.size());
+    return h.finalize();
+}
+
+// Routine Description:
+// - Restores the glyph runs for the current text from the cache, if they're in there.
+// Arguments:
+// - key - The value returned by _HashLayoutCacheKey()
+// Return Value:
+// - True if the glyph runs were restored and can be drawn right away.
+[[nodiscard]] bool CustomTextLayout::_RestoreFromLayoutCache(const size_t key)
+{
+    const auto it = _layoutCache.find(key);
+    if (it == _layoutCache.end())
+    {
+        return false;
+    }
+
+    // The hash might collide, so we still need to check the actual key.
+    const auto& cached = it->second;
+    if (cached.format != _formatInUse || cached.font != _fontInUse || cached.text != _text || cached.textClusterColumns != _textClusterColumns)
+    {
+        return false;
+    }
+
+    _runs = cached.runs;
+    _glyphOffsets = cached.glyphOffsets;
+    _glyphClusters = cached.glyphClusters;
+    _glyphIndices = cached.glyphIndices;
+    _glyphAdvances = cached.glyphAdvances;
+    return true;
+}
+
+// Routine Description:
+// - Stores the glyph runs for the current text in the cache.
+// - The cache is simply cleared once it's full. Its only purpose is to hold
+//   the couple screens worth of text that gets drawn over and over again.
+// Arguments:
+// - key - The value returned by _HashLayoutCacheKey()
+// Return Value:
+// - <none>
+void CustomTextLayout::_StoreInLayoutCache(const size_t key)
+{
+    if (_layoutCache.size() >= _layoutCacheCapacity)
+    {
+        _layoutCache.clear();
+    }
+
+    _layoutCache.insert_or_assign(key,
+                                  CachedLayout{
+                                      .format = _formatInUse,
+                                      .font = _fontInUse,
+                                      .text = _text,
+                                      .textClusterColumns = _textClusterColumns,
+                                      .runs = _runs,
+                                      .glyphOffsets = _glyphOffsets,
+                                      .glyphClusters = _glyphClusters,
+                                      .glyphIndices = _glyphIndices,
+                                      .glyphAdvances = _glyphAdvances,
+                                  });
+}
+
 #pragma region IDWriteTextAnalysisSource methods
 // Routine Description:
 // - Implementation of IDWriteTextAnalysisSource::GetTextAtPosition
@@ -148,6 +148,10 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] static constexpr UINT32 _EstimateGlyphCount(const UINT32 textLength) noexcept;
 
+        [[nodiscard]] size_t _HashLayoutCacheKey() const noexcept;
+        [[nodiscard]] bool _RestoreFromLayoutCache(const size_t key);
+        void _StoreInLayoutCache(const size_t key);
+
     private:
         // DirectWrite font render data
         DxFontRenderData* _fontRenderData;
@@ -206,6 +210,25 @@ namespace Microsoft::Console::Render
         // These are used to further break the runs apart and adjust the font size so glyphs fit inside the cells.
         std::vector<ScaleCorrection> _glyphScaleCorrections;
 
+        // The results of analyzing, shaping and correcting the glyph runs in Draw(). Most lines are drawn
+        // over and over again without having changed, so we can skip straight to drawing them next time.
+        // The cell width is fixed for a given layout (it gets recreated whenever the font changes),
+        // which is why the text, its columns and the font are all there is to the key.
+        struct CachedLayout
+        {
+            IDWriteTextFormat* format;
+            IDWriteFontFace1* font;
+            std::wstring text;
+            std::vector<UINT16> textClusterColumns;
+            std::vector<LinkedRun> runs;
+            std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            std::vector<UINT16> glyphClusters;
+            std::vector<UINT16> glyphIndices;
+            std::vector<float> glyphAdvances;
+        };
+        static constexpr size_t _layoutCacheCapacity = 1024;
+        std::unordered_map<size_t, CachedLayout> _layoutCache;
+
 #ifdef UNIT_TESTING
     public:
         CustomTextLayout() = default;
@@ -1370,7 +1370,9 @@ try
 
         if (SUCCEEDED(hr))
         {
-            if (_invalidScroll != til::point{ 0, 0 })
+            // If everything is invalid, we leave _presentParams zeroed out
+            // which makes Present1 present the entire swap chain buffer.
+            if (!_invalidMap.all())
             {
                 // Copy `til::rects` into RECT map.
                 _presentDirty.assign(_invalidMap.begin(), _invalidMap.end());
@@ -1380,6 +1382,18 @@ try
                     return rc.scale_up(_fontRenderData->GlyphCell());
                 });
 
+                // Now fill up the parameters structure from the member variables.
+                _presentParams.DirtyRectsCount = gsl::narrow<UINT>(_presentDirty.size());
+
+                // It's not nice to use reinterpret_cast between til::rect and RECT,
+                // but to be honest... it does save a ton of type juggling.
+                static_assert(sizeof(decltype(_presentDirty)::value_type) == sizeof(RECT));
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+                _presentParams.pDirtyRects = reinterpret_cast<RECT*>(_presentDirty.data());
+            }
+
+            if (!_invalidMap.all() && _invalidScroll != til::point{ 0, 0 })
+            {
                 // Invalid scroll is in characters, convert it to pixels.
                 const auto scrollPixels = (_invalidScroll * _fontRenderData->GlyphCell());
 
@@ -1398,15 +1412,6 @@ try
                 // Pass the offset.
                 _presentOffset = scrollPixels.to_win32_point();
 
-                // Now fill up the parameters structure from the member variables.
-                _presentParams.DirtyRectsCount = gsl::narrow<UINT>(_presentDirty.size());
-
-                // It's not nice to use reinterpret_cast between til::rect and RECT,
-                // but to be honest... it does save a ton of type juggling.
-                static_assert(sizeof(decltype(_presentDirty)::value_type) == sizeof(RECT));
-#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
-                _presentParams.pDirtyRects = reinterpret_cast<RECT*>(_presentDirty.data());
-
                 _presentParams.pScrollOffset = &_presentOffset;
                 _presentParams.pScrollRect = &_presentScroll;
 
@@ -29,6 +29,7 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept override;
         [[nodiscard]] HRESULT InvalidateScroll(const til::point* const pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const til::rect* const psrRegion, const til::CoordType delta) noexcept override;
         [[nodiscard]] HRESULT InvalidateSystem(const til::rect* const prcDirtyClient) noexcept override;
         [[nodiscard]] HRESULT Invalidate(const til::rect* const psrRegion) noexcept override;
         [[nodiscard]] HRESULT InvalidateCursor(const til::rect* const psrRegion) noexcept override;
@@ -38,6 +39,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
+        void WaitUntilCanRender() noexcept override;
 
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
 
@@ -104,7 +106,9 @@ namespace Microsoft::Console::Render
         TEXTMETRICW _tmFontMetrics;
         FontResource _softFont;
 
-        static const size_t s_cPolyTextCache = 80;
+        // _FlushBufferLines() groups the entries by color and font,
+        // which works better the more of a frame it gets to see at once.
+        static const size_t s_cPolyTextCache = 256;
         POLYTEXTW _pPolyText[s_cPolyTextCache];
         size_t _cPolyText;
         [[nodiscard]] HRESULT _FlushBufferLines() noexcept;
@@ -133,6 +137,10 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PrepareMemoryBitmap(const HWND hwnd) noexcept;
 
         til::size _szInvalidScroll;
+        // A scroll of the rows within the (pixel) rect _rcScrollRegion by _scrollRegionDelta pixels,
+        // which ScrollFrame() applies to the frame before _szInvalidScroll. See InvalidateScrollRegion().
+        til::rect _rcScrollRegion;
+        til::CoordType _scrollRegionDelta = 0;
         til::rect _rcInvalid;
         bool _fInvalidRectUsed;
 
@@ -147,8 +155,21 @@ namespace Microsoft::Console::Render
             Soft
         };
         FontType _lastFontType;
+        // The font that's actually selected into _hdcMemoryContext.
+        // This lags behind _lastFontType, because fonts only get selected by _FlushBufferLines().
+        FontType _selectedFontType = FontType::Undefined;
         bool _fontHasWesternScript = false;
 
+        // The colors and font of each _pPolyText entry, as they were when PaintBufferLine() was called.
+        struct PolyTextAttributes
+        {
+            COLORREF foreground;
+            COLORREF background;
+            FontType fontType;
+        };
+        PolyTextAttributes _polyTextAttributes[s_cPolyTextCache];
+        void _SelectFontType(FontType fontType) noexcept;
+
         XFORM _currentLineTransform;
         LineRendition _currentLineRendition;
 
@@ -40,6 +40,80 @@ HRESULT GdiEngine::InvalidateScroll(const til::point* const pcoordDelta) noexcep
     return S_OK;
 }
 
+// Routine Description:
+// - Notifies us that the console scrolled the rows within the given region, for instance
+//   because the client set scrolling margins. Instead of repainting the whole region,
+//   ScrollFrame() will shift the existing pixels and only the revealed rows get repainted.
+// - We only keep track of a single region per frame. If the client scrolls a different region
+//   or in the opposite direction before we paint, or if the viewport is scrolled as well,
+//   we return S_FALSE and the renderer invalidates the region instead.
+// Arguments:
+// - psrRegion - the scrolled rows, relative to the viewport, spanning its full width
+// - delta - the distance the rows moved (positive is down, negative is up)
+// Return Value:
+// - S_OK if we'll scroll the region, S_FALSE if it needs to be repainted.
+HRESULT GdiEngine::InvalidateScrollRegion(const til::rect* const psrRegion, const til::CoordType delta) noexcept
+try
+{
+    const auto fontSize = _GetFontSize();
+    if (delta == 0 || std::abs(delta) >= psrRegion->height() || !_IsWindowValid() ||
+        _szInvalidScroll != til::size{} || fontSize.width == 0 || fontSize.height == 0)
+    {
+        return S_FALSE;
+    }
+
+    til::rect rcClient;
+    RETURN_HR_IF(E_FAIL, !(GetClientRect(_hwndTargetWindow, rcClient.as_win32_rect())));
+
+    // If everything is getting repainted anyway, the scroll is pointless.
+    if (_fInvalidRectUsed && _rcInvalid.top <= rcClient.top && _rcInvalid.bottom >= rcClient.bottom)
+    {
+        return S_FALSE;
+    }
+
+    // The gutters (the sub-character pixels at the right and bottom of the window) are never scrolled.
+    auto region = psrRegion->scale_up(fontSize);
+    region.left = 0;
+    region.right = _szMemorySurface.width - _szMemorySurface.width % fontSize.width;
+    const auto pixelDelta = delta * fontSize.height;
+
+    if (_scrollRegionDelta != 0 &&
+        (region.top != _rcScrollRegion.top || region.bottom != _rcScrollRegion.bottom || (pixelDelta < 0) != (_scrollRegionDelta < 0)))
+    {
+        return S_FALSE;
+    }
+
+    // Areas that are still waiting to be painted move along with the scrolled rows.
+    if (_fInvalidRectUsed)
+    {
+        auto moved = _rcInvalid & region;
+        moved.top += pixelDelta;
+        moved.bottom += pixelDelta;
+        moved &= region;
+        if (!moved.empty())
+        {
+            RETURN_IF_FAILED(_InvalidCombine(&moved));
+        }
+    }
+
+    // The rows revealed by the scroll need to be painted.
+    auto revealed = region;
+    if (pixelDelta < 0)
+    {
+        revealed.top = region.bottom + pixelDelta;
+    }
+    else
+    {
+        revealed.bottom = region.top + pixelDelta;
+    }
+    RETURN_IF_FAILED(_InvalidCombine(&revealed));
+
+    _rcScrollRegion = region;
+    _scrollRegionDelta = std::clamp(_scrollRegionDelta + pixelDelta, -region.height(), region.height());
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Routine Description:
 // - Notifies us that the console has changed the selection region and would like it updated
 // Arguments:
@@ -79,7 +79,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
 [[nodiscard]] HRESULT GdiEngine::ScrollFrame() noexcept
 {
     // If we don't have any scrolling to do, return early.
-    RETURN_HR_IF(S_OK, 0 == _szInvalidScroll.width && 0 == _szInvalidScroll.height);
+    RETURN_HR_IF(S_OK, 0 == _szInvalidScroll.width && 0 == _szInvalidScroll.height && 0 == _scrollRegionDelta);
 
     // If we have an inverted cursor, we have to see if we have to clean it before we scroll to prevent
     // left behind cursor copies in the scrolled region.
@@ -125,6 +125,23 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
     RETURN_IF_FAILED(LongSub(_szMemorySurface.width, szGutter.width, &rcScrollLimit.right));
     RETURN_IF_FAILED(LongSub(_szMemorySurface.height, szGutter.height, &rcScrollLimit.bottom));
 
+    // InvalidateScrollRegion() refuses to scroll a region once the viewport was scrolled, so the region
+    // scroll always happened first. It also already invalidated the revealed rows.
+    if (_scrollRegionDelta != 0)
+    {
+        const auto rcRegion = _rcScrollRegion.to_win32_rect();
+        LOG_LAST_ERROR_IF(!ScrollWindowEx(_hwndTargetWindow, 0, _scrollRegionDelta, &rcRegion, &rcRegion, nullptr, nullptr, 0));
+        LOG_HR_IF(E_FAIL, !(ScrollDC(_hdcMemoryContext, 0, _scrollRegionDelta, &rcRegion, &rcRegion, nullptr, nullptr)));
+        _scrollRegionDelta = 0;
+    }
+
+    if (0 == _szInvalidScroll.width && 0 == _szInvalidScroll.height)
+    {
+        // update invalid rect for the remainder of paint functions
+        _psInvalidData.rcPaint = _rcInvalid.to_win32_rect();
+        return S_OK;
+    }
+
     // Scroll real window and memory buffer in-sync.
     LOG_LAST_ERROR_IF(!ScrollWindowEx(_hwndTargetWindow,
                                       _szInvalidScroll.width,
@@ -234,6 +251,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
     _rcInvalid = {};
     _fInvalidRectUsed = false;
     _szInvalidScroll = {};
+    _scrollRegionDelta = 0;
 
     LOG_HR_IF(E_FAIL, !(GdiFlush()));
     LOG_HR_IF(E_FAIL, !(ReleaseDC(_hwndTargetWindow, _psInvalidData.hdc)));
@@ -261,6 +279,25 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
     return S_FALSE;
 }
 
+// Routine Description:
+// - Blocks until the next frame should be painted.
+// - RenderThread calls this right after a frame and before it waits for the next paint request.
+//   This means that the first frame after idling (for instance the echo of a key press) is painted
+//   immediately, while continuous output gets coalesced into one frame per composition pass.
+// - The default implementation sleeps for a fixed 8ms instead, which isn't tied to the refresh rate.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void GdiEngine::WaitUntilCanRender() noexcept
+{
+    // DWM doesn't compose minimized windows, so DwmFlush() may return immediately.
+    if (IsIconic(_hwndTargetWindow) || FAILED(DwmFlush()))
+    {
+        RenderEngineBase::WaitUntilCanRender();
+    }
+}
+
 // Routine Description:
 // - Fills the given rectangle with the background color on the drawing context.
 // Arguments:
@@ -415,7 +452,8 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
         pPolyTextLine->n = gsl::narrow<UINT>(polyString.size());
         pPolyTextLine->x = ptDraw.x;
         pPolyTextLine->y = ptDraw.y;
-        pPolyTextLine->uiFlags = ETO_OPAQUE | ETO_CLIPPED;
+        // The background isn't painted with ETO_OPAQUE, but rather separately by _FlushBufferLines().
+        pPolyTextLine->uiFlags = ETO_CLIPPED;
         pPolyTextLine->rcl.left = pPolyTextLine->x;
         pPolyTextLine->rcl.top = pPolyTextLine->y + topOffset;
         pPolyTextLine->rcl.right = pPolyTextLine->rcl.left + (til::CoordType)cchCharWidths;
@@ -427,6 +465,7 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
             pPolyTextLine->rcl.left += coordFontSize.width;
         }
 
+        _polyTextAttributes[_cPolyText] = { _lastFg, _lastBg, _lastFontType };
         _cPolyText++;
 
         if (_cPolyText >= s_cPolyTextCache)
@@ -441,6 +480,9 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
 
 // Routine Description:
 // - Flushes any buffer lines in the PolyTextOut cache by drawing them and freeing the strings.
+// - The backgrounds of all lines are painted first. The text is then painted transparently on top, grouped by
+//   font and foreground color, with one PolyTextOutW() call per group. This way a colorful frame doesn't cost
+//   a flush for every color change, which matters on machines where GDI is all there is (VMs without a GPU).
 // - See also: PaintBufferLine
 // Arguments:
 // - <none>
@@ -452,9 +494,56 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
 
     if (_cPolyText > 0)
     {
+        // Paint the backgrounds with the DC brush. Its color is also used by _PaintBackgroundColor() and must be restored.
+        const auto brushPrev = SelectBrush(_hdcMemoryContext, GetStockBrush(DC_BRUSH));
+        const auto brushColorPrev = GetDCBrushColor(_hdcMemoryContext);
+        auto brushColor = CLR_INVALID;
+
         for (size_t i = 0; i != _cPolyText; ++i)
         {
             const auto& t = _pPolyText[i];
+            const auto background = _polyTextAttributes[i].background;
+
+            if (background != brushColor)
+            {
+                SetDCBrushColor(_hdcMemoryContext, background);
+                brushColor = background;
+            }
+
+            PatBlt(_hdcMemoryContext, t.rcl.left, t.rcl.top, t.rcl.right - t.rcl.left, t.rcl.bottom - t.rcl.top, PATCOPY);
+        }
+
+        SetDCBrushColor(_hdcMemoryContext, brushColorPrev);
+        SelectBrush(_hdcMemoryContext, brushPrev);
+
+        // Sort the lines by font and foreground color. Ties are broken by index, which keeps the order
+        // of the lines within a group stable, without std::stable_sort() and its potential allocation.
+        std::array<uint16_t, s_cPolyTextCache> order;
+        std::iota(order.begin(), order.begin() + _cPolyText, uint16_t{ 0 });
+        std::sort(order.begin(), order.begin() + _cPolyText, [&](const uint16_t a, const uint16_t b) {
+            const auto& aa = _polyTextAttributes[a];
+            const auto& ba = _polyTextAttributes[b];
+            return std::tie(aa.fontType, aa.foreground, a) < std::tie(ba.fontType, ba.foreground, b);
+        });
+
+        const auto bkModePrev = SetBkMode(_hdcMemoryContext, TRANSPARENT);
+
+        // The lines of the current group that can be drawn with a single PolyTextOutW().
+        std::array<POLYTEXTW, s_cPolyTextCache> batch;
+        size_t batchSize = 0;
+        auto textColor = CLR_INVALID;
+
+        for (size_t i = 0; i != _cPolyText; ++i)
+        {
+            const auto& t = _pPolyText[order[i]];
+            const auto& a = _polyTextAttributes[order[i]];
+
+            _SelectFontType(a.fontType);
+            if (a.foreground != textColor)
+            {
+                SetTextColor(_hdcMemoryContext, a.foreground);
+                textColor = a.foreground;
+            }
 
             // The following if/else replicates the essentials of how ExtTextOutW() without ETO_IGNORELANGUAGE works.
             // See InternalTextOut().
@@ -467,11 +556,9 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
             // text in logical order in order to be compatible with applications like `vim -H`.
             if (_fontHasWesternScript && ScriptIsComplex(t.lpstr, t.n, SIC_COMPLEX) == S_FALSE)
             {
-                if (!ExtTextOutW(_hdcMemoryContext, t.x, t.y, t.uiFlags | ETO_IGNORELANGUAGE, &t.rcl, t.lpstr, t.n, t.pdx))
-                {
-                    hr = E_FAIL;
-                    break;
-                }
+                auto& b = batch[batchSize++];
+                b = t;
+                b.uiFlags |= ETO_IGNORELANGUAGE;
             }
             else
             {
@@ -492,8 +579,22 @@ bool GdiEngine::FontHasWesternScript(HDC hdc)
                     break;
                 }
             }
+
+            // Flush the batch at the end of each group, before the font or color changes.
+            const auto last = i + 1 == _cPolyText;
+            if (batchSize && (last || std::tie(a.fontType, a.foreground) != std::tie(_polyTextAttributes[order[i + 1]].fontType, _polyTextAttributes[order[i + 1]].foreground)))
+            {
+                if (!PolyTextOutW(_hdcMemoryContext, batch.data(), gsl::narrow_cast<int>(batchSize)))
+                {
+                    hr = E_FAIL;
+                    break;
+                }
+                batchSize = 0;
+            }
         }
 
+        SetBkMode(_hdcMemoryContext, bkModePrev);
+
         _polyStrings.clear();
         _polyWidths.clear();
 
@@ -19,6 +19,7 @@ Abstract:
 #include <Windows.h>
 #include <windowsx.h>
 #include <usp10.h>
+#include <dwmapi.h>
 
 #if defined(DEBUG) || defined(_DEBUG) || defined(DBG)
 #define WHEN_DBG(x) x
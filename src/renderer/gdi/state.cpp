@@ -269,23 +269,13 @@ GdiEngine::~GdiEngine()
                                                       const bool usingSoftFont,
                                                       const bool isSettingDefaultBrushes) noexcept
 {
-    RETURN_IF_FAILED(_FlushBufferLines());
-
     RETURN_HR_IF_NULL(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), _hdcMemoryContext);
 
-    // Set the colors for painting text
+    // The colors for painting text. These don't get applied to the DC here, but are rather recorded
+    // for each line by PaintBufferLine(), so that _FlushBufferLines() can group the lines by them.
     const auto [colorForeground, colorBackground] = renderSettings.GetAttributeColors(textAttributes);
-
-    if (colorForeground != _lastFg)
-    {
-        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetTextColor(_hdcMemoryContext, colorForeground));
-        _lastFg = colorForeground;
-    }
-    if (colorBackground != _lastBg)
-    {
-        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetBkColor(_hdcMemoryContext, colorBackground));
-        _lastBg = colorBackground;
-    }
+    _lastFg = colorForeground;
+    _lastBg = colorBackground;
 
     if (isSettingDefaultBrushes)
     {
@@ -296,31 +286,43 @@ GdiEngine::~GdiEngine()
         RETURN_IF_FAILED(s_SetWindowLongWHelper(_hwndTargetWindow, GWL_CONSOLE_BKCOLOR, colorBackground));
     }
 
-    // If the font type has changed, select an appropriate font variant or soft font.
+    // Same for the font variant or soft font. It gets selected by _FlushBufferLines().
     const auto usingItalicFont = textAttributes.IsItalic();
-    const auto fontType = usingSoftFont   ? FontType::Soft :
-                          usingItalicFont ? FontType::Italic :
-                                            FontType::Default;
-    if (fontType != _lastFontType)
+    _lastFontType = usingSoftFont   ? FontType::Soft :
+                    usingItalicFont ? FontType::Italic :
+                                      FontType::Default;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Selects the given font variant or soft font into the memory DC, if it isn't already.
+// Arguments:
+// - fontType - The font to select
+// Return Value:
+// - <none>
+void GdiEngine::_SelectFontType(const FontType fontType) noexcept
+{
+    if (fontType == _selectedFontType)
     {
-        switch (fontType)
-        {
-        case FontType::Soft:
-            SelectFont(_hdcMemoryContext, _softFont);
-            break;
-        case FontType::Italic:
-            SelectFont(_hdcMemoryContext, _hfontItalic);
-            break;
-        case FontType::Default:
-        default:
-            SelectFont(_hdcMemoryContext, _hfont);
-            break;
-        }
-        _lastFontType = fontType;
-        _fontHasWesternScript = FontHasWesternScript(_hdcMemoryContext);
+        return;
     }
 
-    return S_OK;
+    switch (fontType)
+    {
+    case FontType::Soft:
+        SelectFont(_hdcMemoryContext, _softFont);
+        break;
+    case FontType::Italic:
+        SelectFont(_hdcMemoryContext, _hfontItalic);
+        break;
+    case FontType::Default:
+    default:
+        SelectFont(_hdcMemoryContext, _hfont);
+        break;
+    }
+    _selectedFontType = fontType;
+    _fontHasWesternScript = FontHasWesternScript(_hdcMemoryContext);
 }
 
 // Routine Description:
@@ -333,11 +335,17 @@ GdiEngine::~GdiEngine()
 // - S_OK if set successfully or relevant GDI error via HRESULT.
 [[nodiscard]] HRESULT GdiEngine::UpdateFont(const FontInfoDesired& FontDesired, _Out_ FontInfo& Font) noexcept
 {
+    // Any pending lines need to be drawn before we delete the fonts they're using.
+    LOG_IF_FAILED(_FlushBufferLines());
+
     wil::unique_hfont hFont, hFontItalic;
     RETURN_IF_FAILED(_GetProposedFont(FontDesired, Font, _iCurrentDpi, hFont, hFontItalic));
 
     // Select into DC
     RETURN_HR_IF_NULL(E_FAIL, SelectFont(_hdcMemoryContext, hFont.get()));
+    // hFont becomes the new _hfont below.
+    _selectedFontType = FontType::Default;
+    _fontHasWesternScript = FontHasWesternScript(_hdcMemoryContext);
 
     // Save off the font metrics for various other calculations
     RETURN_HR_IF(E_FAIL, !(GetTextMetricsW(_hdcMemoryContext, &_tmFontMetrics)));
@@ -444,12 +452,19 @@ GdiEngine::~GdiEngine()
                                                 const til::size cellSize,
                                                 const size_t centeringHint) noexcept
 {
+    // Any pending lines in the soft font need to be drawn with the pattern they were written with.
+    LOG_IF_FAILED(_FlushBufferLines());
+
     // If we previously called SelectFont(_hdcMemoryContext, _softFont), it will
     // still hold a reference to the _softFont object we're planning to overwrite.
     // --> First revert back to the standard _hfont, lest we have dangling pointers.
-    if (_lastFontType == FontType::Soft)
+    if (_selectedFontType == FontType::Soft)
     {
         RETURN_HR_IF_NULL(E_FAIL, SelectFont(_hdcMemoryContext, _hfont));
+        _selectedFontType = FontType::Default;
+    }
+    if (_lastFontType == FontType::Soft)
+    {
         _lastFontType = FontType::Default;
     }
 
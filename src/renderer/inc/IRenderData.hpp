@@ -46,6 +46,7 @@ namespace Microsoft::Console::Render
         virtual til::point GetTextBufferEndPosition() const noexcept = 0;
         virtual const TextBuffer& GetTextBuffer() const noexcept = 0;
         virtual const FontInfo& GetFontInfo() const noexcept = 0;
+        // Only the rows within GetViewport() need to be returned.
         virtual std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept = 0;
         virtual void LockConsole() noexcept = 0;
         virtual void UnlockConsole() noexcept = 0;
@@ -64,6 +65,7 @@ namespace Microsoft::Console::Render
         virtual const std::wstring GetHyperlinkUri(uint16_t id) const = 0;
         virtual const std::wstring GetHyperlinkCustomId(uint16_t id) const = 0;
         virtual const std::vector<size_t> GetPatternId(const til::point location) const = 0;
+        virtual bool HasPatternsInRow(const til::CoordType row) const = 0;
 
         // This block used to be IUiaData.
         virtual std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept = 0;
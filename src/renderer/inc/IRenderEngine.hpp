@@ -21,6 +21,7 @@ Author(s):
 #include "FontInfoDesired.hpp"
 #include "IRenderData.hpp"
 #include "RenderSettings.hpp"
+#include "../../buffer/out/ImageSlice.hpp"
 #include "../../buffer/out/LineRendition.hpp"
 
 #pragma warning(push)
@@ -32,6 +33,13 @@ namespace Microsoft::Console::Render
         std::optional<CursorOptions> cursorInfo;
     };
 
+    // The memory held by a render engine in bytes, as returned by IRenderEngine::GetMemoryUsage().
+    struct RenderEngineMemoryUsage
+    {
+        size_t glyphAtlas = 0;
+        size_t swapChain = 0;
+    };
+
     enum class GridLines
     {
         None,
@@ -64,6 +72,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT InvalidateSystem(const til::rect* prcDirtyClient) noexcept = 0;
         [[nodiscard]] virtual HRESULT InvalidateSelection(const std::vector<til::rect>& rectangles) noexcept = 0;
         [[nodiscard]] virtual HRESULT InvalidateScroll(const til::point* pcoordDelta) noexcept = 0;
+        [[nodiscard]] virtual HRESULT InvalidateScrollRegion(const til::rect* psrRegion, til::CoordType delta) noexcept = 0;
         [[nodiscard]] virtual HRESULT InvalidateAll() noexcept = 0;
         [[nodiscard]] virtual HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept = 0;
         [[nodiscard]] virtual HRESULT InvalidateTitle(std::wstring_view proposedTitle) noexcept = 0;
@@ -74,6 +83,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT PaintBackground() noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept = 0;
+        [[nodiscard]] virtual HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice, til::CoordType targetRow, til::CoordType viewportLeft) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintSelection(const til::rect& rect) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintCursor(const CursorOptions& options) noexcept = 0;
         [[nodiscard]] virtual HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> pData, bool usingSoftFont, bool isSettingDefaultBrushes) noexcept = 0;
@@ -104,6 +114,8 @@ namespace Microsoft::Console::Render
         virtual void SetForceFullRepaintRendering(bool enable) noexcept {}
         [[nodiscard]] virtual HRESULT SetHwnd(const HWND hwnd) noexcept { return E_NOTIMPL; }
         virtual void SetPixelShaderPath(std::wstring_view value) noexcept {}
+        virtual void SetPixelShaderPartialRedraw(bool enable) noexcept {}
+        virtual void SetPixelShaderMaxFrameRate(int32_t fps) noexcept {}
         virtual void SetRetroTerminalEffect(bool enable) noexcept {}
         virtual void SetSelectionBackground(const COLORREF color, const float alpha = 0.5f) noexcept {}
         virtual void SetSoftwareRendering(bool enable) noexcept {}
@@ -111,6 +123,10 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT SetWindowSize(const til::size pixels) noexcept { return E_NOTIMPL; }
         [[nodiscard]] virtual HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept { return E_NOTIMPL; }
         virtual void UpdateHyperlinkHoveredId(const uint16_t hoveredId) noexcept {}
+        // Releases caches and GPU resources that can be recreated on demand. Must only be called while painting is disabled.
+        virtual void TrimMemory() noexcept {}
+        // Unlike most other methods, this one may be called on any thread at any time.
+        [[nodiscard]] virtual RenderEngineMemoryUsage GetMemoryUsage() const noexcept { return {}; }
     };
 }
 #pragma warning(pop)
@@ -41,10 +41,16 @@ namespace Microsoft::Console::Render
                                                    const til::CoordType targetRow,
                                                    const til::CoordType viewportLeft) noexcept override;
 
+        [[nodiscard]] HRESULT PaintImageSlice(const ImageSlice::Pointer& imageSlice,
+                                              const til::CoordType targetRow,
+                                              const til::CoordType viewportLeft) noexcept override;
+
         [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
 
         [[nodiscard]] HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept override;
 
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const til::rect* const psrRegion, const til::CoordType delta) noexcept override;
+
         void WaitUntilCanRender() noexcept override;
 
     protected:
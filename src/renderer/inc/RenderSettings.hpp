@@ -44,11 +44,27 @@ namespace Microsoft::Console::Render
         void ToggleBlinkRendition(class Renderer& renderer) noexcept;
 
     private:
+        struct PerceivableColorCacheEntry
+        {
+            COLORREF fg = 0;
+            COLORREF bg = 0;
+            COLORREF adjustedFg = 0;
+        };
+
+        COLORREF _getPerceivableColor(const COLORREF fg, const COLORREF bg) const noexcept;
+        COLORREF _resolveColor(const TextColor color, const size_t defaultIndex, const bool brighten) const noexcept;
+        void _updateBrightDefaultForeground() noexcept;
+
         til::enumset<Mode> _renderMode{ Mode::BlinkAllowed, Mode::IntenseIsBright };
         std::array<COLORREF, TextColor::TABLE_SIZE> _colorTable;
-        std::array<size_t, static_cast<size_t>(ColorAlias::ENUM_COUNT)> _colorAliasIndices;
+        std::array<size_t, static_cast<size_t>(ColorAlias::ENUM_COUNT)> _colorAliasIndices{};
+        // The result of TextColor::GetColor() for an intense default foreground, which
+        // needs to search the color table and is thus updated whenever the table changes.
+        COLORREF _brightDefaultForeground = 0;
         size_t _blinkCycle = 0;
         mutable bool _blinkIsInUse = false;
         bool _blinkShouldBeFaint = false;
+        // A direct-mapped cache of ColorFix::GetPerceivableColor() results, indexed by a hash of fg and bg.
+        mutable std::array<PerceivableColorCacheEntry, 256> _perceivableColorCache{};
     };
 }
@@ -0,0 +1,19 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RenderTracing.hpp
+
+Abstract:
+- Declares the TraceLogging provider shared by the Renderer and the render engines
+  to mark the stages of painting a frame with TIL_TRACE_REGION.
+- The provider is registered for as long as a Renderer instance exists.
+--*/
+
+#pragma once
+
+#include <winmeta.h>
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DECLARE_PROVIDER(g_hRenderProvider);
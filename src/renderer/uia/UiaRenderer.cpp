@@ -19,6 +19,7 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     _selectionChanged{ false },
     _textBufferChanged{ false },
     _cursorChanged{ false },
+    _clientsListening{ false },
     _isEnabled{ true },
     _prevSelection{},
     _prevCursorRegion{},
@@ -168,10 +169,19 @@ CATCH_RETURN();
     return S_OK;
 }
 
+// Routine Description:
+// - Queues up the given text to be announced to automation clients with the next frame.
+// - The text is dropped if no client was listening during the last frame. That way we
+//   don't copy all output just to throw it away, and clients that only just appeared
+//   will get their announcements starting with the next frame.
+// Arguments:
+// - newText - the text that was written to the buffer
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate.
 [[nodiscard]] HRESULT UiaEngine::NotifyNewText(const std::wstring_view newText) noexcept
 try
 {
-    if (!newText.empty())
+    if (_clientsListening && !newText.empty())
     {
         _newOutput.append(newText);
         _newOutput.push_back(L'\n');
@@ -205,6 +215,9 @@ CATCH_LOG_RETURN_HR(E_FAIL);
 {
     RETURN_HR_IF(S_FALSE, !_isEnabled);
 
+    // This is checked once per frame instead of in NotifyNewText(), which is called for every write.
+    _clientsListening = UiaClientsAreListening() != FALSE;
+
     // add more events here
     const auto somethingToDo = _selectionChanged || _textBufferChanged || _cursorChanged || !_queuedOutput.empty();
 
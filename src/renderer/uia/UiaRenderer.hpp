@@ -70,6 +70,7 @@ namespace Microsoft::Console::Render
         bool _selectionChanged;
         bool _textBufferChanged;
         bool _cursorChanged;
+        bool _clientsListening;
         std::wstring _newOutput;
         std::wstring _queuedOutput;
 
@@ -7,5 +7,6 @@
 #include "LibraryIncludes.h"
 
 #include <windows.h>
+#include <UIAutomationCore.h>
 
 #pragma hdrstop
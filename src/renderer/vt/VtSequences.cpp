@@ -160,6 +160,53 @@ using namespace Microsoft::Console::Render;
     return _InsertDeleteLine(sLines, true);
 }
 
+// Method Description:
+// - Formats and writes a DECSTBM sequence to limit scrolling to the given
+//      rows. Note that this also moves the cursor to the home position.
+// Arguments:
+// - top: the first row of the scrolling region, in console coordinates
+// - bottom: the row below the last row of the scrolling region
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_SetTopBottomMargins(const til::CoordType top, const til::CoordType bottom) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{};{}r"), top + 1, bottom);
+}
+
+// Method Description:
+// - Formats and writes a DECSTBM sequence to make the whole screen scrollable
+//      again. Note that this also moves the cursor to the home position.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ResetTopBottomMargins() noexcept
+{
+    return _Write("\x1b[r");
+}
+
+// Method Description:
+// - Formats and writes a sequence to scroll the contents of the scrolling
+//      region up (SU) or down (SD) by a number of lines.
+// Arguments:
+// - sLines: a number of lines to scroll by
+// - fScrollUp: true iff we should scroll the contents up, false to scroll down.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ScrollUpDown(const til::CoordType sLines, const bool fScrollUp) noexcept
+{
+    if (sLines <= 0)
+    {
+        return S_OK;
+    }
+    if (sLines == 1)
+    {
+        return _Write(fScrollUp ? "\x1b[S" : "\x1b[T");
+    }
+
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}{}"), sLines, fScrollUp ? 'S' : 'T');
+}
+
 // Method Description:
 // - Formats and writes a sequence to move the cursor to the specified
 //      coordinate position. The input coord should be in console coordinates,
@@ -34,6 +34,8 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 {
     RETURN_HR_IF(S_FALSE, _passthrough && isSettingDefaultBrushes);
 
+    RETURN_IF_FAILED(_ResetIfShorter(textAttributes));
+
     RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
 
     RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
@@ -148,6 +150,132 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
     return S_OK;
 }
 
+// Routine Description:
+// - Turning off attributes one by one costs a sequence each. If resetting them all
+//   with a SGR 0 and then turning on those that are still needed is shorter,
+//   write the SGR 0 now, so that the following updates only have to turn things on.
+// - _RgbUpdateDrawingBrushes already resets if both colors become the default,
+//   which makes this only relevant if at least one of the colors isn't.
+// Arguments:
+// - textAttributes - The attributes we're about to switch to.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT Xterm256Engine::_ResetIfShorter(const TextAttribute& textAttributes) noexcept
+{
+    static const TextAttribute defaultAttrs{};
+
+    const auto fg = textAttributes.GetForeground();
+    const auto bg = textAttributes.GetBackground();
+    const auto lastFg = _lastTextAttributes.GetForeground();
+    const auto lastBg = _lastTextAttributes.GetBackground();
+
+    if (fg.IsDefault() && bg.IsDefault())
+    {
+        return S_OK;
+    }
+
+    const auto updateLength = (fg != lastFg ? _ColorSequenceLength(fg, true) : 0) +
+                              (bg != lastBg ? _ColorSequenceLength(bg, false) : 0) +
+                              _ExtendedAttrsSequenceLength(_lastTextAttributes, textAttributes);
+    const auto resetLength = strlen("\x1b[m") +
+                             (fg.IsDefault() ? 0 : _ColorSequenceLength(fg, true)) +
+                             (bg.IsDefault() ? 0 : _ColorSequenceLength(bg, false)) +
+                             _ExtendedAttrsSequenceLength(defaultAttrs, textAttributes);
+
+    if (resetLength < updateLength)
+    {
+        // Same as in _RgbUpdateDrawingBrushes: SGR 0 doesn't reset the hyperlink ID.
+        RETURN_IF_FAILED(_SetGraphicsDefault());
+        _lastTextAttributes.SetDefaultBackground();
+        _lastTextAttributes.SetDefaultForeground();
+        _lastTextAttributes.SetDefaultRenditionAttributes();
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Returns the length of the sequence _RgbUpdateDrawingBrushes writes for the given color.
+// Arguments:
+// - color - The color to write.
+// - isForeground - Whether it's the foreground or the background color.
+// Return Value:
+// - The length of the sequence in bytes.
+size_t Xterm256Engine::_ColorSequenceLength(const TextColor& color, const bool isForeground) noexcept
+{
+    const auto digits = [](const unsigned int value) noexcept -> size_t {
+        return value >= 100 ? 3 : value >= 10 ? 2 : 1;
+    };
+
+    if (color.IsIndex16())
+    {
+        // \x1b[31m, \x1b[91m, \x1b[41m or \x1b[101m
+        return !isForeground && WI_IsFlagSet(color.GetIndex(), FOREGROUND_INTENSITY) ? 6 : 5;
+    }
+    if (color.IsIndex256())
+    {
+        // \x1b[38;5;123m
+        return 8 + digits(color.GetIndex());
+    }
+    if (color.IsRgb())
+    {
+        // \x1b[38;2;1;2;3m
+        const auto rgb = color.GetRGB();
+        return 10 + digits(GetRValue(rgb)) + digits(GetGValue(rgb)) + digits(GetBValue(rgb));
+    }
+    // \x1b[39m
+    return 5;
+}
+
+// Routine Description:
+// - Returns the length of the sequences _UpdateExtendedAttrs writes
+//   to switch from one set of rendition attributes to another.
+// Arguments:
+// - last - The attributes the terminal currently uses.
+// - next - The attributes to switch to.
+// Return Value:
+// - The combined length of the sequences in bytes.
+size_t Xterm256Engine::_ExtendedAttrsSequenceLength(const TextAttribute& last, const TextAttribute& next) noexcept
+{
+    // Most "on" sequences are 4 bytes long (\x1b[1m) and all "off" sequences are 5 (\x1b[22m).
+    static constexpr size_t on = 4;
+    static constexpr size_t off = 5;
+    size_t length = 0;
+
+    auto intense = last.IsIntense();
+    auto faint = last.IsFaint();
+    if ((!next.IsIntense() && intense) || (!next.IsFaint() && faint))
+    {
+        length += off;
+        intense = false;
+        faint = false;
+    }
+    length += next.IsIntense() && !intense ? on : 0;
+    length += next.IsFaint() && !faint ? on : 0;
+
+    auto underlined = last.IsUnderlined();
+    auto doublyUnderlined = last.IsDoublyUnderlined();
+    if ((!next.IsUnderlined() && underlined) || (!next.IsDoublyUnderlined() && doublyUnderlined))
+    {
+        length += off;
+        underlined = false;
+        doublyUnderlined = false;
+    }
+    length += next.IsUnderlined() && !underlined ? on : 0;
+    length += next.IsDoublyUnderlined() && !doublyUnderlined ? on + 1 : 0;
+
+    const auto toggle = [](const bool from, const bool to, const size_t onLength) noexcept -> size_t {
+        return from == to ? 0 : to ? onLength : off;
+    };
+    length += toggle(last.IsOverlined(), next.IsOverlined(), on + 1);
+    length += toggle(last.IsItalic(), next.IsItalic(), on);
+    length += toggle(last.IsBlinking(), next.IsBlinking(), on);
+    length += toggle(last.IsInvisible(), next.IsInvisible(), on);
+    length += toggle(last.IsCrossedOut(), next.IsCrossedOut(), on);
+    length += toggle(last.IsReverseVideo(), next.IsReverseVideo(), on);
+    return length;
+}
+
 // Routine Description:
 // - Write a VT sequence to start/stop a hyperlink
 // Arguments:
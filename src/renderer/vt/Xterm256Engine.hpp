@@ -42,6 +42,9 @@ namespace Microsoft::Console::Render
 
     private:
         [[nodiscard]] HRESULT _UpdateExtendedAttrs(const TextAttribute& textAttributes) noexcept;
+        [[nodiscard]] HRESULT _ResetIfShorter(const TextAttribute& textAttributes) noexcept;
+        static size_t _ColorSequenceLength(const TextColor& color, const bool isForeground) noexcept;
+        static size_t _ExtendedAttrsSequenceLength(const TextAttribute& last, const TextAttribute& next) noexcept;
         [[nodiscard]] HRESULT _UpdateHyperlinkAttr(const TextAttribute& textAttributes,
                                                    const gsl::not_null<IRenderData*> pData) noexcept;
 
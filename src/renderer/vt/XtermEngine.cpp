@@ -64,6 +64,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _InvalidateShadow();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -351,6 +352,10 @@ try
 {
     _trace.TraceScrollFrame(_scrollDelta);
 
+    // Any scroll within a region happened before the whole viewport scrolled.
+    // See InvalidateScrollRegion.
+    RETURN_IF_FAILED(_ScrollRegionFrame());
+
     if (_scrollDelta.x != 0)
     {
         // No easy way to shift left-right. Everything needs repainting.
@@ -365,6 +370,10 @@ try
     const auto dy = _scrollDelta.y;
     const auto absDy = abs(dy);
 
+    // The rows we know about in the terminal are moving. Rather than shifting
+    // the shadow copy along, we simply start over. See _TrimUnchangedClusters().
+    _InvalidateShadow();
+
     // Save the old wrap state here. We're going to clear it so that
     // _MoveCursor will definitely move us to the right position. We'll
     // restore the state afterwards.
@@ -489,6 +498,121 @@ try
 }
 CATCH_RETURN();
 
+// Routine Description:
+// - Notifies us that the console scrolled the rows within the given region,
+//      for instance because the client set scrolling margins with DECSTBM.
+//      Instead of repainting the whole region, we'll ask the terminal to scroll
+//      it as well and only repaint the rows that were revealed. This makes
+//      build-log style output with a status line considerably cheaper.
+// - We only keep track of a single region per frame. If the client scrolls
+//      a different region or in the opposite direction before we paint, or
+//      we're in a state we can't shift (line renditions, a pending viewport
+//      scroll), we return S_FALSE and the renderer invalidates the region.
+// Arguments:
+// - psrRegion - the scrolled rows, relative to the viewport, spanning its full width
+// - delta - the distance the rows moved (positive is down, negative is up)
+// Return Value:
+// - S_OK if we'll scroll the region, S_FALSE if it needs to be repainted.
+[[nodiscard]] HRESULT XtermEngine::InvalidateScrollRegion(const til::rect* const psrRegion, const til::CoordType delta) noexcept
+try
+{
+    const auto region = *psrRegion;
+    const auto height = region.height();
+
+    if (delta == 0 || std::abs(delta) >= height ||
+        _scrollDelta != til::point{ 0, 0 } ||
+        _usingLineRenditions ||
+        _invalidMap.all())
+    {
+        return S_FALSE;
+    }
+
+    if (_regionScrollDelta != 0 &&
+        (region.top != _regionScrollTop || region.bottom != _regionScrollBottom || (delta < 0) != (_regionScrollDelta < 0)))
+    {
+        return S_FALSE;
+    }
+
+    _trace.TraceInvalidateScroll({ 0, delta });
+
+    // Cells that are still waiting to be painted move along with the scrolled
+    // rows. The bitmap's runs never span more than a single row, so each one
+    // is either entirely within the region or entirely outside of it.
+    const std::vector<til::rect> runs{ _invalidMap.begin(), _invalidMap.end() };
+    _invalidMap.reset_all();
+    for (auto run : runs)
+    {
+        if (run.top >= region.top && run.top < region.bottom)
+        {
+            run.top += delta;
+            run.bottom += delta;
+            if (run.top < region.top || run.top >= region.bottom)
+            {
+                continue;
+            }
+        }
+        _invalidMap.set(run);
+    }
+
+    // The rows revealed by the scroll need to be painted.
+    auto revealed = region;
+    if (delta < 0)
+    {
+        revealed.top = region.bottom + delta;
+    }
+    else
+    {
+        revealed.bottom = region.top + delta;
+    }
+    _invalidMap.set(revealed);
+
+    _regionScrollTop = region.top;
+    _regionScrollBottom = region.bottom;
+    _regionScrollDelta = std::clamp(_regionScrollDelta + delta, -height, height);
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Emits the region scroll accumulated by InvalidateScrollRegion: we set the
+//      terminal's margins to the region, scroll its contents with SU/SD and
+//      reset the margins again. Both DECSTBM sequences home the cursor.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT XtermEngine::_ScrollRegionFrame() noexcept
+{
+    const auto delta = _regionScrollDelta;
+    if (delta == 0)
+    {
+        return S_OK;
+    }
+    _regionScrollDelta = 0;
+
+    // If everything is getting repainted anyway, the scroll is pointless.
+    if (_invalidMap.all())
+    {
+        return S_OK;
+    }
+
+    // The rows we know about in the terminal are moving. See ScrollFrame().
+    _InvalidateShadow();
+
+    RETURN_IF_FAILED(_SetTopBottomMargins(_regionScrollTop, _regionScrollBottom));
+    RETURN_IF_FAILED(_ScrollUpDown(std::abs(delta), delta < 0));
+    RETURN_IF_FAILED(_ResetTopBottomMargins());
+
+    _lastText = { 0, 0 };
+    _delayedEolWrap = false;
+    if (_wrappedRow.has_value() && _wrappedRow.value() >= _regionScrollTop && _wrappedRow.value() < _regionScrollBottom)
+    {
+        _wrappedRow = std::nullopt;
+    }
+
+    return S_OK;
+}
+
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8 or ASCII only, depending on the VtIoMode.
@@ -509,9 +633,23 @@ CATCH_RETURN();
                                                    const bool /*trimLeft*/,
                                                    const bool lineWrapped) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
-               VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped);
+    if (_fUseAsciiOnly)
+    {
+        return VtEngine::_PaintAsciiBufferLine(clusters, coord);
+    }
+
+    // Only paint the part of the run that differs from what the terminal already displays.
+    auto changedClusters = clusters;
+    auto changedCoord = coord;
+    auto changedLineWrapped = lineWrapped;
+    if (!_TrimUnchangedClusters(changedClusters, changedCoord, changedLineWrapped))
+    {
+        return S_OK;
+    }
+
+    RETURN_IF_FAILED(VtEngine::_PaintUtf8BufferLine(changedClusters, changedCoord, changedLineWrapped));
+    _UpdateShadow(clusters, coord);
+    return S_OK;
 }
 
 // Method Description:
@@ -523,6 +661,8 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // We don't know what this string will do to the terminal contents.
+    _InvalidateShadow();
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
@@ -50,6 +50,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
 
         [[nodiscard]] HRESULT InvalidateScroll(const til::point* const pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const til::rect* const psrRegion, const til::CoordType delta) noexcept override;
 
         [[nodiscard]] HRESULT WriteTerminalW(const std::wstring_view str) noexcept override;
 
@@ -71,6 +72,7 @@ namespace Microsoft::Console::Render
         bool _nextCursorIsVisible;
 
         [[nodiscard]] HRESULT _MoveCursor(const til::point coord) noexcept override;
+        [[nodiscard]] HRESULT _ScrollRegionFrame() noexcept;
 
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
 
@@ -118,6 +118,11 @@ CATCH_RETURN();
         // Keep track of the fact that we circled, we'll need to do some work on
         //      end paint to specifically handle this.
         _circled = circled;
+        if (circled)
+        {
+            // Circling scrolls the terminal contents. See _TrimUnchangedClusters().
+            _InvalidateShadow();
+        }
     }
 
     // If we flushed for any reason other than circling (i.e, a sequence that we
@@ -140,5 +145,7 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
-    return S_OK;
+    // The host may exit right after the final paint, so it must not leave a write in flight.
+    _flushSynchronously = true;
+    return _WaitForFlush();
 }
@@ -7,6 +7,8 @@
 #include "../../inc/conattrs.hpp"
 #include "../../types/inc/convert.hpp"
 
+#include <til/hash.h>
+
 #pragma hdrstop
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
@@ -32,6 +34,7 @@ using namespace Microsoft::Console::Types;
     // If there's nothing to do, quick return
     auto somethingToDo = _invalidMap.any() ||
                          _scrollDelta != til::point{ 0, 0 } ||
+                         _regionScrollDelta != 0 ||
                          _cursorMoved ||
                          _titleChanged;
 
@@ -113,6 +116,30 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Blocks the render thread until the terminal has read the previous frame.
+// - This happens before the renderer takes the console lock for the next
+//      frame, so the client can keep writing in the meantime. Its changes pile
+//      up in our invalid map and get painted as a single frame of the latest
+//      buffer state, instead of the client stalling in EndPaint's _Flush()
+//      while we emit every intermediate frame. Under backpressure the output
+//      thus stays as responsive as the terminal allows (e.g. to Ctrl+C).
+// - Frames forced by circling or teardown are painted from other threads
+//      and still wait for the terminal, as their contents would be lost otherwise.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::WaitUntilCanRender() noexcept
+{
+    if (_flushPending.load(std::memory_order_relaxed))
+    {
+        WaitForThreadpoolWorkCallbacks(_flushWork.get(), FALSE);
+    }
+
+    RenderEngineBase::WaitUntilCanRender();
+}
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
@@ -656,6 +683,173 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Turns a cluster into the value we store in a ShadowCell. Short clusters
+//   (the vast majority) are stored verbatim and longer ones are hashed.
+// Arguments:
+// - cluster - The cluster to encode.
+// Return Value:
+// - A non-zero value that's equal for equal clusters.
+uint64_t VtEngine::_ShadowText(const Cluster& cluster) noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = gsl::narrow_cast<uint8_t>(cluster.GetColumns());
+
+    if (text.size() <= 3)
+    {
+        // 8 bits of columns followed by up to 3 UTF-16 code units. Bit 63 marks the cell as known.
+        uint64_t value = uint64_t{ 1 } << 63 | columns;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            value |= uint64_t{ til::at(text, i) } << (8 + 16 * i);
+        }
+        return value;
+    }
+
+    til::hasher h;
+    h.write(text.data(), text.size());
+    h.write(&columns, 1);
+    // Bit 62 separates hashed from verbatim clusters and ensures the value is never 0.
+    return (h.finalize() | uint64_t{ 1 } << 62) & ~(uint64_t{ 1 } << 63);
+}
+
+// Routine Description:
+// - Compares the given run against the shadow copy of what we've last emitted and
+//   trims any leading and trailing clusters, which the terminal already displays
+//   with the current attributes. Only the part in between needs to be painted.
+// - Whenever the terminal contents might've moved or changed behind our back
+//   (scrolling, clearing, resizing, passthrough, ...) _InvalidateShadow() is called
+//   and the run is painted in full again.
+// Arguments:
+// - clusters - The run to paint. Trimmed in place.
+// - coord - The position of the run. Adjusted to the start of the trimmed run.
+// - lineWrapped - Whether the run ends in a wrapped line. Cleared if the end got trimmed.
+// Return Value:
+// - false if the entire run is unchanged and nothing needs to be painted.
+bool VtEngine::_TrimUnchangedClusters(std::span<const Cluster>& clusters, til::point& coord, bool& lineWrapped) noexcept
+{
+    // Line renditions and soft fonts change how the terminal interprets the text we send.
+    if (_usingLineRenditions || _usingSoftFont || _passthrough || coord.y < _virtualTop)
+    {
+        return true;
+    }
+
+    const auto size = _lastViewport.Dimensions();
+    if (_shadowSize != size || coord.y < 0 || coord.y >= size.height || coord.x < 0)
+    {
+        return true;
+    }
+
+    const auto row = _shadow.begin() + gsl::narrow_cast<ptrdiff_t>(coord.y) * size.width;
+    const auto matches = [&](const Cluster& cluster, til::CoordType x) noexcept {
+        if (x >= size.width)
+        {
+            return false;
+        }
+        const auto& cell = row[x];
+        return cell.text == _ShadowText(cluster) && cell.attributes == _lastTextAttributes;
+    };
+
+    size_t beg = 0;
+    auto x = coord.x;
+    for (; beg < clusters.size() && matches(til::at(clusters, beg), x); ++beg)
+    {
+        x += til::at(clusters, beg).GetColumns();
+    }
+
+    if (beg == clusters.size())
+    {
+        return false;
+    }
+
+    // Find the end of the changed part by walking forward from `beg`, remembering
+    // the column after the last cluster that differs. Clusters can be wide,
+    // so we can't easily walk backwards from the end of the run.
+    auto end = beg + 1;
+    auto endX = x + til::at(clusters, beg).GetColumns();
+    {
+        auto x2 = endX;
+        for (auto i = end; i < clusters.size(); ++i)
+        {
+            const auto& cluster = til::at(clusters, i);
+            x2 += cluster.GetColumns();
+            if (!matches(cluster, x2 - cluster.GetColumns()))
+            {
+                end = i + 1;
+                endX = x2;
+            }
+        }
+    }
+
+    if (end != clusters.size())
+    {
+        lineWrapped = false;
+    }
+
+    clusters = clusters.subspan(beg, end - beg);
+    coord.x = x;
+    return true;
+}
+
+// Routine Description:
+// - Records the given run as what the terminal now displays. See _TrimUnchangedClusters().
+// Arguments:
+// - clusters - The run that was painted.
+// - coord - The position of the run.
+void VtEngine::_UpdateShadow(const std::span<const Cluster> clusters, const til::point coord) noexcept
+try
+{
+    if (_usingLineRenditions || _usingSoftFont || _passthrough)
+    {
+        _InvalidateShadow();
+        return;
+    }
+    if (coord.y < _virtualTop)
+    {
+        return;
+    }
+
+    const auto size = _lastViewport.Dimensions();
+    if (_shadowSize != size)
+    {
+        _shadow.assign(gsl::narrow_cast<size_t>(size.area()), {});
+        _shadowSize = size;
+    }
+
+    if (coord.y < 0 || coord.y >= size.height || coord.x < 0)
+    {
+        return;
+    }
+
+    const auto row = _shadow.begin() + gsl::narrow_cast<ptrdiff_t>(coord.y) * size.width;
+    auto x = coord.x;
+    for (const auto& cluster : clusters)
+    {
+        const auto columns = cluster.GetColumns();
+        const auto text = _ShadowText(cluster);
+        for (til::CoordType i = 0; i < columns && x < size.width; ++i, ++x)
+        {
+            // Only the leading cell of a wide glyph holds its text. The trailing one stays
+            // unknown so that whatever gets painted over it later can't be mistaken as unchanged.
+            row[x] = { i == 0 ? text : 0, _lastTextAttributes };
+        }
+    }
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    _InvalidateShadow();
+}
+
+// Routine Description:
+// - Forgets everything we know about the terminal contents, because it
+//   might've moved or changed without us painting it.
+void VtEngine::_InvalidateShadow() noexcept
+{
+    _shadow.clear();
+    _shadowSize = {};
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
@@ -5,6 +5,7 @@
 #include "vtrenderer.hpp"
 #include "../../inc/conattrs.hpp"
 #include "../../host/VtIo.hpp"
+#include "../../inc/VtSharedMemory.h"
 
 // For _vcprintf
 #include <conio.h>
@@ -65,6 +66,11 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    // This is created upfront, because WaitUntilCanRender() waits on
+    // it from the render thread without holding the console lock.
+    _flushWork.reset(CreateThreadpoolWork(&_FlushWorkCallback, this, nullptr));
+    THROW_LAST_ERROR_IF(!_flushWork);
 }
 
 // Method Description:
@@ -140,27 +146,92 @@ CATCH_RETURN();
 {
     if (_hFile)
     {
-        auto fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        // Only one write can be in flight at a time. If the terminal hasn't
+        // finished reading the previous one yet, this is where we block.
+        RETURN_IF_FAILED(_WaitForFlush());
+
+        if (_buffer.empty())
+        {
+            return S_OK;
+        }
+
+        std::swap(_buffer, _flushBuffer);
         _buffer.clear();
-        if (!fSuccess)
+        _flushPending.store(true, std::memory_order_relaxed);
+        SubmitThreadpoolWork(_flushWork.get());
+
+        if (_flushSynchronously)
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _hFile.reset();
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
-            return _exitResult;
+            RETURN_IF_FAILED(_WaitForFlush());
+        }
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Waits for the write submitted by the previous _Flush() call to finish.
+//   If it's still in flight, the time spent waiting is reported
+//   via RenderTracing::TraceFlushBackpressure.
+// - If the write failed, we'll stop writing to the pipe and tell the VtIo.
+// Return Value:
+// - S_OK or the error of the previous write.
+[[nodiscard]] HRESULT VtEngine::_WaitForFlush() noexcept
+{
+    if (!_flushWork)
+    {
+        return S_OK;
+    }
+
+    if (_flushPending.load(std::memory_order_relaxed))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        WaitForThreadpoolWorkCallbacks(_flushWork.get(), FALSE);
+        _trace.TraceFlushBackpressure(_flushBuffer.size(), std::chrono::steady_clock::now() - start);
+    }
+    else
+    {
+        WaitForThreadpoolWorkCallbacks(_flushWork.get(), FALSE);
+    }
+
+    if (FAILED(_flushResult))
+    {
+        _exitResult = std::exchange(_flushResult, S_OK);
+        _hFile.reset();
+        if (_terminalOwner)
+        {
+            _terminalOwner->CloseOutput();
         }
+        return _exitResult;
     }
 
     return S_OK;
 }
 
+void CALLBACK VtEngine::_FlushWorkCallback(PTP_CALLBACK_INSTANCE, void* context, PTP_WORK) noexcept
+{
+    const auto self = static_cast<VtEngine*>(context);
+    if (self->_sharedMemory)
+    {
+        // Write() only fails once the terminal closed the connection, which is our broken pipe.
+        if (!self->_sharedMemory->Write(self->_flushBuffer))
+        {
+            self->_flushResult = HRESULT_FROM_WIN32(ERROR_BROKEN_PIPE);
+        }
+    }
+    else if (!WriteFile(self->_hFile.get(), self->_flushBuffer.data(), gsl::narrow_cast<DWORD>(self->_flushBuffer.size()), nullptr, nullptr))
+    {
+        self->_flushResult = HRESULT_FROM_WIN32(GetLastError());
+    }
+    self->_flushPending.store(false, std::memory_order_relaxed);
+}
+
 // Method Description:
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    // We don't know what this string will do to the terminal contents.
+    _InvalidateShadow();
     return _Write(str);
 }
 
@@ -503,6 +574,17 @@ void VtEngine::SetPassthroughMode(const bool passthrough) noexcept
     _passthrough = passthrough;
 }
 
+// Method Description:
+// - Makes the renderer write its output into the given VtSharedMemory section
+//   instead of the pipe. The pipe is still required though, because it's
+//   what the rest of the engine checks to see whether the terminal is still there.
+// Arguments:
+// - sharedMemory - The client end of the section that VtIo was started with.
+void VtEngine::SetSharedMemory(std::shared_ptr<VtSharedMemory::Client> sharedMemory) noexcept
+{
+    _sharedMemory = std::move(sharedMemory);
+}
+
 void VtEngine::SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept
 {
     _pfnSetLookingForDSR = pfnLooking;
@@ -552,6 +634,7 @@ HRESULT VtEngine::RequestWin32Input() noexcept
 
 HRESULT VtEngine::SwitchScreenBuffer(const bool useAltBuffer) noexcept
 {
+    _InvalidateShadow();
     RETURN_IF_FAILED(_SwitchScreenBuffer(useAltBuffer));
     RETURN_IF_FAILED(_Flush());
     return S_OK;
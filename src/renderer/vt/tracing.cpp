@@ -229,6 +229,26 @@ void RenderTracing::TraceEndPaint() const
 #endif UNIT_TESTING
 }
 
+void RenderTracing::TraceFlushBackpressure(const size_t pendingBytes, const std::chrono::steady_clock::duration waited) const
+{
+#ifndef UNIT_TESTING
+    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    {
+        const auto waitedUs = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                          "VtEngine_TraceFlushBackpressure",
+                          TraceLoggingDescription("The terminal was still reading the previous frame when the next one was ready"),
+                          TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(pendingBytes), "pendingBytes"),
+                          TraceLoggingInt64(waitedUs, "waitedUs"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+#else
+    UNREFERENCED_PARAMETER(pendingBytes);
+    UNREFERENCED_PARAMETER(waited);
+#endif UNIT_TESTING
+}
+
 void RenderTracing::TraceLastText(const til::point lastTextPos) const
 {
 #ifndef UNIT_TESTING
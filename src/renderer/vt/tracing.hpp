@@ -10,6 +10,7 @@ Abstract:
 --*/
 
 #pragma once
+#include <chrono>
 #include <string>
 #include <windows.h>
 #include <winmeta.h>
@@ -46,5 +47,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const bool cursorMoved,
                              const std::optional<til::CoordType>& wrappedRow) const;
         void TraceEndPaint() const;
+        void TraceFlushBackpressure(const size_t pendingBytes, const std::chrono::steady_clock::duration waited) const;
     };
 }
@@ -35,6 +35,11 @@ namespace Microsoft::Console::VirtualTerminal
     class VtIo;
 }
 
+namespace Microsoft::Console::VtSharedMemory
+{
+    class Client;
+}
+
 namespace Microsoft::Console::Render
 {
     class VtEngine : public RenderEngineBase
@@ -50,6 +55,7 @@ namespace Microsoft::Console::Render
         // IRenderEngine
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
+        void WaitUntilCanRender() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
         [[nodiscard]] HRESULT Invalidate(const til::rect* psrRegion) noexcept override;
@@ -84,6 +90,7 @@ namespace Microsoft::Console::Render
         void EndResizeRequest();
         void SetResizeQuirk(const bool resizeQuirk);
         void SetPassthroughMode(const bool passthrough) noexcept;
+        void SetSharedMemory(std::shared_ptr<Microsoft::Console::VtSharedMemory::Client> sharedMemory) noexcept;
         void SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept;
         void SetTerminalCursorTextPosition(const til::point coordCursor) noexcept;
         [[nodiscard]] virtual HRESULT ManuallyClearScrollback() noexcept;
@@ -95,6 +102,18 @@ namespace Microsoft::Console::Render
         wil::unique_hfile _hFile;
         std::string _buffer;
 
+        // _Flush() hands the _buffer over to a threadpool work item which writes it
+        // to the _hFile, so that we can compose the next frame while the terminal is
+        // still busy reading the previous one. The work item must be destroyed before
+        // the _hFile and _flushBuffer it uses, hence the member order.
+        // If _sharedMemory is set, the output goes there instead of the _hFile.
+        std::shared_ptr<Microsoft::Console::VtSharedMemory::Client> _sharedMemory;
+        std::string _flushBuffer;
+        HRESULT _flushResult{ S_OK };
+        std::atomic<bool> _flushPending{ false };
+        bool _flushSynchronously{ false };
+        wil::unique_threadpool_work_nocancel _flushWork;
+
         std::string _formatBuffer;
         std::string _conversionBuffer;
 
@@ -113,6 +132,12 @@ namespace Microsoft::Console::Render
         til::point _lastText;
         til::point _scrollDelta;
 
+        // A pending scroll of the rows [_regionScrollTop, _regionScrollBottom)
+        // within the viewport. See XtermEngine::InvalidateScrollRegion.
+        til::CoordType _regionScrollTop{ 0 };
+        til::CoordType _regionScrollBottom{ 0 };
+        til::CoordType _regionScrollDelta{ 0 };
+
         bool _quickReturn;
         bool _clearedAllThisFrame;
         bool _cursorMoved;
@@ -145,6 +170,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _WriteFill(const size_t n, const char c) noexcept;
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        [[nodiscard]] HRESULT _WaitForFlush() noexcept;
+        static void CALLBACK _FlushWorkCallback(PTP_CALLBACK_INSTANCE instance, void* context, PTP_WORK work) noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -167,6 +194,9 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _InsertDeleteLine(const til::CoordType sLines, const bool fInsertLine) noexcept;
         [[nodiscard]] HRESULT _DeleteLine(const til::CoordType sLines) noexcept;
         [[nodiscard]] HRESULT _InsertLine(const til::CoordType sLines) noexcept;
+        [[nodiscard]] HRESULT _SetTopBottomMargins(const til::CoordType top, const til::CoordType bottom) noexcept;
+        [[nodiscard]] HRESULT _ResetTopBottomMargins() noexcept;
+        [[nodiscard]] HRESULT _ScrollUpDown(const til::CoordType sLines, const bool fScrollUp) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const til::CoordType chars) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const til::CoordType chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const til::point coord) noexcept;
@@ -224,6 +254,22 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(const std::span<const Cluster> clusters,
                                                     const til::point coord) noexcept;
 
+        // A copy of the cells we've last emitted to the terminal, so that PaintBufferLine
+        // can skip the parts of a run that the terminal already displays. A `text` of 0
+        // means that we don't know what the terminal shows in that cell.
+        struct ShadowCell
+        {
+            uint64_t text = 0;
+            TextAttribute attributes;
+        };
+        std::vector<ShadowCell> _shadow;
+        til::size _shadowSize;
+
+        static uint64_t _ShadowText(const Cluster& cluster) noexcept;
+        bool _TrimUnchangedClusters(std::span<const Cluster>& clusters, til::point& coord, bool& lineWrapped) noexcept;
+        void _UpdateShadow(const std::span<const Cluster> clusters, const til::point coord) noexcept;
+        void _InvalidateShadow() noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalDrcs(const std::wstring_view str) noexcept;
@@ -173,6 +173,8 @@ PCONSOLE_API_MSG ApiSorter::ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Mess
     // such known code -- STATUS_BUFFER_TOO_SMALL. There's a conlibk dependency on this being returned from the console
     // alias API.
     NTSTATUS Status = S_OK;
+    const auto traceApiCall = Tracing::s_IsApiCallTracingEnabled();
+    const auto start = traceApiCall ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
     {
         Status = (*Descriptor->Routine)(Message, &ReplyPending);
     }
@@ -181,6 +183,17 @@ PCONSOLE_API_MSG ApiSorter::ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Mess
         Status = NTSTATUS_FROM_HRESULT(Status);
     }
 
+    if (traceApiCall)
+    {
+        Tracing::s_TraceApiCall(Message->GetProcessHandle(),
+                                Descriptor->TraceName,
+                                Message->Descriptor.InputSize,
+                                Message->Descriptor.OutputSize,
+                                Status,
+                                ReplyPending != FALSE,
+                                std::chrono::steady_clock::now() - start);
+    }
+
     if (!ReplyPending)
     {
         Message->SetReplyStatus(Status);
@@ -12,6 +12,75 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 
+namespace
+{
+    // A ConsoleHandleData is created and destroyed for every CreateFile("CONOUT$"), DuplicateHandle() and
+    // CloseHandle() of a client, which test harnesses and build tools can do at a very high rate.
+    // They're allocated from slabs of this many and recycled through a free list instead of the heap.
+    constexpr size_t handleSlabSize = 64;
+
+    union HandleSlot
+    {
+        HandleSlot* next;
+        alignas(ConsoleHandleData) std::byte storage[sizeof(ConsoleHandleData)];
+    };
+
+    struct HandleSlabs
+    {
+        wil::srwlock lock;
+        HandleSlot* freeList = nullptr;
+        // The slabs are never freed. The number of handles that are open at the same
+        // time is small, so the high watermark is all the memory this ever needs.
+        std::vector<std::unique_ptr<HandleSlot[]>> slabs;
+    };
+
+    HandleSlabs& handleSlabs()
+    {
+        // Leaked intentionally, because handles may still be freed during static destruction.
+        static auto& slabs = *new HandleSlabs;
+        return slabs;
+    }
+}
+
+void* ConsoleHandleData::operator new(const size_t size)
+{
+    assert(size == sizeof(ConsoleHandleData));
+    UNREFERENCED_PARAMETER(size);
+
+    auto& slabs = handleSlabs();
+    const auto guard = slabs.lock.lock_exclusive();
+
+    if (!slabs.freeList)
+    {
+        auto& slab = slabs.slabs.emplace_back(std::make_unique<HandleSlot[]>(handleSlabSize));
+        for (size_t i = 0; i < handleSlabSize - 1; ++i)
+        {
+            slab[i].next = &slab[i + 1];
+        }
+        slab[handleSlabSize - 1].next = nullptr;
+        slabs.freeList = &slab[0];
+    }
+
+    const auto slot = slabs.freeList;
+    slabs.freeList = slot->next;
+    return slot;
+}
+
+void ConsoleHandleData::operator delete(void* const ptr) noexcept
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    auto& slabs = handleSlabs();
+    const auto guard = slabs.lock.lock_exclusive();
+
+    const auto slot = static_cast<HandleSlot*>(ptr);
+    slot->next = slabs.freeList;
+    slabs.freeList = slot;
+}
+
 ConsoleHandleData::ConsoleHandleData(const ACCESS_MASK amAccess,
                                      const ULONG ulShareAccess) :
     _ulHandleType(HandleType::NotReady),
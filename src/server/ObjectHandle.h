@@ -41,6 +41,10 @@ public:
     ConsoleHandleData& operator=(const ConsoleHandleData&) & = delete;
     ConsoleHandleData& operator=(ConsoleHandleData&&) & = delete;
 
+    // Handles are recycled through a free list of slabs instead of the heap. See ObjectHandle.cpp.
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
+
     [[nodiscard]] HRESULT GetInputBuffer(const ACCESS_MASK amRequested,
                                          _Outptr_ InputBuffer** const ppInputBuffer) const;
     [[nodiscard]] HRESULT GetScreenBuffer(const ACCESS_MASK amRequested,
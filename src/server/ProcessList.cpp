@@ -40,7 +40,10 @@ using namespace Microsoft::Console::Interactivity;
     try
     {
         pProcessData = std::make_unique<ConsoleProcessHandle>(dwProcessId, dwThreadId, ulProcessGroupId);
+        _processesById.emplace(dwProcessId, pProcessData.get());
+        auto removeFromIndex = wil::scope_exit([&]() noexcept { _processesById.erase(dwProcessId); });
         _processes.emplace_back(pProcessData.get());
+        removeFromIndex.release();
     }
     CATCH_RETURN();
 
@@ -59,10 +62,14 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 {
     assert(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked());
 
-    const auto it = std::ranges::find(_processes, pProcessData);
-    if (it != _processes.end())
+    const auto indexed = _processesById.find(pProcessData->dwProcessId);
+    if (indexed != _processesById.end() && indexed->second == pProcessData)
     {
-        _processes.erase(it);
+        // Short-lived processes are the ones that come and go the most, which is why we search from the back.
+        const auto it = std::ranges::find(_processes.rbegin(), _processes.rend(), pProcessData);
+        assert(it != _processes.rend());
+        _processes.erase(std::next(it).base());
+        _processesById.erase(indexed);
         delete pProcessData;
     }
     else
@@ -84,15 +91,8 @@ ConsoleProcessHandle* ConsoleProcessList::FindProcessInList(const DWORD dwProces
 {
     assert(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked());
 
-    for (const auto& p : _processes)
-    {
-        if (p->dwProcessId == dwProcessId)
-        {
-            return p;
-        }
-    }
-
-    return nullptr;
+    const auto it = _processesById.find(dwProcessId);
+    return it != _processesById.end() ? it->second : nullptr;
 }
 
 // Routine Description:
@@ -124,6 +124,13 @@ ConsoleProcessHandle* ConsoleProcessList::GetRootProcess() const
 {
     assert(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked());
 
+    // The root process is usually the first one that connected, as it's also
+    // reassigned to the oldest one if it exits (see windowio.cpp).
+    if (!_processes.empty() && _processes.front()->fRootProcess)
+    {
+        return _processes.front();
+    }
+
     for (const auto& p : _processes)
     {
         if (p->fRootProcess)
@@ -210,6 +217,7 @@ ConsoleProcessHandle* ConsoleProcessList::GetOldestProcess() const
     try
     {
         termRecords.clear();
+        termRecords.reserve(_processes.size());
 
         // Dig through known processes looking for a match
         for (const auto& p : _processes)
@@ -58,7 +58,11 @@ public:
     bool IsEmpty() const;
 
 private:
+    // Ordered from oldest to newest, as GetOldestProcess() and GetProcessList() depend on it.
     std::vector<ConsoleProcessHandle*> _processes;
+    // Build tools may attach hundreds of processes to a single console. This index
+    // keeps FindProcessInList(), which is used on every connect and disconnect, O(1).
+    std::unordered_map<DWORD, ConsoleProcessHandle*> _processesById;
 
     void _ModifyProcessForegroundRights(const HANDLE hProcess, const bool fForeground) const;
 };
@@ -148,6 +148,10 @@ public:
                                        const VTParameter cellHeight,
                                        const DispatchTypes::DrcsCharsetSize charsetSize) = 0; // DECDLD
 
+    virtual StringHandler DefineSixelImage(const VTParameter aspectRatio,
+                                           const VTParameter backgroundSelect,
+                                           const VTParameter gridSize) = 0; // SIXEL
+
     virtual StringHandler DefineMacro(const VTInt macroId,
                                       const DispatchTypes::MacroDeleteControl deleteControl,
                                       const DispatchTypes::MacroEncoding encoding) = 0; // DECDMAC
@@ -15,7 +15,6 @@
 #include "InteractDispatch.hpp"
 #include "../../host/conddkrefs.h"
 #include "../../interactivity/inc/ServiceLocator.hpp"
-#include "../../interactivity/inc/EventSynthesis.hpp"
 #include "../../types/inc/Viewport.hpp"
 
 using namespace Microsoft::Console::Interactivity;
@@ -29,7 +28,7 @@ InteractDispatch::InteractDispatch() :
 
 // Method Description:
 // - Writes a collection of input to the host. The new input is appended to the
-//      end of the input buffer.
+//      end of the input buffer once FlushInput() is called.
 //  If Ctrl+C is written with this function, it will not trigger a Ctrl-C
 //      interrupt in the client, but instead write a Ctrl+C to the input buffer
 //      to be read by the client.
@@ -39,8 +38,11 @@ InteractDispatch::InteractDispatch() :
 // - True.
 bool InteractDispatch::WriteInput(const std::span<const INPUT_RECORD>& inputEvents)
 {
-    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.GetActiveInputBuffer()->Write(inputEvents);
+    if (!_pendingText.empty())
+    {
+        FlushInput();
+    }
+    _pendingEvents.insert(_pendingEvents.end(), inputEvents.begin(), inputEvents.end());
     return true;
 }
 
@@ -53,33 +55,54 @@ bool InteractDispatch::WriteInput(const std::span<const INPUT_RECORD>& inputEven
 // - event: The key to send to the host.
 bool InteractDispatch::WriteCtrlKey(const INPUT_RECORD& event)
 {
+    FlushInput();
     HandleGenericKeyEvent(event, false);
     return true;
 }
 
 // Method Description:
-// - Writes a string of input to the host.
+// - Writes a string of input to the host once FlushInput() is called. The input buffer
+//   stores it as text and only synthesizes key events for it if a client reads it as such.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
 // - True.
 bool InteractDispatch::WriteString(const std::wstring_view string)
 {
-    if (!string.empty())
+    if (!_pendingEvents.empty())
     {
-        const auto codepage = _api.GetConsoleOutputCP();
-        InputEventQueue keyEvents;
-
-        for (const auto& wch : string)
-        {
-            CharToKeyEvents(wch, codepage, keyEvents);
-        }
-
-        WriteInput(keyEvents);
+        FlushInput();
     }
+    _pendingText.append(string);
     return true;
 }
 
+// Method Description:
+// - Writes the input queued up by WriteInput() and WriteString() to the input buffer.
+//   Writing it in bulk wakes up waiting readers only once, instead of once per key.
+//   Any input that affects the console directly (Ctrl+C, focus changes, etc.)
+//   flushes the input that precedes it first, so that its order is preserved.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+// Note:
+// - The console lock must be held when calling this routine.
+void InteractDispatch::FlushInput() const
+{
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (!_pendingEvents.empty())
+    {
+        gci.GetActiveInputBuffer()->Write(_pendingEvents);
+        _pendingEvents.clear();
+    }
+    if (!_pendingText.empty())
+    {
+        gci.GetActiveInputBuffer()->WriteString(_pendingText);
+        _pendingText.clear();
+    }
+}
+
 //Method Description:
 // Window Manipulation - Performs a variety of actions relating to the window,
 //      such as moving the window position, resizing the window, querying
@@ -99,6 +122,7 @@ bool InteractDispatch::WindowManipulation(const DispatchTypes::WindowManipulatio
     // Other Window Manipulation functions:
     //  MSFT:13271098 - QueryViewport
     //  MSFT:13271146 - QueryScreenSize
+    FlushInput();
     switch (function)
     {
     case DispatchTypes::WindowManipulationType::DeIconifyWindow:
@@ -134,6 +158,8 @@ bool InteractDispatch::WindowManipulation(const DispatchTypes::WindowManipulatio
 // - True.
 bool InteractDispatch::MoveCursor(const VTInt row, const VTInt col)
 {
+    FlushInput();
+
     // First retrieve some information about the buffer
     const auto viewport = _api.GetViewport();
 
@@ -172,6 +198,8 @@ bool InteractDispatch::IsVtInputEnabled() const
 // - true always.
 bool InteractDispatch::FocusChanged(const bool focused) const
 {
+    FlushInput();
+
     auto& g = ServiceLocator::LocateGlobals();
     auto& gci = g.getConsoleInformation();
 
@@ -37,7 +37,15 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool FocusChanged(const bool focused) const override;
 
+        void FlushInput() const;
+
     private:
         ConhostInternalGetSet _api;
+
+        // WriteInput() and WriteString() only queue up their input, which FlushInput() then writes
+        // to the input buffer in bulk. At most one of the two is non-empty, which preserves the
+        // order of the input. They're mutable, because the const FocusChanged() needs to flush them.
+        mutable InputEventQueue _pendingEvents;
+        mutable std::wstring _pendingText;
     };
 }
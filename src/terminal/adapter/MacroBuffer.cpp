@@ -37,6 +37,12 @@ void MacroBuffer::InvokeMacro(const size_t macroId, StateMachine& stateMachine)
     if (macroId < _macros.size())
     {
         const auto& macroSequence = til::at(_macros, macroId);
+        // Undefined and deleted macros are empty. There's nothing to parse then,
+        // which saves us from resetting the parser's run state for nothing.
+        if (macroSequence.empty())
+        {
+            return;
+        }
         // Macros can invoke other macros up to a depth of 16, but we don't allow
         // the total sequence length to exceed the maximum buffer size, since that's
         // likely to facilitate a denial-of-service attack.
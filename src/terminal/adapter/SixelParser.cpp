@@ -0,0 +1,321 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "SixelParser.hpp"
+#include "../parser/stateMachine.hpp"
+#include "../../types/inc/utils.hpp"
+
+using namespace Microsoft::Console::Utils;
+using namespace Microsoft::Console::VirtualTerminal;
+
+namespace
+{
+    constexpr RGBQUAD toRgbQuad(const til::color color) noexcept
+    {
+        return { color.b, color.g, color.r, 255 };
+    }
+}
+
+// Routine Description:
+// - Creates a parser for the data string of a sixel sequence.
+// Arguments:
+// - aspectRatio - The P1 parameter, which selects the height of a sixel pixel.
+// - backgroundSelect - The P2 parameter. If it's 1, unset pixels remain transparent.
+// - maxSize - The largest image in pixels we're willing to decode. Anything outside of it is ignored.
+SixelParser::SixelParser(const VTParameter aspectRatio, const VTParameter backgroundSelect, const til::size maxSize) noexcept :
+    _colors{ _defaultColors() },
+    _color{ _colors[0] },
+    _transparentBackground{ backgroundSelect.value_or(0) == 1 },
+    _maxSize{ maxSize }
+{
+    // See DEC STD 070, Sixel Graphics Extension, § 9.2.2.1, Pixel Aspect Ratio.
+    switch (aspectRatio.value_or(0))
+    {
+    case 2:
+        _pixelAspectRatio = 5;
+        break;
+    case 3:
+    case 4:
+        _pixelAspectRatio = 3;
+        break;
+    case 7:
+    case 8:
+    case 9:
+        _pixelAspectRatio = 1;
+        break;
+    default:
+        _pixelAspectRatio = 2;
+        break;
+    }
+}
+
+// Routine Description:
+// - Processes the next character of the sixel data string.
+// Arguments:
+// - ch - The character to process.
+void SixelParser::AddData(const wchar_t ch)
+{
+    if (ch >= L'0' && ch <= L'9')
+    {
+        _parameter = std::min(_parameter * 10 + (ch - L'0'), MAX_PARAMETER_VALUE);
+    }
+    else if (ch == L';')
+    {
+        _addParameter();
+    }
+    else if (ch >= L'?' && ch <= L'~')
+    {
+        _finishCommand();
+        _addSixelValue(ch - L'?');
+    }
+    else if (ch == L'"')
+    {
+        _startCommand(State::RasterAttributes);
+    }
+    else if (ch == L'#')
+    {
+        _startCommand(State::ColorIntroducer);
+    }
+    else if (ch == L'!')
+    {
+        _startCommand(State::RepeatIntroducer);
+    }
+    else if (ch == L'$')
+    {
+        // Graphics carriage return
+        _finishCommand();
+        _column = 0;
+    }
+    else if (ch == L'-')
+    {
+        // Graphics new line
+        _finishCommand();
+        _column = 0;
+        _bandTop += 6 * _pixelAspectRatio;
+    }
+}
+
+// Routine Description:
+// - Completes the image once the data string has ended. Unless the background
+//   was selected to be transparent, all the pixels that weren't drawn get filled
+//   with color 0, up to the size declared in the raster attributes.
+void SixelParser::FinalizeData()
+{
+    _finishCommand();
+
+    if (!_transparentBackground)
+    {
+        _imageSize.width = std::max(_imageSize.width, std::min(_declaredSize.width, _maxSize.width));
+        _imageSize.height = std::max(_imageSize.height, std::min(_declaredSize.height, _maxSize.height));
+        _ensureSize(_imageSize.width, _imageSize.height);
+
+        const auto background = _colors[0];
+        for (til::CoordType y = 0; y < _imageSize.height; ++y)
+        {
+            const auto row = _pixels.begin() + gsl::narrow_cast<size_t>(y) * _stride;
+            std::replace_if(
+                row, row + _imageSize.width, [](const RGBQUAD& p) { return p.rgbReserved == 0; }, background);
+        }
+    }
+}
+
+til::size SixelParser::GetSize() const noexcept
+{
+    return _imageSize;
+}
+
+// Routine Description:
+// - Returns the distance between rows of pixels in GetPixels().
+til::CoordType SixelParser::GetStride() const noexcept
+{
+    return _stride;
+}
+
+std::span<const RGBQUAD> SixelParser::GetPixels() const noexcept
+{
+    return _pixels;
+}
+
+void SixelParser::_startCommand(const State state) noexcept
+{
+    _finishCommand();
+    _state = state;
+}
+
+void SixelParser::_finishCommand()
+{
+    if (_state == State::Data)
+    {
+        return;
+    }
+
+    _addParameter();
+
+    switch (_state)
+    {
+    case State::RasterAttributes:
+        // The aspect ratio can only be changed before any pixels are drawn.
+        if (_imageSize.width == 0 && _parameterCount >= 2 && _parameters[0] > 0 && _parameters[1] > 0)
+        {
+            _pixelAspectRatio = std::clamp((_parameters[0] + _parameters[1] / 2) / _parameters[1], 1, 100);
+        }
+        if (_parameterCount >= 4)
+        {
+            _declaredSize = { _parameters[2], _parameters[3] };
+        }
+        break;
+    case State::ColorIntroducer:
+        _defineColor();
+        break;
+    case State::RepeatIntroducer:
+        _repeatCount = std::max(_parameters[0], 1);
+        break;
+    default:
+        break;
+    }
+
+    _state = State::Data;
+    _parameters = {};
+    _parameterCount = 0;
+}
+
+void SixelParser::_addParameter() noexcept
+{
+    if (_parameterCount < _parameters.size())
+    {
+        til::at(_parameters, _parameterCount++) = _parameter;
+    }
+    _parameter = 0;
+}
+
+// Routine Description:
+// - Handles the #Pc;Pu;Px;Py;Pz color introducer. With only 1 parameter it selects the
+//   color Pc for the following pixels. Otherwise it defines the color Pc in the HLS (Pu = 1)
+//   or RGB (Pu = 2) color model first. See DEC STD 070, § 9.2.3.2, Color Introducer.
+void SixelParser::_defineColor() noexcept
+{
+    const auto index = gsl::narrow_cast<size_t>(_parameters[0]) % MAX_COLORS;
+
+    if (_parameterCount >= 5)
+    {
+        const auto colorModel = DispatchTypes::ColorModel{ _parameters[1] };
+        const auto x = _parameters[2];
+        const auto y = _parameters[3];
+        const auto z = _parameters[4];
+        if (colorModel == DispatchTypes::ColorModel::HLS)
+        {
+            til::at(_colors, index) = toRgbQuad(ColorFromHLS(x, y, z));
+        }
+        else if (colorModel == DispatchTypes::ColorModel::RGB)
+        {
+            til::at(_colors, index) = toRgbQuad(ColorFromRGB100(x, y, z));
+        }
+    }
+
+    _color = til::at(_colors, index);
+}
+
+// Routine Description:
+// - Draws a sixel, which is a column of 6 pixels (multiplied by the aspect ratio), at the current
+//   position, as often as the preceding repeat introducer said. Bit 0 is the top most pixel.
+// Arguments:
+// - value - The 6 bits of the sixel.
+void SixelParser::_addSixelValue(const VTInt value)
+{
+    const auto columnBegin = _column;
+    const auto columnEnd = std::min(_column + _repeatCount, _maxSize.width);
+    _column += _repeatCount;
+    _repeatCount = 1;
+
+    if (value == 0 || columnBegin >= columnEnd)
+    {
+        return;
+    }
+
+    // The pixels below the last bit that's set aren't part of the image (yet).
+    unsigned long lastBit;
+    _BitScanReverse(&lastBit, gsl::narrow_cast<unsigned long>(value));
+    const auto bottom = std::min(_bandTop + gsl::narrow_cast<til::CoordType>(lastBit + 1) * _pixelAspectRatio, _maxSize.height);
+    if (_bandTop >= bottom)
+    {
+        return;
+    }
+
+    _ensureSize(columnEnd, bottom);
+
+    for (auto bit = 0; bit < 6; ++bit)
+    {
+        if (!(value & (1 << bit)))
+        {
+            continue;
+        }
+
+        const auto top = _bandTop + bit * _pixelAspectRatio;
+        for (auto y = top; y < std::min(top + _pixelAspectRatio, bottom); ++y)
+        {
+            const auto row = _pixels.begin() + gsl::narrow_cast<size_t>(y) * _stride;
+            std::fill(row + columnBegin, row + columnEnd, _color);
+        }
+    }
+
+    _imageSize.width = std::max(_imageSize.width, columnEnd);
+    _imageSize.height = std::max(_imageSize.height, bottom);
+}
+
+// Routine Description:
+// - Grows the pixel buffer to fit at least the given size. The capacity is doubled
+//   every time, because the size of an image is generally not known in advance.
+void SixelParser::_ensureSize(const til::CoordType width, const til::CoordType height)
+{
+    if (width > _stride)
+    {
+        const auto stride = std::min(std::max({ width, _stride * 2, 64 }), _maxSize.width);
+        std::vector<RGBQUAD> pixels(gsl::narrow_cast<size_t>(stride) * _allocatedHeight);
+        for (til::CoordType y = 0; y < _allocatedHeight; ++y)
+        {
+            const auto src = _pixels.begin() + gsl::narrow_cast<size_t>(y) * _stride;
+            std::copy_n(src, _stride, pixels.begin() + gsl::narrow_cast<size_t>(y) * stride);
+        }
+        _pixels = std::move(pixels);
+        _stride = stride;
+    }
+
+    if (height > _allocatedHeight)
+    {
+        _allocatedHeight = std::min(std::max({ height, _allocatedHeight * 2, 6 * _pixelAspectRatio }), _maxSize.height);
+        _pixels.resize(gsl::narrow_cast<size_t>(_stride) * _allocatedHeight);
+    }
+}
+
+// Routine Description:
+// - Returns the initial color registers, which are the 16 colors of the VT340.
+//   The remaining registers repeat that palette. See DEC STD 070, § 9.2.3.3.
+std::array<RGBQUAD, SixelParser::MAX_COLORS> SixelParser::_defaultColors() noexcept
+{
+    static const std::array<til::color, 16> vt340Colors{
+        ColorFromRGB100(0, 0, 0), // Black
+        ColorFromRGB100(20, 20, 80), // Blue
+        ColorFromRGB100(80, 13, 13), // Red
+        ColorFromRGB100(20, 80, 20), // Green
+        ColorFromRGB100(80, 20, 80), // Magenta
+        ColorFromRGB100(20, 80, 80), // Cyan
+        ColorFromRGB100(80, 80, 20), // Yellow
+        ColorFromRGB100(53, 53, 53), // Gray 50%
+        ColorFromRGB100(26, 26, 26), // Gray 25%
+        ColorFromRGB100(33, 33, 60), // Blue*
+        ColorFromRGB100(60, 26, 26), // Red*
+        ColorFromRGB100(33, 60, 33), // Green*
+        ColorFromRGB100(60, 33, 60), // Magenta*
+        ColorFromRGB100(33, 60, 60), // Cyan*
+        ColorFromRGB100(60, 60, 33), // Yellow*
+        ColorFromRGB100(80, 80, 80), // Gray 75%
+    };
+
+    std::array<RGBQUAD, MAX_COLORS> colors;
+    for (size_t i = 0; i < colors.size(); ++i)
+    {
+        til::at(colors, i) = toRgbQuad(til::at(vt340Colors, i % vt340Colors.size()));
+    }
+    return colors;
+}
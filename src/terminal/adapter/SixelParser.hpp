@@ -0,0 +1,75 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SixelParser.hpp
+
+Abstract:
+- This decodes the image data of the sixel graphics DCS sequence into a bitmap.
+--*/
+
+#pragma once
+
+#include "DispatchTypes.hpp"
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class SixelParser
+    {
+    public:
+        // Sixel images are measured in the pixels of the VT340, which had a cell size of 10x20.
+        // Applications expect this size to figure out how many rows and columns an image covers.
+        static constexpr til::size CellSize{ 10, 20 };
+
+        SixelParser(const VTParameter aspectRatio, const VTParameter backgroundSelect, const til::size maxSize) noexcept;
+        void AddData(const wchar_t ch);
+        void FinalizeData();
+
+        til::size GetSize() const noexcept;
+        til::CoordType GetStride() const noexcept;
+        std::span<const RGBQUAD> GetPixels() const noexcept;
+
+    private:
+        static constexpr size_t MAX_COLORS = 256;
+        static constexpr size_t MAX_PARAMETERS = 5;
+
+        enum class State
+        {
+            Data,
+            RasterAttributes,
+            ColorIntroducer,
+            RepeatIntroducer,
+        };
+
+        void _startCommand(const State state) noexcept;
+        void _finishCommand();
+        void _addParameter() noexcept;
+        void _defineColor() noexcept;
+        void _addSixelValue(const VTInt value);
+        void _ensureSize(const til::CoordType width, const til::CoordType height);
+
+        static std::array<RGBQUAD, MAX_COLORS> _defaultColors() noexcept;
+
+        State _state = State::Data;
+        std::array<VTInt, MAX_PARAMETERS> _parameters{};
+        size_t _parameterCount = 0;
+        VTInt _parameter = 0;
+
+        std::array<RGBQUAD, MAX_COLORS> _colors;
+        RGBQUAD _color;
+        bool _transparentBackground;
+
+        til::size _maxSize;
+        til::CoordType _pixelAspectRatio;
+        til::CoordType _repeatCount = 1;
+        til::CoordType _column = 0;
+        til::CoordType _bandTop = 0;
+        til::size _declaredSize;
+        til::size _imageSize;
+
+        std::vector<RGBQUAD> _pixels;
+        til::CoordType _stride = 0;
+        til::CoordType _allocatedHeight = 0;
+    };
+}
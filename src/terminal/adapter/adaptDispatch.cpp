@@ -57,13 +57,9 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
 {
     if (_termOutput.NeedToTranslate())
     {
-        std::wstring buffer;
-        buffer.reserve(string.size());
-        for (auto& wch : string)
-        {
-            buffer.push_back(_termOutput.TranslateKey(wch));
-        }
-        _WriteToBuffer(buffer);
+        // The buffer is a member, so that its capacity is reused across calls.
+        _termOutput.TranslateString(string, _translatedString);
+        _WriteToBuffer(_translatedString);
     }
     else
     {
@@ -73,6 +69,8 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
 
 void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
 {
+    TIL_TRACE_REGION(g_hConsoleVirtTermParserEventTraceProvider, "BufferWrite");
+
     auto& textBuffer = _api.GetTextBuffer();
     auto& cursor = textBuffer.GetCursor();
     auto cursorPosition = cursor.GetPosition();
@@ -614,9 +612,10 @@ void AdaptDispatch::_ScrollRectVertically(TextBuffer& textBuffer, const til::rec
         if (width == textBuffer.GetSize().Width())
         {
             // If the scrollRect is the full width of the buffer, we can scroll
-            // more efficiently by rotating the row storage.
+            // more efficiently by rotating the row storage. This also allows
+            // renderers (like ConPTY) to shift their frame instead of repainting.
             textBuffer.ScrollRows(top, height, actualDelta);
-            textBuffer.TriggerRedraw(Viewport::FromExclusive(scrollRect));
+            textBuffer.TriggerScrollRegion(Viewport::FromExclusive(scrollRect), actualDelta);
         }
         else
         {
@@ -663,27 +662,14 @@ void AdaptDispatch::_ScrollRectHorizontally(TextBuffer& textBuffer, const til::r
     if (absoluteDelta < scrollRect.width())
     {
         const auto left = delta > 0 ? scrollRect.left : (scrollRect.left + absoluteDelta);
-        const auto top = scrollRect.top;
         const auto width = scrollRect.width() - absoluteDelta;
-        const auto height = scrollRect.height();
         const auto actualDelta = delta > 0 ? absoluteDelta : -absoluteDelta;
 
-        const auto source = Viewport::FromDimensions({ left, top }, width, height);
-        const auto target = Viewport::Offset(source, { actualDelta, 0 });
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*textBuffer.GetCellDataAt(sourcePos));
-        do
-        {
-            const auto current = next;
-            source.WalkInBounds(sourcePos, walkDirection);
-            next = OutputCell(*textBuffer.GetCellDataAt(sourcePos));
-            textBuffer.WriteLine(OutputCellIterator({ &current, 1 }), targetPos);
-        } while (target.WalkInBounds(targetPos, walkDirection));
+        // CopyRect() moves the text and attributes of each row in bulk, instead
+        // of one cell at a time. Wide glyphs that get cut in half by either edge
+        // of the source area are replaced with whitespace.
+        const til::rect source{ left, scrollRect.top, left + width, scrollRect.bottom };
+        textBuffer.CopyRect(source, { left + actualDelta, scrollRect.top });
     }
 
     // Columns revealed by the scroll are filled with standard erase attributes.
@@ -996,10 +982,15 @@ void AdaptDispatch::_ChangeRectAttributes(TextBuffer& textBuffer, const til::rec
     {
         for (auto row = changeRect.top; row < changeRect.bottom; row++)
         {
+            // The attributes are run-length encoded, so we apply the changes to
+            // each run that overlaps the rect, rather than to each cell. The
+            // slice is a copy, because we modify the row while iterating it.
             auto& rowBuffer = textBuffer.GetMutableRowByOffset(row);
-            for (auto col = changeRect.left; col < changeRect.right; col++)
+            const auto runs = rowBuffer.Attributes().slice(gsl::narrow_cast<uint16_t>(changeRect.left), gsl::narrow_cast<uint16_t>(changeRect.right));
+            auto col = changeRect.left;
+            for (const auto& run : runs.runs())
             {
-                auto attr = rowBuffer.GetAttrByColumn(col);
+                auto attr = run.value;
                 auto characterAttributes = attr.GetCharacterAttributes();
                 characterAttributes &= changeOps.andAttrMask;
                 characterAttributes ^= changeOps.xorAttrMask;
@@ -1012,7 +1003,8 @@ void AdaptDispatch::_ChangeRectAttributes(TextBuffer& textBuffer, const til::rec
                 {
                     attr.SetBackground(*changeOps.background);
                 }
-                rowBuffer.ReplaceAttributes(col, col + 1, attr);
+                rowBuffer.ReplaceAttributes(col, col + run.length, attr);
+                col += run.length;
             }
         }
         textBuffer.TriggerRedraw(Viewport::FromExclusive(changeRect));
@@ -1228,28 +1220,26 @@ bool AdaptDispatch::CopyRectangularArea(const VTInt top, const VTInt left, const
     {
         // If the source is bigger than the available space at the destination
         // it needs to be clipped, so we only care about the destination size.
-        const auto srcView = Viewport::FromDimensions(srcRect.origin(), dstRect.size());
-        const auto dstView = Viewport::FromDimensions(dstRect.origin(), dstRect.size());
-        const auto walkDirection = Viewport::DetermineWalkDirection(srcView, dstView);
-        auto srcPos = srcView.GetWalkOrigin(walkDirection);
-        auto dstPos = dstView.GetWalkOrigin(walkDirection);
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*textBuffer.GetCellDataAt(srcPos));
-        do
+        const auto width = dstRect.width();
+        const auto height = dstRect.height();
+
+        // The area is copied a row at a time, which lets CopyRect() move the
+        // text and attribute runs in bulk. If the area moves down, we need to
+        // start with the bottom row, so we don't overwrite rows we still need.
+        const auto bottomUp = dstRect.top > srcRect.top;
+        for (til::CoordType i = 0; i < height; ++i)
         {
-            const auto current = next;
-            const auto currentSrcPos = srcPos;
-            srcView.WalkInBounds(srcPos, walkDirection);
-            next = OutputCell(*textBuffer.GetCellDataAt(srcPos));
-            // If the source position is offscreen (which can occur on double
-            // width lines), then we shouldn't copy anything to the destination.
-            if (currentSrcPos.x < textBuffer.GetLineWidth(currentSrcPos.y))
+            const auto dy = bottomUp ? height - 1 - i : i;
+            const auto srcRow = srcRect.top + dy;
+
+            // If part of the source is offscreen (which can occur on double
+            // width lines), then we shouldn't copy that part to the destination.
+            const auto srcRight = std::min(srcRect.left + width, textBuffer.GetLineWidth(srcRow));
+            if (srcRight > srcRect.left)
             {
-                textBuffer.WriteLine(OutputCellIterator({ &current, 1 }), dstPos);
+                textBuffer.CopyRect({ srcRect.left, srcRow, srcRight, srcRow + 1 }, { dstRect.left, dstRect.top + dy });
             }
-        } while (dstView.WalkInBounds(dstPos, walkDirection));
+        }
         _api.NotifyAccessibilityChange(dstRect);
     }
 
@@ -1382,6 +1372,10 @@ bool AdaptDispatch::RequestChecksumRectangularArea(const VTInt id, const VTInt p
             const auto eraseRect = _CalculateRectArea(top, left, bottom, right, textBuffer.GetSize().Dimensions());
             for (auto row = eraseRect.top; row < eraseRect.bottom; row++)
             {
+                // The text and the attributes are summed up separately, directly
+                // from the ROW, since a checksum doesn't depend on the order of
+                // its terms. This avoids looking up every cell via GetCellDataAt().
+                const auto& rowData = textBuffer.GetRowByOffset(row);
                 for (auto col = eraseRect.left; col < eraseRect.right; col++)
                 {
                     // The algorithm we're using here should match the DEC terminals
@@ -1389,24 +1383,41 @@ bool AdaptDispatch::RequestChecksumRectangularArea(const VTInt id, const VTInt p
                     // predate Unicode, though, so we'd need a custom mapping table
                     // to lookup the correct checksums. Considering this is only for
                     // testing at the moment, that doesn't seem worth the effort.
-                    const auto cell = textBuffer.GetCellDataAt({ col, row });
-                    for (auto ch : cell->Chars())
+                    // Just like the cells of the buffer, both halves of a wide
+                    // glyph contain its text.
+                    for (auto ch : rowData.GlyphAt(col))
                     {
                         // That said, I've made a special allowance for U+2426,
                         // since that is widely used in a lot of character sets.
                         checksum -= (ch == L'\u2426' ? 0x1B : ch);
                     }
+                }
+
+                // The attributes are run-length encoded, so we only need to
+                // compute the contribution of each run once and multiply it by the
+                // number of its columns that are within the requested area.
+                til::CoordType runBegin = 0;
+                for (const auto& run : rowData.Attributes().runs())
+                {
+                    const til::CoordType runEnd = runBegin + run.length;
+                    const auto columns = std::min(runEnd, eraseRect.right) - std::max(runBegin, eraseRect.left);
+                    runBegin = runEnd;
+                    if (columns <= 0)
+                    {
+                        continue;
+                    }
 
                     // Since we're attempting to match the DEC checksum algorithm,
                     // the only attributes affecting the checksum are the ones that
                     // were supported by DEC terminals.
-                    const auto attr = cell->TextAttr();
-                    checksum -= attr.IsProtected() ? 0x04 : 0;
-                    checksum -= attr.IsInvisible() ? 0x08 : 0;
-                    checksum -= attr.IsUnderlined() ? 0x10 : 0;
-                    checksum -= attr.IsReverseVideo() ? 0x20 : 0;
-                    checksum -= attr.IsBlinking() ? 0x40 : 0;
-                    checksum -= attr.IsIntense() ? 0x80 : 0;
+                    const auto& attr = run.value;
+                    uint16_t attrChecksum = 0;
+                    attrChecksum += attr.IsProtected() ? 0x04 : 0;
+                    attrChecksum += attr.IsInvisible() ? 0x08 : 0;
+                    attrChecksum += attr.IsUnderlined() ? 0x10 : 0;
+                    attrChecksum += attr.IsReverseVideo() ? 0x20 : 0;
+                    attrChecksum += attr.IsBlinking() ? 0x40 : 0;
+                    attrChecksum += attr.IsIntense() ? 0x80 : 0;
 
                     // For the same reason, we only care about the eight basic ANSI
                     // colors, although technically we also report the 8-16 index
@@ -1416,8 +1427,10 @@ bool AdaptDispatch::RequestChecksumRectangularArea(const VTInt id, const VTInt p
                     };
                     const auto fgIndex = colorIndex(attr.GetForeground(), defaultFgIndex);
                     const auto bgIndex = colorIndex(attr.GetBackground(), defaultBgIndex);
-                    checksum -= gsl::narrow_cast<uint16_t>(fgIndex << 4);
-                    checksum -= gsl::narrow_cast<uint16_t>(bgIndex);
+                    attrChecksum += gsl::narrow_cast<uint16_t>(fgIndex << 4);
+                    attrChecksum += gsl::narrow_cast<uint16_t>(bgIndex);
+
+                    checksum -= gsl::narrow_cast<uint16_t>(attrChecksum * columns);
                 }
             }
         }
@@ -2628,7 +2641,7 @@ bool AdaptDispatch::HorizontalTabSet()
     const auto column = textBuffer.GetCursor().GetPosition().x;
 
     _InitTabStopsForWidth(width);
-    _tabStopColumns.at(column) = true;
+    _SetTabStop(column, true);
 
     return true;
 }
@@ -2660,11 +2673,10 @@ bool AdaptDispatch::ForwardTab(const VTInt numTabs)
     _InitTabStopsForWidth(width);
     while (column < maxColumn && tabsPerformed < numTabs)
     {
-        column++;
-        if (til::at(_tabStopColumns, column))
-        {
-            tabsPerformed++;
-        }
+        // If there are no more tab stops, this moves us to maxColumn,
+        // which ends the loop, regardless of the tab count.
+        column = gsl::narrow_cast<VTInt>(_NextTabStop(column + 1, maxColumn));
+        tabsPerformed++;
     }
 
     // While the STD 070 reference suggests that horizontal tabs should reset
@@ -2709,11 +2721,10 @@ bool AdaptDispatch::BackwardsTab(const VTInt numTabs)
     _InitTabStopsForWidth(width);
     while (column > minColumn && tabsPerformed < numTabs)
     {
-        column--;
-        if (til::at(_tabStopColumns, column))
-        {
-            tabsPerformed++;
-        }
+        // If there are no more tab stops, this moves us to minColumn,
+        // which ends the loop, regardless of the tab count.
+        column = gsl::narrow_cast<VTInt>(_PreviousTabStop(column - 1, minColumn));
+        tabsPerformed++;
     }
 
     cursor.SetXPosition(column);
@@ -2757,7 +2768,7 @@ void AdaptDispatch::_ClearSingleTabStop()
     const auto column = textBuffer.GetCursor().GetPosition().x;
 
     _InitTabStopsForWidth(width);
-    _tabStopColumns.at(column) = false;
+    _SetTabStop(column, false);
 }
 
 // Routine Description:
@@ -2770,6 +2781,7 @@ void AdaptDispatch::_ClearSingleTabStop()
 void AdaptDispatch::_ClearAllTabStops() noexcept
 {
     _tabStopColumns.clear();
+    _tabStopWidth = 0;
     _initDefaultTabStops = false;
 }
 
@@ -2783,6 +2795,7 @@ void AdaptDispatch::_ClearAllTabStops() noexcept
 void AdaptDispatch::_ResetTabStops() noexcept
 {
     _tabStopColumns.clear();
+    _tabStopWidth = 0;
     _initDefaultTabStops = true;
 }
 
@@ -2797,23 +2810,103 @@ void AdaptDispatch::_ResetTabStops() noexcept
 void AdaptDispatch::_InitTabStopsForWidth(const VTInt width)
 {
     const auto screenWidth = gsl::narrow<size_t>(width);
-    const auto initialWidth = _tabStopColumns.size();
+    const auto initialWidth = _tabStopWidth;
     if (screenWidth > initialWidth)
     {
-        _tabStopColumns.resize(screenWidth);
+        // The bits past _tabStopWidth are always zero,
+        // so the new columns start out without tab stops.
+        _tabStopColumns.resize((screenWidth + 63) / 64);
+        _tabStopWidth = screenWidth;
         if (_initDefaultTabStops)
         {
-            for (auto column = 8u; column < _tabStopColumns.size(); column += 8)
+            for (auto column = 8u; column < screenWidth; column += 8)
             {
                 if (column >= initialWidth)
                 {
-                    til::at(_tabStopColumns, column) = true;
+                    _SetTabStop(column, true);
                 }
             }
         }
     }
 }
 
+// Routine Description:
+// - Returns true if there's a tab stop in the given column.
+// Arguments:
+// - column - the column to check. Must be less than _tabStopWidth.
+// Return value:
+// - True if the column has a tab stop.
+bool AdaptDispatch::_IsTabStop(const size_t column) const noexcept
+{
+    return (til::at(_tabStopColumns, column / 64) >> (column % 64)) & 1;
+}
+
+// Routine Description:
+// - Sets or clears the tab stop in the given column.
+// Arguments:
+// - column - the column to modify. It must be less than _tabStopWidth.
+// - set - true to set the tab stop, false to clear it.
+// Return value:
+// - <none>
+void AdaptDispatch::_SetTabStop(const size_t column, const bool set)
+{
+    auto& word = _tabStopColumns.at(column / 64);
+    const auto bit = uint64_t{ 1 } << (column % 64);
+    word = set ? word | bit : word & ~bit;
+}
+
+// Routine Description:
+// - Finds the first tab stop in the range [from, limit].
+// Arguments:
+// - from - the first column to check.
+// - limit - the last column to check. It must be less than _tabStopWidth.
+// Return value:
+// - The column of the tab stop, or limit if there is none.
+size_t AdaptDispatch::_NextTabStop(const size_t from, const size_t limit) const noexcept
+{
+    auto column = from;
+    while (column < limit)
+    {
+        // The bit of `column` ends up at the bottom, so that countr_zero()
+        // returns the distance to the next tab stop within this word.
+        const auto word = til::at(_tabStopColumns, column / 64) >> (column % 64);
+        if (word)
+        {
+            return std::min(limit, column + gsl::narrow_cast<size_t>(std::countr_zero(word)));
+        }
+        column = (column | 63) + 1;
+    }
+    return limit;
+}
+
+// Routine Description:
+// - Finds the last tab stop in the range [limit, from].
+// Arguments:
+// - from - the first column to check. It must be less than _tabStopWidth.
+// - limit - the last column to check.
+// Return value:
+// - The column of the tab stop, or limit if there is none.
+size_t AdaptDispatch::_PreviousTabStop(const size_t from, const size_t limit) const noexcept
+{
+    auto column = from;
+    while (column > limit)
+    {
+        // The bit of `column` ends up at the top, so that countl_zero()
+        // returns the distance to the previous tab stop within this word.
+        const auto word = til::at(_tabStopColumns, column / 64) << (63 - column % 64);
+        if (word)
+        {
+            return std::max(limit, column - gsl::narrow_cast<size_t>(std::countl_zero(word)));
+        }
+        if (column < 64)
+        {
+            break;
+        }
+        column = (column & ~size_t{ 63 }) - 1;
+    }
+    return limit;
+}
+
 //Routine Description:
 // DOCS - Selects the coding system through which character sets are activated.
 //     When ISO2022 is selected, the code page is set to ISO-8859-1, C1 control
@@ -3153,10 +3246,10 @@ bool AdaptDispatch::_EraseScrollback()
 
     // Scroll the viewport content to the top of the buffer.
     textBuffer.ScrollRows(top, height, -top);
-    // Clear everything after the viewport.
-    _FillRect(textBuffer, { 0, height, bufferSize.width, bufferSize.height }, whitespace, {});
-    // Also reset the line rendition for all of the cleared rows.
-    textBuffer.ResetLineRenditionRange(height, bufferSize.height);
+    // Clear everything after the viewport. This also resets the line rendition of the cleared rows.
+    // Unlike _FillRect() this doesn't touch each of the cleared rows, which may be thousands.
+    textBuffer.ResetRowsFrom(height, {});
+    _api.NotifyAccessibilityChange({ 0, height, bufferSize.width, bufferSize.height });
     // Move the viewport
     _api.SetViewportPosition({ viewport.left, 0 });
     // Move the cursor to the same relative location.
@@ -3632,14 +3725,9 @@ bool AdaptDispatch::DoITerm2Action(const std::wstring_view string)
         return false;
     }
 
-    const auto parts = Utils::SplitString(string, L';');
-
-    if (parts.size() < 1)
-    {
-        return false;
-    }
-
-    const auto action = til::at(parts, 0);
+    // Only the action is needed, so there's no point in splitting up the entire string.
+    auto remaining = string;
+    const auto action = til::prefix_split(remaining, L";");
 
     if (action == L"SetMark")
     {
@@ -3676,14 +3764,10 @@ bool AdaptDispatch::DoFinalTermAction(const std::wstring_view string)
         return false;
     }
 
-    const auto parts = Utils::SplitString(string, L';');
-
-    if (parts.size() < 1)
-    {
-        return false;
-    }
-
-    const auto action = til::at(parts, 0);
+    // The parameters are parsed one at a time, so that handling these doesn't allocate.
+    auto remaining = string;
+    const auto hasParameters = string.find(L';') != std::wstring_view::npos;
+    const auto action = til::prefix_split(remaining, L";");
     if (action.size() == 1)
     {
         switch (til::at(action, 0))
@@ -3709,9 +3793,9 @@ bool AdaptDispatch::DoFinalTermAction(const std::wstring_view string)
         case L'D': // FTCS_COMMAND_FINISHED
         {
             std::optional<unsigned int> error = std::nullopt;
-            if (parts.size() >= 2)
+            if (hasParameters)
             {
-                const auto errorString = til::at(parts, 1);
+                const auto errorString = til::prefix_split(remaining, L";");
 
                 // If we fail to parse the code, then it was gibberish, or it might
                 // have just started with "-". Either way, let's just treat it as an
@@ -3945,6 +4029,113 @@ ITermDispatch::StringHandler AdaptDispatch::_CreateDrcsPassthroughHandler(const
     return nullptr;
 }
 
+// Method Description:
+// - SIXEL - Defines an image in the sixel format, which gets drawn into the
+//   buffer at the cursor position once the data string is complete. The image
+//   is stored alongside the rows it covers and so it scrolls with the text.
+// Arguments:
+// - aspectRatio - The height of a sixel pixel in relation to its width.
+// - backgroundSelect - Whether unset pixels are transparent (1) or filled with color 0.
+// - gridSize - The distance between pixels in decipoints (ignored).
+// Return Value:
+// - a function to receive the image data or nullptr if images aren't supported.
+ITermDispatch::StringHandler AdaptDispatch::DefineSixelImage(const VTParameter aspectRatio,
+                                                             const VTParameter backgroundSelect,
+                                                             const VTParameter /*gridSize*/)
+{
+    // The VT renderer of a conpty has no way to forward the image to the
+    // connected terminal, so we'd only be reserving blank space for it.
+    if (_api.IsConsolePty())
+    {
+        return nullptr;
+    }
+
+    // The image can't be wider than the space to right of the cursor. We also limit the height
+    // to a few pages, because anything beyond that would just scroll past the user anyway.
+    const auto& textBuffer = _api.GetTextBuffer();
+    const auto viewport = _api.GetViewport();
+    const auto columns = textBuffer.GetSize().Width() - textBuffer.GetCursor().GetPosition().x;
+    const auto maxSize = til::size{ columns, (viewport.bottom - viewport.top) * 4 } * SixelParser::CellSize;
+
+    // StringHandler needs to be copyable, which is why the parser is held in a shared_ptr.
+    const auto parser = std::make_shared<SixelParser>(aspectRatio, backgroundSelect, maxSize);
+    return [this, parser](const auto ch) {
+        if (ch != AsciiChars::ESC)
+        {
+            parser->AddData(ch);
+        }
+        else
+        {
+            parser->FinalizeData();
+            _WriteSixelImage(*parser);
+        }
+        return true;
+    };
+}
+
+// Routine Description:
+// - Copies a decoded sixel image into the image slices of the rows starting at the cursor
+//   position, scrolling the buffer as needed. Afterwards the cursor is placed on the line
+//   below the image, in the column that the image starts in.
+// Arguments:
+// - parser - The parser holding the decoded image.
+// Return Value:
+// - <none>
+void AdaptDispatch::_WriteSixelImage(const SixelParser& parser)
+{
+    const auto size = parser.GetSize();
+    if (size.width <= 0 || size.height <= 0)
+    {
+        return;
+    }
+
+    auto& textBuffer = _api.GetTextBuffer();
+    auto& cursor = textBuffer.GetCursor();
+    const auto cellSize = SixelParser::CellSize;
+    const auto pixels = parser.GetPixels();
+    const auto stride = gsl::narrow_cast<size_t>(parser.GetStride());
+    const auto columnBegin = cursor.GetPosition().x;
+    const auto columnEnd = std::min(columnBegin + (size.width + cellSize.width - 1) / cellSize.width, textBuffer.GetSize().Width());
+    const auto rows = (size.height + cellSize.height - 1) / cellSize.height;
+    const auto width = std::min(size.width, (columnEnd - columnBegin) * cellSize.width);
+
+    // Turn off the cursor until we're done, so it isn't refreshed unnecessarily.
+    cursor.SetIsOn(false);
+
+    for (til::CoordType i = 0; i < rows; ++i)
+    {
+        if (i != 0)
+        {
+            _DoLineFeed(textBuffer, false, false);
+        }
+
+        const auto row = cursor.GetPosition().y;
+        auto& slice = textBuffer.GetMutableRowByOffset(row).GetMutableImageSlice(cellSize);
+        const auto dst = slice.MutablePixels(columnBegin, columnEnd);
+        const auto dstStride = gsl::narrow_cast<size_t>(slice.PixelWidth());
+        const auto top = i * cellSize.height;
+        const auto height = std::min(cellSize.height, size.height - top);
+
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            const auto src = pixels.subspan(gsl::narrow_cast<size_t>(top + y) * stride, gsl::narrow_cast<size_t>(width));
+            const auto dstRow = dst + y * dstStride;
+            for (size_t x = 0; x < src.size(); ++x)
+            {
+                // Transparent pixels leave any previous image in this spot untouched.
+                if (til::at(src, x).rgbReserved)
+                {
+                    dstRow[x] = til::at(src, x);
+                }
+            }
+        }
+
+        textBuffer.TriggerRedraw(Viewport::FromExclusive({ columnBegin, row, columnEnd, row + 1 }));
+    }
+
+    _DoLineFeed(textBuffer, false, false);
+}
+
 // Method Description:
 // - DECDMAC - Defines a string of characters as a macro that can later be
 //   invoked with a DECINVM sequence.
@@ -4638,7 +4829,7 @@ void AdaptDispatch::_ReportTabStops()
     auto need_separator = false;
     for (auto column = 0; column < width; column++)
     {
-        if (til::at(_tabStopColumns, column))
+        if (_IsTabStop(column))
         {
             response.append(need_separator ? L"/"sv : L""sv);
             fmt::format_to(std::back_inserter(response), FMT_COMPILE(L"{}"), column + 1);
@@ -4679,7 +4870,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreTabStops()
             // need to record an entry at that offset.
             if (column > 1u && column <= static_cast<size_t>(width))
             {
-                _tabStopColumns.at(column - 1) = true;
+                _SetTabStop(column - 1, true);
             }
             column = 0;
         }
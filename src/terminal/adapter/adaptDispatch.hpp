@@ -17,6 +17,7 @@ Author(s):
 #include "termDispatch.hpp"
 #include "ITerminalApi.hpp"
 #include "FontBuffer.hpp"
+#include "SixelParser.hpp"
 #include "MacroBuffer.hpp"
 #include "terminalOutput.hpp"
 #include "../input/terminalInput.hpp"
@@ -150,6 +151,10 @@ namespace Microsoft::Console::VirtualTerminal
                                    const VTParameter cellHeight,
                                    const DispatchTypes::DrcsCharsetSize charsetSize) override; // DECDLD
 
+        StringHandler DefineSixelImage(const VTParameter aspectRatio,
+                                       const VTParameter backgroundSelect,
+                                       const VTParameter gridSize) override; // SIXEL
+
         StringHandler DefineMacro(const VTInt macroId,
                                   const DispatchTypes::MacroDeleteControl deleteControl,
                                   const DispatchTypes::MacroEncoding encoding) override; // DECDMAC
@@ -252,6 +257,10 @@ namespace Microsoft::Console::VirtualTerminal
         void _ClearAllTabStops() noexcept;
         void _ResetTabStops() noexcept;
         void _InitTabStopsForWidth(const VTInt width);
+        bool _IsTabStop(const size_t column) const noexcept;
+        void _SetTabStop(const size_t column, const bool set);
+        size_t _NextTabStop(const size_t from, const size_t limit) const noexcept;
+        size_t _PreviousTabStop(const size_t from, const size_t limit) const noexcept;
 
         StringHandler _RestoreColorTable();
 
@@ -268,9 +277,13 @@ namespace Microsoft::Console::VirtualTerminal
         StringHandler _RestoreTabStops();
 
         StringHandler _CreateDrcsPassthroughHandler(const DispatchTypes::DrcsCharsetSize charsetSize);
+        void _WriteSixelImage(const SixelParser& parser);
         StringHandler _CreatePassthroughHandler();
 
-        std::vector<bool> _tabStopColumns;
+        // One bit per column, 64 columns per word, so that the next and
+        // previous tab stop can be found a word at a time.
+        std::vector<uint64_t> _tabStopColumns;
+        size_t _tabStopWidth = 0;
         bool _initDefaultTabStops = true;
 
         ITerminalApi& _api;
@@ -278,6 +291,7 @@ namespace Microsoft::Console::VirtualTerminal
         RenderSettings& _renderSettings;
         TerminalInput& _terminalInput;
         TerminalOutput _termOutput;
+        std::wstring _translatedString;
         std::unique_ptr<FontBuffer> _fontBuffer;
         std::shared_ptr<MacroBuffer> _macroBuffer;
         std::optional<unsigned int> _initialCodePage;
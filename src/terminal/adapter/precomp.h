@@ -13,6 +13,7 @@ Abstract:
 // This includes support libraries from the CRT, STL, WIL, and GSL
 #include "LibraryIncludes.h"
 
+#include <bit>
 #include <cmath>
 #define ENABLE_INTSAFE_SIGNED_FUNCTIONS
 #include <intsafe.h>
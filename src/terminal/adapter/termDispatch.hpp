@@ -141,6 +141,10 @@ public:
                                const VTParameter /*cellHeight*/,
                                const DispatchTypes::DrcsCharsetSize /*charsetSize*/) override { return nullptr; } // DECDLD
 
+    StringHandler DefineSixelImage(const VTParameter /*aspectRatio*/,
+                                   const VTParameter /*backgroundSelect*/,
+                                   const VTParameter /*gridSize*/) override { return nullptr; } // SIXEL
+
     StringHandler DefineMacro(const VTInt /*macroId*/,
                               const DispatchTypes::MacroDeleteControl /*deleteControl*/,
                               const DispatchTypes::MacroEncoding /*encoding*/) override { return nullptr; } // DECDMAC
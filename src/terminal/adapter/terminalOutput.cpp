@@ -167,6 +167,43 @@ wchar_t TerminalOutput::TranslateKey(const wchar_t wch) const noexcept
     return wchFound;
 }
 
+// Routine Description:
+// - Translates an entire string, which is equivalent to calling TranslateKey()
+//   for each of its characters, but avoids re-checking the single shift state
+//   and the bounds checks of the tables for every single one of them.
+// Arguments:
+// - string - The text to translate.
+// - buffer - Receives the translated text. Its previous contents are replaced.
+// Return Value:
+// - <none>
+void TerminalOutput::TranslateString(const std::wstring_view string, std::wstring& buffer) const
+{
+    buffer.resize(string.size());
+
+    auto in = string.begin();
+    const auto end = string.end();
+    auto out = buffer.begin();
+
+    // A single shift only ever applies to the first character.
+    if (_ssSetNumber != 0 && in != end)
+    {
+        *out++ = TranslateKey(*in++);
+    }
+
+    // The tables hold at most 96 entries for the ranges starting at 0x20 (GL) and 0xA0 (GR).
+    // An empty table means that the respective range is left untouched.
+    const auto gl = _glTranslationTable;
+    const auto gr = _grTranslationTable;
+    for (; in != end; ++in, ++out)
+    {
+        const auto wch = *in;
+        const auto glIndex = wch - 0x20u;
+        const auto grIndex = wch - 0xA0u;
+#pragma warning(suppress : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+        *out = glIndex < gl.size() ? gl[glIndex] : grIndex < gr.size() ? gr[grIndex] : wch;
+    }
+}
+
 const std::wstring_view TerminalOutput::_LookupTranslationTable94(const VTID charset) const
 {
     // Note that the DRCS set can be designated with either a 94 or 96 sequence,
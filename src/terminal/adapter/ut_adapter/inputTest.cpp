@@ -36,6 +36,7 @@ public:
     TEST_METHOD(CtrlNumTest);
     TEST_METHOD(BackarrowKeyModeTest);
     TEST_METHOD(AutoRepeatModeTest);
+    TEST_METHOD(Win32InputModeTest);
 
     wchar_t GetModifierChar(const bool fShift, const bool fAlt, const bool fCtrl)
     {
@@ -684,3 +685,32 @@ void InputTest::AutoRepeatModeTest()
     VERIFY_ARE_EQUAL(TerminalInput::MakeOutput(L"A"), input.HandleKey(down));
     VERIFY_ARE_EQUAL(TerminalInput::MakeUnhandled(), input.HandleKey(up));
 }
+
+void InputTest::Win32InputModeTest()
+{
+    static constexpr auto down = SynthesizeKeyEvent(true, 1, 'A', 30, 'a', 0);
+    static constexpr auto up = SynthesizeKeyEvent(false, 1, 'A', 30, 'a', 0);
+    static constexpr auto large = SynthesizeKeyEvent(true, 65535, 65535, 65535, 65535, 65535);
+    TerminalInput input;
+    input.SetInputMode(TerminalInput::Mode::Win32, true);
+
+    Log::Comment(L"Encoding key events, including ones that were encoded before.");
+
+    VERIFY_ARE_EQUAL(TerminalInput::MakeOutput(L"\x1b[65;30;97;1;0;1_"), input.HandleKey(down));
+    VERIFY_ARE_EQUAL(TerminalInput::MakeOutput(L"\x1b[65;30;97;0;0;1_"), input.HandleKey(up));
+    VERIFY_ARE_EQUAL(TerminalInput::MakeOutput(L"\x1b[65;30;97;1;0;1_"), input.HandleKey(down));
+    VERIFY_ARE_EQUAL(TerminalInput::MakeOutput(L"\x1b[65535;65535;65535;1;65535;65535_"), input.HandleKey(large));
+
+    Log::Comment(L"Appending a batch of key events to a single string.");
+
+    TerminalInput::StringType str;
+    VERIFY_IS_TRUE(input.HandleKey(down, str));
+    VERIFY_IS_TRUE(input.HandleKey(up, str));
+    VERIFY_ARE_EQUAL(L"\x1b[65;30;97;1;0;1_\x1b[65;30;97;0;0;1_", str);
+
+    Log::Comment(L"Events that aren't keys are left to the caller.");
+
+    INPUT_RECORD mouse{};
+    mouse.EventType = MOUSE_EVENT;
+    VERIFY_IS_FALSE(input.HandleKey(mouse, str));
+}
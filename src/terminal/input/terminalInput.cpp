@@ -490,7 +490,9 @@ TerminalInput::OutputType TerminalInput::HandleKey(const INPUT_RECORD& event)
     // Only do this if win32-input-mode support isn't manually disabled.
     if (_inputMode.test(Mode::Win32) && !_forceDisableWin32InputMode)
     {
-        return _makeWin32Output(keyEvent);
+        StringType str;
+        _appendWin32Output(keyEvent, str);
+        return str;
     }
 
     // Check if this key matches the last recorded key code.
@@ -663,6 +665,32 @@ TerminalInput::OutputType TerminalInput::HandleKey(const INPUT_RECORD& event)
     return MakeUnhandled();
 }
 
+// Routine Description:
+// - Same as HandleKey() above, but appends the VT input sequence to the given string.
+//   This allows translating a batch of input events into a single string without
+//   allocating memory for each one of them, at least in win32-input-mode.
+// Arguments:
+// - event - Key event to translate
+// - out - The string to append the VT input sequence to
+// Return Value:
+// - Returns false if we didn't handle the event, just like HandleKey() does.
+bool TerminalInput::HandleKey(const INPUT_RECORD& event, StringType& out)
+{
+    if (event.EventType == KEY_EVENT && _inputMode.test(Mode::Win32) && !_forceDisableWin32InputMode)
+    {
+        _appendWin32Output(event.Event.KeyEvent, out);
+        return true;
+    }
+
+    if (const auto str = HandleKey(event))
+    {
+        out.append(*str);
+        return true;
+    }
+
+    return false;
+}
+
 TerminalInput::OutputType TerminalInput::HandleFocus(const bool focused) const
 {
     if (!_inputMode.test(Mode::FocusEvent))
@@ -713,10 +741,25 @@ TerminalInput::OutputType TerminalInput::_makeEscapedOutput(const wchar_t wch)
     return str;
 }
 
-// Turns an KEY_EVENT_RECORD into a win32-input-mode VT sequence.
+// Turns an KEY_EVENT_RECORD into a win32-input-mode VT sequence and appends it to `out`.
 // It allows us to send KEY_EVENT_RECORD data losslessly to conhost.
-TerminalInput::OutputType TerminalInput::_makeWin32Output(const KEY_EVENT_RECORD& key)
+void TerminalInput::_appendWin32Output(const KEY_EVENT_RECORD& key, StringType& out)
 {
+    for (const auto& entry : _win32SequenceCache)
+    {
+        if (entry.length != 0 &&
+            entry.key.bKeyDown == key.bKeyDown &&
+            entry.key.wRepeatCount == key.wRepeatCount &&
+            entry.key.wVirtualKeyCode == key.wVirtualKeyCode &&
+            entry.key.wVirtualScanCode == key.wVirtualScanCode &&
+            entry.key.uChar.UnicodeChar == key.uChar.UnicodeChar &&
+            entry.key.dwControlKeyState == key.dwControlKeyState)
+        {
+            out.append(entry.sequence.data(), entry.length);
+            return;
+        }
+    }
+
     // .uChar.UnicodeChar must be cast to an integer because we want its numerical value.
     // Casting the rest to uint16_t as well doesn't hurt because that's MAX_PARAMETER_VALUE anyways.
     const auto kd = gsl::narrow_cast<uint16_t>(key.bKeyDown ? 1 : 0);
@@ -737,5 +780,37 @@ TerminalInput::OutputType TerminalInput::_makeWin32Output(const KEY_EVENT_RECORD
     //      Kd: the value of bKeyDown - either a '0' or '1'. If omitted, defaults to '0'.
     //      Cs: the value of dwControlKeyState - any number. If omitted, defaults to '0'.
     //      Rc: the value of wRepeatCount - any number. If omitted, defaults to '1'.
-    return fmt::format(FMT_COMPILE(L"\x1b[{};{};{};{};{};{}_"), vk, sc, uc, kd, cs, rc);
+    auto& entry = til::at(_win32SequenceCache, _win32SequenceCacheNext);
+    _win32SequenceCacheNext = (_win32SequenceCacheNext + 1) % _win32SequenceCache.size();
+
+    auto& seq = entry.sequence;
+    size_t len = 0;
+    const auto appendNumber = [&](uint16_t value, wchar_t terminator) {
+        // Digits are produced in reverse, so they're written to the end of a scratch buffer first.
+        std::array<wchar_t, 5> digits{};
+        auto beg = digits.size();
+        do
+        {
+            til::at(digits, --beg) = gsl::narrow_cast<wchar_t>(L'0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        for (; beg < digits.size(); ++beg)
+        {
+            til::at(seq, len++) = til::at(digits, beg);
+        }
+        til::at(seq, len++) = terminator;
+    };
+
+    til::at(seq, len++) = L'\x1b';
+    til::at(seq, len++) = L'[';
+    appendNumber(vk, L';');
+    appendNumber(sc, L';');
+    appendNumber(uc, L';');
+    appendNumber(kd, L';');
+    appendNumber(cs, L';');
+    appendNumber(rc, L'_');
+
+    entry.key = key;
+    entry.length = len;
+    out.append(seq.data(), len);
 }
@@ -21,6 +21,7 @@ namespace Microsoft::Console::VirtualTerminal
         static [[nodiscard]] OutputType MakeUnhandled() noexcept;
         static [[nodiscard]] OutputType MakeOutput(const std::wstring_view& str);
         [[nodiscard]] OutputType HandleKey(const INPUT_RECORD& pInEvent);
+        bool HandleKey(const INPUT_RECORD& event, StringType& out);
         [[nodiscard]] OutputType HandleFocus(bool focused) const;
         [[nodiscard]] OutputType HandleMouse(til::point position, unsigned int button, short modifierKeyState, short delta, MouseButtonState state);
 
@@ -73,9 +74,24 @@ namespace Microsoft::Console::VirtualTerminal
         til::enumset<Mode> _inputMode{ Mode::Ansi, Mode::AutoRepeat };
         bool _forceDisableWin32InputMode{ false };
 
+        // The longest win32-input-mode sequence: "\x1b[" + 5 numbers with up to 5 digits + "1" + 5 ";" + "_".
+        static constexpr size_t _win32SequenceMaxLength = 34;
+
+        struct Win32SequenceCacheEntry
+        {
+            KEY_EVENT_RECORD key{};
+            size_t length = 0;
+            std::array<wchar_t, _win32SequenceMaxLength> sequence{};
+        };
+
+        // Key repeat and automated input produce the same few key events over and over again,
+        // which is why the most recently encoded win32-input-mode sequences are kept around.
+        std::array<Win32SequenceCacheEntry, 4> _win32SequenceCache{};
+        size_t _win32SequenceCacheNext = 0;
+
         [[nodiscard]] OutputType _makeCharOutput(wchar_t ch);
         static [[nodiscard]] OutputType _makeEscapedOutput(wchar_t wch);
-        static [[nodiscard]] OutputType _makeWin32Output(const KEY_EVENT_RECORD& key);
+        void _appendWin32Output(const KEY_EVENT_RECORD& key, StringType& out);
         static [[nodiscard]] OutputType _searchWithModifier(const KEY_EVENT_RECORD& keyEvent);
 
 #pragma region MouseInputState Management
@@ -689,6 +689,9 @@ IStateMachineEngine::StringHandler OutputStateMachineEngine::ActionDcsDispatch(c
                                           parameters.at(6),
                                           parameters.at(7));
         break;
+    case DcsActionCodes::SIXEL_DefineImage:
+        handler = _dispatch->DefineSixelImage(parameters.at(0), parameters.at(1), parameters.at(2));
+        break;
     case DcsActionCodes::DECDMAC_DefineMacro:
         handler = _dispatch->DefineMacro(parameters.at(0).value_or(0), parameters.at(1), parameters.at(2));
         break;
@@ -758,68 +761,20 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
     case OscActionCodes::SetWindowIcon:
     case OscActionCodes::SetWindowTitle:
     {
-        std::wstring title;
-        success = _GetOscTitle(string, title);
-        success = success && _dispatch->SetWindowTitle(title);
+        // The string is a view into the parser's buffer and can be passed along as is.
+        success = !string.empty() && _dispatch->SetWindowTitle(string);
         break;
     }
     case OscActionCodes::SetColor:
     {
-        std::vector<size_t> tableIndexes;
-        std::vector<DWORD> colors;
-        success = _GetOscSetColorTable(string, tableIndexes, colors);
-        for (size_t i = 0; i < tableIndexes.size(); i++)
-        {
-            const auto tableIndex = til::at(tableIndexes, i);
-            const auto rgb = til::at(colors, i);
-            success = success && _dispatch->SetColorTableEntry(tableIndex, rgb);
-        }
+        success = _SetOscColorTable(string);
         break;
     }
     case OscActionCodes::SetForegroundColor:
     case OscActionCodes::SetBackgroundColor:
     case OscActionCodes::SetCursorColor:
     {
-        std::vector<DWORD> colors;
-        success = _GetOscSetColor(string, colors);
-        if (success)
-        {
-            auto commandIndex = parameter;
-            size_t colorIndex = 0;
-
-            if (commandIndex == OscActionCodes::SetForegroundColor && colors.size() > colorIndex)
-            {
-                const auto color = til::at(colors, colorIndex);
-                if (color != INVALID_COLOR)
-                {
-                    success = success && _dispatch->SetDefaultForeground(color);
-                }
-                commandIndex++;
-                colorIndex++;
-            }
-
-            if (commandIndex == OscActionCodes::SetBackgroundColor && colors.size() > colorIndex)
-            {
-                const auto color = til::at(colors, colorIndex);
-                if (color != INVALID_COLOR)
-                {
-                    success = success && _dispatch->SetDefaultBackground(color);
-                }
-                commandIndex++;
-                colorIndex++;
-            }
-
-            if (commandIndex == OscActionCodes::SetCursorColor && colors.size() > colorIndex)
-            {
-                const auto color = til::at(colors, colorIndex);
-                if (color != INVALID_COLOR)
-                {
-                    success = success && _dispatch->SetCursorColor(color);
-                }
-                commandIndex++;
-                colorIndex++;
-            }
-        }
+        success = _SetOscColors(parameter, string);
         break;
     }
     case OscActionCodes::SetClipboard:
@@ -840,8 +795,8 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
     }
     case OscActionCodes::Hyperlink:
     {
-        std::wstring params;
-        std::wstring uri;
+        std::wstring_view params;
+        std::wstring_view uri;
         success = _ParseHyperlink(string, params, uri);
         if (uri.empty())
         {
@@ -907,63 +862,86 @@ bool OutputStateMachineEngine::ActionSs3Dispatch(const wchar_t /*wch*/, const VT
     return false;
 }
 
-// Routine Description:
-// - Null terminates, then returns, the string that we've collected as part of the OSC string.
-// Arguments:
-// - string - Osc String input
-// - title - Where to place the Osc String to use as a title.
-// Return Value:
-// - True if there was a title to output. (a title with length=0 is still valid)
-bool OutputStateMachineEngine::_GetOscTitle(const std::wstring_view string,
-                                            std::wstring& title) const
-{
-    title = string;
-
-    return !string.empty();
-}
-
 // Routine Description:
 // - OSC 4 ; c ; spec ST
 //      c: the index of the ansi color table
 //      spec: The colors are specified by name or RGB specification as per XParseColor
 //
 //   It's possible to have multiple "c ; spec" pairs, which will set the index "c" of the color table
-//   with color parsed from "spec" for each pair respectively.
+//   with color parsed from "spec" for each pair respectively. The pairs are parsed and dispatched
+//   one at a time straight out of the given string, so that this doesn't need to allocate.
 // Arguments:
 // - string - the Osc String to parse
-// - tableIndexes - receives the table indexes
-// - rgbs - receives the colors that we parsed in the format: 0x00BBGGRR
 // Return Value:
-// - True if at least one table index and color was parsed successfully. False otherwise.
-bool OutputStateMachineEngine::_GetOscSetColorTable(const std::wstring_view string,
-                                                    std::vector<size_t>& tableIndexes,
-                                                    std::vector<DWORD>& rgbs) const
+// - True if at least one table index and color was parsed successfully and all of them were dispatched.
+bool OutputStateMachineEngine::_SetOscColorTable(const std::wstring_view string)
 {
-    const auto parts = Utils::SplitString(string, L';');
-    if (parts.size() < 2)
-    {
-        return false;
-    }
-
-    std::vector<size_t> newTableIndexes;
-    std::vector<DWORD> newRgbs;
+    auto remaining = string;
+    auto parsed = false;
+    auto success = true;
 
-    for (size_t i = 0, j = 1; j < parts.size(); i += 2, j += 2)
+    // An index is only part of a pair if there's a (potentially empty) color after it.
+    while (remaining.find(L';') != std::wstring_view::npos)
     {
+        const auto indexPart = til::prefix_split(remaining, L";");
+        const auto colorPart = til::prefix_split(remaining, L";");
+
         unsigned int tableIndex = 0;
-        const auto indexSuccess = Utils::StringToUint(til::at(parts, i), tableIndex);
-        const auto colorOptional = Utils::ColorFromXTermColor(til::at(parts, j));
+        const auto indexSuccess = Utils::StringToUint(indexPart, tableIndex);
+        const auto colorOptional = Utils::ColorFromXTermColor(colorPart);
         if (indexSuccess && colorOptional.has_value())
         {
-            newTableIndexes.push_back(tableIndex);
-            newRgbs.push_back(colorOptional.value());
+            parsed = true;
+            success = success && _dispatch->SetColorTableEntry(tableIndex, colorOptional.value());
         }
     }
 
-    tableIndexes.swap(newTableIndexes);
-    rgbs.swap(newRgbs);
+    return parsed && success;
+}
 
-    return tableIndexes.size() > 0 && rgbs.size() > 0;
+// Routine Description:
+// - OSC 10, 11, 12 ; spec ST
+//      spec: The colors are specified by name or RGB specification as per XParseColor
+//
+//   It's possible to have multiple "spec", which by design equals to a series of OSC command
+//   with accumulated Ps. For example "OSC 10;color1;color2" is effectively an "OSC 10;color1"
+//   and an "OSC 11;color2". Specs that fail to parse are skipped, but still advance the Ps.
+// Arguments:
+// - parameter - the OSC command that the first spec applies to
+// - string - the Osc String to parse
+// Return Value:
+// - True if all of the parsed colors were dispatched successfully.
+bool OutputStateMachineEngine::_SetOscColors(const size_t parameter, const std::wstring_view string)
+{
+    auto remaining = string;
+    auto commandIndex = parameter;
+    auto success = true;
+
+    do
+    {
+        const auto colorOptional = Utils::ColorFromXTermColor(til::prefix_split(remaining, L";"));
+        if (colorOptional.has_value())
+        {
+            const DWORD color = colorOptional.value();
+            switch (commandIndex)
+            {
+            case OscActionCodes::SetForegroundColor:
+                success = success && _dispatch->SetDefaultForeground(color);
+                break;
+            case OscActionCodes::SetBackgroundColor:
+                success = success && _dispatch->SetDefaultBackground(color);
+                break;
+            case OscActionCodes::SetCursorColor:
+                success = success && _dispatch->SetCursorColor(color);
+                break;
+            default:
+                break;
+            }
+        }
+        commandIndex++;
+    } while (!remaining.empty() && commandIndex <= OscActionCodes::SetCursorColor);
+
+    return success;
 }
 
 #pragma warning(push)
@@ -980,16 +958,16 @@ bool OutputStateMachineEngine::_GetOscSetColorTable(const std::wstring_view stri
 //          ";"
 // Arguments:
 // - string - the string containing the parameters and URI
-// - params - where to store the parameters
-// - uri - where to store the uri
+// - params - receives a view of the id parameter within string
+// - uri - receives a view of the uri within string
 // Return Value:
 // - True if a URI was successfully parsed or if we are meant to close a hyperlink
 bool OutputStateMachineEngine::_ParseHyperlink(const std::wstring_view string,
-                                               std::wstring& params,
-                                               std::wstring& uri) const
+                                               std::wstring_view& params,
+                                               std::wstring_view& uri) const
 {
-    params.clear();
-    uri.clear();
+    params = {};
+    uri = {};
 
     if (string == L";")
     {
@@ -1000,10 +978,10 @@ bool OutputStateMachineEngine::_ParseHyperlink(const std::wstring_view string,
     if (midPos != std::wstring::npos)
     {
         uri = string.substr(midPos + 1, MAX_URL_LENGTH);
-        const auto paramStr = string.substr(0, midPos);
-        const auto paramParts = Utils::SplitString(paramStr, ':');
-        for (const auto& part : paramParts)
+        auto paramStr = string.substr(0, midPos);
+        while (!paramStr.empty())
         {
+            const auto part = til::prefix_split(paramStr, L":");
             const auto idPos = part.find(hyperlinkIDParameter);
             if (idPos != std::wstring::npos)
             {
@@ -1017,47 +995,6 @@ bool OutputStateMachineEngine::_ParseHyperlink(const std::wstring_view string,
 
 #pragma warning(pop)
 
-// Routine Description:
-// - OSC 10, 11, 12 ; spec ST
-//      spec: The colors are specified by name or RGB specification as per XParseColor
-//
-//   It's possible to have multiple "spec", which by design equals to a series of OSC command
-//   with accumulated Ps. For example "OSC 10;color1;color2" is effectively an "OSC 10;color1"
-//   and an "OSC 11;color2".
-//
-// Arguments:
-// - string - the Osc String to parse
-// - rgbs - receives the colors that we parsed in the format: 0x00BBGGRR
-// Return Value:
-// - True if at least one color was parsed successfully. False otherwise.
-bool OutputStateMachineEngine::_GetOscSetColor(const std::wstring_view string,
-                                               std::vector<DWORD>& rgbs) const
-{
-    const auto parts = Utils::SplitString(string, L';');
-    if (parts.size() < 1)
-    {
-        return false;
-    }
-
-    std::vector<DWORD> newRgbs;
-    for (size_t i = 0; i < parts.size(); i++)
-    {
-        const auto colorOptional = Utils::ColorFromXTermColor(til::at(parts, i));
-        if (colorOptional.has_value())
-        {
-            newRgbs.push_back(colorOptional.value());
-        }
-        else
-        {
-            newRgbs.push_back(INVALID_COLOR);
-        }
-    }
-
-    rgbs.swap(newRgbs);
-
-    return rgbs.size() > 0;
-}
-
 // Method Description:
 // - Sets us up to have another terminal acting as the tty instead of conhost.
 //      We'll set a couple members, and if they aren't null, when we get a
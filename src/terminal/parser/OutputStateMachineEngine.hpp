@@ -22,7 +22,7 @@ namespace Microsoft::Console::Render
 
 namespace Microsoft::Console::VirtualTerminal
 {
-    class OutputStateMachineEngine : public IStateMachineEngine
+    class OutputStateMachineEngine final : public IStateMachineEngine
     {
     public:
         static constexpr size_t MAX_URL_LENGTH = 2 * 1048576; // 2MB, like iTerm2
@@ -172,6 +172,7 @@ namespace Microsoft::Console::VirtualTerminal
         enum DcsActionCodes : uint64_t
         {
             DECDLD_DownloadDRCS = VTID("{"),
+            SIXEL_DefineImage = VTID("q"),
             DECDMAC_DefineMacro = VTID("!z"),
             DECRSTS_RestoreTerminalState = VTID("$p"),
             DECRQSS_RequestSetting = VTID("$q"),
@@ -218,15 +219,9 @@ namespace Microsoft::Console::VirtualTerminal
             ITerm2Action = 1337,
         };
 
-        bool _GetOscTitle(const std::wstring_view string,
-                          std::wstring& title) const;
+        bool _SetOscColorTable(const std::wstring_view string);
 
-        bool _GetOscSetColorTable(const std::wstring_view string,
-                                  std::vector<size_t>& tableIndexes,
-                                  std::vector<DWORD>& rgbs) const;
-
-        bool _GetOscSetColor(const std::wstring_view string,
-                             std::vector<DWORD>& rgbs) const;
+        bool _SetOscColors(const size_t parameter, const std::wstring_view string);
 
         bool _GetOscSetClipboard(const std::wstring_view string,
                                  std::wstring& content,
@@ -234,8 +229,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         static constexpr std::wstring_view hyperlinkIDParameter{ L"id=" };
         bool _ParseHyperlink(const std::wstring_view string,
-                             std::wstring& params,
-                             std::wstring& uri) const;
+                             std::wstring_view& params,
+                             std::wstring_view& uri) const;
 
         bool _CanSeqAcceptSubParam(const VTID id, const VTParameters& parameters) noexcept;
 
@@ -10,6 +10,7 @@
 #pragma warning(disable : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
 #pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
 #pragma warning(disable : 26482) // Only index into arrays using constant expressions (bounds.2).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
 
 using namespace Microsoft::Console::VirtualTerminal;
 
@@ -24,8 +25,63 @@ static constexpr uint8_t decodeTable[128] = {
     255 /* `   */, 26  /* a   */, 27  /* b   */, 28  /* c   */, 29  /* d   */, 30  /* e   */, 31  /* f   */, 32  /* g   */, 33  /* h   */, 34  /* i   */, 35  /* j   */, 36  /* k   */, 37  /* l   */, 38  /* m   */, 39  /* n   */, 40  /* o   */,
     41  /* p   */, 42  /* q   */, 43  /* r   */, 44  /* s   */, 45  /* t   */, 46  /* u   */, 47  /* v   */, 48  /* w   */, 49  /* x   */, 50  /* y   */, 51  /* z   */, 255 /* {   */, 255 /* |   */, 255 /* }   */, 255 /* ~   */, 255 /* DEL */,
 };
+static constexpr char encodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 // clang-format on
 
+#if defined(TIL_SSE_INTRINSICS)
+// Decodes 8 base64 characters into 6 bytes. Returns false without writing anything if any of
+// the characters isn't part of the alphabet (including "=") and leaves them to the scalar code.
+static bool decode8(const wchar_t* in, char* out) noexcept
+{
+    const auto ch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const auto z = _mm_setzero_si128();
+
+    // SSE2 lacks unsigned comparisons, which is why this checks for "ch - first < count" by
+    // subtracting count - 1 with saturation ("SubS") and checking whether the result is 0.
+    const auto inRange = [&](const wchar_t first, const short count) noexcept {
+        const auto offset = _mm_sub_epi16(ch, _mm_set1_epi16(static_cast<short>(first)));
+        return _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(count - 1)), z);
+    };
+    const auto equals = [&](const wchar_t a, const wchar_t b) noexcept {
+        return _mm_or_si128(_mm_cmpeq_epi16(ch, _mm_set1_epi16(static_cast<short>(a))), _mm_cmpeq_epi16(ch, _mm_set1_epi16(static_cast<short>(b))));
+    };
+
+    const auto upper = inRange(L'A', 26);
+    const auto lower = inRange(L'a', 26);
+    const auto digit = inRange(L'0', 10);
+    const auto plus = equals(L'+', L'-');
+    const auto slash = equals(L'/', L'_');
+
+    const auto valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), digit), _mm_or_si128(plus, slash));
+    if (_mm_movemask_epi8(valid) != 0xffff)
+    {
+        return false;
+    }
+
+    // Same as decodeTable, but computed from the character ranges.
+    auto n = _mm_and_si128(upper, _mm_sub_epi16(ch, _mm_set1_epi16(L'A')));
+    n = _mm_or_si128(n, _mm_and_si128(lower, _mm_sub_epi16(ch, _mm_set1_epi16(L'a' - 26))));
+    n = _mm_or_si128(n, _mm_and_si128(digit, _mm_add_epi16(ch, _mm_set1_epi16(52 - L'0'))));
+    n = _mm_or_si128(n, _mm_and_si128(plus, _mm_set1_epi16(62)));
+    n = _mm_or_si128(n, _mm_and_si128(slash, _mm_set1_epi16(63)));
+
+    // Each 16-bit lane now holds 6 bits. Combine pairs of them into 12 bits per 32-bit lane (n0 << 6 | n1)
+    // and then pairs of those into 24 bits in the low half of each 64-bit lane (v0 << 12 | v1).
+    auto v = _mm_madd_epi16(n, _mm_set1_epi32(0x00010040));
+    v = _mm_or_si128(_mm_slli_epi64(v, 12), _mm_srli_epi64(v, 32));
+
+    const auto lo = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+    const auto hi = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 8)));
+    out[0] = gsl::narrow_cast<char>(lo >> 16);
+    out[1] = gsl::narrow_cast<char>(lo >> 8);
+    out[2] = gsl::narrow_cast<char>(lo >> 0);
+    out[3] = gsl::narrow_cast<char>(hi >> 16);
+    out[4] = gsl::narrow_cast<char>(hi >> 8);
+    out[5] = gsl::narrow_cast<char>(hi >> 0);
+    return true;
+}
+#endif
+
 // Decodes an UTF8 string encoded with RFC 4648 (Base64) and returns it as UTF16 in dst.
 // It supports both variants of the RFC (base64 and base64url), but
 // throws an error for non-alphabet characters, including newlines.
@@ -85,6 +141,16 @@ HRESULT Base64::Decode(const std::wstring_view& src, std::wstring& dst) noexcept
         r = r << 6 | n;
     };
 
+#if defined(TIL_SSE_INTRINSICS)
+    // OSC 52 clipboard payloads can be megabytes large, so it's worth decoding 8 characters at a time.
+    // This stops at the first non-alphabet character. Since it only ever consumes multiples of 4
+    // characters, the loops below can continue as if they had processed these characters themselves.
+    // If src.empty() then `in == inEnd == nullptr` and this is skipped.
+    for (; inEnd - in >= 8 && decode8(in, out); in += 8, out += 6)
+    {
+    }
+#endif
+
     // If src.empty() then `in == inEndBatched == nullptr` and this is skipped.
     while (in < inEndBatched)
     {
@@ -156,3 +222,53 @@ HRESULT Base64::Decode(const std::wstring_view& src, std::wstring& dst) noexcept
     result.resize(out - outBeg);
     return til::u8u16(result, dst);
 }
+
+// Encodes the UTF16 string src as UTF8 with RFC 4648 (Base64) and returns it in dst,
+// padded with "=" to a multiple of 4 characters. This is the inverse of Decode().
+HRESULT Base64::Encode(const std::wstring_view& src, std::wstring& dst) noexcept
+{
+    std::string utf8;
+    RETURN_IF_FAILED(til::u16u8(src, utf8));
+
+    dst.resize(((utf8.size() + 2) / 3) * 4);
+
+    const auto in = reinterpret_cast<const uint8_t*>(utf8.data());
+    const auto inEnd = in + utf8.size();
+    auto it = in;
+    auto out = dst.data();
+
+    for (; inEnd - it >= 3; it += 3)
+    {
+        const uint_fast32_t r = it[0] << 16 | it[1] << 8 | it[2];
+        *out++ = encodeTable[r >> 18];
+        *out++ = encodeTable[(r >> 12) & 0x3f];
+        *out++ = encodeTable[(r >> 6) & 0x3f];
+        *out++ = encodeTable[r & 0x3f];
+    }
+
+    switch (inEnd - it)
+    {
+    case 1:
+    {
+        const uint_fast32_t r = it[0] << 16;
+        *out++ = encodeTable[r >> 18];
+        *out++ = encodeTable[(r >> 12) & 0x3f];
+        *out++ = L'=';
+        *out++ = L'=';
+        break;
+    }
+    case 2:
+    {
+        const uint_fast32_t r = it[0] << 16 | it[1] << 8;
+        *out++ = encodeTable[r >> 18];
+        *out++ = encodeTable[(r >> 12) & 0x3f];
+        *out++ = encodeTable[(r >> 6) & 0x3f];
+        *out++ = L'=';
+        break;
+    }
+    default:
+        break;
+    }
+
+    return S_OK;
+}
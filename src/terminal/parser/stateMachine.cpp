@@ -4,11 +4,16 @@
 #include "precomp.h"
 
 #include "stateMachine.hpp"
+#include "OutputStateMachineEngine.hpp"
+
+#include <isa_availability.h>
 
 #include "ascii.hpp"
 
 using namespace Microsoft::Console::VirtualTerminal;
 
+extern "C" int __isa_available;
+
 //Takes ownership of the pEngine.
 StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine, const bool isEngineForInput) :
     _engine(std::move(engine)),
@@ -368,6 +373,70 @@ static constexpr bool _isApcIndicator(const wchar_t wch) noexcept
     return wch == L'_'; // 0x5F
 }
 
+// The character classes used by the table-driven CSI, SS3 and DCS states.
+// Within these states every character of the same class triggers the same
+// action and transition, which allows us to replace the chains of _is*()
+// checks with a lookup into a state x class table. See _EventFromTransitionTable.
+enum class CharClass : uint8_t
+{
+    C0, // _isC0Code
+    Delete, // _isDelete
+    Intermediate, // _isIntermediate
+    Digit, // _isNumericParamValue
+    SubParameterDelimiter, // _isSubParameterDelimiter
+    ParameterDelimiter, // _isParameterDelimiter
+    PrivateMarker, // _isCsiPrivateMarker
+    Final, // Everything else
+    Count,
+};
+
+static constexpr auto s_charClasses = []() {
+    std::array<CharClass, 128> classes{};
+    for (size_t i = 0; i < classes.size(); ++i)
+    {
+        const auto wch = static_cast<wchar_t>(i);
+        auto& c = classes[i];
+        if (_isC0Code(wch))
+        {
+            c = CharClass::C0;
+        }
+        else if (_isDelete(wch))
+        {
+            c = CharClass::Delete;
+        }
+        else if (_isIntermediate(wch))
+        {
+            c = CharClass::Intermediate;
+        }
+        else if (_isNumericParamValue(wch))
+        {
+            c = CharClass::Digit;
+        }
+        else if (_isSubParameterDelimiter(wch))
+        {
+            c = CharClass::SubParameterDelimiter;
+        }
+        else if (_isParameterDelimiter(wch))
+        {
+            c = CharClass::ParameterDelimiter;
+        }
+        else if (_isCsiPrivateMarker(wch))
+        {
+            c = CharClass::PrivateMarker;
+        }
+        else
+        {
+            c = CharClass::Final;
+        }
+    }
+    return classes;
+}();
+
+static constexpr CharClass _classify(const wchar_t wch) noexcept
+{
+    return wch < s_charClasses.size() ? til::at(s_charClasses, wch) : CharClass::Final;
+}
+
 #pragma warning(pop)
 
 // Routine Description:
@@ -380,7 +449,7 @@ void StateMachine::_ActionExecute(const wchar_t wch)
 {
     _trace.TraceOnExecute(wch);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
-        return _engine->ActionExecute(wch);
+        return _outputEngine ? _outputEngine->ActionExecute(wch) : _engine->ActionExecute(wch);
     }));
 }
 
@@ -410,7 +479,7 @@ void StateMachine::_ActionPrint(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Print");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
-        return _engine->ActionPrint(wch);
+        return _outputEngine ? _outputEngine->ActionPrint(wch) : _engine->ActionPrint(wch);
     }));
 }
 
@@ -423,7 +492,7 @@ void StateMachine::_ActionPrint(const wchar_t wch)
 void StateMachine::_ActionPrintString(const std::wstring_view string)
 {
     _SafeExecute([=]() {
-        return _engine->ActionPrintString(string);
+        return _outputEngine ? _outputEngine->ActionPrintString(string) : _engine->ActionPrintString(string);
     });
     _trace.DispatchPrintRunTrace(string);
 }
@@ -469,8 +538,9 @@ void StateMachine::_ActionCsiDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"CsiDispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
-        return _engine->ActionCsiDispatch(_identifier.Finalize(wch),
-                                          { _parameters, _subParameters, _subParameterRanges });
+        const auto id = _identifier.Finalize(wch);
+        const VTParameters parameters{ _parameters, _subParameters, _subParameterRanges };
+        return _outputEngine ? _outputEngine->ActionCsiDispatch(id, parameters) : _engine->ActionCsiDispatch(id, parameters);
     }));
 }
 
@@ -684,6 +754,20 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
     _oscString.push_back(wch);
 }
 
+// Routine Description:
+// - Stores a run of characters as part of the OSC string. The characters must
+//   be ones that _EventOscString() would pass to _ActionOscPut() one by one.
+// Arguments:
+// - string - Characters to store.
+// Return Value:
+// - <none>
+void StateMachine::_ActionOscPutString(const std::wstring_view string)
+{
+    _trace.TraceOnAction(L"OscPutString");
+
+    _oscString.append(string);
+}
+
 // Routine Description:
 // - Triggers the CsiDispatch action to indicate that the listener should handle a control sequence.
 //   These sequences perform various API-type commands that can include many parameters.
@@ -1045,6 +1129,216 @@ void StateMachine::_EnterSosPmApcString() noexcept
     _trace.TraceStateChange(L"SosPmApcString");
 }
 
+// Routine Description:
+// - Processes a character event for the CSI, SS3 and DCS states (with the exception
+//   of DcsIgnore and DcsPassThrough), by looking up the action and the next state
+//   in a transition table indexed by the current state and the character's class.
+//   The table is built at compile time and is equivalent to the chains of _is*()
+//   checks the other _Event*() functions use.
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventFromTransitionTable(const wchar_t wch)
+{
+    static constexpr auto stateCount = static_cast<size_t>(VTStates::SosPmApcString) + 1;
+    static constexpr auto classCount = static_cast<size_t>(CharClass::Count);
+    using Row = std::array<VTTransition, classCount>;
+
+    static constexpr auto transitions = []() {
+        using A = VTActions;
+        using S = VTStates;
+
+        std::array<Row, stateCount> t{};
+        const auto set = [&](const S state, const Row& row) {
+            t[static_cast<size_t>(state)] = row;
+        };
+
+        // The columns are in the order of the CharClass enum:
+        //  C0, Delete, Intermediate, Digit, SubParameterDelimiter, ParameterDelimiter, PrivateMarker, Final
+        set(S::CsiEntry, Row{ {
+                             { A::Execute, S::CsiEntry },
+                             { A::Ignore, S::CsiEntry },
+                             { A::Collect, S::CsiIntermediate },
+                             { A::Param, S::CsiParam },
+                             { A::SubParam, S::CsiSubParam },
+                             { A::Param, S::CsiParam },
+                             { A::Collect, S::CsiParam },
+                             { A::CsiDispatch, S::Ground },
+                         } });
+        set(S::CsiIntermediate, Row{ {
+                                    { A::Execute, S::CsiIntermediate },
+                                    { A::Ignore, S::CsiIntermediate },
+                                    { A::Collect, S::CsiIntermediate },
+                                    { A::None, S::CsiIgnore },
+                                    { A::None, S::CsiIgnore },
+                                    { A::None, S::CsiIgnore },
+                                    { A::None, S::CsiIgnore },
+                                    { A::CsiDispatch, S::Ground },
+                                } });
+        set(S::CsiIgnore, Row{ {
+                              { A::Execute, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::Ignore, S::CsiIgnore },
+                              { A::None, S::Ground },
+                          } });
+        set(S::CsiParam, Row{ {
+                             { A::Execute, S::CsiParam },
+                             { A::Ignore, S::CsiParam },
+                             { A::Collect, S::CsiIntermediate },
+                             { A::Param, S::CsiParam },
+                             { A::SubParam, S::CsiSubParam },
+                             { A::Param, S::CsiParam },
+                             { A::None, S::CsiIgnore },
+                             { A::CsiDispatch, S::Ground },
+                         } });
+        set(S::CsiSubParam, Row{ {
+                                { A::Execute, S::CsiSubParam },
+                                { A::Ignore, S::CsiSubParam },
+                                { A::Collect, S::CsiIntermediate },
+                                { A::SubParam, S::CsiSubParam },
+                                { A::SubParam, S::CsiSubParam },
+                                { A::Param, S::CsiParam },
+                                { A::None, S::CsiIgnore },
+                                { A::CsiDispatch, S::Ground },
+                            } });
+        // SS3 sequences are structurally the same as CSI sequences, just with a
+        // different initiation. Invalid characters send us into CsiIgnore,
+        // because both SS3 and CSI sequences ignore characters the same way.
+        set(S::Ss3Entry, Row{ {
+                             { A::Execute, S::Ss3Entry },
+                             { A::Ignore, S::Ss3Entry },
+                             { A::Ss3Dispatch, S::Ground },
+                             { A::Param, S::Ss3Param },
+                             { A::None, S::CsiIgnore },
+                             { A::Param, S::Ss3Param },
+                             { A::Ss3Dispatch, S::Ground },
+                             { A::Ss3Dispatch, S::Ground },
+                         } });
+        set(S::Ss3Param, Row{ {
+                             { A::Execute, S::Ss3Param },
+                             { A::Ignore, S::Ss3Param },
+                             { A::Ss3Dispatch, S::Ground },
+                             { A::Param, S::Ss3Param },
+                             { A::None, S::CsiIgnore },
+                             { A::Param, S::Ss3Param },
+                             { A::None, S::CsiIgnore },
+                             { A::Ss3Dispatch, S::Ground },
+                         } });
+        // DCS sequences are structurally almost the same as CSI sequences, just with an
+        // extra data string. _ActionDcsDispatch enters the next state on its own.
+        set(S::DcsEntry, Row{ {
+                             { A::Ignore, S::DcsEntry },
+                             { A::Ignore, S::DcsEntry },
+                             { A::Collect, S::DcsIntermediate },
+                             { A::Param, S::DcsParam },
+                             { A::None, S::DcsIgnore },
+                             { A::Param, S::DcsParam },
+                             { A::DcsDispatch, S::DcsEntry },
+                             { A::DcsDispatch, S::DcsEntry },
+                         } });
+        set(S::DcsIntermediate, Row{ {
+                                    { A::Ignore, S::DcsIntermediate },
+                                    { A::Ignore, S::DcsIntermediate },
+                                    { A::Collect, S::DcsIntermediate },
+                                    { A::None, S::DcsIgnore },
+                                    { A::None, S::DcsIgnore },
+                                    { A::None, S::DcsIgnore },
+                                    { A::None, S::DcsIgnore },
+                                    { A::DcsDispatch, S::DcsIntermediate },
+                                } });
+        set(S::DcsParam, Row{ {
+                             { A::Ignore, S::DcsParam },
+                             { A::Ignore, S::DcsParam },
+                             { A::Collect, S::DcsIntermediate },
+                             { A::Param, S::DcsParam },
+                             { A::None, S::DcsIgnore },
+                             { A::Param, S::DcsParam },
+                             { A::None, S::DcsIgnore },
+                             { A::DcsDispatch, S::DcsParam },
+                         } });
+        return t;
+    }();
+
+    const auto state = _state;
+    const auto& transition = til::at(til::at(transitions, static_cast<size_t>(state)), static_cast<size_t>(_classify(wch)));
+
+    switch (transition.action)
+    {
+    case VTActions::Execute:
+        _ActionExecute(wch);
+        break;
+    case VTActions::Ignore:
+        _ActionIgnore();
+        break;
+    case VTActions::Collect:
+        _ActionCollect(wch);
+        break;
+    case VTActions::Param:
+        _ActionParam(wch);
+        break;
+    case VTActions::SubParam:
+        _ActionSubParam(wch);
+        break;
+    case VTActions::CsiDispatch:
+        _ActionCsiDispatch(wch);
+        break;
+    case VTActions::Ss3Dispatch:
+        _ActionSs3Dispatch(wch);
+        break;
+    case VTActions::DcsDispatch:
+        _ActionDcsDispatch(wch);
+        break;
+    default:
+        break;
+    }
+
+    if (transition.state != state)
+    {
+        switch (transition.state)
+        {
+        case VTStates::Ground:
+            _EnterGround();
+            break;
+        case VTStates::CsiIntermediate:
+            _EnterCsiIntermediate();
+            break;
+        case VTStates::CsiIgnore:
+            _EnterCsiIgnore();
+            break;
+        case VTStates::CsiParam:
+            _EnterCsiParam();
+            break;
+        case VTStates::CsiSubParam:
+            _EnterCsiSubParam();
+            break;
+        case VTStates::Ss3Param:
+            _EnterSs3Param();
+            break;
+        case VTStates::DcsIgnore:
+            _EnterDcsIgnore();
+            break;
+        case VTStates::DcsIntermediate:
+            _EnterDcsIntermediate();
+            break;
+        case VTStates::DcsParam:
+            _EnterDcsParam();
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (transition.action == VTActions::CsiDispatch)
+    {
+        _ExecuteCsiCompleteCallback();
+    }
+}
+
 // Routine Description:
 // - Processes a character event into an Action that occurs while in the Ground state.
 //   Events in this state will:
@@ -1082,8 +1376,9 @@ void StateMachine::_EventGround(const wchar_t wch)
 void StateMachine::_EventEscape(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"Escape");
-    if (_isC0Code(wch))
+    switch (_classify(wch))
     {
+    case CharClass::C0:
         // Typically, control characters are immediately executed in the Escape
         // state without returning to ground. For the InputStateMachineEngine,
         // though, we instead need to call ActionExecuteFromEscape and then enter
@@ -1098,13 +1393,11 @@ void StateMachine::_EventEscape(const wchar_t wch)
         {
             _ActionExecute(wch);
         }
-    }
-    else if (_isDelete(wch))
-    {
+        return;
+    case CharClass::Delete:
         _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
+        return;
+    case CharClass::Intermediate:
         // In the InputStateMachineEngine, we do _not_ want to buffer any characters
         // as intermediates, because we use ESC as a prefix to indicate a key was
         // pressed while Alt was pressed.
@@ -1118,8 +1411,12 @@ void StateMachine::_EventEscape(const wchar_t wch)
             _ActionCollect(wch);
             _EnterEscapeIntermediate();
         }
+        return;
+    default:
+        break;
     }
-    else if (_parserMode.test(Mode::Ansi))
+
+    if (_parserMode.test(Mode::Ansi))
     {
         if (_isCsiIndicator(wch))
         {
@@ -1172,19 +1469,22 @@ void StateMachine::_EventEscape(const wchar_t wch)
 void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"EscapeIntermediate");
-    if (_isC0Code(wch))
+    switch (_classify(wch))
     {
+    case CharClass::C0:
         _ActionExecute(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
+        return;
+    case CharClass::Intermediate:
         _ActionCollect(wch);
-    }
-    else if (_isDelete(wch))
-    {
+        return;
+    case CharClass::Delete:
         _ActionIgnore();
+        return;
+    default:
+        break;
     }
-    else if (_parserMode.test(Mode::Ansi))
+
+    if (_parserMode.test(Mode::Ansi))
     {
         _ActionEscDispatch(wch);
         _EnterGround();
@@ -1217,40 +1517,7 @@ void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
 void StateMachine::_EventCsiEntry(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"CsiEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterCsiParam();
-    }
-    else if (_isSubParameterDelimiter(wch))
-    {
-        _ActionSubParam(wch);
-        _EnterCsiSubParam();
-    }
-    else if (_isCsiPrivateMarker(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiParam();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-        _ExecuteCsiCompleteCallback();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1268,28 +1535,7 @@ void StateMachine::_EventCsiEntry(const wchar_t wch)
 void StateMachine::_EventCsiIntermediate(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"CsiIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-        _ExecuteCsiCompleteCallback();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1307,26 +1553,7 @@ void StateMachine::_EventCsiIntermediate(const wchar_t wch)
 void StateMachine::_EventCsiIgnore(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"CsiIgnore");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        _EnterGround();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1346,38 +1573,7 @@ void StateMachine::_EventCsiIgnore(const wchar_t wch)
 void StateMachine::_EventCsiParam(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"CsiParam");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isSubParameterDelimiter(wch))
-    {
-        _ActionSubParam(wch);
-        _EnterCsiSubParam();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-        _ExecuteCsiCompleteCallback();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1397,38 +1593,7 @@ void StateMachine::_EventCsiParam(const wchar_t wch)
 void StateMachine::_EventCsiSubParam(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"CsiSubParam");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isSubParameterDelimiter(wch))
-    {
-        _ActionSubParam(wch);
-    }
-    else if (_isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterCsiParam();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-        _ExecuteCsiCompleteCallback();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1539,30 +1704,7 @@ void StateMachine::_EventOscTermination(const wchar_t wch)
 void StateMachine::_EventSs3Entry(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"Ss3Entry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isSubParameterDelimiter(wch))
-    {
-        // It's safe for us to go into the CSI ignore here, because both SS3 and
-        //      CSI sequences ignore characters the same way.
-        _EnterCsiIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterSs3Param();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1580,27 +1722,7 @@ void StateMachine::_EventSs3Entry(const wchar_t wch)
 void StateMachine::_EventSs3Param(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"Ss3Param");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isParameterInvalid(wch) || _isSubParameterDelimiter(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1657,32 +1779,7 @@ void StateMachine::_EventVt52Param(const wchar_t wch)
 void StateMachine::_EventDcsEntry(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"DcsEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isSubParameterDelimiter(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterDcsParam();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else
-    {
-        _ActionDcsDispatch(wch);
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1714,26 +1811,7 @@ void StateMachine::_EventDcsIgnore() noexcept
 void StateMachine::_EventDcsIntermediate(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"DcsIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
-    {
-        _ActionDcsDispatch(wch);
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1752,31 +1830,7 @@ void StateMachine::_EventDcsIntermediate(const wchar_t wch)
 void StateMachine::_EventDcsParam(const wchar_t wch)
 {
     _trace.TraceOnEvent(L"DcsParam");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else if (_isParameterInvalid(wch) || _isSubParameterDelimiter(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
-    {
-        _ActionDcsDispatch(wch);
-    }
+    _EventFromTransitionTable(wch);
 }
 
 // Routine Description:
@@ -1991,6 +2045,39 @@ static size_t findActionableFromGround(const wchar_t* data, size_t count) noexce
 
     auto it = data;
 
+    // Mostly-printable output (compiler logs, `cat`ing text files, etc.) tends to have runs far
+    // longer than 8 characters, so it's worth scanning 16 characters at a time if we can.
+    // Any remainder of less than 16 characters is then handled by the SSE2 loop below.
+    if (__isa_available >= __ISA_AVAILABLE_AVX2)
+    {
+        for (const auto end = data + (count & ~size_t{ 15 }); it < end; it += 16)
+        {
+            const auto wch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto z = _mm256_setzero_si256();
+
+            // See the SSE2 loop below for an explanation of these 2 checks.
+            auto a = _mm256_subs_epu16(wch, _mm256_set1_epi16(0x1f));
+            auto b = _mm256_subs_epu16(_mm256_add_epi16(wch, _mm256_set1_epi16(static_cast<short>(0xff81))), _mm256_set1_epi16(0x20));
+            a = _mm256_cmpeq_epi16(a, z);
+            b = _mm256_cmpeq_epi16(b, z);
+
+            const auto c = _mm256_or_si256(a, b);
+            const auto mask = static_cast<unsigned long>(_mm256_movemask_epi8(c));
+
+            if (mask)
+            {
+                _mm256_zeroupper();
+                unsigned long offset;
+                _BitScanForward(&offset, mask);
+                it += offset / 2;
+                return it - data;
+            }
+        }
+
+        // Avoid the AVX-SSE transition penalty when we continue with the SSE2 loop.
+        _mm256_zeroupper();
+    }
+
     for (const auto end = data + (count & ~size_t{ 7 }); it < end; it += 8)
     {
         const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
@@ -2060,9 +2147,41 @@ exitWithMask:
 
 #else
 
-    return findActionableFromGroundPlain(data, data + count, p);
+    return findActionableFromGroundPlain(data, data + count, data);
+
+#endif
+}
+
+// Returns the number of characters at the start of data that _isDcsPassThroughValid() accepts.
+// The whole run can be passed to the DCS string handler without going through ProcessCharacter().
+static size_t findDcsPassThroughEnd(const wchar_t* data, size_t count) noexcept
+{
+    auto it = data;
+
+#if defined(TIL_SSE_INTRINSICS)
+    for (const auto end = data + (count & ~size_t{ 7 }); it < end; it += 8)
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        // Check for "(wch - 0x20) <= 0x5e" the same way findActionableFromGround() does.
+        const auto offset = _mm_sub_epi16(wch, _mm_set1_epi16(0x20));
+        const auto valid = _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(0x5e)), _mm_setzero_si128());
+        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(valid)) ^ 0xffff;
 
+        if (mask)
+        {
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            it += index / 2;
+            return it - data;
+        }
+    }
 #endif
+
+#pragma loop(no_vector)
+    for (const auto end = data + count; it < end && _isDcsPassThroughValid(*it); ++it)
+    {
+    }
+    return it - data;
 }
 
 #pragma warning(pop)
@@ -2078,6 +2197,8 @@ exitWithMask:
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    TIL_TRACE_REGION(g_hConsoleVirtTermParserEventTraceProvider, "StateMachineParse");
+
     size_t i = 0;
     _currentString = string;
     _runOffset = 0;
@@ -2116,6 +2237,49 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
         do
         {
+            // OSC 52 clipboard payloads can be megabytes of base64. Instead of adding them to the OSC string
+            // one character at a time, we append entire runs of them at once. The characters that
+            // findActionableFromGround() stops at are a superset of those handled by _EventOscString().
+            if (_state == VTStates::OscString)
+            {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).)
+                const auto run = findActionableFromGround(string.data() + i, string.size() - i);
+                if (run)
+                {
+                    _ActionOscPutString(string.substr(i, run));
+                    _runSize += run;
+                    i += run;
+
+                    if (i >= string.size())
+                    {
+                        break;
+                    }
+                }
+            }
+            // Sixel images and DECDLD soft fonts are similarly large. Their characters still have to
+            // be passed to the string handler one by one, but they can skip ProcessCharacter().
+            else if (_state == VTStates::DcsPassThrough)
+            {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).)
+                const auto end = i + findDcsPassThroughEnd(string.data() + i, string.size() - i);
+                _trace.TraceOnEvent(L"DcsPassThrough");
+
+                while (i < end)
+                {
+                    _runSize++;
+                    if (!_dcsStringHandler(til::at(string, i++)))
+                    {
+                        _EnterDcsIgnore();
+                        break;
+                    }
+                }
+
+                if (i >= string.size())
+                {
+                    break;
+                }
+            }
+
             _runSize++;
             _processingLastCharacter = i + 1 >= string.size();
             // If we're processing characters individually, send it to the state machine.
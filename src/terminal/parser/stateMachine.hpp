@@ -20,6 +20,8 @@ Abstract:
 
 namespace Microsoft::Console::VirtualTerminal
 {
+    class OutputStateMachineEngine;
+
     // The DEC STD 070 reference recommends supporting up to at least 16384
     // for parameter values. 65535 is what XTerm and VTE support.
     // GH#12977: We must use 65535 to properly parse win32-input-mode
@@ -49,7 +51,12 @@ namespace Microsoft::Console::VirtualTerminal
         StateMachine(std::unique_ptr<T> engine) :
             StateMachine(std::move(engine), std::is_same_v<T, class InputStateMachineEngine>)
         {
+            if constexpr (std::is_same_v<T, OutputStateMachineEngine>)
+            {
+                _outputEngine = static_cast<T*>(_engine.get());
+            }
         }
+        // Unlike the above, this always calls the engine's actions virtually.
         StateMachine(std::unique_ptr<IStateMachineEngine> engine, const bool isEngineForInput);
 
         enum class Mode : size_t
@@ -95,6 +102,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionCsiDispatch(const wchar_t wch);
         void _ActionOscParam(const wchar_t wch) noexcept;
         void _ActionOscPut(const wchar_t wch);
+        void _ActionOscPutString(const std::wstring_view string);
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
         void _ActionDcsDispatch(const wchar_t wch);
@@ -176,9 +184,38 @@ namespace Microsoft::Console::VirtualTerminal
             SosPmApcString
         };
 
+        // The actions that can be triggered by a character in one of the table-driven states.
+        // See _EventFromTransitionTable for the table that maps states and characters to them.
+        enum class VTActions : uint8_t
+        {
+            None,
+            Execute,
+            Ignore,
+            Collect,
+            Param,
+            SubParam,
+            CsiDispatch,
+            Ss3Dispatch,
+            DcsDispatch,
+        };
+
+        struct VTTransition
+        {
+            VTActions action;
+            // The state to enter after the action has been executed.
+            // If this is the current state, no transition is made.
+            VTStates state;
+        };
+
+        void _EventFromTransitionTable(const wchar_t wch);
+
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
 
         std::unique_ptr<IStateMachineEngine> _engine;
+        // Set if _engine is an OutputStateMachineEngine. Since that class is final, the
+        // most frequent actions (print, execute, CSI dispatch) are called through this
+        // pointer without a virtual call, which allows them to be inlined with LTCG.
+        OutputStateMachineEngine* _outputEngine = nullptr;
         const bool _isEngineForInput;
 
         VTStates _state;
@@ -116,4 +116,43 @@ class Microsoft::Console::VirtualTerminal::Base64Test
         Base64::Decode(L"8J+RjfCfkY3wn4+78J+RjfCfj7zwn5GN8J+PvfCfkY3wn4++8J+RjfCfj78=", result);
         VERIFY_ARE_EQUAL(L"👍👍🏻👍🏼👍🏽👍🏾👍🏿", result);
     }
+
+    TEST_METHOD(DecodeVectorized)
+    {
+        std::wstring result;
+
+        // Long inputs are decoded 8 characters at a time. Both variants of the alphabet must be
+        // supported there as well, and invalid characters anywhere in the string must be caught.
+        Base64::Decode(L"Pj8+Pz4/fn5+Pz8/", result);
+        VERIFY_ARE_EQUAL(L">?>?>?~~~???", result);
+        Base64::Decode(L"Pj8-Pz4_fn5-Pz8_", result);
+        VERIFY_ARE_EQUAL(L">?>?>?~~~???", result);
+
+        Base64::Decode(L"YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXo=", result);
+        VERIFY_ARE_EQUAL(L"abcdefghijklmnopqrstuvwxyz", result);
+
+        VERIFY_FAILED(Base64::Decode(L"YWJjZGVmZ2hp.mtsbW5vcHFyc3R1dnd4eXo=", result));
+        VERIFY_FAILED(Base64::Decode(L"YWJjZGVmZ2hp\u0161mtsbW5vcHFyc3R1dnd4eXo=", result));
+    }
+
+    TEST_METHOD(Encode)
+    {
+        std::wstring result;
+
+        Base64::Encode(L"", result);
+        VERIFY_ARE_EQUAL(L"", result);
+        Base64::Encode(L"a", result);
+        VERIFY_ARE_EQUAL(L"YQ==", result);
+        Base64::Encode(L"ab", result);
+        VERIFY_ARE_EQUAL(L"YWI=", result);
+        Base64::Encode(L"abc", result);
+        VERIFY_ARE_EQUAL(L"YWJj", result);
+        Base64::Encode(L"にほんご汉语한국", result);
+        VERIFY_ARE_EQUAL(L"44Gr44G744KT44GU5rGJ6K+t7ZWc6rWt", result);
+
+        std::wstring decoded;
+        Base64::Encode(L"👍👍🏻👍🏼👍🏽👍🏾👍🏿", result);
+        Base64::Decode(result, decoded);
+        VERIFY_ARE_EQUAL(L"👍👍🏻👍🏼👍🏽👍🏾👍🏿", decoded);
+    }
 };
@@ -910,6 +910,36 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestDcsParamIgnoresC0)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
+        mach.ProcessCharacter(L'P');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsEntry);
+        mach.ProcessCharacter(L'1');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        // C0 controls are ignored in the DCS parameter state and must
+        // neither dispatch the sequence nor leave the state.
+        mach.ProcessCharacter(AsciiChars::CR);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(AsciiChars::LF);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(L'2');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+
+        VERIFY_ARE_EQUAL(mach._parameters.size(), 1u);
+        VERIFY_ARE_EQUAL(mach._parameters.at(0), 12);
+
+        mach.ProcessCharacter(AsciiChars::ESC);
+        mach.ProcessCharacter(L'\\');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
     TEST_METHOD(TestDcsIntermediateAndPassThrough)
     {
         auto dispatch = std::make_unique<DummyDispatch>();
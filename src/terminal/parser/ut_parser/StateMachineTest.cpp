@@ -38,6 +38,8 @@ public:
         dcsId = 0;
         dcsParams.clear();
         dcsDataString.clear();
+        oscParameter = 0;
+        oscString.clear();
     }
 
     bool ActionExecute(const wchar_t wch) override
@@ -69,14 +71,16 @@ public:
     bool ActionIgnore() override { return true; };
 
     bool ActionOscDispatch(const wchar_t /* wch */,
-                           const size_t /* parameter */,
-                           const std::wstring_view /* string */) override
+                           const size_t parameter,
+                           const std::wstring_view string) override
     {
         if (pfnFlushToTerminal)
         {
             pfnFlushToTerminal();
             return true;
         }
+        oscParameter = parameter;
+        oscString = string;
         return true;
     };
 
@@ -133,6 +137,10 @@ public:
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
     std::wstring dcsDataString;
+
+    // These will only be populated if ActionOscDispatch is called.
+    size_t oscParameter = 0;
+    std::wstring oscString;
 };
 
 class Microsoft::Console::VirtualTerminal::StateMachineTest
@@ -154,8 +162,12 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(BulkTextPrintStopsAtEveryOffset);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
+    TEST_METHOD(BulkOscString);
+    TEST_METHOD(BulkDcsString);
+
     TEST_METHOD(DcsDataStringsReceivedByHandler);
 
     TEST_METHOD(VtParameterSubspanTest);
@@ -231,6 +243,70 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::BulkTextPrintStopsAtEveryOffset()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The ground state scanner is vectorized and processes up to 16 characters at a time.
+    // Place a control character at every offset across several of those blocks
+    // to ensure that each of them is found and none is printed as part of a run.
+    static constexpr size_t length = 48;
+
+    for (const auto control : { L'\x00', L'\n', L'\x1f', L'\x7f' })
+    {
+        for (size_t offset = 0; offset < length; ++offset)
+        {
+            std::wstring input(length, L'x');
+            input[offset] = control;
+
+            engine.ResetTestState();
+            machine.ProcessString(input);
+
+            VERIFY_ARE_EQUAL(String(std::wstring(length - 1, L'x').c_str()), String(engine.printed.c_str()));
+            VERIFY_ARE_EQUAL(std::wstring(1, control), engine.executed);
+        }
+    }
+}
+
+void StateMachineTest::BulkOscString()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The OSC string is collected in runs, which must end at the same characters as before.
+    // Invalid C0 characters are ignored, while DEL is part of the string.
+    machine.ProcessString(L"\x1b]52;c;YWJj\x7fZGVm\x01Z2hp\x1b\\");
+    VERIFY_ARE_EQUAL(size_t{ 52 }, engine.oscParameter);
+    VERIFY_ARE_EQUAL(L"c;YWJj\x7fZGVmZ2hp", engine.oscString);
+
+    Log::Comment(L"The string may be split across several writes.");
+    engine.ResetTestState();
+    machine.ProcessString(L"\x1b]52;c;YWJj");
+    machine.ProcessString(L"ZGVm");
+    machine.ProcessString(L"Z2hp\x07");
+    VERIFY_ARE_EQUAL(size_t{ 52 }, engine.oscParameter);
+    VERIFY_ARE_EQUAL(L"c;YWJjZGVmZ2hp", engine.oscString);
+}
+
+void StateMachineTest::BulkDcsString()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Runs of printable ASCII are passed to the handler in bulk. C0 controls must still reach it,
+    // while DEL and non-ASCII characters are ignored, no matter where they are within a run.
+    machine.ProcessString(L"\033P1|#0;2;0;0;0#1~~~~~~~~\x7f~~~~\n~~~~~~~~~~~~~\u00e9~~~~-");
+    machine.ProcessString(L"~~~~\033\\");
+    VERIFY_ARE_EQUAL(L"#0;2;0;0;0#1~~~~~~~~~~~~\n~~~~~~~~~~~~~~~~~-~~~~\033", engine.dcsDataString);
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
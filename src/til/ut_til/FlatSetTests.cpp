@@ -65,4 +65,57 @@ class FlatSetTests
         VERIFY_ARE_EQUAL(&entry1, &entry2);
         VERIFY_ARE_EQUAL(123u, entry2.value);
     }
+
+    TEST_METHOD(SwissBasic)
+    {
+        til::swiss_flat_set<Data> set;
+        VERIFY_IS_TRUE(set.empty());
+        VERIFY_IS_NULL(set.lookup(123));
+
+        const auto [entry1, inserted1] = set.insert(123);
+        VERIFY_IS_TRUE(inserted1);
+
+        const auto [entry2, inserted2] = set.insert(123);
+        VERIFY_IS_FALSE(inserted2);
+
+        VERIFY_ARE_EQUAL(&entry1, &entry2);
+        VERIFY_ARE_EQUAL(&entry1, set.lookup(123));
+        VERIFY_ARE_EQUAL(123u, entry2.value);
+        VERIFY_ARE_EQUAL(1u, set.size());
+    }
+
+    TEST_METHOD(SwissGrowth)
+    {
+        til::swiss_flat_set<Data> set;
+
+        // Enough to grow the set a couple times and to fill many groups to the brim.
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto [entry, inserted] = set.insert(i * 64);
+            VERIFY_IS_TRUE(inserted);
+            VERIFY_ARE_EQUAL(static_cast<size_t>(i * 64), entry.value);
+        }
+
+        VERIFY_ARE_EQUAL(10000u, set.size());
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto entry = set.lookup(i * 64);
+            VERIFY_IS_NOT_NULL(entry);
+            VERIFY_ARE_EQUAL(static_cast<size_t>(i * 64), entry->value);
+            VERIFY_IS_NULL(set.lookup(i * 64 + 1));
+        }
+
+        size_t occupied = 0;
+        for (const auto& slot : set.container())
+        {
+            occupied += slot ? 1 : 0;
+        }
+        VERIFY_ARE_EQUAL(10000u, occupied);
+
+        set.clear();
+        VERIFY_IS_TRUE(set.empty());
+        VERIFY_IS_NULL(set.lookup(0));
+        VERIFY_IS_TRUE(set.insert(0).second);
+    }
 };
@@ -43,4 +43,29 @@ class HashTests
 #endif
         }
     }
+
+    TEST_METHOD(HashShort)
+    {
+        static constexpr std::wstring_view clusters[]{ L"", L"a", L"b", L"ab", L"ba", L"\xD83D\xDE00", L"e\x0301", L"abcdefgh" };
+
+        std::vector<size_t> hashes;
+        for (const auto& c : clusters)
+        {
+            const auto h = til::hash_short(c.data(), c.size() * sizeof(wchar_t));
+            VERIFY_ARE_EQUAL(h, til::hash_short(c.data(), c.size() * sizeof(wchar_t)));
+            VERIFY_ARE_NOT_EQUAL(h, til::hash_short(c.data(), c.size() * sizeof(wchar_t), 1));
+            hashes.emplace_back(h);
+        }
+
+        std::sort(hashes.begin(), hashes.end());
+        VERIFY_ARE_EQUAL(hashes.end(), std::adjacent_find(hashes.begin(), hashes.end()));
+
+        // Trailing zeroes must not collide with shorter keys, despite the zero-padding.
+        static constexpr uint8_t zeroes[16]{};
+        VERIFY_ARE_NOT_EQUAL(til::hash_short(&zeroes[0], 2), til::hash_short(&zeroes[0], 3));
+
+        // Keys longer than 16 bytes are passed through to til::hash.
+        static constexpr std::string_view longKey{ "abcdefghijklmnopqrstuvwxyz" };
+        VERIFY_ARE_EQUAL(til::hasher{ 4 }.write(longKey).finalize(), til::hash_short(longKey.data(), longKey.size(), 4));
+    }
 };
@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <til/mpsc.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace
+{
+    struct drop_indicator
+    {
+        explicit drop_indicator(int& counter) noexcept :
+            _counter(&counter) {}
+
+        drop_indicator(const drop_indicator&) = delete;
+        drop_indicator& operator=(const drop_indicator&) = delete;
+
+        drop_indicator(drop_indicator&& other) noexcept
+        {
+            _counter = std::exchange(other._counter, nullptr);
+        }
+
+        drop_indicator& operator=(drop_indicator&& other) noexcept
+        {
+            _counter = std::exchange(other._counter, nullptr);
+            return *this;
+        }
+
+        ~drop_indicator()
+        {
+            if (_counter)
+            {
+                ++*_counter;
+            }
+        }
+
+    private:
+        int* _counter = nullptr;
+    };
+
+    template<typename T>
+    void drop(T&& val)
+    {
+        auto _ = std::move(val);
+    }
+}
+
+class MPSCTests
+{
+    BEGIN_TEST_CLASS(MPSCTests)
+        TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+    END_TEST_CLASS()
+
+    TEST_METHOD(SmokeTest);
+    TEST_METHOD(TryTest);
+    TEST_METHOD(DropTest);
+    TEST_METHOD(DropConsumerTest);
+    TEST_METHOD(IntegrationTest);
+};
+
+void MPSCTests::SmokeTest()
+{
+    // This test mostly ensures that the API wasn't broken.
+
+    // construction
+    auto [tx, rx] = til::mpsc::channel<int>(32);
+    std::array<int, 3> data{};
+
+    // copy and move constructor
+    auto tx2(tx);
+    auto tx3(std::move(tx2));
+    auto rx2(std::move(rx));
+
+    // copy and move assignment operator
+    tx2 = tx3;
+    tx = std::move(tx3);
+    rx = std::move(rx2);
+
+    // push
+    tx.emplace(0);
+    tx.try_emplace(0);
+    tx.push(data.begin(), data.end());
+    tx.push(til::mpsc::block_initially, data.begin(), data.end());
+    tx2.push(til::mpsc::block_forever, data.begin(), data.end());
+    tx.push_n(data.begin(), data.size());
+    tx.push_n(til::mpsc::block_initially, data.begin(), data.size());
+    tx2.push_n(til::mpsc::block_forever, data.begin(), data.size());
+
+    // pop
+    auto x = rx.pop();
+    auto y = rx.try_pop();
+    rx.pop_n(til::mpsc::block_initially, data.begin(), data.size());
+    rx.pop_n(til::mpsc::block_forever, data.begin(), data.size());
+}
+
+void MPSCTests::TryTest()
+{
+    // The capacity is rounded up to a power of two.
+    auto [tx, rx] = til::mpsc::channel<int>(3);
+
+    for (auto i = 0; i < 4; ++i)
+    {
+        VERIFY_IS_TRUE(tx.try_emplace(i));
+    }
+    VERIFY_IS_FALSE(tx.try_emplace(4));
+
+    VERIFY_ARE_EQUAL(0, rx.try_pop());
+    VERIFY_IS_TRUE(tx.try_emplace(4));
+
+    for (auto i = 1; i < 5; ++i)
+    {
+        VERIFY_ARE_EQUAL(i, rx.try_pop());
+    }
+    VERIFY_IS_FALSE(rx.try_pop().has_value());
+}
+
+void MPSCTests::DropTest()
+{
+    auto [tx, rx] = til::mpsc::channel<drop_indicator>(8);
+    auto tx2 = tx;
+    auto counter = 0;
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        tx.emplace(counter);
+        tx2.emplace(counter);
+    }
+    VERIFY_ARE_EQUAL(counter, 0);
+
+    for (auto i = 0; i < 2; ++i)
+    {
+        rx.pop();
+    }
+    VERIFY_ARE_EQUAL(counter, 2);
+
+    // The consumer must only see the end once all producers are gone, and not before draining the queue.
+    drop(tx);
+    VERIFY_IS_TRUE(rx.pop().has_value());
+    drop(tx2);
+    VERIFY_ARE_EQUAL(counter, 3);
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        VERIFY_IS_TRUE(rx.pop().has_value());
+    }
+    VERIFY_IS_FALSE(rx.pop().has_value());
+    VERIFY_ARE_EQUAL(counter, 6);
+
+    drop(rx);
+    VERIFY_ARE_EQUAL(counter, 6);
+}
+
+void MPSCTests::DropConsumerTest()
+{
+    auto [tx, rx] = til::mpsc::channel<drop_indicator>(4);
+    auto counter = 0;
+
+    for (auto i = 0; i < 3; ++i)
+    {
+        tx.emplace(counter);
+    }
+
+    // Items left in the queue are destroyed once both sides are gone.
+    drop(rx);
+    VERIFY_ARE_EQUAL(counter, 0);
+    VERIFY_IS_FALSE(tx.emplace(counter));
+    VERIFY_ARE_EQUAL(counter, 0);
+
+    drop(tx);
+    VERIFY_ARE_EQUAL(counter, 3);
+}
+
+void MPSCTests::IntegrationTest()
+{
+    static constexpr auto producers = 4;
+    static constexpr auto itemsPerProducer = 10000;
+
+    auto [tx, rx] = til::mpsc::channel<int>(7);
+    std::vector<std::thread> threads;
+
+    for (auto p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([tx, p]() {
+            std::array<int, 10> buffer{};
+
+            for (auto i = 0; i < itemsPerProducer; i += gsl::narrow_cast<int>(buffer.size()))
+            {
+                std::ranges::generate(buffer, [v = p * itemsPerProducer + i]() mutable { return v++; });
+                tx.push(buffer.begin(), buffer.end());
+            }
+        });
+    }
+    drop(tx);
+
+    // Items from the different producers may be interleaved, but those of each individual one must be in order.
+    std::array<int, producers> next{};
+    std::array<int, 13> buffer{};
+    auto total = 0;
+
+    for (;;)
+    {
+        const auto [count, ok] = rx.pop_n(til::mpsc::block_initially, buffer.data(), buffer.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto p = buffer[i] / itemsPerProducer;
+            VERIFY_ARE_EQUAL(p * itemsPerProducer + next[p], buffer[i]);
+            ++next[p];
+        }
+        total += gsl::narrow_cast<int>(count);
+
+        if (!ok)
+        {
+            break;
+        }
+    }
+
+    VERIFY_ARE_EQUAL(producers * itemsPerProducer, total);
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+}
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <til/scheduler.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class SchedulerTests
+{
+    BEGIN_TEST_CLASS(SchedulerTests)
+        TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+    END_TEST_CLASS()
+
+    TEST_METHOD(VisitsEachIndexOnce);
+    TEST_METHOD(ParticipantIsUnique);
+    TEST_METHOD(RethrowsException);
+    TEST_METHOD(Cancellation);
+    TEST_METHOD(Nested);
+};
+
+void SchedulerTests::VisitsEachIndexOnce()
+{
+    // An odd size and grain to ensure that the last chunk is correctly cut short.
+    std::vector<std::atomic<int>> visits(1003);
+
+    til::parallel_for(
+        0,
+        visits.size(),
+        [&](size_t beg, size_t end) {
+            VERIFY_IS_TRUE(end - beg <= 7);
+            for (auto i = beg; i < end; ++i)
+            {
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        },
+        { .grain = 7 });
+
+    for (size_t i = 0; i < visits.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(1, visits[i].load(), NoThrowString().Format(L"i=%zu", i));
+    }
+}
+
+void SchedulerTests::ParticipantIsUnique()
+{
+    static constexpr size_t maxConcurrency = 3;
+    std::array<std::atomic<bool>, maxConcurrency> busy{};
+    std::atomic<bool> ok{ true };
+
+    til::parallel_for(
+        0,
+        1000,
+        [&](size_t, size_t, size_t participant) {
+            if (participant >= maxConcurrency || busy[participant].exchange(true))
+            {
+                ok = false;
+                return;
+            }
+            std::this_thread::yield();
+            busy[participant] = false;
+        },
+        { .max_concurrency = maxConcurrency });
+
+    VERIFY_IS_TRUE(ok.load());
+}
+
+void SchedulerTests::RethrowsException()
+{
+    std::atomic<size_t> calls{ 0 };
+
+    VERIFY_THROWS_SPECIFIC(
+        til::parallel_for(0, 1000, [&](size_t beg, size_t) {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            if (beg == 10)
+            {
+                throw std::runtime_error{ "test" };
+            }
+        }),
+        std::runtime_error,
+        [](const std::runtime_error& e) { return std::string_view{ e.what() } == "test"; });
+
+    // No further chunks should be started after the exception, but
+    // others may have been running concurrently, so we can't be exact here.
+    VERIFY_IS_LESS_THAN(calls.load(), 1000u);
+}
+
+void SchedulerTests::Cancellation()
+{
+    til::cancellation_source source;
+    std::atomic<size_t> calls{ 0 };
+
+    til::parallel_for(
+        0,
+        1000,
+        [&](size_t, size_t) {
+            if (calls.fetch_add(1, std::memory_order_relaxed) == 10)
+            {
+                source.cancel();
+            }
+        },
+        { .cancellation = source.token() });
+
+    VERIFY_IS_TRUE(source.is_cancelled());
+    VERIFY_IS_LESS_THAN(calls.load(), 1000u);
+
+    // Cancelled tokens don't run anything at all.
+    calls = 0;
+    til::parallel_for(0, 10, [&](size_t, size_t) { calls++; }, { .cancellation = source.token() });
+    VERIFY_ARE_EQUAL(0u, calls.load());
+
+    // Default constructed ones are never cancelled.
+    VERIFY_IS_FALSE(til::cancellation_token{}.is_cancelled());
+}
+
+void SchedulerTests::Nested()
+{
+    std::atomic<size_t> total{ 0 };
+
+    til::parallel_for(0, 16, [&](size_t, size_t) {
+        til::parallel_for(0, 16, [&](size_t beg, size_t end) {
+            total.fetch_add(end - beg, std::memory_order_relaxed);
+        });
+    });
+
+    VERIFY_ARE_EQUAL(256u, total.load());
+}
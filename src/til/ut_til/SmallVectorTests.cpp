@@ -103,6 +103,52 @@ struct Movable_int : Copyable_int
     }
 };
 
+struct CountingAllocatorState
+{
+    size_t allocations = 0;
+    size_t deallocations = 0;
+};
+
+// A stateful allocator, similar to the one that TextBuffer uses for the attributes of its ROWs.
+template<typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    CountingAllocator() = default;
+
+    explicit CountingAllocator(CountingAllocatorState* state) noexcept :
+        state{ state }
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        if (state)
+        {
+            state->allocations++;
+        }
+        return std::allocator<T>{}.allocate(count);
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept
+    {
+        if (state)
+        {
+            state->deallocations++;
+        }
+        std::allocator<T>{}.deallocate(ptr, count);
+    }
+
+    bool operator==(const CountingAllocator&) const noexcept
+    {
+        return true;
+    }
+
+    CountingAllocatorState* state = nullptr;
+};
+
 class SmallVectorTests
 {
     TEST_CLASS(SmallVectorTests)
@@ -378,6 +424,32 @@ class SmallVectorTests
         VERIFY_ARE_EQUAL(expected, actual);
     }
 
+    TEST_METHOD(StatefulAllocator)
+    {
+        CountingAllocatorState state;
+        {
+            til::small_vector<int, 2, CountingAllocator<int>> actual{ CountingAllocator<int>{ &state } };
+            actual.push_back(1);
+            actual.push_back(2);
+            VERIFY_ARE_EQUAL(0u, state.allocations);
+
+            // Only the storage beyond the small buffer is allocated.
+            actual.push_back(3);
+            VERIFY_ARE_EQUAL(1u, state.allocations);
+
+            // Copies inherit the allocator via select_on_container_copy_construction().
+            const auto copy = actual;
+            VERIFY_ARE_EQUAL(2u, state.allocations);
+            VERIFY_IS_TRUE(actual == copy);
+
+            // Moving transfers the storage without allocating.
+            auto moved = std::move(actual);
+            VERIFY_ARE_EQUAL(2u, state.allocations);
+            VERIFY_IS_TRUE(moved == copy);
+        }
+        VERIFY_ARE_EQUAL(2u, state.deallocations);
+    }
+
     TEST_METHOD(MoveOntoItself)
     {
         til::small_vector<Movable_int, 5> actual;
@@ -79,4 +79,65 @@ class UnicodeTests
             VERIFY_ARE_EQUAL(end, it);
         }
     }
+
+    TEST_METHOD(utf16_grapheme_next_prev)
+    {
+        struct Test
+        {
+            std::wstring_view input;
+            til::some<std::wstring_view, 5> expected;
+        };
+
+        static constexpr std::array tests{
+            Test{ L"", {} },
+            Test{ L"abc", { L"a", L"b", L"c" } },
+            Test{ L"\r\n\n", { L"\r\n", L"\n" } },
+            Test{ L"e\x0301\x0302x", { L"e\x0301\x0302", L"x" } },
+            // Hangul L V T, followed by an LVT that can't be extended by a V.
+            Test{ L"\x1100\x1161\x11A8\xAC01\x1161", { L"\x1100\x1161\x11A8", L"\xAC01", L"\x1161" } },
+            // A ZWJ sequence of 3 emoji and a thumbs up with a skin tone modifier.
+            Test{ L"\U0001F468\x200D\U0001F469\x200D\U0001F467\U0001F44D\U0001F3FD", { L"\U0001F468\x200D\U0001F469\x200D\U0001F467", L"\U0001F44D\U0001F3FD" } },
+            // A ZWJ only joins emoji if it's preceded by one.
+            Test{ L"a\x200D\U0001F469", { L"a\x200D", L"\U0001F469" } },
+            // Regional indicators form pairs.
+            Test{ L"\U0001F1E9\U0001F1EA\U0001F1EB\U0001F1F7\U0001F1EC", { L"\U0001F1E9\U0001F1EA", L"\U0001F1EB\U0001F1F7", L"\U0001F1EC" } },
+            // Prepend, and a spacing mark.
+            Test{ L"\x0600" L"a\x0915\x093F", { L"\x0600" L"a", L"\x0915\x093F" } },
+            Test{ LEADING L"\x0301" TRAILING, { LEADING, L"\x0301", TRAILING } },
+        };
+
+        for (const auto& t : tests)
+        {
+            size_t beg = 0;
+            for (const auto& v : t.expected)
+            {
+                const auto end = til::utf16_grapheme_next(t.input, beg);
+                VERIFY_ARE_EQUAL(v, t.input.substr(beg, end - beg));
+                beg = end;
+            }
+            VERIFY_ARE_EQUAL(t.input.size(), beg);
+
+            for (auto it = t.expected.end(); it != t.expected.begin();)
+            {
+                --it;
+                const auto prev = til::utf16_grapheme_prev(t.input, beg);
+                VERIFY_ARE_EQUAL(*it, t.input.substr(prev, beg - prev));
+                beg = prev;
+            }
+            VERIFY_ARE_EQUAL(size_t{ 0 }, beg);
+        }
+    }
+
+    TEST_METHOD(utf16_count_grapheme_trivial)
+    {
+        // Long enough to be processed by both the vectorized and the scalar loop.
+        std::wstring str{ L"Hello, \x4E16\x754C \xD55C\xAE00 \x043F\x0440\x0438\x0432\x0435\x0442 \x3053\x3093\x306B\x3061\x306F" };
+        VERIFY_ARE_EQUAL(str.size(), til::utf16_count_grapheme_trivial(str));
+
+        const auto size = str.size();
+        str.append(L"e\x0301");
+        VERIFY_ARE_EQUAL(size + 1, til::utf16_count_grapheme_trivial(str));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, til::utf16_count_grapheme_trivial(L"\x0301"));
+        VERIFY_ARE_EQUAL(size_t{ 3 }, til::utf16_count_grapheme_trivial(L"abc\U0001F600"));
+    }
 };
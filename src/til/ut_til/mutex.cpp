@@ -4,6 +4,9 @@
 #include "precomp.h"
 
 #include "til/mutex.h"
+#include "til/ticket_lock.h"
+
+#include <numeric>
 
 using namespace WEX::Common;
 using namespace WEX::Logging;
@@ -44,3 +47,86 @@ class MutexTests
         auto lock = mutex.lock();
     }
 };
+
+class TicketLockTests
+{
+    BEGIN_TEST_CLASS(TicketLockTests)
+        TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+    END_TEST_CLASS()
+
+    struct TestProfiler final : til::lock_profiler
+    {
+        bool enabled() const noexcept override
+        {
+            return enable;
+        }
+
+        void acquired(const sample& sample) noexcept override
+        {
+            acquisitions.emplace_back(sample);
+        }
+
+        void released(const sample& sample) noexcept override
+        {
+            releases.emplace_back(sample);
+        }
+
+        bool enable = false;
+        std::vector<sample> acquisitions;
+        std::vector<sample> releases;
+    };
+
+    TEST_METHOD(ProfilerOnlySeesOutermostLock)
+    {
+        TestProfiler profiler;
+        til::recursive_ticket_lock lock;
+        lock.set_profiler(&profiler);
+
+        // A disabled profiler sees nothing.
+        lock.lock();
+        lock.unlock();
+        VERIFY_ARE_EQUAL(0u, profiler.acquisitions.size());
+        VERIFY_ARE_EQUAL(0u, profiler.releases.size());
+
+        profiler.enable = true;
+
+        const auto site = std::source_location::current();
+        lock.lock(site);
+        lock.lock();
+        lock.unlock();
+        VERIFY_ARE_EQUAL(1u, profiler.acquisitions.size());
+        VERIFY_ARE_EQUAL(0u, profiler.releases.size());
+        lock.unlock();
+
+        VERIFY_ARE_EQUAL(1u, profiler.releases.size());
+        VERIFY_ARE_EQUAL(site.line(), profiler.releases[0].site.line());
+        VERIFY_ARE_EQUAL(0u, profiler.releases[0].waiters);
+
+        // Every release lands in exactly one bucket of each histogram.
+        const auto wait = profiler.wait_histogram();
+        const auto hold = profiler.hold_histogram();
+        VERIFY_ARE_EQUAL(1u, std::accumulate(wait.begin(), wait.end(), uint64_t{ 0 }));
+        VERIFY_ARE_EQUAL(1u, std::accumulate(hold.begin(), hold.end(), uint64_t{ 0 }));
+    }
+
+    TEST_METHOD(ProfilerSeesSuspension)
+    {
+        TestProfiler profiler;
+        profiler.enable = true;
+        til::recursive_ticket_lock lock;
+        lock.set_profiler(&profiler);
+
+        lock.lock();
+        {
+            const auto suspension = lock.suspend();
+            VERIFY_IS_FALSE(lock.is_locked());
+            VERIFY_ARE_EQUAL(1u, profiler.releases.size());
+        }
+        VERIFY_IS_TRUE(lock.is_locked());
+        VERIFY_ARE_EQUAL(2u, profiler.acquisitions.size());
+        lock.unlock();
+
+        VERIFY_ARE_EQUAL(2u, profiler.releases.size());
+        VERIFY_ARE_EQUAL(profiler.acquisitions[0].site.line(), profiler.acquisitions[1].site.line());
+    }
+};
@@ -17,6 +17,8 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16MatchesPlatform);
+    TEST_METHOD(TestU16ToU8MatchesPlatform);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +193,69 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+// til::u8u16 converts valid input itself (with SIMD for ASCII) and only hands invalid sequences
+// to MultiByteToWideChar. The result must be indistinguishable from using MultiByteToWideChar for everything.
+void Utf8Utf16ConvertTests::TestU8ToU16MatchesPlatform()
+{
+    static constexpr std::string_view pieces[]{
+        "a",
+        "0123456789abcdefghijklmnopqrstuvwxyz", // longer than a vector
+        "\xC3\xB6", // U+00F6 (2 bytes)
+        "\xE2\x82\xAC", // U+20AC (3 bytes)
+        "\xF0\x9F\x93\xB7", // U+1F4F7 (4 bytes)
+        "\xFF", // invalid lead byte
+        "\xC3", // truncated sequence
+        "\xC0\xAF", // overlong encoding
+        "\xED\xA0\x80", // encoded surrogate
+        "\xF4\x90\x80\x80", // beyond U+10FFFF
+    };
+
+    for (size_t seed = 0; seed < 200; ++seed)
+    {
+        std::string u8String;
+        for (size_t i = 0; i < 32; ++i)
+        {
+            // Mostly valid input, so that the fast paths get to run for a while between invalid sequences.
+            const auto n = (seed * 31 + i * 17 + (seed ^ i)) % 23;
+            u8String.append(pieces[n < 10 ? n : n % 5]);
+        }
+
+        std::wstring expected(u8String.size(), L'\0');
+        expected.resize(MultiByteToWideChar(CP_UTF8, 0, u8String.data(), gsl::narrow_cast<int>(u8String.size()), expected.data(), gsl::narrow_cast<int>(expected.size())));
+
+        std::wstring u16Out;
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+        VERIFY_ARE_EQUAL(expected, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8MatchesPlatform()
+{
+    static constexpr std::wstring_view pieces[]{
+        L"a",
+        L"0123456789abcdefghijklmnopqrstuvwxyz",
+        L"\x00F6",
+        L"\x20AC",
+        L"\xD83D\xDCF7", // U+1F4F7 (surrogate pair)
+        L"\xD83D", // lone leading surrogate
+        L"\xDCF7", // lone trailing surrogate
+    };
+
+    for (size_t seed = 0; seed < 200; ++seed)
+    {
+        std::wstring u16String;
+        for (size_t i = 0; i < 32; ++i)
+        {
+            const auto n = (seed * 31 + i * 17 + (seed ^ i)) % 19;
+            u16String.append(pieces[n < 7 ? n : n % 5]);
+        }
+
+        std::string expected(u16String.size() * 3, '\0');
+        expected.resize(WideCharToMultiByte(CP_UTF8, 0, u16String.data(), gsl::narrow_cast<int>(u16String.size()), expected.data(), gsl::narrow_cast<int>(expected.size()), nullptr, nullptr));
+
+        std::string u8Out;
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+        VERIFY_ARE_EQUAL(expected, u8Out);
+    }
+}
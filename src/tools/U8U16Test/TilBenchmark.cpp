@@ -0,0 +1,140 @@
+// TEST TOOL U8U16Test
+// Throughput benchmark for til::u8u16 and til::u16u8, which convert valid input without syscalls
+// and fall back to MultiByteToWideChar and WideCharToMultiByte for invalid sequences.
+// The platform functions are measured alongside as the baseline. Each conversion is run both
+// on the whole string and in 4 KiB chunks, which is what ConptyConnection reads at a time.
+
+#include <LibraryIncludes.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr size_t chunkSize = 4096;
+    constexpr int iterations = 10;
+
+    // Runs func `iterations` times and returns the throughput in MB of input per second for the fastest run.
+    template<typename Func>
+    double measure(size_t bytes, Func&& func)
+    {
+        auto best = clock::duration::max();
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto beg = clock::now();
+            func();
+            best = std::min(best, clock::now() - beg);
+        }
+        return static_cast<double>(bytes) / std::chrono::duration<double>(best).count() / 1e6;
+    }
+
+    void printResult(std::string_view name, double mbps)
+    {
+        std::cout << "  " << name << std::string(28 - std::min<size_t>(27, name.size()), ' ') << mbps << " MB/s" << std::endl;
+    }
+
+    void benchmark(std::string_view label, const std::string& u8)
+    {
+        std::wstring u16;
+        THROW_IF_FAILED(til::u8u16(u8, u16));
+
+        std::cout << "\n### " << label << " (" << u8.size() << " bytes) ###" << std::endl;
+
+        std::wstring out16(u8.size(), L'\0');
+        std::string out8(u16.size() * 3, '\0');
+        std::wstring str16;
+        std::string str8;
+        til::u8state state8;
+        til::u16state state16;
+
+        const auto u8Bytes = u8.size();
+        const auto u16Bytes = u16.size() * sizeof(wchar_t);
+
+        printResult("MultiByteToWideChar", measure(u8Bytes, [&]() {
+                        MultiByteToWideChar(CP_UTF8, 0, u8.data(), gsl::narrow_cast<int>(u8.size()), out16.data(), gsl::narrow_cast<int>(out16.size()));
+                    }));
+        printResult("til::u8u16", measure(u8Bytes, [&]() {
+                        THROW_IF_FAILED(til::u8u16(u8, str16));
+                    }));
+        printResult("MultiByteToWideChar 4K", measure(u8Bytes, [&]() {
+                        for (size_t i = 0; i < u8.size(); i += chunkSize)
+                        {
+                            const auto len = std::min(chunkSize, u8.size() - i);
+                            MultiByteToWideChar(CP_UTF8, 0, u8.data() + i, gsl::narrow_cast<int>(len), out16.data(), gsl::narrow_cast<int>(out16.size()));
+                        }
+                    }));
+        printResult("til::u8u16 4K (stateful)", measure(u8Bytes, [&]() {
+                        for (size_t i = 0; i < u8.size(); i += chunkSize)
+                        {
+                            THROW_IF_FAILED(til::u8u16(std::string_view{ u8 }.substr(i, chunkSize), str16, state8));
+                        }
+                    }));
+
+        printResult("WideCharToMultiByte", measure(u16Bytes, [&]() {
+                        WideCharToMultiByte(CP_UTF8, 0, u16.data(), gsl::narrow_cast<int>(u16.size()), out8.data(), gsl::narrow_cast<int>(out8.size()), nullptr, nullptr);
+                    }));
+        printResult("til::u16u8", measure(u16Bytes, [&]() {
+                        THROW_IF_FAILED(til::u16u8(u16, str8));
+                    }));
+        printResult("WideCharToMultiByte 4K", measure(u16Bytes, [&]() {
+                        for (size_t i = 0; i < u16.size(); i += chunkSize)
+                        {
+                            const auto len = std::min(chunkSize, u16.size() - i);
+                            WideCharToMultiByte(CP_UTF8, 0, u16.data() + i, gsl::narrow_cast<int>(len), out8.data(), gsl::narrow_cast<int>(out8.size()), nullptr, nullptr);
+                        }
+                    }));
+        printResult("til::u16u8 4K (stateful)", measure(u16Bytes, [&]() {
+                        for (size_t i = 0; i < u16.size(); i += chunkSize)
+                        {
+                            THROW_IF_FAILED(til::u16u8(std::wstring_view{ u16 }.substr(i, chunkSize), str8, state16));
+                        }
+                    }));
+    }
+
+    std::string repeat(std::string_view pattern, size_t bytes)
+    {
+        std::string str;
+        str.reserve(bytes + pattern.size());
+        while (str.size() < bytes)
+        {
+            str.append(pattern);
+        }
+        return str;
+    }
+
+    std::string readFile(const char* fileName)
+    {
+        std::ostringstream buf;
+        buf << std::ifstream{ fileName, std::ios::binary }.rdbuf();
+        return buf.str();
+    }
+}
+
+void TilBenchmark()
+try
+{
+    constexpr size_t size = 16 * 1024 * 1024;
+
+    std::cout << "\n\n### til::u8u16 / til::u16u8 throughput ###" << std::endl;
+
+    benchmark("ASCII", repeat("The quick brown fox jumps over the lazy dog. ", size));
+    benchmark("2-byte", repeat("\xc3\xb6\xc3\xa4\xc3\xbc\xd0\x96\xd0\xb4", size)); // öäüЖд
+    benchmark("3-byte", repeat("\xe2\x82\xac\xe4\xb8\xad\xe6\x96\x87", size)); // €中文
+    benchmark("Mixed", repeat("\x1b[38;2;255;128;0mH\xc3\xa9llo \xe2\x94\x80\xe2\x94\x80 \xf0\x9f\x98\x80\x1b[m\r\n", size)); // VT, é, ─, 😀
+
+    for (const auto fileName : { "en.txt", "fr.txt", "ru.txt", "zh.txt" })
+    {
+        const auto text = readFile(fileName);
+        if (!text.empty())
+        {
+            benchmark(fileName, repeat(text, size));
+        }
+    }
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+}
@@ -3,6 +3,7 @@
 // NOTE The functions u8u16 and u16u8 contain own algorithms. Tests have shown that they perform
 // worse than the platform API functions.
 // Thus, these functions are *unrelated* to the til::u8u16 and til::u16u8 implementation.
+// The throughput of the latter is measured by TilBenchmark(), see TilBenchmark.cpp.
 
 #include <iostream>
 #include <memory>
@@ -31,6 +32,7 @@ NTSTATUS(WINAPI* p_RtlUnicodeToUTF8N)
     _In_ ULONG UnicodeStringWCharCount){};
 
 // helper functions
+void TilBenchmark();
 double GetDuration();
 ptrdiff_t RandomIndex(ptrdiff_t length);
 void PrintHeader(const char* const funcName);
@@ -519,6 +521,8 @@ int main()
     CompNaturalLang_Chunks("ru.txt");
     CompNaturalLang_Chunks("zh.txt");
 
+    TilBenchmark();
+
     FreeLibrary(ntdll);
     return 0;
 }
@@ -325,10 +325,12 @@ enum class VtMode
     Color
 };
 
+static HANDLE g_stdin;
 static HANDLE g_stdout;
 static HANDLE g_stderr;
 static UINT g_console_cp_old;
 static DWORD g_console_mode_old;
+static DWORD g_console_input_mode_old;
 static size_t g_large_page_minimum;
 
 [[noreturn]] static void clean_exit(UINT code)
@@ -341,6 +343,10 @@ static size_t g_large_page_minimum;
     {
         SetConsoleMode(g_stdout, g_console_mode_old);
     }
+    if (g_console_input_mode_old)
+    {
+        SetConsoleMode(g_stdin, g_console_input_mode_old);
+    }
     ExitProcess(code);
 }
 
@@ -408,27 +414,473 @@ static char* allocate(size_t size)
     print_last_error("allocate memory");
 }
 
+static void release(char* address) noexcept
+{
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+// Each of the workloads below generates a single line (or a similar unit of output) at a time.
+// The lines are at most this long, which includes any VT sequences they contain.
+static constexpr size_t max_line_size = 1024;
+
+using generate_line_fn = char* (*)(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept;
+
+static char* append_random_ascii(char* dst, pcg_engines::oneseq_dxsm_64_32& rng, uint32_t count) noexcept
+{
+    static constexpr char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ./\\:-_()[]";
+
+    for (; count; --count)
+    {
+        *dst++ = alphabet[rng(static_cast<uint32_t>(sizeof(alphabet) - 1))];
+    }
+    return dst;
+}
+
+static char* append_utf8(char* dst, uint32_t cp) noexcept
+{
+    if (cp < 0x80)
+    {
+        *dst++ = static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        *dst++ = static_cast<char>(0xc0 | (cp >> 6));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        *dst++ = static_cast<char>(0xe0 | (cp >> 12));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        *dst++ = static_cast<char>(0xf0 | (cp >> 18));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    return dst;
+}
+
+// Resembles the output of a compiler or build system:
+// Long runs of printable ASCII, separated by CRLF and the occasional SGR sequence.
+// This stresses the ground state of the VT parser, which is where most of the time is spent for such output.
+static char* generate_log_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    static constexpr const char* sgr[] = { "\x1b[1;31m", "\x1b[33m", "\x1b[32m", "\x1b[36m" };
+
+    // Roughly every 8th line gets a colored prefix, similar to "warning:" or "error:" in a build log.
+    const auto colored = rng(8) == 0;
+    if (colored)
+    {
+        dst = buffer_append_string(dst, sgr[rng(4)]);
+    }
+
+    dst = append_random_ascii(dst, rng, 40 + rng(120));
+
+    if (colored)
+    {
+        dst = buffer_append_string(dst, "\x1b[m");
+    }
+
+    return buffer_append_string(dst, "\r\n");
+}
+
+// Resembles the output of `ls --color`, `git log --graph` or syntax highlighters:
+// Short runs of text with an SGR sequence in front of almost each of them.
+// This stresses the CSI dispatch and the attribute runs of the text buffer.
+static char* generate_sgr_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    for (auto runs = 8 + rng(16); runs; --runs)
+    {
+        switch (rng(4))
+        {
+        case 0:
+            dst = buffer_append_string(dst, "\x1b[38;5;");
+            dst = buffer_append_number(dst, static_cast<uint8_t>(rng(256)));
+            break;
+        case 1:
+            dst = buffer_append_string(dst, "\x1b[48;2;");
+            dst = buffer_append_number(dst, static_cast<uint8_t>(rng(256)));
+            *dst++ = ';';
+            dst = buffer_append_number(dst, static_cast<uint8_t>(rng(256)));
+            *dst++ = ';';
+            dst = buffer_append_number(dst, static_cast<uint8_t>(rng(256)));
+            break;
+        case 2:
+            dst = buffer_append_string(dst, "\x1b[");
+            dst = buffer_append_number(dst, static_cast<uint8_t>(30 + rng(8)));
+            dst = buffer_append_string(dst, rng(2) ? ";1" : ";4");
+            break;
+        default:
+            dst = buffer_append_string(dst, "\x1b[0");
+            break;
+        }
+
+        *dst++ = 'm';
+        dst = append_random_ascii(dst, rng, 1 + rng(8));
+    }
+
+    return buffer_append_string(dst, "\x1b[m\r\n");
+}
+
+// Lines of CJK ideographs, each of which is 3 bytes of UTF-8 and 2 columns wide.
+// This stresses the UTF-8 decoder and the handling of wide glyphs in the text buffer.
+static char* generate_cjk_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    for (auto count = 20 + rng(40); count; --count)
+    {
+        // CJK Unified Ideographs, U+4E00..U+9FFF, with the occasional full-width punctuation.
+        const auto cp = rng(16) == 0 ? 0x3001 + rng(2) : 0x4e00 + rng(0x5200);
+        dst = append_utf8(dst, cp);
+    }
+
+    return buffer_append_string(dst, "\r\n");
+}
+
+// Text that's interspersed with grapheme clusters of multiple codepoints:
+// Emoji with modifiers, ZWJ sequences, flags and combining marks.
+// This stresses the grapheme segmentation and the storage of clusters in the text buffer.
+static char* generate_emoji_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    static constexpr const char* clusters[] = {
+        "\xf0\x9f\x98\x80", // U+1F600 grinning face
+        "\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd", // U+1F44D U+1F3FD thumbs up with a skin tone
+        "\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x92\xbb", // U+1F469 U+200D U+1F4BB woman technologist
+        "\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa", // U+1F1E9 U+1F1EA flag of Germany
+        "\xe2\x9d\xa4\xef\xb8\x8f", // U+2764 U+FE0F red heart
+        "e\xcc\x81", // U+0065 U+0301 e with a combining acute accent
+        "\xe0\xa4\xa8\xe0\xa4\xbf", // U+0928 U+093F devanagari syllable "ni"
+    };
+
+    for (auto count = 10 + rng(20); count; --count)
+    {
+        dst = buffer_append_string(dst, clusters[rng(static_cast<uint32_t>(sizeof(clusters) / sizeof(clusters[0])))]);
+        if (rng(4) == 0)
+        {
+            dst = append_random_ascii(dst, rng, 1 + rng(8));
+        }
+    }
+
+    return buffer_append_string(dst, "\r\n");
+}
+
+// Resembles the output of full-screen applications like htop or vim:
+// Cursor positioning to random places on screen, followed by short (colored) updates.
+// This stresses the cursor movement paths, as well as partial invalidation of the screen.
+static char* generate_tui_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    for (auto updates = 4 + rng(8); updates; --updates)
+    {
+        dst = buffer_append_string(dst, "\x1b[");
+        dst = buffer_append_number(dst, static_cast<uint8_t>(1 + rng(40)));
+        *dst++ = ';';
+        dst = buffer_append_number(dst, static_cast<uint8_t>(1 + rng(100)));
+        *dst++ = 'H';
+
+        if (rng(2))
+        {
+            dst = buffer_append_string(dst, "\x1b[");
+            dst = buffer_append_number(dst, static_cast<uint8_t>(90 + rng(8)));
+            *dst++ = 'm';
+        }
+
+        dst = append_random_ascii(dst, rng, 1 + rng(20));
+
+        if (rng(4) == 0)
+        {
+            dst = buffer_append_string(dst, "\x1b[m\x1b[K");
+        }
+    }
+
+    return dst;
+}
+
+// Resembles the output of `ls --hyperlink` or compilers that link to their diagnostics:
+// Text with an OSC 8 hyperlink in each line, many of which point to the same URI.
+// This stresses the OSC string handling and the hyperlink storage of the text buffer.
+static char* generate_osc8_line(char* dst, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    dst = append_random_ascii(dst, rng, 10 + rng(40));
+
+    const auto id = static_cast<uint8_t>(rng(256));
+    dst = buffer_append_string(dst, "\x1b]8;id=");
+    dst = buffer_append_number(dst, id);
+    dst = buffer_append_string(dst, ";https://example.com/docs/");
+    dst = buffer_append_number(dst, id);
+    dst = buffer_append_string(dst, "\x1b\\");
+    dst = append_random_ascii(dst, rng, 5 + rng(20));
+    dst = buffer_append_string(dst, "\x1b]8;;\x1b\\");
+
+    dst = append_random_ascii(dst, rng, rng(40));
+    return buffer_append_string(dst, "\r\n");
+}
+
+struct Workload
+{
+    const char* name;
+    generate_line_fn generate_line;
+};
+
+static constexpr Workload workloads[] = {
+    { "log", generate_log_line },
+    { "sgr", generate_sgr_line },
+    { "cjk", generate_cjk_line },
+    { "emoji", generate_emoji_line },
+    { "tui", generate_tui_line },
+    { "osc8", generate_osc8_line },
+};
+
+// Fills the buffer with lines of the given workload. The last line is replaced with spaces
+// if it doesn't fit, so that the output doesn't end within a VT sequence or a UTF-8 character.
+static void generate(char* dst, size_t size, const Workload& workload, pcg_engines::oneseq_dxsm_64_32& rng) noexcept
+{
+    const auto end = dst + size;
+
+    while (dst < end)
+    {
+        char line[max_line_size];
+        const auto line_end = workload.generate_line(&line[0], rng);
+        const auto line_size = static_cast<size_t>(line_end - &line[0]);
+
+        if (line_size <= static_cast<size_t>(end - dst))
+        {
+            dst = buffer_append(dst, &line[0], line_size);
+        }
+        else
+        {
+            memset(dst, ' ', static_cast<size_t>(end - dst));
+            dst = end;
+        }
+    }
+}
+
 static BOOL WINAPI consoleCtrlHandler(DWORD)
 {
     CancelIoEx(g_stdout, nullptr);
     return TRUE;
 }
 
+// Applies the -vi and -vc transformations to the input. Returns the input as-is otherwise.
+static char* apply_vt_mode(char* data, size_t size, VtMode vt, pcg_engines::oneseq_dxsm_64_32& rng, size_t* out_size)
+{
+    *out_size = size;
+
+    switch (vt)
+    {
+    case VtMode::Italic:
+    {
+        const auto out = allocate(size + 16);
+        auto p = out;
+        p = buffer_append_string(p, "\x1b[3m");
+        p = buffer_append_long(p, data, size);
+        p = buffer_append_string(p, "\x1b[0m");
+        *out_size = static_cast<size_t>(p - out);
+        return out;
+    }
+    case VtMode::Color:
+    {
+        if (const auto icu = LoadLibraryExW(L"icuuc.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32))
+        {
+            const auto out = allocate(size * 20 + 8);
+            auto p = out;
+
+            const auto p_utext_openUTF8 = reinterpret_cast<decltype(&utext_openUTF8)>(GetProcAddress(icu, "utext_openUTF8"));
+            const auto p_ubrk_open = reinterpret_cast<decltype(&ubrk_open)>(GetProcAddress(icu, "ubrk_open"));
+            const auto p_ubrk_setUText = reinterpret_cast<decltype(&ubrk_setUText)>(GetProcAddress(icu, "ubrk_setUText"));
+            const auto p_ubrk_next = reinterpret_cast<decltype(&ubrk_next)>(GetProcAddress(icu, "ubrk_next"));
+
+            auto error = U_ZERO_ERROR;
+            UText text = UTEXT_INITIALIZER;
+            p_utext_openUTF8(&text, data, size, &error);
+
+            const auto it = p_ubrk_open(UBRK_CHARACTER, "", nullptr, 0, &error);
+            p_ubrk_setUText(it, &text, &error);
+
+            for (int32_t ubrk0 = 0, ubrk1; (ubrk1 = p_ubrk_next(it)) != UBRK_DONE; ubrk0 = ubrk1)
+            {
+                p = buffer_append_string(p, "\x1b[38;2");
+                for (int i = 0; i < 3; i++)
+                {
+                    *p++ = ';';
+                    p = buffer_append_number(p, static_cast<uint8_t>(rng()));
+                }
+                p = buffer_append_string(p, "m");
+                p = buffer_append(p, data + ubrk0, ubrk1 - ubrk0);
+            }
+
+            p = buffer_append_string(p, "\x1b[39;49m");
+            *out_size = static_cast<size_t>(p - out);
+            return out;
+        }
+        return data;
+    }
+    default:
+        return data;
+    }
+}
+
+// Waits until the terminal has caught up with everything we've written so far.
+// WriteFile() returns as soon as the data is in the pipe, which for ConPTY only means that conhost has received it.
+// By requesting a cursor position report (DSR CPR) and waiting for the answer, the measurement includes
+// the time it takes the terminal to work through the backlog, as it answers requests in order.
+static void drain() noexcept
+{
+    static constexpr char request[] = "\x1b[6n";
+    if (!WriteFile(g_stdout, &request[0], sizeof(request) - 1, nullptr, nullptr))
+    {
+        print_last_error("write");
+    }
+
+    for (;;)
+    {
+        char buffer[64];
+        DWORD read = 0;
+        if (!ReadFile(g_stdin, &buffer[0], sizeof(buffer), &read, nullptr) || read == 0)
+        {
+            print_last_error("read the cursor position report");
+        }
+
+        // The report is "\x1b[{row};{col}R". Anything else is user input that we don't care about.
+        for (DWORD i = 0; i < read; ++i)
+        {
+            if (buffer[i] == 'R')
+            {
+                return;
+            }
+        }
+    }
+}
+
+struct BenchResult
+{
+    LONGLONG bytes;
+    LONGLONG write_us;
+    LONGLONG total_us;
+};
+
+static BenchResult measure(const char* data, size_t size, uint32_t repeat, uint32_t chunk_size, bool drained) noexcept
+{
+    LARGE_INTEGER frequency, beg, end_write, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&beg);
+
+    for (size_t iteration = 0; iteration < repeat; ++iteration)
+    {
+        auto write_data = data;
+        DWORD written = 0;
+
+        for (auto remaining = size; remaining != 0; remaining -= written, write_data += written)
+        {
+            written = static_cast<DWORD>(min<size_t>(remaining, chunk_size));
+            if (!WriteFile(g_stdout, write_data, written, &written, nullptr))
+            {
+                print_last_error("write");
+            }
+        }
+    }
+
+    QueryPerformanceCounter(&end_write);
+
+    if (drained)
+    {
+        drain();
+    }
+
+    QueryPerformanceCounter(&end);
+
+    BenchResult result;
+    result.bytes = static_cast<LONGLONG>(size) * repeat;
+    result.write_us = ((end_write.QuadPart - beg.QuadPart) * 1'000'000) / frequency.QuadPart;
+    result.total_us = ((end.QuadPart - beg.QuadPart) * 1'000'000) / frequency.QuadPart;
+    return result;
+}
+
+static void report(const char* name, const BenchResult& result, uint32_t repeat, uint32_t chunk_size, bool drained, bool json) noexcept
+{
+    const auto bytes_per_second = result.total_us ? (result.bytes * 1'000'000) / result.total_us : 0;
+
+    char buffer[512];
+    char* buffer_end = &buffer[0];
+
+    if (json)
+    {
+        // One object per line, with integers only and in a fixed order, so that results can be diffed and
+        // collected over time. "total_us" includes the time it took the terminal to catch up if "drained" is true.
+        const auto length = format(
+            &buffer[0],
+            sizeof(buffer) - 2,
+            "{\"workload\":\"%s\",\"bytes\":%lld,\"repeat\":%lu,\"chunk_size\":%lu,\"drained\":%s,\"write_us\":%lld,\"total_us\":%lld,\"bytes_per_second\":%lld}",
+            name,
+            result.bytes,
+            repeat,
+            chunk_size,
+            drained ? "true" : "false",
+            result.write_us,
+            result.total_us,
+            bytes_per_second);
+        if (length <= 0)
+        {
+            clean_exit(1);
+        }
+
+        buffer_end += length;
+        buffer_end = buffer_append_string(buffer_end, "\r\n");
+    }
+    else
+    {
+        const auto written = format_size(result.bytes);
+        const auto duration = format_duration(result.total_us);
+        const auto throughput = format_size(bytes_per_second);
+
+        char status[128];
+        const auto status_length = format(
+            &status[0],
+            sizeof(status),
+            "%s: " FORMAT_RESULT_FMT "B, " FORMAT_RESULT_FMT "s, " FORMAT_RESULT_FMT "B/s",
+            name,
+            FORMAT_RESULT_ARGS(written),
+            FORMAT_RESULT_ARGS(duration),
+            FORMAT_RESULT_ARGS(throughput));
+        if (status_length <= 0)
+        {
+            clean_exit(1);
+        }
+
+        buffer_end = buffer_append_string(buffer_end, "\r\n");
+        for (int i = 0; i < status_length; ++i)
+        {
+            *buffer_end++ = '-';
+        }
+        buffer_end = buffer_append_string(buffer_end, "\r\n");
+        buffer_end = buffer_append_long(buffer_end, &status[0], static_cast<size_t>(status_length));
+        buffer_end = buffer_append_string(buffer_end, "\r\n");
+    }
+
+    WriteFile(g_stderr, &buffer[0], static_cast<DWORD>(buffer_end - &buffer[0]), nullptr, nullptr);
+}
+
 int __stdcall main() noexcept
 {
+    g_stdin = GetStdHandle(STD_INPUT_HANDLE);
     g_stdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    g_stderr = GetStdHandle(STD_OUTPUT_HANDLE);
+    g_stderr = GetStdHandle(STD_ERROR_HANDLE);
     g_console_cp_old = GetConsoleOutputCP();
 
     SetConsoleCtrlHandler(consoleCtrlHandler, TRUE);
     SetConsoleOutputCP(CP_UTF8);
 
     const wchar_t* path = nullptr;
+    const wchar_t* workload_name = nullptr;
+    uint32_t parser_size = 0;
     uint32_t chunk_size = 128 * 1024;
     uint32_t repeat = 1;
     VtMode vt = VtMode::Off;
     uint64_t seed = 0;
     bool has_seed = false;
+    bool drained = false;
+    bool json = false;
 
     {
         int argc;
@@ -441,6 +893,18 @@ int __stdcall main() noexcept
                 // 1GiB is the maximum buffer size WriteFile seems to accept.
                 chunk_size = min<uint32_t>(parse_number_with_suffix(suffix), 1024 * 1024 * 1024);
             }
+            else if (has_suffix(argv[i], L"-d"))
+            {
+                drained = true;
+            }
+            else if (has_suffix(argv[i], L"-j"))
+            {
+                json = true;
+            }
+            else if (const auto suffix = split_prefix(argv[i], L"-p"))
+            {
+                parser_size = parse_number_with_suffix(suffix);
+            }
             else if (const auto suffix = split_prefix(argv[i], L"-r"))
             {
                 repeat = parse_number_with_suffix(suffix);
@@ -461,7 +925,11 @@ int __stdcall main() noexcept
                     break;
                 }
             }
-            else if (has_suffix(argv[i], L"-s"))
+            else if (const auto suffix = split_prefix(argv[i], L"-w"))
+            {
+                workload_name = suffix;
+            }
+            else if (const auto suffix = split_prefix(argv[i], L"-s"))
             {
                 seed = parse_number_with_suffix(suffix);
                 has_seed = true;
@@ -477,20 +945,73 @@ int __stdcall main() noexcept
         }
     }
 
-    if (!path || !chunk_size || !repeat)
+    // Select the synthetic workloads to run. -p without -w runs the log workload, for compatibility.
+    const Workload* workload_beg = nullptr;
+    const Workload* workload_end = nullptr;
+    if (workload_name || parser_size)
+    {
+        if (!workload_name || has_suffix(workload_name, L"log"))
+        {
+            workload_beg = &workloads[0];
+            workload_end = &workloads[1];
+        }
+        else if (has_suffix(workload_name, L"all"))
+        {
+            workload_beg = &workloads[0];
+            workload_end = &workloads[sizeof(workloads) / sizeof(workloads[0])];
+        }
+        else
+        {
+            for (const auto& w : workloads)
+            {
+                wchar_t name[16]{};
+                for (size_t i = 0; w.name[i] && i < 15; ++i)
+                {
+                    name[i] = static_cast<wchar_t>(w.name[i]);
+                }
+                if (has_suffix(workload_name, &name[0]))
+                {
+                    workload_beg = &w;
+                    workload_end = &w + 1;
+                }
+            }
+        }
+
+        if (!parser_size)
+        {
+            parser_size = 16 * 1024 * 1024;
+        }
+    }
+
+    if ((!path && !workload_beg) || !chunk_size || !repeat)
     {
         eprintf(
             "bc [options] <filename>\r\n"
             "  -v        enable VT\r\n"
             "  -vi       print as italic\r\n"
             "  -vc       print colorized\r\n"
+            "  -w{name}  synthetic benchmark: instead of <filename>, print\r\n"
+            "            generated output of one of these workloads:\r\n"
+            "            log, sgr, cjk, emoji, tui, osc8, or all of them\r\n"
+            "  -p{d}{u}  size of the synthetic output, defaults to 16Mi\r\n"
+            "            with -w, or runs the log workload without it\r\n"
             "  -c{d}{u}  chunk size, defaults to 128Ki\r\n"
             "  -r{d}{u}  repeats, defaults to 1\r\n"
             "  -s{d}     RNG seed\r\n"
+            "  -d        wait for the terminal to process all output\r\n"
+            "            before stopping the clock\r\n"
+            "  -j        print the results as JSON, one line per run\r\n"
             "{d} are base-10 digits\r\n"
             "{u} are suffix units k, Ki, M, Mi, G, Gi\r\n");
     }
 
+    // The synthetic output contains VT sequences which we want to be parsed and not printed as-is,
+    // and the DSR CPR request of -d needs to be processed too, so both require VT processing to be enabled.
+    if ((workload_beg || drained) && vt == VtMode::Off)
+    {
+        vt = VtMode::On;
+    }
+
     if (!has_seed && vt == VtMode::Color)
     {
         const auto cryptbase = LoadLibraryExW(L"cryptbase.dll", nullptr, 0);
@@ -510,183 +1031,123 @@ int __stdcall main() noexcept
 
     pcg_engines::oneseq_dxsm_64_32 rng{ seed };
 
-    const auto stdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    const auto file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-    if (file == INVALID_HANDLE_VALUE)
-    {
-        print_last_error("open file");
-    }
+    acquire_lock_memory_privilege();
 
-    size_t file_size = 0;
     {
-#ifdef _WIN64
-        LARGE_INTEGER i;
-        if (!GetFileSizeEx(file, &i))
+        DWORD mode = 0;
+        if (!GetConsoleMode(g_stdout, &mode))
         {
-            print_last_error("open file");
+            print_last_error("get console mode");
         }
 
-        file_size = static_cast<size_t>(i.QuadPart);
+        g_console_mode_old = mode;
 
-#else
-        file_size = GetFileSize(file, nullptr);
-        if (file_size == INVALID_FILE_SIZE)
+        mode |= ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
+        mode &= ~(ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+        if (vt != VtMode::Off)
         {
-            print_last_error("open file");
+            mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+        }
+
+        if (!SetConsoleMode(g_stdout, mode))
+        {
+            print_last_error("set console mode");
         }
-#endif
     }
 
-    acquire_lock_memory_privilege();
+    if (drained)
+    {
+        // The cursor position report is delivered as VT input, and we want to read it without waiting for a newline.
+        DWORD mode = 0;
+        if (!GetConsoleMode(g_stdin, &mode))
+        {
+            print_last_error("get console input mode");
+        }
 
-    const auto file_data = allocate(file_size);
-    auto stdout_size = file_size;
-    auto stdout_data = file_data;
+        g_console_input_mode_old = mode;
 
-    {
-        auto read_data = file_data;
-        DWORD read = 0;
+        mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
+        mode &= ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT);
 
-        for (auto remaining = file_size; remaining > 0; remaining -= read, read_data += read)
+        if (!SetConsoleMode(g_stdin, mode))
         {
-            read = static_cast<DWORD>(min<size_t>(0xffffffff, remaining));
-            if (!ReadFile(file, read_data, read, &read, nullptr))
-            {
-                print_last_error("read");
-            }
+            print_last_error("set console input mode");
         }
     }
 
-    switch (vt)
-    {
-    case VtMode::Italic:
+    if (workload_beg)
     {
-        stdout_data = allocate(file_size + 16);
-        auto p = stdout_data;
-        p = buffer_append_string(p, "\x1b[3m");
-        p = buffer_append_long(p, file_data, file_size);
-        p = buffer_append_string(p, "\x1b[0m");
-        stdout_size = static_cast<DWORD>(p - stdout_data);
-        break;
-    }
-    case VtMode::Color:
-    {
-        if (const auto icu = LoadLibraryExW(L"icuuc.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32))
+        // The same buffer is reused for each of the workloads, as they're all the same size.
+        const auto file_data = allocate(parser_size);
+
+        for (auto w = workload_beg; w != workload_end; ++w)
         {
-            stdout_data = allocate(file_size * 20 + 8);
-            auto p = stdout_data;
+            generate(file_data, parser_size, *w, rng);
 
-            const auto p_utext_openUTF8 = reinterpret_cast<decltype(&utext_openUTF8)>(GetProcAddress(icu, "utext_openUTF8"));
-            const auto p_ubrk_open = reinterpret_cast<decltype(&ubrk_open)>(GetProcAddress(icu, "ubrk_open"));
-            const auto p_ubrk_setUText = reinterpret_cast<decltype(&ubrk_setUText)>(GetProcAddress(icu, "ubrk_setUText"));
-            const auto p_ubrk_next = reinterpret_cast<decltype(&ubrk_next)>(GetProcAddress(icu, "ubrk_next"));
+            size_t stdout_size = 0;
+            const auto stdout_data = apply_vt_mode(file_data, parser_size, vt, rng, &stdout_size);
 
-            auto error = U_ZERO_ERROR;
-            UText text = UTEXT_INITIALIZER;
-            p_utext_openUTF8(&text, file_data, file_size, &error);
+            const auto result = measure(stdout_data, stdout_size, repeat, chunk_size, drained);
+            report(w->name, result, repeat, chunk_size, drained, json);
 
-            const auto it = p_ubrk_open(UBRK_CHARACTER, "", nullptr, 0, &error);
-            p_ubrk_setUText(it, &text, &error);
+            // Reset the screen between the workloads, so that they don't affect each other, for instance
+            // because the TUI workload left the cursor somewhere in the middle of the viewport.
+            static constexpr char reset[] = "\x1b[m\x1b[H\x1b[2J";
+            WriteFile(g_stdout, &reset[0], sizeof(reset) - 1, nullptr, nullptr);
 
-            for (int32_t ubrk0 = 0, ubrk1; (ubrk1 = p_ubrk_next(it)) != UBRK_DONE; ubrk0 = ubrk1)
+            if (stdout_data != file_data)
             {
-                p = buffer_append_string(p, "\x1b[38;2");
-                for (int i = 0; i < 3; i++)
-                {
-                    *p++ = ';';
-                    p = buffer_append_number(p, static_cast<uint8_t>(rng()));
-                }
-                p = buffer_append_string(p, "m");
-                p = buffer_append(p, file_data + ubrk0, ubrk1 - ubrk0);
+                release(stdout_data);
             }
-
-            p = buffer_append_string(p, "\x1b[39;49m");
-            stdout_size = static_cast<DWORD>(p - stdout_data);
         }
-        break;
     }
-    default:
-        break;
-    }
-
+    else
     {
-        DWORD mode = 0;
-        if (!GetConsoleMode(g_stdout, &mode))
+        const auto file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
         {
-            print_last_error("get console mode");
+            print_last_error("open file");
         }
 
-        g_console_mode_old = mode;
+        size_t file_size = 0;
 
-        mode |= ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
-        mode &= ~(ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
-        if (vt != VtMode::Off)
+#ifdef _WIN64
+        LARGE_INTEGER i;
+        if (!GetFileSizeEx(file, &i))
         {
-            mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+            print_last_error("open file");
         }
 
-        if (!SetConsoleMode(g_stdout, mode))
+        file_size = static_cast<size_t>(i.QuadPart);
+
+#else
+        file_size = GetFileSize(file, nullptr);
+        if (file_size == INVALID_FILE_SIZE)
         {
-            print_last_error("set console mode");
+            print_last_error("open file");
         }
-    }
+#endif
 
-    LARGE_INTEGER frequency, beg, end;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&beg);
+        const auto file_data = allocate(file_size);
 
-    for (size_t iteration = 0; iteration < repeat; ++iteration)
-    {
-        auto write_data = stdout_data;
-        DWORD written = 0;
+        auto read_data = file_data;
+        DWORD read = 0;
 
-        for (auto remaining = stdout_size; remaining != 0; remaining -= written, write_data += written)
+        for (auto remaining = file_size; remaining > 0; remaining -= read, read_data += read)
         {
-            written = static_cast<DWORD>(min<size_t>(remaining, chunk_size));
-            if (!WriteFile(stdout, write_data, written, &written, nullptr))
+            read = static_cast<DWORD>(min<size_t>(0xffffffff, remaining));
+            if (!ReadFile(file, read_data, read, &read, nullptr))
             {
-                print_last_error("write");
+                print_last_error("read");
             }
         }
-    }
 
-    QueryPerformanceCounter(&end);
-
-    const auto elapsed_ticks = end.QuadPart - beg.QuadPart;
-    const auto elapsed_us = (elapsed_ticks * 1'000'000) / frequency.QuadPart;
-    LONGLONG total_size = static_cast<LONGLONG>(stdout_size) * repeat;
-    const auto bytes_per_second = (total_size * frequency.QuadPart) / elapsed_ticks;
-
-    const auto written = format_size(total_size);
-    const auto duration = format_duration(elapsed_us);
-    const auto throughput = format_size(bytes_per_second);
+        size_t stdout_size = 0;
+        const auto stdout_data = apply_vt_mode(file_data, file_size, vt, rng, &stdout_size);
 
-    char status[128];
-    const auto status_length = format(
-        &status[0],
-        1024,
-        FORMAT_RESULT_FMT "B, " FORMAT_RESULT_FMT "s, " FORMAT_RESULT_FMT "B/s",
-        FORMAT_RESULT_ARGS(written),
-        FORMAT_RESULT_ARGS(duration),
-        FORMAT_RESULT_ARGS(throughput));
-
-    if (status_length <= 0)
-    {
-        clean_exit(1);
+        const auto result = measure(stdout_data, stdout_size, repeat, chunk_size, drained);
+        report("file", result, repeat, chunk_size, drained, json);
     }
 
-    char buffer[256];
-    char* buffer_end = &buffer[0];
-
-    buffer_end = buffer_append_string(buffer_end, "\r\n");
-    for (int i = 0; i < status_length; ++i)
-    {
-        *buffer_end++ = '-';
-    }
-    buffer_end = buffer_append_string(buffer_end, "\r\n");
-    buffer_end = buffer_append_long(buffer_end, &status[0], static_cast<size_t>(status_length));
-    buffer_end = buffer_append_string(buffer_end, "\r\n");
-
-    WriteFile(g_stderr, &buffer[0], static_cast<DWORD>(buffer_end - &buffer[0]), nullptr, nullptr);
     clean_exit(0);
 }
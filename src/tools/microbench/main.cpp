@@ -0,0 +1,426 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Microbenchmarks for the hot paths of the parser, ROW and TextBuffer, as well as some of the
+// til helpers they're built on. Unlike benchcat, which measures a terminal from the outside,
+// these call the code directly and so are suitable for judging changes to individual functions.
+//
+// Usage: microbench [--json] [filter]
+//   Runs all benchmarks whose name contains the filter string. With --json, each result
+//   is printed as a single-line JSON object, in the same manner as benchcat -j.
+
+#include "precomp.h"
+
+#include <til/rle.h>
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+#include "../../terminal/adapter/IInteractDispatch.hpp"
+#include "../../terminal/adapter/termDispatch.hpp"
+#include "../../terminal/parser/InputStateMachineEngine.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../terminal/parser/stateMachine.hpp"
+#include "../../types/inc/CodepointWidthDetector.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+using namespace Microsoft::Console::Types;
+
+// Each benchmark is repeated with a doubling number of iterations until a batch takes at least this long.
+static constexpr auto MinimumBatchDuration = std::chrono::milliseconds(250);
+
+namespace
+{
+    struct Benchmark
+    {
+        std::string_view name;
+        // The number of bytes (or characters) processed by each iteration, for the throughput figure. Can be 0.
+        size_t bytesPerIteration;
+        std::function<void()> iteration;
+    };
+
+    // Prevents the compiler from optimizing away computations whose results are otherwise unused.
+    template<typename T>
+    void doNotOptimize(const T& value) noexcept
+    {
+        static const volatile void* sink;
+        sink = &value;
+        _ReadWriteBarrier();
+    }
+
+    class NullTermDispatch final : public TermDispatch
+    {
+    public:
+        void Print(const wchar_t /*wchPrintable*/) override
+        {
+        }
+
+        void PrintString(const std::wstring_view string) override
+        {
+            doNotOptimize(string);
+        }
+    };
+
+    class NullInteractDispatch final : public IInteractDispatch
+    {
+    public:
+        bool WriteInput(const std::span<const INPUT_RECORD>& inputEvents) override
+        {
+            doNotOptimize(inputEvents);
+            return true;
+        }
+
+        bool WriteCtrlKey(const INPUT_RECORD& /*event*/) override
+        {
+            return true;
+        }
+
+        bool WriteString(const std::wstring_view string) override
+        {
+            doNotOptimize(string);
+            return true;
+        }
+
+        bool WindowManipulation(const DispatchTypes::WindowManipulationType /*function*/,
+                                const VTParameter /*parameter1*/,
+                                const VTParameter /*parameter2*/) override
+        {
+            return true;
+        }
+
+        bool MoveCursor(const VTInt /*row*/, const VTInt /*col*/) override
+        {
+            return true;
+        }
+
+        bool IsVtInputEnabled() const override
+        {
+            return true;
+        }
+
+        bool FocusChanged(const bool /*focused*/) const override
+        {
+            return true;
+        }
+    };
+}
+
+// Output that resembles a build log: long runs of printable ASCII with the occasional SGR sequence.
+static std::wstring generateLog(size_t size)
+{
+    static constexpr std::wstring_view alphabet{ L"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ./\\:-_()[]" };
+
+    std::wstring text;
+    text.reserve(size + 256);
+
+    for (size_t line = 0; text.size() < size; ++line)
+    {
+        const auto colored = line % 8 == 0;
+        if (colored)
+        {
+            text.append(L"\x1b[1;31m");
+        }
+        for (size_t i = 0; i < 40 + (line * 37) % 120; ++i)
+        {
+            text.push_back(alphabet[(line * 31 + i * 7) % alphabet.size()]);
+        }
+        if (colored)
+        {
+            text.append(L"\x1b[m");
+        }
+        text.append(L"\r\n");
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// Output that resembles syntax highlighted text: an SGR sequence in front of every few characters.
+static std::wstring generateSgr(size_t size)
+{
+    std::wstring text;
+    text.reserve(size + 256);
+
+    for (size_t i = 0; text.size() < size; ++i)
+    {
+        text.append(fmt::format(FMT_COMPILE(L"\x1b[38;5;{}m"), i % 256));
+        text.append(L"word ");
+        if (i % 16 == 15)
+        {
+            text.append(L"\x1b[m\r\n");
+        }
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// Lines of CJK ideographs, which are wide glyphs, interspersed with ASCII.
+static std::wstring generateCjk(size_t size)
+{
+    std::wstring text;
+    text.reserve(size + 256);
+
+    for (size_t i = 0; text.size() < size; ++i)
+    {
+        text.push_back(static_cast<wchar_t>(0x4e00 + (i * 7919) % 0x5200));
+        if (i % 8 == 7)
+        {
+            text.append(L" abc ");
+        }
+        if (i % 40 == 39)
+        {
+            text.append(L"\r\n");
+        }
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// Input as it arrives from a terminal in win32-input-mode off: keys, cursor keys and mouse reports.
+static std::wstring generateInput(size_t size)
+{
+    static constexpr std::wstring_view sequences[] = {
+        L"a", L"hello world", L"\x1b[A", L"\x1b[1;5C", L"\x1b[<0;12;5M", L"\x1b[<0;12;5m", L"\r", L"\x1bOP"
+    };
+
+    std::wstring text;
+    text.reserve(size + 256);
+
+    for (size_t i = 0; text.size() < size; ++i)
+    {
+        text.append(til::at(sequences, (i * 5) % std::size(sequences)));
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// Fills all rows of the buffer with a few lines of text that wrap at the end of each row,
+// so that reflowing the buffer has to actually move text around.
+static void fillBuffer(TextBuffer& buffer, const std::wstring_view& text)
+{
+    auto remaining = text;
+    for (til::CoordType y = 0; y < buffer.TotalRowCount(); ++y)
+    {
+        if (remaining.empty())
+        {
+            remaining = text;
+        }
+
+        RowWriteState state{ .text = remaining };
+        auto& row = buffer.GetMutableRowByOffset(y);
+        row.ReplaceText(state);
+        row.SetWrapForced(!state.text.empty());
+        remaining = state.text;
+    }
+}
+
+static std::vector<Benchmark> createBenchmarks(DummyRenderer& renderer)
+{
+    std::vector<Benchmark> benchmarks;
+
+    static constexpr size_t parserInputSize = 1024 * 1024;
+    static constexpr til::size bufferSize{ 120, 9001 };
+    const TextAttribute defaultAttr{ 0x07 };
+
+    // StateMachine::ProcessString with the output engine, the one conhost and Terminal use for application output.
+    for (auto [name, text] : {
+             std::pair{ "parser/output/log", generateLog(parserInputSize) },
+             std::pair{ "parser/output/sgr", generateSgr(parserInputSize) },
+             std::pair{ "parser/output/cjk", generateCjk(parserInputSize) },
+         })
+    {
+        const auto size = text.size() * sizeof(wchar_t);
+        auto machine = std::make_shared<StateMachine>(std::make_unique<OutputStateMachineEngine>(std::make_unique<NullTermDispatch>()));
+        benchmarks.emplace_back(name, size, [machine, text = std::move(text)]() {
+            machine->ProcessString(text);
+        });
+    }
+
+    // StateMachine::ProcessString with the input engine, the one conhost uses for VT input.
+    {
+        auto machine = std::make_shared<StateMachine>(std::make_unique<InputStateMachineEngine>(std::make_unique<NullInteractDispatch>()));
+        auto text = generateInput(parserInputSize);
+        const auto size = text.size() * sizeof(wchar_t);
+        benchmarks.emplace_back("parser/input", size, [machine, text = std::move(text)]() {
+            machine->ProcessString(text);
+        });
+    }
+
+    // ROW::ReplaceText with a full row of ASCII and of wide glyphs.
+    for (auto [name, text] : {
+             std::pair{ "row/ReplaceText/ascii", std::wstring(bufferSize.width, L'a') },
+             std::pair{ "row/ReplaceText/cjk", std::wstring(bufferSize.width / 2, L'\x4e00') },
+         })
+    {
+        const auto size = text.size() * sizeof(wchar_t);
+        auto buffer = std::make_shared<TextBuffer>(til::size{ bufferSize.width, 2 }, defaultAttr, 12, false, renderer);
+        benchmarks.emplace_back(name, size, [buffer, text = std::move(text)]() {
+            RowWriteState state{ .text = text };
+            buffer->GetMutableRowByOffset(0).ReplaceText(state);
+            doNotOptimize(state.columnEnd);
+        });
+    }
+
+    // ROW::ReplaceAttributes with a new attribute every 8 columns, as is typical for colored output.
+    {
+        auto buffer = std::make_shared<TextBuffer>(til::size{ bufferSize.width, 2 }, defaultAttr, 12, false, renderer);
+        benchmarks.emplace_back("row/ReplaceAttributes", 0, [buffer]() {
+            auto& row = buffer->GetMutableRowByOffset(0);
+            for (til::CoordType x = 0; x < bufferSize.width; x += 8)
+            {
+                row.ReplaceAttributes(x, x + 8, TextAttribute{ static_cast<WORD>(x % 16) });
+            }
+        });
+    }
+
+    // ROW::CopyTextFrom between two rows, as during a reflow or when scrolling with a margin.
+    {
+        auto buffer = std::make_shared<TextBuffer>(til::size{ bufferSize.width, 2 }, defaultAttr, 12, false, renderer);
+        fillBuffer(*buffer, generateCjk(bufferSize.width));
+        benchmarks.emplace_back("row/CopyTextFrom", 0, [buffer]() {
+            RowCopyTextFromState state{ .source = buffer->GetRowByOffset(0) };
+            buffer->GetMutableRowByOffset(1).CopyTextFrom(state);
+            doNotOptimize(state.columnEnd);
+        });
+    }
+
+    // TextBuffer::Reflow of a full buffer from 120 to 80 columns, as when the window gets resized.
+    {
+        auto buffer = std::make_shared<TextBuffer>(bufferSize, defaultAttr, 12, false, renderer);
+        fillBuffer(*buffer, generateLog(4096));
+        benchmarks.emplace_back("textbuffer/Reflow", 0, [buffer, defaultAttr, &renderer]() {
+            TextBuffer newBuffer{ { 80, bufferSize.height }, defaultAttr, 12, false, renderer };
+            THROW_IF_FAILED(TextBuffer::Reflow(*buffer, newBuffer, std::nullopt, std::nullopt));
+        });
+    }
+
+    // TextBuffer::SearchText for a needle that occurs a few times, case-sensitively and not.
+    for (const auto caseInsensitive : { false, true })
+    {
+        auto buffer = std::make_shared<TextBuffer>(bufferSize, defaultAttr, 12, false, renderer);
+        fillBuffer(*buffer, generateLog(4096));
+        const auto name = caseInsensitive ? "textbuffer/SearchText/icase" : "textbuffer/SearchText";
+        benchmarks.emplace_back(name, 0, [buffer, caseInsensitive]() {
+            const auto results = buffer->SearchText(L"abcd", caseInsensitive);
+            doNotOptimize(results);
+        });
+    }
+
+    // til::small_rle::replace with short runs, the way ROW uses it for its attributes.
+    {
+        auto rle = std::make_shared<til::small_rle<TextAttribute, uint16_t, 1>>(static_cast<uint16_t>(bufferSize.width), TextAttribute{});
+        benchmarks.emplace_back("til/small_rle/replace", 0, [rle]() {
+            for (uint16_t x = 0; x + 3 < bufferSize.width; x += 5)
+            {
+                rle->replace(x, static_cast<uint16_t>(x + 3), TextAttribute{ static_cast<WORD>(x % 16) });
+            }
+            rle->replace(0, static_cast<uint16_t>(bufferSize.width), TextAttribute{});
+        });
+    }
+
+    // til::u8u16 of mixed ASCII and CJK text.
+    {
+        auto text = std::make_shared<std::string>(til::u16u8(generateCjk(parserInputSize / 2)));
+        benchmarks.emplace_back("til/u8u16", text->size(), [text]() {
+            std::wstring out;
+            THROW_IF_FAILED(til::u8u16(*text, out));
+            doNotOptimize(out);
+        });
+    }
+
+    // CodepointWidthDetector::GetWidth for each glyph of mixed ASCII and CJK text.
+    {
+        auto detector = std::make_shared<CodepointWidthDetector>();
+        auto text = generateCjk(64 * 1024);
+        const auto size = text.size() * sizeof(wchar_t);
+        benchmarks.emplace_back("types/CodepointWidthDetector/GetWidth", size, [detector, text = std::move(text)]() {
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                doNotOptimize(detector->GetWidth({ &text[i], 1 }));
+            }
+        });
+    }
+
+    return benchmarks;
+}
+
+static void run(const Benchmark& benchmark, bool json)
+{
+    using clock = std::chrono::steady_clock;
+
+    // Warm up the caches and any lazily initialized state.
+    benchmark.iteration();
+
+    uint64_t iterations = 1;
+    clock::duration elapsed{};
+    for (;;)
+    {
+        const auto beg = clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            benchmark.iteration();
+        }
+        elapsed = clock::now() - beg;
+
+        if (elapsed >= MinimumBatchDuration)
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    const auto totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    const auto nsPerIteration = totalNs / static_cast<int64_t>(iterations);
+    const auto bytesPerSecond = totalNs ? static_cast<int64_t>(benchmark.bytesPerIteration * iterations * 1'000'000'000 / totalNs) : 0;
+
+    if (json)
+    {
+        fmt::print(FMT_COMPILE("{{\"name\":\"{}\",\"iterations\":{},\"ns_per_iteration\":{},\"bytes_per_second\":{}}}\n"), benchmark.name, iterations, nsPerIteration, bytesPerSecond);
+    }
+    else if (benchmark.bytesPerIteration)
+    {
+        fmt::print(FMT_COMPILE("{:<40} {:>12} ns {:>10.1f} MB/s\n"), benchmark.name, nsPerIteration, bytesPerSecond / 1e6);
+    }
+    else
+    {
+        fmt::print(FMT_COMPILE("{:<40} {:>12} ns\n"), benchmark.name, nsPerIteration);
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    bool json = false;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::wstring_view arg{ argv[i] };
+        if (arg == L"--json")
+        {
+            json = true;
+        }
+        else
+        {
+            filter = til::u16u8(arg);
+        }
+    }
+
+    DummyRenderer renderer;
+    for (const auto& benchmark : createBenchmarks(renderer))
+    {
+        if (benchmark.name.find(filter) != std::string_view::npos)
+        {
+            run(benchmark, json);
+        }
+    }
+
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return 1;
+}
@@ -0,0 +1,338 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Measures the frame times of the AtlasEngine backends. VT captures (for instance made with
+// `script` or by redirecting benchcat's output into a file) are replayed into a Terminal and after
+// each chunk a frame is painted synchronously into a hidden window, the same way the render
+// thread would do it. This avoids the noise of a real terminal window, like input handling,
+// the conpty round trip and vsync, and makes the results comparable across machines via WARP.
+//
+// Usage: renderbench [--d3d|--d2d|--both] [--warp] [--json] [--size WxH] [--chunk N] <file>...
+//   --d3d, --d2d, --both  The backend(s) to benchmark. Defaults to --both.
+//   --warp                Use the WARP software rasterizer instead of the GPU.
+//   --json                Print each result as a single-line JSON object, in the same manner as benchcat -j.
+//   --size WxH            The size of the terminal in cells. Defaults to 120x30.
+//   --chunk N             The number of bytes written into the terminal per frame. Defaults to 4096.
+//
+// The CPU time of a frame is the time it takes Renderer::PaintFrame() to return, including Present().
+// The GPU time is the time it then takes for the device to become idle. This is measured with an
+// event query and not with timestamp queries, because the latter aren't supported by every device
+// (most notably they're meaningless under WARP) and because it's what limits the throughput anyway.
+
+#include "pch.h"
+
+#include "../../cascadia/TerminalCore/Terminal.hpp"
+#include "../../renderer/atlas/AtlasEngine.h"
+#include "../../renderer/base/renderer.hpp"
+#include "../../inc/DefaultSettings.h"
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Terminal::Core;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        bool d3d = true;
+        bool d2d = true;
+        bool warp = false;
+        bool json = false;
+        til::size size{ 120, 30 };
+        size_t chunk = 4096;
+        std::vector<std::filesystem::path> files;
+    };
+
+    struct Capture
+    {
+        std::string name;
+        std::string data;
+    };
+
+    struct Percentiles
+    {
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    struct Result
+    {
+        Percentiles cpu;
+        Percentiles gpu;
+        size_t frames = 0;
+        Atlas::FrameStatistics stats;
+    };
+
+    // Returns the given percentiles in milliseconds. Sorts the samples in the process.
+    Percentiles computePercentiles(std::vector<clock::duration>& samples)
+    {
+        Percentiles p;
+        if (samples.empty())
+        {
+            return p;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        const auto at = [&](double fraction) {
+            const auto index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+            return std::chrono::duration<double, std::milli>(samples[index]).count();
+        };
+
+        p.p50 = at(0.50);
+        p.p90 = at(0.90);
+        p.p99 = at(0.99);
+        p.max = std::chrono::duration<double, std::milli>(samples.back()).count();
+        return p;
+    }
+
+    std::string readFile(const std::filesystem::path& path)
+    {
+        const wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        LARGE_INTEGER size;
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+        THROW_HR_IF(E_OUTOFMEMORY, size.QuadPart > INT32_MAX);
+
+        std::string data;
+        data.resize(gsl::narrow_cast<size_t>(size.QuadPart));
+
+        DWORD read = 0;
+        THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), data.data(), gsl::narrow_cast<DWORD>(data.size()), &read, nullptr));
+        data.resize(read);
+        return data;
+    }
+
+    // The swap chain needs a window, but it doesn't need to be visible.
+    wil::unique_hwnd createHiddenWindow()
+    {
+        static const auto atom = [] {
+            WNDCLASSEXW wc{};
+            wc.cbSize = sizeof(wc);
+            wc.lpfnWndProc = DefWindowProcW;
+            wc.hInstance = GetModuleHandleW(nullptr);
+            wc.lpszClassName = L"renderbench";
+            const auto atom = RegisterClassExW(&wc);
+            THROW_LAST_ERROR_IF(!atom);
+            return atom;
+        }();
+
+        wil::unique_hwnd hwnd{ CreateWindowExW(0, MAKEINTATOM(atom), L"renderbench", WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, nullptr, nullptr, GetModuleHandleW(nullptr), nullptr) };
+        THROW_LAST_ERROR_IF(!hwnd);
+        return hwnd;
+    }
+
+    Result run(const Options& options, const Capture& capture, bool d2d)
+    {
+        const auto hwnd = createHiddenWindow();
+
+        Terminal terminal;
+        Atlas::AtlasEngine engine;
+        // The render thread is never initialized, because we paint the frames ourselves.
+        Renderer renderer{ terminal.GetRenderSettings(), &terminal, nullptr, 0, std::make_unique<RenderThread>() };
+        renderer.AddRenderEngine(&engine);
+
+        THROW_IF_FAILED(engine.SetHwnd(hwnd.get()));
+        engine.SetSoftwareRendering(options.warp);
+        engine.SetForceD2DMode(d2d);
+        THROW_IF_FAILED(engine.UpdateDpi(USER_DEFAULT_SCREEN_DPI));
+
+        const FontInfoDesired fontInfoDesired{ DEFAULT_FONT_FACE, 0, DEFAULT_FONT_WEIGHT, static_cast<float>(DEFAULT_FONT_SIZE), CP_UTF8 };
+        FontInfo fontInfo{ DEFAULT_FONT_FACE, 0, DEFAULT_FONT_WEIGHT, { 0, DEFAULT_FONT_SIZE }, CP_UTF8, false };
+        THROW_IF_FAILED(engine.UpdateFont(fontInfoDesired, fontInfo));
+
+        const auto cellSize = fontInfo.GetSize();
+        THROW_IF_FAILED(engine.SetWindowSize({ options.size.width * cellSize.width, options.size.height * cellSize.height }));
+        THROW_IF_FAILED(engine.Enable());
+
+        terminal.Create(options.size, 9001, renderer);
+        terminal.SetFontInfo(fontInfo);
+
+        // The first frame creates the device, swap chain, glyph atlas, etc., which we don't want to measure.
+        THROW_IF_FAILED(renderer.PaintFrame());
+        engine.WaitUntilGpuIdle();
+
+        const auto statsBefore = engine.GetFrameStatistics();
+        std::vector<clock::duration> cpu;
+        std::vector<clock::duration> gpu;
+        til::u8state state;
+        std::wstring wide;
+
+        for (size_t offset = 0; offset < capture.data.size(); offset += options.chunk)
+        {
+            const auto chunk = std::string_view{ capture.data }.substr(offset, options.chunk);
+            THROW_IF_FAILED(til::u8u16(chunk, wide, state));
+
+            {
+                const auto lock = terminal.LockForWriting();
+                terminal.Write(wide);
+            }
+
+            // This is where the render thread would block on the swap chain's frame latency waitable object.
+            renderer.WaitUntilCanRender();
+
+            const auto beg = clock::now();
+            THROW_IF_FAILED(renderer.PaintFrame());
+            const auto mid = clock::now();
+            engine.WaitUntilGpuIdle();
+            const auto end = clock::now();
+
+            cpu.emplace_back(mid - beg);
+            gpu.emplace_back(end - mid);
+        }
+
+        const auto statsAfter = engine.GetFrameStatistics();
+        renderer.TriggerTeardown();
+
+        Result result;
+        result.frames = cpu.size();
+        result.cpu = computePercentiles(cpu);
+        result.gpu = computePercentiles(gpu);
+        result.stats.glyphAtlasMisses = statsAfter.glyphAtlasMisses - statsBefore.glyphAtlasMisses;
+        result.stats.bytesUploaded = statsAfter.bytesUploaded - statsBefore.bytesUploaded;
+        return result;
+    }
+
+    void report(const Options& options, const Capture& capture, std::string_view backend, const Result& r)
+    {
+        if (options.json)
+        {
+            fmt::print(FMT_COMPILE("{{\"capture\":\"{}\",\"backend\":\"{}\",\"warp\":{},\"frames\":{},"
+                                   "\"cpu_ms\":{{\"p50\":{:.3f},\"p90\":{:.3f},\"p99\":{:.3f},\"max\":{:.3f}}},"
+                                   "\"gpu_ms\":{{\"p50\":{:.3f},\"p90\":{:.3f},\"p99\":{:.3f},\"max\":{:.3f}}},"
+                                   "\"glyph_atlas_misses\":{},\"bytes_uploaded\":{}}}\n"),
+                       capture.name,
+                       backend,
+                       options.warp,
+                       r.frames,
+                       r.cpu.p50,
+                       r.cpu.p90,
+                       r.cpu.p99,
+                       r.cpu.max,
+                       r.gpu.p50,
+                       r.gpu.p90,
+                       r.gpu.p99,
+                       r.gpu.max,
+                       r.stats.glyphAtlasMisses,
+                       r.stats.bytesUploaded);
+        }
+        else
+        {
+            fmt::print(FMT_COMPILE("{} ({}{}): {} frames\n"
+                                   "  cpu: p50 {:.3f}ms, p90 {:.3f}ms, p99 {:.3f}ms, max {:.3f}ms\n"
+                                   "  gpu: p50 {:.3f}ms, p90 {:.3f}ms, p99 {:.3f}ms, max {:.3f}ms\n"
+                                   "  glyph atlas misses: {}, bytes uploaded: {}\n"),
+                       capture.name,
+                       backend,
+                       options.warp ? ", WARP" : "",
+                       r.frames,
+                       r.cpu.p50,
+                       r.cpu.p90,
+                       r.cpu.p99,
+                       r.cpu.max,
+                       r.gpu.p50,
+                       r.gpu.p90,
+                       r.gpu.p99,
+                       r.gpu.max,
+                       r.stats.glyphAtlasMisses,
+                       r.stats.bytesUploaded);
+        }
+    }
+
+    bool parseArguments(int argc, wchar_t* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::wstring_view arg{ argv[i] };
+            const auto hasValue = i + 1 < argc;
+
+            if (arg == L"--d3d")
+            {
+                options.d3d = true;
+                options.d2d = false;
+            }
+            else if (arg == L"--d2d")
+            {
+                options.d3d = false;
+                options.d2d = true;
+            }
+            else if (arg == L"--both")
+            {
+                options.d3d = true;
+                options.d2d = true;
+            }
+            else if (arg == L"--warp")
+            {
+                options.warp = true;
+            }
+            else if (arg == L"--json")
+            {
+                options.json = true;
+            }
+            else if (arg == L"--size" && hasValue)
+            {
+                int width = 0;
+                int height = 0;
+                if (swscanf_s(argv[++i], L"%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+                {
+                    return false;
+                }
+                options.size = { width, height };
+            }
+            else if (arg == L"--chunk" && hasValue)
+            {
+                options.chunk = wcstoul(argv[++i], nullptr, 10);
+                if (!options.chunk)
+                {
+                    return false;
+                }
+            }
+            else if (arg.starts_with(L"--"))
+            {
+                return false;
+            }
+            else
+            {
+                options.files.emplace_back(arg);
+            }
+        }
+
+        return !options.files.empty();
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        fmt::print(stderr, FMT_COMPILE("usage: renderbench [--d3d|--d2d|--both] [--warp] [--json] [--size WxH] [--chunk N] <file>...\n"));
+        return 1;
+    }
+
+    for (const auto& path : options.files)
+    {
+        const Capture capture{ til::u16u8(path.filename().native()), readFile(path) };
+
+        if (options.d3d)
+        {
+            report(options, capture, "d3d", run(options, capture, false));
+        }
+        if (options.d2d)
+        {
+            report(options, capture, "d2d", run(options, capture, true));
+        }
+    }
+
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return 1;
+}
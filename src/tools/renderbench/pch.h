@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#define NOMINMAX
+
+#define BLOCK_TIL
+// This includes support libraries from the CRT, STL, WIL, and GSL
+#include <LibraryIncludes.h>
+// cppwinrt conflicts with the SDK definition of this function, so the only fix is to undef it.
+#ifdef GetCurrentTime
+#undef GetCurrentTime
+#endif
+
+#include <wil/cppwinrt.h>
+#include <unknwn.h>
+#include <hstring.h>
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+
+#include <winrt/Microsoft.Terminal.Core.h>
+
+// Manually include til after we include Windows.Foundation to give it winrt superpowers
+#include <til.h>
+
+#include <d2d1_3.h>
+#include <d3d11_2.h>
+#include <dwrite_3.h>
+#include <dxgi1_3.h>
+
+#include <cppwinrt_utils.h>
@@ -0,0 +1,231 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Replays session recordings made with the "experimental.sessionRecordingDirectory" setting
+// into the terminal this tool is running in, either with the original timing or as fast as possible.
+// Run it under `wpr -start src\Terminal.wprp!Terminal` to get the replay markers logged by this
+// tool next to the events of the terminal's own providers.
+//
+// Usage: vtreplay [--max] [--speed N] [--no-resize] <file>
+//   --max        Write the output as fast as possible, ignoring the recorded timing.
+//   --speed N    Replay N times faster than the recording. Defaults to 1.
+//   --no-resize  Ignore resize records. Otherwise they're replayed as XTWINOPS CSI 8 ; rows ; columns t,
+//                which not every terminal supports, so it's best to size the window to match beforehand.
+//
+// Input records aren't replayed, as the input went to the application, not the terminal.
+
+#include "precomp.h"
+
+#include "../../inc/VtRecording.h"
+
+using namespace Microsoft::Console::VtRecording;
+
+// {19032b09-4570-5020-fe1a-ff2833b2bb15}
+TRACELOGGING_DEFINE_PROVIDER(g_hVtReplayProvider,
+                             "Microsoft.Windows.Terminal.VtReplay",
+                             (0x19032b09, 0x4570, 0x5020, 0xfe, 0x1a, 0xff, 0x28, 0x33, 0xb2, 0xbb, 0x15));
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        bool maxSpeed = false;
+        bool resize = true;
+        double speed = 1.0;
+        std::filesystem::path file;
+    };
+
+    struct Record
+    {
+        RecordHeader header;
+        std::string_view payload;
+    };
+
+    std::string readFile(const std::filesystem::path& path)
+    {
+        const wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        LARGE_INTEGER size;
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+        THROW_HR_IF(E_OUTOFMEMORY, size.QuadPart > INT32_MAX);
+
+        std::string data;
+        data.resize(gsl::narrow_cast<size_t>(size.QuadPart));
+
+        DWORD read = 0;
+        THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), data.data(), gsl::narrow_cast<DWORD>(data.size()), &read, nullptr));
+        data.resize(read);
+        return data;
+    }
+
+    // Splits the recording into its records. A truncated last record, as left behind
+    // by a terminal that didn't exit cleanly, is silently dropped.
+    std::vector<Record> parseRecording(const std::string_view data)
+    {
+        FileHeader fileHeader;
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), data.size() < sizeof(fileHeader));
+        memcpy(&fileHeader, data.data(), sizeof(fileHeader));
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), fileHeader.magic != Magic);
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), fileHeader.version != Version);
+
+        std::vector<Record> records;
+        for (auto offset = sizeof(fileHeader); data.size() - offset >= sizeof(RecordHeader);)
+        {
+            Record record;
+            memcpy(&record.header, data.data() + offset, sizeof(RecordHeader));
+            offset += sizeof(RecordHeader);
+
+            if (data.size() - offset < record.header.size)
+            {
+                break;
+            }
+
+            record.payload = data.substr(offset, record.header.size);
+            offset += record.header.size;
+            records.emplace_back(record);
+        }
+
+        return records;
+    }
+
+    void write(HANDLE output, const std::string_view text)
+    {
+        DWORD written = 0;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(output, text.data(), gsl::narrow_cast<DWORD>(text.size()), &written, nullptr));
+    }
+
+    bool parseArguments(int argc, wchar_t* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::wstring_view arg{ argv[i] };
+
+            if (arg == L"--max")
+            {
+                options.maxSpeed = true;
+            }
+            else if (arg == L"--speed" && i + 1 < argc)
+            {
+                options.speed = wcstod(argv[++i], nullptr);
+                if (!(options.speed > 0))
+                {
+                    return false;
+                }
+            }
+            else if (arg == L"--no-resize")
+            {
+                options.resize = false;
+            }
+            else if (arg.starts_with(L"--") || !options.file.empty())
+            {
+                return false;
+            }
+            else
+            {
+                options.file = arg;
+            }
+        }
+
+        return !options.file.empty();
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        fmt::print(stderr, FMT_COMPILE("usage: vtreplay [--max] [--speed N] [--no-resize] <file>\n"));
+        return 1;
+    }
+
+    const auto data = readFile(options.file);
+    const auto records = parseRecording(data);
+
+    TraceLoggingRegister(g_hVtReplayProvider);
+    const auto unregister = wil::scope_exit([] { TraceLoggingUnregister(g_hVtReplayProvider); });
+
+    const auto output = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD originalMode = 0;
+    const auto isConsole = GetConsoleMode(output, &originalMode) != 0;
+    const auto originalCP = GetConsoleOutputCP();
+    if (isConsole)
+    {
+        SetConsoleMode(output, originalMode | ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+        SetConsoleOutputCP(CP_UTF8);
+    }
+    const auto restore = wil::scope_exit([&] {
+        if (isConsole)
+        {
+            SetConsoleMode(output, originalMode);
+            SetConsoleOutputCP(originalCP);
+        }
+    });
+
+    TraceLoggingWrite(g_hVtReplayProvider,
+                      "ReplayStarted",
+                      TraceLoggingWideString(options.file.c_str(), "file"),
+                      TraceLoggingUInt64(records.size(), "records"),
+                      TraceLoggingBool(options.maxSpeed, "maxSpeed"),
+                      TraceLoggingFloat64(options.speed, "speed"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_INFO));
+
+    uint64_t bytes = 0;
+    std::string resizeSequence;
+    const auto start = clock::now();
+
+    for (const auto& record : records)
+    {
+        if (!options.maxSpeed)
+        {
+            const std::chrono::duration<double, std::micro> due{ record.header.timestamp / options.speed };
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<clock::duration>(due));
+        }
+
+        TraceLoggingWrite(g_hVtReplayProvider,
+                          "ReplayRecord",
+                          TraceLoggingUInt8(static_cast<uint8_t>(record.header.type), "type"),
+                          TraceLoggingUInt64(record.header.timestamp, "timestamp"),
+                          TraceLoggingUInt32(record.header.size, "size"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+
+        switch (record.header.type)
+        {
+        case RecordType::Output:
+            write(output, record.payload);
+            bytes += record.payload.size();
+            break;
+        case RecordType::Resize:
+            if (options.resize && record.payload.size() == sizeof(ResizePayload))
+            {
+                ResizePayload resize;
+                memcpy(&resize, record.payload.data(), sizeof(resize));
+                resizeSequence = fmt::format(FMT_COMPILE("\x1b[8;{};{}t"), resize.rows, resize.columns);
+                write(output, resizeSequence);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+    TraceLoggingWrite(g_hVtReplayProvider,
+                      "ReplayFinished",
+                      TraceLoggingUInt64(bytes, "bytes"),
+                      TraceLoggingFloat64(elapsed, "seconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_INFO));
+
+    fmt::print(stderr, FMT_COMPILE("\r\n{} records, {} bytes in {:.3f}s ({:.1f} MB/s)\r\n"), records.size(), bytes, elapsed, elapsed > 0 ? bytes / elapsed / 1e6 : 0.0);
+    return 0;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return 1;
+}
@@ -0,0 +1,8 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <LibraryIncludes.h>
+
+#include <TraceLoggingProvider.h>
@@ -325,6 +325,102 @@ namespace
     };
 }
 
+// Builds the BMP lookup table out of s_wideAndAmbiguousTable.
+CodepointWidthDetector::CodepointWidthDetector() noexcept
+{
+    auto range = s_wideAndAmbiguousTable.begin();
+    const auto rangeEnd = s_wideAndAmbiguousTable.end();
+    size_t blockCount = 0;
+
+    for (size_t hi = 0; hi < _bmpBlockIndices.size(); ++hi)
+    {
+        std::array<uint8_t, 64> block{};
+
+        for (size_t lo = 0; lo < 256; ++lo)
+        {
+            const auto codepoint = gsl::narrow_cast<char32_t>(hi << 8 | lo);
+
+            // The table is sorted and codepoints are visited in ascending order.
+            while (range != rangeEnd && range->upperBound < codepoint)
+            {
+                ++range;
+            }
+
+            uint8_t width = 1;
+            if (range != rangeEnd && codepoint >= range->lowerBound)
+            {
+                width = range->isAmbiguous ? 3 : 2;
+            }
+
+            til::at(block, lo / 4) |= gsl::narrow_cast<uint8_t>(width << (lo % 4 * 2));
+        }
+
+        const auto blocksEnd = _bmpBlocks.begin() + blockCount;
+        const auto it = std::find(_bmpBlocks.begin(), blocksEnd, block);
+        if (it != blocksEnd)
+        {
+            til::at(_bmpBlockIndices, hi) = gsl::narrow_cast<uint8_t>(it - _bmpBlocks.begin());
+        }
+        else if (blockCount < _bmpBlockCapacity)
+        {
+            // If s_wideAndAmbiguousTable ever grows to the point where we run out of blocks,
+            // the remaining codepoints will be looked up in s_wideAndAmbiguousTable directly.
+            til::at(_bmpBlocks, blockCount) = block;
+            til::at(_bmpBlockIndices, hi) = gsl::narrow_cast<uint8_t>(blockCount);
+            blockCount++;
+        }
+        else
+        {
+            til::at(_bmpBlockIndices, hi) = _bmpNoBlock;
+        }
+    }
+}
+
+// Routine Description:
+// - Returns the number of characters at the start of the text that are ASCII.
+//   Those don't need to be measured, because they're always 1 column wide.
+// Arguments:
+// - text - the utf16 encoded text to check
+// Return Value:
+// - the length of the ASCII prefix of text
+size_t CodepointWidthDetector::CountLeadingAscii(const std::wstring_view& text) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+    const auto beg = text.data();
+    const auto end = beg + text.size();
+    auto it = beg;
+
+#if defined(TIL_SSE_INTRINSICS)
+    // A character is ASCII if none of its bits above the lowest 7 are set.
+    const auto nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xff80));
+    const auto zero = _mm_setzero_si128();
+
+    for (; end - it >= 8; it += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        // Each of the 8 characters results in 2 bits in the mask, which are set if it's not ASCII.
+        const auto mask = ~_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, nonAsciiBits), zero)) & 0xffff;
+        if (mask)
+        {
+            unsigned long offset;
+            _BitScanForward(&offset, mask);
+            return gsl::narrow_cast<size_t>(it - beg) + offset / 2;
+        }
+    }
+#endif
+
+    for (; it != end && *it < 0x80; ++it)
+    {
+    }
+
+    return gsl::narrow_cast<size_t>(it - beg);
+
+#pragma warning(pop)
+}
+
 // Routine Description:
 // - returns the width type of codepoint as fast as we can by using quick lookup table and fallback cache.
 // Arguments:
@@ -377,6 +473,16 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view& glyph) noexcept
 // GetWidth's slow-path for non-ASCII characters. Returns the number of columns the codepoint takes up in the terminal.
 uint8_t CodepointWidthDetector::_lookupGlyphWidth(const char32_t codepoint, const std::wstring_view& glyph) noexcept
 {
+    if (codepoint <= 0xffff)
+    {
+        if (const auto index = til::at(_bmpBlockIndices, codepoint >> 8); index != _bmpNoBlock)
+        {
+            const auto lo = codepoint & 0xff;
+            const auto width = gsl::narrow_cast<uint8_t>((til::at(til::at(_bmpBlocks, index), lo / 4) >> (lo % 4 * 2)) & 3);
+            return width == 3 ? _checkFallbackViaCache(codepoint, glyph) : width;
+        }
+    }
+
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'lower_bound<...>()' which may throw exceptions (f.6).
     const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
     uint8_t width = 1;
@@ -25,6 +25,14 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return wch < 0x80 ? false : IsGlyphFullWidth({ &wch, 1 });
 }
 
+// Function Description:
+// - returns the number of characters at the start of the text which are ASCII
+//      and thus always narrow. See CodepointWidthDetector::CountLeadingAscii
+size_t CountLeadingAscii(const std::wstring_view& text) noexcept
+{
+    return CodepointWidthDetector::CountLeadingAscii(text);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
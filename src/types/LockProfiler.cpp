@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/LockProfiler.hpp"
+
+using namespace Microsoft::Console::Types;
+
+bool EtwLockProfiler::enabled() const noexcept
+{
+    return TraceLoggingProviderEnabled(_provider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_LOCKS);
+}
+
+void EtwLockProfiler::acquired(const sample& sample) noexcept
+{
+    TraceLoggingWrite(
+        _provider,
+        "LockHeld",
+        TraceLoggingOpcode(WINEVENT_OPCODE_START),
+        TraceLoggingString(_name, "Lock"),
+        TraceLoggingString(sample.site.function_name(), "Function"),
+        TraceLoggingString(sample.site.file_name(), "File"),
+        TraceLoggingUInt32(sample.site.line(), "Line"),
+        TraceLoggingUInt64(sample.wait_us, "WaitUs"),
+        TraceLoggingUInt32(sample.waiters, "Waiters"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_LOCKS));
+}
+
+void EtwLockProfiler::released(const sample& sample) noexcept
+{
+    TraceLoggingWrite(
+        _provider,
+        "LockHeld",
+        TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+        TraceLoggingString(_name, "Lock"),
+        TraceLoggingString(sample.site.function_name(), "Function"),
+        TraceLoggingUInt64(sample.wait_us, "WaitUs"),
+        TraceLoggingUInt64(sample.hold_us, "HoldUs"),
+        TraceLoggingUInt32(sample.waiters, "Waiters"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_LOCKS));
+
+    if ((_releases.fetch_add(1, std::memory_order_relaxed) + 1) % HistogramInterval == 0)
+    {
+        // Bucket i counts the durations in [2^(i-1), 2^i) microseconds. See til::lock_profiler.
+        const auto wait = wait_histogram();
+        const auto hold = hold_histogram();
+
+        TraceLoggingWrite(
+            _provider,
+            "LockHistogram",
+            TraceLoggingString(_name, "Lock"),
+            TraceLoggingUInt64Array(wait.data(), gsl::narrow_cast<UINT16>(wait.size()), "WaitUs"),
+            TraceLoggingUInt64Array(hold.data(), gsl::narrow_cast<UINT16>(hold.size()), "HoldUs"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+            TraceLoggingKeyword(TIL_KEYWORD_LOCKS));
+    }
+}
@@ -608,31 +608,24 @@ try
     RETURN_HR_IF(E_FAIL, !_pData->IsUiaDataInitialized());
 
     const std::wstring_view queryText{ text, SysStringLen(text) };
-    auto exclusiveBegin = _start;
-
-    // MovePastPoint() moves *past* the given point.
-    // -> We need to turn [_beg,_end) into (_beg,_end).
-    exclusiveBegin.x--;
-
-    _searcher.ResetIfStale(*_pData, queryText, searchBackward, ignoreCase);
-    _searcher.MovePastPoint(searchBackward ? _end : exclusiveBegin);
+    if (queryText.empty() || IsDegenerate())
+    {
+        return S_OK;
+    }
 
-    til::point hitBeg{ til::CoordTypeMax, til::CoordTypeMax };
-    til::point hitEnd{ til::CoordTypeMin, til::CoordTypeMin };
+    const auto& buffer = _pData->GetTextBuffer();
+    const auto bufferSize = buffer.GetSize();
+    const auto hit = searchBackward ? _findTextBackward(buffer, queryText, ignoreCase) : _findTextForward(buffer, queryText, ignoreCase);
 
-    if (const auto hit = _searcher.GetCurrent())
+    if (hit)
     {
-        hitBeg = hit->start;
-        hitEnd = hit->end;
+        auto hitEnd = hit->end;
         // we need to increment the position of end because it's exclusive
-        _pData->GetTextBuffer().GetSize().IncrementInBounds(hitEnd, true);
-    }
+        bufferSize.IncrementInBounds(hitEnd, true);
 
-    if (hitBeg >= _start && hitEnd <= _end)
-    {
         RETURN_IF_FAILED(Clone(ppRetVal));
         auto& range = static_cast<UiaTextRangeBase&>(**ppRetVal);
-        range._start = hitBeg;
+        range._start = hit->start;
         range._end = hitEnd;
         UiaTracing::TextRange::FindText(*this, queryText, searchBackward, ignoreCase, range);
     }
@@ -641,6 +634,72 @@ try
 }
 CATCH_RETURN();
 
+// Checks whether the given search hit (with an inclusive end) lies within this range.
+bool UiaTextRangeBase::_containsHit(const TextBuffer& buffer, const til::point_span& hit) const
+{
+    auto hitEnd = hit.end;
+    buffer.GetSize().IncrementInBounds(hitEnd, true);
+    return hit.start >= _start && hitEnd <= _end;
+}
+
+// Finds the first occurrence of needle within this range.
+// Instead of searching the entire range at once, the rows are searched in chunks and the search stops
+// at the first chunk with a hit. Since matches may span multiple rows, each chunk is extended by up to
+// needle.size() rows (every row holds at least one character) but only hits beginning in it are accepted.
+std::optional<til::point_span> UiaTextRangeBase::_findTextForward(const TextBuffer& buffer, const std::wstring_view& needle, bool caseInsensitive) const
+{
+    const auto overlap = gsl::narrow_cast<til::CoordType>(std::min<size_t>(needle.size(), til::CoordTypeMax / 2));
+    const auto rowEnd = _end.y + 1;
+    auto start = _start;
+
+    while (start.y < rowEnd)
+    {
+        const auto chunkEnd = std::min(rowEnd, start.y + _findTextChunkRows);
+        const auto hits = buffer.SearchText(needle, caseInsensitive, start, std::min(rowEnd, chunkEnd + overlap));
+
+        for (const auto& hit : hits)
+        {
+            if (hit.start.y >= chunkEnd)
+            {
+                break;
+            }
+            // Hits are sorted, so if the first one doesn't fit, none of the following ones do either.
+            return _containsHit(buffer, hit) ? std::optional{ hit } : std::nullopt;
+        }
+
+        start = { 0, chunkEnd };
+    }
+
+    return std::nullopt;
+}
+
+// Finds the last occurrence of needle within this range, searching in chunks from the end of the range.
+// See _findTextForward for how matches that span chunks are handled.
+std::optional<til::point_span> UiaTextRangeBase::_findTextBackward(const TextBuffer& buffer, const std::wstring_view& needle, bool caseInsensitive) const
+{
+    const auto overlap = gsl::narrow_cast<til::CoordType>(std::min<size_t>(needle.size(), til::CoordTypeMax / 2));
+    auto chunkEnd = _end.y + 1;
+
+    while (chunkEnd > _start.y)
+    {
+        const auto chunkBeg = std::max(_start.y, chunkEnd - _findTextChunkRows);
+        const auto searchBeg = chunkBeg - overlap > _start.y ? til::point{ 0, chunkBeg - overlap } : _start;
+        const auto hits = buffer.SearchText(needle, caseInsensitive, searchBeg, chunkEnd);
+
+        for (auto it = hits.rbegin(); it != hits.rend() && it->start.y >= chunkBeg; ++it)
+        {
+            if (_containsHit(buffer, *it))
+            {
+                return *it;
+            }
+        }
+
+        chunkEnd = chunkBeg;
+    }
+
+    return std::nullopt;
+}
+
 // Method Description:
 // - (1) Checks the current range for the attributeId's sub-type
 // - (2) Record the attributeId's sub-type
@@ -967,7 +1026,25 @@ std::wstring UiaTextRangeBase::_getTextValue(til::CoordType maxLength) const
         bufferSize.DecrementInBounds(inclusiveEnd, true);
 
         // reserve size in accordance to extracted text
-        const auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true);
+        auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true);
+
+        // Screen readers commonly ask for just a few characters of a potentially huge range.
+        // Every column yields at least half a character (wide glyphs), which allows us
+        // to cut off the rows we definitely won't need before extracting any text.
+        if (maxLength >= 0)
+        {
+            size_t minimumLength = 0;
+            for (auto it = textRects.begin(); it != textRects.end(); ++it)
+            {
+                if (minimumLength >= maxLengthAsSize)
+                {
+                    textRects.erase(it, textRects.end());
+                    break;
+                }
+                minimumLength += gsl::narrow_cast<size_t>(it->right - it->left + 1) / 2;
+            }
+        }
+
         const auto bufferData = buffer.GetText(true,
                                                false,
                                                textRects);
@@ -1408,22 +1485,52 @@ void UiaTextRangeBase::_moveEndpointByUnitCharacter(_In_ const int moveCount,
     const auto documentEnd{ _getDocumentEnd() };
     while (std::abs(*pAmountMoved) < std::abs(moveCount) && success)
     {
+        // Moving within a row doesn't need the generic buffer navigation, which has
+        // to construct a cell iterator for every single step. We walk the row's
+        // glyphs directly and only defer to the buffer when crossing a row boundary
+        // or getting close to the document end.
+        const auto& row = buffer.GetRowByOffset(target.y);
+
         switch (moveDirection)
         {
         case MovementDirection::Forward:
-            success = buffer.MoveToNextGlyph(target, allowBottomExclusive, documentEnd);
+        {
+            const auto next = row.NavigateToNext(target.x);
+            if (next < row.size() && til::point{ next, target.y } < documentEnd)
+            {
+                target.x = next;
+            }
+            else
+            {
+                success = buffer.MoveToNextGlyph(target, allowBottomExclusive, documentEnd);
+            }
             if (success)
             {
                 (*pAmountMoved)++;
             }
             break;
+        }
         case MovementDirection::Backward:
-            success = buffer.MoveToPreviousGlyph(target, documentEnd);
+        {
+            auto previous = target.x - 1;
+            if (previous >= 0 && row.DbcsAttrAt(previous) == DbcsAttribute::Leading)
+            {
+                previous--;
+            }
+            if (previous >= 0 && target <= documentEnd)
+            {
+                target.x = previous;
+            }
+            else
+            {
+                success = buffer.MoveToPreviousGlyph(target, documentEnd);
+            }
             if (success)
             {
                 (*pAmountMoved)--;
             }
             break;
+        }
         default:
             break;
         }
@@ -22,7 +22,6 @@ Author(s):
 
 #include "IUiaTraceable.h"
 #include "unicode.hpp"
-#include "../buffer/out/search.h"
 
 #ifdef UNIT_TESTING
 class UiaTextRangeTests;
@@ -121,7 +120,6 @@ namespace Microsoft::Console::Types
         IRawElementProviderSimple* _pProvider{ nullptr };
 
         std::wstring _wordDelimiters{};
-        ::Search _searcher;
 
         virtual void _TranslatePointToScreen(til::point* clientPoint) const = 0;
         virtual void _TranslatePointFromScreen(til::point* screenPoint) const = 0;
@@ -180,6 +178,13 @@ namespace Microsoft::Console::Types
         bool _initializeAttrQuery(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal, const TextAttribute& attr) const;
         bool _tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, til::point& resultingPos) const;
 
+        // FindText() searches this many rows at a time, so that it doesn't need to
+        // find every single occurrence in a huge range just to return the first one.
+        static constexpr til::CoordType _findTextChunkRows{ 128 };
+        bool _containsHit(const TextBuffer& buffer, const til::point_span& hit) const;
+        std::optional<til::point_span> _findTextForward(const TextBuffer& buffer, const std::wstring_view& needle, bool caseInsensitive) const;
+        std::optional<til::point_span> _findTextBackward(const TextBuffer& buffer, const std::wstring_view& needle, bool caseInsensitive) const;
+
         til::point _getInclusiveEnd() const noexcept;
 
 #ifdef UNIT_TESTING
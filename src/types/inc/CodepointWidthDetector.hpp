@@ -19,6 +19,9 @@ Author:
 class CodepointWidthDetector final
 {
 public:
+    CodepointWidthDetector() noexcept;
+
+    static size_t CountLeadingAscii(const std::wstring_view& text) noexcept;
     CodepointWidth GetWidth(const std::wstring_view& glyph) noexcept;
     bool IsWide(const std::wstring_view& glyph) noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
@@ -32,6 +35,15 @@ private:
     uint8_t _lookupGlyphWidth(char32_t codepoint, const std::wstring_view& glyph) noexcept;
     uint8_t _checkFallbackViaCache(char32_t codepoint, const std::wstring_view& glyph) noexcept;
 
+    // A two-level lookup table for the BMP, which contains almost all codepoints in practice. _bmpBlockIndices
+    // maps the upper 8 bits of a codepoint to one of the _bmpBlocks, which store 2 bits for each of the 256
+    // codepoints with those upper bits: 1 for narrow, 2 for wide and 3 for ambiguous. Most blocks are
+    // identical (for instance all narrow or all wide) and so there are only a few dozen distinct ones.
+    static constexpr uint8_t _bmpNoBlock = 0xff;
+    static constexpr size_t _bmpBlockCapacity = 64;
+    std::array<uint8_t, 256> _bmpBlockIndices{};
+    std::array<std::array<uint8_t, 64>, _bmpBlockCapacity> _bmpBlocks{};
+
     std::unordered_map<char32_t, uint8_t> _fallbackCache;
     std::function<bool(const std::wstring_view&)> _pfnFallbackMethod;
 };
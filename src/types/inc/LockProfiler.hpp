@@ -0,0 +1,43 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LockProfiler.hpp
+
+Abstract:
+- A til::lock_profiler that reports lock acquisitions via ETW, if the given provider is
+  enabled with TIL_KEYWORD_LOCKS. Each outermost lock()/unlock() pair is reported as a
+  start/stop pair of "LockHeld" events, which ConsolePerf.regions.xml turns into regions.
+  Every HistogramInterval releases, a "LockHistogram" event with the wait and hold time
+  histograms is logged as well.
+--*/
+
+#pragma once
+
+#include <TraceLoggingProvider.h>
+#include <til/ticket_lock.h>
+
+namespace Microsoft::Console::Types
+{
+    class EtwLockProfiler final : public til::lock_profiler
+    {
+    public:
+        static constexpr uint64_t HistogramInterval = 4096;
+
+        EtwLockProfiler(TraceLoggingHProvider provider, const char* name) noexcept :
+            _provider{ provider },
+            _name{ name }
+        {
+        }
+
+        bool enabled() const noexcept override;
+        void acquired(const sample& sample) noexcept override;
+        void released(const sample& sample) noexcept override;
+
+    private:
+        TraceLoggingHProvider _provider;
+        const char* _name;
+        std::atomic<uint64_t> _releases{ 0 };
+    };
+}
@@ -16,6 +16,7 @@
 #else
 #include "device.h"
 #include <filesystem>
+#include "../inc/VtSharedMemory.h"
 #endif // __INSIDE_WINDOWS
 
 #pragma warning(push)
@@ -93,10 +94,57 @@ static bool _HandleIsValid(HANDLE h) noexcept
     return (h != INVALID_HANDLE_VALUE) && (h != nullptr);
 }
 
+#ifndef __INSIDE_WINDOWS
+// Function Description:
+// - Returns true if the console host is the OpenConsole that ships alongside this module.
+//   Only that one is guaranteed to understand --sharedMemory; conhost might be older than us.
+static bool _ConsoleHostSupportsSharedMemory()
+{
+    static const auto supported = _wcsicmp(_ConsoleHostPath(), _InboxConsoleHostPath().get()) != 0;
+    return supported;
+}
+
+// Function Description:
+// - Duplicates a VtSharedMemory section and its events as inheritable handles for the console
+//   host and stores the duplicates' values in the section's header, because that's where
+//   the console host will look for them (see VtSharedMemory.h).
+// Arguments:
+// - hSharedMemory: The section created by the caller of ConptyCreatePseudoConsoleWithSharedMemory().
+// - handles: Receives the section, followed by the 4 events.
+// Return Value:
+// - S_OK if the handles were duplicated, otherwise an appropriate HRESULT.
+static HRESULT _DuplicateSharedMemoryHandles(const HANDLE hSharedMemory, wil::unique_handle (&handles)[5]) noexcept
+{
+    using namespace Microsoft::Console::VtSharedMemory;
+
+    wil::unique_mapview_ptr<Header> header{ static_cast<Header*>(MapViewOfFile(hSharedMemory, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(Header))) };
+    RETURN_LAST_ERROR_IF(!header);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), header->magic != Magic || header->version != Version);
+
+    RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), hSharedMemory, GetCurrentProcess(), handles[0].addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
+
+    uint64_t* const events[]{
+        &header->output.writtenEvent,
+        &header->output.drainedEvent,
+        &header->input.writtenEvent,
+        &header->input.drainedEvent,
+    };
+    for (size_t i = 0; i < ARRAYSIZE(events); ++i)
+    {
+        const auto event = reinterpret_cast<HANDLE>(static_cast<uintptr_t>(*events[i]));
+        RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), event, GetCurrentProcess(), handles[i + 1].addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
+        *events[i] = reinterpret_cast<uintptr_t>(handles[i + 1].get());
+    }
+
+    return S_OK;
+}
+#endif // __INSIDE_WINDOWS
+
 HRESULT _CreatePseudoConsole(const HANDLE hToken,
                              const COORD size,
                              const HANDLE hInput,
                              const HANDLE hOutput,
+                             const HANDLE hSharedMemory,
                              const DWORD dwFlags,
                              _Inout_ PseudoConsole* pPty)
 {
@@ -132,6 +180,20 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(signalPipeConhostSide.addressof(), signalPipeOurSide.addressof(), &sa, 0));
     RETURN_IF_WIN32_BOOL_FALSE(SetHandleInformation(signalPipeConhostSide.get(), HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT));
 
+    // If the caller asked for it and the console host supports it, it receives
+    // the shared memory section and its events in addition to the pipes.
+    wil::unique_handle sharedMemoryHandles[5];
+    auto useSharedMemory = false;
+#ifndef __INSIDE_WINDOWS
+    if (_HandleIsValid(hSharedMemory) && _ConsoleHostSupportsSharedMemory())
+    {
+        RETURN_IF_FAILED(_DuplicateSharedMemoryHandles(hSharedMemory, sharedMemoryHandles));
+        useSharedMemory = true;
+    }
+#else
+    UNREFERENCED_PARAMETER(hSharedMemory);
+#endif
+
     // GH4061: Ensure that the path to executable in the format is escaped so C:\Program.exe cannot collide with C:\Program Files
     auto pwszFormat = L"\"%s\" --headless %s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
     // This is plenty of space to hold the formatted string
@@ -150,6 +212,11 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
                size.Y,
                signalPipeConhostSide.get(),
                serverHandle.get());
+    if (useSharedMemory)
+    {
+        const auto length = wcslen(cmd);
+        swprintf_s(cmd + length, MAX_PATH - length, L" --sharedMemory 0x%x", sharedMemoryHandles[0].get());
+    }
 
     STARTUPINFOEXW siEx{ 0 };
     siEx.StartupInfo.cb = sizeof(STARTUPINFOEXW);
@@ -159,12 +226,19 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     siEx.StartupInfo.dwFlags |= STARTF_USESTDHANDLES;
 
     // Only pass the handles we actually want the conhost to know about to it:
-    const size_t INHERITED_HANDLES_COUNT = 4;
-    HANDLE inheritedHandles[INHERITED_HANDLES_COUNT];
-    inheritedHandles[0] = serverHandle.get();
-    inheritedHandles[1] = hInput;
-    inheritedHandles[2] = hOutput;
-    inheritedHandles[3] = signalPipeConhostSide.get();
+    HANDLE inheritedHandles[4 + ARRAYSIZE(sharedMemoryHandles)];
+    size_t inheritedHandlesCount = 0;
+    inheritedHandles[inheritedHandlesCount++] = serverHandle.get();
+    inheritedHandles[inheritedHandlesCount++] = hInput;
+    inheritedHandles[inheritedHandlesCount++] = hOutput;
+    inheritedHandles[inheritedHandlesCount++] = signalPipeConhostSide.get();
+    if (useSharedMemory)
+    {
+        for (const auto& handle : sharedMemoryHandles)
+        {
+            inheritedHandles[inheritedHandlesCount++] = handle.get();
+        }
+    }
 
     // Get the size of the attribute list. We need one attribute, the handle list.
     SIZE_T listSize = 0;
@@ -187,7 +261,7 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
                                                          0,
                                                          PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
                                                          inheritedHandles,
-                                                         (INHERITED_HANDLES_COUNT * sizeof(HANDLE)),
+                                                         (inheritedHandlesCount * sizeof(HANDLE)),
                                                          nullptr,
                                                          nullptr));
     wil::unique_process_information pi;
@@ -236,7 +310,8 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     pPty->hPtyReference = referenceHandle.release();
     pPty->hConPtyProcess = std::exchange(pi.hProcess, nullptr);
 
-    return S_OK;
+    // S_FALSE tells the caller that it asked for shared memory but has to use the pipes.
+    return _HandleIsValid(hSharedMemory) && !useSharedMemory ? S_FALSE : S_OK;
 }
 
 // Function Description:
@@ -284,6 +359,38 @@ HRESULT _ClearPseudoConsole(_In_ const PseudoConsole* const pPty)
     return fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
 }
 
+// Function Description:
+// - Sends a Ctrl+C to the conpty via the signal pipe, so that it doesn't
+//   have to queue up behind any other input that's still in the input pipe.
+// - An inbox conhost that we fell back to doesn't know this signal and would
+//   treat it as a fatal error. In that case we return E_NOTIMPL and the caller
+//   is expected to write the Ctrl+C into the input pipe instead.
+// Arguments:
+// - hSignal: A signal pipe as returned by CreateConPty.
+// Return Value:
+// - S_OK if the call succeeded, E_NOTIMPL if the conpty doesn't support it,
+//      else an appropriate HRESULT for failing to write the message to the pty.
+HRESULT _InterruptPseudoConsole(_In_ const PseudoConsole* const pPty)
+{
+    if (pPty == nullptr)
+    {
+        return E_INVALIDARG;
+    }
+
+#if !defined(__INSIDE_WINDOWS)
+    if (_wcsicmp(_ConsoleHostPath(), _InboxConsoleHostPath().get()) == 0)
+    {
+        return E_NOTIMPL;
+    }
+#endif
+
+    unsigned short signalPacket[1];
+    signalPacket[0] = PTY_SIGNAL_INTERRUPT;
+
+    const auto fSuccess = WriteFile(pPty->hSignal, signalPacket, sizeof(signalPacket), nullptr, nullptr);
+    return fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+}
+
 // Function Description:
 // - Shows or hides the internal HWND used by ConPTY. This should be kept in
 //   sync with the hosting application's window.
@@ -407,6 +514,47 @@ static void _ClosePseudoConsole(_In_ PseudoConsole* pPty, _In_ DWORD dwMilliseco
     }
 }
 
+// Function Description:
+// - The shared implementation of ConptyCreatePseudoConsoleAsUser() and
+//   ConptyCreatePseudoConsoleWithSharedMemory(). hSharedMemory is optional.
+static HRESULT _CreatePseudoConsoleWithDuplicatedPipes(const HANDLE hToken,
+                                                       const COORD size,
+                                                       const HANDLE hInput,
+                                                       const HANDLE hOutput,
+                                                       const HANDLE hSharedMemory,
+                                                       const DWORD dwFlags,
+                                                       HPCON* phPC)
+{
+    if (phPC == nullptr)
+    {
+        return E_INVALIDARG;
+    }
+    *phPC = nullptr;
+    if ((!_HandleIsValid(hInput)) && (!_HandleIsValid(hOutput)))
+    {
+        return E_INVALIDARG;
+    }
+
+    auto pPty = (PseudoConsole*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(PseudoConsole));
+    RETURN_IF_NULL_ALLOC(pPty);
+    auto cleanupPty = wil::scope_exit([&]() noexcept {
+        _ClosePseudoConsole(pPty, 0);
+    });
+
+    wil::unique_handle duplicatedInput;
+    wil::unique_handle duplicatedOutput;
+    RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), hInput, GetCurrentProcess(), duplicatedInput.addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
+    RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), hOutput, GetCurrentProcess(), duplicatedOutput.addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
+
+    const auto hr = _CreatePseudoConsole(hToken, size, duplicatedInput.get(), duplicatedOutput.get(), hSharedMemory, dwFlags, pPty);
+    RETURN_IF_FAILED(hr);
+
+    *phPC = (HPCON)pPty;
+    cleanupPty.release();
+
+    return hr;
+}
+
 // These functions are defined in the console l1 apiset, which is generated from
 //      the consoleapi.apx file in minkernel\apiset\libs\Console.
 
@@ -450,33 +598,50 @@ extern "C" HRESULT WINAPI ConptyCreatePseudoConsoleAsUser(_In_ HANDLE hToken,
                                                           _In_ DWORD dwFlags,
                                                           _Out_ HPCON* phPC)
 {
-    if (phPC == nullptr)
-    {
-        return E_INVALIDARG;
-    }
-    *phPC = nullptr;
-    if ((!_HandleIsValid(hInput)) && (!_HandleIsValid(hOutput)))
+    return _CreatePseudoConsoleWithDuplicatedPipes(hToken, size, hInput, hOutput, nullptr, dwFlags, phPC);
+}
+
+// Function Description:
+// Like ConptyCreatePseudoConsole(), but additionally offers the conpty a VtSharedMemory
+//      section (see VtSharedMemory.h) created by the caller. If the conpty accepts it,
+//      it writes its output into the section's output ring and reads its input from
+//      the input ring, instead of using the pipes, which avoids the kernel transitions
+//      and copies of pipe I/O. Resizing and all other signals still use the signal pipe.
+// Since not every console host supports this (conhost may be older than this
+//      module), the pipes are still required and will be used if it doesn't.
+// Return Value:
+// - S_OK if the conpty uses the shared memory, S_FALSE if it uses the pipes,
+//      otherwise an appropriate HRESULT for failing to create it.
+// - phProcess receives a handle to the conpty process with SYNCHRONIZE access,
+//      which the caller can wait on to find out when the conpty exited. In
+//      pipe mode a broken output pipe tells it that already.
+extern "C" HRESULT WINAPI ConptyCreatePseudoConsoleWithSharedMemory(_In_ COORD size,
+                                                                    _In_ HANDLE hInput,
+                                                                    _In_ HANDLE hOutput,
+                                                                    _In_ HANDLE hSharedMemory,
+                                                                    _In_ DWORD dwFlags,
+                                                                    _Out_ HPCON* phPC,
+                                                                    _Out_ HANDLE* phProcess)
+{
+    if (phProcess == nullptr || !_HandleIsValid(hSharedMemory))
     {
         return E_INVALIDARG;
     }
+    *phProcess = nullptr;
 
-    auto pPty = (PseudoConsole*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(PseudoConsole));
-    RETURN_IF_NULL_ALLOC(pPty);
-    auto cleanupPty = wil::scope_exit([&]() noexcept {
-        _ClosePseudoConsole(pPty, 0);
-    });
-
-    wil::unique_handle duplicatedInput;
-    wil::unique_handle duplicatedOutput;
-    RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), hInput, GetCurrentProcess(), duplicatedInput.addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
-    RETURN_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(), hOutput, GetCurrentProcess(), duplicatedOutput.addressof(), 0, TRUE, DUPLICATE_SAME_ACCESS));
-
-    RETURN_IF_FAILED(_CreatePseudoConsole(hToken, size, duplicatedInput.get(), duplicatedOutput.get(), dwFlags, pPty));
+    const auto hr = _CreatePseudoConsoleWithDuplicatedPipes(INVALID_HANDLE_VALUE, size, hInput, hOutput, hSharedMemory, dwFlags, phPC);
+    RETURN_IF_FAILED(hr);
 
-    *phPC = (HPCON)pPty;
-    cleanupPty.release();
+    const auto pPty = (PseudoConsole*)*phPC;
+    if (!DuplicateHandle(GetCurrentProcess(), pPty->hConPtyProcess, GetCurrentProcess(), phProcess, SYNCHRONIZE, FALSE, 0))
+    {
+        const auto error = HRESULT_FROM_WIN32(GetLastError());
+        _ClosePseudoConsole(pPty, 0);
+        *phPC = nullptr;
+        return error;
+    }
 
-    return S_OK;
+    return hr;
 }
 
 // Function Description:
@@ -509,6 +674,16 @@ extern "C" HRESULT WINAPI ConptyClearPseudoConsole(_In_ HPCON hPC)
     return hr;
 }
 
+// Function Description:
+// - Deliver a Ctrl+C to the conpty out of band, ahead of any pending input.
+// - This allows a terminal to interrupt a client that's flooding the conpty
+//   with output, even if the input pipe is backed up.
+extern "C" HRESULT WINAPI ConptyInterruptPseudoConsole(_In_ HPCON hPC)
+{
+    // _InterruptPseudoConsole will return E_INVALIDARG for us if the hPC is nullptr.
+    return _InterruptPseudoConsole((PseudoConsole*)hPC);
+}
+
 // Function Description:
 // - Tell the ConPTY about the state of the hosting window. This should be used
 //   to keep ConPTY's internal HWND state in sync with the state of whatever the
@@ -46,6 +46,7 @@ typedef struct _PseudoConsole
 #define PTY_SIGNAL_SHOWHIDE_WINDOW (1u)
 #define PTY_SIGNAL_CLEAR_WINDOW (2u)
 #define PTY_SIGNAL_REPARENT_WINDOW (3u)
+#define PTY_SIGNAL_INTERRUPT (4u)
 #define PTY_SIGNAL_RESIZE_WINDOW (8u)
 
 // CreatePseudoConsole Flags
@@ -67,11 +68,13 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
                              const COORD size,
                              const HANDLE hInput,
                              const HANDLE hOutput,
+                             const HANDLE hSharedMemory,
                              const DWORD dwFlags,
                              _Inout_ PseudoConsole* pPty);
 
 HRESULT _ResizePseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const COORD size);
 HRESULT _ClearPseudoConsole(_In_ const PseudoConsole* const pPty);
+HRESULT _InterruptPseudoConsole(_In_ const PseudoConsole* const pPty);
 HRESULT _ShowHidePseudoConsole(_In_ const PseudoConsole* const pPty, const bool show);
 HRESULT _ReparentPseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const HWND newParent);
 void _ClosePseudoConsoleMembers(_In_ PseudoConsole* pPty, _In_ DWORD dwMilliseconds);
@@ -83,6 +86,14 @@ HRESULT WINAPI ConptyCreatePseudoConsoleAsUser(_In_ HANDLE hToken,
                                                _In_ DWORD dwFlags,
                                                _Out_ HPCON* phPC);
 
+HRESULT WINAPI ConptyCreatePseudoConsoleWithSharedMemory(_In_ COORD size,
+                                                         _In_ HANDLE hInput,
+                                                         _In_ HANDLE hOutput,
+                                                         _In_ HANDLE hSharedMemory,
+                                                         _In_ DWORD dwFlags,
+                                                         _Out_ HPCON* phPC,
+                                                         _Out_ HANDLE* phProcess);
+
 #ifdef __cplusplus
 }
 #endif